@@ -0,0 +1,491 @@
+// Copyright (C) 2012, Steffen Knollmann
+// Released under the terms of the GNU General Public License version 3.
+// This file is part of `ginnungagap'.
+
+
+/*--- Doxygen file description ------------------------------------------*/
+
+/**
+ * @file bench/bench.c
+ * @ingroup  bench
+ * @brief  Implements the micro-benchmark harness.
+ */
+
+
+/*--- Includes ----------------------------------------------------------*/
+#include "bench.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include <assert.h>
+#ifdef WITH_MPI
+#  include <mpi.h>
+#endif
+#ifdef WITH_OPENMP
+#  include <omp.h>
+#endif
+#ifdef WITH_FFT_FFTW3
+#  include <complex.h>
+#  include <fftw3.h>
+#endif
+#include "../version.h"
+#include "../src/libutil/xmem.h"
+#include "../src/libutil/xstring.h"
+#include "../src/libutil/cmdline.h"
+#include "../src/libutil/diediedie.h"
+#if (!defined WITH_MPI && !defined WITH_OPENMP)
+#  include <time.h>
+#endif
+
+
+/*--- Local defines -----------------------------------------------------*/
+#define LOCAL_MAX_DIMS 32
+#define LOCAL_DEFAULT_DIMS "32,64"
+#define LOCAL_DEFAULT_REPS 5
+#define LOCAL_DEFAULT_WARMUP 1
+
+
+/*--- Implemention of main structure ------------------------------------*/
+struct bench_struct {
+	char     *driverName;
+	int      rank;
+	int      numRanks;
+	int      numThreads;
+	int      numDims;
+	uint32_t dims[LOCAL_MAX_DIMS];
+	int      numReps;
+	int      numWarmup;
+	int      nProcs[NDIM];
+	char     *workDir;
+	FILE     *out;
+	bool     outIsStdout;
+	int      numTimings;
+	double   *timings;
+	double   startTime;
+};
+
+
+/*--- Prototypes of local functions -------------------------------------*/
+static cmdline_t
+local_cmdlineSetup(const char *driverName);
+
+static void
+local_checkForPrematureTermination(cmdline_t cmdline, const char *name);
+
+static void
+local_parseOpts(bench_t bench, cmdline_t cmdline);
+
+static int
+local_parseList(const char *str, int maxNum, long *vals);
+
+static void
+local_setThreads(bench_t bench);
+
+static double
+local_wtime(void);
+
+
+/*--- Implementations of exported functions -----------------------------*/
+extern bench_t
+bench_new(int *argc, char ***argv, const char *driverName)
+{
+	bench_t   bench;
+	cmdline_t cmdline;
+
+	assert(argc != NULL && argv != NULL);
+	assert(driverName != NULL);
+
+#ifdef WITH_MPI
+	MPI_Init(argc, argv);
+#endif
+
+	bench             = xmalloc(sizeof(struct bench_struct));
+	bench->driverName = xstrdup(driverName);
+	bench->rank       = 0;
+	bench->numRanks   = 1;
+#ifdef WITH_MPI
+	MPI_Comm_rank(MPI_COMM_WORLD, &(bench->rank));
+	MPI_Comm_size(MPI_COMM_WORLD, &(bench->numRanks));
+#endif
+
+	cmdline = local_cmdlineSetup(driverName);
+	cmdline_parse(cmdline, *argc, *argv);
+	local_checkForPrematureTermination(cmdline, driverName);
+	local_parseOpts(bench, cmdline);
+	cmdline_del(&cmdline);
+
+	local_setThreads(bench);
+
+	bench->timings    = xmalloc(sizeof(double) * bench_getNumRuns(bench));
+	bench->numTimings = 0;
+	bench->startTime  = 0.0;
+
+	return bench;
+}
+
+extern void
+bench_del(bench_t *bench)
+{
+	assert(bench != NULL && *bench != NULL);
+
+	if ((*bench)->out != NULL) {
+		if ((*bench)->outIsStdout)
+			fflush((*bench)->out);
+		else
+			fclose((*bench)->out);
+	}
+	xfree((*bench)->timings);
+	xfree((*bench)->workDir);
+	xfree((*bench)->driverName);
+	xfree(*bench);
+	*bench = NULL;
+
+#ifdef WITH_MPI
+	MPI_Finalize();
+#endif
+}
+
+extern int
+bench_getNumDims(const bench_t bench)
+{
+	assert(bench != NULL);
+
+	return bench->numDims;
+}
+
+extern uint32_t
+bench_getDim(const bench_t bench, int idx)
+{
+	assert(bench != NULL);
+	assert(idx >= 0 && idx < bench->numDims);
+
+	return bench->dims[idx];
+}
+
+extern int
+bench_getNumRuns(const bench_t bench)
+{
+	assert(bench != NULL);
+
+	return bench->numWarmup + bench->numReps;
+}
+
+extern int
+bench_getNumWarmup(const bench_t bench)
+{
+	assert(bench != NULL);
+
+	return bench->numWarmup;
+}
+
+extern void
+bench_getNProcs(const bench_t bench, int *nProcs)
+{
+	assert(bench != NULL);
+	assert(nProcs != NULL);
+
+	for (int i = 0; i < NDIM; i++)
+		nProcs[i] = bench->nProcs[i];
+}
+
+extern const char *
+bench_getWorkDir(const bench_t bench)
+{
+	assert(bench != NULL);
+
+	return bench->workDir;
+}
+
+extern int
+bench_getRank(const bench_t bench)
+{
+	assert(bench != NULL);
+
+	return bench->rank;
+}
+
+extern int
+bench_getNumRanks(const bench_t bench)
+{
+	assert(bench != NULL);
+
+	return bench->numRanks;
+}
+
+extern void
+bench_start(bench_t bench)
+{
+	assert(bench != NULL);
+	assert(bench->numTimings < bench_getNumRuns(bench));
+
+#ifdef WITH_MPI
+	MPI_Barrier(MPI_COMM_WORLD);
+#endif
+	bench->startTime = local_wtime();
+}
+
+extern void
+bench_stop(bench_t bench)
+{
+	assert(bench != NULL);
+	assert(bench->numTimings < bench_getNumRuns(bench));
+
+	bench->timings[bench->numTimings] = local_wtime() - bench->startTime;
+	bench->numTimings++;
+}
+
+extern void
+bench_record(bench_t    bench,
+             const char *kernel,
+             uint32_t   dim1D,
+             uint64_t   numItems)
+{
+	double *t;
+	int    num;
+	double min, max, mean;
+
+	assert(bench != NULL);
+	assert(kernel != NULL);
+	assert(bench->numTimings > bench->numWarmup);
+
+	t   = bench->timings + bench->numWarmup;
+	num = bench->numTimings - bench->numWarmup;
+#ifdef WITH_MPI
+	// A run takes as long as the slowest rank.
+	MPI_Allreduce(MPI_IN_PLACE, t, num, MPI_DOUBLE, MPI_MAX,
+	              MPI_COMM_WORLD);
+#endif
+	min  = t[0];
+	max  = t[0];
+	mean = 0.0;
+	for (int i = 0; i < num; i++) {
+		min   = (t[i] < min) ? t[i] : min;
+		max   = (t[i] > max) ? t[i] : max;
+		mean += t[i];
+	}
+	mean /= num;
+
+	if (bench->rank == 0) {
+		fprintf(bench->out,
+		        "{\"driver\": \"%s\", \"kernel\": \"%s\", \"dim1D\": %"
+		        PRIu32 ", \"ranks\": %i, \"threads\": %i, \"reps\": %i, "
+		        "\"min\": %.6e, \"mean\": %.6e, \"max\": %.6e, "
+		        "\"items\": %" PRIu64 ", \"itemsPerSec\": %.6e}\n",
+		        bench->driverName, kernel, dim1D, bench->numRanks,
+		        bench->numThreads, num, min, mean, max, numItems,
+		        (min > 0.0) ? numItems / min : 0.0);
+		fflush(bench->out);
+		if (!bench->outIsStdout)
+			printf("%-12s %-16s %6" PRIu32 "  min %.4es  mean %.4es\n",
+			       bench->driverName, kernel, dim1D, min, mean);
+	}
+
+	bench->numTimings = 0;
+} /* bench_record */
+
+extern void
+bench_skip(bench_t bench, const char *kernel, const char *reason)
+{
+	assert(bench != NULL);
+	assert(kernel != NULL && reason != NULL);
+
+	if (bench->rank == 0) {
+		fprintf(bench->out,
+		        "{\"driver\": \"%s\", \"kernel\": \"%s\", "
+		        "\"skipped\": \"%s\"}\n",
+		        bench->driverName, kernel, reason);
+		fflush(bench->out);
+		if (!bench->outIsStdout)
+			printf("%-12s %-16s skipped: %s\n",
+			       bench->driverName, kernel, reason);
+	}
+	bench->numTimings = 0;
+}
+
+/*--- Implementations of local functions --------------------------------*/
+static cmdline_t
+local_cmdlineSetup(const char *driverName)
+{
+	cmdline_t cmdline;
+
+	cmdline = cmdline_new(0, 9, driverName);
+	(void)cmdline_addOpt(cmdline, "version",
+	                     "This will output a version information.",
+	                     false, CMDLINE_TYPE_NONE);
+	(void)cmdline_addOpt(cmdline, "help",
+	                     "This will print this help text.",
+	                     false, CMDLINE_TYPE_NONE);
+	(void)cmdline_addOpt(cmdline, "dims",
+	                     "Comma separated list of the grid sizes to run "
+	                     "(default: " LOCAL_DEFAULT_DIMS ").",
+	                     true, CMDLINE_TYPE_STRING);
+	(void)cmdline_addOpt(cmdline, "reps",
+	                     "The number of timed runs per kernel.",
+	                     true, CMDLINE_TYPE_INT);
+	(void)cmdline_addOpt(cmdline, "warmup",
+	                     "The number of untimed runs per kernel.",
+	                     true, CMDLINE_TYPE_INT);
+	(void)cmdline_addOpt(cmdline, "threads",
+	                     "The number of OpenMP threads per rank.",
+	                     true, CMDLINE_TYPE_INT);
+	(void)cmdline_addOpt(cmdline, "nProcs",
+	                     "Comma separated process grid (default: 1,0,0).",
+	                     true, CMDLINE_TYPE_STRING);
+	(void)cmdline_addOpt(cmdline, "workDir",
+	                     "The directory for temporary files.",
+	                     true, CMDLINE_TYPE_STRING);
+	(void)cmdline_addOpt(cmdline, "output",
+	                     "The file to append the results to (- is stdout).",
+	                     true, CMDLINE_TYPE_STRING);
+
+	return cmdline;
+}
+
+static void
+local_checkForPrematureTermination(cmdline_t cmdline, const char *name)
+{
+	// This relies on the knowledge of which number is which option!
+	// Not nice style, but the respective calls are directly above.
+	if (cmdline_checkOptSetByNum(cmdline, 0)) {
+		PRINT_VERSION_INFO2(stdout, name);
+		cmdline_del(&cmdline);
+		exit(EXIT_SUCCESS);
+	}
+	if (cmdline_checkOptSetByNum(cmdline, 1)) {
+		cmdline_printHelp(cmdline, stdout);
+		cmdline_del(&cmdline);
+		exit(EXIT_SUCCESS);
+	}
+	if (!cmdline_verify(cmdline)) {
+		cmdline_printHelp(cmdline, stderr);
+		cmdline_del(&cmdline);
+		exit(EXIT_FAILURE);
+	}
+}
+
+static void
+local_parseOpts(bench_t bench, cmdline_t cmdline)
+{
+	char *str;
+	long vals[LOCAL_MAX_DIMS];
+	int  num;
+
+	if (cmdline_checkOptSetByNum(cmdline, 2))
+		cmdline_getOptValueByNum(cmdline, 2, &str);
+	else
+		str = xstrdup(LOCAL_DEFAULT_DIMS);
+	num = local_parseList(str, LOCAL_MAX_DIMS, vals);
+	if (num < 1) {
+		fprintf(stderr, "FATAL:  Invalid list of grid sizes: %s\n", str);
+		diediedie(EXIT_FAILURE);
+	}
+	for (int i = 0; i < num; i++) {
+		if (vals[i] < 2) {
+			fprintf(stderr, "FATAL:  Invalid grid size: %li\n", vals[i]);
+			diediedie(EXIT_FAILURE);
+		}
+		bench->dims[i] = (uint32_t)vals[i];
+	}
+	bench->numDims = num;
+	xfree(str);
+
+	if (!cmdline_getOptValueByNum(cmdline, 3, &(bench->numReps)))
+		bench->numReps = LOCAL_DEFAULT_REPS;
+	if (!cmdline_getOptValueByNum(cmdline, 4, &(bench->numWarmup)))
+		bench->numWarmup = LOCAL_DEFAULT_WARMUP;
+	if ((bench->numReps < 1) || (bench->numWarmup < 0)) {
+		fprintf(stderr, "FATAL:  Need at least one timed run.\n");
+		diediedie(EXIT_FAILURE);
+	}
+	if (!cmdline_getOptValueByNum(cmdline, 5, &(bench->numThreads)))
+		bench->numThreads = 0;
+
+	bench->nProcs[0] = 1;
+	for (int i = 1; i < NDIM; i++)
+		bench->nProcs[i] = 0;
+	if (cmdline_checkOptSetByNum(cmdline, 6)) {
+		cmdline_getOptValueByNum(cmdline, 6, &str);
+		if (local_parseList(str, LOCAL_MAX_DIMS, vals) != NDIM) {
+			fprintf(stderr, "FATAL:  Need %i entries in nProcs: %s\n",
+			        NDIM, str);
+			diediedie(EXIT_FAILURE);
+		}
+		for (int i = 0; i < NDIM; i++)
+			bench->nProcs[i] = (int)vals[i];
+		xfree(str);
+	}
+
+	if (!cmdline_getOptValueByNum(cmdline, 7, &(bench->workDir)))
+		bench->workDir = xstrdup(".");
+
+	bench->out         = NULL;
+	bench->outIsStdout = false;
+	if (cmdline_getOptValueByNum(cmdline, 8, &str)) {
+		bench->outIsStdout = (strcmp(str, "-") == 0);
+	} else {
+		str = xstrmerge(bench->driverName, ".jsonl");
+	}
+	if (bench->rank == 0) {
+		bench->out = bench->outIsStdout ? stdout : fopen(str, "a");
+		if (bench->out == NULL) {
+			fprintf(stderr, "FATAL:  Cannot open %s for writing.\n", str);
+			diediedie(EXIT_FAILURE);
+		}
+	}
+	xfree(str);
+} /* local_parseOpts */
+
+static int
+local_parseList(const char *str, int maxNum, long *vals)
+{
+	const char *p = str;
+	char       *end;
+	int        num = 0;
+
+	while (*p != '\0') {
+		if (num == maxNum)
+			return -1;
+		vals[num] = strtol(p, &end, 10);
+		if (end == p)
+			return -1;
+		num++;
+		p = end;
+		if (*p == ',')
+			p++;
+		else if (*p != '\0')
+			return -1;
+	}
+
+	return num;
+}
+
+static void
+local_setThreads(bench_t bench)
+{
+#ifdef WITH_OPENMP
+	if (bench->numThreads > 0)
+		omp_set_num_threads(bench->numThreads);
+	bench->numThreads = omp_get_max_threads();
+#  ifdef WITH_FFT_FFTW3
+	fftw_init_threads();
+	fftw_plan_with_nthreads(bench->numThreads);
+	fftwf_init_threads();
+	fftwf_plan_with_nthreads(bench->numThreads);
+#  endif
+#else
+	bench->numThreads = 1;
+#endif
+}
+
+static double
+local_wtime(void)
+{
+#if (defined WITH_MPI)
+	return MPI_Wtime();
+#elif (defined WITH_OPENMP)
+	return omp_get_wtime();
+#else
+	return clock() / ((double)CLOCKS_PER_SEC);
+#endif
+}
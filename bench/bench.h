@@ -0,0 +1,290 @@
+// Copyright (C) 2012, Steffen Knollmann
+// Released under the terms of the GNU General Public License version 3.
+// This file is part of `ginnungagap'.
+
+#ifndef BENCH_H
+#define BENCH_H
+
+
+/*--- Doxygen file description ------------------------------------------*/
+
+/**
+ * @file bench/bench.h
+ * @ingroup  bench
+ * @brief  Provides the interface of the micro-benchmark harness.
+ *
+ * Every benchmark driver creates a harness with bench_new(), which
+ * initialises MPI (if enabled), parses the common command line options
+ * and opens the result file.  For every grid size the driver then runs
+ * each kernel bench_getNumRuns() times, enclosing the timed part in
+ * bench_start() and bench_stop(), and finally calls bench_record().  The
+ * first bench_getNumWarmup() runs are discarded, of the remaining runs
+ * the maximum over all ranks is taken for every run and the minimum,
+ * mean, and maximum of those are written as one JSON object per line:
+ *
+ * <tt>{"driver": "benchGrid", "kernel": "fftForward", "dim1D": 64,
+ * "ranks": 2, "threads": 4, "reps": 5, "min": ..., "mean": ..., "max":
+ * ..., "items": 262144, "itemsPerSec": ...}</tt>
+ *
+ * The rate is calculated from the minimum time.  Kernels that are not
+ * available in the current build are reported with bench_skip() as
+ * <tt>{"driver": ..., "kernel": ..., "skipped": "reason"}</tt>.
+ */
+
+
+/*--- Includes ----------------------------------------------------------*/
+#include "../config.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+
+/*--- ADT handle --------------------------------------------------------*/
+
+/** @brief  The handle of the benchmark harness. */
+typedef struct bench_struct *bench_t;
+
+
+/*--- Prototypes of exported functions ----------------------------------*/
+
+/**
+ * @name  Creating and Deleting
+ * @{
+ */
+
+/**
+ * @brief  Sets up the environment and creates a new harness.
+ *
+ * This initialises MPI, parses the command line and sets the number of
+ * OpenMP threads (which is also used for the threaded FFTW).  The
+ * recognised options are @c --dims (a comma separated list of grid
+ * sizes), @c --reps, @c --warmup, @c --threads, @c --nProcs (the
+ * process grid, a comma separated list of #NDIM numbers, 0 entries are
+ * filled in), @c --workDir (where temporary files are put) and
+ * @c --output (the file the results are appended to, @c - for stdout,
+ * defaults to <tt>\<driverName\>.jsonl</tt>).
+ *
+ * @param[in,out]  *argc
+ *                    Pointer to the number of command line arguments.
+ * @param[in,out]  ***argv
+ *                    Pointer to the command line arguments.
+ * @param[in]      *driverName
+ *                    The name of the driver, used in the output.
+ *
+ * @return  Returns a new harness.
+ */
+extern bench_t
+bench_new(int *argc, char ***argv, const char *driverName);
+
+
+/**
+ * @brief  Deletes the harness, closes the result file and finalises
+ *         MPI.
+ *
+ * @param[in,out]  *bench
+ *                    Pointer to the harness to delete.  Will be set to
+ *                    @c NULL.
+ *
+ * @return  Returns nothing.
+ */
+extern void
+bench_del(bench_t *bench);
+
+
+/** @} */
+
+/**
+ * @name  Getter
+ * @{
+ */
+
+/**
+ * @brief  Gets the number of grid sizes to run.
+ *
+ * @param[in]  bench
+ *                The harness to query.
+ *
+ * @return  Returns the number of grid sizes.
+ */
+extern int
+bench_getNumDims(const bench_t bench);
+
+
+/**
+ * @brief  Gets a grid size.
+ *
+ * @param[in]  bench
+ *                The harness to query.
+ * @param[in]  idx
+ *                The index of the size, must be smaller than
+ *                bench_getNumDims().
+ *
+ * @return  Returns the one-dimensional size of the grid.
+ */
+extern uint32_t
+bench_getDim(const bench_t bench, int idx);
+
+
+/**
+ * @brief  Gets the number of runs (warm-up and timed) per kernel.
+ *
+ * @param[in]  bench
+ *                The harness to query.
+ *
+ * @return  Returns the number of runs.
+ */
+extern int
+bench_getNumRuns(const bench_t bench);
+
+
+/**
+ * @brief  Gets the number of warm-up runs per kernel.
+ *
+ * @param[in]  bench
+ *                The harness to query.
+ *
+ * @return  Returns the number of warm-up runs.
+ */
+extern int
+bench_getNumWarmup(const bench_t bench);
+
+
+/**
+ * @brief  Gets the process grid.
+ *
+ * @param[in]   bench
+ *                 The harness to query.
+ * @param[out]  *nProcs
+ *                 Array of #NDIM elements that receives the process grid.
+ *
+ * @return  Returns nothing.
+ */
+extern void
+bench_getNProcs(const bench_t bench, int *nProcs);
+
+
+/**
+ * @brief  Gets the directory for temporary files.
+ *
+ * @param[in]  bench
+ *                The harness to query.
+ *
+ * @return  Returns the directory, this is internal memory of the harness.
+ */
+extern const char *
+bench_getWorkDir(const bench_t bench);
+
+
+/**
+ * @brief  Gets the rank of this process.
+ *
+ * @param[in]  bench
+ *                The harness to query.
+ *
+ * @return  Returns the rank, 0 without MPI.
+ */
+extern int
+bench_getRank(const bench_t bench);
+
+
+/**
+ * @brief  Gets the number of processes.
+ *
+ * @param[in]  bench
+ *                The harness to query.
+ *
+ * @return  Returns the number of ranks, 1 without MPI.
+ */
+extern int
+bench_getNumRanks(const bench_t bench);
+
+
+/** @} */
+
+/**
+ * @name  Timing
+ * @{
+ */
+
+/**
+ * @brief  Starts a run.
+ *
+ * This synchronises all ranks.
+ *
+ * @param[in,out]  bench
+ *                    The harness to use.
+ *
+ * @return  Returns nothing.
+ */
+extern void
+bench_start(bench_t bench);
+
+
+/**
+ * @brief  Stops a run and stores its time.
+ *
+ * @param[in,out]  bench
+ *                    The harness to use.
+ *
+ * @return  Returns nothing.
+ */
+extern void
+bench_stop(bench_t bench);
+
+
+/**
+ * @brief  Reduces the stored runs and writes the result of a kernel.
+ *
+ * This is a collective operation, the result is written by rank 0.
+ * Afterwards the stored runs are discarded.
+ *
+ * @param[in,out]  bench
+ *                    The harness to use.
+ * @param[in]      *kernel
+ *                    The name of the kernel.
+ * @param[in]      dim1D
+ *                    The grid size the kernel was run for.
+ * @param[in]      numItems
+ *                    The number of items (cells, particles, numbers)
+ *                    processed by one run on all ranks.
+ *
+ * @return  Returns nothing.
+ */
+extern void
+bench_record(bench_t    bench,
+             const char *kernel,
+             uint32_t   dim1D,
+             uint64_t   numItems);
+
+
+/**
+ * @brief  Writes a record for a kernel that cannot be run.
+ *
+ * @param[in,out]  bench
+ *                    The harness to use.
+ * @param[in]      *kernel
+ *                    The name of the kernel.
+ * @param[in]      *reason
+ *                    The reason why it was skipped.
+ *
+ * @return  Returns nothing.
+ */
+extern void
+bench_skip(bench_t bench, const char *kernel, const char *reason);
+
+
+/** @} */
+
+
+/*--- Doxygen group definitions -----------------------------------------*/
+
+/**
+ * @defgroup bench Micro-Benchmarks
+ * @brief  Standalone drivers timing the central kernels.
+ *
+ * Every driver (benchGrid, benchIC, benchRng, benchIO, benchMask and
+ * benchGenICs) is built with <tt>make bench</tt> and shares the harness
+ * described in bench.h.
+ */
+
+
+#endif
@@ -0,0 +1,113 @@
+// Copyright (C) 2013, Steffen Knollmann
+// Released under the terms of the GNU General Public License version 3.
+// This file is part of `ginnungagap'.
+
+
+/*--- Doxygen file description ------------------------------------------*/
+
+/**
+ * @file bench/benchGenICs.c
+ * @ingroup  bench
+ * @brief  Times the particle assembly of generateICs.
+ *
+ * Every rank turns the velocity fields of its patch of an unmasked grid
+ * into particles, as generateICs does for every tile.
+ */
+
+
+/*--- Includes ----------------------------------------------------------*/
+#include "../config.h"
+#include "bench.h"
+#include "benchUtil.h"
+#include <stdlib.h>
+#include "../src/libutil/xmem.h"
+#include "../src/libcosmo/cosmoModel.h"
+#include "../src/libgrid/gridRegular.h"
+#include "../src/libgrid/gridRegularDistrib.h"
+#include "../src/libgrid/gridPatch.h"
+#include "../tools/generateICs/generateICsCore.h"
+#include "../tools/generateICs/generateICsData.h"
+#include "../tools/generateICs/generateICsMode.h"
+
+
+/*--- Local defines -----------------------------------------------------*/
+#define THIS_PROGNAME "benchGenICs"
+#define LOCAL_BOXSIZE 100.
+#define LOCAL_AINIT 0.02
+
+
+/*--- Prototypes of local functions -------------------------------------*/
+static void
+local_benchGenICs(bench_t bench, uint32_t dim1D);
+
+
+/*--- M A I N -----------------------------------------------------------*/
+int
+main(int argc, char **argv)
+{
+	bench_t bench = bench_new(&argc, &argv, THIS_PROGNAME);
+
+	for (int i = 0; i < bench_getNumDims(bench); i++)
+		local_benchGenICs(bench, bench_getDim(bench, i));
+
+	bench_del(&bench);
+
+	return EXIT_SUCCESS;
+}
+
+/*--- Implementations of local functions --------------------------------*/
+static void
+local_benchGenICs(bench_t bench, uint32_t dim1D)
+{
+	gridRegularDistrib_t distrib;
+	gridRegular_t        grid;
+	generateICsData_t    data;
+	generateICsMode_t    mode;
+	int                  nProcs[NDIM];
+	uint64_t             numCells = benchUtil_getNumCells(dim1D);
+
+	bench_getNProcs(bench, nProcs);
+	grid = benchUtil_newGrid(dim1D, LOCAL_BOXSIZE, nProcs, &distrib);
+	benchUtil_fillVar(grid, benchUtil_attachVar(grid, "velx"));
+	benchUtil_fillVar(grid, benchUtil_attachVar(grid, "vely"));
+	benchUtil_fillVar(grid, benchUtil_attachVar(grid, "velz"));
+
+	// The model is owned by the data.
+	data = generateICsData_new(LOCAL_BOXSIZE, LOCAL_AINIT,
+	                           benchUtil_newModel());
+	mode = generateICsMode_new(false, false, false, false, false, false);
+
+	generateICsCore_s core = GENICSCORE_INIT_STRUCT(data, mode);
+	core.patch        = gridRegular_getPatchHandle(grid, 0);
+	core.numParticles = gridPatch_getNumCells(core.patch);
+	core.pos          = xmalloc(sizeof(fpv_t) * 3 * core.numParticles);
+	core.vel          = xmalloc(sizeof(fpv_t) * 3 * core.numParticles);
+	core.id           = xmalloc(sizeof(uint32_t) * core.numParticles);
+	core.maskDim1D    = dim1D;
+	core.partDim1D    = dim1D;
+	core.maxDims      = dim1D;
+	for (int i = 0; i < NDIM; i++)
+		core.fullDims[i] = dim1D;
+
+	for (int i = 0; i < bench_getNumRuns(bench); i++) {
+		bench_start(bench);
+		generateICsCore_initPosID(&core);
+		bench_stop(bench);
+	}
+	bench_record(bench, "initPosID", dim1D, numCells);
+
+	for (int i = 0; i < bench_getNumRuns(bench); i++) {
+		bench_start(bench);
+		generateICsCore_toParticles(&core);
+		bench_stop(bench);
+	}
+	bench_record(bench, "toParticles", dim1D, numCells);
+
+	xfree(core.id);
+	xfree(core.vel);
+	xfree(core.pos);
+	generateICsMode_del(&mode);
+	generateICsData_del(&data);
+	gridRegularDistrib_del(&distrib);
+	gridRegular_del(&grid);
+} /* local_benchGenICs */
@@ -0,0 +1,193 @@
+// Copyright (C) 2012, Steffen Knollmann
+// Released under the terms of the GNU General Public License version 3.
+// This file is part of `ginnungagap'.
+
+
+/*--- Doxygen file description ------------------------------------------*/
+
+/**
+ * @file bench/benchGrid.c
+ * @ingroup  bench
+ * @brief  Times the FFT, the transpositions, and the grid statistics.
+ */
+
+
+/*--- Includes ----------------------------------------------------------*/
+#include "../config.h"
+#include "bench.h"
+#include "benchUtil.h"
+#include <stdlib.h>
+#include "../src/libgrid/gridRegular.h"
+#include "../src/libgrid/gridRegularDistrib.h"
+#include "../src/libgrid/gridRegularFFT.h"
+#include "../src/libgrid/gridPatch.h"
+#include "../src/libgrid/gridStatistics.h"
+#include "../src/libgrid/gridHistogram.h"
+
+
+/*--- Local defines -----------------------------------------------------*/
+#define THIS_PROGNAME "benchGrid"
+
+
+/*--- Prototypes of local functions -------------------------------------*/
+static void
+local_benchFFT(bench_t bench, uint32_t dim1D);
+
+static void
+local_benchTranspose(bench_t bench, uint32_t dim1D);
+
+static void
+local_benchStatistics(bench_t bench, uint32_t dim1D);
+
+static void
+local_rescale(gridRegular_t grid, double factor);
+
+
+/*--- M A I N -----------------------------------------------------------*/
+int
+main(int argc, char **argv)
+{
+	bench_t bench = bench_new(&argc, &argv, THIS_PROGNAME);
+
+	for (int i = 0; i < bench_getNumDims(bench); i++) {
+		uint32_t dim1D = bench_getDim(bench, i);
+		local_benchFFT(bench, dim1D);
+		local_benchTranspose(bench, dim1D);
+		local_benchStatistics(bench, dim1D);
+	}
+
+	bench_del(&bench);
+
+	return EXIT_SUCCESS;
+}
+
+/*--- Implementations of local functions --------------------------------*/
+static void
+local_benchFFT(bench_t bench, uint32_t dim1D)
+{
+	gridRegularDistrib_t distrib;
+	gridRegular_t        grid;
+	gridRegularFFT_t     fft;
+	int                  nProcs[NDIM];
+	int                  idxOfVar;
+	uint64_t             numCells = benchUtil_getNumCells(dim1D);
+
+	bench_getNProcs(bench, nProcs);
+	grid     = benchUtil_newGrid(dim1D, 100., nProcs, &distrib);
+	idxOfVar = benchUtil_attachVar(grid, "field");
+	benchUtil_fillVar(grid, idxOfVar);
+	fft      = gridRegularFFT_new(grid, distrib, idxOfVar);
+
+	// The backward transform is timed in a second sweep so that the plan
+	// creation of both directions is covered by the warm-up runs.
+	for (int i = 0; i < bench_getNumRuns(bench); i++) {
+		bench_start(bench);
+		gridRegularFFT_execute(fft, GRIDREGULARFFT_FORWARD);
+		bench_stop(bench);
+		gridRegularFFT_execute(fft, GRIDREGULARFFT_BACKWARD);
+		local_rescale(grid, 1. / numCells);
+	}
+	bench_record(bench, "fftForward", dim1D, numCells);
+
+	for (int i = 0; i < bench_getNumRuns(bench); i++) {
+		gridRegularFFT_execute(fft, GRIDREGULARFFT_FORWARD);
+		bench_start(bench);
+		gridRegularFFT_execute(fft, GRIDREGULARFFT_BACKWARD);
+		bench_stop(bench);
+		local_rescale(grid, 1. / numCells);
+	}
+	bench_record(bench, "fftBackward", dim1D, numCells);
+
+	gridRegularFFT_del(&fft);
+	gridRegularDistrib_del(&distrib);
+	gridRegular_del(&grid);
+} /* local_benchFFT */
+
+static void
+local_benchTranspose(bench_t bench, uint32_t dim1D)
+{
+	gridRegularDistrib_t distrib;
+	gridRegular_t        grid;
+	gridPatch_t          patch;
+	int                  nProcs[NDIM];
+	int                  idxOfVar;
+	uint64_t             numCells = benchUtil_getNumCells(dim1D);
+
+	bench_getNProcs(bench, nProcs);
+	grid     = benchUtil_newGrid(dim1D, 100., nProcs, &distrib);
+	idxOfVar = benchUtil_attachVar(grid, "field");
+	benchUtil_fillVar(grid, idxOfVar);
+
+	// Every run transposes twice to end up in the original layout.
+	for (int i = 0; i < bench_getNumRuns(bench); i++) {
+		bench_start(bench);
+		gridRegularDistrib_transpose(distrib, 0, 1);
+		bench_stop(bench);
+		gridRegularDistrib_transpose(distrib, 0, 1);
+	}
+	bench_record(bench, "distribTranspose", dim1D, numCells);
+
+	patch = gridRegular_getPatchHandle(grid, 0);
+	for (int i = 0; i < bench_getNumRuns(bench); i++) {
+		bench_start(bench);
+		gridPatch_transpose(patch, 0, 2);
+		bench_stop(bench);
+		gridPatch_transpose(patch, 0, 2);
+	}
+	bench_record(bench, "patchTranspose", dim1D, numCells);
+
+	gridRegularDistrib_del(&distrib);
+	gridRegular_del(&grid);
+}
+
+static void
+local_benchStatistics(bench_t bench, uint32_t dim1D)
+{
+	gridRegularDistrib_t distrib;
+	gridRegular_t        grid;
+	gridStatistics_t     stat;
+	gridHistogram_t      histo;
+	int                  nProcs[NDIM];
+	int                  idxOfVar;
+	uint64_t             numCells = benchUtil_getNumCells(dim1D);
+
+	bench_getNProcs(bench, nProcs);
+	grid     = benchUtil_newGrid(dim1D, 100., nProcs, &distrib);
+	idxOfVar = benchUtil_attachVar(grid, "field");
+	benchUtil_fillVar(grid, idxOfVar);
+
+	stat     = gridStatistics_new();
+	for (int i = 0; i < bench_getNumRuns(bench); i++) {
+		bench_start(bench);
+		gridStatistics_calcGridRegularDistrib(stat, distrib, idxOfVar);
+		bench_stop(bench);
+	}
+	bench_record(bench, "statistics", dim1D, numCells);
+	gridStatistics_del(&stat);
+
+	histo = gridHistogram_new(100, -1.0, 1.0);
+	for (int i = 0; i < bench_getNumRuns(bench); i++) {
+		bench_start(bench);
+		gridHistogram_calcGridRegularDistrib(histo, distrib, idxOfVar);
+		bench_stop(bench);
+	}
+	bench_record(bench, "histogram", dim1D, numCells);
+	gridHistogram_del(&histo);
+
+	gridRegularDistrib_del(&distrib);
+	gridRegular_del(&grid);
+}
+
+static void
+local_rescale(gridRegular_t grid, double factor)
+{
+	gridPatch_t patch    = gridRegular_getPatchHandle(grid, 0);
+	fpv_t       *data    = gridPatch_getVarDataHandle(patch, 0);
+	uint64_t    numCells = gridPatch_getNumCellsActual(patch, 0);
+
+#ifdef WITH_OPENMP
+#  pragma omp parallel for
+#endif
+	for (uint64_t i = 0; i < numCells; i++)
+		data[i] *= (fpv_t)factor;
+}
@@ -0,0 +1,164 @@
+// Copyright (C) 2012, Steffen Knollmann
+// Released under the terms of the GNU General Public License version 3.
+// This file is part of `ginnungagap'.
+
+
+/*--- Doxygen file description ------------------------------------------*/
+
+/**
+ * @file bench/benchIC.c
+ * @ingroup  bench
+ * @brief  Times the Fourier space kernels of ginnungagap.
+ */
+
+
+/*--- Includes ----------------------------------------------------------*/
+#include "../config.h"
+#include "bench.h"
+#include "benchUtil.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "../src/libutil/xmem.h"
+#include "../src/libcosmo/cosmoModel.h"
+#include "../src/libcosmo/cosmoPk.h"
+#include "../src/libdata/dataVar.h"
+#include "../src/libgrid/gridRegular.h"
+#include "../src/libgrid/gridRegularDistrib.h"
+#include "../src/libgrid/gridRegularFFT.h"
+#include "../src/libgrid/gridPatch.h"
+#include "../src/ginnungagap/g9pIC.h"
+
+
+/*--- Local defines -----------------------------------------------------*/
+#define THIS_PROGNAME "benchIC"
+#define LOCAL_BOXSIZE 100.
+#define LOCAL_AINIT 0.02
+#define LOCAL_PK_NUMPOINTS 256
+
+
+/*--- Prototypes of local functions -------------------------------------*/
+static void
+local_benchKernels(bench_t bench, uint32_t dim1D);
+
+static cosmoPk_t
+local_getPk(void);
+
+static void *
+local_getFFTedData(gridRegularFFT_t fft, size_t *size);
+
+
+/*--- M A I N -----------------------------------------------------------*/
+int
+main(int argc, char **argv)
+{
+	bench_t bench = bench_new(&argc, &argv, THIS_PROGNAME);
+
+	for (int i = 0; i < bench_getNumDims(bench); i++)
+		local_benchKernels(bench, bench_getDim(bench, i));
+
+	bench_del(&bench);
+
+	return EXIT_SUCCESS;
+}
+
+/*--- Implementations of local functions --------------------------------*/
+static void
+local_benchKernels(bench_t bench, uint32_t dim1D)
+{
+	gridRegularDistrib_t distrib;
+	gridRegular_t        grid;
+	gridRegularFFT_t     fft;
+	cosmoModel_t         model    = benchUtil_newModel();
+	cosmoPk_t            pk       = local_getPk();
+	uint64_t             numCells = benchUtil_getNumCells(dim1D);
+	int                  nProcs[NDIM];
+	int                  idxOfVar;
+	void                 *cache, *data;
+	size_t               size;
+
+	bench_getNProcs(bench, nProcs);
+	grid     = benchUtil_newGrid(dim1D, LOCAL_BOXSIZE, nProcs, &distrib);
+	idxOfVar = benchUtil_attachVar(grid, "field");
+	benchUtil_fillVar(grid, idxOfVar);
+	fft      = gridRegularFFT_new(grid, distrib, idxOfVar);
+	gridRegularFFT_execute(fft, GRIDREGULARFFT_FORWARD);
+
+	// All kernels work in place, every run hence starts from a copy of
+	// the transformed field.
+	data  = local_getFFTedData(fft, &size);
+	cache = xmalloc(size);
+	memcpy(cache, data, size);
+
+	for (int i = 0; i < bench_getNumRuns(bench); i++) {
+		memcpy(data, cache, size);
+		bench_start(bench);
+		g9pIC_calcDeltaFromWN(fft, dim1D, LOCAL_BOXSIZE, pk);
+		bench_stop(bench);
+	}
+	bench_record(bench, "deltaFromWN", dim1D, numCells);
+
+	for (int i = 0; i < bench_getNumRuns(bench); i++) {
+		memcpy(data, cache, size);
+		bench_start(bench);
+		g9pIC_calcVelFromDelta(fft, dim1D, LOCAL_BOXSIZE, model,
+		                       LOCAL_AINIT, 0.0, G9PIC_MODE_VX);
+		bench_stop(bench);
+	}
+	bench_record(bench, "velFromDelta", dim1D, numCells);
+
+	for (int i = 0; i < bench_getNumRuns(bench); i++) {
+		memcpy(data, cache, size);
+		bench_start(bench);
+		g9pIC_calcDDPhiFromDelta(fft, dim1D, 0, 1);
+		bench_stop(bench);
+	}
+	bench_record(bench, "ddPhiFromDelta", dim1D, numCells);
+
+	memcpy(data, cache, size);
+	for (int i = 0; i < bench_getNumRuns(bench); i++) {
+		cosmoPk_t pkGrid;
+		bench_start(bench);
+		pkGrid = g9pIC_calcPkFromDelta(fft, dim1D, LOCAL_BOXSIZE);
+		bench_stop(bench);
+		cosmoPk_del(&pkGrid);
+	}
+	bench_record(bench, "pkFromDelta", dim1D, numCells);
+
+	xfree(cache);
+	gridRegularFFT_del(&fft);
+	gridRegularDistrib_del(&distrib);
+	gridRegular_del(&grid);
+	cosmoPk_del(&pk);
+	cosmoModel_del(&model);
+} /* local_benchKernels */
+
+static cosmoPk_t
+local_getPk(void)
+{
+	double    k[LOCAL_PK_NUMPOINTS];
+	double    P[LOCAL_PK_NUMPOINTS];
+	cosmoPk_t pk;
+
+	// A broken power law with a turnover at k = 0.02, the shape does not
+	// matter for the timing.
+	for (int i = 0; i < LOCAL_PK_NUMPOINTS; i++) {
+		k[i] = pow(10., -4. + 7. * i / (LOCAL_PK_NUMPOINTS - 1.));
+		P[i] = k[i] / pow(1. + k[i] / 0.02, 3.);
+	}
+	pk = cosmoPk_newFromArrays(LOCAL_PK_NUMPOINTS, k, P, 1., -2.);
+
+	return pk;
+}
+
+static void *
+local_getFFTedData(gridRegularFFT_t fft, size_t *size)
+{
+	gridPatch_t patch;
+
+	patch = gridRegular_getPatchHandle(gridRegularFFT_getGridFFTed(fft), 0);
+	*size = gridPatch_getNumCells(patch)
+	        * dataVar_getSizePerElement(gridPatch_getVarHandle(patch, 0));
+
+	return gridPatch_getVarDataHandle(patch, 0);
+}
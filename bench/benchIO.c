@@ -0,0 +1,299 @@
+// Copyright (C) 2012, Steffen Knollmann
+// Released under the terms of the GNU General Public License version 3.
+// This file is part of `ginnungagap'.
+
+
+/*--- Doxygen file description ------------------------------------------*/
+
+/**
+ * @file bench/benchIO.c
+ * @ingroup  bench
+ * @brief  Times reading and writing of grafic, HDF5 and Gadget files.
+ *
+ * The grid files are written and read through the writer and reader
+ * factories, using a small ini file placed in the work directory.  For
+ * Gadget every rank writes and reads its own file with the positions,
+ * velocities and IDs of @c dim1D^3 / ranks particles.  All files are
+ * removed at the end.
+ */
+
+
+/*--- Includes ----------------------------------------------------------*/
+#include "../config.h"
+#include "bench.h"
+#include "benchUtil.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <inttypes.h>
+#ifdef WITH_MPI
+#  include <mpi.h>
+#endif
+#ifdef WITH_HDF5
+#  include <hdf5.h>
+#endif
+#include "../src/libutil/xmem.h"
+#include "../src/libutil/xstring.h"
+#include "../src/libutil/xfile.h"
+#include "../src/libutil/filename.h"
+#include "../src/libutil/parse_ini.h"
+#include "../src/libutil/gadget.h"
+#include "../src/libutil/stai.h"
+#include "../src/libgrid/gridRegular.h"
+#include "../src/libgrid/gridRegularDistrib.h"
+#include "../src/libgrid/gridPatch.h"
+#include "../src/libgrid/gridWriter.h"
+#include "../src/libgrid/gridWriterFactory.h"
+#include "../src/libgrid/gridReader.h"
+#include "../src/libgrid/gridReaderFactory.h"
+
+
+/*--- Local defines -----------------------------------------------------*/
+#define THIS_PROGNAME "benchIO"
+
+
+/*--- Prototypes of local functions -------------------------------------*/
+static void
+local_benchGrid(bench_t bench, uint32_t dim1D, const char *type);
+
+static char *
+local_writeIni(bench_t bench, uint32_t dim1D, const char *type);
+
+static void
+local_benchGadget(bench_t bench, uint32_t dim1D);
+
+static gadget_t
+local_getGadgetWrite(const char *fileName, uint32_t np);
+
+static void
+local_barrier(void);
+
+
+/*--- M A I N -----------------------------------------------------------*/
+int
+main(int argc, char **argv)
+{
+	bench_t bench = bench_new(&argc, &argv, THIS_PROGNAME);
+
+	for (int i = 0; i < bench_getNumDims(bench); i++) {
+		uint32_t dim1D = bench_getDim(bench, i);
+		local_benchGrid(bench, dim1D, "grafic");
+#if defined(WITH_HDF5) && (!defined(WITH_MPI) || defined(H5_HAVE_PARALLEL))
+		local_benchGrid(bench, dim1D, "hdf5");
+#elif defined(WITH_HDF5)
+		bench_skip(bench, "hdf5Write", "requires parallel HDF5");
+		bench_skip(bench, "hdf5Read", "requires parallel HDF5");
+#else
+		bench_skip(bench, "hdf5Write", "requires HDF5");
+		bench_skip(bench, "hdf5Read", "requires HDF5");
+#endif
+		local_benchGadget(bench, dim1D);
+	}
+
+	bench_del(&bench);
+
+	return EXIT_SUCCESS;
+}
+
+/*--- Implementations of local functions --------------------------------*/
+static void
+local_benchGrid(bench_t bench, uint32_t dim1D, const char *type)
+{
+	gridRegularDistrib_t distrib;
+	gridRegular_t        grid;
+	gridWriter_t         writer;
+	gridReader_t         reader;
+	parse_ini_t          ini;
+	char                 *iniName, *kernel;
+	int                  nProcs[NDIM];
+	int                  idxOfVar;
+	uint64_t             numCells = benchUtil_getNumCells(dim1D);
+
+	bench_getNProcs(bench, nProcs);
+	grid     = benchUtil_newGrid(dim1D, 100., nProcs, &distrib);
+	idxOfVar = benchUtil_attachVar(grid, "field");
+	benchUtil_fillVar(grid, idxOfVar);
+
+	iniName  = local_writeIni(bench, dim1D, type);
+	ini      = parse_ini_open(iniName);
+
+	// A writer that has been active before appends to its file, every run
+	// hence uses a fresh one to truncate the file.
+	for (int i = 0; i < bench_getNumRuns(bench); i++) {
+		writer = gridWriterFactory_newWriterFromIni(ini, "Out");
+#ifdef WITH_MPI
+		gridWriter_initParallel(writer, MPI_COMM_WORLD);
+#endif
+		bench_start(bench);
+		gridWriter_activate(writer);
+		gridWriter_writeGridRegular(writer, grid);
+		gridWriter_deactivate(writer);
+		bench_stop(bench);
+		if (i < bench_getNumRuns(bench) - 1)
+			gridWriter_del(&writer);
+	}
+	kernel = xstrmerge(type, "Write");
+	bench_record(bench, kernel, dim1D, numCells);
+	xfree(kernel);
+
+	// The reader opens the file on creation, hence it must exist.
+	local_barrier();
+	reader = gridReaderFactory_newReaderFromIni(ini, "In");
+	for (int i = 0; i < bench_getNumRuns(bench); i++) {
+		bench_start(bench);
+		gridReader_readIntoPatchForVar(reader,
+		                               gridRegular_getPatchHandle(grid, 0),
+		                               idxOfVar);
+		bench_stop(bench);
+	}
+	kernel = xstrmerge(type, "Read");
+	bench_record(bench, kernel, dim1D, numCells);
+	xfree(kernel);
+	gridReader_del(&reader);
+
+	local_barrier();
+	if (bench_getRank(bench) == 0) {
+		remove(filename_getFullName(gridWriter_getFileName(writer)));
+		remove(iniName);
+	}
+	gridWriter_del(&writer);
+	parse_ini_close(&ini);
+	xfree(iniName);
+	gridRegularDistrib_del(&distrib);
+	gridRegular_del(&grid);
+} /* local_benchGrid */
+
+static char *
+local_writeIni(bench_t bench, uint32_t dim1D, const char *type)
+{
+	const char *workDir = bench_getWorkDir(bench);
+	char       *iniName = xstrmerge(workDir, "/benchIO.ini");
+
+	if (bench_getRank(bench) == 0) {
+		FILE *f = xfopen(iniName, "w");
+		for (int i = 0; i < 2; i++) {
+			fprintf(f, "[%s]\ntype = %s\npath = %s/\nprefix = benchIO_%s\n",
+			        (i == 0) ? "Out" : "In", type, workDir, type);
+			fprintf(f, "suffix = %s\noverwriteFileIfExists = true\n",
+			        (type[0] == 'g') ? ".grafic" : ".h5");
+			fprintf(f, "size = %" PRIu32 ", %" PRIu32 ", %" PRIu32 "\n",
+			        dim1D, dim1D, dim1D);
+			fprintf(f, "isWhiteNoise = true\niseed = 1\n\n");
+		}
+		xfclose(&f);
+	}
+	local_barrier();
+
+	return iniName;
+}
+
+static void
+local_benchGadget(bench_t bench, uint32_t dim1D)
+{
+	uint64_t np = benchUtil_getNumCells(dim1D) / bench_getNumRanks(bench);
+	float    *pos, *vel;
+	uint32_t *id;
+	char     *fileName, *tmp, rankStr[16];
+	gadget_t gadget;
+	stai_t   stai;
+
+	pos = xmalloc(sizeof(float) * np * 3);
+	vel = xmalloc(sizeof(float) * np * 3);
+	id  = xmalloc(sizeof(uint32_t) * np);
+	for (uint64_t i = 0; i < np; i++) {
+		for (int j = 0; j < 3; j++) {
+			pos[i * 3 + j] = (float)((i + j) % 1000);
+			vel[i * 3 + j] = (float)((i * 7 + j) % 1000);
+		}
+		id[i] = (uint32_t)i;
+	}
+
+	tmp = xstrmerge(bench_getWorkDir(bench), "/benchIO_gadget.");
+	sprintf(rankStr, "%i", bench_getRank(bench));
+	fileName = xstrmerge(tmp, rankStr);
+	xfree(tmp);
+
+	for (int i = 0; i < bench_getNumRuns(bench); i++) {
+		gadget = local_getGadgetWrite(fileName, (uint32_t)np);
+		bench_start(bench);
+		gadget_createEmptyFile(gadget, 0);
+		gadget_open(gadget, GADGET_MODE_WRITE_CONT, 0);
+		gadget_writeHeaderToCurrentFile(gadget);
+		stai = stai_new(pos, 3 * sizeof(float), 3 * sizeof(float));
+		gadget_writeBlockToCurrentFile(gadget, GADGETBLOCK_POS_, 0, np, stai);
+		stai_del(&stai);
+		stai = stai_new(vel, 3 * sizeof(float), 3 * sizeof(float));
+		gadget_writeBlockToCurrentFile(gadget, GADGETBLOCK_VEL_, 0, np, stai);
+		stai_del(&stai);
+		stai = stai_new(id, sizeof(uint32_t), sizeof(uint32_t));
+		gadget_writeBlockToCurrentFile(gadget, GADGETBLOCK_ID__, 0, np, stai);
+		stai_del(&stai);
+		gadget_close(gadget);
+		bench_stop(bench);
+		gadget_del(&gadget);
+	}
+	bench_record(bench, "gadgetWrite", dim1D, np * bench_getNumRanks(bench));
+
+	for (int i = 0; i < bench_getNumRuns(bench); i++) {
+		bench_start(bench);
+		gadget = gadget_newSimple(fileName, 1);
+		gadget_initForRead(gadget);
+		gadget_open(gadget, GADGET_MODE_READ, 0);
+		stai = stai_new(pos, 3 * sizeof(float), 3 * sizeof(float));
+		gadget_readBlockFromCurrentFile(gadget, GADGETBLOCK_POS_, 0, np, stai);
+		stai_del(&stai);
+		stai = stai_new(vel, 3 * sizeof(float), 3 * sizeof(float));
+		gadget_readBlockFromCurrentFile(gadget, GADGETBLOCK_VEL_, 0, np, stai);
+		stai_del(&stai);
+		stai = stai_new(id, sizeof(uint32_t), sizeof(uint32_t));
+		gadget_readBlockFromCurrentFile(gadget, GADGETBLOCK_ID__, 0, np, stai);
+		stai_del(&stai);
+		gadget_close(gadget);
+		bench_stop(bench);
+		gadget_del(&gadget);
+	}
+	bench_record(bench, "gadgetRead", dim1D, np * bench_getNumRanks(bench));
+
+	remove(fileName);
+	xfree(fileName);
+	xfree(id);
+	xfree(vel);
+	xfree(pos);
+} /* local_benchGadget */
+
+static gadget_t
+local_getGadgetWrite(const char *fileName, uint32_t np)
+{
+	gadget_t       gadget     = gadget_newSimple(fileName, 1);
+	uint32_t       nps[6]     = {0, np, 0, 0, 0, 0};
+	uint64_t       nall[6]    = {0, np, 0, 0, 0, 0};
+	double         massarr[6] = {0.0, 1.0, 0.0, 0.0, 0.0, 0.0};
+	gadgetHeader_t header     = gadgetHeader_new();
+	gadgetTOC_t    toc        = gadgetTOC_new();
+
+	gadgetHeader_setNp(header, nps);
+	gadgetHeader_setMassArr(header, massarr);
+	gadgetHeader_setNall(header, nall);
+	gadgetHeader_setNumFiles(header, 1);
+	gadget_setHeaderOfFile(gadget, 0, header);
+
+	gadgetTOC_setFileVersion(toc, gadget_getFileVersion(gadget));
+	gadgetTOC_addEntryByType(toc, GADGETBLOCK_HEAD);
+	gadgetTOC_addEntryByType(toc, GADGETBLOCK_POS_);
+	gadgetTOC_addEntryByType(toc, GADGETBLOCK_VEL_);
+	gadgetTOC_addEntryByType(toc, GADGETBLOCK_ID__);
+	gadgetTOC_calcSizes(toc, nps, massarr,
+	                    gadgetHeader_getFlagDoublePrecision(header),
+	                    gadgetHeader_getUseLongIDs(header));
+	gadgetTOC_calcOffset(toc);
+	gadget_setTOCOfFile(gadget, 0, toc);
+
+	return gadget;
+}
+
+static void
+local_barrier(void)
+{
+#ifdef WITH_MPI
+	MPI_Barrier(MPI_COMM_WORLD);
+#endif
+}
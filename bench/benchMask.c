@@ -0,0 +1,145 @@
+// Copyright (C) 2012, Steffen Knollmann
+// Released under the terms of the GNU General Public License version 3.
+// This file is part of `ginnungagap'.
+
+
+/*--- Doxygen file description ------------------------------------------*/
+
+/**
+ * @file bench/benchMask.c
+ * @ingroup  bench
+ * @brief  Times the creation of zoom masks.
+ *
+ * The mask has @c dim1D cells per dimension (which must be a power of
+ * two), the hierarchy extends two levels below and above the mask level.
+ * The cells within a sphere with a radius of an eighth of the box are
+ * tagged.  Every rank creates the full mask.
+ */
+
+
+/*--- Includes ----------------------------------------------------------*/
+#include "../config.h"
+#include "bench.h"
+#include "benchUtil.h"
+#include <stdlib.h>
+#include "../src/libutil/xmem.h"
+#include "../src/libgrid/gridPoint.h"
+#include "../src/libg9p/g9pHierarchy.h"
+#include "../src/libg9p/g9pMask.h"
+#include "../src/libg9p/g9pMaskCreator.h"
+
+
+/*--- Local defines -----------------------------------------------------*/
+#define THIS_PROGNAME "benchMask"
+
+
+/*--- Prototypes of local functions -------------------------------------*/
+static void
+local_benchMask(bench_t bench, uint32_t dim1D);
+
+static g9pMask_t
+local_newMask(uint8_t maskLevel);
+
+static gridPointUint32_t *
+local_getSphere(uint32_t dim1D, uint64_t *numCells);
+
+
+/*--- M A I N -----------------------------------------------------------*/
+int
+main(int argc, char **argv)
+{
+	bench_t bench = bench_new(&argc, &argv, THIS_PROGNAME);
+
+	for (int i = 0; i < bench_getNumDims(bench); i++)
+		local_benchMask(bench, bench_getDim(bench, i));
+
+	bench_del(&bench);
+
+	return EXIT_SUCCESS;
+}
+
+/*--- Implementations of local functions --------------------------------*/
+static void
+local_benchMask(bench_t bench, uint32_t dim1D)
+{
+	uint8_t           maskLevel = 0;
+	uint64_t          numCells;
+	gridPointUint32_t *cells;
+	g9pMask_t         mask;
+
+	// The hierarchy starts at 2 cells per dimension.
+	while ((UINT32_C(2) << maskLevel) < dim1D)
+		maskLevel++;
+	if ((UINT32_C(2) << maskLevel) != dim1D) {
+		bench_skip(bench, "newTiledMask", "dim1D must be a power of two");
+		bench_skip(bench, "fromCells", "dim1D must be a power of two");
+		return;
+	}
+
+	for (int i = 0; i < bench_getNumRuns(bench); i++) {
+		bench_start(bench);
+		mask = local_newMask(maskLevel);
+		bench_stop(bench);
+		g9pMask_del(&mask);
+	}
+	bench_record(bench, "newTiledMask", dim1D,
+	             benchUtil_getNumCells(dim1D));
+
+	cells = local_getSphere(dim1D, &numCells);
+	for (int i = 0; i < bench_getNumRuns(bench); i++) {
+		mask = local_newMask(maskLevel);
+		bench_start(bench);
+		g9pMaskCreator_fromCells(mask, numCells,
+		                         (const gridPointUint32_t *)cells);
+		bench_stop(bench);
+		g9pMask_del(&mask);
+	}
+	bench_record(bench, "fromCells", dim1D, numCells);
+	xfree(cells);
+} /* local_benchMask */
+
+static g9pMask_t
+local_newMask(uint8_t maskLevel)
+{
+	uint8_t        minLevel  = (maskLevel > 2) ? maskLevel - 2 : 0;
+	uint8_t        maxLevel  = maskLevel + 2;
+	g9pHierarchy_t hierarchy = g9pHierarchy_newWithSimpleFactor(maxLevel + 1,
+	                                                             2, 2);
+
+	return g9pMask_newMinMaxTiledMask(hierarchy, maskLevel, minLevel,
+	                                  maxLevel, 0);
+}
+
+static gridPointUint32_t *
+local_getSphere(uint32_t dim1D, uint64_t *numCells)
+{
+	gridPointUint32_t *cells;
+	int64_t           c    = dim1D / 2;
+	int64_t           r    = dim1D / 8;
+	int64_t           kMax = (NDIM > 2) ? r : 0;
+	uint64_t          n    = 0;
+	uint64_t          nMax = 1;
+
+	for (int i = 0; i < NDIM; i++)
+		nMax *= 2 * r + 1;
+	cells = xmalloc(sizeof(gridPointUint32_t) * nMax);
+
+	for (int64_t k = -kMax; k <= kMax; k++) {
+		for (int64_t j = -r; j <= r; j++) {
+			for (int64_t i = -r; i <= r; i++) {
+				if (i * i + j * j + k * k > r * r)
+					continue;
+				cells[n][0] = (uint32_t)(c + i);
+				cells[n][1] = (uint32_t)(c + j);
+#if (NDIM > 2)
+				cells[n][2] = (uint32_t)(c + k);
+#endif
+				n++;
+			}
+		}
+	}
+
+	*numCells = n;
+
+	return cells;
+}
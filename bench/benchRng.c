@@ -0,0 +1,142 @@
+// Copyright (C) 2012, Steffen Knollmann
+// Released under the terms of the GNU General Public License version 3.
+// This file is part of `ginnungagap'.
+
+
+/*--- Doxygen file description ------------------------------------------*/
+
+/**
+ * @file bench/benchRng.c
+ * @ingroup  bench
+ * @brief  Times the generation of Gaussian random numbers.
+ *
+ * Every rank generates its share of @c dim1D^3 numbers, using one stream
+ * per thread for the stream based generators.
+ */
+
+
+/*--- Includes ----------------------------------------------------------*/
+#include "../config.h"
+#include "bench.h"
+#include "benchUtil.h"
+#include <stdlib.h>
+#ifdef WITH_OPENMP
+#  include <omp.h>
+#endif
+#include "../src/libutil/xmem.h"
+#include "../src/libutil/rng.h"
+
+
+/*--- Local defines -----------------------------------------------------*/
+#define THIS_PROGNAME "benchRng"
+#define LOCAL_SEED 1234
+
+
+/*--- Prototypes of local functions -------------------------------------*/
+static void
+local_benchRng(bench_t bench, uint32_t dim1D);
+
+#ifdef WITH_SPRNG
+static void
+local_fillStreams(rng_t rng, fpv_t *data, uint64_t n, bool doBatched);
+
+#endif
+
+
+/*--- M A I N -----------------------------------------------------------*/
+int
+main(int argc, char **argv)
+{
+	bench_t bench = bench_new(&argc, &argv, THIS_PROGNAME);
+
+	for (int i = 0; i < bench_getNumDims(bench); i++)
+		local_benchRng(bench, bench_getDim(bench, i));
+
+	bench_del(&bench);
+
+	return EXIT_SUCCESS;
+}
+
+/*--- Implementations of local functions --------------------------------*/
+static void
+local_benchRng(bench_t bench, uint32_t dim1D)
+{
+	int      numThreads = 1;
+	uint64_t n;
+	uint64_t offset;
+	fpv_t    *data;
+	rng_t    rng;
+
+#ifdef WITH_OPENMP
+	numThreads = omp_get_max_threads();
+#endif
+	n      = benchUtil_getNumCells(dim1D) / bench_getNumRanks(bench);
+	offset = n * bench_getRank(bench);
+	data   = xmalloc(sizeof(fpv_t) * n);
+	rng    = rng_new(0, numThreads * bench_getNumRanks(bench), LOCAL_SEED);
+
+	for (int i = 0; i < bench_getNumRuns(bench); i++) {
+		bench_start(bench);
+#ifdef WITH_OPENMP
+#  pragma omp parallel for
+#endif
+		for (uint64_t j = 0; j < n; j++)
+			data[j] = (fpv_t)rng_getGaussUnitAtIndex(rng, offset + j);
+		bench_stop(bench);
+	}
+	bench_record(bench, "gaussAtIndex", dim1D,
+	             n * bench_getNumRanks(bench));
+
+#ifdef WITH_SPRNG
+	for (int i = 0; i < bench_getNumRuns(bench); i++) {
+		rng_reset(rng);
+		bench_start(bench);
+		local_fillStreams(rng, data, n, false);
+		bench_stop(bench);
+	}
+	bench_record(bench, "gaussUnit", dim1D, n * bench_getNumRanks(bench));
+
+	for (int i = 0; i < bench_getNumRuns(bench); i++) {
+		rng_reset(rng);
+		bench_start(bench);
+		local_fillStreams(rng, data, n, true);
+		bench_stop(bench);
+	}
+	bench_record(bench, "fillGaussUnit", dim1D,
+	             n * bench_getNumRanks(bench));
+#else
+	bench_skip(bench, "gaussUnit", "requires SPRNG");
+	bench_skip(bench, "fillGaussUnit", "requires SPRNG");
+#endif
+
+	rng_del(&rng);
+	xfree(data);
+} /* local_benchRng */
+
+#ifdef WITH_SPRNG
+static void
+local_fillStreams(rng_t rng, fpv_t *data, uint64_t n, bool doBatched)
+{
+#  ifdef WITH_OPENMP
+#    pragma omp parallel
+#  endif
+	{
+		int      stream     = 0;
+		int      numStreams = 1;
+		uint64_t lo, hi;
+#  ifdef WITH_OPENMP
+		stream     = omp_get_thread_num();
+		numStreams = omp_get_num_threads();
+#  endif
+		lo = n * stream / numStreams;
+		hi = n * (stream + 1) / numStreams;
+		if (doBatched) {
+			rng_fillGaussUnit(rng, stream, data + lo, hi - lo);
+		} else {
+			for (uint64_t j = lo; j < hi; j++)
+				data[j] = (fpv_t)rng_getGaussUnit(rng, stream);
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,137 @@
+// Copyright (C) 2012, Steffen Knollmann
+// Released under the terms of the GNU General Public License version 3.
+// This file is part of `ginnungagap'.
+
+
+/*--- Doxygen file description ------------------------------------------*/
+
+/**
+ * @file bench/benchUtil.c
+ * @ingroup  bench
+ * @brief  Implements the helpers to set up the grids.
+ */
+
+
+/*--- Includes ----------------------------------------------------------*/
+#include "benchUtil.h"
+#include <assert.h>
+#ifdef WITH_MPI
+#  include <mpi.h>
+#endif
+#ifdef WITH_FFT_FFTW3
+#  include <complex.h>
+#  include <fftw3.h>
+#endif
+#include "../src/libgrid/gridPatch.h"
+#include "../src/libdata/dataVar.h"
+#include "../src/libdata/dataVarType.h"
+
+
+/*--- Implementations of exported functions -----------------------------*/
+extern gridRegular_t
+benchUtil_newGrid(uint32_t             dim1D,
+                  double               boxsizeInMpch,
+                  const int            *nProcs,
+                  gridRegularDistrib_t *distrib)
+{
+	gridRegular_t     grid;
+	gridPointDbl_t    origin;
+	gridPointDbl_t    extent;
+	gridPointUint32_t dims;
+	int               localRank = 0;
+
+	assert(distrib != NULL);
+
+	for (int i = 0; i < NDIM; i++) {
+		origin[i] = 0.0;
+		extent[i] = boxsizeInMpch;
+		dims[i]   = dim1D;
+	}
+	grid     = gridRegular_new("bench", origin, extent, dims);
+
+	*distrib = gridRegularDistrib_new(grid, NULL);
+#ifdef WITH_MPI
+	{
+		int tmp[NDIM];
+		for (int i = 0; i < NDIM; i++)
+			tmp[i] = nProcs[i];
+		gridRegularDistrib_initMPI(*distrib, tmp, MPI_COMM_WORLD);
+	}
+	localRank = gridRegularDistrib_getLocalRank(*distrib);
+#else
+	(void)nProcs;
+#endif
+	gridRegular_attachPatch(grid,
+	                        gridRegularDistrib_getPatchForRank(*distrib,
+	                                                           localRank));
+
+	return grid;
+}
+
+extern int
+benchUtil_attachVar(gridRegular_t grid, const char *name)
+{
+	dataVar_t var;
+
+	assert(grid != NULL);
+	assert(name != NULL);
+
+	var = dataVar_new(name, DATAVARTYPE_FPV, 1);
+#ifdef WITH_FFT_FFTW3
+	if (dataVarType_isNativeFloat(DATAVARTYPE_FPV))
+		dataVar_setMemFuncs(var, &fftwf_malloc, &fftwf_free);
+	else
+		dataVar_setMemFuncs(var, &fftw_malloc, &fftw_free);
+#endif
+
+	return gridRegular_attachVar(grid, var);
+}
+
+extern void
+benchUtil_fillVar(gridRegular_t grid, int idxOfVar)
+{
+	gridPatch_t patch;
+	fpv_t       *data;
+	uint64_t    numCells;
+
+	assert(grid != NULL);
+
+	patch    = gridRegular_getPatchHandle(grid, 0);
+	data     = gridPatch_getVarDataHandle(patch, idxOfVar);
+	numCells = gridPatch_getNumCellsActual(patch, idxOfVar);
+
+#ifdef WITH_OPENMP
+#  pragma omp parallel for
+#endif
+	for (uint64_t i = 0; i < numCells; i++) {
+		uint32_t h = (uint32_t)(i * UINT64_C(2654435761));
+		data[i] = (fpv_t)((h >> 8) * (1.0 / 8388608.0) - 1.0);
+	}
+}
+
+extern uint64_t
+benchUtil_getNumCells(uint32_t dim1D)
+{
+	uint64_t numCells = 1;
+
+	for (int i = 0; i < NDIM; i++)
+		numCells *= dim1D;
+
+	return numCells;
+}
+
+extern cosmoModel_t
+benchUtil_newModel(void)
+{
+	cosmoModel_t model = cosmoModel_new();
+
+	cosmoModel_setOmegaRad0(model, 0.0);
+	cosmoModel_setOmegaLambda0(model, 0.73);
+	cosmoModel_setOmegaMatter0(model, 0.27);
+	cosmoModel_setOmegaBaryon0(model, 0.045);
+	cosmoModel_setSmallH(model, 0.7);
+	cosmoModel_setSigma8(model, 0.8);
+	cosmoModel_setNs(model, 0.96);
+
+	return model;
+}
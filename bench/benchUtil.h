@@ -0,0 +1,110 @@
+// Copyright (C) 2012, Steffen Knollmann
+// Released under the terms of the GNU General Public License version 3.
+// This file is part of `ginnungagap'.
+
+#ifndef BENCHUTIL_H
+#define BENCHUTIL_H
+
+
+/*--- Doxygen file description ------------------------------------------*/
+
+/**
+ * @file bench/benchUtil.h
+ * @ingroup  bench
+ * @brief  Provides helpers to set up the grids used by the drivers.
+ */
+
+
+/*--- Includes ----------------------------------------------------------*/
+#include "../config.h"
+#include <stdint.h>
+#include "../src/libgrid/gridRegular.h"
+#include "../src/libgrid/gridRegularDistrib.h"
+#include "../src/libcosmo/cosmoModel.h"
+
+
+/*--- Prototypes of exported functions ----------------------------------*/
+
+/**
+ * @brief  Creates a distributed grid and attaches the local patch.
+ *
+ * The grid is set up like in ginnungagap, i.e. a cube of the given size
+ * with the origin at 0, distributed over all ranks according to the
+ * process grid.
+ *
+ * @param[in]   dim1D
+ *                 The number of cells per dimension.
+ * @param[in]   boxsizeInMpch
+ *                 The extent of the grid.
+ * @param[in]   *nProcs
+ *                 The process grid, see gridRegularDistrib_initMPI().
+ *                 Ignored without MPI.
+ * @param[out]  *distrib
+ *                 Receives the new distribution of the grid.
+ *
+ * @return  Returns the new grid.
+ */
+extern gridRegular_t
+benchUtil_newGrid(uint32_t             dim1D,
+                  double               boxsizeInMpch,
+                  const int            *nProcs,
+                  gridRegularDistrib_t *distrib);
+
+
+/**
+ * @brief  Attaches a native floating point variable to the grid.
+ *
+ * The memory of the variable is managed by FFTW (if available) to allow
+ * for aligned transforms.
+ *
+ * @param[in,out]  grid
+ *                    The grid to attach the variable to.
+ * @param[in]      *name
+ *                    The name of the variable.
+ *
+ * @return  Returns the index of the new variable.
+ */
+extern int
+benchUtil_attachVar(gridRegular_t grid, const char *name);
+
+
+/**
+ * @brief  Fills a real space variable of the local patch with numbers
+ *         uniformly distributed in [-1, 1).
+ *
+ * The numbers come from a cheap hash of the index, they are only meant
+ * to keep the kernels away from trivial data.
+ *
+ * @param[in,out]  grid
+ *                    The grid to work with.
+ * @param[in]      idxOfVar
+ *                    The variable to fill.
+ *
+ * @return  Returns nothing.
+ */
+extern void
+benchUtil_fillVar(gridRegular_t grid, int idxOfVar);
+
+
+/**
+ * @brief  Gets the number of cells of the full grid.
+ *
+ * @param[in]  dim1D
+ *                The number of cells per dimension.
+ *
+ * @return  Returns @c dim1D to the power of #NDIM.
+ */
+extern uint64_t
+benchUtil_getNumCells(uint32_t dim1D);
+
+
+/**
+ * @brief  Creates the cosmological model used by the drivers.
+ *
+ * @return  Returns a new model with WMAP-like parameters.
+ */
+extern cosmoModel_t
+benchUtil_newModel(void);
+
+
+#endif
@@ -0,0 +1,502 @@
+#!/bin/bash
+
+# Copyright (C) 2012, Steffen Knollmann
+# Released under the terms of the GNU General Public License version 3.
+# This file is part of `ginnungagap'.
+
+# Runs the chain ginnungagap -> realSpaceConstraints -> refineGrid ->
+# generateICs for a series of grid sizes, MPI process counts and thread
+# counts and turns the profiles of the stages into parallel efficiency
+# tables.  All inputs are synthetic: the power spectrum is computed from
+# the Eisenstein & Hu transfer function and the white noise comes from
+# the RNG, so nothing but the binaries is needed.
+
+set -e
+
+scriptName=$(basename $0)
+topDir=$(cd $(dirname $0)/.. && pwd)
+
+# Defaults
+dims="32 64"
+ranks="1 2 4"
+threads="1"
+stages="ginnungagap realSpaceConstraints refineGrid generateICs"
+nProcs="1 0 0"
+cellSize=1.0
+workDir=./scaling
+binDir=
+mpiRun=${MPIRUN:-mpirun -np}
+keepData=false
+dryRun=false
+
+function usage ()
+{
+	cat <<EOF
+Usage: $scriptName [options]
+
+Options:
+  -d "<dims>"     Grid sizes (cells per dimension) of ginnungagap,
+                  realSpaceConstraints and refineGrid produce twice this.
+                  Default: "$dims"
+  -r "<ranks>"    Numbers of MPI processes.  Default: "$ranks"
+  -t "<threads>"  Numbers of OpenMP threads per process.  Default: "$threads"
+  -s "<stages>"   Stages to run.  Default: "$stages"
+  -p "<nProcs>"   Process grid handed to ginnungagap.  Default: "$nProcs"
+  -c <cellSize>   Cell size in Mpc/h, the box grows with the grid.
+                  Default: $cellSize
+  -w <dir>        Working directory.  Default: $workDir
+  -b <dir>        Directory holding the binaries.  Default: the build tree.
+  -m "<cmd>"      MPI launcher, the number of ranks is appended.
+                  Default: "$mpiRun" (or \$MPIRUN)
+  -k              Keep the grid and particle files of every run.
+  -n              Only write the ini files, do not run anything.
+  -h              Show this help.
+
+Every run is done in <dir>/N<dim>_r<ranks>_t<threads>.  The wall clock
+times of all stages are collected in <dir>/results.dat and the tables
+are written to <dir>/tables.txt.
+EOF
+}
+
+while getopts "d:r:t:s:p:c:w:b:m:knh" opt
+do
+	case $opt in
+		d) dims=$OPTARG ;;
+		r) ranks=$OPTARG ;;
+		t) threads=$OPTARG ;;
+		s) stages=$OPTARG ;;
+		p) nProcs=$OPTARG ;;
+		c) cellSize=$OPTARG ;;
+		w) workDir=$OPTARG ;;
+		b) binDir=$OPTARG ;;
+		m) mpiRun=$OPTARG ;;
+		k) keepData=true ;;
+		n) dryRun=true ;;
+		h) usage ; exit 0 ;;
+		*) usage ; exit 1 ;;
+	esac
+done
+
+
+###########################################################################
+# Helpers
+
+function getBinary ()
+{
+	local name=$1
+
+	if [[ -n $binDir ]]
+	then
+		echo $binDir/$name
+	elif [[ $name == ginnungagap ]]
+	then
+		echo $topDir/src/ginnungagap/ginnungagap
+	else
+		echo $topDir/tools/$name/$name
+	fi
+}
+
+# Checks whether a binary has been compiled with a given feature, by
+# looking at the list of features in use of its version output.
+function hasFeature ()
+{
+	$(getBinary $1) --version 2>/dev/null \
+		| sed -n '/features in use/,/features NOT in use/p' \
+		| grep -q "\<$2\>"
+}
+
+function log2 ()
+{
+	local n=$1 l=0
+
+	while (( n > 1 ))
+	do
+		n=$(( n / 2 ))
+		l=$(( l + 1 ))
+	done
+	echo $l
+}
+
+function calc ()
+{
+	awk "BEGIN {printf \"%.10g\", $1}"
+}
+
+
+###########################################################################
+# Ini file creators, they expect dim, box, rank to be set.
+
+function cosmologySection ()
+{
+	cat <<EOF
+[Cosmology]
+modelOmegaRad0 = 0.0
+modelOmegaLambda0 = 0.73
+modelOmegaMatter0 = 0.27
+modelOmegaBaryon0 = 0.045
+modelHubble = 0.7
+modelSigma8 = 0.8
+modelNs = 0.96
+powerSpectrumKmin = 1e-5
+powerSpectrumKmax = 1e4
+powerSpectrumNumPoints = 501
+transferFunctionType = EisensteinHu1998
+EOF
+}
+
+function graficSection ()
+{
+	cat <<EOF
+size = $1, $1, $1
+dx = $(calc "$box / $1")
+astart = 0.02
+omegam = 0.27
+omegav = 0.73
+h0 = 70
+EOF
+}
+
+function ginnungagapCreator ()
+{
+	cat <<EOF
+[Ginnungagap]
+dim1D = $dim
+boxsizeInMpch = $box
+zInit = 49.0
+normalisationMode = sigma8
+gridName = scaling
+profilePrefix = prof_ginnungagap
+
+[Output]
+type = grafic
+prefix = g9p
+overwriteFileIfExists = true
+writerSection = OutputGrafic
+
+[OutputGrafic]
+isWhiteNoise = false
+$(graficSection $dim)
+
+[WhiteNoise]
+useFile = false
+useKSpace = true
+dumpWhiteNoise = false
+rngSectionName = rng
+
+[rng]
+generator = 4
+numStreamsTotal = 256
+randomSeed = 1
+
+[MPI]
+nProcs = $nProcs
+
+$(cosmologySection)
+EOF
+}
+
+function realSpaceConstraintsCreator ()
+{
+	cat <<EOF
+[Setup]
+boxsizeInMpch = $box
+inputDim1D = $dim
+outputDim1D = $(( 2 * dim ))
+useFileForInput = false
+writerInSecName = inputWriter
+writerSecName = outputWriter
+seedIn = 123
+seedOut = 6553
+profilePrefix = prof_realSpaceConstraints
+
+[inputWriter]
+type = grafic
+prefix = wn_$dim
+overwriteFileIfExists = true
+isWhiteNoise = true
+size = $dim, $dim, $dim
+iseed = 123
+
+[outputWriter]
+type = grafic
+prefix = wn_$(( 2 * dim ))
+overwriteFileIfExists = true
+isWhiteNoise = true
+size = $(( 2 * dim )), $(( 2 * dim )), $(( 2 * dim ))
+iseed = 6553
+EOF
+}
+
+function refineGridCreator ()
+{
+	cat <<EOF
+[Setup]
+boxsizeInMpch = $box
+inputDim1D = $dim
+outputDim1D = $(( 2 * dim ))
+readerSecName = inputReader
+writerSecName = outputWriter
+varName = velx
+addFields = false
+profilePrefix = prof_refineGrid
+
+[inputReader]
+type = grafic
+prefix = g9p_velx
+
+[outputWriter]
+type = grafic
+prefix = refine_velx
+overwriteFileIfExists = true
+$(graficSection $(( 2 * dim )))
+EOF
+}
+
+function generateICsCreator ()
+{
+	local level=$(log2 $dim)
+	local tileLevel=1 numFiles=$rank
+
+	# Every process writes one file, which needs at least as many tiles.
+	if (( numFiles > 8 ))
+	then
+		tileLevel=$(( ($(log2 $(( numFiles - 1 ))) + 3) / 3 ))
+	fi
+	if (( tileLevel > level ))
+	then
+		tileLevel=$level
+	fi
+
+	cat <<EOF
+[Ginnungagap]
+dim1D = $dim
+boxsizeInMpch = $box
+zInit = 49.0
+
+[GenerateICs]
+ginnungagapSection = Ginnungagap
+doGas = false
+doLongIDs = false
+sequentialIDs = false
+inputSection = GenicsInput
+outputSection = GenicsOutput
+cosmologySection = Cosmology
+maskSection = Mask
+hierarchySection = Hierarchy
+zoomLevel = $level
+typeForLevel$level = 1
+profilePrefix = prof_generateICs
+
+[Mask]
+maskLevel = $level
+minLevel = $level
+maxLevel = $level
+tileLevel = $tileLevel
+
+[Hierarchy]
+numLevels = $(( level + 1 ))
+minDim1D = 1
+factor = 2
+
+[GenicsInput]
+velxSection = GenicsInput_velx
+velySection = GenicsInput_vely
+velzSection = GenicsInput_velz
+
+[GenicsInput_velx]
+type = grafic
+prefix = g9p_velx
+
+[GenicsInput_vely]
+type = grafic
+prefix = g9p_vely
+
+[GenicsInput_velz]
+type = grafic
+prefix = g9p_velz
+
+[GenicsOutput]
+numFilesForLevel$level = $numFiles
+prefix = genics
+
+$(cosmologySection)
+EOF
+}
+
+
+###########################################################################
+# Running
+
+# Sums the maximum time over all ranks of the outermost regions of a
+# profile, i.e. the time the stage spent in profiled code.
+function profileTime ()
+{
+	awk -F'[:,]' '/"depth": 0/ {
+		for (i = 1; i <= NF; i++)
+			if ($i ~ /"max"/)
+				sum += $(i + 1)
+	} END {printf "%.6e", sum}' $1
+}
+
+function runStage ()
+{
+	local stage=$1 binary start stop
+
+	binary=$(getBinary $stage)
+	${stage}Creator > $stage.ini
+	if $dryRun
+	then
+		return
+	fi
+
+	# The exit status is not reliable under some MPI launchers (the tools
+	# finalise MPI from an exit handler), a run counts as successful if it
+	# wrote its profile.
+	rm -f prof_$stage.json
+	start=$(date +%s.%N)
+	if $withMPI
+	then
+		OMP_NUM_THREADS=$thread $mpiRun $rank $binary $stage.ini \
+			> $stage.log 2>&1 || true
+	else
+		OMP_NUM_THREADS=$thread $binary $stage.ini > $stage.log 2>&1 || true
+	fi
+	stop=$(date +%s.%N)
+	if [[ ! -e prof_$stage.json ]]
+	then
+		echo "$stage failed, see $(pwd)/$stage.log" >&2
+		exit 1
+	fi
+
+	printf "%6i %6i %8i %-22s %.6e %s\n" $dim $rank $thread $stage \
+		$(calc "$stop - $start") $(profileTime prof_$stage.json) \
+		>> ../results.dat
+}
+
+withMPI=false
+if hasFeature ginnungagap WITH_MPI
+then
+	withMPI=true
+fi
+
+runStages=
+for stage in $stages
+do
+	if [[ $stage == realSpaceConstraints ]] \
+	   && ! hasFeature $stage WITH_SPRNG
+	then
+		echo "Skipping $stage, it needs SPRNG to draw the white noise."
+		continue
+	fi
+	if ! $dryRun && [[ ! -x $(getBinary $stage) ]]
+	then
+		echo "Cannot find $(getBinary $stage), run make first." >&2
+		exit 1
+	fi
+	runStages="$runStages $stage"
+done
+
+mkdir -p $workDir
+cd $workDir
+if ! $dryRun
+then
+	printf "# %4s %6s %8s %-22s %-12s %s\n" dim ranks threads stage \
+		wall profiled > results.dat
+fi
+
+for dim in $dims
+do
+	box=$(calc "$dim * $cellSize")
+	for rank in $ranks
+	do
+		if ! $withMPI && (( rank > 1 ))
+		then
+			echo "Skipping $rank ranks, the binaries are built without MPI."
+			continue
+		fi
+		for thread in $threads
+		do
+			run=N${dim}_r${rank}_t${thread}
+			echo "Running $run"
+			mkdir -p $run
+			cd $run
+			for stage in $runStages
+			do
+				runStage $stage
+			done
+			if ! $keepData
+			then
+				rm -f g9p_* wn_* refine_* genics*
+			fi
+			cd ..
+		done
+	done
+done
+
+if $dryRun
+then
+	exit 0
+fi
+
+
+###########################################################################
+# Tables
+
+# Strong scaling compares the runs of the same size, weak scaling the runs
+# with the same number of cells per core.  The efficiency is relative to
+# the run with the fewest cores of the respective group and is based on
+# the profiled time, the wall clock time includes the start-up of the
+# launcher and the reading of the ini file.
+awk '
+	/^#/ {next}
+	{
+		key = $4 " " $1 " " $2 * $3
+		if (!(key in wall)) {
+			n++
+			dim[n] = $1; ranks[n] = $2; threads[n] = $3; stage[n] = $4
+			wall[key] = $5; prof[key] = $6
+		}
+	}
+	function table(title, groupOf, scale,     i, j, g, c, base) {
+		print title
+		printf "  %-22s %-12s %6s %6s %8s %12s %12s %8s %10s\n", \
+		       "stage", "group", "dim", "ranks", "threads", "wall", \
+		       "profiled", "speedup", "efficiency"
+		for (i = 1; i <= n; i++) {
+			g = stage[i] " " groupOf[i]
+			c = ranks[i] * threads[i]
+			if (!(g in baseCores) || c < baseCores[g]) {
+				baseCores[g] = c
+				baseTime[g]  = prof[stage[i] " " dim[i] " " c]
+			}
+			numInGroup[g]++
+		}
+		for (i = 1; i <= n; i++) {
+			g = stage[i] " " groupOf[i]
+			if (numInGroup[g] < 2)
+				continue
+			found = 1
+			c = ranks[i] * threads[i]
+			t = prof[stage[i] " " dim[i] " " c]
+			s = baseTime[g] / t
+			e = scale ? s * baseCores[g] / c : s
+			printf "  %-22s %-12s %6i %6i %8i %12.4e %12.4e %8.2f %9.1f%%\n", \
+			       stage[i], groupOf[i], dim[i], ranks[i], threads[i], \
+			       wall[stage[i] " " dim[i] " " c], t, s, 100. * e
+		}
+		if (!found)
+			print "  (no group with more than one run)"
+		print ""
+		found = 0
+		delete baseCores; delete baseTime; delete numInGroup
+	}
+	END {
+		for (i = 1; i <= n; i++) {
+			strong[i] = "N=" dim[i]
+			weak[i]   = sprintf("%.0f/core", \
+			                    dim[i]^3 / (ranks[i] * threads[i]))
+		}
+		table("Strong scaling (fixed size)", strong, 1)
+		table("Weak scaling (fixed cells per core)", weak, 0)
+	}
+' results.dat | tee tables.txt
@@ -0,0 +1,519 @@
+// Copyright (C) 2013, Steffen Knollmann
+// Released under the terms of the GNU General Public License version 3.
+// This file is part of `ginnungagap'.
+
+
+/*--- Doxygen file description ------------------------------------------*/
+
+/**
+ * @file g9pCheckpoint.c
+ * @ingroup  ginnungagapCheckpoint
+ * @brief  Provides the implementation of the checkpoints of ginnungagap.
+ */
+
+
+/*--- Includes ----------------------------------------------------------*/
+#include "g9pConfig.h"
+#include "g9pCheckpoint.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include <assert.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#ifdef WITH_MPI
+#  include <mpi.h>
+#endif
+#include "../libutil/xmem.h"
+#include "../libutil/xstring.h"
+#include "../libutil/xfile.h"
+
+
+/*--- Implemention of main structure ------------------------------------*/
+
+/** @brief  Describes one output file of a field. */
+struct local_file_struct {
+	/** @brief  The name of the file. */
+	char     *name;
+	/** @brief  The size of the file in bytes. */
+	uint64_t size;
+	/** @brief  The checksum of the file. */
+	uint64_t checksum;
+};
+
+/** @brief  Describes one completed field. */
+struct local_field_struct {
+	/** @brief  The name of the field. */
+	char                     *name;
+	/** @brief  The number of output files. */
+	int                      numFiles;
+	/** @brief  The output files. */
+	struct local_file_struct *files;
+};
+
+/** @brief  The main structure of a checkpoint. */
+struct g9pCheckpoint_struct {
+	/** @brief  The name of the checkpoint file. */
+	char                      *fileName;
+	/** @brief  The hash identifying the run. */
+	uint64_t                  runHash;
+	/** @brief  The number of completed fields. */
+	int                       numFields;
+	/** @brief  The completed fields, the same on all processes. */
+	struct local_field_struct *fields;
+	/** @brief  The MPI rank of this process. */
+	int                       rank; ///< Will be 0 for non-MPI situations.
+	/** @brief  The number of MPI processes. */
+	int                       size; ///< Will be 1 for non-MPI situations.
+};
+
+
+/*--- Local defines -----------------------------------------------------*/
+
+/** @brief  The offset basis of the 64bit FNV-1a hash. */
+#define LOCAL_HASH_INIT UINT64_C(14695981039346656037)
+
+/** @brief  The prime of the 64bit FNV-1a hash. */
+#define LOCAL_HASH_PRIME UINT64_C(1099511628211)
+
+/** @brief  The size of the blocks that are hashed separately. */
+#define LOCAL_BLOCK_SIZE (1L << 24)
+
+/** @brief  The first line of a checkpoint file. */
+#define LOCAL_MAGIC "# ginnungagap checkpoint 1"
+
+/** @brief  The section of the ini file that may differ between runs whose
+ *         fields do not depend on the layout. */
+#define LOCAL_IGNORED_SECTION "[MPI]"
+
+
+/*--- Prototypes of local functions -------------------------------------*/
+static uint64_t
+local_hashBytes(uint64_t hash, const void *data, size_t numBytes);
+
+static uint64_t
+local_hashUint64(uint64_t hash, uint64_t value);
+
+static uint64_t
+local_getRunHash(parse_ini_t ini, bool dependsOnLayout, int size);
+
+static void
+local_read(g9pCheckpoint_t checkpoint);
+
+static void
+local_write(const g9pCheckpoint_t checkpoint);
+
+static bool
+local_checksumFile(const g9pCheckpoint_t checkpoint,
+                   const char            *fileName,
+                   uint64_t              *size,
+                   uint64_t              *checksum);
+
+static struct local_field_struct *
+local_findField(const g9pCheckpoint_t checkpoint, const char *fieldName);
+
+static void
+local_clearField(struct local_field_struct *field);
+
+
+/*--- Implementations of exported functions -----------------------------*/
+extern g9pCheckpoint_t
+g9pCheckpoint_new(const char  *fileName,
+                  parse_ini_t ini,
+                  bool        dependsOnLayout)
+{
+	g9pCheckpoint_t checkpoint;
+
+	assert(fileName != NULL);
+	assert(ini != NULL);
+
+	checkpoint            = xmalloc(sizeof(struct g9pCheckpoint_struct));
+	checkpoint->fileName  = xstrdup(fileName);
+	checkpoint->numFields = 0;
+	checkpoint->fields    = NULL;
+	checkpoint->rank      = 0;
+	checkpoint->size      = 1;
+#ifdef WITH_MPI
+	MPI_Comm_rank(MPI_COMM_WORLD, &(checkpoint->rank));
+	MPI_Comm_size(MPI_COMM_WORLD, &(checkpoint->size));
+#endif
+	checkpoint->runHash   = local_getRunHash(ini, dependsOnLayout,
+	                                         checkpoint->size);
+
+	// The file is tiny, every process reads it itself.
+	local_read(checkpoint);
+#ifdef WITH_MPI
+	// Nobody may replace the file while the others still read it.
+	MPI_Barrier(MPI_COMM_WORLD);
+#endif
+
+	return checkpoint;
+}
+
+extern void
+g9pCheckpoint_del(g9pCheckpoint_t *checkpoint)
+{
+	assert(checkpoint != NULL && *checkpoint != NULL);
+
+	for (int i = 0; i < (*checkpoint)->numFields; i++)
+		local_clearField((*checkpoint)->fields + i);
+	if ((*checkpoint)->fields != NULL)
+		xfree((*checkpoint)->fields);
+	xfree((*checkpoint)->fileName);
+	xfree(*checkpoint);
+
+	*checkpoint = NULL;
+}
+
+extern bool
+g9pCheckpoint_isDone(g9pCheckpoint_t checkpoint, const char *fieldName)
+{
+	struct local_field_struct *field;
+
+	assert(checkpoint != NULL);
+	assert(fieldName != NULL);
+
+	field = local_findField(checkpoint, fieldName);
+	if (field == NULL)
+		return false;
+
+	for (int i = 0; i < field->numFiles; i++) {
+		uint64_t size, checksum;
+
+		if (!local_checksumFile(checkpoint, field->files[i].name,
+		                        &size, &checksum)
+		    || (size != field->files[i].size)
+		    || (checksum != field->files[i].checksum)) {
+			if (checkpoint->rank == 0)
+				printf("  %s is missing or has changed, redoing %s.\n",
+				       field->files[i].name, fieldName);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+extern void
+g9pCheckpoint_setDone(g9pCheckpoint_t checkpoint,
+                      const char      *fieldName,
+                      int             numFiles,
+                      const char      **fileNames)
+{
+	struct local_field_struct *field;
+	struct local_file_struct  *files = NULL;
+
+	assert(checkpoint != NULL);
+	assert(fieldName != NULL);
+	assert(numFiles >= 0);
+	assert(numFiles == 0 || fileNames != NULL);
+
+#ifdef WITH_MPI
+	// All processes must be done writing before the files are read back.
+	MPI_Barrier(MPI_COMM_WORLD);
+#endif
+
+	if (numFiles > 0)
+		files = xmalloc(sizeof(struct local_file_struct) * numFiles);
+	for (int i = 0; i < numFiles; i++) {
+		if (!local_checksumFile(checkpoint, fileNames[i],
+		                        &(files[i].size), &(files[i].checksum))) {
+			if (checkpoint->rank == 0)
+				fprintf(stderr, "WARNING:  Could not read %s, %s is not "
+				        "recorded in the checkpoint.\n", fileNames[i],
+				        fieldName);
+			for (int j = 0; j < i; j++)
+				xfree(files[j].name);
+			xfree(files);
+			return;
+		}
+		files[i].name = xstrdup(fileNames[i]);
+	}
+
+	field = local_findField(checkpoint, fieldName);
+	if (field == NULL) {
+		checkpoint->fields = xrealloc(checkpoint->fields,
+		                              sizeof(struct local_field_struct)
+		                              * (checkpoint->numFields + 1));
+		field       = checkpoint->fields + checkpoint->numFields;
+		field->name = xstrdup(fieldName);
+		checkpoint->numFields++;
+	} else {
+		char *name = field->name;
+
+		field->name = NULL;
+		local_clearField(field);
+		field->name = name;
+	}
+	field->numFiles = numFiles;
+	field->files    = files;
+
+	if (checkpoint->rank == 0)
+		local_write(checkpoint);
+}
+
+/*--- Implementations of local functions --------------------------------*/
+static uint64_t
+local_hashBytes(uint64_t hash, const void *data, size_t numBytes)
+{
+	const unsigned char *bytes = data;
+
+	for (size_t i = 0; i < numBytes; i++) {
+		hash ^= (uint64_t)(bytes[i]);
+		hash *= LOCAL_HASH_PRIME;
+	}
+
+	return hash;
+}
+
+static uint64_t
+local_hashUint64(uint64_t hash, uint64_t value)
+{
+	unsigned char bytes[8];
+
+	for (int i = 0; i < 8; i++)
+		bytes[i] = (unsigned char)((value >> (8 * i)) & 0xff);
+
+	return local_hashBytes(hash, bytes, 8);
+}
+
+static uint64_t
+local_getRunHash(parse_ini_t ini, bool dependsOnLayout, int size)
+{
+	FILE       *f;
+	char       line[1024];
+	uint64_t   hash           = LOCAL_HASH_INIT;
+	bool       isIgnored      = false;
+	const char *ignoredMark   = "# IGNORED:  ";
+	size_t     ignoredMarkLen = strlen(ignoredMark);
+
+	// The dump normalises the formatting of the ini file.
+	f = tmpfile();
+	if (f == NULL) {
+		fprintf(stderr, "FATAL:  Could not create a temporary file.\n");
+		exit(EXIT_FAILURE);
+	}
+	parse_ini_dump(ini, f);
+	rewind(f);
+
+	while (fgets(line, sizeof(line), f) != NULL) {
+		const char *content = line;
+
+		// Whether a key has been used depends on the order of the setup.
+		if (strncmp(content, ignoredMark, ignoredMarkLen) == 0)
+			content += ignoredMarkLen;
+		else if (content[0] == '#')
+			continue;
+
+		if ((content[0] == '[') && !dependsOnLayout)
+			isIgnored = (strncmp(content, LOCAL_IGNORED_SECTION,
+			                     strlen(LOCAL_IGNORED_SECTION)) == 0);
+		if (!isIgnored)
+			hash = local_hashBytes(hash, content, strlen(content));
+	}
+	fclose(f);
+
+	// The process grid may be chosen automatically, the section alone does
+	// not fix it.
+	if (dependsOnLayout)
+		hash = local_hashUint64(hash, (uint64_t)size);
+
+	return hash;
+}
+
+static void
+local_read(g9pCheckpoint_t checkpoint)
+{
+	FILE     *f;
+	char     line[1024];
+	char     name[1024];
+	uint64_t runHash;
+	bool     isValid = true;
+
+	f = fopen(checkpoint->fileName, "r");
+	if (f == NULL)
+		return;
+
+	if ((fgets(line, sizeof(line), f) == NULL)
+	    || (strncmp(line, LOCAL_MAGIC, strlen(LOCAL_MAGIC)) != 0)
+	    || (fscanf(f, "runHash %" SCNx64 "\n", &runHash) != 1)) {
+		if (checkpoint->rank == 0)
+			fprintf(stderr, "WARNING:  %s is not a checkpoint, ignoring it.\n",
+			        checkpoint->fileName);
+		fclose(f);
+		return;
+	}
+	if (runHash != checkpoint->runHash) {
+		if (checkpoint->rank == 0)
+			printf("Ignoring the checkpoint %s of a different run.\n",
+			       checkpoint->fileName);
+		fclose(f);
+		return;
+	}
+
+	while (isValid) {
+		struct local_field_struct field;
+
+		if (fscanf(f, "field %1023s %i\n", name, &(field.numFiles)) != 2)
+			break;
+		isValid = (field.numFiles >= 0);
+		if (!isValid)
+			break;
+		field.name  = xstrdup(name);
+		field.files = (field.numFiles > 0)
+		              ? xmalloc(sizeof(struct local_file_struct)
+		                        * field.numFiles) : NULL;
+		for (int i = 0; i < field.numFiles; i++) {
+			if (fscanf(f, "file %" SCNu64 " %" SCNx64 " %1023s\n",
+			           &(field.files[i].size), &(field.files[i].checksum),
+			           name) != 3) {
+				field.numFiles = i;
+				isValid        = false;
+				break;
+			}
+			field.files[i].name = xstrdup(name);
+		}
+		if (!isValid) {
+			local_clearField(&field);
+			break;
+		}
+		checkpoint->fields = xrealloc(checkpoint->fields,
+		                              sizeof(struct local_field_struct)
+		                              * (checkpoint->numFields + 1));
+		checkpoint->fields[checkpoint->numFields] = field;
+		checkpoint->numFields++;
+	}
+	if (!feof(f) && (checkpoint->rank == 0))
+		fprintf(stderr, "WARNING:  Ignoring the damaged end of %s.\n",
+		        checkpoint->fileName);
+	fclose(f);
+
+	if ((checkpoint->rank == 0) && (checkpoint->numFields > 0)) {
+		printf("Restarting from %s, done are:", checkpoint->fileName);
+		for (int i = 0; i < checkpoint->numFields; i++)
+			printf(" %s", checkpoint->fields[i].name);
+		printf("\n");
+	}
+} // local_read
+
+static void
+local_write(const g9pCheckpoint_t checkpoint)
+{
+	FILE *f;
+	char *tmpName = xstrmerge(checkpoint->fileName, ".tmp");
+
+	// Writing a new file and renaming it never leaves a partial checkpoint.
+	f = xfopen(tmpName, "w");
+	fprintf(f, "%s\n", LOCAL_MAGIC);
+	fprintf(f, "runHash %016" PRIx64 "\n", checkpoint->runHash);
+	for (int i = 0; i < checkpoint->numFields; i++) {
+		const struct local_field_struct *field = checkpoint->fields + i;
+
+		fprintf(f, "field %s %i\n", field->name, field->numFiles);
+		for (int j = 0; j < field->numFiles; j++)
+			fprintf(f, "file %" PRIu64 " %016" PRIx64 " %s\n",
+			        field->files[j].size, field->files[j].checksum,
+			        field->files[j].name);
+	}
+	xfclose(&f);
+
+	if (rename(tmpName, checkpoint->fileName) != 0) {
+		fprintf(stderr, "FATAL:  Could not rename %s to %s.\n",
+		        tmpName, checkpoint->fileName);
+		exit(EXIT_FAILURE);
+	}
+	xfree(tmpName);
+}
+
+static bool
+local_checksumFile(const g9pCheckpoint_t checkpoint,
+                   const char            *fileName,
+                   uint64_t              *size,
+                   uint64_t              *checksum)
+{
+	int64_t       fileSize = -1;
+	int64_t       numBlocks;
+	uint64_t      *blockHashes;
+	unsigned char *buffer;
+	FILE          *f = NULL;
+	int           isOkay = 1;
+
+	if (checkpoint->rank == 0) {
+		struct stat info;
+
+		if (stat(fileName, &info) == 0)
+			fileSize = (int64_t)(info.st_size);
+	}
+#ifdef WITH_MPI
+	MPI_Bcast(&fileSize, 1, MPI_INT64_T, 0, MPI_COMM_WORLD);
+#endif
+	if (fileSize < 0)
+		return false;
+
+	numBlocks   = (fileSize + LOCAL_BLOCK_SIZE - 1) / LOCAL_BLOCK_SIZE;
+	blockHashes = xmalloc(sizeof(uint64_t) * (numBlocks + 1));
+	memset(blockHashes, 0, sizeof(uint64_t) * (numBlocks + 1));
+	buffer      = xmalloc(LOCAL_BLOCK_SIZE);
+
+	// The blocks are dealt out round robin to the processes.
+	for (int64_t b = checkpoint->rank; b < numBlocks && isOkay;
+	     b += checkpoint->size) {
+		size_t numBytes = (size_t)((b < numBlocks - 1)
+		                           ? LOCAL_BLOCK_SIZE
+		                           : fileSize - b * LOCAL_BLOCK_SIZE);
+
+		if (f == NULL)
+			f = fopen(fileName, "rb");
+		if ((f == NULL)
+		    || (fseek(f, (long)(b * LOCAL_BLOCK_SIZE), SEEK_SET) != 0)
+		    || (fread(buffer, 1, numBytes, f) != numBytes)) {
+			isOkay = 0;
+			break;
+		}
+		blockHashes[b] = local_hashBytes(LOCAL_HASH_INIT, buffer, numBytes);
+	}
+	if (f != NULL)
+		fclose(f);
+	xfree(buffer);
+
+#ifdef WITH_MPI
+	MPI_Allreduce(MPI_IN_PLACE, &isOkay, 1, MPI_INT, MPI_MIN,
+	              MPI_COMM_WORLD);
+	// Every block has been hashed by exactly one process.
+	MPI_Allreduce(MPI_IN_PLACE, blockHashes, (int)numBlocks, MPI_UINT64_T,
+	              MPI_BOR, MPI_COMM_WORLD);
+#endif
+
+	*size     = (uint64_t)fileSize;
+	*checksum = LOCAL_HASH_INIT;
+	for (int64_t b = 0; b < numBlocks; b++)
+		*checksum = local_hashUint64(*checksum, blockHashes[b]);
+	xfree(blockHashes);
+
+	return isOkay ? true : false;
+} // local_checksumFile
+
+static struct local_field_struct *
+local_findField(const g9pCheckpoint_t checkpoint, const char *fieldName)
+{
+	for (int i = 0; i < checkpoint->numFields; i++) {
+		if (strcmp(checkpoint->fields[i].name, fieldName) == 0)
+			return checkpoint->fields + i;
+	}
+
+	return NULL;
+}
+
+static void
+local_clearField(struct local_field_struct *field)
+{
+	for (int i = 0; i < field->numFiles; i++)
+		xfree(field->files[i].name);
+	if (field->files != NULL)
+		xfree(field->files);
+	if (field->name != NULL)
+		xfree(field->name);
+	field->numFiles = 0;
+	field->files    = NULL;
+}
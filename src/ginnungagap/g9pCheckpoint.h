@@ -0,0 +1,135 @@
+// Copyright (C) 2013, Steffen Knollmann
+// Released under the terms of the GNU General Public License version 3.
+// This file is part of `ginnungagap'.
+
+#ifndef G9PCHECKPOINT_H
+#define G9PCHECKPOINT_H
+
+
+/*--- Doxygen file description ------------------------------------------*/
+
+/**
+ * @file g9pCheckpoint.h
+ * @ingroup  ginnungagapCheckpoint
+ * @brief  Provides the interface to the checkpoints of ginnungagap.
+ */
+
+
+/*--- Includes ----------------------------------------------------------*/
+#include "g9pConfig.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include "../libutil/parse_ini.h"
+
+
+/*--- ADT handle --------------------------------------------------------*/
+
+/** @brief  Provides a handle for a checkpoint. */
+typedef struct g9pCheckpoint_struct *g9pCheckpoint_t;
+
+
+/*--- Prototypes of exported functions ----------------------------------*/
+
+/**
+ * @brief  Creates a new checkpoint and reads the fields completed by an
+ *         earlier run.
+ *
+ * The checkpoint identifies the run by a hash of the ini file.  If the
+ * fields do not depend on the layout, the @c MPI section is left out so
+ * that a restart may use a different number of processes.  Otherwise the
+ * section and the number of processes are part of the hash.  A checkpoint
+ * file of a different run is ignored (and replaced when the first field
+ * has been completed).
+ *
+ * This is a collective operation.
+ *
+ * @param[in]  *fileName
+ *                The name of the checkpoint file.
+ * @param[in]  ini
+ *                The ini file of the run.
+ * @param[in]  dependsOnLayout
+ *                Whether the fields change with the process grid, see
+ *                g9pWN_isLayoutIndependent().
+ *
+ * @return  Returns a new checkpoint.
+ */
+extern g9pCheckpoint_t
+g9pCheckpoint_new(const char  *fileName,
+                  parse_ini_t ini,
+                  bool        dependsOnLayout);
+
+
+/**
+ * @brief  Deletes a checkpoint and frees the associated memory.
+ *
+ * @param[in,out]  *checkpoint
+ *                    The checkpoint to delete, will be set to @c NULL.
+ *
+ * @return  Returns nothing.
+ */
+extern void
+g9pCheckpoint_del(g9pCheckpoint_t *checkpoint);
+
+
+/**
+ * @brief  Checks whether a field has been completed by an earlier run.
+ *
+ * The output files of the field must still have the recorded sizes and
+ * checksums.  This is a collective operation, the files are read by all
+ * processes in parallel.
+ *
+ * @param[in]  checkpoint
+ *                The checkpoint to query.
+ * @param[in]  *fieldName
+ *                The name of the field.
+ *
+ * @return  Returns @c true if the field does not need to be computed.
+ */
+extern bool
+g9pCheckpoint_isDone(g9pCheckpoint_t checkpoint, const char *fieldName);
+
+
+/**
+ * @brief  Records that a field has been completed.
+ *
+ * The output files must have been written completely.  Their sizes and
+ * checksums are recorded and the checkpoint file is replaced.  This is a
+ * collective operation.
+ *
+ * @param[in,out]  checkpoint
+ *                    The checkpoint to update.
+ * @param[in]      *fieldName
+ *                    The name of the field.
+ * @param[in]      numFiles
+ *                    The number of output files of the field, may be 0.
+ * @param[in]      **fileNames
+ *                    The output files.
+ *
+ * @return  Returns nothing.
+ */
+extern void
+g9pCheckpoint_setDone(g9pCheckpoint_t checkpoint,
+                      const char      *fieldName,
+                      int             numFiles,
+                      const char      **fileNames);
+
+
+/*--- Doxygen group definitions -----------------------------------------*/
+
+/**
+ * @defgroup ginnungagapCheckpoint Checkpoints
+ * @ingroup ginnungagap
+ * @brief Allows to restart ginnungagap at the last completed field.
+ *
+ * The fields (delta, the velocities and the 2LPT corrections) are
+ * independent of each other, every one of them is computed from the white
+ * noise which is regenerated from the seeds.  A restarted run hence only
+ * needs to know which fields are complete.  The checkpoint is a small text
+ * file listing those fields with the size and checksum of their output
+ * files.  The checksum is a 64bit FNV-1a hash over the FNV-1a hashes of
+ * consecutive blocks of the file, so that the processes can share the
+ * work of reading large files.
+ */
+
+
+#endif
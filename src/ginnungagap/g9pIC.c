@@ -19,6 +19,8 @@
 #include <stdint.h>
 #include <math.h>
 #include <string.h>
+#include <stdbool.h>
+#include <complex.h>
 #ifdef WITH_MPI
 #  include <mpi.h>
 #endif
@@ -28,6 +30,8 @@
 #include "../libgrid/gridPoint.h"
 #include "../libgrid/gridRegular.h"
 #include "../libgrid/gridPatch.h"
+#include "../libdata/dataVar.h"
+#include "../libdata/dataVarType.h"
 #include "../libcosmo/cosmoPk.h"
 #include "../libcosmo/cosmoModel.h"
 
@@ -61,6 +65,15 @@ static const char *local_modeSVyStr = "small_vely";
 /** @brief  The name for the mode corresponding to small scale vz. */
 static const char *local_modeSVzStr = "small_velz";
 
+/** @brief  The name for the mode corresponding to second order vx. */
+static const char *local_modeVx2lptStr = "velx_2lpt";
+
+/** @brief  The name for the mode corresponding to second order vy. */
+static const char *local_modeVy2lptStr = "vely_2lpt";
+
+/** @brief  The name for the mode corresponding to second order vz. */
+static const char *local_modeVz2lptStr = "velz_2lpt";
+
 
 /*--- Prototypes of local functions -------------------------------------*/
 
@@ -75,6 +88,10 @@ static const char *local_modeSVzStr = "small_velz";
  * @param[out]  **data
  *                 External variable that will receive a handle to the
  *                 actual data block in memory.
+ * @param[out]  *isFloat
+ *                 Will be set to @c true if the data are single precision
+ *                 complex numbers and to @c false if they are double
+ *                 precision.
  * @param[out]  dimsGrid
  *                 The dimensions of the grid.
  * @param[out]  dimsPatch
@@ -91,13 +108,107 @@ static const char *local_modeSVzStr = "small_velz";
 static void
 local_getGridStuff(gridRegularFFT_t  gridFFT,
                    uint32_t          dim1D,
-                   fpvComplex_t      **data,
+                   void              **data,
+                   bool              *isFloat,
                    gridPointUint32_t dimsGrid,
                    gridPointUint32_t dimsPatch,
                    gridPointUint32_t idxLo,
                    gridPointUint32_t kMaxGrid);
 
 
+/**
+ * @brief  Sets a mode to zero.
+ *
+ * @param[in,out]  *data
+ *                    The array of modes, either float complex or double
+ *                    complex.
+ * @param[in]      isFloat
+ *                    Flags whether @c data holds float complex values.
+ * @param[in]      idx
+ *                    The mode to work on.
+ *
+ * @return  Returns nothing.
+ */
+static inline void
+local_zeroMode(void *data, bool isFloat, uint64_t idx);
+
+
+/**
+ * @brief  Multiplies a mode with a real factor.
+ *
+ * The factor is converted to the precision of the data before the
+ * multiplication.
+ *
+ * @param[in,out]  *data
+ *                    The array of modes, see local_zeroMode().
+ * @param[in]      isFloat
+ *                    Flags whether @c data holds float complex values.
+ * @param[in]      idx
+ *                    The mode to work on.
+ * @param[in]      factor
+ *                    The factor.
+ *
+ * @return  Returns nothing.
+ */
+static inline void
+local_scaleMode(void *data, bool isFloat, uint64_t idx, double factor);
+
+
+/**
+ * @brief  Divides a mode by a real divisor.
+ *
+ * The divisor is converted to the precision of the data before the
+ * division.
+ *
+ * @param[in,out]  *data
+ *                    The array of modes, see local_zeroMode().
+ * @param[in]      isFloat
+ *                    Flags whether @c data holds float complex values.
+ * @param[in]      idx
+ *                    The mode to work on.
+ * @param[in]      divisor
+ *                    The divisor.
+ *
+ * @return  Returns nothing.
+ */
+static inline void
+local_divideMode(void *data, bool isFloat, uint64_t idx, double divisor);
+
+
+/**
+ * @brief  Multiplies a mode with a purely imaginary factor.
+ *
+ * @param[in,out]  *data
+ *                    The array of modes, see local_zeroMode().
+ * @param[in]      isFloat
+ *                    Flags whether @c data holds float complex values.
+ * @param[in]      idx
+ *                    The mode to work on.
+ * @param[in]      factor
+ *                    The imaginary part of the factor.
+ *
+ * @return  Returns nothing.
+ */
+static inline void
+local_scaleModeImag(void *data, bool isFloat, uint64_t idx, double factor);
+
+
+/**
+ * @brief  Calculates the squared modulus of a mode.
+ *
+ * @param[in]  *data
+ *                The array of modes, see local_zeroMode().
+ * @param[in]  isFloat
+ *                Flags whether @c data holds float complex values.
+ * @param[in]  idx
+ *                The mode to work on.
+ *
+ * @return  Returns the squared modulus of the mode.
+ */
+static inline double
+local_getModePower(const void *data, bool isFloat, uint64_t idx);
+
+
 #ifdef WITH_MPI
 
 /**
@@ -157,6 +268,29 @@ local_getDisplacementToVelocityFactor(cosmoModel_t model, double aInit);
 static double
 local_getDisplacementToVelocityFactor2lpt(cosmoModel_t model, double aInit);
 
+
+/**
+ * @brief  Helper function that calculates the normalisation factor to
+ *         go from the transformed second order source to the second
+ *         order velocity field.
+ *
+ * @param[in]  gridFFT
+ *                The FFT holding the second order source, required for
+ *                the normalisation of the transform.
+ * @param[in]  model
+ *                The cosmological model to use.
+ * @param[in]  aInit
+ *                The initial expansion factor for which to calculate
+ *                the conversion factor.
+ *
+ * @return  Returns the conversion factor from the second order source to
+ *          the second order velocity.
+ */
+static double
+local_getSourceToVelocityFactor2lpt(gridRegularFFT_t gridFFT,
+                                    cosmoModel_t     model,
+                                    double           aInit);
+
 static void
 local_calcVelFromDeltaActual(const int               direction,
                              const gridPointUint32_t idxLo,
@@ -165,7 +299,8 @@ local_calcVelFromDeltaActual(const int               direction,
                              const gridPointUint32_t dimsGrid,
                              const double            norm,
                              const double            waveNumToFreq,
-                             fpvComplex_t *restrict  data);
+                             const bool              isFloat,
+                             void                    *data);
 
 static double
 local_kernel1D(double x);
@@ -183,7 +318,8 @@ local_calcVelFromDeltaCutoff(const int               direction,
                              const double            wavenumToFreq,
                              const bool              doCutSmall,
                              const double            cutoffScale,
-                             fpvComplex_t *restrict  data);
+                             const bool              isFloat,
+                             void                    *data);
 
 /*--- Implementations of exported functios ------------------------------*/
 extern void
@@ -193,15 +329,16 @@ g9pIC_calcDeltaFromWN(gridRegularFFT_t gridFFT,
                       cosmoPk_t        pk)
 {
 	gridPointUint32_t dimsGrid, dimsPatch, idxLo, kMaxGrid;
-	fpvComplex_t      *data;
+	void              *data;
+	bool              isFloat;
 	double            wavenumToFreq, norm;
 //	double            maxFreq;
 
 	assert(gridFFT != NULL);
 	assert(pk != NULL);
 
-	local_getGridStuff(gridFFT, dim1D, &data, dimsGrid, dimsPatch,
-	                   idxLo, kMaxGrid);
+	local_getGridStuff(gridFFT, dim1D, &data, &isFloat, dimsGrid,
+	                   dimsPatch, idxLo, kMaxGrid);
 	wavenumToFreq = 2. * M_PI / (boxsizeInMpch);
 	norm          = sqrt(gridRegularFFT_getNorm(gridFFT));
 	norm         *= pow(1. / (boxsizeInMpch), 1.5);
@@ -210,7 +347,7 @@ g9pIC_calcDeltaFromWN(gridRegularFFT_t gridFFT,
 // maxFreq needs to be added to shared when used again
 #ifdef _OPENMP
 #  pragma omp parallel for shared(dimsPatch, idxLo, kMaxGrid, \
-	dimsGrid, data, pk, norm)
+	dimsGrid, data, isFloat, pk, norm)
 #endif
 	for (uint64_t k = 0; k < dimsPatch[2]; k++) {
 		int64_t k2 = k + idxLo[2];
@@ -228,14 +365,14 @@ g9pIC_calcDeltaFromWN(gridRegularFFT_t gridFFT,
 				kCell *= wavenumToFreq;
 
 				if ((k0 == 0) && (k1 == 0) && (k2 == 0)) {
-					data[idx] = 0.0;
+					local_zeroMode(data, isFloat, idx);
 //				} else if (kCell > maxFreq) {
-//					data[idx] = 0.0 + 0.0I;
+//					local_zeroMode(data, isFloat, idx);
 				} else {
 					double tmp;
 					tmp        = sqrt(cosmoPk_eval(pk, kCell));
 //					tmp       *= cos(0.5 * M_PI * kCell / maxFreq);
-					data[idx] *= (fpv_t)(tmp * norm);
+					local_scaleMode(data, isFloat, idx, tmp * norm);
 				}
 			}
 		}
@@ -253,14 +390,15 @@ g9pIC_calcVelFromDelta(gridRegularFFT_t gridFFT,
 {
 	gridRegular_t     grid;
 	gridPointUint32_t dimsGrid, dimsPatch, idxLo, kMaxGrid;
-	fpvComplex_t      *data;
+	void              *data;
+	bool              isFloat;
 	double            wavenumToFreq, norm;
 
 	assert(gridFFT != NULL);
 	assert(model != NULL);
 
-	local_getGridStuff(gridFFT, dim1D, &data, dimsGrid, dimsPatch, idxLo,
-	                   kMaxGrid);
+	local_getGridStuff(gridFFT, dim1D, &data, &isFloat, dimsGrid,
+	                   dimsPatch, idxLo, kMaxGrid);
 	grid          = gridRegularFFT_getGridFFTed(gridFFT);
 	wavenumToFreq = 2. * M_PI / (boxsizeInMpch);
 	norm          = local_getDisplacementToVelocityFactor(model, aInit);
@@ -269,47 +407,71 @@ g9pIC_calcVelFromDelta(gridRegularFFT_t gridFFT,
 		case G9PIC_MODE_VX:
 			local_calcVelFromDeltaActual(gridRegular_getCurrentDim(grid, 0),
 		                             idxLo, dimsPatch, kMaxGrid,
-		                             dimsGrid, norm, wavenumToFreq, data);
+		                             dimsGrid, norm, wavenumToFreq, isFloat,
+		                             data);
 			break;
 		case G9PIC_MODE_VY:
 			local_calcVelFromDeltaActual(gridRegular_getCurrentDim(grid, 1),
 		                             idxLo, dimsPatch, kMaxGrid,
-		                             dimsGrid, norm, wavenumToFreq, data);
+		                             dimsGrid, norm, wavenumToFreq, isFloat,
+		                             data);
 			break;
 		case G9PIC_MODE_VZ:
 			local_calcVelFromDeltaActual(gridRegular_getCurrentDim(grid, 2),
 		                             idxLo, dimsPatch, kMaxGrid,
-		                             dimsGrid, norm, wavenumToFreq, data);
+		                             dimsGrid, norm, wavenumToFreq, isFloat,
+		                             data);
 			break;
 		case G9PIC_MODE_LVX:
 			local_calcVelFromDeltaCutoff(gridRegular_getCurrentDim(grid, 0),
 		                             idxLo, dimsPatch, kMaxGrid,
-		                             dimsGrid, norm, wavenumToFreq, true, cutoffScale, data);
+		                             dimsGrid, norm, wavenumToFreq, true, cutoffScale, isFloat, data);
 			break;
 		case G9PIC_MODE_LVY:
 			local_calcVelFromDeltaCutoff(gridRegular_getCurrentDim(grid, 1),
 		                             idxLo, dimsPatch, kMaxGrid,
-		                             dimsGrid, norm, wavenumToFreq, true, cutoffScale, data);
+		                             dimsGrid, norm, wavenumToFreq, true, cutoffScale, isFloat, data);
 			break;
 		case G9PIC_MODE_LVZ:
 			local_calcVelFromDeltaCutoff(gridRegular_getCurrentDim(grid, 2),
 		                             idxLo, dimsPatch, kMaxGrid,
-		                             dimsGrid, norm, wavenumToFreq, true, cutoffScale, data);
+		                             dimsGrid, norm, wavenumToFreq, true, cutoffScale, isFloat, data);
 			break;
 		case G9PIC_MODE_SVX:
 			local_calcVelFromDeltaCutoff(gridRegular_getCurrentDim(grid, 0),
 		                             idxLo, dimsPatch, kMaxGrid,
-		                             dimsGrid, norm, wavenumToFreq, false, cutoffScale, data);
+		                             dimsGrid, norm, wavenumToFreq, false, cutoffScale, isFloat, data);
 			break;
 		case G9PIC_MODE_SVY:
 			local_calcVelFromDeltaCutoff(gridRegular_getCurrentDim(grid, 1),
 		                             idxLo, dimsPatch, kMaxGrid,
-		                             dimsGrid, norm, wavenumToFreq, false, cutoffScale, data);
+		                             dimsGrid, norm, wavenumToFreq, false, cutoffScale, isFloat, data);
 			break;
 		case G9PIC_MODE_SVZ:
 			local_calcVelFromDeltaCutoff(gridRegular_getCurrentDim(grid, 2),
 		                             idxLo, dimsPatch, kMaxGrid,
-		                             dimsGrid, norm, wavenumToFreq, false, cutoffScale, data);
+		                             dimsGrid, norm, wavenumToFreq, false, cutoffScale, isFloat, data);
+			break;
+		case G9PIC_MODE_VX2LPT:
+			norm = local_getSourceToVelocityFactor2lpt(gridFFT, model, aInit);
+			local_calcVelFromDeltaActual(gridRegular_getCurrentDim(grid, 0),
+		                             idxLo, dimsPatch, kMaxGrid,
+		                             dimsGrid, norm, wavenumToFreq, isFloat,
+		                             data);
+			break;
+		case G9PIC_MODE_VY2LPT:
+			norm = local_getSourceToVelocityFactor2lpt(gridFFT, model, aInit);
+			local_calcVelFromDeltaActual(gridRegular_getCurrentDim(grid, 1),
+		                             idxLo, dimsPatch, kMaxGrid,
+		                             dimsGrid, norm, wavenumToFreq, isFloat,
+		                             data);
+			break;
+		case G9PIC_MODE_VZ2LPT:
+			norm = local_getSourceToVelocityFactor2lpt(gridFFT, model, aInit);
+			local_calcVelFromDeltaActual(gridRegular_getCurrentDim(grid, 2),
+		                             idxLo, dimsPatch, kMaxGrid,
+		                             dimsGrid, norm, wavenumToFreq, isFloat,
+		                             data);
 			break;
 		default:
 			diediedie(EXIT_FAILURE);
@@ -324,18 +486,19 @@ g9pIC_calcDDPhiFromDelta(gridRegularFFT_t gridFFT,
                          uint32_t         d2)
 {
 	gridPointUint32_t dimsGrid, dimsPatch, idxLo, kMaxGrid;
-	fpvComplex_t      *data;
+	void              *data;
+	bool              isFloat;
 
 	assert(gridFFT != NULL);
 	assert(d1 >= 0 && d1 < NDIM);
 	assert(d2 >= 0 && d2 < NDIM);
 
-	local_getGridStuff(gridFFT, dim1D, &data, dimsGrid, dimsPatch,
-	                   idxLo, kMaxGrid);
+	local_getGridStuff(gridFFT, dim1D, &data, &isFloat, dimsGrid,
+	                   dimsPatch, idxLo, kMaxGrid);
 
 #ifdef _OPENMP
 #  pragma omp parallel for shared(dimsPatch, idxLo, kMaxGrid, \
-	dimsGrid, data, d1, d2)
+	dimsGrid, data, isFloat, d1, d2)
 #endif
 	for (uint64_t k = 0; k < dimsPatch[2]; k++) {
 		int64_t k2 = k + idxLo[2];
@@ -367,9 +530,10 @@ g9pIC_calcDDPhiFromDelta(gridRegularFFT_t gridFFT,
 				kCellSqr = (double)(k0 * k0 + k1 * k1 + k2 * k2);
 
 				if ((k0 == 0) && (k1 == 0) && (k2 == 0))
-					data[idx] = 0.0;
+					local_zeroMode(data, isFloat, idx);
 				else
-					data[idx] *= (fpv_t)(-kd1 * kd2 / kCellSqr);
+					local_scaleMode(data, isFloat, idx,
+					                -kd1 * kd2 / kCellSqr);
 			}
 		}
 	}
@@ -382,14 +546,15 @@ g9pIC_calcPkFromDelta(gridRegularFFT_t gridFFT,
 {
 	cosmoPk_t         pk;
 	gridPointUint32_t dimsGrid, dimsPatch, idxLo, kMaxGrid;
-	fpvComplex_t      *data;
+	void              *data;
+	bool              isFloat;
 	double            wavenumToFreq, *P, *freq, volume;
 	uint32_t          *numFreqHits;
 
 	assert(gridFFT != NULL);
 
-	local_getGridStuff(gridFFT, dim1D, &data, dimsGrid, dimsPatch,
-	                   idxLo, kMaxGrid);
+	local_getGridStuff(gridFFT, dim1D, &data, &isFloat, dimsGrid,
+	                   dimsPatch, idxLo, kMaxGrid);
 	wavenumToFreq = 2. * M_PI * 1. / boxsizeInMpch;
 	volume        = boxsizeInMpch * boxsizeInMpch * boxsizeInMpch;
 	P             = xmalloc(sizeof(double) * kMaxGrid[0]);
@@ -418,8 +583,7 @@ g9pIC_calcPkFromDelta(gridRegularFFT_t gridFFT,
 				                                 + k2 * k2)));
 
 				if ((kCell <= kMaxGrid[0]) && (kCell > 0)) {
-					P[kCell - 1]   += creal(data[idx]) * creal(data[idx])
-					                  + cimag(data[idx]) * cimag(data[idx]);
+					P[kCell - 1]   += local_getModePower(data, isFloat, idx);
 					freq[kCell - 1] = kCell * wavenumToFreq;
 					numFreqHits[kCell - 1]++;
 				}
@@ -478,6 +642,15 @@ g9pIC_getModeStr(g9pICMode_t mode)
 		case G9PIC_MODE_SVZ:
 			s = local_modeSVzStr;
 			break;
+		case G9PIC_MODE_VX2LPT:
+			s = local_modeVx2lptStr;
+			break;
+		case G9PIC_MODE_VY2LPT:
+			s = local_modeVy2lptStr;
+			break;
+		case G9PIC_MODE_VZ2LPT:
+			s = local_modeVz2lptStr;
+			break;
 		default:
 			diediedie(EXIT_FAILURE);
 	}
@@ -489,7 +662,8 @@ g9pIC_getModeStr(g9pICMode_t mode)
 static void
 local_getGridStuff(gridRegularFFT_t  gridFFT,
                    uint32_t          dim1D,
-                   fpvComplex_t      **data,
+                   void              **data,
+                   bool              *isFloat,
                    gridPointUint32_t dimsGrid,
                    gridPointUint32_t dimsPatch,
                    gridPointUint32_t idxLo,
@@ -503,7 +677,9 @@ local_getGridStuff(gridRegularFFT_t  gridFFT,
 	patch = gridRegular_getPatchHandle(grid, 0);
 	gridPatch_getDims(patch, dimsPatch);
 	gridPatch_getIdxLo(patch, idxLo);
-	*data = gridPatch_getVarDataHandle(patch, 0);
+	*data    = gridPatch_getVarDataHandle(patch, 0);
+	*isFloat = dataVarType_isNativeFloat(
+	    dataVar_getType(gridPatch_getVarHandle(patch, 0)));
 
 	for (int i = 0; i < NDIM; i++)
 		kMaxGrid[i] = dim1D / 2;
@@ -511,6 +687,55 @@ local_getGridStuff(gridRegularFFT_t  gridFFT,
 	                                                // dimension
 }
 
+static inline void
+local_zeroMode(void *data, bool isFloat, uint64_t idx)
+{
+	if (isFloat)
+		((float complex *)data)[idx] = 0.0;
+	else
+		((double complex *)data)[idx] = 0.0;
+}
+
+static inline void
+local_scaleMode(void *data, bool isFloat, uint64_t idx, double factor)
+{
+	if (isFloat)
+		((float complex *)data)[idx] *= (float)factor;
+	else
+		((double complex *)data)[idx] *= factor;
+}
+
+static inline void
+local_divideMode(void *data, bool isFloat, uint64_t idx, double divisor)
+{
+	if (isFloat)
+		((float complex *)data)[idx] /= (float)divisor;
+	else
+		((double complex *)data)[idx] /= divisor;
+}
+
+static inline void
+local_scaleModeImag(void *data, bool isFloat, uint64_t idx, double factor)
+{
+	if (isFloat)
+		((float complex *)data)[idx] *= (float)factor * I;
+	else
+		((double complex *)data)[idx] *= factor * I;
+}
+
+static inline double
+local_getModePower(const void *data, bool isFloat, uint64_t idx)
+{
+	double complex mode;
+
+	if (isFloat)
+		mode = ((const float complex *)data)[idx];
+	else
+		mode = ((const double complex *)data)[idx];
+
+	return creal(mode) * creal(mode) + cimag(mode) * cimag(mode);
+}
+
 #ifdef WITH_MPI
 static void
 local_reducePk(double *pK, double *k, uint32_t *nums, uint32_t kMaxGrid)
@@ -559,6 +784,23 @@ local_getDisplacementToVelocityFactor2lpt(cosmoModel_t model, double aInit)
 	return adot * 100. * growthVel2;
 }
 
+static double
+local_getSourceToVelocityFactor2lpt(gridRegularFFT_t gridFFT,
+                                    cosmoModel_t     model,
+                                    double           aInit)
+{
+	double omegaM = cosmoModel_calcOmegaMatter(model, aInit);
+	// D2 ~ -3/7 D1^2 Omega_m^(-1/143) and psi2 = D2 grad phi2 with
+	// lap phi2 = source.  The source goes through the same kernel as the
+	// density, which yields psi1 = -D1 grad phi1, i.e. it already carries
+	// the minus sign.  Hence only the magnitude is applied here; do not
+	// flip the sign of this factor or of the source in local_do2LPTSource.
+	double growth2OverGrowthSqr = 3. / 7. * pow(omegaM, -1. / 143.);
+
+	return local_getDisplacementToVelocityFactor2lpt(model, aInit)
+	       * growth2OverGrowthSqr * gridRegularFFT_getNorm(gridFFT);
+}
+
 #define WRAP_WAVENUM(k, kmax, dims) \
     k = (k > kmax) ? k - dims : k
 
@@ -573,12 +815,13 @@ local_calcVelFromDeltaActual(const int               direction,
                              const gridPointUint32_t dimsGrid,
                              const double            norm,
                              const double            wavenumToFreq,
-                             fpvComplex_t *restrict  data)
+                             const bool              isFloat,
+                             void                    *data)
 {
 	const double wavenumToFreqSqr = wavenumToFreq * wavenumToFreq;
 #ifdef _OPENMP
 #  pragma omp parallel for shared(dimsPatch, idxLo, kMaxGrid, \
-	dimsGrid, data)
+	dimsGrid, data, isFloat)
 #endif
 	for (uint64_t k = 0; k < dimsPatch[2]; k++) {
 		int64_t kReal[3];
@@ -599,12 +842,13 @@ local_calcVelFromDeltaActual(const int               direction,
 
 				if ((kReal[0] == 0) && (kReal[1] == 0)
 				    && (kReal[2] == 0)) {
-					data[idx] = 0.0;
+					local_zeroMode(data, isFloat, idx);
+				} else if (kReal[direction] == kMaxGrid[direction]) {
+					local_zeroMode(data, isFloat, idx);
 				} else {
-					data[idx] *= (fpv_t)(norm * kReal[direction]
-					                     * wavenumToFreq / kCellSqr) * I;
-					data[idx]  = (kReal[direction] == kMaxGrid[direction]) ?
-					             FPV_C(0.0) : data[idx];
+					local_scaleModeImag(data, isFloat, idx,
+					                    norm * kReal[direction]
+					                    * wavenumToFreq / kCellSqr);
 				}
 			}
 		}
@@ -638,7 +882,8 @@ local_calcVelFromDeltaCutoff(const int               direction,
                              const double            wavenumToFreq,
                              const bool              doCutSmall,
                              const double            cutoffScale,
-                             fpvComplex_t *restrict  data)
+                             const bool              isFloat,
+                             void                    *data)
 {
 	const double wavenumToFreqSqr = wavenumToFreq * wavenumToFreq;
 	const double rsSqr = cutoffScale * cutoffScale;
@@ -648,7 +893,7 @@ local_calcVelFromDeltaCutoff(const int               direction,
 	//printf("\n%i %i %i\n", dimsGrid[0], dimsGrid[1], dimsGrid[2]);
 #ifdef _OPENMP
 #  pragma omp parallel for shared(dimsPatch, idxLo, kMaxGrid, \
-	dimsGrid, data)
+	dimsGrid, data, isFloat)
 #endif
 	for (uint64_t k = 0; k < dimsPatch[2]; k++) {
 		int64_t kReal[3];
@@ -670,23 +915,25 @@ local_calcVelFromDeltaCutoff(const int               direction,
 
 				if ((kReal[0] == 0) && (kReal[1] == 0)
 				    && (kReal[2] == 0)) {
-					data[idx] = 0.0;
+					local_zeroMode(data, isFloat, idx);
+				} else if (kReal[direction] == kMaxGrid[direction]) {
+					local_zeroMode(data, isFloat, idx);
 				} else {
-					data[idx] *= (fpv_t)(norm * kReal[direction]
-					                     * wavenumToFreq / kCellSqr) * I;
+					local_scaleModeImag(data, isFloat, idx,
+					                    norm * kReal[direction]
+					                    * wavenumToFreq / kCellSqr);
 					if (doCutSmall) {
-						data[idx] *= local_cutoff(kCellSqr, rsSqr);
+						local_scaleMode(data, isFloat, idx,
+						                local_cutoff(kCellSqr, rsSqr));
 						if(kReal[0]!=0)
-							data[idx] /= (fpv_t)local_kernel1D(((double)kReal[0])*M_PI/realGrid);
+							local_divideMode(data, isFloat, idx, local_kernel1D(((double)kReal[0])*M_PI/realGrid));
 						if(kReal[1]!=0)
-							data[idx] /= (fpv_t)local_kernel1D(((double)kReal[1])*M_PI/realGrid);
+							local_divideMode(data, isFloat, idx, local_kernel1D(((double)kReal[1])*M_PI/realGrid));
 						if(kReal[2]!=0)
-							data[idx] /= (fpv_t)local_kernel1D(((double)kReal[2])*M_PI/realGrid);
+							local_divideMode(data, isFloat, idx, local_kernel1D(((double)kReal[2])*M_PI/realGrid));
 					} else
-						data[idx] *= 1 - local_cutoff(kCellSqr, rsSqr);
-						
-					data[idx]  = (kReal[direction] == kMaxGrid[direction]) ?
-					             FPV_C(0.0) : data[idx];
+						local_scaleMode(data, isFloat, idx,
+						                1 - local_cutoff(kCellSqr, rsSqr));
 				}
 			}
 		}
@@ -44,7 +44,13 @@ typedef enum {
 	/** @brief  Do the y-component of the small scale velocity. */
 	G9PIC_MODE_SVY,
 	/** @brief  Do the z-component of the small scale velocity. */
-	G9PIC_MODE_SVZ
+	G9PIC_MODE_SVZ,
+	/** @brief  Do the x-component of the second order velocity. */
+	G9PIC_MODE_VX2LPT,
+	/** @brief  Do the y-component of the second order velocity. */
+	G9PIC_MODE_VY2LPT,
+	/** @brief  Do the z-component of the second order velocity. */
+	G9PIC_MODE_VZ2LPT
 } g9pICMode_t;
 
 
@@ -127,6 +133,21 @@ g9pIC_calcDeltaFromWN(gridRegularFFT_t gridFFT,
  * details on the calculations of the first and last factor in the last
  * equation.
  *
+ * For the second order modes (#G9PIC_MODE_VX2LPT, #G9PIC_MODE_VY2LPT and
+ * #G9PIC_MODE_VZ2LPT) the grid must instead hold the forward transform of
+ * the second order source
+ * @f$ S = \sum_{i<j} (\phi_{,ii}\phi_{,jj} - \phi_{,ij}^2) @f$,
+ * as it is obtained from g9pIC_calcDDPhiFromDelta() and an unnormalised
+ * forward transform.  The normalisation of the transform is taken care
+ * of and the velocity is scaled with
+ * @f[
+ *    \mbox{norm} = \dot{a} H_0 \frac{\mbox{d} \ln G_2}{ \mbox{d} \ln a}
+ *                   \frac{3}{7} \Omega_{\mbox{m}}(a)^{-1/143}
+ * @f]
+ * instead, i.e. using the approximation
+ * @f$ G_2 \approx -\frac{3}{7} \Omega_{\mbox{m}}^{-1/143} G^2 @f$
+ * for the second order growth factor (Bouchet et al. 1995).
+ *
  * @bug This is only valid in MPI mode, where the grid is permuted in
  *      the order @f$ z, x, y @f$.
  *
@@ -117,6 +117,18 @@ static void
 local_parseOptionalHistogram(g9pSetup_t s, parse_ini_t ini);
 
 
+/**
+ * @brief  Retrieves the type of the grid variable from an ini file.
+ *
+ * @param[in,out]  ini
+ *                    The ini file to read from.
+ *
+ * @return  Returns the type, #DATAVARTYPE_FPV if nothing is given.
+ */
+static dataVarType_t
+local_getVarTypeFromIni(parse_ini_t ini);
+
+
 /**
  * @brief  Retrieves the normalisation mode from an ini file.
  *
@@ -170,6 +182,10 @@ g9pSetup_del(g9pSetup_t *setup)
 {
 	assert(setup != NULL && *setup != NULL);
 
+	if ((*setup)->profilePrefix != NULL)
+		xfree((*setup)->profilePrefix);
+	if ((*setup)->checkpointFileName != NULL)
+		xfree((*setup)->checkpointFileName);
 	xfree((*setup)->nameHistogramVelz);
 	xfree((*setup)->nameHistogramVely);
 	xfree((*setup)->nameHistogramVelx);
@@ -210,6 +226,12 @@ local_parseOptional(g9pSetup_t s, parse_ini_t ini)
 	if (!(parse_ini_get_bool(ini, "writeDensityField", "Ginnungagap",
 	                         &(s->writeDensityField))))
 		s->writeDensityField = true;
+	if (!(parse_ini_get_uint32(ini, "writeAsyncMaxMB", "Ginnungagap",
+	                           &(s->writeAsyncMaxMB))))
+		s->writeAsyncMaxMB = 0;
+	if (!(parse_ini_get_bool(ini, "useInPlaceFFT", "Ginnungagap",
+	                         &(s->useInPlaceFFT))))
+		s->useInPlaceFFT = false;
 	
 	if (!(parse_ini_get_bool(ini, "doSmallScale", "Ginnungagap",
 	                         &(s->doSmallScale))))
@@ -220,6 +242,15 @@ local_parseOptional(g9pSetup_t s, parse_ini_t ini)
 	if (s->doSmallScale || s->doLargeScale)
 		parse_ini_get_double(ini, "cutoffScale", "Ginnungagap",
 							&(s->cutoffScale));
+	s->varType = local_getVarTypeFromIni(ini);
+
+	if (!(parse_ini_get_string(ini, "profilePrefix", "Ginnungagap",
+	                           &(s->profilePrefix))))
+		s->profilePrefix = NULL;
+
+	if (!(parse_ini_get_string(ini, "checkpointFile", "Ginnungagap",
+	                           &(s->checkpointFileName))))
+		s->checkpointFileName = NULL;
 
 	local_parseOptionalPk(s, ini);
 	local_parseOptionalHistogram(s, ini);
@@ -278,6 +309,30 @@ local_parseOptionalHistogram(g9pSetup_t s, parse_ini_t ini)
 		s->nameHistogramVelz = xstrdup(local_nameHistoVelz);
 }
 
+static dataVarType_t
+local_getVarTypeFromIni(parse_ini_t ini)
+{
+	char          *name;
+	dataVarType_t type = DATAVARTYPE_FPV;
+
+	if (!(parse_ini_get_string(ini, "precision", "Ginnungagap", &name)))
+		return type;
+
+	if (strcmp(name, "single") == 0) {
+		type = DATAVARTYPE_FLOAT;
+	} else if (strcmp(name, "double") == 0) {
+		type = DATAVARTYPE_DOUBLE;
+	} else {
+		fprintf(stderr, "Precision %s unknown, use single or double\n",
+		        name);
+		diediedie(EXIT_FAILURE);
+	}
+
+	xfree(name);
+
+	return type;
+}
+
 static g9pNorm_mode_t
 local_getNormModeFromIni(parse_ini_t ini)
 {
@@ -302,16 +357,52 @@ static void
 local_parseMPIStuff(g9pSetup_t setup, parse_ini_t ini)
 {
 	int32_t *nProcs;
-	bool    rtn;
+	int32_t numTransposeRounds;
+	int32_t numOverlapChunks;
+	char    *name;
+	bool    hasNProcs;
 
-	rtn = parse_ini_get_int32list(ini, "nProcs", "MPI", NDIM, &nProcs);
-	if (!rtn) {
-		fprintf(stderr, "Could not get nProcs from section MPI.\n");
+	hasNProcs = parse_ini_get_int32list(ini, "nProcs", "MPI", NDIM, &nProcs);
+	for (int i = 0; i < NDIM; i++)
+		setup->nProcs[i] = hasNProcs ? (int)(nProcs[i]) : 0;
+	if (hasNProcs)
+		xfree(nProcs);
+
+	// An explicit processor grid is used as given unless a decomposition
+	// is requested as well.
+	if (parse_ini_get_string(ini, "decomposition", "MPI", &name)) {
+		setup->decomposition = gridRegularDistrib_getDecompFromName(name);
+		if (setup->decomposition == GRIDREGULARDISTRIB_DECOMP_UNKNOWN) {
+			fprintf(stderr, "Decomposition %s unknown\n", name);
+			exit(EXIT_FAILURE);
+		}
+		xfree(name);
+	} else {
+		setup->decomposition = hasNProcs ? GRIDREGULARDISTRIB_DECOMP_PENCIL
+		                       : GRIDREGULARDISTRIB_DECOMP_AUTO;
+	}
+
+	if (!(parse_ini_get_int32(ini, "numTransposeRounds", "MPI",
+	                          &numTransposeRounds)))
+		numTransposeRounds = 0;
+	if (numTransposeRounds < 0) {
+		fprintf(stderr, "numTransposeRounds must not be negative.\n");
 		exit(EXIT_FAILURE);
 	}
-	for (int i = 0; i < NDIM; i++)
-		setup->nProcs[i] = (int)(nProcs[i]);
-	xfree(nProcs);
+	setup->numTransposeRounds = (int)numTransposeRounds;
+
+	if (!(parse_ini_get_int32(ini, "numOverlapChunks", "MPI",
+	                          &numOverlapChunks)))
+		numOverlapChunks = 0;
+	if (numOverlapChunks < 0) {
+		fprintf(stderr, "numOverlapChunks must not be negative.\n");
+		exit(EXIT_FAILURE);
+	}
+	setup->numOverlapChunks = (int)numOverlapChunks;
+
+	if (!(parse_ini_get_bool(ini, "usePersistentSchedules", "MPI",
+	                         &(setup->usePersistentSchedules))))
+		setup->usePersistentSchedules = false;
 }
 
 #endif
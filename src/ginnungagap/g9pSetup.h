@@ -18,6 +18,8 @@
 /*--- Includes ----------------------------------------------------------*/
 #include "g9pConfig.h"
 #include "g9pNorm.h"
+#include "../libdata/dataVarType.h"
+#include "../libgrid/gridRegularDistrib.h"
 #include <stdint.h>
 #include <stdbool.h>
 #include "../libutil/parse_ini.h"
@@ -51,12 +53,32 @@ struct g9pSetup_struct {
 	bool		   doSmallScale;
 	/** @brief  Gives the cutoff scale. */
 	double		   cutoffScale;
+	/**
+	 * @brief  The type of the grid variable (single or double).
+	 *
+	 * @todo  Select the precision per field.  This needs a grid variable
+	 *        and FFT plans per precision, and the cached modes of the 2LPT
+	 *        corrections must be converted between them.
+	 */
+	dataVarType_t  varType; ///< Defaults to #DATAVARTYPE_FPV.
 #ifdef WITH_MPI
 	/** @brief  The process grid. */
-	int nProcs[NDIM];
+	int nProcs[NDIM]; ///< Defaults to 0 in all dimensions.
+	/** @brief  The domain decomposition. */
+	gridRegularDistrib_decomp_t decomposition;
+	/** @brief  The number of rounds for the MPI transpositions. */
+	int numTransposeRounds; ///< Defaults to 0.
+	/** @brief  The number of chunks to overlap FFTs and transpositions. */
+	int numOverlapChunks; ///< Defaults to 0.
+	/** @brief  Whether the transpositions replay persistent schedules. */
+	bool usePersistentSchedules; ///< Defaults to @c false.
 #endif
 	/** @brief  Flags whether the density field should be written. */
 	bool     writeDensityField; ///< Defaults to @c true.
+	/** @brief  Flags whether the FFTs work in place on padded data. */
+	bool     useInPlaceFFT; ///< Defaults to @c false.
+	/** @brief  The staging budget for writing in the background in MB. */
+	uint32_t writeAsyncMaxMB; ///< Defaults to 0 (synchronous writing).
 	/** @brief  Gives the name of the P(k) of the white noise. */
 	char     *namePkWN; ///< Defaults to #local_namePkWN.
 	/** @brief  Gives the name of the P(k) of the overdensity field. */
@@ -87,6 +109,12 @@ struct g9pSetup_struct {
 	double   histogramExtremeDens;
 	/** @brief  The extreme value for the velocity histograms. */
 	double   histogramExtremeVel;
+	/** @brief  The prefix of the profiling report, profiling is off if
+	 *          this is @c NULL. */
+	char     *profilePrefix; ///< Defaults to @c NULL.
+	/** @brief  The name of the checkpoint file, no checkpoints are kept if
+	 *          this is @c NULL. */
+	char     *checkpointFileName; ///< Defaults to @c NULL.
 };
 
 
@@ -162,17 +190,39 @@ g9pSetup_del(g9pSetup_t *setup);
  * #
  * # This can be used to switch on the calculation of an additional set of
  * # velocity fields which encode the second order corrections to linear
- * # theory.  To calculate this corrections, a significantly larger amount
- * # of memory is required.  If this key is not set, no corrections will be
- * # calculated.
+ * # theory.  They are written with the qualifiers velx_2lpt, vely_2lpt
+ * # and velz_2lpt.  To calculate this corrections, memory for three
+ * # additional fields of the size of the grid is required.  If this key
+ * # is not set, no corrections will be calculated.
  * do2LPTCorrections = <true|false>
  * #
+ * # The precision in which the fields are stored and transformed.  This
+ * # is independent of how the code was configured; the default is the
+ * # precision selected at compile time (see ENABLE_DOUBLE).  Using single
+ * # precision halves the memory and bandwidth requirements.  All fields
+ * # share one grid variable, hence the precision applies to the whole run.
+ * precision = <single|double>
+ * #
  * # A tag whether or not to write the density field.  Note: This should
  * # not be disabled for the Grafic writer, as it will then have wrong file
  * # names:  Instead of velx, vely, and velz, the velocity files will have
  * # the names delta, velx, and vely, respectively.
  * writeDensityField = <true|false>
  * #
+ * # The amount of memory (in MB per process) that may be used to hold
+ * # copies of the output fields while they are written in the background.
+ * # This needs the code to be configured with --enable-async-io and, with
+ * # MPI, an MPI library providing MPI_THREAD_MULTIPLE; otherwise the fields
+ * # are written synchronously.  The default of 0 also writes synchronously.
+ * writeAsyncMaxMB = <integer>
+ * #
+ * # Whether the FFTs work in place on the field.  The field is then
+ * # allocated with the padding FFTW needs (2(n/2+1) instead of n cells
+ * # in the first dimension) and is only padded for the duration of the
+ * # transforms, so that only one copy of the field exists instead of
+ * # one in real and one in Fourier space.  Defaults to false.
+ * useInPlaceFFT = <true|false>
+ * #
  * # The name of the text file that will contain the P(k) of the white
  * # noise field.
  * namePkWN = <string>
@@ -230,6 +280,13 @@ g9pSetup_del(g9pSetup_t *setup);
  * # z-component of the velocity.
  * nameHistogramVelz = <string>
  * #
+ * # Switches on the profiling of the code.  The region timings and
+ * # memory peaks (reduced over all processes) are written to
+ * # <prefix>.json and a timeline of all calls is written to
+ * # <prefix>.trace.json (see libutil/prof.h).
+ * # Profiling is off if this key is not set.
+ * profilePrefix = <string>
+ * #
  * @endcode
  *
  *
@@ -241,7 +298,7 @@ g9pSetup_del(g9pSetup_t *setup);
  * [MPI]
  * #
  * #################
- * # Required keys #
+ * # Optional keys #
  * #################
  * #
  * # This gives the processor grid employed in the domain decomposition,
@@ -255,6 +312,38 @@ g9pSetup_del(g9pSetup_t *setup);
  * # effectively forces a slab decomposition.
  * nProcs = <2 or 3 integers>
  * #
+ * # Selects the domain decomposition.  Slabs only split the z
+ * # dimension and the FFTs then need only one global transposition per
+ * # direction instead of two, but they cannot use more tasks than there
+ * # are cells in one dimension.  Pencils use nProcs (defaulting to
+ * # 1 0 0) and scale to more tasks.  The automatic mode uses slabs
+ * # whenever they are possible.  If this key is not given, nProcs is
+ * # used as is if present and the decomposition is chosen automatically
+ * # otherwise.
+ * decomposition = <auto|slab|pencil>
+ * #
+ * # The number of rounds in which the transpositions of the FFTs exchange
+ * # their data.  The default of 0 exchanges everything at once which
+ * # needs about twice the memory of the field, a positive number K
+ * # reorders the field in-place and exchanges it in K rounds, needing
+ * # only about (1 + 2/K) times the memory of the field at the expense of
+ * # some local reordering work.
+ * numTransposeRounds = <integer>
+ * #
+ * # The number of chunks in which the transpositions of the FFTs send
+ * # their data.  A positive number K lets the one-dimensional transforms
+ * # of a chunk run while the previous chunks are still in transit.  The
+ * # default of 0 does the transforms and the transpositions one after
+ * # the other.  If used, numTransposeRounds is ignored.
+ * numOverlapChunks = <integer>
+ * #
+ * # Whether the transpositions set up their buffers and MPI requests
+ * # only once and replay them for all fields.  This saves the setup
+ * # costs of the many identical transpositions, but keeps about twice
+ * # the memory of the field allocated for the buffers.  Defaults to
+ * # false.  Has no effect if numTransposeRounds is used.
+ * usePersistentSchedules = <true|false>
+ * #
  * @endcode
  */
 
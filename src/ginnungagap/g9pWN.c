@@ -19,12 +19,18 @@
 #include "../libutil/parse_ini.h"
 #include "../libutil/xmem.h"
 #include "../libutil/diediedie.h"
+#include "../libutil/utilMath.h"
 #include "../libgrid/gridRegular.h"
 #include "../libgrid/gridReader.h"
 #include "../libgrid/gridReaderFactory.h"
 #include "../libgrid/gridWriter.h"
 #include "../libgrid/gridWriterFactory.h"
 #include "../libgrid/gridPatch.h"
+#include "../libgrid/gridRegularFFT.h"
+#include "../libdata/dataVar.h"
+#include "../libdata/dataVarType.h"
+#include <math.h>
+#include <complex.h>
 
 
 /*--- Implemention of main structure ------------------------------------*/
@@ -50,6 +56,12 @@ local_setupFromRNG(g9pWN_t     wn,
                    gridPatch_t patch,
                    int         idxOfDensVar);
 
+static double complex
+local_getMode(const rng_t             rng,
+              const gridPointUint32_t mode,
+              const gridPointUint32_t dims,
+              double                  sigma);
+
 
 /*--- Implementations of exported functios ------------------------------*/
 extern g9pWN_t
@@ -65,6 +77,18 @@ g9pWN_newFromIni(parse_ini_t ini, const char *sectionName)
 	           ini, "useFile", sectionName);
 	getFromIni(&(wn->dumpWhiteNoise), parse_ini_get_bool,
 	           ini, "dumpWhiteNoise", sectionName);
+	if (!parse_ini_get_bool(ini, "useKSpace", sectionName,
+	                        &(wn->useKSpace)))
+		wn->useKSpace = false;
+	if (!parse_ini_get_bool(ini, "useBatchedGauss", sectionName,
+	                        &(wn->useBatchedGauss)))
+		wn->useBatchedGauss = false;
+	if (wn->useKSpace && (wn->useFile || wn->dumpWhiteNoise)) {
+		fprintf(stderr,
+		        "useKSpace cannot be used with useFile or "
+		        "dumpWhiteNoise.\n");
+		diediedie(EXIT_FAILURE);
+	}
 
 	wn->reader = NULL;
 	wn->rng    = NULL;
@@ -109,6 +133,80 @@ g9pWN_setup(g9pWN_t       wn,
 		local_setupFromRNG(wn, patch, idxOfDensVar);
 }
 
+extern bool
+g9pWN_useKSpace(const g9pWN_t wn)
+{
+	assert(wn != NULL);
+
+	return wn->useKSpace;
+}
+
+extern bool
+g9pWN_isLayoutIndependent(const g9pWN_t wn)
+{
+	assert(wn != NULL);
+
+	return wn->useKSpace || wn->useFile;
+}
+
+extern void
+g9pWN_setupFFTed(g9pWN_t          wn,
+                 gridRegular_t    grid,
+                 gridRegularFFT_t gridFFT)
+{
+	gridRegular_t     gridFFTed;
+	gridPatch_t       patch;
+	gridPointUint32_t dims, dimsPatch, idxLo;
+	int               curDim[NDIM];
+	void              *data;
+	bool              isFloat;
+	uint64_t          numCells;
+	double            sigma;
+
+	assert(wn != NULL);
+	assert(wn->useKSpace);
+	assert(grid != NULL);
+	assert(gridFFT != NULL);
+
+	gridRegularFFT_initFFTed(gridFFT);
+	gridFFTed = gridRegularFFT_getGridFFTed(gridFFT);
+	patch     = gridRegular_getPatchHandle(gridFFTed, 0);
+	gridPatch_getDims(patch, dimsPatch);
+	gridPatch_getIdxLo(patch, idxLo);
+	data      = gridPatch_getVarDataHandle(patch, 0);
+	isFloat   = dataVarType_isNativeFloat(
+	    dataVar_getType(gridPatch_getVarHandle(patch, 0)));
+	numCells  = gridPatch_getNumCells(patch);
+	for (int i = 0; i < NDIM; i++)
+		curDim[i] = gridRegular_getCurrentDim(gridFFTed, i);
+	gridRegular_getDims(grid, dims);
+	// The standard deviation of the real and imaginary part of a mode of
+	// the (unnormalised) forward transform of unit white noise.
+	sigma = sqrt(0.5 * gridRegular_getNumCellsTotal(grid));
+
+#ifdef WITH_OPENMP
+#  pragma omp parallel for shared(data, isFloat, numCells, dimsPatch, \
+	idxLo, curDim, dims, sigma, wn)
+#endif
+	for (uint64_t j = 0; j < numCells; j++) {
+		gridPointUint32_t pos, mode;
+		uint64_t          tmp = j;
+
+		for (int i = 0; i < NDIM; i++) {
+			pos[i] = (uint32_t)(tmp % dimsPatch[i]) + idxLo[i];
+			tmp   /= dimsPatch[i];
+		}
+		for (int i = 0; i < NDIM; i++)
+			mode[i] = pos[curDim[i]];
+		if (isFloat)
+			((float complex *)data)[j] = local_getMode(wn->rng, mode,
+			                                           dims, sigma);
+		else
+			((double complex *)data)[j] = local_getMode(wn->rng, mode,
+			                                            dims, sigma);
+	}
+}
+
 extern void
 g9pWN_reset(g9pWN_t wn)
 {
@@ -142,9 +240,11 @@ local_newGetInput(g9pWN_t     wn,
 	} else {
 		char *rngSectionName;
 #ifndef WITH_SPRNG
-		fprintf(stderr,
-		        "WITH_SPRNG must be defined to use random numbers.\n");
-		diediedie(EXIT_FAILURE);
+		if (!wn->useKSpace) {
+			fprintf(stderr,
+			        "WITH_SPRNG must be defined to use random numbers.\n");
+			diediedie(EXIT_FAILURE);
+		}
 #endif
 		getFromIni(&rngSectionName, parse_ini_get_string,
 		           ini, "rngSectionName", sectionName);
@@ -178,24 +278,79 @@ local_setupFromRNG(g9pWN_t     wn,
                    int         idxOfDensVar)
 {
 	int      numStreams;
-	fpv_t    *data;
+	void     *data;
+	bool     isFloat;
 	uint64_t numCells = 0;
 
 	data       = gridPatch_getVarDataHandle(patch, idxOfDensVar);
+	isFloat    = dataVarType_isNativeFloat(
+	    dataVar_getType(gridPatch_getVarHandle(patch, idxOfDensVar)));
 	numCells   = gridPatch_getNumCells(patch);
 	numStreams = rng_getNumStreamsLocal(wn->rng);
 
 #ifdef _OPENMP
-#  pragma omp parallel for shared(data, numStreams, numCells)
+#  pragma omp parallel for shared(data, isFloat, numStreams, numCells)
 #endif
 	for (int i = 0; i < numStreams; i++) {
 		uint64_t cps   = numCells / numStreams;
 		uint64_t start = i * cps;
 		uint64_t stop  = (i == numStreams - 1) ? numCells : (start
 		                                                     + cps);
-		for (uint64_t j = start; j < stop; j++) {
-			assert(j < numCells);
-			data[j] = (fpv_t)rng_getGaussUnit(wn->rng, i);
+		assert(stop <= numCells);
+		if (wn->useBatchedGauss) {
+			if (isFloat)
+				rng_fillGaussUnitFloat(wn->rng, i, (float *)data + start,
+				                       stop - start);
+			else
+				rng_fillGaussUnitDouble(wn->rng, i, (double *)data + start,
+				                        stop - start);
+		} else {
+			for (uint64_t j = start; j < stop; j++) {
+				if (isFloat)
+					((float *)data)[j] = (float)rng_getGaussUnit(wn->rng, i);
+				else
+					((double *)data)[j] = rng_getGaussUnit(wn->rng, i);
+			}
 		}
 	}
 }
+
+static double complex
+local_getMode(const rng_t             rng,
+              const gridPointUint32_t mode,
+              const gridPointUint32_t dims,
+              double                  sigma)
+{
+	uint64_t idx     = 0;
+	uint64_t idxConj = 0;
+	double   re, im;
+
+	// Global indices of the mode and of its conjugate in the r2c layout
+	// (dimension 0 is halved) in original dimension order.
+	for (int i = NDIM - 1; i > 0; i--) {
+		idx     = idx * dims[i] + mode[i];
+		idxConj = idxConj * dims[i] + (dims[i] - mode[i]) % dims[i];
+	}
+	idx     = idx * (dims[0] / 2 + 1) + mode[0];
+	idxConj = idxConj * (dims[0] / 2 + 1) + mode[0];
+
+	// Only on the zero and the Nyquist plane of dimension 0 the
+	// conjugate mode is stored as well.  Both are derived from the one
+	// with the smaller index and the self-conjugate modes are real.
+	if ((mode[0] == 0) || (2 * mode[0] == dims[0])) {
+		if (idx == idxConj) {
+			re = M_SQRT2 * sigma * rng_getGaussUnitAtIndex(rng, 2 * idx);
+			return re;
+		}
+		if (idxConj < idx) {
+			re = sigma * rng_getGaussUnitAtIndex(rng, 2 * idxConj);
+			im = -sigma * rng_getGaussUnitAtIndex(rng, 2 * idxConj + 1);
+			return re + im * I;
+		}
+	}
+
+	re = sigma * rng_getGaussUnitAtIndex(rng, 2 * idx);
+	im = sigma * rng_getGaussUnitAtIndex(rng, 2 * idx + 1);
+
+	return re + im * I;
+}
@@ -19,6 +19,8 @@
 #include "g9pConfig.h"
 #include "../libutil/parse_ini.h"
 #include "../libgrid/gridRegular.h"
+#include "../libgrid/gridRegularFFT.h"
+#include <stdbool.h>
 
 
 /*--- ADT handle --------------------------------------------------------*/
@@ -49,6 +51,62 @@ g9pWN_setup(g9pWN_t       wn,
             gridRegular_t grid,
             int           idxOfDensVar);
 
+/**
+ * @brief  Checks whether the white noise is generated directly in
+ *         k-space.
+ *
+ * @param[in]  wn
+ *                The WN module to query.
+ *
+ * @return  Returns @c true if g9pWN_setupFFTed() has to be used instead
+ *          of g9pWN_setup() and @c false otherwise.
+ */
+extern bool
+g9pWN_useKSpace(const g9pWN_t wn);
+
+/**
+ * @brief  Checks whether the white noise is independent of the number of
+ *         MPI processes.
+ *
+ * Noise read from a file or generated in k-space is the same for every
+ * process grid, noise generated in real space is not.
+ *
+ * @param[in]  wn
+ *                The WN module to query.
+ *
+ * @return  Returns @c true if the noise does not depend on the layout.
+ */
+extern bool
+g9pWN_isLayoutIndependent(const g9pWN_t wn);
+
+/**
+ * @brief  Fills the Fourier space grid of an FFT object with the Fourier
+ *         modes of a white noise field.
+ *
+ * The modes have the statistics of an unnormalised forward transform
+ * of a real white noise field of unit variance on @c grid, including the
+ * Hermitian symmetry on the planes of the r2c dimension that hold their
+ * own conjugates.  Every mode is generated from the seed and its global
+ * position alone, the result does therefore not depend on the
+ * distribution of the grid or the number of threads.
+ *
+ * @param[in,out]  wn
+ *                    The WN module to use, it must generate the white
+ *                    noise in k-space, see g9pWN_useKSpace().
+ * @param[in]      grid
+ *                    The real space grid of the FFT.
+ * @param[in,out]  gridFFT
+ *                    The FFT object whose Fourier space grid is filled.
+ *                    Afterwards it is in the state a forward transform
+ *                    would have left it in.
+ *
+ * @return  Returns nothing.
+ */
+extern void
+g9pWN_setupFFTed(g9pWN_t          wn,
+                 gridRegular_t    grid,
+                 gridRegularFFT_t gridFFT);
+
 extern void
 g9pWN_dump(g9pWN_t wn, gridRegular_t grid);
 
@@ -94,8 +152,25 @@ g9pWN_reset(g9pWN_t wn);
  * # information for the RNG can be found. 
  * rngSectionName = <string>
  * #
+ * # Optional: Selects whether the white noise is drawn directly as
+ * # Fourier modes, which saves the forward FFT.  This cannot be combined
+ * # with dumpWhiteNoise = true.  Defaults to false.
+ * useKSpace = <true|false>
+ * #
+ * # Optional: Selects whether the white noise is drawn with the batched
+ * # Gaussian sampler rng_fillGaussUnit() instead of one value at a time
+ * # with rng_getGaussUnit().  The batched sampler is faster, but gives a
+ * # different realisation for the same seed.  Defaults to false.
+ * useBatchedGauss = <true|false>
+ * #
  * @endcode
  *
+ * With <tt>useKSpace = true</tt> each Fourier mode is computed from the
+ * random seed and its position in the grid only, so the same seed gives
+ * the same field for any number of tasks and threads, and SPRNG is not
+ * needed.  The field is, however, a different realisation than the one
+ * obtained with <tt>useKSpace = false</tt> and the same seed.
+ *
  * To see how the RNG is constructed, see @ref libutilMiscRNGIniFormat.
  *
  * If instead a file should be used, then the section should look
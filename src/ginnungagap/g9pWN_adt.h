@@ -29,6 +29,10 @@
 struct g9pWN_struct {
 	/** @brief  Flags whether the WN is read from a file.  */
 	bool         useFile;
+	/** @brief  Flags whether the WN is generated directly in k-space. */
+	bool         useKSpace;
+	/** @brief  Flags whether the batched Gaussian sampler is used. */
+	bool         useBatchedGauss;
 	/** @brief  Gives, if appropriate, the WN reader.  */
 	gridReader_t reader;
 	/** @brief  The RNG to use. */
@@ -18,12 +18,14 @@
 #include "g9pInit.h"
 #include "g9pWN.h"
 #include "g9pIC.h"
+#include "g9pCheckpoint.h"
 #include <stdlib.h>
 #include <math.h>
 #include <stdio.h>
 #include <stdbool.h>
 #include <assert.h>
 #include <inttypes.h>
+#include <string.h>
 #ifdef WITH_MPI
 #  include <mpi.h>
 #endif
@@ -34,6 +36,7 @@
 #include "../libutil/xstring.h"
 #include "../libutil/xfile.h"
 #include "../libutil/timer.h"
+#include "../libutil/prof.h"
 #include "../libutil/filename.h"
 #include "../libutil/utilMath.h"
 #include "../libcosmo/cosmo.h"
@@ -42,6 +45,7 @@
 #include "../libdata/dataVarType.h"
 #include "../libgrid/gridWriter.h"
 #include "../libgrid/gridWriterFactory.h"
+#include "../libgrid/gridWriterAsync.h"
 #include "../libgrid/gridStatistics.h"
 #include "../libgrid/gridHistogram.h"
 #ifdef WITH_FFT_FFTW3
@@ -62,11 +66,85 @@ static gridRegularDistrib_t
 local_getGridDistrib(ginnungagap_t g9p);
 
 static int
-local_initGrid(gridRegular_t grid, gridRegularDistrib_t distrib);
+local_initGrid(gridRegular_t        grid,
+               gridRegularDistrib_t distrib,
+               dataVarType_t        varType,
+               bool                 useInPlaceFFT);
 
 static gridRegularFFT_t
 local_getFFT(ginnungagap_t g9p);
 
+/**
+ * @brief  Makes sure the real space field can be filled.
+ *
+ * With in-place FFTs the field is allocated with the FFTW padding, but
+ * it is filled (and used) in the unpadded layout.  Without in-place FFTs
+ * this does nothing.
+ *
+ * @param[in,out]  g9p
+ *                    The application to work with.
+ *
+ * @return  Returns nothing.
+ */
+static void
+local_prepareRealSpace(ginnungagap_t g9p);
+
+/**
+ * @brief  Transforms the field to Fourier space.
+ *
+ * With in-place FFTs the (unpadded) real space field is padded in its
+ * memory before the transform.
+ *
+ * @param[in,out]  g9p
+ *                    The application to work with.
+ *
+ * @return  Returns nothing.
+ */
+static void
+local_doFFTForward(ginnungagap_t g9p);
+
+/**
+ * @brief  Transforms the field back to real space.
+ *
+ * With in-place FFTs the padding is squeezed out of the real space field
+ * after the transform, so that all users of the field see the unpadded
+ * layout.
+ *
+ * @param[in,out]  g9p
+ *                    The application to work with.
+ *
+ * @return  Returns nothing.
+ */
+static void
+local_doFFTBackward(ginnungagap_t g9p);
+
+/**
+ * @brief  Moves the rows of a field between the unpadded and the FFTW
+ *         padded layout.
+ *
+ * @param[in,out]  *data
+ *                    The field, its memory must be large enough for the
+ *                    padded layout.
+ * @param[in]      numRows
+ *                    The number of rows (cells divided by the first
+ *                    dimension).
+ * @param[in]      dim0
+ *                    The unpadded length of a row.
+ * @param[in]      size
+ *                    The size of one element in bytes.
+ * @param[in]      doPad
+ *                    If @c true, the field is padded, otherwise the
+ *                    padding is removed.
+ *
+ * @return  Returns nothing.
+ */
+static void
+local_moveRowsForPadding(char     *data,
+                         uint64_t numRows,
+                         uint32_t dim0,
+                         size_t   size,
+                         bool     doPad);
+
 static void
 local_newHistograms(ginnungagap_t g9p);
 
@@ -88,6 +166,11 @@ local_doDeltaX(ginnungagap_t g9p);
 static void
 local_doVelocities(ginnungagap_t g9p, g9pICMode_t mode);
 
+static void
+local_doVelocityField(ginnungagap_t g9p,
+                      g9pICMode_t   mode,
+                      const char    *nameHistogram);
+
 static void
 local_doStatistics(ginnungagap_t g9p, int idxOfVar);
 
@@ -97,32 +180,176 @@ local_doHistogram(ginnungagap_t         g9p,
                   const gridHistogram_t stat,
                   const char            *histoName);
 
+static filename_t
+local_doRenames(dataVar_t var, const char *newName);
+
+/**
+ * @brief  Checks whether a field has been completed by an earlier run.
+ *
+ * @param[in,out]  g9p
+ *                    The application to work with.
+ * @param[in]      *fieldName
+ *                    The name of the field.
+ *
+ * @return  Returns @c true if the field can be skipped, always @c false
+ *          if no checkpoints are kept.
+ */
+static bool
+local_fieldIsDone(ginnungagap_t g9p, const char *fieldName);
+
+/**
+ * @brief  Records a completed field in the checkpoint.
+ *
+ * The pending writes are completed first, so that the checkpoint never
+ * refers to files that are still being written.
+ *
+ * @param[in,out]  g9p
+ *                    The application to work with.
+ * @param[in]      *fieldName
+ *                    The name of the field.
+ * @param[in]      numOutputs
+ *                    The number of grids written for the field.
+ * @param[in]      **outputNames
+ *                    The names under which the grids were written (see
+ *                    local_doRenames()).
+ *
+ * @return  Returns nothing.
+ */
 static void
-local_doRenames(dataVar_t var, gridWriter_t writer, const char *newName);
+local_setFieldDone(ginnungagap_t g9p,
+                   const char    *fieldName,
+                   int           numOutputs,
+                   const char    **outputNames);
 
+/**
+ * @brief  Calculates the second order velocity fields.
+ *
+ * The overdensity field in Fourier space is generated once more and
+ * cached, it is then reused for all six second derivatives of the
+ * potential.  The resulting second order source is transformed back to
+ * Fourier space and cached in place of the overdensity field, from which
+ * the three velocity components are derived and written.  Apart from the
+ * grid itself, at most three fields (the cache and two real space fields
+ * for the accumulation of the source) are held in memory at any time.
+ *
+ * @param[in,out]  g9p
+ *                    The application to work with.
+ *
+ * @return  Returns nothing.
+ */
 static void
 local_do2LPTCorrections(ginnungagap_t g9p);
 
+/**
+ * @brief  Copies the Fourier space data of the FFT into a cache.
+ *
+ * @param[in]      g9p
+ *                    The application to work with.
+ * @param[in,out]  *cache
+ *                    The cache to copy the data to.  If this is @c NULL,
+ *                    a new cache of the required size is allocated.
+ *
+ * @return  Returns the cache.
+ */
+static void *
+local_cacheFFTed(ginnungagap_t g9p, void *cache);
+
+/**
+ * @brief  Fills the Fourier space grid of the FFT from a cache.
+ *
+ * @param[in,out]  g9p
+ *                    The application to work with.  The grid must be in
+ *                    real space.
+ * @param[in]      *cache
+ *                    The cache, as filled by local_cacheFFTed().
+ *
+ * @return  Returns nothing.
+ */
+static void
+local_restoreFFTed(ginnungagap_t g9p, const void *cache);
+
+/**
+ * @brief  Calculates the second order source in real space.
+ *
+ * This evaluates
+ * @f[
+ *    S = \sum_{i<j} \left( \phi_{,ii}\phi_{,jj} - \phi_{,ij}^2 \right)
+ * @f]
+ * by streaming through the second derivatives of the potential.  The
+ * diagonal terms are accumulated as
+ * @f$ S = \phi_{,00}\phi_{,11} + (\phi_{,00} + \phi_{,11})\phi_{,22} @f$
+ * so that only the running sum of the diagonal derivatives needs to be
+ * kept besides the source itself, the off-diagonal terms are subtracted
+ * directly.
+ *
+ * @param[in,out]  g9p
+ *                    The application to work with.
+ * @param[in]      *deltaK
+ *                    The cached overdensity field in Fourier space.
+ *
+ * @return  Returns a newly allocated array holding the source for the
+ *          local patch of the real space grid.
+ */
+static void *
+local_do2LPTSource(ginnungagap_t g9p, const void *deltaK);
+
+/**
+ * @brief  Calculates a second derivative of the potential in real space.
+ *
+ * @param[in,out]  g9p
+ *                    The application to work with.
+ * @param[in]      *deltaK
+ *                    The cached overdensity field in Fourier space.
+ * @param[in]      d1
+ *                    The direction of the first derivative.
+ * @param[in]      d2
+ *                    The direction of the second derivative.
+ *
+ * @return  Returns a handle to the real space data of the grid, which
+ *          holds the derivative until the next transform.
+ */
+static void *
+local_doDDPhi(ginnungagap_t g9p, const void *deltaK, uint32_t d1, uint32_t d2);
+
 
 /*--- Implementations of exported functios ------------------------------*/
 extern ginnungagap_t
 ginnungagap_new(parse_ini_t ini)
+{
+	assert(ini != NULL);
+
+	return ginnungagap_newWithWriter(ini,
+	                                 gridWriterFactory_newWriterFromIni(
+	                                     ini, "Output"));
+}
+
+extern ginnungagap_t
+ginnungagap_newWithWriter(parse_ini_t ini, gridWriter_t writer)
 {
 	ginnungagap_t g9p;
 
 	assert(ini != NULL);
+	assert(writer != NULL);
 
 	g9p              = xmalloc(sizeof(struct ginnungagap_struct));
 	g9p->setup       = g9pSetup_new(ini);
+	if (g9p->setup->profilePrefix != NULL)
+		prof_enable();
 	g9p->model       = cosmoModel_newFromIni(ini, "Cosmology");
 	g9p->pk          = cosmoPk_newFromIni(ini, "Cosmology");
 	g9p->whiteNoise  = g9pWN_newFromIni(ini,
 	                                    "WhiteNoise");
 	g9p->grid        = local_getGrid(g9p);
 	g9p->gridDistrib = local_getGridDistrib(g9p);
-	g9p->posOfDens   = local_initGrid(g9p->grid, g9p->gridDistrib);
+	g9p->posOfDens   = local_initGrid(g9p->grid, g9p->gridDistrib,
+	                                  g9p->setup->varType,
+	                                  g9p->setup->useInPlaceFFT);
 	g9p->gridFFT     = local_getFFT(g9p);
-	g9p->finalWriter = gridWriterFactory_newWriterFromIni(ini, "Output");
+	g9p->finalWriter = writer;
+	g9p->asyncWriter = gridWriterAsync_new(g9p->finalWriter,
+	                                       ((uint64_t)
+	                                        g9p->setup->writeAsyncMaxMB)
+	                                       << 20);
 	g9p->rank        = 0;
 	g9p->size        = 1;
 	g9p->numThreads  = 1;
@@ -130,11 +357,26 @@ ginnungagap_new(parse_ini_t ini)
 #ifdef WITH_MPI
 	MPI_Comm_rank(MPI_COMM_WORLD, &(g9p->rank));
 	MPI_Comm_rank(MPI_COMM_WORLD, &(g9p->size));
-	gridWriter_initParallel(g9p->finalWriter, MPI_COMM_WORLD);
+	g9p->writerComm = MPI_COMM_NULL;
+	if (gridWriterAsync_isAsync(g9p->asyncWriter)) {
+		MPI_Comm_dup(MPI_COMM_WORLD, &(g9p->writerComm));
+		gridWriter_initParallel(g9p->finalWriter, g9p->writerComm);
+	} else {
+		gridWriter_initParallel(g9p->finalWriter, MPI_COMM_WORLD);
+	}
 #endif
+	if ((g9p->setup->writeAsyncMaxMB > 0)
+	    && !gridWriterAsync_isAsync(g9p->asyncWriter) && (g9p->rank == 0))
+		fprintf(stderr, "Writing in the background is not available, "
+		        "the fields will be written synchronously.\n");
 #ifdef WITH_OPENMP
 	g9p->numThreads = omp_get_num_threads();
 #endif
+	g9p->checkpoint = NULL;
+	if (g9p->setup->checkpointFileName != NULL)
+		g9p->checkpoint = g9pCheckpoint_new(
+		    g9p->setup->checkpointFileName, ini,
+		    !g9pWN_isLayoutIndependent(g9p->whiteNoise));
 
 	return g9p;
 }
@@ -167,109 +409,55 @@ ginnungagap_run(ginnungagap_t g9p)
 	if (g9p->rank == 0)
 		printf("\nGenerating IC:\n\n");
 
-	local_doWhiteNoise(g9p, true);
-	local_doWhiteNoisePk(g9p);
-	local_doDeltaK(g9p);
-	local_doDeltaKPk(g9p);
-	local_doDeltaX(g9p);
-	local_doStatistics(g9p, 0);
-	if (g9p->setup->doHistograms)
-		local_doHistogram(g9p, 0, g9p->histoDens,
-		                  g9p->setup->nameHistogramDens);
-	if (g9p->rank == 0)
-		printf("\n");
-
-	if (!g9p->setup->doSmallScale) {
+	if (!local_fieldIsDone(g9p, "delta")) {
+		const char *outputName = "delta";
 
-	g9pWN_reset(g9p->whiteNoise);
-	local_doWhiteNoise(g9p, false);
-	local_doDeltaK(g9p);
-	local_doVelocities(g9p, G9PIC_MODE_VX);
-	local_doStatistics(g9p, 0);
-	if (g9p->setup->doHistograms)
-		local_doHistogram(g9p, 0, g9p->histoVel,
-		                  g9p->setup->nameHistogramVelx);
-	if (g9p->rank == 0)
-		printf("\n");
-
-	g9pWN_reset(g9p->whiteNoise);
-	local_doWhiteNoise(g9p, false);
-	local_doDeltaK(g9p);
-	local_doVelocities(g9p, G9PIC_MODE_VY);
-	local_doStatistics(g9p, 0);
-	if (g9p->setup->doHistograms)
-		local_doHistogram(g9p, 0, g9p->histoVel,
-		                  g9p->setup->nameHistogramVely);
+		local_doWhiteNoise(g9p, true);
+		local_doWhiteNoisePk(g9p);
+		local_doDeltaK(g9p);
+		local_doDeltaKPk(g9p);
+		local_doDeltaX(g9p);
+		local_doStatistics(g9p, 0);
+		if (g9p->setup->doHistograms)
+			local_doHistogram(g9p, 0, g9p->histoDens,
+			                  g9p->setup->nameHistogramDens);
+		local_setFieldDone(g9p, "delta",
+		                   g9p->setup->writeDensityField ? 1 : 0,
+		                   &outputName);
+	}
 	if (g9p->rank == 0)
 		printf("\n");
 
-	g9pWN_reset(g9p->whiteNoise);
-	local_doWhiteNoise(g9p, false);
-	local_doDeltaK(g9p);
-	local_doVelocities(g9p, G9PIC_MODE_VZ);
-	local_doStatistics(g9p, 0);
-	if (g9p->setup->doHistograms)
-		local_doHistogram(g9p, 0, g9p->histoVel,
-		                  g9p->setup->nameHistogramVelz);
-	if (g9p->rank == 0)
-		printf("\n");
+	if (!g9p->setup->doSmallScale) {
+		local_doVelocityField(g9p, G9PIC_MODE_VX,
+		                      g9p->setup->nameHistogramVelx);
+		local_doVelocityField(g9p, G9PIC_MODE_VY,
+		                      g9p->setup->nameHistogramVely);
+		local_doVelocityField(g9p, G9PIC_MODE_VZ,
+		                      g9p->setup->nameHistogramVelz);
 	}
-	
+
 	if (g9p->setup->doLargeScale) {
-		g9pWN_reset(g9p->whiteNoise);
-		local_doWhiteNoise(g9p, false);
-		local_doDeltaK(g9p);
-		local_doVelocities(g9p, G9PIC_MODE_LVX);
-		local_doStatistics(g9p, 0);
-		if (g9p->rank == 0)
-			printf("\n");
-	
-		g9pWN_reset(g9p->whiteNoise);
-		local_doWhiteNoise(g9p, false);
-		local_doDeltaK(g9p);
-		local_doVelocities(g9p, G9PIC_MODE_LVY);
-		local_doStatistics(g9p, 0);
-		if (g9p->rank == 0)
-			printf("\n");
-	
-		g9pWN_reset(g9p->whiteNoise);
-		local_doWhiteNoise(g9p, false);
-		local_doDeltaK(g9p);
-		local_doVelocities(g9p, G9PIC_MODE_LVZ);
-		local_doStatistics(g9p, 0);
-		if (g9p->rank == 0)
-			printf("\n");
+		local_doVelocityField(g9p, G9PIC_MODE_LVX, NULL);
+		local_doVelocityField(g9p, G9PIC_MODE_LVY, NULL);
+		local_doVelocityField(g9p, G9PIC_MODE_LVZ, NULL);
 	}
-	
+
 	if (g9p->setup->doSmallScale) {
-		g9pWN_reset(g9p->whiteNoise);
-		local_doWhiteNoise(g9p, false);
-		local_doDeltaK(g9p);
-		local_doVelocities(g9p, G9PIC_MODE_SVX);
-		local_doStatistics(g9p, 0);
-		if (g9p->rank == 0)
-			printf("\n");
-	
-		g9pWN_reset(g9p->whiteNoise);
-		local_doWhiteNoise(g9p, false);
-		local_doDeltaK(g9p);
-		local_doVelocities(g9p, G9PIC_MODE_SVY);
-		local_doStatistics(g9p, 0);
-		if (g9p->rank == 0)
-			printf("\n");
-	
-		g9pWN_reset(g9p->whiteNoise);
-		local_doWhiteNoise(g9p, false);
-		local_doDeltaK(g9p);
-		local_doVelocities(g9p, G9PIC_MODE_SVZ);
-		local_doStatistics(g9p, 0);
-		if (g9p->rank == 0)
-			printf("\n");
+		local_doVelocityField(g9p, G9PIC_MODE_SVX, NULL);
+		local_doVelocityField(g9p, G9PIC_MODE_SVY, NULL);
+		local_doVelocityField(g9p, G9PIC_MODE_SVZ, NULL);
 	}
-	
-	
+
 	if (g9p->setup->do2LPTCorrections)
 		local_do2LPTCorrections(g9p);
+
+	if (gridWriterAsync_isAsync(g9p->asyncWriter)) {
+		double timing;
+		timing = timer_start_text("Waiting for the background writes... ");
+		gridWriterAsync_flush(g9p->asyncWriter);
+		timing = timer_stop_text(timing, "took %.5fs\n");
+	}
 } /* ginnungagap_run */
 
 extern void
@@ -278,19 +466,30 @@ ginnungagap_del(ginnungagap_t *g9p)
 	assert(g9p != NULL);
 	assert(*g9p != NULL);
 
+	if ((*g9p)->setup->profilePrefix != NULL) {
+		prof_report((*g9p)->setup->profilePrefix);
+		prof_reset();
+	}
 	if ((*g9p)->histoVel != NULL)
 		gridHistogram_del(&((*g9p)->histoVel));
 	if ((*g9p)->histoDens != NULL)
 		gridHistogram_del(&((*g9p)->histoDens));
 	if ((*g9p)->histoWN != NULL)
 		gridHistogram_del(&((*g9p)->histoWN));
+	if ((*g9p)->checkpoint != NULL)
+		g9pCheckpoint_del(&((*g9p)->checkpoint));
 	cosmoPk_del(&((*g9p)->pk));
 	cosmoModel_del(&((*g9p)->model));
 	g9pWN_del(&((*g9p)->whiteNoise));
 	gridRegularFFT_del(&((*g9p)->gridFFT));
 	gridRegularDistrib_del(&((*g9p)->gridDistrib));
 	gridRegular_del(&((*g9p)->grid));
+	gridWriterAsync_del(&((*g9p)->asyncWriter));
 	gridWriter_del(&((*g9p)->finalWriter));
+#ifdef WITH_MPI
+	if ((*g9p)->writerComm != MPI_COMM_NULL)
+		MPI_Comm_free(&((*g9p)->writerComm));
+#endif
 	g9pSetup_del(&((*g9p)->setup));
 	xfree(*g9p);
 	*g9p = NULL;
@@ -325,15 +524,33 @@ local_getGridDistrib(ginnungagap_t g9p)
 
 	distrib = gridRegularDistrib_new(g9p->grid, NULL);
 #ifdef WITH_MPI
+	{
+		gridPointUint32_t dims;
+		int               size;
+
+		gridRegular_getDims(g9p->grid, dims);
+		MPI_Comm_size(MPI_COMM_WORLD, &size);
+		(void)gridRegularDistrib_calcNProcsForDecomp(
+		    g9p->setup->decomposition, dims, size, g9p->setup->nProcs);
+	}
 	gridRegularDistrib_initMPI(distrib, g9p->setup->nProcs,
 	                           MPI_COMM_WORLD);
+	gridRegularDistrib_setNumTransposeRounds(distrib,
+	                                         g9p->setup->numTransposeRounds);
+	gridRegularDistrib_setNumOverlapChunks(distrib,
+	                                       g9p->setup->numOverlapChunks);
+	gridRegularDistrib_setUsePersistentSchedules(
+	    distrib, g9p->setup->usePersistentSchedules);
 #endif
 
 	return distrib;
 }
 
 static int
-local_initGrid(gridRegular_t grid, gridRegularDistrib_t distrib)
+local_initGrid(gridRegular_t        grid,
+               gridRegularDistrib_t distrib,
+               dataVarType_t        varType,
+               bool                 useInPlaceFFT)
 {
 	int         localRank = 0;
 	gridPatch_t patch;
@@ -346,13 +563,16 @@ local_initGrid(gridRegular_t grid, gridRegularDistrib_t distrib)
 	                                               localRank);
 	gridRegular_attachPatch(grid, patch);
 
-	dens = dataVar_new("wn", DATAVARTYPE_FPV, 1);
+	dens = dataVar_new("wn", varType, 1);
+	// The FFT decides on the in-place transforms by the padding of the
+	// variable at its creation.
+	if (useInPlaceFFT)
+		dataVar_setFFTWPadded(dens);
 #ifdef WITH_FFT_FFTW3
-#  ifdef ENABLE_DOUBLE
-	dataVar_setMemFuncs(dens, &fftw_malloc, &fftw_free);
-#  else
-	dataVar_setMemFuncs(dens, &fftwf_malloc, &fftwf_free);
-#  endif
+	if (dataVarType_isNativeFloat(varType))
+		dataVar_setMemFuncs(dens, &fftwf_malloc, &fftwf_free);
+	else
+		dataVar_setMemFuncs(dens, &fftw_malloc, &fftw_free);
 #endif
 	return gridRegular_attachVar(grid, dens);
 }
@@ -369,6 +589,92 @@ local_getFFT(ginnungagap_t g9p)
 	return fft;
 }
 
+static void
+local_prepareRealSpace(ginnungagap_t g9p)
+{
+	gridPatch_t patch;
+	dataVar_t   var;
+
+	if (!g9p->setup->useInPlaceFFT)
+		return;
+
+	patch = gridRegular_getPatchHandle(g9p->grid, 0);
+	var   = gridPatch_getVarHandle(patch, g9p->posOfDens);
+	if (dataVar_isFFTWPadded(var)) {
+		// Allocates the padded size if the memory is with the FFT.
+		(void)gridPatch_getVarDataHandle(patch, g9p->posOfDens);
+		dataVar_unsetFFTWPadded(var);
+	}
+}
+
+static void
+local_doFFTForward(ginnungagap_t g9p)
+{
+	if (g9p->setup->useInPlaceFFT) {
+		gridPatch_t       patch = gridRegular_getPatchHandle(g9p->grid, 0);
+		dataVar_t         var;
+		gridPointUint32_t dims;
+
+		var = gridPatch_getVarHandle(patch, g9p->posOfDens);
+		assert(!dataVar_isFFTWPadded(var));
+		gridPatch_getDims(patch, dims);
+		local_moveRowsForPadding(gridPatch_getVarDataHandle(patch,
+		                                                    g9p->posOfDens),
+		                         gridPatch_getNumCells(patch) / dims[0],
+		                         dims[0], dataVar_getSizePerElement(var),
+		                         true);
+		dataVar_setFFTWPadded(var);
+	}
+	gridRegularFFT_execute(g9p->gridFFT, GRIDREGULARFFT_FORWARD);
+}
+
+static void
+local_doFFTBackward(ginnungagap_t g9p)
+{
+	gridPatch_t       patch;
+	dataVar_t         var;
+	gridPointUint32_t dims;
+
+	if (!g9p->setup->useInPlaceFFT) {
+		gridRegularFFT_execute(g9p->gridFFT, GRIDREGULARFFT_BACKWARD);
+		return;
+	}
+
+	patch = gridRegular_getPatchHandle(g9p->grid, 0);
+	var   = gridPatch_getVarHandle(patch, g9p->posOfDens);
+	dataVar_setFFTWPadded(var);
+	gridRegularFFT_execute(g9p->gridFFT, GRIDREGULARFFT_BACKWARD);
+	gridPatch_getDims(patch, dims);
+	local_moveRowsForPadding(gridPatch_getVarDataHandle(patch,
+	                                                    g9p->posOfDens),
+	                         gridPatch_getNumCells(patch) / dims[0],
+	                         dims[0], dataVar_getSizePerElement(var),
+	                         false);
+	dataVar_unsetFFTWPadded(var);
+}
+
+static void
+local_moveRowsForPadding(char     *data,
+                         uint64_t numRows,
+                         uint32_t dim0,
+                         size_t   size,
+                         bool     doPad)
+{
+	size_t lenRow       = dim0 * size;
+	size_t lenRowPadded = 2 * (dim0 / 2 + 1) * size;
+
+	// The rows overlap, hence padding has to start at the end and
+	// unpadding at the beginning.
+	if (doPad) {
+		for (uint64_t j = numRows; j > 0; j--)
+			memmove(data + (j - 1) * lenRowPadded,
+			        data + (j - 1) * lenRow, lenRow);
+	} else {
+		for (uint64_t j = 0; j < numRows; j++)
+			memmove(data + j * lenRow, data + j * lenRowPadded, lenRow);
+	}
+}
+
 static void
 local_newHistograms(ginnungagap_t g9p)
 {
@@ -392,7 +698,17 @@ local_doWhiteNoise(ginnungagap_t g9p, bool doDumpOfWhiteNoise)
 {
 	double timing;
 
+	prof_start("whiteNoise");
+	if (g9pWN_useKSpace(g9p->whiteNoise)) {
+		timing = timer_start_text("  Setting up white noise in k-space... ");
+		g9pWN_setupFFTed(g9p->whiteNoise, g9p->grid, g9p->gridFFT);
+		timing = timer_stop_text(timing, "took %.5fs\n");
+		prof_stop("whiteNoise");
+		return;
+	}
+
 	timing = timer_start_text("  Setting up white noise... ");
+	local_prepareRealSpace(g9p);
 	g9pWN_setup(g9p->whiteNoise,
 	            g9p->grid,
 	            g9p->posOfDens);
@@ -408,8 +724,9 @@ local_doWhiteNoise(ginnungagap_t g9p, bool doDumpOfWhiteNoise)
 	}
 
 	timing = timer_start_text("  Going to k-space... ");
-	gridRegularFFT_execute(g9p->gridFFT, GRIDREGULARFFT_FORWARD);
+	local_doFFTForward(g9p);
 	timing = timer_stop_text(timing, "took %.5fs\n");
+	prof_stop("whiteNoise");
 }
 
 static void
@@ -419,6 +736,7 @@ local_doWhiteNoisePk(ginnungagap_t g9p)
 	cosmoPk_t pk;
 
 	if (g9p->setup->dim1D >= G9P_MINGRIDSIZE_FOR_PS) {
+		prof_start("pk");
 		timing = timer_start_text("  Calculating P(k) for white noise... ");
 		pk     = g9pIC_calcPkFromDelta(g9p->gridFFT,
 		                               g9p->setup->dim1D,
@@ -426,6 +744,7 @@ local_doWhiteNoisePk(ginnungagap_t g9p)
 		cosmoPk_dumpToFile(pk, g9p->setup->namePkWN, 1);
 		cosmoPk_del(&pk);
 		timing = timer_stop_text(timing, "took %.5fs\n");
+		prof_stop("pk");
 	}
 }
 
@@ -434,12 +753,14 @@ local_doDeltaK(ginnungagap_t g9p)
 {
 	double timing;
 
+	prof_start("deltaK");
 	timing = timer_start_text("  Generating delta(k)... ");
 	g9pIC_calcDeltaFromWN(g9p->gridFFT,
 	                      g9p->setup->dim1D,
 	                      g9p->setup->boxsizeInMpch,
 	                      g9p->pk);
 	timing = timer_stop_text(timing, "took %.5fs\n");
+	prof_stop("deltaK");
 }
 
 static void
@@ -449,6 +770,7 @@ local_doDeltaKPk(ginnungagap_t g9p)
 	cosmoPk_t pk;
 
 	if (g9p->setup->dim1D >= G9P_MINGRIDSIZE_FOR_PS) {
+		prof_start("pk");
 		timing = timer_start_text("  Calculating P(k) for delta(k)... ");
 		pk     = g9pIC_calcPkFromDelta(g9p->gridFFT,
 		                               g9p->setup->dim1D,
@@ -456,6 +778,7 @@ local_doDeltaKPk(ginnungagap_t g9p)
 		cosmoPk_dumpToFile(pk, g9p->setup->namePkDeltak, 1);
 		cosmoPk_del(&pk);
 		timing = timer_stop_text(timing, "took %.5fs\n");
+		prof_stop("pk");
 	}
 }
 
@@ -464,26 +787,27 @@ local_doDeltaX(ginnungagap_t g9p)
 {
 	double    timing;
 #ifdef ENABLE_WRITING
-	dataVar_t var;
+	dataVar_t  var;
+	filename_t fn;
 #endif
 
+	prof_start("deltaX");
 	timing = timer_start_text("  Going back to real space... ");
-	gridRegularFFT_execute(g9p->gridFFT, GRIDREGULARFFT_BACKWARD);
+	local_doFFTBackward(g9p);
 	timing = timer_stop_text(timing, "took %.5fs\n");
 
 #ifdef ENABLE_WRITING
 	var = gridRegular_getVarHandle(g9p->grid, g9p->posOfDens);
 	if (g9p->setup->writeDensityField) {
 		timing = timer_start_text("  Writing delta(x) to file... ");
-		local_doRenames(var, g9p->finalWriter, "delta");
-		gridWriter_activate(g9p->finalWriter);
-		gridWriter_writeGridRegular(g9p->finalWriter,
-		                            g9p->grid);
-		gridWriter_deactivate(g9p->finalWriter);
+		fn     = local_doRenames(var, "delta");
+		gridWriterAsync_writeGridRegular(g9p->asyncWriter, g9p->grid, fn);
+		filename_del(&fn);
 		dataVar_rename(var, "wn");
 		timing = timer_stop_text(timing, "took %.5fs\n");
 	}
 #endif
+	prof_stop("deltaX");
 }
 
 static void
@@ -492,9 +816,11 @@ local_doVelocities(ginnungagap_t g9p, g9pICMode_t mode)
 	double    timing;
 	char      *msg = NULL, *msg2 = NULL;
 #ifdef ENABLE_WRITING
-	dataVar_t var;
+	dataVar_t  var;
+	filename_t fn;
 #endif
 
+	prof_start(g9pIC_getModeStr(mode));
 	msg    = xstrmerge("  Generating ", g9pIC_getModeStr(mode));
 	msg2   = xstrmerge(msg, "(k)... ");
 	timing = timer_start_text(msg2);
@@ -510,7 +836,7 @@ local_doVelocities(ginnungagap_t g9p, g9pICMode_t mode)
 	xfree(msg);
 
 	timing = timer_start_text("  Going back to real space... ");
-	gridRegularFFT_execute(g9p->gridFFT, GRIDREGULARFFT_BACKWARD);
+	local_doFFTBackward(g9p);
 	timing = timer_stop_text(timing, "took %.5fs\n");
 
 #ifdef ENABLE_WRITING
@@ -519,30 +845,52 @@ local_doVelocities(ginnungagap_t g9p, g9pICMode_t mode)
 	timing = timer_start_text(msg2);
 	var    = gridRegular_getVarHandle(g9p->grid,
 	                                  g9p->posOfDens);
-	local_doRenames(var, g9p->finalWriter, g9pIC_getModeStr(mode));
+	fn     = local_doRenames(var, g9pIC_getModeStr(mode));
 	dataVar_rename(var, g9pIC_getModeStr(mode%3));
-	gridWriter_activate(g9p->finalWriter);
-	gridWriter_writeGridRegular(g9p->finalWriter,
-	                            g9p->grid);
-	gridWriter_deactivate(g9p->finalWriter);
+	gridWriterAsync_writeGridRegular(g9p->asyncWriter, g9p->grid, fn);
+	filename_del(&fn);
 	dataVar_rename(var, "wn");
 	timing = timer_stop_text(timing, "took %.5fs\n");
 	xfree(msg2);
 	xfree(msg);
 #endif
+	prof_stop(g9pIC_getModeStr(mode));
 } /* local_doVelocities */
 
+static void
+local_doVelocityField(ginnungagap_t g9p,
+                      g9pICMode_t   mode,
+                      const char    *nameHistogram)
+{
+	const char *outputName = g9pIC_getModeStr(mode);
+
+	if (!local_fieldIsDone(g9p, outputName)) {
+		g9pWN_reset(g9p->whiteNoise);
+		local_doWhiteNoise(g9p, false);
+		local_doDeltaK(g9p);
+		local_doVelocities(g9p, mode);
+		local_doStatistics(g9p, 0);
+		if ((nameHistogram != NULL) && g9p->setup->doHistograms)
+			local_doHistogram(g9p, 0, g9p->histoVel, nameHistogram);
+		local_setFieldDone(g9p, outputName, 1, &outputName);
+	}
+	if (g9p->rank == 0)
+		printf("\n");
+}
+
 static void
 local_doStatistics(ginnungagap_t g9p, int idxOfVar)
 {
 	double           timing;
 	gridStatistics_t stat;
 
+	prof_start("statistics");
 	timing = timer_start_text("  Calculating statistics... ");
 	stat   = gridStatistics_new();
 	gridStatistics_calcGridRegularDistrib(stat, g9p->gridDistrib,
 	                                      idxOfVar);
 	timing = timer_stop_text(timing, "took %.5fs\n");
+	prof_stop("statistics");
 	if (g9p->rank == 0)
 		gridStatistics_printPretty(stat, stdout, "  ");
 	gridStatistics_del(&stat);
@@ -556,9 +904,11 @@ local_doHistogram(ginnungagap_t         g9p,
 {
 	double timing;
 
+	prof_start("histogram");
 	timing = timer_start_text("  Calculating histogram... ");
 	gridHistogram_calcGridRegularDistrib(histo, g9p->gridDistrib, idxOfVar);
 	timing = timer_stop_text(timing, "took %.5fs\n");
+	prof_stop("histogram");
 
 	if (g9p->rank == 0) {
 		gridHistogram_printPrettyFile(histo, histoName, false, "");
@@ -566,23 +916,281 @@ local_doHistogram(ginnungagap_t         g9p,
 	}
 }
 
-static void
-local_doRenames(dataVar_t var, gridWriter_t writer, const char *newName)
+static filename_t
+local_doRenames(dataVar_t var, const char *newName)
 {
-	filename_t fn = filename_clone(gridWriter_getFileName(writer));
+	filename_t fn = filename_new();
 	char *qualifier = xstrmerge("_", newName);
 
+	// Only the qualifier is set, the overlay keeps the rest of the name
+	// of the writer.
 	filename_setQualifier(fn, qualifier);
 
 	dataVar_rename(var, newName);
-	gridWriter_overlayFileName(writer, fn);
 
 	xfree(qualifier);
-	filename_del(&fn);
+
+	return fn;
 }
 
+static bool
+local_fieldIsDone(ginnungagap_t g9p, const char *fieldName)
+{
+	bool isDone;
+
+	if (g9p->checkpoint == NULL)
+		return false;
+
+	isDone = g9pCheckpoint_isDone(g9p->checkpoint, fieldName);
+	if (isDone && (g9p->rank == 0))
+		printf("  %s is complete according to %s, skipping it.\n",
+		       fieldName, g9p->setup->checkpointFileName);
+
+	return isDone;
+}
+
+static void
+local_setFieldDone(ginnungagap_t g9p,
+                   const char    *fieldName,
+                   int           numOutputs,
+                   const char    **outputNames)
+{
+	double     timing;
+	const char **fileNames;
+	filename_t *fns;
+
+	if (g9p->checkpoint == NULL)
+		return;
+
+	// Without a file name (e.g. a writer keeping the grids in memory) there
+	// is nothing to restart from.
+	if (gridWriter_getFileName(g9p->finalWriter) == NULL)
+		return;
+
+	timing = timer_start_text("  Updating the checkpoint... ");
+	if (gridWriterAsync_isAsync(g9p->asyncWriter))
+		gridWriterAsync_flush(g9p->asyncWriter);
+
+	fileNames = xmalloc(sizeof(char *) * (numOutputs + 1));
+	fns       = xmalloc(sizeof(filename_t) * (numOutputs + 1));
+	for (int i = 0; i < numOutputs; i++) {
+		char *qualifier = xstrmerge("_", outputNames[i]);
+
+		// This mirrors the overlay of local_doRenames().
+		fns[i] = filename_clone(gridWriter_getFileName(g9p->finalWriter));
+		filename_setQualifier(fns[i], qualifier);
+		fileNames[i] = filename_getFullName(fns[i]);
+		xfree(qualifier);
+	}
+
+	g9pCheckpoint_setDone(g9p->checkpoint, fieldName, numOutputs, fileNames);
+
+	for (int i = 0; i < numOutputs; i++)
+		filename_del(fns + i);
+	xfree(fns);
+	xfree(fileNames);
+	timing = timer_stop_text(timing, "took %.5fs\n");
+} /* local_setFieldDone */
 
 static void
 local_do2LPTCorrections(ginnungagap_t g9p)
 {
+	double      timing;
+	void        *cache;
+	void        *source, *data;
+	gridPatch_t patch;
+	uint64_t    numCells;
+	const char  *outputNames[NDIM];
+
+	if (g9p->rank == 0)
+		printf("Calculating 2LPT corrections:\n\n");
+	if (local_fieldIsDone(g9p, "2lpt"))
+		return;
+
+	g9pWN_reset(g9p->whiteNoise);
+	local_doWhiteNoise(g9p, false);
+	local_doDeltaK(g9p);
+	cache  = local_cacheFFTed(g9p, NULL);
+
+	prof_start("2lptSource");
+	source = local_do2LPTSource(g9p, cache);
+
+	timing   = timer_start_text("  Going to k-space... ");
+	patch    = gridRegular_getPatchHandle(g9p->grid, 0);
+	local_prepareRealSpace(g9p);
+	numCells = gridPatch_getNumCells(patch);
+	data     = gridPatch_getVarDataHandle(patch, g9p->posOfDens);
+	memcpy(data, source,
+	       dataVar_getSizePerElement(
+	           gridPatch_getVarHandle(patch, g9p->posOfDens)) * numCells);
+	xmem_trackFree(source);
+	xfree(source);
+	local_doFFTForward(g9p);
+	timing = timer_stop_text(timing, "took %.5fs\n");
+	prof_stop("2lptSource");
+	(void)local_cacheFFTed(g9p, cache);
+	if (g9p->rank == 0)
+		printf("\n");
+
+	for (int i = 0; i < NDIM; i++) {
+		local_restoreFFTed(g9p, cache);
+		local_doVelocities(g9p, G9PIC_MODE_VX2LPT + i);
+		local_doStatistics(g9p, 0);
+		if (g9p->rank == 0)
+			printf("\n");
+	}
+
+	xmem_trackFree(cache);
+	xfree(cache);
+
+	// The three components share the source, they are redone together.
+	for (int i = 0; i < NDIM; i++)
+		outputNames[i] = g9pIC_getModeStr(G9PIC_MODE_VX2LPT + i);
+	local_setFieldDone(g9p, "2lpt", NDIM, outputNames);
+} /* local_do2LPTCorrections */
+
+static void *
+local_cacheFFTed(ginnungagap_t g9p, void *cache)
+{
+	gridPatch_t patch;
+	size_t      size;
+
+	patch = gridRegular_getPatchHandle(
+	    gridRegularFFT_getGridFFTed(g9p->gridFFT), 0);
+	size  = gridPatch_getNumCells(patch)
+	        * dataVar_getSizePerElement(gridPatch_getVarHandle(patch, 0));
+
+	if (cache == NULL) {
+		cache = xmalloc(size);
+		xmem_trackAlloc(cache, size, "2lpt");
+	}
+	memcpy(cache, gridPatch_getVarDataHandle(patch, 0), size);
+
+	return cache;
+}
+
+static void
+local_restoreFFTed(ginnungagap_t g9p, const void *cache)
+{
+	gridPatch_t patch;
+	size_t      size;
+
+	gridRegularFFT_initFFTed(g9p->gridFFT);
+	patch = gridRegular_getPatchHandle(
+	    gridRegularFFT_getGridFFTed(g9p->gridFFT), 0);
+	size  = gridPatch_getNumCells(patch)
+	        * dataVar_getSizePerElement(gridPatch_getVarHandle(patch, 0));
+
+	memcpy(gridPatch_getVarDataHandle(patch, 0), cache, size);
+}
+
+static void *
+local_do2LPTSource(ginnungagap_t g9p, const void *deltaK)
+{
+	const uint32_t offDiag[3][2] = { { 0, 1 }, { 0, 2 }, { 1, 2 } };
+	gridPatch_t    patch;
+	uint64_t       numCells;
+	size_t         sizePerElement;
+	bool           isFloat;
+	void           *source, *sumDiag, *phi;
+
+	patch          = gridRegular_getPatchHandle(g9p->grid, 0);
+	numCells       = gridPatch_getNumCells(patch);
+	sizePerElement = dataVar_getSizePerElement(
+	    gridPatch_getVarHandle(patch, g9p->posOfDens));
+	isFloat        = dataVarType_isNativeFloat(dataVar_getType(
+	                     gridPatch_getVarHandle(patch, g9p->posOfDens)));
+	source         = xmalloc(sizePerElement * numCells);
+	sumDiag        = xmalloc(sizePerElement * numCells);
+	xmem_trackAlloc(source, sizePerElement * numCells, "2lpt");
+	xmem_trackAlloc(sumDiag, sizePerElement * numCells, "2lpt");
+
+	phi = local_doDDPhi(g9p, deltaK, 0, 0);
+	memcpy(sumDiag, phi, sizePerElement * numCells);
+
+	phi = local_doDDPhi(g9p, deltaK, 1, 1);
+	if (isFloat) {
+		float       *s = source, *sd = sumDiag;
+		const float *p = phi;
+#ifdef WITH_OPENMP
+#  pragma omp parallel for shared(s, sd, p, numCells)
+#endif
+		for (uint64_t i = 0; i < numCells; i++) {
+			s[i]   = sd[i] * p[i];
+			sd[i] += p[i];
+		}
+	} else {
+		double       *s = source, *sd = sumDiag;
+		const double *p = phi;
+#ifdef WITH_OPENMP
+#  pragma omp parallel for shared(s, sd, p, numCells)
+#endif
+		for (uint64_t i = 0; i < numCells; i++) {
+			s[i]   = sd[i] * p[i];
+			sd[i] += p[i];
+		}
+	}
+
+	phi = local_doDDPhi(g9p, deltaK, 2, 2);
+	if (isFloat) {
+		float       *s = source, *sd = sumDiag;
+		const float *p = phi;
+#ifdef WITH_OPENMP
+#  pragma omp parallel for shared(s, sd, p, numCells)
+#endif
+		for (uint64_t i = 0; i < numCells; i++)
+			s[i] += sd[i] * p[i];
+	} else {
+		double       *s = source, *sd = sumDiag;
+		const double *p = phi;
+#ifdef WITH_OPENMP
+#  pragma omp parallel for shared(s, sd, p, numCells)
+#endif
+		for (uint64_t i = 0; i < numCells; i++)
+			s[i] += sd[i] * p[i];
+	}
+	xmem_trackFree(sumDiag);
+	xfree(sumDiag);
+
+	for (int j = 0; j < 3; j++) {
+		phi = local_doDDPhi(g9p, deltaK, offDiag[j][0], offDiag[j][1]);
+		if (isFloat) {
+			float       *s = source;
+			const float *p = phi;
+#ifdef WITH_OPENMP
+#  pragma omp parallel for shared(s, p, numCells)
+#endif
+			for (uint64_t i = 0; i < numCells; i++)
+				s[i] -= p[i] * p[i];
+		} else {
+			double       *s = source;
+			const double *p = phi;
+#ifdef WITH_OPENMP
+#  pragma omp parallel for shared(s, p, numCells)
+#endif
+			for (uint64_t i = 0; i < numCells; i++)
+				s[i] -= p[i] * p[i];
+		}
+	}
+
+	return source;
+} /* local_do2LPTSource */
+
+static void *
+local_doDDPhi(ginnungagap_t g9p, const void *deltaK, uint32_t d1, uint32_t d2)
+{
+	double timing;
+
+	local_restoreFFTed(g9p, deltaK);
+
+	timing = timer_start_text("  Generating phi_ij(k)... ");
+	g9pIC_calcDDPhiFromDelta(g9p->gridFFT, g9p->setup->dim1D, d1, d2);
+	timing = timer_stop_text(timing, "took %.5fs\n");
+
+	timing = timer_start_text("  Going back to real space... ");
+	local_doFFTBackward(g9p);
+	timing = timer_stop_text(timing, "took %.5fs\n");
+
+	return gridPatch_getVarDataHandle(
+	    gridRegular_getPatchHandle(g9p->grid, 0), g9p->posOfDens);
 }
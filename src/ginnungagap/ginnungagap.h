@@ -18,6 +18,7 @@
 /*--- Includes ----------------------------------------------------------*/
 #include "g9pConfig.h"
 #include "../libutil/parse_ini.h"
+#include "../libgrid/gridWriter.h"
 
 
 /*--- ADT handle --------------------------------------------------------*/
@@ -40,6 +41,27 @@ typedef struct ginnungagap_struct *ginnungagap_t;
 extern ginnungagap_t
 ginnungagap_new(parse_ini_t ini);
 
+
+/**
+ * @brief  Creates a new ginnungagap application object with a given
+ *         writer.
+ *
+ * This is the same as ginnungagap_new(), except that the fields are
+ * handed to the given writer instead of the one described in the
+ * @c Output section.
+ *
+ * @param[in,out]  ini
+ *                    The ini file to use.
+ * @param[in]      writer
+ *                    The writer for the fields.  The application takes
+ *                    over the reference and deletes it with
+ *                    gridWriter_del().
+ *
+ * @return  Returns a new ginnungagap application.
+ */
+extern ginnungagap_t
+ginnungagap_newWithWriter(parse_ini_t ini, gridWriter_t writer);
+
 extern void
 ginnungagap_init(ginnungagap_t g9p);
 
@@ -19,12 +19,17 @@
 #include "g9pConfig.h"
 #include "g9pSetup.h"
 #include "g9pWN.h"
+#include "g9pCheckpoint.h"
+#ifdef WITH_MPI
+#  include <mpi.h>
+#endif
 #include "../libcosmo/cosmoModel.h"
 #include "../libcosmo/cosmoPk.h"
 #include "../libgrid/gridRegular.h"
 #include "../libgrid/gridRegularDistrib.h"
 #include "../libgrid/gridRegularFFT.h"
 #include "../libgrid/gridWriter.h"
+#include "../libgrid/gridWriterAsync.h"
 #include "../libgrid/gridHistogram.h"
 
 
@@ -48,6 +53,14 @@ struct ginnungagap_struct {
 	gridRegularFFT_t     gridFFT;
 	/** @brief  The writer used to write the velocity fields. */
 	gridWriter_t         finalWriter;
+	/** @brief  Writes the fields with the final writer, maybe in the
+	 *          background. */
+	gridWriterAsync_t    asyncWriter;
+#ifdef WITH_MPI
+	/** @brief  The communicator of the final writer when writing in the
+	 *          background. */
+	MPI_Comm             writerComm; ///< Else @c MPI_COMM_NULL.
+#endif
 	/** @brief  The position of the density variable in the grid. */
 	int                  posOfDens;
 	/** @brief  The MPI rank of this tasks. */
@@ -62,6 +75,8 @@ struct ginnungagap_struct {
 	gridHistogram_t      histoDens;
 	/** @brief  The histogram used for velocities. */
 	gridHistogram_t      histoVel;
+	/** @brief  Records the completed fields for a restart. */
+	g9pCheckpoint_t      checkpoint; ///< @c NULL if no checkpoints are kept.
 };
 
 
@@ -54,6 +54,12 @@ bool localVerify = false;
  */
 bool localInitOnly = false;
 
+/**
+ * @brief  The rank of this process, kept for the final message which is
+ *         printed after MPI has been finalized.
+ */
+int localRank = 0;
+
 
 /*--- Prototypes of local functions -------------------------------------*/
 static void
@@ -107,15 +113,17 @@ main(int argc, char **argv)
 	local_initEnvironment(&argc, &argv);
 
 	g9p = local_getGinnungagap();
-	if (localVerify)
-		return EXIT_SUCCESS;
-
-	ginnungagap_init(g9p);
-	if (localInitOnly)
-		return EXIT_SUCCESS;
+	if (!localVerify) {
+		ginnungagap_init(g9p);
+		if (!localInitOnly) {
+			ginnungagap_run(g9p);
+			ginnungagap_del(&g9p);
+		}
+	}
 
-	ginnungagap_run(g9p);
-	ginnungagap_del(&g9p);
+#ifdef WITH_MPI
+	MPI_Finalize();
+#endif
 
 	return EXIT_SUCCESS;
 }
@@ -126,9 +134,17 @@ local_initEnvironment(int *argc, char ***argv)
 {
 	cmdline_t cmdline;
 
-#ifdef WITH_MPI
+#if (defined WITH_MPI && defined ENABLE_ASYNC_IO)
+	// The background writer communicates from its own thread; if the
+	// library cannot provide this, the fields are written synchronously.
+	int provided;
+	MPI_Init_thread(argc, argv, MPI_THREAD_MULTIPLE, &provided);
+#elif (defined WITH_MPI)
 	MPI_Init(argc, argv);
 #endif
+#ifdef WITH_MPI
+	MPI_Comm_rank(MPI_COMM_WORLD, &localRank);
+#endif
 #if (defined _OPENMP && WITH_FFT_FFTW3)
 	local_setThreadedFFTW();
 #endif
@@ -154,6 +170,8 @@ local_setThreadedFFTW(void)
 
 	fftw_init_threads();
 	fftw_plan_with_nthreads(omp_get_max_threads());
+	fftwf_init_threads();
+	fftwf_plan_with_nthreads(omp_get_max_threads());
 
 	if (rank == 0)
 		printf("Using %i threads\n", omp_get_max_threads());
@@ -179,16 +197,12 @@ local_registerCleanUpFunctions(void)
 static void
 local_finalMessage(void)
 {
-	int rank = 0;
 #if (defined _OPENMP && WITH_FFT_FFTW3)
 	fftw_cleanup_threads();
-#endif
-#ifdef WITH_MPI
-	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
-	//MPI_Finalize();
+	fftwf_cleanup_threads();
 #endif
 	xfree(localIniFname);
-	if (rank == 0) {
+	if (localRank == 0) {
 #ifdef XMEM_TRACK_MEM
 		printf("\n");
 		xmem_info(stdout);
@@ -139,6 +139,7 @@ extern void *
 dataVar_getMemory(dataVar_t var, uint64_t numElements)
 {
 	size_t sizeToAlloc;
+	void   *mem;
 
 	assert(var != NULL);
 	assert(numElements > UINT64_C(0));
@@ -146,9 +147,12 @@ dataVar_getMemory(dataVar_t var, uint64_t numElements)
 	sizeToAlloc = dataVar_getSizePerElement(var) * numElements;
 
 	if (var->mallocFunc != NULL)
-		return var->mallocFunc(sizeToAlloc);
+		mem = var->mallocFunc(sizeToAlloc);
+	else
+		mem = xmalloc(sizeToAlloc);
+	xmem_trackAlloc(mem, sizeToAlloc, NULL);
 
-	return xmalloc(sizeToAlloc);
+	return mem;
 }
 
 extern void *
@@ -174,6 +178,7 @@ dataVar_freeMemory(dataVar_t var, void *data)
 	assert(var != NULL);
 	assert(data != NULL);
 
+	xmem_trackFree(data);
 	if (var->freeFunc != NULL)
 		var->freeFunc(data);
 	else
@@ -259,6 +264,9 @@ dataVar_getMPIDatatype(dataVar_t var)
 		case DATAVARTYPE_DOUBLE:
 			dt = MPI_DOUBLE;
 			break;
+		case DATAVARTYPE_FLOAT:
+			dt = MPI_FLOAT;
+			break;
 		case DATAVARTYPE_INT:
 			dt = MPI_INT;
 			break;
@@ -292,6 +300,7 @@ dataVar_getMPICount(dataVar_t var, uint64_t numElements)
 	if (!dataVar_isComplexified(var)) {
 		switch (var->type) {
 		case DATAVARTYPE_DOUBLE:
+		case DATAVARTYPE_FLOAT:
 		case DATAVARTYPE_INT:
 		case DATAVARTYPE_INT8:
 		case DATAVARTYPE_FPV:
@@ -16,6 +16,7 @@
 #include "g9pConfig.h"
 #include "g9pICMap.h"
 #include <assert.h>
+#include <stdlib.h>
 #include <string.h>
 #include "../libutil/xmem.h"
 
@@ -26,8 +27,22 @@
 
 /*--- Local defines -----------------------------------------------------*/
 
+/** @brief  Used to sort the tiles by their key. */
+struct local_tileKey_struct {
+	/** @brief  The key of the tile. */
+	uint64_t key;
+	/** @brief  The index of the tile. */
+	uint32_t tile;
+};
+
 
 /*--- Prototypes of local functions -------------------------------------*/
+static void
+local_calcOrder(g9pICMap_t map, lIdxOrder_t order);
+
+static int
+local_cmpTileKey(const void *a, const void *b);
+
 static void
 local_calcIdx(g9pICMap_t map, uint32_t zoomlevel);
 
@@ -42,6 +57,18 @@ g9pICMap_new(uint32_t     numFiles,
              const int8_t *gasLevel,
              g9pMask_t    mask,
              uint32_t zoomlevel)
+{
+	return g9pICMap_newOrdered(numFiles, numGasLevel, gasLevel, mask,
+	                           zoomlevel, LIDX_ORDER_LINEAR);
+}
+
+extern g9pICMap_t
+g9pICMap_newOrdered(uint32_t     numFiles,
+                    uint32_t     numGasLevel,
+                    const int8_t *gasLevel,
+                    g9pMask_t    mask,
+                    uint32_t     zoomlevel,
+                    lIdxOrder_t  order)
 {
 	g9pICMap_t map;
 
@@ -68,6 +95,7 @@ g9pICMap_new(uint32_t     numFiles,
 	map->numCells     = xmalloc(sizeof(uint64_t)
 	                            * (map->numFiles * numLevel));
 
+	local_calcOrder(map, order);
 	local_calcIdx(map,zoomlevel);
 	local_calcNumCellsPerFile(map);
 
@@ -79,6 +107,7 @@ g9pICMap_del(g9pICMap_t *g9pICMap)
 {
 	assert(g9pICMap != NULL && *g9pICMap != NULL);
 
+	xfree((*g9pICMap)->tileAt);
 	xfree((*g9pICMap)->firstTileIdx);
 	xfree((*g9pICMap)->numCells);
 	if ((*g9pICMap)->gasLevel != NULL)
@@ -96,13 +125,14 @@ g9pICMap_getFileForTile(const g9pICMap_t map, const uint32_t tile)
 	assert(map != NULL);
 	assert(tile < g9pMask_getTotalNumTiles(map->mask));
 
+	uint32_t pos  = map->posOfTile[tile];
 	uint32_t file = 0;
-	while ((file < map->numFiles) && (map->lastTileIdx[file] < tile)) {
+	while ((file < map->numFiles) && (map->lastTileIdx[file] < pos)) {
 		file++;
 	}
 	assert(file < map->numFiles);
-	assert(map->lastTileIdx[file] >= tile);
-	assert(map->firstTileIdx[file] <= tile);
+	assert(map->lastTileIdx[file] >= pos);
+	assert(map->firstTileIdx[file] <= pos);
 
 	return file;
 }
@@ -125,6 +155,23 @@ g9pICMap_getLastTileInFile(const g9pICMap_t map, const uint32_t file)
 	return map->lastTileIdx[file];
 }
 
+extern uint32_t
+g9pICMap_getTileAt(const g9pICMap_t map, const uint32_t pos)
+{
+	assert(map != NULL);
+	assert(pos < g9pMask_getTotalNumTiles(map->mask));
+
+	return map->tileAt[pos];
+}
+
+extern const uint32_t *
+g9pICMap_getTileOrder(const g9pICMap_t map)
+{
+	assert(map != NULL);
+
+	return map->tileAt;
+}
+
 extern const uint64_t *
 g9pICMap_getNumCellsPerLevelInFile(const g9pICMap_t map,
                                    const uint32_t   file)
@@ -136,6 +183,45 @@ g9pICMap_getNumCellsPerLevelInFile(const g9pICMap_t map,
 }
 
 /*--- Implementations of local functions --------------------------------*/
+static void
+local_calcOrder(g9pICMap_t map, lIdxOrder_t order)
+{
+	uint32_t                    numTiles = g9pMask_getTotalNumTiles(map->mask);
+	const uint32_t              *dims    = g9pMask_getNumTiles(map->mask);
+	int                         bits     = lIdx_getNumBits3d(dims);
+	struct local_tileKey_struct *tileKeys;
+
+	map->tileAt    = xmalloc(sizeof(uint32_t) * numTiles * 2);
+	map->posOfTile = map->tileAt + numTiles;
+
+	tileKeys = xmalloc(sizeof(struct local_tileKey_struct) * numTiles);
+	for (uint32_t i = 0; i < numTiles; i++) {
+		uint32_t coords[3];
+		lIdx_toCoord3d(i, dims, coords);
+		tileKeys[i].key  = lIdx_toKey3d(order, coords, dims, bits);
+		tileKeys[i].tile = i;
+	}
+	// The linear keys are already sorted.
+	if (order != LIDX_ORDER_LINEAR)
+		qsort(tileKeys, numTiles, sizeof(struct local_tileKey_struct),
+		      &local_cmpTileKey);
+
+	for (uint32_t i = 0; i < numTiles; i++) {
+		map->tileAt[i]                   = tileKeys[i].tile;
+		map->posOfTile[tileKeys[i].tile] = i;
+	}
+	xfree(tileKeys);
+}
+
+static int
+local_cmpTileKey(const void *a, const void *b)
+{
+	const struct local_tileKey_struct *ka = a;
+	const struct local_tileKey_struct *kb = b;
+
+	return (ka->key < kb->key) ? -1 : ((ka->key > kb->key) ? 1 : 0);
+}
+
 static void
 local_calcIdx(g9pICMap_t map, uint32_t zoomlevel)
 {
@@ -144,7 +230,9 @@ local_calcIdx(g9pICMap_t map, uint32_t zoomlevel)
 	//uint32_t tilePerFile  = numTilesLeft / map->numFiles;
 	uint64_t numCellsTot = 0;
 	for (uint32_t i=0; i<numTiles; i++) {
-		numCellsTot+=g9pMask_getNumCellsInTileForLevel(map->mask, i, zoomlevel);
+		numCellsTot+=g9pMask_getNumCellsInTileForLevel(map->mask,
+		                                               map->tileAt[i],
+		                                               zoomlevel);
 	}
 	uint64_t numCellsLeft = numCellsTot;
 	uint32_t cellsPerFile = numCellsLeft / map->numFiles;
@@ -155,7 +243,9 @@ local_calcIdx(g9pICMap_t map, uint32_t zoomlevel)
 	uint32_t numCells = 0;
 	uint32_t file = 0;
 	for (uint32_t i = 0; i < numTiles; i++) {
-		numCells += g9pMask_getNumCellsInTileForLevel(map->mask, i, zoomlevel);
+		numCells += g9pMask_getNumCellsInTileForLevel(map->mask,
+		                                              map->tileAt[i],
+		                                              zoomlevel);
 		if (numCells >= cellsPerFile) {
 			map->lastTileIdx[file] = i;
 			numCellsLeft -= numCells;
@@ -186,7 +276,7 @@ local_calcNumCellsPerFile(g9pICMap_t map)
 		for (int8_t k = 0; k < numLevel; k++)
 			map->numCells[i * numLevel + k] = UINT64_C(0);
 		do {
-			tmp = g9pMask_getNumCellsInTile(map->mask, j, tmp);
+			tmp = g9pMask_getNumCellsInTile(map->mask, map->tileAt[j], tmp);
 			for (int8_t k = 0; k < numLevel; k++)
 				map->numCells[i * numLevel + k] += tmp[k];
 		} while (++j <= map->lastTileIdx[i]);
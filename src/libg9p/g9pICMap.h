@@ -18,6 +18,7 @@
 /*--- Includes ----------------------------------------------------------*/
 #include "g9pConfig.h"
 #include "g9pMask.h"
+#include "../libutil/lIdx.h"
 
 
 /*--- ADT handle --------------------------------------------------------*/
@@ -52,6 +53,39 @@ g9pICMap_new(uint32_t     numFiles,
              g9pMask_t    mask,
              uint32_t zoomlevel);
 
+/**
+ * @brief  Creates a map in which the tiles follow a given ordering.
+ *
+ * This is g9pICMap_new(), except that the tiles are not distributed to
+ * the files in the order of their index but sorted by the position of
+ * their lower corner along the requested curve.  The first and last tiles
+ * of a file are then positions in this ordering, which are translated to
+ * tiles with g9pICMap_getTileAt().  For #LIDX_ORDER_LINEAR positions and
+ * tiles are identical.
+ *
+ * @param[in]  numFiles
+ *                See g9pICMap_new().
+ * @param[in]  numGasLevel
+ *                See g9pICMap_new().
+ * @param[in]  *gasLevel
+ *                See g9pICMap_new().
+ * @param[in]  mask
+ *                See g9pICMap_new().
+ * @param[in]  zoomlevel
+ *                The level whose cells are balanced between the files.
+ * @param[in]  order
+ *                The ordering of the tiles.
+ *
+ * @return  Returns a new map.
+ */
+extern g9pICMap_t
+g9pICMap_newOrdered(uint32_t     numFiles,
+                    uint32_t     numGasLevel,
+                    const int8_t *gasLevel,
+                    g9pMask_t    mask,
+                    uint32_t     zoomlevel,
+                    lIdxOrder_t  order);
+
 extern void
 g9pICMap_del(g9pICMap_t *g9pICMap);
 
@@ -64,6 +98,32 @@ g9pICMap_getFirstTileInFile(const g9pICMap_t map, const uint32_t file);
 extern uint32_t
 g9pICMap_getLastTileInFile(const g9pICMap_t map, const uint32_t file);
 
+/**
+ * @brief  Translates a position in the ordering of the map to a tile.
+ *
+ * @param[in]  map
+ *                The map to query.
+ * @param[in]  pos
+ *                The position, as returned by g9pICMap_getFirstTileInFile()
+ *                and g9pICMap_getLastTileInFile().
+ *
+ * @return  Returns the index of the tile in the mask.
+ */
+extern uint32_t
+g9pICMap_getTileAt(const g9pICMap_t map, const uint32_t pos);
+
+/**
+ * @brief  Retrieves the tiles in the ordering of the map.
+ *
+ * @param[in]  map
+ *                The map to query.
+ *
+ * @return  Returns an array holding for each position the tile, the map
+ *          keeps ownership of it.
+ */
+extern const uint32_t *
+g9pICMap_getTileOrder(const g9pICMap_t map);
+
 extern const uint64_t *
 g9pICMap_getNumCellsPerLevelInFile(const g9pICMap_t map,
                                    const uint32_t   file);
@@ -80,6 +140,11 @@ g9pICMap_getNumCellsPerLevelInFile(const g9pICMap_t map,
  * tiles in file.  IOW, the aim is to be able to ask two questions, firstly,
  * in which file is a given tile, and secondly, which tiles are in a given
  * file.
+ *
+ * Every file holds a consecutive range of tiles.  By default the tiles are
+ * taken in the order of their index, g9pICMap_newOrdered() instead lines
+ * them up along a Morton or Peano-Hilbert curve, so that the tiles of a
+ * file form a compact region.
  */
 
 #endif
@@ -29,6 +29,8 @@ struct g9pICMap_struct {
 	g9pMask_t      mask;
 	g9pHierarchy_t hierarchy;
 	// Computed information
+	uint32_t       *tileAt;    // Stores the tiles in the order of the files
+	uint32_t       *posOfTile; // Stores for each tile its position in tileAt
 	uint32_t       *firstTileIdx; // Stores for each file the first tile idx
 	uint32_t       *lastTileIdx;  // Stores for each file the last tile idx
 	uint64_t 		*numCells; // Stores for each file cell counts
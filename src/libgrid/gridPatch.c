@@ -337,12 +337,15 @@ gridPatch_allocateVarData(gridPatch_t patch, int idxOfVarData)
 	data = varArr_getElementHandle(patch->varData, idxOfVarData);
 
 	if (data == NULL) {
-		dataVar_t var;
-		uint64_t  numCellsToAllocate = 1;
+		dataVar_t  var;
+		uint64_t   numCellsToAllocate = 1;
+		const char *tag;
 		var                = gridPatch_getVarHandle(patch, idxOfVarData);
 		numCellsToAllocate = gridPatch_getNumCellsActual(patch,
 		                                                 idxOfVarData);
+		tag                = xmem_setTrackTag("grid");
 		data               = dataVar_getMemory(var, numCellsToAllocate);
+		(void)xmem_setTrackTag(tag);
 		(void)varArr_replace(patch->varData, idxOfVarData, data);
 	}
 
@@ -466,14 +469,14 @@ gridPatch_transpose(gridPatch_t patch,
 	patch->dims[dimB]  = tmp;
 }
 
-extern void *
-gridPatch_getWindowedDataCopy(const gridPatch_t patch,
-                              int               idxVar,
-                              gridPointUint32_t idxLo,
-                              gridPointUint32_t idxHi,
-                              uint64_t          *numElements)
+extern uint64_t
+gridPatch_getWindowedData(const gridPatch_t patch,
+                          int               idxVar,
+                          gridPointUint32_t idxLo,
+                          gridPointUint32_t idxHi,
+                          void              *dataCopy)
 {
-	void              *data, *dataCopy;
+	void              *data;
 	gridPointUint32_t dimsWindow;
 	uint64_t          num = 1;
 	dataVar_t         var;
@@ -483,6 +486,7 @@ gridPatch_getWindowedDataCopy(const gridPatch_t patch,
 
 	assert(patch != NULL);
 	assert((idxVar >= 0) && (idxVar < gridPatch_getNumVars(patch)));
+	assert(dataCopy != NULL);
 	assert(idxLo[0] >= patch->idxLo[0]);
 	assert(idxHi[0] < patch->idxLo[0] + patch->dims[0]);
 	assert(idxLo[1] >= patch->idxLo[1]);
@@ -496,7 +500,6 @@ gridPatch_getWindowedDataCopy(const gridPatch_t patch,
 
 	var            = gridPatch_getVarHandle(patch, idxVar);
 	data           = gridPatch_getVarDataHandle(patch, idxVar);
-	dataCopy       = dataVar_getMemory(var, num);
 	sizePerElement = dataVar_getSizePerElement(var);
 
 #if (NDIM == 2)
@@ -525,6 +528,28 @@ gridPatch_getWindowedDataCopy(const gridPatch_t patch,
 	}
 #endif
 
+	return num;
+} /* gridPatch_getWindowedData */
+
+extern void *
+gridPatch_getWindowedDataCopy(const gridPatch_t patch,
+                              int               idxVar,
+                              gridPointUint32_t idxLo,
+                              gridPointUint32_t idxHi,
+                              uint64_t          *numElements)
+{
+	void              *dataCopy;
+	gridPointUint32_t dimsWindow;
+	uint64_t          num = 1;
+
+	assert(patch != NULL);
+	assert((idxVar >= 0) && (idxVar < gridPatch_getNumVars(patch)));
+
+	local_getWindowDims(idxLo, idxHi, dimsWindow, &num);
+
+	dataCopy = dataVar_getMemory(gridPatch_getVarHandle(patch, idxVar), num);
+	(void)gridPatch_getWindowedData(patch, idxVar, idxLo, idxHi, dataCopy);
+
 	if (numElements != NULL)
 		*numElements = num;
 
@@ -652,6 +677,12 @@ local_transposeVar(gridPatch_t patch,
 	uint32_t          tmp;
 	uint64_t          numCellsActual;
 	void              *dataT;
+	const char        *tag;
+
+	// Unallocated data has no layout yet, it will be allocated with the
+	// transposed dimensions when it is first requested.
+	if (varArr_getElementHandle(patch->varData, idxOfVarData) == NULL)
+		return;
 
 	data           = gridPatch_getVarDataHandle(patch, idxOfVarData);
 	var            = gridPatch_getVarHandle(patch, idxOfVarData);
@@ -661,7 +692,9 @@ local_transposeVar(gridPatch_t patch,
 	dimsT[dimA]    = dimsT[dimB];
 	dimsT[dimB]    = tmp;
 	numCellsActual = gridPatch_getNumCellsActual(patch, idxOfVarData);
+	tag            = xmem_setTrackTag("grid");
 	dataT          = dataVar_getMemory(var, numCellsActual);
+	(void)xmem_setTrackTag(tag);
 
 	switch (size) {
 	default:
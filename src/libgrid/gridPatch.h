@@ -387,6 +387,41 @@ gridPatch_transpose(gridPatch_t patch,
                     int         dimB);
 
 
+/**
+ * @brief  Copies the variable data in a subset of the patch into a given
+ *         buffer.
+ *
+ * This is the same as gridPatch_getWindowedDataCopy(), but the data is
+ * written to memory provided by the caller, which allows to pack the
+ * windows of several variables into one buffer.
+ *
+ * @param[in]   patch
+ *                 The patch to work with.
+ * @param[in]   idxVar
+ *                 The variable for which to copy the data.
+ * @param[in]   idxLo
+ *                 The lower left corner of the window which should be
+ *                 copied.  This must be within the patch.
+ * @param[in]   idxHi
+ *                 The upper right corner of the window which should be
+ *                 copied.  This must be within the patch.
+ * @param[out]  *data
+ *                 The buffer that will receive the data, it must be large
+ *                 enough to hold the window.
+ *
+ * @return  Returns the number of elements that have been copied.
+ *
+ * @bug  This does not work for padded data, i.e. data for which the logical
+ *       patch dimension is different from the actual dimension.
+ */
+extern uint64_t
+gridPatch_getWindowedData(const gridPatch_t patch,
+                          int               idxVar,
+                          gridPointUint32_t idxLo,
+                          gridPointUint32_t idxHi,
+                          void              *data);
+
+
 /**
  * @brief  Performs a copy of the variable data in a subset of the patch.
  *
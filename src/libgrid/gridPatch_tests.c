@@ -984,6 +984,70 @@ gridPatch_getWindowedDataCopy_test(void)
 	return hasPassed ? true : false;
 } /* gridPatch_getWindowedDataCopy_test */
 
+extern bool
+gridPatch_getWindowedData_test(void)
+{
+	bool              hasPassed = true;
+	int               rank      = 0;
+	gridPatch_t       patch;
+	gridPointUint32_t idxLo;
+	gridPointUint32_t idxHi;
+	int               data[9];
+	int               offset         = 0;
+#ifdef XMEM_TRACK_MEM
+	size_t            allocatedBytes = global_allocated_bytes;
+#endif
+#ifdef WITH_MPI
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+#endif
+
+	if (rank == 0)
+		printf("Testing %s... ", __func__);
+
+	patch = local_getFakePatchForCopy();
+
+	for (int i = 0; i < NDIM; i++) {
+		idxLo[i] = 3;
+		idxHi[i] = 4;
+	}
+	// The last element must stay untouched.
+	data[8] = -1;
+	if (gridPatch_getWindowedData(patch, 0, idxLo, idxHi, data)
+	    != (NDIM == 2 ? 4 : 8))
+		hasPassed = false;
+#if (NDIM == 2)
+	for (int j = 3; j <= 4; j++) {
+		for (int i = 3; i <= 4; i++) {
+			int expected = i + j * (patch->idxLo[0] + patch->dims[0]);
+			if (data[offset++] != expected)
+				hasPassed = false;
+		}
+	}
+#elif (NDIM == 3)
+	for (int k = 3; k <= 4; k++) {
+		for (int j = 3; j <= 4; j++) {
+			for (int i = 3; i <= 4; i++) {
+				int expected = i + j * (patch->idxLo[0] + patch->dims[0])
+				               + k * (patch->idxLo[0] + patch->dims[0])
+				               * (patch->idxLo[1] + patch->dims[1]);
+				if (data[offset++] != expected)
+					hasPassed = false;
+			}
+		}
+	}
+#endif
+	if (data[8] != -1)
+		hasPassed = false;
+
+	gridPatch_del(&patch);
+#ifdef XMEM_TRACK_MEM
+	if (allocatedBytes != global_allocated_bytes)
+		hasPassed = false;
+#endif
+
+	return hasPassed ? true : false;
+} /* gridPatch_getWindowedData_test */
+
 extern bool
 gridPatch_putWindowedData_test(void)
 {
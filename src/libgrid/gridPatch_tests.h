@@ -211,6 +211,15 @@ gridPatch_transpose_test(void);
 extern bool
 gridPatch_getWindowedDataCopy_test(void);
 
+/**
+ * @brief  This will test gridPatch_getWindowedData().
+ *
+ * @return  Returns @c true if the test succeeded and @c false
+ *          otherwise.
+ */
+extern bool
+gridPatch_getWindowedData_test(void);
+
 /**
  * @brief  This will test gridPatch_putWindowedData().
  *
@@ -0,0 +1,342 @@
+// Copyright (C) 2013, Steffen Knollmann
+// Released under the terms of the GNU General Public License version 3.
+// This file is part of `ginnungagap'.
+
+
+/*--- Doxygen file description ------------------------------------------*/
+
+/**
+ * @file libgrid/gridQuantise.c
+ * @ingroup libgridIOQuantise
+ * @brief  Implements the error-bounded quantisation of grid variables.
+ */
+
+
+/*--- Includes ----------------------------------------------------------*/
+#include "gridConfig.h"
+#include "gridQuantise.h"
+#include <assert.h>
+#include <math.h>
+#include <float.h>
+#include "../libdata/dataVarType.h"
+#include "../libutil/xmem.h"
+
+
+/*--- Implemention of main structure ------------------------------------*/
+
+/** @brief  The main structure of a quantiser. */
+struct gridQuantise_struct {
+	/** @brief  The tolerance in units of the standard deviation. */
+	double   tolerance;
+	/** @brief  The number of values seen. */
+	double   num;
+	/** @brief  The mean of the values. */
+	double   mean;
+	/** @brief  The sum of the squared deviations from the mean. */
+	double   m2;
+	/** @brief  The smallest value. */
+	double   min;
+	/** @brief  The largest value. */
+	double   max;
+	/** @brief  The value that is encoded as 0. */
+	double   offset;
+	/** @brief  The difference between consecutive encoded values. */
+	double   step;
+	/** @brief  The size of the encoded integers, 0 if not prepared. */
+	int      numBytes;
+};
+
+
+/*--- Local defines -----------------------------------------------------*/
+
+/**
+ * @brief  The largest code of 4 byte integers.
+ *
+ * Limited to 2^24 so that the codes are exactly representable as floats,
+ * the decoding relies on HDF5 converting them to the type of the variable.
+ */
+#define LOCAL_MAXCODE_4BYTE 16777216.
+
+
+/*--- Prototypes of local functions -------------------------------------*/
+inline static double
+local_getValue(const void *data, uint64_t i, bool isFloat);
+
+static void
+local_combine(gridQuantise_t quantise, double num, double mean, double m2);
+
+
+/*--- Implementations of exported functions -----------------------------*/
+extern gridQuantise_t
+gridQuantise_new(double tolerance)
+{
+	gridQuantise_t quantise;
+
+	assert(tolerance > 0.0);
+
+	quantise            = xmalloc(sizeof(struct gridQuantise_struct));
+	quantise->tolerance = tolerance;
+	quantise->num       = 0.0;
+	quantise->mean      = 0.0;
+	quantise->m2        = 0.0;
+	quantise->min       = DBL_MAX;
+	quantise->max       = -DBL_MAX;
+	quantise->offset    = 0.0;
+	quantise->step      = 1.0;
+	quantise->numBytes  = 0;
+
+	return quantise;
+}
+
+extern void
+gridQuantise_del(gridQuantise_t *quantise)
+{
+	assert(quantise != NULL && *quantise != NULL);
+
+	xfree(*quantise);
+
+	*quantise = NULL;
+}
+
+extern bool
+gridQuantise_isSupported(const dataVar_t var)
+{
+	assert(var != NULL);
+
+	return dataVarType_isFloating(dataVar_getType(var))
+	       && (dataVar_getNumComponents(var) == 1)
+	       && !dataVar_isFFTWPadded(var);
+}
+
+extern void
+gridQuantise_addData(gridQuantise_t  quantise,
+                     const dataVar_t var,
+                     const void      *data,
+                     uint64_t        numValues)
+{
+	bool   isFloat;
+	double sum = 0.0, mean, sumDev = 0.0, sumDevSqr = 0.0;
+
+	assert(quantise != NULL);
+	assert(gridQuantise_isSupported(var));
+	assert(data != NULL || numValues == 0);
+
+	quantise->numBytes = 0;
+	if (numValues == 0)
+		return;
+
+	isFloat = dataVarType_isNativeFloat(dataVar_getType(var));
+
+	for (uint64_t i = 0; i < numValues; i++) {
+		double v = local_getValue(data, i, isFloat);
+
+		sum          += v;
+		quantise->min = (v < quantise->min) ? v : quantise->min;
+		quantise->max = (v > quantise->max) ? v : quantise->max;
+	}
+	mean = sum / (double)numValues;
+
+	// The deviations are summed about the mean of this chunk, a large
+	// offset of the field does not cancel the spread.  The sum of the
+	// deviations corrects for the rounding of the mean.
+	for (uint64_t i = 0; i < numValues; i++) {
+		double dev = local_getValue(data, i, isFloat) - mean;
+
+		sumDev    += dev;
+		sumDevSqr += dev * dev;
+	}
+
+	local_combine(quantise, (double)numValues,
+	              mean + sumDev / (double)numValues,
+	              sumDevSqr - sumDev * sumDev / (double)numValues);
+}
+
+#ifdef WITH_MPI
+extern void
+gridQuantise_reduce(gridQuantise_t quantise, MPI_Comm comm)
+{
+	double minMax[2], tmp[3], *all;
+	int    size;
+
+	assert(quantise != NULL);
+
+	MPI_Comm_size(comm, &size);
+	all = xmalloc(sizeof(double) * 3 * size);
+
+	tmp[0] = quantise->num;
+	tmp[1] = quantise->mean;
+	tmp[2] = quantise->m2;
+	MPI_Allgather(tmp, 3, MPI_DOUBLE, all, 3, MPI_DOUBLE, comm);
+
+	// The minimum is reduced as the negated maximum.
+	tmp[0] = -quantise->min;
+	tmp[1] = quantise->max;
+	MPI_Allreduce(tmp, minMax, 2, MPI_DOUBLE, MPI_MAX, comm);
+
+	// Combining in the order of the ranks gives the same result everywhere.
+	quantise->num  = 0.0;
+	quantise->mean = 0.0;
+	quantise->m2   = 0.0;
+	for (int i = 0; i < size; i++)
+		local_combine(quantise, all[3 * i], all[3 * i + 1], all[3 * i + 2]);
+	xfree(all);
+
+	quantise->min      = -minMax[0];
+	quantise->max      = minMax[1];
+	quantise->numBytes = 0;
+}
+
+#endif
+
+extern bool
+gridQuantise_prepare(gridQuantise_t quantise)
+{
+	double mean, maxCode;
+
+	assert(quantise != NULL);
+
+	quantise->numBytes = 0;
+	// NaNs and infinities do not show in min and max, but in the moments.
+	if ((quantise->num < 1.0) || !isfinite(quantise->mean)
+	    || !isfinite(quantise->m2))
+		return false;
+
+	mean             = quantise->mean;
+	quantise->offset = mean;
+	if (quantise->max == quantise->min) {
+		// A constant field, every value is encoded as 0.
+		quantise->step = 1.0;
+	} else {
+		quantise->step = 2. * quantise->tolerance
+		                 * sqrt(fmax(quantise->m2, 0.0) / quantise->num);
+		// The spread is too small to be resolved.
+		if (!(quantise->step > 0.0))
+			return false;
+	}
+
+	maxCode = fmax(quantise->max - mean, mean - quantise->min)
+	          / quantise->step + 0.5;
+	if (maxCode <= 127.)
+		quantise->numBytes = 1;
+	else if (maxCode <= 32767.)
+		quantise->numBytes = 2;
+	else if (maxCode <= LOCAL_MAXCODE_4BYTE)
+		quantise->numBytes = 4;
+
+	return quantise->numBytes != 0 ? true : false;
+}
+
+extern double
+gridQuantise_getOffset(const gridQuantise_t quantise)
+{
+	assert(quantise != NULL);
+	assert(quantise->numBytes != 0);
+
+	return quantise->offset;
+}
+
+extern double
+gridQuantise_getStep(const gridQuantise_t quantise)
+{
+	assert(quantise != NULL);
+	assert(quantise->numBytes != 0);
+
+	return quantise->step;
+}
+
+extern int
+gridQuantise_getNumBytes(const gridQuantise_t quantise)
+{
+	assert(quantise != NULL);
+	assert(quantise->numBytes != 0);
+
+	return quantise->numBytes;
+}
+
+extern void *
+gridQuantise_encode(const gridQuantise_t quantise,
+                    const dataVar_t      var,
+                    const void           *data,
+                    uint64_t             numValues)
+{
+	void   *codes;
+	bool   isFloat;
+	double maxCode;
+
+	assert(quantise != NULL);
+	assert(quantise->numBytes != 0);
+	assert(gridQuantise_isSupported(var));
+	assert(data != NULL || numValues == 0);
+
+	isFloat = dataVarType_isNativeFloat(dataVar_getType(var));
+	codes   = xmalloc((size_t)(quantise->numBytes) * (numValues > 0
+	                                                   ? numValues : 1));
+	maxCode = (quantise->numBytes == 1) ? 127.
+	          : ((quantise->numBytes == 2) ? 32767. : LOCAL_MAXCODE_4BYTE);
+
+	for (uint64_t i = 0; i < numValues; i++) {
+		double code = round((local_getValue(data, i, isFloat)
+		                     - quantise->offset) / quantise->step);
+
+		// Guards against rounding at the edges of the range.
+		code = fmin(fmax(code, -maxCode), maxCode);
+		switch (quantise->numBytes) {
+		case 1:
+			((int8_t *)codes)[i] = (int8_t)code;
+			break;
+		case 2:
+			((int16_t *)codes)[i] = (int16_t)code;
+			break;
+		default:
+			((int32_t *)codes)[i] = (int32_t)code;
+			break;
+		}
+	}
+
+	return codes;
+}
+
+extern void
+gridQuantise_decode(const dataVar_t var,
+                    void            *data,
+                    uint64_t        numValues,
+                    double          offset,
+                    double          step)
+{
+	assert(gridQuantise_isSupported(var));
+	assert(data != NULL || numValues == 0);
+
+	if (dataVarType_isNativeFloat(dataVar_getType(var))) {
+		float *values = data;
+		for (uint64_t i = 0; i < numValues; i++)
+			values[i] = (float)(offset + step * (double)(values[i]));
+	} else {
+		double *values = data;
+		for (uint64_t i = 0; i < numValues; i++)
+			values[i] = offset + step * values[i];
+	}
+}
+
+/*--- Implementations of local functions --------------------------------*/
+inline static double
+local_getValue(const void *data, uint64_t i, bool isFloat)
+{
+	return isFloat ? (double)(((const float *)data)[i])
+	       : ((const double *)data)[i];
+}
+
+static void
+local_combine(gridQuantise_t quantise, double num, double mean, double m2)
+{
+	double numTotal, delta;
+
+	if (num <= 0.0)
+		return;
+
+	// The pairwise update of Chan, Golub & LeVeque (1979).
+	numTotal        = quantise->num + num;
+	delta           = mean - quantise->mean;
+	quantise->mean += delta * num / numTotal;
+	quantise->m2   += m2 + delta * delta * quantise->num * num / numTotal;
+	quantise->num   = numTotal;
+}
@@ -0,0 +1,264 @@
+// Copyright (C) 2013, Steffen Knollmann
+// Released under the terms of the GNU General Public License version 3.
+// This file is part of `ginnungagap'.
+
+#ifndef GRIDQUANTISE_H
+#define GRIDQUANTISE_H
+
+
+/*--- Doxygen file description ------------------------------------------*/
+
+/**
+ * @file libgrid/gridQuantise.h
+ * @ingroup libgridIOQuantise
+ * @brief  Provides the error-bounded quantisation of grid variables.
+ */
+
+
+/*--- Includes ----------------------------------------------------------*/
+#include "gridConfig.h"
+#include <stdint.h>
+#include <stdbool.h>
+#ifdef WITH_MPI
+#  include <mpi.h>
+#endif
+#include "../libdata/dataVar.h"
+
+
+/*--- ADT handle --------------------------------------------------------*/
+
+/** @brief  Provides a handle for a quantiser. */
+typedef struct gridQuantise_struct *gridQuantise_t;
+
+
+/*--- Prototypes of exported functions ----------------------------------*/
+
+/**
+ * @name  Creating and Deleting
+ *
+ * @{
+ */
+
+/**
+ * @brief  Creates a new quantiser.
+ *
+ * @param[in]  tolerance
+ *                The largest allowed error in units of the standard
+ *                deviation of the data, must be positive.
+ *
+ * @return  Returns a new quantiser that has not seen any data.
+ */
+extern gridQuantise_t
+gridQuantise_new(double tolerance);
+
+
+/**
+ * @brief  Deletes a quantiser and frees the associated memory.
+ *
+ * @param[in,out]  *quantise
+ *                    The quantiser to delete, will be set to @c NULL.
+ *
+ * @return  Returns nothing.
+ */
+extern void
+gridQuantise_del(gridQuantise_t *quantise);
+
+
+/** @} */
+
+/**
+ * @name  Encoding
+ *
+ * @{
+ */
+
+/**
+ * @brief  Checks whether a variable can be quantised.
+ *
+ * Only scalar floating point variables without FFTW padding are
+ * supported.
+ *
+ * @param[in]  var
+ *                The variable to check.
+ *
+ * @return  Returns @c true if the variable can be quantised.
+ */
+extern bool
+gridQuantise_isSupported(const dataVar_t var);
+
+
+/**
+ * @brief  Adds data to the statistics from which the quantisation is
+ *         derived.
+ *
+ * @param[in,out]  quantise
+ *                    The quantiser to work with.
+ * @param[in]      var
+ *                    The variable describing the data, must be supported.
+ * @param[in]      *data
+ *                    The data.
+ * @param[in]      numValues
+ *                    The number of values in @c data.
+ *
+ * @return  Returns nothing.
+ */
+extern void
+gridQuantise_addData(gridQuantise_t  quantise,
+                     const dataVar_t var,
+                     const void      *data,
+                     uint64_t        numValues);
+
+
+#ifdef WITH_MPI
+
+/**
+ * @brief  Combines the statistics of all processes.
+ *
+ * This is a collective operation, it must be called before
+ * gridQuantise_prepare() if the data is distributed.
+ *
+ * @param[in,out]  quantise
+ *                    The quantiser to work with.
+ * @param[in]      comm
+ *                    The communicator of the processes holding the data.
+ *
+ * @return  Returns nothing.
+ */
+extern void
+gridQuantise_reduce(gridQuantise_t quantise, MPI_Comm comm);
+
+#endif
+
+
+/**
+ * @brief  Derives offset, step and integer size from the statistics.
+ *
+ * The offset is the mean and the step is twice the tolerance times the
+ * standard deviation, so that rounding to the nearest step keeps the
+ * error within the tolerance.  A constant field is encoded exactly with
+ * a step of 1.  The smallest of 1, 2 or 4 byte integers holding the range
+ * of the data is used.
+ *
+ * @param[in,out]  quantise
+ *                    The quantiser to work with.
+ *
+ * @return  Returns @c true if the data can be quantised and @c false if
+ *          there was no data, the data is not finite, the spread is too
+ *          small to give a step, or the range does not fit into 4 byte
+ *          integers.
+ */
+extern bool
+gridQuantise_prepare(gridQuantise_t quantise);
+
+
+/**
+ * @brief  Retrieves the offset of the quantisation.
+ *
+ * @param[in]  quantise
+ *                The quantiser to query, must have been prepared.
+ *
+ * @return  Returns the value that is encoded as 0.
+ */
+extern double
+gridQuantise_getOffset(const gridQuantise_t quantise);
+
+
+/**
+ * @brief  Retrieves the step of the quantisation.
+ *
+ * @param[in]  quantise
+ *                The quantiser to query, must have been prepared.
+ *
+ * @return  Returns the difference between consecutive encoded values.
+ */
+extern double
+gridQuantise_getStep(const gridQuantise_t quantise);
+
+
+/**
+ * @brief  Retrieves the size of the integers the data is encoded to.
+ *
+ * @param[in]  quantise
+ *                The quantiser to query, must have been prepared.
+ *
+ * @return  Returns 1, 2 or 4.
+ */
+extern int
+gridQuantise_getNumBytes(const gridQuantise_t quantise);
+
+
+/**
+ * @brief  Encodes data.
+ *
+ * @param[in]  quantise
+ *                The quantiser to use, must have been prepared.
+ * @param[in]  var
+ *                The variable describing the data.
+ * @param[in]  *data
+ *                The data to encode.
+ * @param[in]  numValues
+ *                The number of values in @c data.
+ *
+ * @return  Returns a new array of @c numValues signed integers of
+ *          gridQuantise_getNumBytes() bytes each.  The caller must free
+ *          it with xfree().
+ */
+extern void *
+gridQuantise_encode(const gridQuantise_t quantise,
+                    const dataVar_t      var,
+                    const void           *data,
+                    uint64_t             numValues);
+
+
+/** @} */
+
+/**
+ * @name  Decoding
+ *
+ * @{
+ */
+
+/**
+ * @brief  Decodes data in place.
+ *
+ * @param[in]      var
+ *                    The variable describing the data, must be supported.
+ * @param[in,out]  *data
+ *                    The encoded integers, already converted to the type of
+ *                    @c var.  Receives the decoded values.
+ * @param[in]      numValues
+ *                    The number of values in @c data.
+ * @param[in]      offset
+ *                    The offset of the quantisation.
+ * @param[in]      step
+ *                    The step of the quantisation.
+ *
+ * @return  Returns nothing.
+ */
+extern void
+gridQuantise_decode(const dataVar_t var,
+                    void            *data,
+                    uint64_t        numValues,
+                    double          offset,
+                    double          step);
+
+
+/** @} */
+
+
+/*--- Doxygen group definitions -----------------------------------------*/
+
+/**
+ * @defgroup libgridIOQuantise Quantisation
+ * @ingroup libgridIO
+ * @brief  Provides lossy, error-bounded storage of grid variables.
+ *
+ * Velocities and displacements are Gaussian random fields which hardly
+ * compress without losses.  Storing them as small integers with a step
+ * that is a fixed fraction of their standard deviation halves or quarters
+ * the size of the files, while every value stays within a known
+ * tolerance of the original.
+ */
+
+
+#endif
@@ -0,0 +1,318 @@
+// Copyright (C) 2013, Steffen Knollmann
+// Released under the terms of the GNU General Public License version 3.
+// This file is part of `ginnungagap'.
+
+
+/*--- Doxygen file description ------------------------------------------*/
+
+/**
+ * @file libgrid/gridQuantise_tests.c
+ * @ingroup libgridIOQuantise
+ * @brief  This file implements the test functions for the quantisation.
+ */
+
+
+/*--- Includes ----------------------------------------------------------*/
+#include "gridConfig.h"
+#include "gridQuantise_tests.h"
+#include "gridQuantise.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <math.h>
+#ifdef WITH_MPI
+#  include <mpi.h>
+#endif
+#include "../libdata/dataVar.h"
+#include "../libutil/xmem.h"
+
+
+/*--- Local defines -----------------------------------------------------*/
+#define LOCAL_NUMVALUES 1000
+
+
+/*--- Prototypes of local functions -------------------------------------*/
+static void
+local_fillWithFakeData(float *data, uint64_t numValues);
+
+
+/*--- Implementations of exported functios ------------------------------*/
+extern bool
+gridQuantise_new_test(void)
+{
+	bool           hasPassed = true;
+	int            rank      = 0;
+	gridQuantise_t quantise;
+	dataVar_t      var;
+#ifdef XMEM_TRACK_MEM
+	size_t         allocatedBytes = global_allocated_bytes;
+#endif
+#ifdef WITH_MPI
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+#endif
+
+	if (rank == 0)
+		printf("Testing %s... ", __func__);
+
+	quantise = gridQuantise_new(0.1);
+	// Nothing has been seen yet.
+	if (gridQuantise_prepare(quantise))
+		hasPassed = false;
+	gridQuantise_del(&quantise);
+
+	var = dataVar_new("test", DATAVARTYPE_FLOAT, 1);
+	if (!gridQuantise_isSupported(var))
+		hasPassed = false;
+	dataVar_del(&var);
+	var = dataVar_new("test", DATAVARTYPE_DOUBLE, NDIM);
+	if (gridQuantise_isSupported(var))
+		hasPassed = false;
+	dataVar_del(&var);
+	var = dataVar_new("test", DATAVARTYPE_INT, 1);
+	if (gridQuantise_isSupported(var))
+		hasPassed = false;
+	dataVar_del(&var);
+#ifdef XMEM_TRACK_MEM
+	if (allocatedBytes != global_allocated_bytes)
+		hasPassed = false;
+#endif
+
+	return hasPassed ? true : false;
+}
+
+extern bool
+gridQuantise_del_test(void)
+{
+	bool           hasPassed = true;
+	int            rank      = 0;
+	gridQuantise_t quantise;
+#ifdef XMEM_TRACK_MEM
+	size_t         allocatedBytes = global_allocated_bytes;
+#endif
+#ifdef WITH_MPI
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+#endif
+
+	if (rank == 0)
+		printf("Testing %s... ", __func__);
+
+	quantise = gridQuantise_new(0.1);
+	gridQuantise_del(&quantise);
+	if (quantise != NULL)
+		hasPassed = false;
+#ifdef XMEM_TRACK_MEM
+	if (allocatedBytes != global_allocated_bytes)
+		hasPassed = false;
+#endif
+
+	return hasPassed ? true : false;
+}
+
+extern bool
+gridQuantise_addData_test(void)
+{
+	bool           hasPassed = true;
+	int            rank      = 0;
+	gridQuantise_t quantise;
+	dataVar_t      var;
+	double         data[LOCAL_NUMVALUES], decoded[LOCAL_NUMVALUES];
+	double         rms = 0.0, step;
+	int8_t         *codes;
+#ifdef XMEM_TRACK_MEM
+	size_t         allocatedBytes = global_allocated_bytes;
+#endif
+#ifdef WITH_MPI
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+#endif
+
+	if (rank == 0)
+		printf("Testing %s... ", __func__);
+
+	var = dataVar_new("test", DATAVARTYPE_DOUBLE, 1);
+
+	// A large offset with a small spread, the variance from the sum of
+	// the squares cancels completely for this.
+	for (int i = 0; i < LOCAL_NUMVALUES; i++) {
+		data[i] = 1e-3 * sin(0.1 * i);
+		rms    += data[i] * data[i];
+		data[i] += 1e8;
+	}
+	rms = sqrt(rms / LOCAL_NUMVALUES);
+
+	// Added in two unequal parts to also combine the statistics.
+	quantise = gridQuantise_new(0.1);
+	gridQuantise_addData(quantise, var, data, 300);
+	gridQuantise_addData(quantise, var, data + 300, LOCAL_NUMVALUES - 300);
+	if (!gridQuantise_prepare(quantise)
+	    || (gridQuantise_getNumBytes(quantise) != 1)) {
+		hasPassed = false;
+	} else {
+		step = gridQuantise_getStep(quantise);
+		if (fabs(step - 0.2 * rms) > 1e-3 * step)
+			hasPassed = false;
+		codes = gridQuantise_encode(quantise, var, data, LOCAL_NUMVALUES);
+		for (int i = 0; i < LOCAL_NUMVALUES; i++)
+			decoded[i] = (double)(codes[i]);
+		gridQuantise_decode(var, decoded, LOCAL_NUMVALUES,
+		                    gridQuantise_getOffset(quantise), step);
+		for (int i = 0; i < LOCAL_NUMVALUES; i++) {
+			if (fabs(decoded[i] - data[i]) > 0.1 * rms * (1. + 1e-3))
+				hasPassed = false;
+		}
+		xfree(codes);
+	}
+	gridQuantise_del(&quantise);
+
+	// Only a truly constant field falls back to encoding the mean.
+	for (int i = 0; i < LOCAL_NUMVALUES; i++)
+		data[i] = 1e8;
+	quantise = gridQuantise_new(0.1);
+	gridQuantise_addData(quantise, var, data, LOCAL_NUMVALUES);
+	if (!gridQuantise_prepare(quantise)
+	    || islessgreater(gridQuantise_getOffset(quantise), 1e8)
+	    || islessgreater(gridQuantise_getStep(quantise), 1.0))
+		hasPassed = false;
+	gridQuantise_del(&quantise);
+
+	dataVar_del(&var);
+#ifdef XMEM_TRACK_MEM
+	if (allocatedBytes != global_allocated_bytes)
+		hasPassed = false;
+#endif
+
+	return hasPassed ? true : false;
+} /* gridQuantise_addData_test */
+
+extern bool
+gridQuantise_prepare_test(void)
+{
+	bool           hasPassed = true;
+	int            rank      = 0;
+	gridQuantise_t quantise;
+	dataVar_t      var;
+	double         data[4] = { -1., 1., -1., 1. };
+#ifdef XMEM_TRACK_MEM
+	size_t         allocatedBytes = global_allocated_bytes;
+#endif
+#ifdef WITH_MPI
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+#endif
+
+	if (rank == 0)
+		printf("Testing %s... ", __func__);
+
+	var = dataVar_new("test", DATAVARTYPE_DOUBLE, 1);
+
+	// Mean 0 and standard deviation 1, the range is +-1/(2 tolerance).
+	quantise = gridQuantise_new(0.1);
+	gridQuantise_addData(quantise, var, data, 4);
+	if (!gridQuantise_prepare(quantise))
+		hasPassed = false;
+	if (islessgreater(gridQuantise_getOffset(quantise), 0.0))
+		hasPassed = false;
+	if (fabs(gridQuantise_getStep(quantise) - 0.2) > 1e-12)
+		hasPassed = false;
+	if (gridQuantise_getNumBytes(quantise) != 1)
+		hasPassed = false;
+	gridQuantise_del(&quantise);
+
+	quantise = gridQuantise_new(1e-3);
+	gridQuantise_addData(quantise, var, data, 4);
+	if (!gridQuantise_prepare(quantise)
+	    || (gridQuantise_getNumBytes(quantise) != 2))
+		hasPassed = false;
+	gridQuantise_del(&quantise);
+
+	quantise = gridQuantise_new(1e-5);
+	gridQuantise_addData(quantise, var, data, 4);
+	if (!gridQuantise_prepare(quantise)
+	    || (gridQuantise_getNumBytes(quantise) != 4))
+		hasPassed = false;
+	gridQuantise_del(&quantise);
+
+	quantise = gridQuantise_new(1e-9);
+	gridQuantise_addData(quantise, var, data, 4);
+	if (gridQuantise_prepare(quantise))
+		hasPassed = false;
+	gridQuantise_del(&quantise);
+
+	data[2]  = NAN;
+	quantise = gridQuantise_new(0.1);
+	gridQuantise_addData(quantise, var, data, 4);
+	if (gridQuantise_prepare(quantise))
+		hasPassed = false;
+	gridQuantise_del(&quantise);
+
+	dataVar_del(&var);
+#ifdef XMEM_TRACK_MEM
+	if (allocatedBytes != global_allocated_bytes)
+		hasPassed = false;
+#endif
+
+	return hasPassed ? true : false;
+} /* gridQuantise_prepare_test */
+
+extern bool
+gridQuantise_encode_test(void)
+{
+	bool           hasPassed = true;
+	int            rank      = 0;
+	gridQuantise_t quantise;
+	dataVar_t      var;
+	float          *data, *decoded;
+	int8_t         *codes;
+	double         step;
+#ifdef XMEM_TRACK_MEM
+	size_t         allocatedBytes = global_allocated_bytes;
+#endif
+#ifdef WITH_MPI
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+#endif
+
+	if (rank == 0)
+		printf("Testing %s... ", __func__);
+
+	var     = dataVar_new("test", DATAVARTYPE_FLOAT, 1);
+	data    = xmalloc(sizeof(float) * LOCAL_NUMVALUES);
+	decoded = xmalloc(sizeof(float) * LOCAL_NUMVALUES);
+	local_fillWithFakeData(data, LOCAL_NUMVALUES);
+
+	quantise = gridQuantise_new(0.05);
+	gridQuantise_addData(quantise, var, data, LOCAL_NUMVALUES);
+	if (!gridQuantise_prepare(quantise)
+	    || (gridQuantise_getNumBytes(quantise) != 1)) {
+		hasPassed = false;
+	} else {
+		step  = gridQuantise_getStep(quantise);
+		codes = gridQuantise_encode(quantise, var, data, LOCAL_NUMVALUES);
+		// This is the conversion done by HDF5 when reading.
+		for (int i = 0; i < LOCAL_NUMVALUES; i++)
+			decoded[i] = (float)(codes[i]);
+		gridQuantise_decode(var, decoded, LOCAL_NUMVALUES,
+		                    gridQuantise_getOffset(quantise), step);
+		for (int i = 0; i < LOCAL_NUMVALUES; i++) {
+			if (fabs(decoded[i] - data[i]) > 0.5 * step * (1. + 1e-5))
+				hasPassed = false;
+		}
+		xfree(codes);
+	}
+	gridQuantise_del(&quantise);
+
+	xfree(decoded);
+	xfree(data);
+	dataVar_del(&var);
+#ifdef XMEM_TRACK_MEM
+	if (allocatedBytes != global_allocated_bytes)
+		hasPassed = false;
+#endif
+
+	return hasPassed ? true : false;
+} /* gridQuantise_encode_test */
+
+/*--- Implementations of local functions --------------------------------*/
+static void
+local_fillWithFakeData(float *data, uint64_t numValues)
+{
+	// A smooth, zero-mean field with an amplitude of a few units.
+	for (uint64_t i = 0; i < numValues; i++)
+		data[i] = (float)(3.0 * sin(0.1 * i) + 0.5 * cos(0.37 * i) + 0.25);
+}
@@ -0,0 +1,40 @@
+// Copyright (C) 2013, Steffen Knollmann
+// Released under the terms of the GNU General Public License version 3.
+// This file is part of `ginnungagap'.
+
+#ifndef GRIDQUANTISE_TESTS_H
+#define GRIDQUANTISE_TESTS_H
+
+
+/*--- Doxygen file description ------------------------------------------*/
+
+/**
+ * @file libgrid/gridQuantise_tests.h
+ * @ingroup libgridIOQuantise
+ * @brief  This file provides the test functions for the quantisation.
+ */
+
+
+/*--- Includes ----------------------------------------------------------*/
+#include "gridConfig.h"
+#include <stdbool.h>
+
+
+/*--- Prototypes of exported functions ----------------------------------*/
+extern bool
+gridQuantise_new_test(void);
+
+extern bool
+gridQuantise_del_test(void);
+
+extern bool
+gridQuantise_addData_test(void);
+
+extern bool
+gridQuantise_prepare_test(void);
+
+extern bool
+gridQuantise_encode_test(void);
+
+
+#endif
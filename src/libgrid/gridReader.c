@@ -20,6 +20,7 @@
 #include "gridPatch.h"
 #include "../libutil/xmem.h"
 #include "../libutil/filename.h"
+#include "../libutil/prof.h"
 
 
 /*--- Implemention of main structure ------------------------------------*/
@@ -49,7 +50,9 @@ gridReader_readIntoPatch(gridReader_t reader, gridPatch_t patch)
 	assert(patch != NULL);
 	assert(reader->func->readIntoPatch != NULL);
 
+	prof_start("read");
 	reader->func->readIntoPatch(reader, patch);
+	prof_stop("read");
 }
 
 extern void
@@ -61,7 +64,9 @@ gridReader_readIntoPatchForVar(gridReader_t reader,
 	assert(patch != NULL);
 	assert(idxOfVar >= 0 && idxOfVar < gridPatch_getNumVars(patch));
 
+	prof_start("read");
 	reader->func->readIntoPatchForVar(reader, patch, idxOfVar);
+	prof_stop("read");
 }
 
 /*--- Implementations of final functions --------------------------------*/
@@ -144,6 +149,7 @@ gridReader_init(gridReader_t                          reader,
 	reader->func                 = func;
 	reader->handleFilenameChange = handleFilenameChange;
 	reader->fileName             = NULL;
+	reader->doPatch              = false;
 }
 
 extern void
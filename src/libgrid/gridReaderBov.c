@@ -206,12 +206,10 @@ local_translateBovTypeToGridType(bovFormat_t typeInBov)
 	} else if (typeInBov == BOV_FORMAT_BYTE) {
 		type = DATAVARTYPE_INT8;
 	} else if (typeInBov == BOV_FORMAT_FLOAT) {
-		if (dataVarType_isNativeFloat(DATAVARTYPE_FPV)) {
+		if (dataVarType_isNativeFloat(DATAVARTYPE_FPV))
 			type = DATAVARTYPE_FPV;
-		} else {
-			fprintf(stderr, "There is no float capacity in the grid :(");
-			diediedie(EXIT_FAILURE);
-		}
+		else
+			type = DATAVARTYPE_FLOAT;
 	} else if (typeInBov == BOV_FORMAT_DOUBLE) {
 		type = DATAVARTYPE_DOUBLE;
 	} else {
@@ -233,6 +231,8 @@ local_translateGridTypeToBovType(dataVarType_t type)
 		typeAsBovType = BOV_FORMAT_BYTE;
 	} else if (type == DATAVARTYPE_DOUBLE) {
 		typeAsBovType = BOV_FORMAT_DOUBLE;
+	} else if (type == DATAVARTYPE_FLOAT) {
+		typeAsBovType = BOV_FORMAT_FLOAT;
 	} else if (type == DATAVARTYPE_FPV) {
 		if (dataVarType_isNativeFloat(type))
 			typeAsBovType = BOV_FORMAT_FLOAT;
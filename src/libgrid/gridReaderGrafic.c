@@ -201,6 +201,8 @@ local_translateGridTypeToGraficType(dataVarType_t type)
 
 	if (type == DATAVARTYPE_DOUBLE) {
 		typeAsGraficType = GRAFIC_FORMAT_DOUBLE;
+	} else if (type == DATAVARTYPE_FLOAT) {
+		typeAsGraficType = GRAFIC_FORMAT_FLOAT;
 	} else if (type == DATAVARTYPE_FPV) {
 		if (dataVarType_isNativeFloat(type))
 			typeAsGraficType = GRAFIC_FORMAT_FLOAT;
@@ -16,6 +16,7 @@
 #include "gridConfig.h"
 #include "gridReaderHDF5.h"
 #include <assert.h>
+#include "gridQuantise.h"
 #include "gridUtilHDF5.h"
 #include "../libutil/xmem.h"
 #include "../libutil/xstring.h"
@@ -48,6 +49,15 @@ static void
 local_readIntoPatchForVar_doPatch(gridReader_t reader,
                                    gridPatch_t  patch,
                                    int          idxOfVar);
+static void
+local_readDataSet(hid_t     dataSet,
+                  hid_t     dataTypeFile,
+                  hid_t     dataTypePatch,
+                  hid_t     dataSpacePatch,
+                  hid_t     dataSpaceFile,
+                  dataVar_t var,
+                  void      *data,
+                  uint64_t  numValues);
 
 /*--- Implementations of exported functions -----------------------------*/
 extern void
@@ -247,13 +257,9 @@ local_readIntoPatchForVar_old(gridReader_t reader,
 	
 	//local_memUsage();
 	
-	if (H5Tequal(dataTypeFile, dataTypePatch)) {
-		H5Dread(dataSet, dataTypeFile, dataSpacePatch,
-		        dataSpaceFile, H5P_DEFAULT, data);
-	} else {
-		fprintf(stderr, "ERROR: Datatype in memory differs from file.\n");
-		diediedie(EXIT_FAILURE);
-	}
+	local_readDataSet(dataSet, dataTypeFile, dataTypePatch, dataSpacePatch,
+	                  dataSpaceFile, var, data,
+	                  (uint64_t)dimsPatch[0] * dimsPatch[1] * dimsPatch[2]);
 //	local_memUsage();
 
 	H5Sclose(dataSpacePatch);
@@ -297,13 +303,9 @@ local_readIntoPatchForVar_old(gridReader_t reader,
 		dataTypePatch  = dataVar_getHDF5Datatype(var); \
 		dataSpacePatch = gridUtilHDF5_getDataSpaceFromDims(dimsRead); \
 		gridUtilHDF5_selectHyperslab(dataSpaceFile, idxLoReadRtw, dimsRead); \
-		if (H5Tequal(dataTypeFile, dataTypePatch)) { \
-			H5Dread(dataSet, dataTypeFile, dataSpacePatch, \
-					dataSpaceFile, H5P_DEFAULT, data); \
-		} else { \
-			fprintf(stderr, "ERROR: Datatype in memory differs from file.\n"); \
-			diediedie(EXIT_FAILURE); \
-		} \
+		local_readDataSet(dataSet, dataTypeFile, dataTypePatch, \
+		                  dataSpacePatch, dataSpaceFile, var, data, \
+		                  (uint64_t)dimsRead[0] * dimsRead[1] * dimsRead[2]); \
 		H5Sclose(dataSpacePatch); \
 		H5Tclose(dataTypePatch); \
 		H5Sclose(dataSpaceFile); \
@@ -429,3 +431,36 @@ local_readIntoPatchForVar_doPatch(gridReader_t reader,
 } 
 
 #undef read
+
+static void
+local_readDataSet(hid_t     dataSet,
+                  hid_t     dataTypeFile,
+                  hid_t     dataTypePatch,
+                  hid_t     dataSpacePatch,
+                  hid_t     dataSpaceFile,
+                  dataVar_t var,
+                  void      *data,
+                  uint64_t  numValues)
+{
+	double offset, step;
+
+	if (H5Tequal(dataTypeFile, dataTypePatch)) {
+		H5Dread(dataSet, dataTypeFile, dataSpacePatch,
+		        dataSpaceFile, H5P_DEFAULT, data);
+	} else if (gridQuantise_isSupported(var)
+	           && (H5Tget_class(dataTypeFile) == H5T_INTEGER)
+	           && gridUtilHDF5_readAttributeDouble(dataSet,
+	                                               GRIDUTILHDF5_QUANTISE_OFFSET,
+	                                               &offset)
+	           && gridUtilHDF5_readAttributeDouble(dataSet,
+	                                               GRIDUTILHDF5_QUANTISE_STEP,
+	                                               &step)) {
+		// HDF5 converts the integers to the type in memory.
+		H5Dread(dataSet, dataTypePatch, dataSpacePatch,
+		        dataSpaceFile, H5P_DEFAULT, data);
+		gridQuantise_decode(var, data, numValues, offset, step);
+	} else {
+		fprintf(stderr, "ERROR: Datatype in memory differs from file.\n");
+		diediedie(EXIT_FAILURE);
+	}
+}
@@ -7,14 +7,18 @@
 #include "gridConfig.h"
 #include "gridRegularDistrib.h"
 #include <assert.h>
+#include <stdbool.h>
+#include <string.h>
 #ifdef WITH_MPI
 #  include "gridUtil.h"
 #  include "../libutil/varArr.h"
 #  include "../libutil/commScheme.h"
 #  include "../libutil/commSchemeBuffer.h"
 #  include <mpi.h>
+#  include <stdlib.h>
 #endif
 #include "../libutil/xmem.h"
+#include "../libutil/prof.h"
 #ifdef WITH_MPITRACE
 #  include <mpitrace_user_events.h>
 #endif
@@ -25,6 +29,12 @@
 
 
 /*--- Local defines -----------------------------------------------------*/
+#ifdef WITH_MPI
+/** @brief  The tag used for the messages of overlapped transpositions. */
+#  define LOCAL_OVERLAP_TAG 4224
+/** @brief  The tag used for the messages of persistent schedules. */
+#  define LOCAL_SCHEDULE_TAG 4225
+#endif
 #ifdef WITH_MPITRACE
 #  define LOCAL_MPITRACE_EVENT 460000000
 #endif
@@ -40,6 +50,60 @@ struct local_transposeLayout_struct {
 	gridPointInt_t     processCoord;
 	commSchemeBuffer_t buffer;
 };
+
+typedef struct local_transposeChunk_struct local_transposeChunk_t;
+
+struct local_transposeChunk_struct {
+	gridPointUint32_t idxLo;
+	gridPointUint32_t idxHi;
+	int               rank;
+	int               round;
+	uint64_t          step;
+	uint64_t          offset;
+	uint64_t          numCells;
+};
+
+typedef struct local_transposeStream_struct *local_transposeStream_t;
+
+struct local_transposeStream_struct {
+	MPI_Comm               comm;
+	int                    dimA;
+	int                    dimB;
+	gridPointInt_t         nProcs;
+	int                    numRounds;
+	int                    numSend;
+	local_transposeChunk_t *send;
+	uint64_t               *sendEnd;
+	int                    numRecv;
+	local_transposeChunk_t *recv;
+	uint64_t               *recvEnd;
+};
+
+typedef struct local_transposeSchedule_struct *local_transposeSchedule_t;
+
+struct local_transposeSchedule_struct {
+	int               dimA;
+	int               dimB;
+	gridPointUint32_t dims;
+	gridPointUint32_t idxLo;
+	gridPointUint32_t patchDims;
+	MPI_Datatype      type;
+	int               size;
+	int               numVars;
+	varArr_t          sendLayout;
+	varArr_t          recvLayout;
+	commScheme_t      scheme;
+};
+
+typedef struct local_overlapChunk_struct local_overlapChunk_t;
+
+struct local_overlapChunk_struct {
+	uint32_t     idxLo;
+	uint32_t     idxHi;
+	commScheme_t scheme;
+	void         **bufSend;
+	void         **bufRecv;
+};
 #endif
 
 /*--- Prototypes of local functions -------------------------------------*/
@@ -48,6 +112,12 @@ local_calcProcCoords(gridRegularDistrib_t distrib,
                      int                  rank,
                      gridPointInt_t       procCoords);
 
+static void
+local_applyChunkFunc(gridRegularDistrib_t           distrib,
+                     gridRegularDistrib_chunkFunc_t func,
+                     void                           *arg,
+                     int                            dimChunk);
+
 
 #ifdef WITH_MPI
 static void
@@ -67,6 +137,11 @@ local_transposeMPIInit(gridRegularDistrib_t distrib,
 static void
 local_transposeMPIClean(varArr_t sendLayout, varArr_t recvLayout);
 
+static void
+local_transposeLayoutMPI(gridRegularDistrib_t distrib,
+                         int                  dimA,
+                         int                  dimB);
+
 static gridPatch_t
 local_transposeGetPatchT(gridPointUint32_t dimsT,
                          gridPointInt_t    nProcs,
@@ -99,19 +174,25 @@ local_transposeAllVarsAtPatch(gridPatch_t    patch,
                               gridPatch_t    patchT,
                               MPI_Comm       commCart,
                               const varArr_t sendLayout,
-                              const varArr_t recvLayout);
+                              const varArr_t recvLayout,
+                              bool           batchVars);
+
+static int
+local_transposeGetNumBatchableVars(const gridPatch_t patch, bool batchVars);
 
 static void
 local_transposeGetFullSendBuffers(commScheme_t      scheme,
                                   const varArr_t    layout,
                                   const gridPatch_t patch,
                                   const dataVar_t   var,
+                                  int               numVars,
                                   MPI_Comm          comm);
 
 static void
 local_transposeGetRecvBuffers(commScheme_t    scheme,
                               const varArr_t  layout,
                               const dataVar_t var,
+                              int             numVars,
                               MPI_Comm        comm);
 
 static void
@@ -122,7 +203,194 @@ static void
 local_transposeMoveRecvBuffersToPatch(const varArr_t  layout,
                                       gridPatch_t     patchT,
                                       const int       idxOfVar,
-                                      const dataVar_t var);
+                                      const dataVar_t var,
+                                      int             numVars);
+
+static void
+local_transposeMPIStreamed(gridRegularDistrib_t distrib,
+                           int                  dimA,
+                           int                  dimB);
+
+static void
+local_transposeMPIScheduled(gridRegularDistrib_t distrib,
+                            int                  dimA,
+                            int                  dimB);
+
+static local_transposeSchedule_t
+local_transposeGetSchedule(gridRegularDistrib_t distrib,
+                           int                  dimA,
+                           int                  dimB,
+                           const gridPatch_t    patch,
+                           int                  numVars);
+
+static local_transposeSchedule_t
+local_transposeSchedule_new(gridRegularDistrib_t distrib,
+                            int                  dimA,
+                            int                  dimB,
+                            const gridPatch_t    patch,
+                            int                  numVars);
+
+static void
+local_transposeSchedule_del(local_transposeSchedule_t *schedule);
+
+static bool
+local_transposeScheduleMatches(const local_transposeSchedule_t schedule,
+                               int                             dimA,
+                               int                             dimB,
+                               const gridPointUint32_t         dims,
+                               const gridPatch_t               patch,
+                               int                             numVars);
+
+static void
+local_transposeScheduleAddBuffers(local_transposeSchedule_t schedule,
+                                  const varArr_t            layout,
+                                  char                      *buf,
+                                  dataVar_t                 var,
+                                  int                       type,
+                                  MPI_Comm                  comm);
+
+static uint64_t
+local_transposeScheduleGetNumCells(const varArr_t layout);
+
+static void
+local_transposeSchedulesClear(gridRegularDistrib_t distrib);
+
+static local_transposeStream_t
+local_transposeStream_new(const gridRegularDistrib_t distrib,
+                          int                        dimA,
+                          int                        dimB,
+                          const varArr_t             sendLayout,
+                          const varArr_t             recvLayout);
+
+static void
+local_transposeStream_del(local_transposeStream_t *stream);
+
+static local_transposeChunk_t *
+local_transposeStreamGetChunks(const local_transposeStream_t stream,
+                               const varArr_t                layout,
+                               int                           numSplits,
+                               bool                          isSend,
+                               int                           *numChunks);
+
+static int
+local_transposeStreamGetPartnerIdx(const local_transposeStream_t stream,
+                                   const gridPointInt_t          procCoords);
+
+static int
+local_transposeChunkCompare(const void *a, const void *b);
+
+static uint64_t *
+local_transposeStreamGetRoundEnds(const local_transposeChunk_t *chunks,
+                                  int                          numChunks,
+                                  int                          numRounds);
+
+static void
+local_transposeStreamVar(const local_transposeStream_t stream,
+                         gridPatch_t                   patch,
+                         gridPatch_t                   patchT,
+                         int                           dimA,
+                         int                           dimB);
+
+static void
+local_transposeStreamPack(const local_transposeStream_t stream,
+                          const gridPatch_t             patch,
+                          void                          *data,
+                          size_t                        size);
+
+static void
+local_transposeStreamExchange(const local_transposeStream_t stream,
+                              const dataVar_t               var,
+                              void                          *data);
+
+static commScheme_t
+local_transposeStreamPostRound(const local_transposeStream_t stream,
+                               const dataVar_t               var,
+                               void                          *data,
+                               int                           round,
+                               void                          **stage);
+
+static void
+local_transposeStreamUnpack(const local_transposeStream_t stream,
+                            const gridPatch_t             patchT,
+                            int                           dimA,
+                            int                           dimB,
+                            void                          *data,
+                            size_t                        size);
+
+static uint64_t
+local_transposeChunkToPatchIdx(const local_transposeChunk_t *chunks,
+                               int                          numChunks,
+                               uint64_t                     pos,
+                               const gridPointUint32_t      idxLo,
+                               const gridPointUint32_t      dims,
+                               int                          dimA,
+                               int                          dimB);
+
+static void
+local_transposeMPIOverlapped(gridRegularDistrib_t           distrib,
+                             int                            dimA,
+                             int                            dimB,
+                             int                            dimChunk,
+                             gridRegularDistrib_chunkFunc_t preFunc,
+                             gridRegularDistrib_chunkFunc_t postFunc,
+                             void                           *arg);
+
+static void *
+local_transposeOverlappedVar(const gridRegularDistrib_t     distrib,
+                             gridPatch_t                    patch,
+                             const gridPatch_t              patchT,
+                             int                            idxOfVar,
+                             int                            dimA,
+                             int                            dimB,
+                             int                            dimChunk,
+                             gridRegularDistrib_chunkFunc_t preFunc,
+                             gridRegularDistrib_chunkFunc_t postFunc,
+                             void                           *arg,
+                             const varArr_t                 sendLayout,
+                             const varArr_t                 recvLayout);
+
+static void
+local_overlapPostChunk(local_overlapChunk_t    *chunk,
+                       MPI_Comm                comm,
+                       const gridPatch_t       patch,
+                       int                     idxOfVar,
+                       int                     dimChunk,
+                       const varArr_t          sendLayout,
+                       const varArr_t          recvLayout);
+
+static void
+local_overlapFinishChunk(local_overlapChunk_t    *chunk,
+                         const gridPatch_t       patchT,
+                         const dataVar_t         var,
+                         int                     dimA,
+                         int                     dimB,
+                         int                     dimChunk,
+                         const varArr_t          sendLayout,
+                         const varArr_t          recvLayout,
+                         void                    *dataT);
+
+static bool
+local_overlapGetWindow(const local_layoutElement_t le,
+                       int                         dimChunk,
+                       uint32_t                    chunkLo,
+                       uint32_t                    chunkHi,
+                       gridPointUint32_t           idxLo,
+                       gridPointUint32_t           idxHi);
+
+static uint64_t
+local_overlapGetNumCells(const gridPointUint32_t idxLo,
+                         const gridPointUint32_t idxHi);
+
+static void
+local_overlapUnpack(char                    *dataT,
+                    const char              *buf,
+                    size_t                  size,
+                    const gridPointUint32_t idxLo,
+                    const gridPointUint32_t idxHi,
+                    const gridPointUint32_t idxLoPatchT,
+                    const gridPointUint32_t dimsT,
+                    int                     dimA,
+                    int                     dimB);
 
 static local_layoutElement_t
 local_layoutElement_new(gridPointUint32_t idxLo,
@@ -150,14 +418,24 @@ gridRegularDistrib_new(gridRegular_t grid, const gridPointInt_t nProcs)
 	}
 	distrib->grid       = gridRegular_getRef(grid);
 #ifdef WITH_MPI
-	distrib->commGlobal = MPI_COMM_NULL;
-	distrib->commCart   = MPI_COMM_NULL;
+	distrib->commGlobal          = MPI_COMM_NULL;
+	distrib->commCart            = MPI_COMM_NULL;
+	distrib->schedules           = varArr_new(4);
+	distrib->scheduleBufSend     = NULL;
+	distrib->scheduleBufSendSize = 0;
+	distrib->scheduleBufRecv     = NULL;
+	distrib->scheduleBufRecvSize = 0;
+	distrib->transposeRoundBytes = NULL;
 #endif
 
 	refCounter_init(&(distrib->refCounter));
 	
 	distrib->factor_numerator = 1;
 	distrib->factor_denominator = 1;
+	distrib->numTransposeRounds = 0;
+	distrib->numOverlapChunks = 0;
+	distrib->usePersistentSchedules = false;
+	distrib->batchTransposeVars = false;
 
 	return gridRegularDistrib_getRef(distrib);
 }
@@ -170,6 +448,10 @@ gridRegularDistrib_del(gridRegularDistrib_t *distrib)
 	if (refCounter_deref(&((*distrib)->refCounter))) {
 		gridRegular_del(&((*distrib)->grid));
 #ifdef WITH_MPI
+		local_transposeSchedulesClear(*distrib);
+		varArr_del(&((*distrib)->schedules));
+		if ((*distrib)->transposeRoundBytes != NULL)
+			xfree((*distrib)->transposeRoundBytes);
 		if ((*distrib)->commGlobal != MPI_COMM_NULL)
 			MPI_Comm_free(&((*distrib)->commGlobal));
 		if ((*distrib)->commCart != MPI_COMM_NULL)
@@ -305,6 +587,56 @@ gridRegularDistrib_getGridHandle(const gridRegularDistrib_t distrib)
 	return distrib->grid;
 }
 
+extern gridRegularDistrib_decomp_t
+gridRegularDistrib_getDecompFromName(const char *name)
+{
+	assert(name != NULL);
+
+	if (strcmp(name, "auto") == 0)
+		return GRIDREGULARDISTRIB_DECOMP_AUTO;
+	else if (strcmp(name, "slab") == 0)
+		return GRIDREGULARDISTRIB_DECOMP_SLAB;
+	else if (strcmp(name, "pencil") == 0)
+		return GRIDREGULARDISTRIB_DECOMP_PENCIL;
+
+	return GRIDREGULARDISTRIB_DECOMP_UNKNOWN;
+}
+
+extern gridRegularDistrib_decomp_t
+gridRegularDistrib_calcNProcsForDecomp(gridRegularDistrib_decomp_t decomp,
+                                       const gridPointUint32_t     dims,
+                                       int                         numProcs,
+                                       gridPointInt_t              nProcs)
+{
+	bool slabFits = true;
+
+	assert(decomp != GRIDREGULARDISTRIB_DECOMP_UNKNOWN);
+	assert(dims != NULL);
+	assert(numProcs > 0);
+	assert(nProcs != NULL);
+
+	// After the first transposition the slabs are cut along the second
+	// dimension, hence all but the first need enough cells.
+	for (int i = 1; i < NDIM; i++) {
+		if ((uint32_t)numProcs > dims[i])
+			slabFits = false;
+	}
+
+	if (decomp == GRIDREGULARDISTRIB_DECOMP_AUTO)
+		decomp = slabFits ? GRIDREGULARDISTRIB_DECOMP_SLAB
+		         : GRIDREGULARDISTRIB_DECOMP_PENCIL;
+
+	nProcs[0] = 1;
+	if (decomp == GRIDREGULARDISTRIB_DECOMP_SLAB) {
+		assert(slabFits);
+		for (int i = 1; i < NDIM - 1; i++)
+			nProcs[i] = 1;
+		nProcs[NDIM - 1] = numProcs;
+	}
+
+	return decomp;
+}
+
 extern void
 gridRegularDistrib_calcIdxsForRank1D(uint32_t nCells,
                                      int      nProcs,
@@ -373,22 +705,201 @@ gridRegularDistrib_getFactor(gridRegularDistrib_t distrib,
 	*factor_denominator = distrib->factor_denominator;
 }
 
+extern void
+gridRegularDistrib_setNumTransposeRounds(gridRegularDistrib_t distrib,
+                                         int                  numRounds)
+{
+	assert(distrib != NULL);
+	assert(numRounds >= 0);
+
+	distrib->numTransposeRounds = numRounds;
+}
+
+extern int
+gridRegularDistrib_getNumTransposeRounds(const gridRegularDistrib_t distrib)
+{
+	assert(distrib != NULL);
+
+	return distrib->numTransposeRounds;
+}
+
+extern void
+gridRegularDistrib_setNumOverlapChunks(gridRegularDistrib_t distrib,
+                                       int                  numChunks)
+{
+	assert(distrib != NULL);
+	assert(numChunks >= 0);
+
+	distrib->numOverlapChunks = numChunks;
+}
+
+extern int
+gridRegularDistrib_getNumOverlapChunks(const gridRegularDistrib_t distrib)
+{
+	assert(distrib != NULL);
+
+	return distrib->numOverlapChunks;
+}
+
+extern void
+gridRegularDistrib_setUsePersistentSchedules(gridRegularDistrib_t distrib,
+                                             bool                 usePersistent)
+{
+	assert(distrib != NULL);
+
+	distrib->usePersistentSchedules = usePersistent;
+#ifdef WITH_MPI
+	if (!usePersistent)
+		local_transposeSchedulesClear(distrib);
+#endif
+}
+
+extern bool
+gridRegularDistrib_getUsePersistentSchedules(
+    const gridRegularDistrib_t distrib)
+{
+	assert(distrib != NULL);
+
+	return distrib->usePersistentSchedules;
+}
+
+extern void
+gridRegularDistrib_setBatchTransposeVars(gridRegularDistrib_t distrib,
+                                         bool                 batchVars)
+{
+	assert(distrib != NULL);
+
+	distrib->batchTransposeVars = batchVars;
+}
+
+extern bool
+gridRegularDistrib_getBatchTransposeVars(const gridRegularDistrib_t distrib)
+{
+	assert(distrib != NULL);
+
+	return distrib->batchTransposeVars;
+}
+
 extern void
 gridRegularDistrib_transpose(gridRegularDistrib_t distrib,
                              int                  dimA,
                              int                  dimB)
 {
+	const char *tag;
+
 	assert(distrib != NULL);
 	assert(dimA >= 0 && dimA < NDIM);
 	assert(dimB >= 0 && dimB < NDIM);
 
+	// The patch data is tagged as grid memory by the patch, all other
+	// allocations are communication buffers.
+	prof_start("transpose");
+	tag = xmem_setTrackTag("transpose");
 #ifdef WITH_MPI
-	local_transposeMPI(distrib, dimA, dimB);
+	if ((distrib->nProcs[dimA] == 1) && (distrib->nProcs[dimB] == 1)) {
+		// Nothing to exchange, this is the second transposition of a slab.
+		gridRegular_transpose(distrib->grid, dimA, dimB);
+		(void)xmem_setTrackTag(tag);
+		prof_stop("transpose");
+		return;
+	}
+	if (distrib->numTransposeRounds > 0) {
+		local_transposeMPIStreamed(distrib, dimA, dimB);
+		(void)xmem_setTrackTag(tag);
+		prof_stop("transpose");
+		return;
+	}
+	if (distrib->usePersistentSchedules)
+		local_transposeMPIScheduled(distrib, dimA, dimB);
+	else
+		local_transposeMPI(distrib, dimA, dimB);
 #endif
 	gridRegular_transpose(distrib->grid, dimA, dimB);
+	(void)xmem_setTrackTag(tag);
+	prof_stop("transpose");
+}
+
+extern void
+gridRegularDistrib_transposeLayout(gridRegularDistrib_t distrib,
+                                   int                  dimA,
+                                   int                  dimB)
+{
+	gridPatch_t patch;
+
+	assert(distrib != NULL);
+	assert(dimA >= 0 && dimA < NDIM);
+	assert(dimB >= 0 && dimB < NDIM);
+
+	patch = gridRegular_getPatchHandle(distrib->grid, 0);
+	for (int i = 0; i < gridPatch_getNumVars(patch); i++)
+		gridPatch_freeVarData(patch, i);
+
+#ifdef WITH_MPI
+	if ((distrib->nProcs[dimA] != 1) || (distrib->nProcs[dimB] != 1))
+		local_transposeLayoutMPI(distrib, dimA, dimB);
+#endif
+	gridRegular_transpose(distrib->grid, dimA, dimB);
+}
+
+extern void
+gridRegularDistrib_transposeOverlapped(
+    gridRegularDistrib_t           distrib,
+    int                            dimA,
+    int                            dimB,
+    gridRegularDistrib_chunkFunc_t preFunc,
+    gridRegularDistrib_chunkFunc_t postFunc,
+    void                           *arg)
+{
+	// The chunks are cut along the dimension that is left alone, it is
+	// distributed identically before and after the transposition.
+	int dimChunk = (NDIM > 2) ? NDIM * (NDIM - 1) / 2 - dimA - dimB : 1;
+
+	assert(distrib != NULL);
+	assert(dimA >= 0 && dimA < NDIM);
+	assert(dimB >= 0 && dimB < NDIM);
+	assert(dimA != dimB);
+
+#ifdef WITH_MPI
+	if ((NDIM > 2) && (distrib->numOverlapChunks > 0)
+	    && ((distrib->nProcs[dimA] != 1) || (distrib->nProcs[dimB] != 1))) {
+		const char *tag;
+
+		prof_start("transposeOverlap");
+		tag = xmem_setTrackTag("transpose");
+		local_transposeMPIOverlapped(distrib, dimA, dimB, dimChunk,
+		                             preFunc, postFunc, arg);
+		(void)xmem_setTrackTag(tag);
+		prof_stop("transposeOverlap");
+		return;
+	}
+#endif
+	local_applyChunkFunc(distrib, preFunc, arg, dimChunk);
+	gridRegularDistrib_transpose(distrib, dimA, dimB);
+	local_applyChunkFunc(distrib, postFunc, arg, dimChunk);
 }
 
 /*--- Implementations of local functions --------------------------------*/
+static void
+local_applyChunkFunc(gridRegularDistrib_t           distrib,
+                     gridRegularDistrib_chunkFunc_t func,
+                     void                           *arg,
+                     int                            dimChunk)
+{
+	gridPatch_t       patch;
+	gridPointUint32_t dims;
+
+	if (func == NULL)
+		return;
+
+	patch = gridRegular_getPatchHandle(distrib->grid, 0);
+	gridPatch_getDims(patch, dims);
+	for (int i = 0; i < gridPatch_getNumVars(patch); i++) {
+		assert(!dataVar_isFFTWPadded(gridPatch_getVarHandle(patch, i)));
+		func(arg, i, gridPatch_getVarDataHandle(patch, i), dims, dimChunk,
+		     0, dims[dimChunk] - 1);
+	}
+}
+
 static void
 local_calcProcCoords(gridRegularDistrib_t distrib,
                      int                  rank,
@@ -423,6 +934,11 @@ local_calcProcCoords(gridRegularDistrib_t distrib,
  *  a tad more than twice the original patch data (depending on the
  *  difference in patch sizes between the tranposed and the
  *  un-transposed patch).
+ *
+ *  If requested, consecutive variables of the same type are handled
+ *  together, the windows of all of them are sent in one message per
+ *  process, so that
+ *  the latency is only paid once for all of them.
  */
 static void
 local_transposeMPI(gridRegularDistrib_t distrib,
@@ -437,7 +953,8 @@ local_transposeMPI(gridRegularDistrib_t distrib,
 	                       &patch, &patchT, &sendLayout, &recvLayout);
 
 	local_transposeAllVarsAtPatch(patch, patchT, distrib->commCart,
-	                              sendLayout, recvLayout);
+	                              sendLayout, recvLayout,
+	                              distrib->batchTransposeVars);
 	assert(gridPatch_getNumVars(patch) == 0);
 
 	gridRegular_replacePatch(distrib->grid, 0, patchT);
@@ -445,6 +962,364 @@ local_transposeMPI(gridRegularDistrib_t distrib,
 	local_transposeMPIClean(sendLayout, recvLayout);
 }
 
+/*
+ * The streaming variant works in-place on the patch data:
+ *   - Reorder the patch data such that the windows for the different
+ *     processes follow each other, ordered by the round in which they
+ *     are sent (windows are split along the slowest varying dimension
+ *     to have at least as many pieces as rounds)
+ *   - Send directly from the patch data; in round r the processes
+ *     exchange with those that are r/K of the way around the ranks,
+ *     the next round is already posted while waiting for the current
+ *     one
+ *   - Received pieces are copied back into the part of the patch
+ *     data that has already been sent
+ *   - Reorder the data into the transposed patch layout
+ *
+ * With K rounds this needs the patch data plus two rounds of receive
+ * buffers, i.e. about (1 + 2/K) times the patch data (plus one bit per
+ * cell to keep track of the reordering), if the patches are not too
+ * different in size.
+ */
+static void
+local_transposeMPIStreamed(gridRegularDistrib_t distrib,
+                           int                  dimA,
+                           int                  dimB)
+{
+	gridPatch_t             patch, patchT;
+	varArr_t                sendLayout;
+	varArr_t                recvLayout;
+	local_transposeStream_t stream;
+	int                     numVars;
+	size_t                  sizeAll;
+	void                    **data;
+
+	local_transposeMPIInit(distrib, dimA, dimB,
+	                       &patch, &patchT, &sendLayout, &recvLayout);
+	stream = local_transposeStream_new(distrib, dimA, dimB,
+	                                   sendLayout, recvLayout);
+
+	// Keep track of what is sent per round (summed over the variables),
+	// which is what the receive buffers of a round have to hold.
+	numVars = gridPatch_getNumVars(patch);
+	sizeAll = 0;
+	for (int i = 0; i < numVars; i++)
+		sizeAll += dataVar_getSizePerElement(gridPatch_getVarHandle(patch,
+		                                                            i));
+	if (distrib->transposeRoundBytes != NULL)
+		xfree(distrib->transposeRoundBytes);
+	distrib->transposeRoundBytes = xmalloc(sizeof(uint64_t)
+	                                       * stream->numRounds);
+	for (int r = 0; r < stream->numRounds; r++) {
+		uint64_t lo = (r == 0) ? 0 : stream->sendEnd[r - 1];
+		distrib->transposeRoundBytes[r] = (stream->sendEnd[r] - lo) * sizeAll;
+	}
+
+	while (gridPatch_getNumVars(patch) > 0)
+		local_transposeStreamVar(stream, patch, patchT, dimA, dimB);
+
+	local_transposeStream_del(&stream);
+	gridRegular_replacePatch(distrib->grid, 0, patchT);
+	local_transposeMPIClean(sendLayout, recvLayout);
+
+	// The data is already in the transposed order, only the layout must
+	// follow.
+	numVars = gridPatch_getNumVars(patchT);
+	data    = xmalloc(sizeof(void *) * (numVars > 0 ? numVars : 1));
+	for (int i = 0; i < numVars; i++)
+		data[i] = gridPatch_popVarData(patchT, i);
+	gridRegular_transpose(distrib->grid, dimA, dimB);
+	patchT = gridRegular_getPatchHandle(distrib->grid, 0);
+	for (int i = 0; i < numVars; i++)
+		gridPatch_replaceVarData(patchT, i, data[i]);
+	xfree(data);
+}
+
+/*
+ * The scheduled variant does the same as local_transposeMPI(), but the
+ * layouts, the message buffers and the (persistent) requests are taken
+ * from a schedule that is kept at the distribution and replayed by all
+ * later transpositions of the same kind.
+ */
+static void
+local_transposeMPIScheduled(gridRegularDistrib_t distrib,
+                            int                  dimA,
+                            int                  dimB)
+{
+	gridPatch_t       patch, patchT;
+	int               rank;
+	gridPointInt_t    pPos;
+	gridPointUint32_t dims;
+
+	prof_start("init");
+	MPI_Comm_rank(distrib->commCart, &rank);
+	MPI_Cart_coords(distrib->commCart, rank, NDIM, pPos);
+	gridRegular_getDims(distrib->grid, dims);
+	patch  = gridRegular_getPatchHandle(distrib->grid, 0);
+	patchT = local_transposeGetPatchT(dims, distrib->nProcs,
+	                                  pPos, dimA, dimB,
+	                                  distrib->factor_numerator,
+	                                  distrib->factor_denominator);
+	prof_stop("init");
+
+	while (gridPatch_getNumVars(patch) > 0) {
+		int                       idxOfVar = gridPatch_getNumVars(patchT);
+		int                       numVars;
+		dataVar_t                 *vars;
+		local_transposeSchedule_t schedule;
+		uint64_t                  offset;
+		int                       size;
+
+		numVars  = local_transposeGetNumBatchableVars(
+		    patch, distrib->batchTransposeVars);
+		prof_start("init");
+		schedule = local_transposeGetSchedule(distrib, dimA, dimB,
+		                                      patch, numVars);
+		prof_stop("init");
+		vars     = xmalloc(sizeof(dataVar_t) * numVars);
+		for (int i = 0; i < numVars; i++)
+			vars[i] = dataVar_getRef(gridPatch_getVarHandle(patch, i));
+		size     = schedule->size;
+
+		prof_start("pack");
+		for (int j = 0; j < varArr_getLength(schedule->sendLayout); j++) {
+			local_layoutElement_t le;
+			char                  *buf;
+
+			le     = varArr_getElementHandle(schedule->sendLayout, j);
+			buf    = commSchemeBuffer_getBuf(le->buffer);
+			offset = local_overlapGetNumCells(le->idxLo, le->idxHi);
+			for (int i = 0; i < numVars; i++)
+				(void)gridPatch_getWindowedData(patch, i, le->idxLo,
+				                                le->idxHi,
+				                                buf + i * offset * size);
+		}
+		for (int i = 0; i < numVars; i++) {
+			dataVar_t varTmp = gridPatch_detachVar(patch, 0);
+			dataVar_del(&varTmp);
+		}
+		prof_stop("pack");
+
+		prof_start("comm");
+		commScheme_fire(schedule->scheme);
+		commScheme_wait(schedule->scheme);
+		prof_stop("comm");
+
+		prof_start("unpack");
+		for (int i = 0; i < numVars; i++)
+			(void)gridPatch_attachVar(patchT, vars[i]);
+		for (int j = 0; j < varArr_getLength(schedule->recvLayout); j++) {
+			local_layoutElement_t le;
+			char                  *buf;
+
+			le     = varArr_getElementHandle(schedule->recvLayout, j);
+			buf    = commSchemeBuffer_getBuf(le->buffer);
+			offset = local_overlapGetNumCells(le->idxLo, le->idxHi);
+			for (int i = 0; i < numVars; i++)
+				gridPatch_putWindowedData(patchT, idxOfVar + i, le->idxLo,
+				                          le->idxHi, buf + i * offset * size);
+		}
+		prof_stop("unpack");
+
+		for (int i = 0; i < numVars; i++)
+			dataVar_del(vars + i);
+		xfree(vars);
+	}
+
+	gridRegular_replacePatch(distrib->grid, 0, patchT);
+} /* local_transposeMPIScheduled */
+
+static local_transposeSchedule_t
+local_transposeGetSchedule(gridRegularDistrib_t distrib,
+                           int                  dimA,
+                           int                  dimB,
+                           const gridPatch_t    patch,
+                           int                  numVars)
+{
+	local_transposeSchedule_t schedule;
+	gridPointUint32_t         dims;
+
+	gridRegular_getDims(distrib->grid, dims);
+	for (int i = 0; i < varArr_getLength(distrib->schedules); i++) {
+		schedule = varArr_getElementHandle(distrib->schedules, i);
+		if (local_transposeScheduleMatches(schedule, dimA, dimB, dims,
+		                                   patch, numVars))
+			return schedule;
+	}
+
+	schedule = local_transposeSchedule_new(distrib, dimA, dimB, patch,
+	                                       numVars);
+	(void)varArr_insert(distrib->schedules, schedule);
+
+	return schedule;
+}
+
+static local_transposeSchedule_t
+local_transposeSchedule_new(gridRegularDistrib_t distrib,
+                            int                  dimA,
+                            int                  dimB,
+                            const gridPatch_t    patch,
+                            int                  numVars)
+{
+	local_transposeSchedule_t schedule;
+	dataVar_t                 var = gridPatch_getVarHandle(patch, 0);
+	int                       rank;
+	gridPointInt_t            pPos;
+	uint64_t                  sizeSend, sizeRecv;
+
+	schedule          = xmalloc(sizeof(struct local_transposeSchedule_struct));
+	schedule->dimA    = dimA;
+	schedule->dimB    = dimB;
+	gridRegular_getDims(distrib->grid, schedule->dims);
+	gridPatch_getIdxLo(patch, schedule->idxLo);
+	gridPatch_getDims(patch, schedule->patchDims);
+	schedule->type    = dataVar_getMPIDatatype(var);
+	schedule->size    = dataVar_getSizePerElement(var);
+	schedule->numVars = numVars;
+
+	MPI_Comm_rank(distrib->commCart, &rank);
+	MPI_Cart_coords(distrib->commCart, rank, NDIM, pPos);
+	schedule->sendLayout = local_transposeGetSendLayout(
+	    schedule->dims, distrib->nProcs, pPos, dimA, dimB,
+	    distrib->factor_numerator, distrib->factor_denominator);
+	schedule->recvLayout = local_transposeGetRecvLayout(
+	    schedule->dims, distrib->nProcs, pPos, dimA, dimB,
+	    distrib->factor_numerator, distrib->factor_denominator);
+
+	// All schedules share the message buffers (only one is used at a
+	// time), those using the old buffers have to go if they grow.
+	sizeSend = local_transposeScheduleGetNumCells(schedule->sendLayout)
+	           * numVars * schedule->size;
+	sizeRecv = local_transposeScheduleGetNumCells(schedule->recvLayout)
+	           * numVars * schedule->size;
+	if ((sizeSend > distrib->scheduleBufSendSize)
+	    || (sizeRecv > distrib->scheduleBufRecvSize)) {
+		local_transposeSchedulesClear(distrib);
+		distrib->scheduleBufSend     = xmalloc(sizeSend > 0 ? sizeSend : 1);
+		distrib->scheduleBufSendSize = sizeSend;
+		distrib->scheduleBufRecv     = xmalloc(sizeRecv > 0 ? sizeRecv : 1);
+		distrib->scheduleBufRecvSize = sizeRecv;
+		xmem_trackAlloc(distrib->scheduleBufSend, sizeSend, NULL);
+		xmem_trackAlloc(distrib->scheduleBufRecv, sizeRecv, NULL);
+	}
+
+	schedule->scheme = commScheme_newPersistent(distrib->commCart,
+	                                            LOCAL_SCHEDULE_TAG);
+	local_transposeScheduleAddBuffers(schedule, schedule->sendLayout,
+	                                  distrib->scheduleBufSend, var,
+	                                  COMMSCHEME_TYPE_SEND,
+	                                  distrib->commCart);
+	local_transposeScheduleAddBuffers(schedule, schedule->recvLayout,
+	                                  distrib->scheduleBufRecv, var,
+	                                  COMMSCHEME_TYPE_RECV,
+	                                  distrib->commCart);
+
+	return schedule;
+} /* local_transposeSchedule_new */
+
+static void
+local_transposeSchedule_del(local_transposeSchedule_t *schedule)
+{
+	commScheme_del(&((*schedule)->scheme));
+	local_transposeMPIClean((*schedule)->sendLayout,
+	                        (*schedule)->recvLayout);
+	xfree(*schedule);
+
+	*schedule = NULL;
+}
+
+static bool
+local_transposeScheduleMatches(const local_transposeSchedule_t schedule,
+                               int                             dimA,
+                               int                             dimB,
+                               const gridPointUint32_t         dims,
+                               const gridPatch_t               patch,
+                               int                             numVars)
+{
+	dataVar_t         var = gridPatch_getVarHandle(patch, 0);
+	gridPointUint32_t idxLo, patchDims;
+
+	if ((schedule->dimA != dimA) || (schedule->dimB != dimB)
+	    || (schedule->numVars != numVars)
+	    || (schedule->type != dataVar_getMPIDatatype(var))
+	    || (schedule->size != dataVar_getSizePerElement(var)))
+		return false;
+
+	gridPatch_getIdxLo(patch, idxLo);
+	gridPatch_getDims(patch, patchDims);
+	for (int i = 0; i < NDIM; i++) {
+		if ((schedule->dims[i] != dims[i])
+		    || (schedule->idxLo[i] != idxLo[i])
+		    || (schedule->patchDims[i] != patchDims[i]))
+			return false;
+	}
+
+	return true;
+}
+
+static void
+local_transposeScheduleAddBuffers(local_transposeSchedule_t schedule,
+                                  const varArr_t            layout,
+                                  char                      *buf,
+                                  dataVar_t                 var,
+                                  int                       type,
+                                  MPI_Comm                  comm)
+{
+	uint64_t offset = 0;
+
+	for (int j = 0; j < varArr_getLength(layout); j++) {
+		local_layoutElement_t le = varArr_getElementHandle(layout, j);
+		uint64_t              numCells;
+		int                   count;
+		int                   rank;
+
+		numCells   = local_overlapGetNumCells(le->idxLo, le->idxHi)
+		             * schedule->numVars;
+		count      = dataVar_getMPICount(var, numCells);
+		MPI_Cart_rank(comm, le->processCoord, &rank);
+		le->buffer = commSchemeBuffer_new(buf + offset, count,
+		                                  schedule->type, rank);
+		commScheme_addBuffer(schedule->scheme, le->buffer, type);
+		offset    += numCells * schedule->size;
+	}
+}
+
+static uint64_t
+local_transposeScheduleGetNumCells(const varArr_t layout)
+{
+	uint64_t numCells = 0;
+
+	for (int j = 0; j < varArr_getLength(layout); j++) {
+		local_layoutElement_t le = varArr_getElementHandle(layout, j);
+		numCells += local_overlapGetNumCells(le->idxLo, le->idxHi);
+	}
+
+	return numCells;
+}
+
+static void
+local_transposeSchedulesClear(gridRegularDistrib_t distrib)
+{
+	while (varArr_getLength(distrib->schedules) > 0) {
+		local_transposeSchedule_t schedule;
+
+		schedule = varArr_remove(distrib->schedules, 0);
+		local_transposeSchedule_del(&schedule);
+	}
+	if (distrib->scheduleBufSend != NULL) {
+		xmem_trackFree(distrib->scheduleBufSend);
+		xfree(distrib->scheduleBufSend);
+	}
+	if (distrib->scheduleBufRecv != NULL) {
+		xmem_trackFree(distrib->scheduleBufRecv);
+		xfree(distrib->scheduleBufRecv);
+	}
+	distrib->scheduleBufSend     = NULL;
+	distrib->scheduleBufSendSize = 0;
+	distrib->scheduleBufRecv     = NULL;
+	distrib->scheduleBufRecvSize = 0;
+}
+
 static void
 local_transposeMPIInit(gridRegularDistrib_t distrib,
                        int                  dimA,
@@ -461,6 +1336,7 @@ local_transposeMPIInit(gridRegularDistrib_t distrib,
 #  ifdef WITH_MPITRACE
 	MPItrace_event(LOCAL_MPITRACE_EVENT, 11);
 #  endif
+	prof_start("init");
 	MPI_Comm_rank(distrib->commCart, &rank);
 	MPI_Cart_coords(distrib->commCart, rank, NDIM, pPos);
 	gridRegular_getDims(distrib->grid, dims);
@@ -479,6 +1355,7 @@ local_transposeMPIInit(gridRegularDistrib_t distrib,
 	                                   pPos, dimA, dimB,
 	                                   distrib->factor_numerator,
 	                                   distrib->factor_denominator);
+	prof_stop("init");
 #  ifdef WITH_MPITRACE
 	MPItrace_event(LOCAL_MPITRACE_EVENT, 0);
 #  endif
@@ -495,6 +1372,39 @@ local_transposeMPIClean(varArr_t sendLayout, varArr_t recvLayout)
 	varArr_del(&recvLayout);
 }
 
+static void
+local_transposeLayoutMPI(gridRegularDistrib_t distrib,
+                         int                  dimA,
+                         int                  dimB)
+{
+	int               rank;
+	gridPointInt_t    pPos;
+	gridPointUint32_t dims;
+	gridPatch_t       patch, patchT;
+
+	MPI_Comm_rank(distrib->commCart, &rank);
+	MPI_Cart_coords(distrib->commCart, rank, NDIM, pPos);
+	gridRegular_getDims(distrib->grid, dims);
+
+	patch  = gridRegular_getPatchHandle(distrib->grid, 0);
+	patchT = local_transposeGetPatchT(dims, distrib->nProcs,
+	                                  pPos, dimA, dimB,
+	                                  distrib->factor_numerator,
+	                                  distrib->factor_denominator);
+
+	while (gridPatch_getNumVars(patch) > 0) {
+		dataVar_t var = dataVar_getRef(gridPatch_getVarHandle(patch, 0));
+		dataVar_t varTmp;
+
+		varTmp = gridPatch_detachVar(patch, 0);
+		dataVar_del(&varTmp);
+		(void)gridPatch_attachVar(patchT, var);
+		dataVar_del(&var);
+	}
+
+	gridRegular_replacePatch(distrib->grid, 0, patchT);
+}
+
 static gridPatch_t
 local_transposeGetPatchT(gridPointUint32_t dims,
                          gridPointInt_t    nProcs,
@@ -613,36 +1523,43 @@ local_transposeAllVarsAtPatch(gridPatch_t    patch,
                               gridPatch_t    patchT,
                               MPI_Comm       commCart,
                               const varArr_t sendLayout,
-                              const varArr_t recvLayout)
+                              const varArr_t recvLayout,
+                              bool           batchVars)
 {
-	int numVars = gridPatch_getNumVars(patch);
-
-	for (int i = 0; i < numVars; i++) {
-		int          idxOfVar;
-		dataVar_t    varTmp;
-		dataVar_t    var    = gridPatch_getVarHandle(patch, 0);
-		commScheme_t scheme = commScheme_new(commCart, 4223);
+	while (gridPatch_getNumVars(patch) > 0) {
+		int          idxOfVar = gridPatch_getNumVars(patchT);
+		int          numVars  = local_transposeGetNumBatchableVars(patch,
+		                                                           batchVars);
+		dataVar_t    *vars    = xmalloc(sizeof(dataVar_t) * numVars);
+		commScheme_t scheme   = commScheme_new(commCart, 4223);
 
-		var = dataVar_getRef(var);
+		for (int i = 0; i < numVars; i++)
+			vars[i] = dataVar_getRef(gridPatch_getVarHandle(patch, i));
 
+		prof_start("pack");
 #  ifdef WITH_MPITRACE
 		MPItrace_event(LOCAL_MPITRACE_EVENT, 12);
 #  endif
 		local_transposeGetFullSendBuffers(scheme, sendLayout, patch,
-		                                  var, commCart);
+		                                  vars[0], numVars, commCart);
 #  ifdef WITH_MPITRACE
 		MPItrace_event(LOCAL_MPITRACE_EVENT, 0);
 #  endif
-		varTmp = gridPatch_detachVar(patch, 0);
-		dataVar_del(&varTmp);
+		for (int i = 0; i < numVars; i++) {
+			dataVar_t varTmp = gridPatch_detachVar(patch, 0);
+			dataVar_del(&varTmp);
+		}
 #  ifdef WITH_MPITRACE
 		MPItrace_event(LOCAL_MPITRACE_EVENT, 13);
 #  endif
-		local_transposeGetRecvBuffers(scheme, recvLayout, var, commCart);
+		local_transposeGetRecvBuffers(scheme, recvLayout, vars[0], numVars,
+		                              commCart);
 #  ifdef WITH_MPITRACE
 		MPItrace_event(LOCAL_MPITRACE_EVENT, 0);
 #  endif
+		prof_stop("pack");
 
+		prof_start("comm");
 #  ifdef WITH_MPITRACE
 		MPItrace_event(LOCAL_MPITRACE_EVENT, 14);
 #  endif
@@ -651,51 +1568,88 @@ local_transposeAllVarsAtPatch(gridPatch_t    patch,
 #  ifdef WITH_MPITRACE
 		MPItrace_event(LOCAL_MPITRACE_EVENT, 0);
 #  endif
+		prof_stop("comm");
 
+		prof_start("unpack");
 #  ifdef WITH_MPITRACE
 		MPItrace_event(LOCAL_MPITRACE_EVENT, 15);
 #  endif
-		local_transposeDelSendBuffers(sendLayout, var);
+		local_transposeDelSendBuffers(sendLayout, vars[0]);
 #  ifdef WITH_MPITRACE
 		MPItrace_event(LOCAL_MPITRACE_EVENT, 0);
 #  endif
-		idxOfVar = gridPatch_attachVar(patchT, var);
+		for (int i = 0; i < numVars; i++)
+			(void)gridPatch_attachVar(patchT, vars[i]);
 #  ifdef WITH_MPITRACE
 		MPItrace_event(LOCAL_MPITRACE_EVENT, 16);
 #  endif
 		local_transposeMoveRecvBuffersToPatch(recvLayout, patchT,
-		                                      idxOfVar, var);
+		                                      idxOfVar, vars[0], numVars);
 #  ifdef WITH_MPITRACE
 		MPItrace_event(LOCAL_MPITRACE_EVENT, 0);
 #  endif
+		prof_stop("unpack");
 
 		commScheme_del(&scheme);
-		dataVar_del(&var);
+		for (int i = 0; i < numVars; i++)
+			dataVar_del(vars + i);
+		xfree(vars);
 	}
 } /* local_transposeAllVarsAtPatch */
 
+static int
+local_transposeGetNumBatchableVars(const gridPatch_t patch, bool batchVars)
+{
+	int          numVars = gridPatch_getNumVars(patch);
+	dataVar_t    var     = gridPatch_getVarHandle(patch, 0);
+	MPI_Datatype type    = dataVar_getMPIDatatype(var);
+	int          size    = dataVar_getSizePerElement(var);
+	int          i       = 1;
+
+	if (!batchVars)
+		return 1;
+
+	// Consecutive variables of the same kind share their messages.
+	while (i < numVars) {
+		dataVar_t varOther = gridPatch_getVarHandle(patch, i);
+		if ((dataVar_getMPIDatatype(varOther) != type)
+		    || (dataVar_getSizePerElement(varOther) != size))
+			break;
+		i++;
+	}
+
+	return i;
+}
+
 static void
 local_transposeGetFullSendBuffers(commScheme_t      scheme,
                                   const varArr_t    layout,
                                   const gridPatch_t patch,
                                   const dataVar_t   var,
+                                  int               numVars,
                                   MPI_Comm          comm)
 {
 	int          len  = varArr_getLength(layout);
 	MPI_Datatype type = dataVar_getMPIDatatype(var);
+	int          size = dataVar_getSizePerElement(var);
 
 	for (int j = 0; j < len; j++) {
-		void                  *dataSend;
-		uint64_t              dataSize;
-		local_layoutElement_t le = varArr_getElementHandle(layout, j);
+		char                  *dataSend;
+		uint64_t              dataSize = 1;
+		local_layoutElement_t le       = varArr_getElementHandle(layout, j);
 		int                   count;
 		int                   rankSend;
 
-		// We always work on the 0th variable as the patch is
-		// emptied during the course of the main loop.
-		dataSend   = gridPatch_getWindowedDataCopy(patch, 0, le->idxLo,
-		                                           le->idxHi, &dataSize);
-		count      = dataVar_getMPICount(var, dataSize);
+		for (int k = 0; k < NDIM; k++)
+			dataSize *= (le->idxHi[k] - le->idxLo[k] + 1);
+
+		// The windows of all variables go into one message, one after the
+		// other.
+		dataSend = dataVar_getMemory(var, dataSize * numVars);
+		for (int i = 0; i < numVars; i++)
+			(void)gridPatch_getWindowedData(patch, i, le->idxLo, le->idxHi,
+			                                dataSend + i * dataSize * size);
+		count      = dataVar_getMPICount(var, dataSize * numVars);
 		MPI_Cart_rank(comm, le->processCoord, &rankSend);
 		le->buffer = commSchemeBuffer_new(dataSend, count, type, rankSend);
 		commScheme_addBuffer(scheme, le->buffer, COMMSCHEME_TYPE_SEND);
@@ -706,6 +1660,7 @@ static void
 local_transposeGetRecvBuffers(commScheme_t    scheme,
                               const varArr_t  layout,
                               const dataVar_t var,
+                              int             numVars,
                               MPI_Comm        comm)
 {
 	int          len  = varArr_getLength(layout);
@@ -716,7 +1671,7 @@ local_transposeGetRecvBuffers(commScheme_t    scheme,
 		void                  *dataRecv;
 		int                   rankRecv;
 		int                   count;
-		uint64_t              dataSize = 1;
+		uint64_t              dataSize = numVars;
 
 		for (int k = 0; k < NDIM; k++) {
 			dataSize *= (le->idxHi[k] - le->idxLo[k] + 1);
@@ -743,19 +1698,819 @@ static void
 local_transposeMoveRecvBuffersToPatch(const varArr_t  layout,
                                       gridPatch_t     patchT,
                                       const int       idxOfVar,
-                                      const dataVar_t var)
+                                      const dataVar_t var,
+                                      int             numVars)
 {
+	int size = dataVar_getSizePerElement(var);
+
 	for (int j = 0; j < varArr_getLength(layout); j++) {
 		local_layoutElement_t le = varArr_getElementHandle(layout, j);
-		void                  *dataRecv;
+		char                  *dataRecv;
+		uint64_t              dataSize = 1;
+
+		for (int k = 0; k < NDIM; k++)
+			dataSize *= (le->idxHi[k] - le->idxLo[k] + 1);
 
 		dataRecv = commSchemeBuffer_getBuf(le->buffer);
-		gridPatch_putWindowedData(patchT, idxOfVar, le->idxLo,
-		                          le->idxHi, dataRecv);
+		for (int i = 0; i < numVars; i++)
+			gridPatch_putWindowedData(patchT, idxOfVar + i, le->idxLo,
+			                          le->idxHi, dataRecv + i * dataSize * size);
 		dataVar_freeMemory(var, dataRecv);
 	}
 }
 
+static local_transposeStream_t
+local_transposeStream_new(const gridRegularDistrib_t distrib,
+                          int                        dimA,
+                          int                        dimB,
+                          const varArr_t             sendLayout,
+                          const varArr_t             recvLayout)
+{
+	local_transposeStream_t stream;
+	int                     numPartners;
+	int                     numSplits;
+
+	stream            = xmalloc(sizeof(struct local_transposeStream_struct));
+	stream->comm      = distrib->commCart;
+	stream->dimA      = dimA;
+	stream->dimB      = dimB;
+	for (int i = 0; i < NDIM; i++)
+		stream->nProcs[i] = distrib->nProcs[i];
+	stream->numRounds = distrib->numTransposeRounds;
+
+	// Windows are split such that there are at least as many pieces as
+	// rounds, the number of partners is the same on all processes.
+	numPartners       = distrib->nProcs[dimA] * distrib->nProcs[dimB];
+	numSplits         = (stream->numRounds + numPartners - 1) / numPartners;
+
+	stream->send      = local_transposeStreamGetChunks(stream, sendLayout,
+	                                                   numSplits, true,
+	                                                   &(stream->numSend));
+	stream->recv      = local_transposeStreamGetChunks(stream, recvLayout,
+	                                                   numSplits, false,
+	                                                   &(stream->numRecv));
+	stream->sendEnd   = local_transposeStreamGetRoundEnds(stream->send,
+	                                                      stream->numSend,
+	                                                      stream->numRounds);
+	stream->recvEnd   = local_transposeStreamGetRoundEnds(stream->recv,
+	                                                      stream->numRecv,
+	                                                      stream->numRounds);
+
+	return stream;
+}
+
+static void
+local_transposeStream_del(local_transposeStream_t *stream)
+{
+	xfree((*stream)->send);
+	xfree((*stream)->sendEnd);
+	xfree((*stream)->recv);
+	xfree((*stream)->recvEnd);
+	xfree(*stream);
+
+	*stream = NULL;
+}
+
+static local_transposeChunk_t *
+local_transposeStreamGetChunks(const local_transposeStream_t stream,
+                               const varArr_t                layout,
+                               int                           numSplits,
+                               bool                          isSend,
+                               int                           *numChunks)
+{
+	int                    len = varArr_getLength(layout);
+	int                    rank, partner, numPartners;
+	gridPointInt_t         procCoords;
+	uint64_t               numSteps, offset = 0;
+	local_transposeChunk_t *chunks;
+
+	// Only the processes in the plane spanned by the two transposed
+	// dimensions exchange data, the steps are counted within that plane.
+	MPI_Comm_rank(stream->comm, &rank);
+	MPI_Cart_coords(stream->comm, rank, NDIM, procCoords);
+	partner     = local_transposeStreamGetPartnerIdx(stream, procCoords);
+	numPartners = stream->nProcs[stream->dimA] * stream->nProcs[stream->dimB];
+	numSteps    = (uint64_t)numPartners * numSplits;
+
+	*numChunks = 0;
+	for (int j = 0; j < len; j++) {
+		local_layoutElement_t le = varArr_getElementHandle(layout, j);
+		uint32_t ext = le->idxHi[NDIM - 1] - le->idxLo[NDIM - 1] + 1;
+		*numChunks += (ext < (uint32_t)numSplits) ? (int)ext : numSplits;
+	}
+	chunks     = xmalloc(sizeof(local_transposeChunk_t)
+	                     * (*numChunks > 0 ? *numChunks : 1));
+
+	*numChunks = 0;
+	for (int j = 0; j < len; j++) {
+		local_layoutElement_t le = varArr_getElementHandle(layout, j);
+		uint32_t              ext, numPieces;
+		int                   peer, peerPartner, shift;
+
+		// Sender and receiver see the same window and hence agree on the
+		// pieces and the round in which they are exchanged.
+		MPI_Cart_rank(stream->comm, le->processCoord, &peer);
+		peerPartner = local_transposeStreamGetPartnerIdx(stream,
+		                                                 le->processCoord);
+		shift       = isSend
+		              ? (peerPartner - partner + numPartners) % numPartners
+		              : (partner - peerPartner + numPartners) % numPartners;
+		ext       = le->idxHi[NDIM - 1] - le->idxLo[NDIM - 1] + 1;
+		numPieces = (ext < (uint32_t)numSplits) ? ext : numSplits;
+		for (uint32_t c = 0; c < numPieces; c++) {
+			local_transposeChunk_t *chunk = chunks + *numChunks;
+
+			chunk->numCells = 1;
+			for (int k = 0; k < NDIM; k++) {
+				chunk->idxLo[k] = le->idxLo[k];
+				chunk->idxHi[k] = le->idxHi[k];
+			}
+			chunk->idxLo[NDIM - 1] += (uint32_t)((uint64_t)c * ext
+			                                     / numPieces);
+			chunk->idxHi[NDIM - 1]  = le->idxLo[NDIM - 1] - 1
+			                          + (uint32_t)((uint64_t)(c + 1) * ext
+			                                       / numPieces);
+			for (int k = 0; k < NDIM; k++)
+				chunk->numCells *= chunk->idxHi[k] - chunk->idxLo[k] + 1;
+			chunk->rank  = peer;
+			chunk->step  = (uint64_t)shift * numSplits + c;
+			chunk->round = (int)(chunk->step * stream->numRounds
+			                     / numSteps);
+			(*numChunks)++;
+		}
+	}
+
+	qsort(chunks, *numChunks, sizeof(local_transposeChunk_t),
+	      &local_transposeChunkCompare);
+	for (int j = 0; j < *numChunks; j++) {
+		chunks[j].offset = offset;
+		offset          += chunks[j].numCells;
+	}
+
+	return chunks;
+} /* local_transposeStreamGetChunks */
+
+static int
+local_transposeStreamGetPartnerIdx(const local_transposeStream_t stream,
+                                   const gridPointInt_t          procCoords)
+{
+	return procCoords[stream->dimA]
+	       + procCoords[stream->dimB] * stream->nProcs[stream->dimA];
+}
+
+static int
+local_transposeChunkCompare(const void *a, const void *b)
+{
+	const local_transposeChunk_t *ca = a;
+	const local_transposeChunk_t *cb = b;
+
+	return (ca->step > cb->step) - (ca->step < cb->step);
+}
+
+static uint64_t *
+local_transposeStreamGetRoundEnds(const local_transposeChunk_t *chunks,
+                                  int                          numChunks,
+                                  int                          numRounds)
+{
+	uint64_t *ends = xmalloc(sizeof(uint64_t) * numRounds);
+	int      j     = 0;
+	uint64_t end   = 0;
+
+	for (int r = 0; r < numRounds; r++) {
+		while (j < numChunks && chunks[j].round == r) {
+			end += chunks[j].numCells;
+			j++;
+		}
+		ends[r] = end;
+	}
+	assert(j == numChunks);
+
+	return ends;
+}
+
+static void
+local_transposeStreamVar(const local_transposeStream_t stream,
+                         gridPatch_t                   patch,
+                         gridPatch_t                   patchT,
+                         int                           dimA,
+                         int                           dimB)
+{
+	dataVar_t var, varTmp;
+	size_t    size;
+	uint64_t  numCells, numCellsT;
+	void      *data;
+	int       idxOfVar;
+
+	var       = dataVar_getRef(gridPatch_getVarHandle(patch, 0));
+	assert(!dataVar_isFFTWPadded(var));
+	size      = dataVar_getSizePerElement(var);
+	numCells  = gridPatch_getNumCells(patch);
+	numCellsT = gridPatch_getNumCells(patchT);
+	assert(numCells == stream->sendEnd[stream->numRounds - 1]);
+	assert(numCellsT == stream->recvEnd[stream->numRounds - 1]);
+
+	// We always work on the 0th variable as the patch is emptied during
+	// the course of the main loop.
+	(void)gridPatch_getVarDataHandle(patch, 0);
+	data   = gridPatch_popVarData(patch, 0);
+	varTmp = gridPatch_detachVar(patch, 0);
+	dataVar_del(&varTmp);
+
+	if (numCellsT > numCells) {
+		const char *tag     = xmem_setTrackTag("grid");
+		void       *dataTmp = dataVar_getMemory(var, numCellsT);
+		(void)xmem_setTrackTag(tag);
+		memcpy(dataTmp, data, numCells * size);
+		dataVar_freeMemory(var, data);
+		data = dataTmp;
+	}
+
+	prof_start("pack");
+	local_transposeStreamPack(stream, patch, data, size);
+	prof_stop("pack");
+	prof_start("comm");
+	local_transposeStreamExchange(stream, var, data);
+	prof_stop("comm");
+	prof_start("unpack");
+	local_transposeStreamUnpack(stream, patchT, dimA, dimB, data, size);
+	prof_stop("unpack");
+
+	idxOfVar = gridPatch_attachVar(patchT, var);
+	gridPatch_replaceVarData(patchT, idxOfVar, data);
+	dataVar_del(&var);
+} /* local_transposeStreamVar */
+
+static void
+local_transposeStreamPack(const local_transposeStream_t stream,
+                          const gridPatch_t             patch,
+                          void                          *data,
+                          size_t                        size)
+{
+	gridPointUint32_t idxLo, dims;
+	uint64_t          numCells = stream->sendEnd[stream->numRounds - 1];
+	uint8_t           *done;
+	char              *tmp;
+	char              *d = data;
+
+	gridPatch_getIdxLo(patch, idxLo);
+	gridPatch_getDims(patch, dims);
+	done = xmalloc(numCells / 8 + 1);
+	memset(done, 0, numCells / 8 + 1);
+	tmp  = xmalloc(size);
+
+	// Follow the cycles of the permutation, pulling each element from the
+	// patch position that belongs to its position in the send order.
+	for (uint64_t start = 0; start < numCells; start++) {
+		uint64_t cur, src;
+
+		if (done[start / 8] & (1 << (start % 8)))
+			continue;
+		memcpy(tmp, d + start * size, size);
+		cur = start;
+		while (true) {
+			done[cur / 8] |= 1 << (cur % 8);
+			src            = local_transposeChunkToPatchIdx(stream->send,
+			                                                stream->numSend,
+			                                                cur, idxLo, dims,
+			                                                0, 0);
+			if (src == start)
+				break;
+			memcpy(d + cur * size, d + src * size, size);
+			cur = src;
+		}
+		memcpy(d + cur * size, tmp, size);
+	}
+
+	xfree(tmp);
+	xfree(done);
+}
+
+static void
+local_transposeStreamExchange(const local_transposeStream_t stream,
+                              const dataVar_t               var,
+                              void                          *data)
+{
+	int          numRounds = stream->numRounds;
+	size_t       size      = dataVar_getSizePerElement(var);
+	commScheme_t *schemes;
+	void         **stage;
+	int          placed = 0;
+
+	schemes    = xmalloc(sizeof(commScheme_t) * numRounds);
+	stage      = xmalloc(sizeof(void *) * numRounds);
+
+	schemes[0] = local_transposeStreamPostRound(stream, var, data, 0, stage);
+	for (int r = 0; r < numRounds; r++) {
+		uint64_t freeEnd;
+
+		if (r + 1 < numRounds)
+			schemes[r + 1] = local_transposeStreamPostRound(stream, var, data,
+			                                                r + 1,
+			                                                stage + r + 1);
+		if (schemes[r] != NULL) {
+			commScheme_wait(schemes[r]);
+			commScheme_del(schemes + r);
+		}
+
+		// Everything sent so far is free to take received data, once
+		// all is sent, the whole patch data is free.
+		freeEnd = stream->sendEnd[r];
+		if (freeEnd == stream->sendEnd[numRounds - 1])
+			freeEnd = UINT64_MAX;
+		while (placed <= r && stream->recvEnd[placed] <= freeEnd) {
+			uint64_t lo = (placed == 0) ? 0 : stream->recvEnd[placed - 1];
+			if (stage[placed] != NULL) {
+				memcpy(((char *)data) + lo * size, stage[placed],
+				       (stream->recvEnd[placed] - lo) * size);
+				dataVar_freeMemory(var, stage[placed]);
+			}
+			placed++;
+		}
+	}
+	assert(placed == numRounds);
+
+	xfree(stage);
+	xfree(schemes);
+} /* local_transposeStreamExchange */
+
+static commScheme_t
+local_transposeStreamPostRound(const local_transposeStream_t stream,
+                               const dataVar_t               var,
+                               void                          *data,
+                               int                           round,
+                               void                          **stage)
+{
+	commScheme_t scheme;
+	MPI_Datatype type   = dataVar_getMPIDatatype(var);
+	size_t       size   = dataVar_getSizePerElement(var);
+	uint64_t     sendLo = (round == 0) ? 0 : stream->sendEnd[round - 1];
+	uint64_t     recvLo = (round == 0) ? 0 : stream->recvEnd[round - 1];
+
+	*stage = NULL;
+	if ((stream->sendEnd[round] == sendLo)
+	    && (stream->recvEnd[round] == recvLo))
+		return NULL;
+
+	// Alternate the tags to keep neighbouring rounds apart.
+	scheme = commScheme_new(stream->comm, 4224 + round % 2);
+	if (stream->recvEnd[round] > recvLo)
+		*stage = dataVar_getMemory(var, stream->recvEnd[round] - recvLo);
+
+	for (int j = 0; j < stream->numSend; j++) {
+		const local_transposeChunk_t *chunk = stream->send + j;
+		commSchemeBuffer_t           buf;
+
+		if (chunk->round != round)
+			continue;
+		buf = commSchemeBuffer_new(((char *)data) + chunk->offset * size,
+		                           dataVar_getMPICount(var, chunk->numCells),
+		                           type, chunk->rank);
+		commScheme_addBuffer(scheme, buf, COMMSCHEME_TYPE_SEND);
+	}
+	for (int j = 0; j < stream->numRecv; j++) {
+		const local_transposeChunk_t *chunk = stream->recv + j;
+		commSchemeBuffer_t           buf;
+
+		if (chunk->round != round)
+			continue;
+		buf = commSchemeBuffer_new(((char *)*stage)
+		                           + (chunk->offset - recvLo) * size,
+		                           dataVar_getMPICount(var, chunk->numCells),
+		                           type, chunk->rank);
+		commScheme_addBuffer(scheme, buf, COMMSCHEME_TYPE_RECV);
+	}
+	commScheme_fire(scheme);
+
+	return scheme;
+} /* local_transposeStreamPostRound */
+
+static void
+local_transposeStreamUnpack(const local_transposeStream_t stream,
+                            const gridPatch_t             patchT,
+                            int                           dimA,
+                            int                           dimB,
+                            void                          *data,
+                            size_t                        size)
+{
+	gridPointUint32_t idxLo, dims;
+	uint64_t          numCells = stream->recvEnd[stream->numRounds - 1];
+	uint32_t          tmpDim;
+	uint8_t           *done;
+	char              *val, *tmp, *swap;
+	char              *d = data;
+
+	// The windows are given in the un-transposed coordinates of the
+	// patch, but the data should be laid out in the transposed order.
+	gridPatch_getIdxLo(patchT, idxLo);
+	gridPatch_getDims(patchT, dims);
+	tmpDim     = dims[dimA];
+	dims[dimA] = dims[dimB];
+	dims[dimB] = tmpDim;
+	done       = xmalloc(numCells / 8 + 1);
+	memset(done, 0, numCells / 8 + 1);
+	val        = xmalloc(size);
+	tmp        = xmalloc(size);
+
+	// Follow the cycles of the permutation, pushing each element to its
+	// final position.
+	for (uint64_t start = 0; start < numCells; start++) {
+		uint64_t cur, dst;
+
+		if (done[start / 8] & (1 << (start % 8)))
+			continue;
+		memcpy(val, d + start * size, size);
+		cur = start;
+		do {
+			dst              = local_transposeChunkToPatchIdx(stream->recv,
+			                                                  stream->numRecv,
+			                                                  cur, idxLo, dims,
+			                                                  dimA, dimB);
+			memcpy(tmp, d + dst * size, size);
+			memcpy(d + dst * size, val, size);
+			done[dst / 8]   |= 1 << (dst % 8);
+			swap             = val;
+			val              = tmp;
+			tmp              = swap;
+			cur              = dst;
+		} while (dst != start);
+	}
+
+	xfree(tmp);
+	xfree(val);
+	xfree(done);
+} /* local_transposeStreamUnpack */
+
+static uint64_t
+local_transposeChunkToPatchIdx(const local_transposeChunk_t *chunks,
+                               int                          numChunks,
+                               uint64_t                     pos,
+                               const gridPointUint32_t      idxLo,
+                               const gridPointUint32_t      dims,
+                               int                          dimA,
+                               int                          dimB)
+{
+	int               lo = 0, hi = numChunks - 1;
+	uint64_t          rest, idx = 0;
+	gridPointUint32_t coords;
+	uint32_t          tmp;
+
+	while (lo < hi) {
+		int mid = (lo + hi + 1) / 2;
+		if (chunks[mid].offset <= pos)
+			lo = mid;
+		else
+			hi = mid - 1;
+	}
+
+	rest = pos - chunks[lo].offset;
+	for (int k = 0; k < NDIM; k++) {
+		uint64_t ext = chunks[lo].idxHi[k] - chunks[lo].idxLo[k] + 1;
+		coords[k] = chunks[lo].idxLo[k] + (uint32_t)(rest % ext) - idxLo[k];
+		rest     /= ext;
+	}
+	tmp          = coords[dimA];
+	coords[dimA] = coords[dimB];
+	coords[dimB] = tmp;
+
+	for (int k = NDIM - 1; k >= 0; k--)
+		idx = idx * dims[k] + coords[k];
+
+	return idx;
+}
+
+/*
+ * The overlapped variant pipelines the transposition of every variable:
+ *   - The patch is cut into chunks along the dimension that is not
+ *     transposed, all partners use the same chunks
+ *   - For every chunk, the pre-function is applied, the windows for the
+ *     partners are packed and sent right away, while the receives for
+ *     the same chunk are posted
+ *   - Between chunks, the already posted chunks are tested, every chunk
+ *     that has fully arrived is unpacked directly into the transposed
+ *     layout and handed to the post-function
+ *   - After the last chunk is sent, the input data is freed and the
+ *     remaining chunks are completed in order
+ */
+static void
+local_transposeMPIOverlapped(gridRegularDistrib_t           distrib,
+                             int                            dimA,
+                             int                            dimB,
+                             int                            dimChunk,
+                             gridRegularDistrib_chunkFunc_t preFunc,
+                             gridRegularDistrib_chunkFunc_t postFunc,
+                             void                           *arg)
+{
+	gridPatch_t patch, patchT;
+	varArr_t    sendLayout;
+	varArr_t    recvLayout;
+	int         numVars;
+	void        **dataT;
+
+	local_transposeMPIInit(distrib, dimA, dimB,
+	                       &patch, &patchT, &sendLayout, &recvLayout);
+
+	numVars = gridPatch_getNumVars(patch);
+	dataT   = xmalloc(sizeof(void *) * (numVars > 0 ? numVars : 1));
+	for (int i = 0; i < numVars; i++)
+		dataT[i] = local_transposeOverlappedVar(distrib, patch, patchT, i,
+		                                        dimA, dimB, dimChunk,
+		                                        preFunc, postFunc, arg,
+		                                        sendLayout, recvLayout);
+
+	while (gridPatch_getNumVars(patch) > 0) {
+		dataVar_t var = dataVar_getRef(gridPatch_getVarHandle(patch, 0));
+		dataVar_t varTmp;
+
+		varTmp = gridPatch_detachVar(patch, 0);
+		dataVar_del(&varTmp);
+		(void)gridPatch_attachVar(patchT, var);
+		dataVar_del(&var);
+	}
+	gridRegular_replacePatch(distrib->grid, 0, patchT);
+	local_transposeMPIClean(sendLayout, recvLayout);
+
+	// The data is already in the transposed order, only the layout must
+	// follow.
+	gridRegular_transpose(distrib->grid, dimA, dimB);
+	patchT = gridRegular_getPatchHandle(distrib->grid, 0);
+	for (int i = 0; i < numVars; i++)
+		gridPatch_replaceVarData(patchT, i, dataT[i]);
+	xfree(dataT);
+} /* local_transposeMPIOverlapped */
+
+static void *
+local_transposeOverlappedVar(const gridRegularDistrib_t     distrib,
+                             gridPatch_t                    patch,
+                             const gridPatch_t              patchT,
+                             int                            idxOfVar,
+                             int                            dimA,
+                             int                            dimB,
+                             int                            dimChunk,
+                             gridRegularDistrib_chunkFunc_t preFunc,
+                             gridRegularDistrib_chunkFunc_t postFunc,
+                             void                           *arg,
+                             const varArr_t                 sendLayout,
+                             const varArr_t                 recvLayout)
+{
+	dataVar_t            var = gridPatch_getVarHandle(patch, idxOfVar);
+	void                 *data, *dataT;
+	gridPointUint32_t    dims, dimsT;
+	uint32_t             tmp;
+	int                  numChunks, next = 0;
+	local_overlapChunk_t *chunks;
+	const char           *tag;
+
+	// The chunks are handed out with the plain layout of the patch.
+	assert(!dataVar_isFFTWPadded(var));
+
+	gridPatch_getDims(patch, dims);
+	gridPatch_getDims(patchT, dimsT);
+	tmp         = dimsT[dimA];
+	dimsT[dimA] = dimsT[dimB];
+	dimsT[dimB] = tmp;
+
+	numChunks = distrib->numOverlapChunks;
+	if ((uint32_t)numChunks > dims[dimChunk])
+		numChunks = (int)(dims[dimChunk]);
+	chunks = xmalloc(sizeof(local_overlapChunk_t) * numChunks);
+
+	data   = gridPatch_getVarDataHandle(patch, idxOfVar);
+	tag    = xmem_setTrackTag("grid");
+	dataT  = dataVar_getMemory(var, gridPatch_getNumCells(patchT));
+	(void)xmem_setTrackTag(tag);
+
+	for (int c = 0; c < numChunks; c++) {
+		gridRegularDistrib_calcIdxsForRank1D(dims[dimChunk], numChunks, c,
+		                                     &(chunks[c].idxLo),
+		                                     &(chunks[c].idxHi), 1, 1);
+		if (preFunc != NULL)
+			preFunc(arg, idxOfVar, data, dims, dimChunk,
+			        chunks[c].idxLo, chunks[c].idxHi);
+		prof_start("pack");
+		local_overlapPostChunk(chunks + c, distrib->commCart, patch,
+		                       idxOfVar, dimChunk, sendLayout, recvLayout);
+		prof_stop("pack");
+
+		// Everything that has arrived in the meantime can be worked on
+		// while the later chunks are in flight.
+		while ((next <= c) && commScheme_test(chunks[next].scheme)) {
+			local_overlapFinishChunk(chunks + next, patchT, var, dimA, dimB,
+			                         dimChunk, sendLayout, recvLayout, dataT);
+			if (postFunc != NULL)
+				postFunc(arg, idxOfVar, dataT, dimsT, dimChunk,
+				         chunks[next].idxLo, chunks[next].idxHi);
+			next++;
+		}
+	}
+	gridPatch_freeVarData(patch, idxOfVar);
+
+	while (next < numChunks) {
+		prof_start("comm");
+		commScheme_wait(chunks[next].scheme);
+		prof_stop("comm");
+		local_overlapFinishChunk(chunks + next, patchT, var, dimA, dimB,
+		                         dimChunk, sendLayout, recvLayout, dataT);
+		if (postFunc != NULL)
+			postFunc(arg, idxOfVar, dataT, dimsT, dimChunk,
+			         chunks[next].idxLo, chunks[next].idxHi);
+		next++;
+	}
+	xfree(chunks);
+
+	return dataT;
+} /* local_transposeOverlappedVar */
+
+static void
+local_overlapPostChunk(local_overlapChunk_t    *chunk,
+                       MPI_Comm                comm,
+                       const gridPatch_t       patch,
+                       int                     idxOfVar,
+                       int                     dimChunk,
+                       const varArr_t          sendLayout,
+                       const varArr_t          recvLayout)
+{
+	dataVar_t         var     = gridPatch_getVarHandle(patch, idxOfVar);
+	MPI_Datatype      type    = dataVar_getMPIDatatype(var);
+	int               numSend = varArr_getLength(sendLayout);
+	int               numRecv = varArr_getLength(recvLayout);
+	gridPointUint32_t idxLo, lo, hi;
+
+	gridPatch_getIdxLo(patch, idxLo);
+	chunk->scheme  = commScheme_new(comm, LOCAL_OVERLAP_TAG);
+	chunk->bufSend = xmalloc(sizeof(void *) * (numSend > 0 ? numSend : 1));
+	chunk->bufRecv = xmalloc(sizeof(void *) * (numRecv > 0 ? numRecv : 1));
+
+	for (int j = 0; j < numRecv; j++) {
+		local_layoutElement_t le = varArr_getElementHandle(recvLayout, j);
+		uint64_t              numCells;
+		int                   rank;
+
+		chunk->bufRecv[j] = NULL;
+		if (!local_overlapGetWindow(le, dimChunk,
+		                            idxLo[dimChunk] + chunk->idxLo,
+		                            idxLo[dimChunk] + chunk->idxHi, lo, hi))
+			continue;
+		numCells          = local_overlapGetNumCells(lo, hi);
+		chunk->bufRecv[j] = dataVar_getMemory(var, numCells);
+		MPI_Cart_rank(comm, le->processCoord, &rank);
+		commScheme_addBuffer(chunk->scheme,
+		                     commSchemeBuffer_new(chunk->bufRecv[j],
+		                                          dataVar_getMPICount(var,
+		                                                              numCells),
+		                                          type, rank),
+		                     COMMSCHEME_TYPE_RECV);
+	}
+
+	for (int j = 0; j < numSend; j++) {
+		local_layoutElement_t le = varArr_getElementHandle(sendLayout, j);
+		uint64_t              numCells;
+		int                   rank;
+
+		chunk->bufSend[j] = NULL;
+		if (!local_overlapGetWindow(le, dimChunk,
+		                            idxLo[dimChunk] + chunk->idxLo,
+		                            idxLo[dimChunk] + chunk->idxHi, lo, hi))
+			continue;
+		numCells          = local_overlapGetNumCells(lo, hi);
+		chunk->bufSend[j] = dataVar_getMemory(var, numCells);
+		(void)gridPatch_getWindowedData(patch, idxOfVar, lo, hi,
+		                                chunk->bufSend[j]);
+		MPI_Cart_rank(comm, le->processCoord, &rank);
+		commScheme_addBuffer(chunk->scheme,
+		                     commSchemeBuffer_new(chunk->bufSend[j],
+		                                          dataVar_getMPICount(var,
+		                                                              numCells),
+		                                          type, rank),
+		                     COMMSCHEME_TYPE_SEND);
+	}
+	commScheme_fire(chunk->scheme);
+} /* local_overlapPostChunk */
+
+static void
+local_overlapFinishChunk(local_overlapChunk_t    *chunk,
+                         const gridPatch_t       patchT,
+                         const dataVar_t         var,
+                         int                     dimA,
+                         int                     dimB,
+                         int                     dimChunk,
+                         const varArr_t          sendLayout,
+                         const varArr_t          recvLayout,
+                         void                    *dataT)
+{
+	size_t            size = dataVar_getSizePerElement(var);
+	gridPointUint32_t idxLoT, dimsT, lo, hi;
+	uint32_t          tmp;
+
+	// This is a no-op if the scheme has already been tested successfully.
+	commScheme_wait(chunk->scheme);
+	commScheme_del(&(chunk->scheme));
+
+	prof_start("unpack");
+	for (int j = 0; j < varArr_getLength(sendLayout); j++) {
+		if (chunk->bufSend[j] != NULL)
+			dataVar_freeMemory(var, chunk->bufSend[j]);
+	}
+	xfree(chunk->bufSend);
+
+	gridPatch_getIdxLo(patchT, idxLoT);
+	gridPatch_getDims(patchT, dimsT);
+	tmp         = dimsT[dimA];
+	dimsT[dimA] = dimsT[dimB];
+	dimsT[dimB] = tmp;
+	for (int j = 0; j < varArr_getLength(recvLayout); j++) {
+		local_layoutElement_t le = varArr_getElementHandle(recvLayout, j);
+
+		if (chunk->bufRecv[j] == NULL)
+			continue;
+		(void)local_overlapGetWindow(le, dimChunk,
+		                             idxLoT[dimChunk] + chunk->idxLo,
+		                             idxLoT[dimChunk] + chunk->idxHi, lo, hi);
+		local_overlapUnpack(dataT, chunk->bufRecv[j], size, lo, hi,
+		                    idxLoT, dimsT, dimA, dimB);
+		dataVar_freeMemory(var, chunk->bufRecv[j]);
+	}
+	xfree(chunk->bufRecv);
+	prof_stop("unpack");
+} /* local_overlapFinishChunk */
+
+static bool
+local_overlapGetWindow(const local_layoutElement_t le,
+                       int                         dimChunk,
+                       uint32_t                    chunkLo,
+                       uint32_t                    chunkHi,
+                       gridPointUint32_t           idxLo,
+                       gridPointUint32_t           idxHi)
+{
+	for (int k = 0; k < NDIM; k++) {
+		idxLo[k] = le->idxLo[k];
+		idxHi[k] = le->idxHi[k];
+	}
+	if (idxLo[dimChunk] < chunkLo)
+		idxLo[dimChunk] = chunkLo;
+	if (idxHi[dimChunk] > chunkHi)
+		idxHi[dimChunk] = chunkHi;
+
+	return (idxLo[dimChunk] <= idxHi[dimChunk]) ? true : false;
+}
+
+static uint64_t
+local_overlapGetNumCells(const gridPointUint32_t idxLo,
+                         const gridPointUint32_t idxHi)
+{
+	uint64_t numCells = 1;
+
+	for (int k = 0; k < NDIM; k++)
+		numCells *= idxHi[k] - idxLo[k] + 1;
+
+	return numCells;
+}
+
+static void
+local_overlapUnpack(char                    *dataT,
+                    const char              *buf,
+                    size_t                  size,
+                    const gridPointUint32_t idxLo,
+                    const gridPointUint32_t idxHi,
+                    const gridPointUint32_t idxLoPatchT,
+                    const gridPointUint32_t dimsT,
+                    int                     dimA,
+                    int                     dimB)
+{
+	uint64_t          strideT[NDIM], stride[NDIM];
+	uint64_t          numRows = 1;
+	uint32_t          lenRow  = idxHi[0] - idxLo[0] + 1;
+	gridPointUint32_t c;
+
+	// The window is given in the un-transposed coordinates, the strides
+	// map them to the transposed layout.
+	strideT[0] = 1;
+	for (int k = 1; k < NDIM; k++)
+		strideT[k] = strideT[k - 1] * dimsT[k - 1];
+	for (int k = 0; k < NDIM; k++) {
+		int kT = (k == dimA) ? dimB : ((k == dimB) ? dimA : k);
+		stride[k] = strideT[kT];
+		c[k]      = idxLo[k];
+		if (k > 0)
+			numRows *= idxHi[k] - idxLo[k] + 1;
+	}
+
+	for (uint64_t r = 0; r < numRows; r++) {
+		uint64_t base = 0;
+
+		for (int k = 0; k < NDIM; k++)
+			base += (c[k] - idxLoPatchT[k]) * stride[k];
+		for (uint32_t i = 0; i < lenRow; i++) {
+			memcpy(dataT + (base + i * stride[0]) * size, buf, size);
+			buf += size;
+		}
+		for (int k = 1; k < NDIM; k++) {
+			if (++(c[k]) <= idxHi[k])
+				break;
+			c[k] = idxLo[k];
+		}
+	}
+} /* local_overlapUnpack */
+
 static local_layoutElement_t
 local_layoutElement_new(gridPointUint32_t idxLo,
                         gridPointUint32_t idxHi,
@@ -32,6 +32,57 @@
 typedef struct gridRegularDistrib_struct *gridRegularDistrib_t;
 
 
+/*--- Exported types ----------------------------------------------------*/
+
+/** @brief  Gives the available domain decompositions. */
+typedef enum {
+	/** @brief  Slabs if the grid is large enough, pencils otherwise. */
+	GRIDREGULARDISTRIB_DECOMP_AUTO,
+	/** @brief  Only the last dimension is distributed. */
+	GRIDREGULARDISTRIB_DECOMP_SLAB,
+	/** @brief  All but the first dimension are distributed. */
+	GRIDREGULARDISTRIB_DECOMP_PENCIL,
+	/** @brief  Flags an unknown decomposition. */
+	GRIDREGULARDISTRIB_DECOMP_UNKNOWN
+} gridRegularDistrib_decomp_t;
+
+
+/**
+ * @brief  The signature of functions working on a chunk of a variable
+ *         during an overlapped transposition.
+ *
+ * The chunk covers all cells of the local patch, except in the
+ * dimension @c dimChunk, where only the cells from @c idxLo to
+ * @c idxHi (inclusive, counted from the start of the patch) are
+ * covered.  All other chunks of the variable must not be touched.
+ *
+ * @param[in,out]  *arg
+ *                    The argument given to the transposition.
+ * @param[in]      idxOfVar
+ *                    The index of the variable in the patch.
+ * @param[in,out]  *data
+ *                    The data of the full patch.
+ * @param[in]      dims
+ *                    The dimensions of @c data.
+ * @param[in]      dimChunk
+ *                    The dimension along which the patch is chunked.
+ * @param[in]      idxLo
+ *                    The first index of the chunk in @c dimChunk.
+ * @param[in]      idxHi
+ *                    The last index of the chunk in @c dimChunk.
+ *
+ * @return  Returns nothing.
+ */
+typedef void
+(*gridRegularDistrib_chunkFunc_t)(void                    *arg,
+                                  int                     idxOfVar,
+                                  void                    *data,
+                                  const gridPointUint32_t dims,
+                                  int                     dimChunk,
+                                  uint32_t                idxLo,
+                                  uint32_t                idxHi);
+
+
 /*--- Prototypes of exported functions ----------------------------------*/
 
 /**
@@ -138,6 +189,57 @@ gridRegularDistrib_getNProcs(gridRegularDistrib_t distrib,
 extern gridRegular_t
 gridRegularDistrib_getGridHandle(const gridRegularDistrib_t distrib);
 
+
+/**
+ * @brief  Maps the name of a decomposition to its value.
+ *
+ * @param[in]  *name
+ *                The name of the decomposition, this is one of
+ *                @c auto, @c slab or @c pencil.  Passing @c NULL is
+ *                undefined.
+ *
+ * @return  Returns the decomposition or
+ *          #GRIDREGULARDISTRIB_DECOMP_UNKNOWN if the name is not known.
+ */
+extern gridRegularDistrib_decomp_t
+gridRegularDistrib_getDecompFromName(const char *name);
+
+
+/**
+ * @brief  Calculates the processor grid for a given decomposition.
+ *
+ * A slab decomposition only splits the last dimension, the forward and
+ * backward FFTs then need only one global transposition each, as the
+ * transposition of two undistributed dimensions is done locally.  This
+ * requires that @c numProcs does not exceed the number of cells in any
+ * but the first dimension.  A pencil decomposition keeps the first
+ * dimension local and leaves the remaining values of @c nProcs as they
+ * are, values of 0 are later filled by gridRegularDistrib_initMPI() to
+ * give domains that are as square as possible.  The automatic mode
+ * picks slabs whenever they are possible and pencils otherwise.
+ *
+ * @param[in]      decomp
+ *                    The decomposition to use, must not be
+ *                    #GRIDREGULARDISTRIB_DECOMP_UNKNOWN.
+ * @param[in]      dims
+ *                    The dimensions of the grid that will be
+ *                    distributed.
+ * @param[in]      numProcs
+ *                    The total number of processes, must be positive.
+ * @param[in,out]  nProcs
+ *                    The processor grid.  For pencils, the given values
+ *                    are kept (apart from the first dimension).
+ *
+ * @return  Returns the decomposition that was actually chosen, i.e.
+ *          either #GRIDREGULARDISTRIB_DECOMP_SLAB or
+ *          #GRIDREGULARDISTRIB_DECOMP_PENCIL.
+ */
+extern gridRegularDistrib_decomp_t
+gridRegularDistrib_calcNProcsForDecomp(gridRegularDistrib_decomp_t decomp,
+                                       const gridPointUint32_t     dims,
+                                       int                         numProcs,
+                                       gridPointInt_t              nProcs);
+
 /**
  * @brief  Calculates the min and max indices of a given processes in
  *         one dimension.
@@ -180,9 +282,164 @@ gridRegularDistrib_getFactor(gridRegularDistrib_t distrib,
                              int                  *factor_numerator,
                              int                  *factor_denominator);
 
+/**
+ * @brief  Sets the number of rounds in which MPI transpositions exchange
+ *         their data.
+ *
+ * With the default of 0 rounds, all data of a variable is copied into
+ * send buffers and received into receive buffers at once, requiring
+ * roughly twice the memory of the patch.  Using @c numRounds > 0
+ * switches to a streaming transposition that works in-place on the
+ * patch data and only exchanges a fraction of about 1/numRounds of
+ * the patch per round, giving a peak memory of about
+ * (1 + 2/numRounds) times the patch (plus one bit per cell).  This
+ * trades some local reordering work for memory.  All processes must
+ * use the same value.  Without MPI this is only recorded.
+ *
+ * @param[in,out]  distrib
+ *                    The distribution object to work with.
+ * @param[in]      numRounds
+ *                    The number of rounds, must not be negative.
+ *
+ * @return  Returns nothing.
+ */
+extern void
+gridRegularDistrib_setNumTransposeRounds(gridRegularDistrib_t distrib,
+                                         int                  numRounds);
+
+
+/**
+ * @brief  Retrieves the number of rounds used in MPI transpositions.
+ *
+ * @param[in]  distrib
+ *                The distribution object to query.
+ *
+ * @return  Returns the number of rounds, 0 indicates that the
+ *          transposition is done in one go.
+ */
+extern int
+gridRegularDistrib_getNumTransposeRounds(const gridRegularDistrib_t distrib);
+
+
+/**
+ * @brief  Sets the number of chunks used by overlapped transpositions.
+ *
+ * With a positive number, gridRegularDistrib_transposeOverlapped()
+ * splits the patch into that many chunks along the dimension that is
+ * not transposed.  The data of a chunk is sent as soon as it has been
+ * prepared and it is processed as soon as it has arrived, while the
+ * other chunks are in flight.  The default of 0 uses the blocking
+ * transposition.  All processes must use the same value.
+ *
+ * @param[in,out]  distrib
+ *                    The distribution object to work with.
+ * @param[in]      numChunks
+ *                    The number of chunks, must not be negative.
+ *
+ * @return  Returns nothing.
+ */
+extern void
+gridRegularDistrib_setNumOverlapChunks(gridRegularDistrib_t distrib,
+                                       int                  numChunks);
+
+
+/**
+ * @brief  Retrieves the number of chunks used in overlapped
+ *         transpositions.
+ *
+ * @param[in]  distrib
+ *                The distribution object to query.
+ *
+ * @return  Returns the number of chunks, 0 indicates that
+ *          transpositions are not overlapped.
+ */
+extern int
+gridRegularDistrib_getNumOverlapChunks(const gridRegularDistrib_t distrib);
+
+
+/**
+ * @brief  Sets whether MPI transpositions use persistent schedules.
+ *
+ * With persistent schedules, the layout, the message buffers and the
+ * MPI requests of a transposition are set up the first time it is done
+ * and are replayed for all later transpositions of the same kind (same
+ * dimensions, grid layout and variable type), instead of being created
+ * anew for every variable.  This saves the setup costs when the same
+ * transpositions are done many times, at the expense of keeping the
+ * message buffers (about twice the size of the largest variable, or
+ * batch of variables, see gridRegularDistrib_setBatchTransposeVars())
+ * allocated until the schedules are switched off again or
+ * the distribution is deleted.  This does not apply if the
+ * transposition is done in rounds (see
+ * gridRegularDistrib_setNumTransposeRounds()).
+ *
+ * @param[in,out]  distrib
+ *                    The distribution object to work with.
+ * @param[in]      usePersistent
+ *                    Whether to use persistent schedules.  Switching
+ *                    them off frees all schedules.
+ *
+ * @return  Returns nothing.
+ */
+extern void
+gridRegularDistrib_setUsePersistentSchedules(gridRegularDistrib_t distrib,
+                                             bool                 usePersistent);
+
+
+/**
+ * @brief  Checks whether MPI transpositions use persistent schedules.
+ *
+ * @param[in]  distrib
+ *                The distribution object to query.
+ *
+ * @return  Returns @c true if persistent schedules are used, @c false
+ *          otherwise.
+ */
+extern bool
+gridRegularDistrib_getUsePersistentSchedules(
+    const gridRegularDistrib_t distrib);
+
+
+/**
+ * @brief  Sets whether MPI transpositions batch variables.
+ *
+ * By default every variable is transposed on its own.  With batching,
+ * consecutive variables of the same type are sent together in one
+ * message per process, which pays the latency only once for all of them
+ * but needs message buffers for all variables of a batch at the same
+ * time.  This does not apply if the transposition is done in rounds
+ * (see gridRegularDistrib_setNumTransposeRounds()).
+ *
+ * @param[in,out]  distrib
+ *                    The distribution object to work with.
+ * @param[in]      batchVars
+ *                    Whether to batch the variables.
+ *
+ * @return  Returns nothing.
+ */
+extern void
+gridRegularDistrib_setBatchTransposeVars(gridRegularDistrib_t distrib,
+                                         bool                 batchVars);
+
+
+/**
+ * @brief  Checks whether MPI transpositions batch variables.
+ *
+ * @param[in]  distrib
+ *                The distribution object to query.
+ *
+ * @return  Returns @c true if variables are batched, @c false otherwise.
+ */
+extern bool
+gridRegularDistrib_getBatchTransposeVars(const gridRegularDistrib_t distrib);
+
+
 /**
  * @brief  Performs a transposition of the distributed grid.
  *
+ * If neither of the two dimensions is distributed, the data is only
+ * reordered locally without any communication.
+ *
  * @param[in]  distrib
  *                The distribution object to work with.  
  * @param[in]  dimA
@@ -198,6 +455,75 @@ gridRegularDistrib_transpose(gridRegularDistrib_t distrib,
                              int                  dimB);
 
 
+/**
+ * @brief  Performs a transposition of the distributed grid, overlapping
+ *         the communication with work on the data.
+ *
+ * This is equivalent to calling @c preFunc on the full patch, doing
+ * gridRegularDistrib_transpose() and then calling @c postFunc on the
+ * full transposed patch.  If a number of overlap chunks is set (see
+ * gridRegularDistrib_setNumOverlapChunks()) and data needs to be
+ * exchanged, the patch is instead split into chunks along the
+ * dimension that is not transposed (which is distributed in the same
+ * way before and after the transposition).  @c preFunc is called for
+ * one chunk after the other, each chunk being sent right away, and
+ * @c postFunc is called for every chunk of the transposed patch as
+ * soon as it has been received.  The chunks of a variable are passed
+ * to @c preFunc in increasing order.  This needs about twice the
+ * memory of the patch, independent of the number of transpose rounds.
+ *
+ * @param[in,out]  distrib
+ *                    The distribution object to work with.
+ * @param[in]      dimA
+ *                    The dimension to exchange.
+ * @param[in]      dimB
+ *                    The dimension to exchange with.
+ * @param[in]      preFunc
+ *                    The function to call before a chunk is sent, may
+ *                    be @c NULL.
+ * @param[in]      postFunc
+ *                    The function to call after a chunk has been
+ *                    received, it gets the data in the transposed
+ *                    layout.  May be @c NULL.
+ * @param[in,out]  *arg
+ *                    Passed on to @c preFunc and @c postFunc.
+ *
+ * @return  Returns nothing.
+ */
+extern void
+gridRegularDistrib_transposeOverlapped(
+    gridRegularDistrib_t           distrib,
+    int                            dimA,
+    int                            dimB,
+    gridRegularDistrib_chunkFunc_t preFunc,
+    gridRegularDistrib_chunkFunc_t postFunc,
+    void                           *arg);
+
+
+/**
+ * @brief  Transposes the layout of the distributed grid without
+ *         redistributing the data.
+ *
+ * This yields the same grid and patch layout as
+ * gridRegularDistrib_transpose(), but the data of all variables on the
+ * patch is discarded instead of being communicated.  This is useful if
+ * the data will be overwritten completely afterwards.
+ *
+ * @param[in]  distrib
+ *                The distribution object to work with.
+ * @param[in]  dimA
+ *                The dimension to exchange.
+ * @param[in]  dimB
+ *                The dimension to exchange with.
+ *
+ * @return  Returns nothing.
+ */
+extern void
+gridRegularDistrib_transposeLayout(gridRegularDistrib_t distrib,
+                                   int                  dimA,
+                                   int                  dimB);
+
+
 /*--- Doxygen group definitions -----------------------------------------*/
 
 /**
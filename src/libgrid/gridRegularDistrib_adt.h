@@ -9,6 +9,10 @@
 /*--- Includes ----------------------------------------------------------*/
 #include "gridConfig.h"
 #include "../libutil/refCounter.h"
+#include <stdbool.h>
+#ifdef WITH_MPI
+#  include "../libutil/varArr.h"
+#endif
 
 
 /*--- ADT implementation ------------------------------------------------*/
@@ -19,9 +23,19 @@ struct gridRegularDistrib_struct {
 	int            numProcs;
 	int			   factor_numerator;
 	int            factor_denominator;
+	int            numTransposeRounds;
+	int            numOverlapChunks;
+	bool           usePersistentSchedules;
+	bool           batchTransposeVars;
 #ifdef WITH_MPI
 	MPI_Comm       commGlobal;
 	MPI_Comm       commCart;
+	varArr_t       schedules;
+	char           *scheduleBufSend;
+	uint64_t       scheduleBufSendSize;
+	char           *scheduleBufRecv;
+	uint64_t       scheduleBufRecvSize;
+	uint64_t       *transposeRoundBytes;
 #endif
 };
 
@@ -16,9 +16,7 @@
 #  include "gridWriterSilo.h"
 #  include <silo.h>
 #endif
-#ifdef XMEM_TRACK_MEM
-#  include "../libutil/xmem.h"
-#endif
+#include "../libutil/xmem.h"
 
 
 /*--- Implemention of main structure ------------------------------------*/
@@ -43,6 +41,9 @@ local_getFakeNProcs(gridPointInt_t nProcs);
 static gridRegularDistrib_t
 local_getFakeDistribForTranspose(void);
 
+static gridRegularDistrib_t
+local_getFakeDistribForTransposeNProcs(const gridPointInt_t nProcsWanted);
+
 static void
 local_fillFakeGridForTranspose(gridRegular_t grid);
 
@@ -305,33 +306,33 @@ gridRegularDistrib_calcIdxsForRank1D_test(void)
 		uint32_t idxLo;
 		uint32_t idxHi;
 		printf("Testing %s... ", __func__);
-		gridRegularDistrib_calcIdxsForRank1D(11, 2, 0, &idxLo, &idxHi);
+		gridRegularDistrib_calcIdxsForRank1D(11, 2, 0, &idxLo, &idxHi, 1, 1);
 		if ((idxLo != 0) || (idxHi != 5))
 			hasPassed = false;
-		gridRegularDistrib_calcIdxsForRank1D(11, 2, 1, &idxLo, &idxHi);
+		gridRegularDistrib_calcIdxsForRank1D(11, 2, 1, &idxLo, &idxHi, 1, 1);
 		if ((idxLo != 6) || (idxHi != 10))
 			hasPassed = false;
 
-		gridRegularDistrib_calcIdxsForRank1D(11, 3, 0, &idxLo, &idxHi);
+		gridRegularDistrib_calcIdxsForRank1D(11, 3, 0, &idxLo, &idxHi, 1, 1);
 		if ((idxLo != 0) || (idxHi != 3))
 			hasPassed = false;
-		gridRegularDistrib_calcIdxsForRank1D(11, 3, 1, &idxLo, &idxHi);
+		gridRegularDistrib_calcIdxsForRank1D(11, 3, 1, &idxLo, &idxHi, 1, 1);
 		if ((idxLo != 4) || (idxHi != 7))
 			hasPassed = false;
-		gridRegularDistrib_calcIdxsForRank1D(11, 3, 2, &idxLo, &idxHi);
+		gridRegularDistrib_calcIdxsForRank1D(11, 3, 2, &idxLo, &idxHi, 1, 1);
 		if ((idxLo != 8) || (idxHi != 10))
 			hasPassed = false;
 
-		gridRegularDistrib_calcIdxsForRank1D(11, 4, 0, &idxLo, &idxHi);
+		gridRegularDistrib_calcIdxsForRank1D(11, 4, 0, &idxLo, &idxHi, 1, 1);
 		if ((idxLo != 0) || (idxHi != 2))
 			hasPassed = false;
-		gridRegularDistrib_calcIdxsForRank1D(11, 4, 1, &idxLo, &idxHi);
+		gridRegularDistrib_calcIdxsForRank1D(11, 4, 1, &idxLo, &idxHi, 1, 1);
 		if ((idxLo != 3) || (idxHi != 5))
 			hasPassed = false;
-		gridRegularDistrib_calcIdxsForRank1D(11, 4, 2, &idxLo, &idxHi);
+		gridRegularDistrib_calcIdxsForRank1D(11, 4, 2, &idxLo, &idxHi, 1, 1);
 		if ((idxLo != 6) || (idxHi != 8))
 			hasPassed = false;
-		gridRegularDistrib_calcIdxsForRank1D(11, 4, 3, &idxLo, &idxHi);
+		gridRegularDistrib_calcIdxsForRank1D(11, 4, 3, &idxLo, &idxHi, 1, 1);
 		if ((idxLo != 9) || (idxHi != 10))
 			hasPassed = false;
 	}
@@ -344,6 +345,66 @@ gridRegularDistrib_calcIdxsForRank1D_test(void)
 	return hasPassed ? true : false;
 } /* gridRegularDistrib_calcIdxsForRank1D_test */
 
+extern bool
+gridRegularDistrib_calcNProcsForDecomp_test(void)
+{
+	bool                        hasPassed = true;
+	int                         rank      = 0;
+	gridPointUint32_t           dims;
+	gridPointInt_t              nProcs;
+	gridRegularDistrib_decomp_t decomp;
+#ifdef XMEM_TRACK_MEM
+	size_t                      allocatedBytes = global_allocated_bytes;
+#endif
+#ifdef WITH_MPI
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+#endif
+
+	if (rank == 0)
+		printf("Testing %s... ", __func__);
+
+	if (gridRegularDistrib_getDecompFromName("slab")
+	    != GRIDREGULARDISTRIB_DECOMP_SLAB)
+		hasPassed = false;
+	if (gridRegularDistrib_getDecompFromName("bla")
+	    != GRIDREGULARDISTRIB_DECOMP_UNKNOWN)
+		hasPassed = false;
+
+	for (int i = 0; i < NDIM; i++) {
+		dims[i]   = 16;
+		nProcs[i] = 0;
+	}
+
+	decomp = gridRegularDistrib_calcNProcsForDecomp(
+	    GRIDREGULARDISTRIB_DECOMP_AUTO, dims, 16, nProcs);
+	if (decomp != GRIDREGULARDISTRIB_DECOMP_SLAB)
+		hasPassed = false;
+	if ((nProcs[0] != 1) || (nProcs[NDIM - 1] != 16))
+		hasPassed = false;
+
+	for (int i = 0; i < NDIM; i++)
+		nProcs[i] = 0;
+	decomp = gridRegularDistrib_calcNProcsForDecomp(
+	    GRIDREGULARDISTRIB_DECOMP_AUTO, dims, 32, nProcs);
+	if (decomp != GRIDREGULARDISTRIB_DECOMP_PENCIL)
+		hasPassed = false;
+	if ((nProcs[0] != 1) || (nProcs[1] != 0))
+		hasPassed = false;
+
+	nProcs[1] = 4;
+	decomp    = gridRegularDistrib_calcNProcsForDecomp(
+	    GRIDREGULARDISTRIB_DECOMP_PENCIL, dims, 8, nProcs);
+	if ((decomp != GRIDREGULARDISTRIB_DECOMP_PENCIL) || (nProcs[1] != 4))
+		hasPassed = false;
+
+#ifdef XMEM_TRACK_MEM
+	if (allocatedBytes != global_allocated_bytes)
+		hasPassed = false;
+#endif
+
+	return hasPassed ? true : false;
+}
+
 extern bool
 gridRegularDistrib_transpose_test(void)
 {
@@ -461,6 +522,165 @@ gridRegularDistrib_transpose_test(void)
 	return hasPassed ? true : false;
 } /* gridRegularDistrib_transpose_test */
 
+extern bool
+gridRegularDistrib_transposeStreamed_test(void)
+{
+	bool                 hasPassed = true;
+	int                  rank      = 0;
+	gridRegularDistrib_t distrib;
+#ifdef XMEM_TRACK_MEM
+	size_t allocatedBytes = global_allocated_bytes;
+#endif
+#ifdef WITH_MPI
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+#endif
+
+	if (rank == 0) {
+		printf("Testing %s... ", __func__);
+	}
+
+	distrib = local_getFakeDistribForTranspose();
+	if (gridRegularDistrib_getNumTransposeRounds(distrib) != 0)
+		hasPassed = false;
+	gridRegularDistrib_setNumTransposeRounds(distrib, 3);
+	if (gridRegularDistrib_getNumTransposeRounds(distrib) != 3)
+		hasPassed = false;
+
+	gridRegularDistrib_transpose(distrib, 0, 1);
+	if (!local_verifyFakeDistribForTranspose(distrib))
+		hasPassed = false;
+	gridRegularDistrib_transpose(distrib, 0, 1);
+	gridRegularDistrib_transpose(distrib, 0, 2);
+	gridRegularDistrib_transpose(distrib, 0, 2);
+
+	gridRegularDistrib_del(&distrib);
+
+#ifdef XMEM_TRACK_MEM
+	if (allocatedBytes != global_allocated_bytes)
+		hasPassed = false;
+#endif
+
+	return hasPassed ? true : false;
+} /* gridRegularDistrib_transposeStreamed_test */
+
+#ifdef WITH_MPI
+extern bool
+gridRegularDistrib_transposeStreamedRounds_test(void)
+{
+	bool                 hasPassed = true;
+	int                  rank      = 0;
+	int                  size;
+	int                  numRounds = 4;
+	gridRegularDistrib_t distrib;
+	gridPointInt_t       nProcs;
+	uint64_t             numBytes  = 0;
+#  ifdef XMEM_TRACK_MEM
+	size_t allocatedBytes = global_allocated_bytes;
+#  endif
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+	MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+	if (rank == 0) {
+		printf("Testing %s... ", __func__);
+	}
+
+	// Only two processes take part in every exchange, the others are
+	// stacked along the last dimension.
+	if (size % 2 != 0)
+		return hasPassed;
+	for (int i = 0; i < NDIM; i++)
+		nProcs[i] = 1;
+	nProcs[0]        = 2;
+	nProcs[NDIM - 1] = size / 2;
+
+	distrib = local_getFakeDistribForTransposeNProcs(nProcs);
+	gridRegularDistrib_setNumTransposeRounds(distrib, numRounds);
+	numBytes = gridPatch_getNumCells(gridRegular_getPatchHandle(
+	                                     distrib->grid, 0)) * sizeof(int);
+
+	gridRegularDistrib_transpose(distrib, 0, 1);
+	if (!local_verifyFakeDistribForTranspose(distrib))
+		hasPassed = false;
+
+	// With two partners and two pieces per window, every round holds
+	// about a quarter of the patch.
+	for (int r = 0; r < numRounds; r++) {
+		uint64_t roundBytes = distrib->transposeRoundBytes[r];
+		if ((roundBytes < numBytes / (2 * numRounds))
+		    || (roundBytes > 2 * numBytes / numRounds))
+			hasPassed = false;
+	}
+
+	gridRegularDistrib_del(&distrib);
+
+#  ifdef XMEM_TRACK_MEM
+	if (allocatedBytes != global_allocated_bytes)
+		hasPassed = false;
+#  endif
+
+	return hasPassed ? true : false;
+} /* gridRegularDistrib_transposeStreamedRounds_test */
+
+extern bool
+gridRegularDistrib_transposePersistent_test(void)
+{
+	bool                 hasPassed = true;
+	int                  rank      = 0;
+	gridRegularDistrib_t distrib;
+	gridPatch_t          patch;
+	uint64_t             numCells;
+	int                  *dataRef;
+	int                  numSchedules;
+#  ifdef XMEM_TRACK_MEM
+	size_t allocatedBytes = global_allocated_bytes;
+#  endif
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+	if (rank == 0) {
+		printf("Testing %s... ", __func__);
+	}
+
+	distrib = local_getFakeDistribForTranspose();
+	gridRegularDistrib_setUsePersistentSchedules(distrib, true);
+
+	// The first pass sets up the schedules for both directions.
+	gridRegularDistrib_transpose(distrib, 0, 1);
+	if (!local_verifyFakeDistribForTranspose(distrib))
+		hasPassed = false;
+	patch    = gridRegular_getPatchHandle(distrib->grid, 0);
+	numCells = gridPatch_getNumCells(patch);
+	dataRef  = xmalloc(sizeof(int) * numCells);
+	memcpy(dataRef, gridPatch_getVarDataHandle(patch, 0),
+	       sizeof(int) * numCells);
+	gridRegularDistrib_transpose(distrib, 0, 1);
+	numSchedules = varArr_getLength(distrib->schedules);
+
+	// The later passes replay the schedules and must give the same.
+	for (int i = 0; i < 2; i++) {
+		gridRegularDistrib_transpose(distrib, 0, 1);
+		patch = gridRegular_getPatchHandle(distrib->grid, 0);
+		if ((gridPatch_getNumCells(patch) != numCells)
+		    || (memcmp(gridPatch_getVarDataHandle(patch, 0), dataRef,
+		               sizeof(int) * numCells) != 0))
+			hasPassed = false;
+		gridRegularDistrib_transpose(distrib, 0, 1);
+	}
+	if (varArr_getLength(distrib->schedules) != numSchedules)
+		hasPassed = false;
+
+	xfree(dataRef);
+	gridRegularDistrib_del(&distrib);
+
+#  ifdef XMEM_TRACK_MEM
+	if (allocatedBytes != global_allocated_bytes)
+		hasPassed = false;
+#  endif
+
+	return hasPassed ? true : false;
+} /* gridRegularDistrib_transposePersistent_test */
+
+#endif
+
 /*--- Implementations of local functions --------------------------------*/
 static gridRegular_t
 local_getFakeGrid(void)
@@ -495,6 +715,17 @@ local_getFakeNProcs(gridPointInt_t nProcs)
 
 static gridRegularDistrib_t
 local_getFakeDistribForTranspose(void)
+{
+	gridPointInt_t nProcs;
+
+	for (int i = 0; i < NDIM; i++)
+		nProcs[i] = 0;
+
+	return local_getFakeDistribForTransposeNProcs(nProcs);
+}
+
+static gridRegularDistrib_t
+local_getFakeDistribForTransposeNProcs(const gridPointInt_t nProcsWanted)
 {
 	gridRegularDistrib_t distrib;
 	gridRegular_t        grid;
@@ -509,16 +740,16 @@ local_getFakeDistribForTranspose(void)
 	origin[0] = 0.0;
 	extent[0] = 4.0;
 	dims[0]   = 400;
-	nProcs[0] = 0;
+	nProcs[0] = nProcsWanted[0];
 	origin[1] = 0.0;
 	extent[1] = 5.0;
 	dims[1]   = 50;
-	nProcs[1] = 0;
+	nProcs[1] = nProcsWanted[1];
 #if (NDIM > 2)
 	origin[2] = 0.0;
 	extent[2] = 2.0;
 	dims[2]   = 30;
-	nProcs[2] = 0;
+	nProcs[2] = nProcsWanted[2];
 #endif
 	grid      = gridRegular_new("bla", origin, extent, dims);
 	var       = dataVar_new("blaVar", DATAVARTYPE_INT, 1);
@@ -536,7 +767,7 @@ local_getFakeDistribForTranspose(void)
 	gridRegular_del(&grid);
 
 	return distrib;
-} /* local_getFakeDistribForTranspose */
+} /* local_getFakeDistribForTransposeNProcs */
 
 static void
 local_fillFakeGridForTranspose(gridRegular_t grid)
@@ -35,7 +35,22 @@ gridRegularDistrib_getPatchForRank_test(void);
 extern bool
 gridRegularDistrib_calcIdxsForRank1D_test(void);
 
+extern bool
+gridRegularDistrib_calcNProcsForDecomp_test(void);
+
 extern bool
 gridRegularDistrib_transpose_test(void);
 
+extern bool
+gridRegularDistrib_transposeStreamed_test(void);
+
+#ifdef WITH_MPI
+extern bool
+gridRegularDistrib_transposeStreamedRounds_test(void);
+
+extern bool
+gridRegularDistrib_transposePersistent_test(void);
+
+#endif
+
 #endif
@@ -10,6 +10,7 @@
 #include <assert.h>
 #include "../libutil/xmem.h"
 #include "../libutil/diediedie.h"
+#include "../libutil/prof.h"
 #ifdef WITH_FFT_FFTW3
 #  include <complex.h>
 #  include <fftw3.h>
@@ -29,10 +30,42 @@
 #endif
 
 
+/*--- Local structures --------------------------------------------------*/
+#if (defined WITH_MPI)
+typedef struct local_overlapPlan_struct local_overlapPlan_t;
+
+struct local_overlapPlan_struct {
+	void *plan;
+	int  howmany;
+};
+
+typedef struct local_overlap_struct local_overlap_t;
+
+struct local_overlap_struct {
+	gridRegularFFT_t    fft;
+	int                 direction;
+	int                 phasePre;
+	int                 phasePost;
+	local_overlapPlan_t planPre;
+	local_overlapPlan_t planPost;
+};
+#endif
+
+
 /*--- Prototypes of local functions -------------------------------------*/
 static void
 local_getFFTedThings(gridRegularFFT_t fft);
 
+static void
+local_getVarData(gridRegularFFT_t fft,
+                 int              idx,
+                 int              direction,
+                 void             **dataIn,
+                 void             **dataOut);
+
+static void
+local_releaseVarData(gridRegularFFT_t fft, int idx, int direction);
+
 
 #if (defined WITH_MPI)
 static void
@@ -67,6 +100,44 @@ local_doFFTParallelC2RPencil(gridRegularFFT_t fft);
 static void *
 local_doFFTParallelBackward(gridRegularFFT_t fft);
 
+static void *
+local_doFFTParallelForwardOverlapped(gridRegularFFT_t fft);
+
+static void *
+local_doFFTParallelBackwardOverlapped(gridRegularFFT_t fft);
+
+static void
+local_overlapPre(void                    *arg,
+                 int                     idxOfVar,
+                 void                    *data,
+                 const gridPointUint32_t dims,
+                 int                     dimChunk,
+                 uint32_t                idxLo,
+                 uint32_t                idxHi);
+
+static void
+local_overlapPost(void                    *arg,
+                  int                     idxOfVar,
+                  void                    *data,
+                  const gridPointUint32_t dims,
+                  int                     dimChunk,
+                  uint32_t                idxLo,
+                  uint32_t                idxHi);
+
+static void
+local_overlapDoChunk(local_overlap_t         *overlap,
+                     local_overlapPlan_t     *plan,
+                     int                     phase,
+                     int                     idxOfVar,
+                     void                    *data,
+                     const gridPointUint32_t dims,
+                     int                     dimChunk,
+                     uint32_t                idxLo,
+                     uint32_t                idxHi);
+
+static void
+local_overlapResetPlans(local_overlap_t *overlap);
+
 #endif
 
 /*--- Implementations of exported functios ------------------------------*/
@@ -74,21 +145,47 @@ extern gridRegularFFT_t
 gridRegularFFT_new(gridRegular_t        grid,
                    gridRegularDistrib_t distrib,
                    int                  idxFFTVar)
+{
+	return gridRegularFFT_newMany(grid, distrib, 1, &idxFFTVar);
+}
+
+extern gridRegularFFT_t
+gridRegularFFT_newMany(gridRegular_t        grid,
+                       gridRegularDistrib_t distrib,
+                       int                  numFFTVars,
+                       const int            *idxFFTVars)
 {
 	gridRegularFFT_t fft;
 
 	assert(grid != NULL);
 	assert(distrib != NULL);
-	assert(idxFFTVar >= 0 && idxFFTVar < gridRegular_getNumVars(grid));
+	assert(numFFTVars > 0 && idxFFTVars != NULL);
 	assert(gridRegular_getNumPatches(grid) == 1);
 
-	fft            = xmalloc(sizeof(struct gridRegularFFT_struct));
-	fft->grid      = gridRegular_getRef(grid);
-	fft->distrib   = gridRegularDistrib_getRef(distrib);
-	fft->idxFFTVar = idxFFTVar;
-	fft->var       = gridRegular_getVarHandle(grid, idxFFTVar);
+	fft             = xmalloc(sizeof(struct gridRegularFFT_struct));
+	fft->grid       = gridRegular_getRef(grid);
+	fft->distrib    = gridRegularDistrib_getRef(distrib);
+	fft->numFFTVars = numFFTVars;
+	fft->idxFFTVar  = xmalloc(sizeof(int) * numFFTVars);
+	for (int i = 0; i < numFFTVars; i++) {
+		assert(idxFFTVars[i] >= 0
+		       && idxFFTVars[i] < gridRegular_getNumVars(grid));
+		fft->idxFFTVar[i] = idxFFTVars[i];
+	}
+	fft->var       = gridRegular_getVarHandle(grid, idxFFTVars[0]);
 	assert(dataVarType_isFloating(dataVar_getType(fft->var)));
 	fft->patch     = gridRegular_getPatchHandle(grid, 0);
+	fft->doInPlace = dataVar_isFFTWPadded(fft->var);
+#ifndef NDEBUG
+	// All variables share the plans, hence they must be of the same kind.
+	for (int i = 1; i < numFFTVars; i++) {
+		dataVar_t var = gridRegular_getVarHandle(grid, idxFFTVars[i]);
+		assert(dataVar_getType(var) == dataVar_getType(fft->var));
+		assert(dataVar_getNumComponents(var)
+		       == dataVar_getNumComponents(fft->var));
+		assert(dataVar_isFFTWPadded(var) == fft->doInPlace);
+	}
+#endif
 	gridRegularDistrib_getNProcs(fft->distrib, fft->nProcs);
 	assert(fft->nProcs[0] == 1);
 #if (defined WITH_MPI)
@@ -111,6 +208,8 @@ gridRegularFFT_del(gridRegularFFT_t *fft)
 	gridRegular_del(&((*fft)->gridFFTed));
 	gridRegularDistrib_del(&((*fft)->distrib));
 	gridRegularDistrib_del(&((*fft)->distribFFTed));
+	xfree((*fft)->idxFFTVar);
+	xfree((*fft)->idxFFTVarFFTed);
 	xfree(*fft);
 
 	*fft = NULL;
@@ -141,14 +240,39 @@ gridRegularFFT_execute(gridRegularFFT_t fft, int direction)
 	assert(direction == GRIDREGULARFFT_FORWARD
 	       || direction == GRIDREGULARFFT_BACKWARD);
 
+	prof_start(direction == GRIDREGULARFFT_FORWARD ? "fftForward"
+	           : "fftBackward");
 #if (!defined WITH_MPI)
 	result = local_doFFTCompletelyLocal(fft, direction);
 #else
 	result = local_doFFTParallel(fft, direction);
 #endif
+	prof_stop(direction == GRIDREGULARFFT_FORWARD ? "fftForward"
+	          : "fftBackward");
 	return result;
 }
 
+extern void
+gridRegularFFT_initFFTed(gridRegularFFT_t fft)
+{
+	assert(fft != NULL);
+
+#if (defined WITH_MPI)
+	// The grid is only in real space layout if the last transform was a
+	// backward transform (or if there was none yet).
+	if (gridRegular_getCurrentDim(fft->gridFFTed, 0) == 0) {
+		gridRegularDistrib_transposeLayout(fft->distribFFTed, 0, 1);
+#  if (NDIM > 2)
+		gridRegularDistrib_transposeLayout(fft->distribFFTed, 0, 2);
+#  endif
+		fft->patchFFTed = gridRegular_getPatchHandle(fft->gridFFTed, 0);
+		return;
+	}
+#endif
+	for (int i = 0; i < fft->numFFTVars; i++)
+		gridPatch_freeVarData(fft->patchFFTed, fft->idxFFTVarFFTed[i]);
+}
+
 /*--- Implementations of local functions --------------------------------*/
 static void
 local_getFFTedThings(gridRegularFFT_t fft)
@@ -171,6 +295,19 @@ local_getFFTedThings(gridRegularFFT_t fft)
 	int fn, fd;
 	gridRegularDistrib_getFactor(fft->distrib, &fn, &fd);
 	gridRegularDistrib_setFactorFromDim(fft->distribFFTed, fd, fn);
+	gridRegularDistrib_setNumTransposeRounds(
+	    fft->distribFFTed,
+	    gridRegularDistrib_getNumTransposeRounds(fft->distrib));
+	gridRegularDistrib_setNumOverlapChunks(
+	    fft->distribFFTed,
+	    gridRegularDistrib_getNumOverlapChunks(fft->distrib));
+	gridRegularDistrib_setUsePersistentSchedules(
+	    fft->distribFFTed,
+	    gridRegularDistrib_getUsePersistentSchedules(fft->distrib));
+	// The Fourier grid only holds the variables of this FFT, if there are
+	// several they are transposed together.
+	gridRegularDistrib_setBatchTransposeVars(fft->distribFFTed,
+	                                         fft->numFFTVars > 1);
 #if (defined WITH_MPI)
 	gridRegularDistrib_initMPI(fft->distribFFTed, fft->nProcs,
 	                           MPI_COMM_WORLD);
@@ -178,11 +315,72 @@ local_getFFTedThings(gridRegularFFT_t fft)
 #endif
 	fft->patchFFTed = gridRegularDistrib_getPatchForRank(fft->distribFFTed,
 	                                                     rank);
-	fft->varFFTed   = dataVar_clone(fft->var);
-	dataVar_setComplexified(fft->varFFTed);
 	gridRegular_attachPatch(fft->gridFFTed, fft->patchFFTed);
-	fft->idxFFTVarFFTed = gridRegular_attachVar(fft->gridFFTed,
-	                                            fft->varFFTed);
+
+	fft->idxFFTVarFFTed = xmalloc(sizeof(int) * fft->numFFTVars);
+	for (int i = 0; i < fft->numFFTVars; i++) {
+		dataVar_t var = gridRegular_getVarHandle(fft->grid,
+		                                         fft->idxFFTVar[i]);
+		dataVar_t varFFTed = dataVar_clone(var);
+
+		dataVar_setComplexified(varFFTed);
+		dataVar_unsetFFTWPadded(varFFTed);
+		fft->idxFFTVarFFTed[i] = gridRegular_attachVar(fft->gridFFTed,
+		                                               varFFTed);
+	}
+}
+
+static void
+local_getVarData(gridRegularFFT_t fft,
+                 int              idx,
+                 int              direction,
+                 void             **dataIn,
+                 void             **dataOut)
+{
+	gridPatch_t patchIn, patchOut;
+	int         idxIn, idxOut;
+
+	if (direction == GRIDREGULARFFT_FORWARD) {
+		patchIn  = fft->patch;
+		idxIn    = fft->idxFFTVar[idx];
+		patchOut = fft->patchFFTed;
+		idxOut   = fft->idxFFTVarFFTed[idx];
+	} else {
+		patchIn  = fft->patchFFTed;
+		idxIn    = fft->idxFFTVarFFTed[idx];
+		patchOut = fft->patch;
+		idxOut   = fft->idxFFTVar[idx];
+	}
+
+	*dataIn  = gridPatch_getVarDataHandle(patchIn, idxIn);
+	*dataOut = fft->doInPlace ? *dataIn
+	           : gridPatch_getVarDataHandle(patchOut, idxOut);
+}
+
+static void
+local_releaseVarData(gridRegularFFT_t fft, int idx, int direction)
+{
+	void *data;
+
+	// In-place the memory moves to the other grid, otherwise the input
+	// is not needed anymore.
+	if (direction == GRIDREGULARFFT_FORWARD) {
+		if (fft->doInPlace) {
+			data = gridPatch_popVarData(fft->patch, fft->idxFFTVar[idx]);
+			gridPatch_replaceVarData(fft->patchFFTed,
+			                         fft->idxFFTVarFFTed[idx], data);
+		} else {
+			gridPatch_freeVarData(fft->patch, fft->idxFFTVar[idx]);
+		}
+	} else {
+		if (fft->doInPlace) {
+			data = gridPatch_popVarData(fft->patchFFTed,
+			                            fft->idxFFTVarFFTed[idx]);
+			gridPatch_replaceVarData(fft->patch, fft->idxFFTVar[idx], data);
+		} else {
+			gridPatch_freeVarData(fft->patchFFTed, fft->idxFFTVarFFTed[idx]);
+		}
+	}
 }
 
 #if (defined WITH_MPI)
@@ -245,16 +443,7 @@ local_doFFTCompletelyLocal(gridRegularFFT_t fft, int direction)
 	int               n[NDIM];
 	void              *dataIn;
 	void              *dataOut;
-
-	if (direction == GRIDREGULARFFT_FORWARD) {
-		dataIn  = gridPatch_getVarDataHandle(fft->patch, fft->idxFFTVar);
-		dataOut = gridPatch_getVarDataHandle(fft->patchFFTed,
-		                                     fft->idxFFTVarFFTed);
-	} else {
-		dataIn  = gridPatch_getVarDataHandle(fft->patchFFTed,
-		                                     fft->idxFFTVarFFTed);
-		dataOut = gridPatch_getVarDataHandle(fft->patch, fft->idxFFTVar);
-	}
+	void              *result = NULL;
 
 	// We always need the non-complex dimensions
 	gridPatch_getDims(fft->patch, dims);
@@ -263,40 +452,58 @@ local_doFFTCompletelyLocal(gridRegularFFT_t fft, int direction)
 	for (int i = 0; i < NDIM; i++)
 		n[i] = dims[NDIM - 1 - i];
 
+	// One plan serves all variables, they only differ in the arrays.
 	if (dataVarType_isNativeFloat(dataVar_getType(fft->var))) {
-		fftwf_plan plan;
-		if (direction == GRIDREGULARFFT_FORWARD) {
-			plan = fftwf_plan_dft_r2c(NDIM, n, (float *)(dataIn),
-			                          (fftwf_complex *)(dataOut),
-			                          FFTW_ESTIMATE);
-		} else {
-			plan = fftwf_plan_dft_c2r(NDIM, n, (fftwf_complex *)(dataIn),
-			                          (float *)(dataOut),
-			                          FFTW_ESTIMATE);
+		fftwf_plan plan = NULL;
+		for (int i = 0; i < fft->numFFTVars; i++) {
+			local_getVarData(fft, i, direction, &dataIn, &dataOut);
+			if (direction == GRIDREGULARFFT_FORWARD) {
+				if (plan == NULL)
+					plan = fftwf_plan_dft_r2c(NDIM, n, (float *)(dataIn),
+					                          (fftwf_complex *)(dataOut),
+					                          FFTW_ESTIMATE);
+				fftwf_execute_dft_r2c(plan, (float *)(dataIn),
+				                      (fftwf_complex *)(dataOut));
+			} else {
+				if (plan == NULL)
+					plan = fftwf_plan_dft_c2r(NDIM, n,
+					                          (fftwf_complex *)(dataIn),
+					                          (float *)(dataOut),
+					                          FFTW_ESTIMATE);
+				fftwf_execute_dft_c2r(plan, (fftwf_complex *)(dataIn),
+				                      (float *)(dataOut));
+			}
+			local_releaseVarData(fft, i, direction);
+			result = (i == 0) ? dataOut : result;
 		}
-		fftwf_execute(plan);
 		fftwf_destroy_plan(plan);
 	} else {
-		fftw_plan plan;
-		if (direction == GRIDREGULARFFT_FORWARD) {
-			plan = fftw_plan_dft_r2c(NDIM, n, (double *)(dataIn),
-			                         (fftw_complex *)(dataOut),
-			                         FFTW_ESTIMATE);
-		} else {
-			plan = fftw_plan_dft_c2r(NDIM, n, (fftw_complex *)(dataIn),
-			                         (double *)(dataOut),
-			                         FFTW_ESTIMATE);
+		fftw_plan plan = NULL;
+		for (int i = 0; i < fft->numFFTVars; i++) {
+			local_getVarData(fft, i, direction, &dataIn, &dataOut);
+			if (direction == GRIDREGULARFFT_FORWARD) {
+				if (plan == NULL)
+					plan = fftw_plan_dft_r2c(NDIM, n, (double *)(dataIn),
+					                         (fftw_complex *)(dataOut),
+					                         FFTW_ESTIMATE);
+				fftw_execute_dft_r2c(plan, (double *)(dataIn),
+				                     (fftw_complex *)(dataOut));
+			} else {
+				if (plan == NULL)
+					plan = fftw_plan_dft_c2r(NDIM, n,
+					                         (fftw_complex *)(dataIn),
+					                         (double *)(dataOut),
+					                         FFTW_ESTIMATE);
+				fftw_execute_dft_c2r(plan, (fftw_complex *)(dataIn),
+				                     (double *)(dataOut));
+			}
+			local_releaseVarData(fft, i, direction);
+			result = (i == 0) ? dataOut : result;
 		}
-		fftw_execute(plan);
 		fftw_destroy_plan(plan);
 	}
 
-	if (direction == GRIDREGULARFFT_FORWARD)
-		gridPatch_freeVarData(fft->patch, fft->idxFFTVar);
-	else
-		gridPatch_freeVarData(fft->patchFFTed, fft->idxFFTVarFFTed);
-
-	return dataOut;
+	return result;
 #  endif
 } /* local_doFFTCompletelyLocal */
 
@@ -306,10 +513,17 @@ local_doFFTParallel(gridRegularFFT_t fft, int direction)
 {
 	void *result;
 
-	if (direction == GRIDREGULARFFT_FORWARD)
-		result = local_doFFTParallelForward(fft);
-	else
-		result = local_doFFTParallelBackward(fft);
+	if (gridRegularDistrib_getNumOverlapChunks(fft->distribFFTed) > 0) {
+		if (direction == GRIDREGULARFFT_FORWARD)
+			result = local_doFFTParallelForwardOverlapped(fft);
+		else
+			result = local_doFFTParallelBackwardOverlapped(fft);
+	} else {
+		if (direction == GRIDREGULARFFT_FORWARD)
+			result = local_doFFTParallelForward(fft);
+		else
+			result = local_doFFTParallelBackward(fft);
+	}
 
 	return result;
 }
@@ -325,14 +539,12 @@ local_doFFTParallelForward(gridRegularFFT_t fft)
 	fft->patchFFTed = gridRegular_getPatchHandle(fft->gridFFTed, 0);
 	result          = local_doFFTParallelC2CPencil(fft, 1,
 	                                               GRIDREGULARFFT_FORWARD);
-	gridPatch_replaceVarData(fft->patchFFTed, fft->idxFFTVarFFTed, result);
 
 #  if (NDIM > 2)
 	gridRegularDistrib_transpose(fft->distribFFTed, 0, 2);
 	fft->patchFFTed = gridRegular_getPatchHandle(fft->gridFFTed, 0);
 	result          = local_doFFTParallelC2CPencil(fft, 2,
 	                                               GRIDREGULARFFT_FORWARD);
-	gridPatch_replaceVarData(fft->patchFFTed, fft->idxFFTVarFFTed, result);
 #  endif
 
 	return result;
@@ -345,14 +557,12 @@ local_doFFTParallelBackward(gridRegularFFT_t fft)
 
 #  if (NDIM > 2)
 	result = local_doFFTParallelC2CPencil(fft, 2, GRIDREGULARFFT_BACKWARD);
-	gridPatch_replaceVarData(fft->patchFFTed, fft->idxFFTVarFFTed, result);
 
 	gridRegularDistrib_transpose(fft->distribFFTed, 0, 2);
 	fft->patchFFTed = gridRegular_getPatchHandle(fft->gridFFTed, 0);
 #  endif
 	result          = local_doFFTParallelC2CPencil(fft, 1,
 	                                               GRIDREGULARFFT_BACKWARD);
-	gridPatch_replaceVarData(fft->patchFFTed, fft->idxFFTVarFFTed, result);
 
 	gridRegularDistrib_transpose(fft->distribFFTed, 0, 1);
 	fft->patchFFTed = gridRegular_getPatchHandle(fft->gridFFTed, 0);
@@ -364,138 +574,467 @@ local_doFFTParallelBackward(gridRegularFFT_t fft)
 static void *
 local_doFFTParallelR2CPencil(gridRegularFFT_t fft)
 {
-	int  howmany  = 1;
-	void *dataIn  = gridPatch_getVarDataHandle(fft->patch,
-	                                           fft->idxFFTVar);
-	void *dataOut = gridPatch_getVarDataHandle(fft->patchFFTed,
-	                                           fft->idxFFTVarFFTed);
+	int  howmany = 1;
+	int  idist   = fft->localNumRealElements;
+	void *dataIn;
+	void *dataOut;
+	void *result = NULL;
+
+	if (fft->doInPlace)
+		idist = 2 * fft->localDims[0][0];
 
 	for (int i = 1; i < NDIM; i++)
 		howmany *= fft->localDims[0][i];
 
+	prof_start("r2c");
 #  ifdef WITH_MPITRACE
 	MPItrace_event(LOCAL_MPITRACE_EVENT, 1);
 #  endif
 	if (dataVarType_isNativeFloat(dataVar_getType(fft->var))) {
-		fftwf_plan plan;
-		plan = fftwf_plan_many_dft_r2c(1, &(fft->localNumRealElements),
-		                               howmany, (float *)dataIn,
-		                               NULL, 1, fft->localNumRealElements,
-		                               (fftwf_complex *)dataOut,
-		                               NULL, 1, fft->localDims[0][0],
-		                               FFTW_ESTIMATE);
-		fftwf_execute(plan);
+		fftwf_plan plan = NULL;
+		for (int i = 0; i < fft->numFFTVars; i++) {
+			local_getVarData(fft, i, GRIDREGULARFFT_FORWARD,
+			                 &dataIn, &dataOut);
+			if (plan == NULL)
+				plan = fftwf_plan_many_dft_r2c(1, &(fft->localNumRealElements),
+				                               howmany, (float *)dataIn,
+				                               NULL, 1, idist,
+				                               (fftwf_complex *)dataOut,
+				                               NULL, 1, fft->localDims[0][0],
+				                               FFTW_ESTIMATE);
+			fftwf_execute_dft_r2c(plan, (float *)dataIn,
+			                      (fftwf_complex *)dataOut);
+			local_releaseVarData(fft, i, GRIDREGULARFFT_FORWARD);
+			result = (i == 0) ? dataOut : result;
+		}
 		fftwf_destroy_plan(plan);
 	} else {
-		fftw_plan plan;
-		plan = fftw_plan_many_dft_r2c(1, &(fft->localNumRealElements),
-		                              howmany, (double *)dataIn,
-		                              NULL, 1, fft->localNumRealElements,
-		                              (fftw_complex *)dataOut,
-		                              NULL, 1, fft->localDims[0][0],
-		                              FFTW_ESTIMATE);
-		fftw_execute(plan);
+		fftw_plan plan = NULL;
+		for (int i = 0; i < fft->numFFTVars; i++) {
+			local_getVarData(fft, i, GRIDREGULARFFT_FORWARD,
+			                 &dataIn, &dataOut);
+			if (plan == NULL)
+				plan = fftw_plan_many_dft_r2c(1, &(fft->localNumRealElements),
+				                              howmany, (double *)dataIn,
+				                              NULL, 1, idist,
+				                              (fftw_complex *)dataOut,
+				                              NULL, 1, fft->localDims[0][0],
+				                              FFTW_ESTIMATE);
+			fftw_execute_dft_r2c(plan, (double *)dataIn,
+			                     (fftw_complex *)dataOut);
+			local_releaseVarData(fft, i, GRIDREGULARFFT_FORWARD);
+			result = (i == 0) ? dataOut : result;
+		}
 		fftw_destroy_plan(plan);
 	}
 #  ifdef WITH_MPITRACE
 	MPItrace_event(LOCAL_MPITRACE_EVENT, 0);
 #  endif
-	gridPatch_freeVarData(fft->patch, fft->idxFFTVar);
+	prof_stop("r2c");
 
-	return dataOut;
+	return result;
 } /* local_doFFTParallelR2CPencil */
 
 static void *
 local_doFFTParallelC2RPencil(gridRegularFFT_t fft)
 {
-	int  howmany  = 1;
-	void *dataIn  = gridPatch_getVarDataHandle(fft->patchFFTed,
-	                                           fft->idxFFTVarFFTed);
-	void *dataOut = gridPatch_getVarDataHandle(fft->patch,
-	                                           fft->idxFFTVar);
+	int  howmany = 1;
+	int  odist   = fft->localNumRealElements;
+	void *dataIn;
+	void *dataOut;
+	void *result = NULL;
+
+	if (fft->doInPlace)
+		odist = 2 * fft->localDims[0][0];
 
 	for (int i = 1; i < NDIM; i++)
 		howmany *= fft->localDims[0][i];
 
+	prof_start("c2r");
 #  ifdef WITH_MPITRACE
 	MPItrace_event(LOCAL_MPITRACE_EVENT, 3);
 #  endif
 	if (dataVarType_isNativeFloat(dataVar_getType(fft->var))) {
-		fftwf_plan plan;
-		plan = fftwf_plan_many_dft_c2r(1, &(fft->localNumRealElements),
-		                               howmany, (fftwf_complex *)dataIn,
-		                               NULL, 1, fft->localDims[0][0],
-		                               (float *)dataOut,
-		                               NULL, 1, fft->localNumRealElements,
-		                               FFTW_ESTIMATE);
-		fftwf_execute(plan);
+		fftwf_plan plan = NULL;
+		for (int i = 0; i < fft->numFFTVars; i++) {
+			local_getVarData(fft, i, GRIDREGULARFFT_BACKWARD,
+			                 &dataIn, &dataOut);
+			if (plan == NULL)
+				plan = fftwf_plan_many_dft_c2r(1, &(fft->localNumRealElements),
+				                               howmany, (fftwf_complex *)dataIn,
+				                               NULL, 1, fft->localDims[0][0],
+				                               (float *)dataOut,
+				                               NULL, 1, odist,
+				                               FFTW_ESTIMATE);
+			fftwf_execute_dft_c2r(plan, (fftwf_complex *)dataIn,
+			                      (float *)dataOut);
+			local_releaseVarData(fft, i, GRIDREGULARFFT_BACKWARD);
+			result = (i == 0) ? dataOut : result;
+		}
 		fftwf_destroy_plan(plan);
 	} else {
-		fftw_plan plan;
-		plan = fftw_plan_many_dft_c2r(1, &(fft->localNumRealElements),
-		                              howmany, (fftw_complex *)dataIn,
-		                              NULL, 1, fft->localDims[0][0],
-		                              (double *)dataOut,
-		                              NULL, 1, fft->localNumRealElements,
-		                              FFTW_ESTIMATE);
-		fftw_execute(plan);
+		fftw_plan plan = NULL;
+		for (int i = 0; i < fft->numFFTVars; i++) {
+			local_getVarData(fft, i, GRIDREGULARFFT_BACKWARD,
+			                 &dataIn, &dataOut);
+			if (plan == NULL)
+				plan = fftw_plan_many_dft_c2r(1, &(fft->localNumRealElements),
+				                              howmany, (fftw_complex *)dataIn,
+				                              NULL, 1, fft->localDims[0][0],
+				                              (double *)dataOut,
+				                              NULL, 1, odist,
+				                              FFTW_ESTIMATE);
+			fftw_execute_dft_c2r(plan, (fftw_complex *)dataIn,
+			                     (double *)dataOut);
+			local_releaseVarData(fft, i, GRIDREGULARFFT_BACKWARD);
+			result = (i == 0) ? dataOut : result;
+		}
 		fftw_destroy_plan(plan);
 	}
 #  ifdef WITH_MPITRACE
 	MPItrace_event(LOCAL_MPITRACE_EVENT, 0);
 #  endif
+	prof_stop("c2r");
 
-	gridPatch_freeVarData(fft->patchFFTed, fft->idxFFTVarFFTed);
-
-	return dataOut;
+	return result;
 } /* local_doFFTParallelC2RPencil */
 
 static void *
 local_doFFTParallelC2CPencil(gridRegularFFT_t fft, int phase, int sign)
 {
-	int  howmany = 1;
-	void *result;
-	void *data   = gridPatch_getVarDataHandle(fft->patchFFTed,
-	                                          fft->idxFFTVarFFTed);
+	int    howmany = 1;
+	void   *result = NULL;
+	void   *data, *dataOut;
+	size_t numCells;
 
 	sign = (sign == GRIDREGULARFFT_FORWARD) ? FFTW_FORWARD : FFTW_BACKWARD;
 
 	for (int i = 1; i < NDIM; i++)
 		howmany *= fft->localDims[phase][i];
+	numCells = (size_t)howmany * fft->localDims[phase][0];
 
+	prof_start("c2c");
 #  ifdef WITH_MPITRACE
 	MPItrace_event(LOCAL_MPITRACE_EVENT, 2);
 #  endif
 	if (dataVarType_isNativeFloat(dataVar_getType(fft->var))) {
-		fftwf_plan plan;
-		result = fftwf_malloc(sizeof(fftwf_complex) * howmany
-		                      * fft->localDims[phase][0]);
-		plan   = fftwf_plan_many_dft(1, fft->localDims[phase],
-		                             howmany, (float complex *)data,
-		                             NULL, 1, fft->localDims[phase][0],
-		                             (fftwf_complex *)result,
-		                             NULL, 1, fft->localDims[phase][0],
-		                             sign, FFTW_ESTIMATE);
-		fftwf_execute(plan);
+		fftwf_plan plan = NULL;
+		for (int i = 0; i < fft->numFFTVars; i++) {
+			data    = gridPatch_getVarDataHandle(fft->patchFFTed,
+			                                     fft->idxFFTVarFFTed[i]);
+			dataOut = fft->doInPlace ? data
+			          : fftwf_malloc(sizeof(fftwf_complex) * numCells);
+			// The output replaces the patch data, it is hence grid memory.
+			if (!fft->doInPlace)
+				xmem_trackAlloc(dataOut, sizeof(fftwf_complex) * numCells,
+				                "grid");
+			if (plan == NULL)
+				plan = fftwf_plan_many_dft(1, fft->localDims[phase],
+				                           howmany, (fftwf_complex *)data,
+				                           NULL, 1, fft->localDims[phase][0],
+				                           (fftwf_complex *)dataOut,
+				                           NULL, 1, fft->localDims[phase][0],
+				                           sign, FFTW_ESTIMATE);
+			fftwf_execute_dft(plan, (fftwf_complex *)data,
+			                  (fftwf_complex *)dataOut);
+			if (!fft->doInPlace)
+				gridPatch_replaceVarData(fft->patchFFTed,
+				                         fft->idxFFTVarFFTed[i], dataOut);
+			result = (i == 0) ? dataOut : result;
+		}
 		fftwf_destroy_plan(plan);
 	} else {
-		fftw_plan plan;
-		result = fftw_malloc(sizeof(fftw_complex) * howmany
-		                     * fft->localDims[phase][0]);
-		plan   = fftw_plan_many_dft(1, fft->localDims[phase],
-		                            howmany, (double complex *)data,
-		                            NULL, 1, fft->localDims[phase][0],
-		                            (fftw_complex *)result,
-		                            NULL, 1, fft->localDims[phase][0],
-		                            sign, FFTW_ESTIMATE);
-		fftw_execute(plan);
+		fftw_plan plan = NULL;
+		for (int i = 0; i < fft->numFFTVars; i++) {
+			data    = gridPatch_getVarDataHandle(fft->patchFFTed,
+			                                     fft->idxFFTVarFFTed[i]);
+			dataOut = fft->doInPlace ? data
+			          : fftw_malloc(sizeof(fftw_complex) * numCells);
+			if (!fft->doInPlace)
+				xmem_trackAlloc(dataOut, sizeof(fftw_complex) * numCells,
+				                "grid");
+			if (plan == NULL)
+				plan = fftw_plan_many_dft(1, fft->localDims[phase],
+				                          howmany, (fftw_complex *)data,
+				                          NULL, 1, fft->localDims[phase][0],
+				                          (fftw_complex *)dataOut,
+				                          NULL, 1, fft->localDims[phase][0],
+				                          sign, FFTW_ESTIMATE);
+			fftw_execute_dft(plan, (fftw_complex *)data,
+			                 (fftw_complex *)dataOut);
+			if (!fft->doInPlace)
+				gridPatch_replaceVarData(fft->patchFFTed,
+				                         fft->idxFFTVarFFTed[i], dataOut);
+			result = (i == 0) ? dataOut : result;
+		}
 		fftw_destroy_plan(plan);
 	}
 #  ifdef WITH_MPITRACE
 	MPItrace_event(LOCAL_MPITRACE_EVENT, 0);
 #  endif
+	prof_stop("c2c");
 
 	return result;
 } /* local_doFFTParallelC2CPencil */
 
+/*
+ * The overlapped variants do the same passes as the blocking ones, but
+ * each pass is done chunk-wise inside the transpositions:  the pass
+ * before a transposition works on a chunk right before it is sent and
+ * the pass after it works on a chunk as soon as it has arrived.  The
+ * passes are done in-place on the chunks.
+ */
+static void *
+local_doFFTParallelForwardOverlapped(gridRegularFFT_t fft)
+{
+	local_overlap_t overlap = {fft, GRIDREGULARFFT_FORWARD, 0, 1,
+		                       {NULL, 0}, {NULL, 0}};
+
+	// In-place, the real data already is the complex data, it only needs
+	// to move to the other grid.
+	if (fft->doInPlace) {
+		for (int i = 0; i < fft->numFFTVars; i++)
+			local_releaseVarData(fft, i, GRIDREGULARFFT_FORWARD);
+	}
+
+	gridRegularDistrib_transposeOverlapped(fft->distribFFTed, 0, 1,
+	                                       &local_overlapPre,
+	                                       &local_overlapPost, &overlap);
+#  if (NDIM > 2)
+	local_overlapResetPlans(&overlap);
+	overlap.phasePost = 2;
+	gridRegularDistrib_transposeOverlapped(fft->distribFFTed, 0, 2,
+	                                       NULL, &local_overlapPost,
+	                                       &overlap);
+#  endif
+	local_overlapResetPlans(&overlap);
+	fft->patchFFTed = gridRegular_getPatchHandle(fft->gridFFTed, 0);
+
+	return gridPatch_getVarDataHandle(fft->patchFFTed,
+	                                  fft->idxFFTVarFFTed[0]);
+}
+
+static void *
+local_doFFTParallelBackwardOverlapped(gridRegularFFT_t fft)
+{
+	local_overlap_t overlap = {fft, GRIDREGULARFFT_BACKWARD, 1, 0,
+		                       {NULL, 0}, {NULL, 0}};
+
+#  if (NDIM > 2)
+	overlap.phasePre  = 2;
+	overlap.phasePost = 1;
+	gridRegularDistrib_transposeOverlapped(fft->distribFFTed, 0, 2,
+	                                       &local_overlapPre,
+	                                       &local_overlapPost, &overlap);
+	local_overlapResetPlans(&overlap);
+	overlap.phasePost = 0;
+	gridRegularDistrib_transposeOverlapped(fft->distribFFTed, 0, 1,
+	                                       NULL, &local_overlapPost,
+	                                       &overlap);
+#  else
+	gridRegularDistrib_transposeOverlapped(fft->distribFFTed, 0, 1,
+	                                       &local_overlapPre,
+	                                       &local_overlapPost, &overlap);
+#  endif
+	local_overlapResetPlans(&overlap);
+	fft->patchFFTed = gridRegular_getPatchHandle(fft->gridFFTed, 0);
+
+	for (int i = 0; i < fft->numFFTVars; i++)
+		local_releaseVarData(fft, i, GRIDREGULARFFT_BACKWARD);
+
+	return gridPatch_getVarDataHandle(fft->patch, fft->idxFFTVar[0]);
+}
+
+static void
+local_overlapPre(void                    *arg,
+                 int                     idxOfVar,
+                 void                    *data,
+                 const gridPointUint32_t dims,
+                 int                     dimChunk,
+                 uint32_t                idxLo,
+                 uint32_t                idxHi)
+{
+	local_overlap_t *overlap = arg;
+
+	local_overlapDoChunk(overlap, &(overlap->planPre), overlap->phasePre,
+	                     idxOfVar, data, dims, dimChunk, idxLo, idxHi);
+
+	// Out-of-place, the real input is not needed after its last chunk.
+	if ((overlap->phasePre == 0) && !(overlap->fft->doInPlace)
+	    && (idxHi == dims[dimChunk] - 1))
+		local_releaseVarData(overlap->fft, idxOfVar, GRIDREGULARFFT_FORWARD);
+}
+
+static void
+local_overlapPost(void                    *arg,
+                  int                     idxOfVar,
+                  void                    *data,
+                  const gridPointUint32_t dims,
+                  int                     dimChunk,
+                  uint32_t                idxLo,
+                  uint32_t                idxHi)
+{
+	local_overlap_t *overlap = arg;
+
+	local_overlapDoChunk(overlap, &(overlap->planPost), overlap->phasePost,
+	                     idxOfVar, data, dims, dimChunk, idxLo, idxHi);
+}
+
+static void
+local_overlapDoChunk(local_overlap_t         *overlap,
+                     local_overlapPlan_t     *plan,
+                     int                     phase,
+                     int                     idxOfVar,
+                     void                    *data,
+                     const gridPointUint32_t dims,
+                     int                     dimChunk,
+                     uint32_t                idxLo,
+                     uint32_t                idxHi)
+{
+	gridRegularFFT_t fft      = overlap->fft;
+	bool             isFloat  = dataVarType_isNativeFloat(
+	    dataVar_getType(fft->var));
+	size_t           sizeReal = isFloat ? sizeof(float) : sizeof(double);
+	size_t           sizeIn   = 2 * sizeReal;
+	size_t           sizeOut  = 2 * sizeReal;
+	int              n        = (int)(dims[0]);
+	int              idist    = n;
+	int              odist    = n;
+	char             *in      = data;
+	char             *out     = data;
+	uint64_t         linesPerSlice = 1;
+	uint64_t         numBlocks     = 1;
+	int              howmany;
+	int              sign;
+	const char       *name;
+
+	assert(dimChunk > 0);
+
+	// The lines along the first dimension with an index in [idxLo, idxHi]
+	// in the chunked dimension form numBlocks blocks of howmany lines.
+	for (int i = 1; i < dimChunk; i++)
+		linesPerSlice *= dims[i];
+	for (int i = dimChunk + 1; i < NDIM; i++)
+		numBlocks *= dims[i];
+	howmany = (int)(linesPerSlice * (idxHi - idxLo + 1));
+
+	sign    = (overlap->direction == GRIDREGULARFFT_FORWARD)
+	          ? FFTW_FORWARD : FFTW_BACKWARD;
+	name    = "c2c";
+	if ((phase == 0) && (overlap->direction == GRIDREGULARFFT_FORWARD)) {
+		name   = "r2c";
+		n      = fft->localNumRealElements;
+		sizeIn = sizeReal;
+		idist  = fft->doInPlace ? 2 * (int)(dims[0]) : n;
+		odist  = (int)(dims[0]);
+		if (!fft->doInPlace)
+			in = gridPatch_getVarDataHandle(fft->patch,
+			                                fft->idxFFTVar[idxOfVar]);
+	} else if (phase == 0) {
+		name    = "c2r";
+		n       = fft->localNumRealElements;
+		sizeOut = sizeReal;
+		idist   = (int)(dims[0]);
+		odist   = fft->doInPlace ? 2 * (int)(dims[0]) : n;
+		if (!fft->doInPlace)
+			out = gridPatch_getVarDataHandle(fft->patch,
+			                                 fft->idxFFTVar[idxOfVar]);
+	}
+
+	prof_start(name);
+	if ((plan->plan != NULL) && (plan->howmany != howmany)) {
+		if (isFloat)
+			fftwf_destroy_plan((fftwf_plan)(plan->plan));
+		else
+			fftw_destroy_plan((fftw_plan)(plan->plan));
+		plan->plan = NULL;
+	}
+	// The blocks are not aligned like the start of the data.
+	if ((plan->plan == NULL) && isFloat) {
+		if (name[0] == 'r')
+			plan->plan = fftwf_plan_many_dft_r2c(
+			    1, &n, howmany, (float *)in, NULL, 1, idist,
+			    (fftwf_complex *)out, NULL, 1, odist,
+			    FFTW_ESTIMATE | FFTW_UNALIGNED);
+		else if (name[2] == 'r')
+			plan->plan = fftwf_plan_many_dft_c2r(
+			    1, &n, howmany, (fftwf_complex *)in, NULL, 1, idist,
+			    (float *)out, NULL, 1, odist,
+			    FFTW_ESTIMATE | FFTW_UNALIGNED);
+		else
+			plan->plan = fftwf_plan_many_dft(
+			    1, &n, howmany, (fftwf_complex *)in, NULL, 1, idist,
+			    (fftwf_complex *)out, NULL, 1, odist, sign,
+			    FFTW_ESTIMATE | FFTW_UNALIGNED);
+	} else if (plan->plan == NULL) {
+		if (name[0] == 'r')
+			plan->plan = fftw_plan_many_dft_r2c(
+			    1, &n, howmany, (double *)in, NULL, 1, idist,
+			    (fftw_complex *)out, NULL, 1, odist,
+			    FFTW_ESTIMATE | FFTW_UNALIGNED);
+		else if (name[2] == 'r')
+			plan->plan = fftw_plan_many_dft_c2r(
+			    1, &n, howmany, (fftw_complex *)in, NULL, 1, idist,
+			    (double *)out, NULL, 1, odist,
+			    FFTW_ESTIMATE | FFTW_UNALIGNED);
+		else
+			plan->plan = fftw_plan_many_dft(
+			    1, &n, howmany, (fftw_complex *)in, NULL, 1, idist,
+			    (fftw_complex *)out, NULL, 1, odist, sign,
+			    FFTW_ESTIMATE | FFTW_UNALIGNED);
+	}
+	plan->howmany = howmany;
+
+	for (uint64_t b = 0; b < numBlocks; b++) {
+		uint64_t line = (b * dims[dimChunk] + idxLo) * linesPerSlice;
+		char     *i   = in + line * idist * sizeIn;
+		char     *o   = out + line * odist * sizeOut;
+
+		if (isFloat) {
+			if (name[0] == 'r')
+				fftwf_execute_dft_r2c((fftwf_plan)(plan->plan), (float *)i,
+				                      (fftwf_complex *)o);
+			else if (name[2] == 'r')
+				fftwf_execute_dft_c2r((fftwf_plan)(plan->plan),
+				                      (fftwf_complex *)i, (float *)o);
+			else
+				fftwf_execute_dft((fftwf_plan)(plan->plan),
+				                  (fftwf_complex *)i, (fftwf_complex *)o);
+		} else {
+			if (name[0] == 'r')
+				fftw_execute_dft_r2c((fftw_plan)(plan->plan), (double *)i,
+				                     (fftw_complex *)o);
+			else if (name[2] == 'r')
+				fftw_execute_dft_c2r((fftw_plan)(plan->plan),
+				                     (fftw_complex *)i, (double *)o);
+			else
+				fftw_execute_dft((fftw_plan)(plan->plan),
+				                 (fftw_complex *)i, (fftw_complex *)o);
+		}
+	}
+	prof_stop(name);
+} /* local_overlapDoChunk */
+
+static void
+local_overlapResetPlans(local_overlap_t *overlap)
+{
+	bool isFloat = dataVarType_isNativeFloat(
+	    dataVar_getType(overlap->fft->var));
+
+	if (overlap->planPre.plan != NULL) {
+		if (isFloat)
+			fftwf_destroy_plan((fftwf_plan)(overlap->planPre.plan));
+		else
+			fftw_destroy_plan((fftw_plan)(overlap->planPre.plan));
+	}
+	if (overlap->planPost.plan != NULL) {
+		if (isFloat)
+			fftwf_destroy_plan((fftwf_plan)(overlap->planPost.plan));
+		else
+			fftw_destroy_plan((fftw_plan)(overlap->planPost.plan));
+	}
+	overlap->planPre.plan  = NULL;
+	overlap->planPost.plan = NULL;
+}
+
 #endif
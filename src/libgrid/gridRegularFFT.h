@@ -22,11 +22,67 @@ typedef struct gridRegularFFT_struct *gridRegularFFT_t;
 
 
 /*--- Prototypes of exported functions ----------------------------------*/
+
+/**
+ * @brief  Creates a new FFT object for a variable of a grid.
+ *
+ * If the variable is FFTW padded (see dataVar_setFFTWPadded()), the
+ * transforms are done in place:  The real space data then uses the
+ * padded layout with @f$ 2(n_0/2+1) @f$ elements in the first dimension
+ * and its memory is handed over to the Fourier space grid (and back), so
+ * that only one copy of the field exists at any time.  Otherwise the
+ * real and the Fourier space data are held in separate arrays.  The
+ * transpositions of the Fourier space grid use the number of rounds set
+ * on @a distrib (see gridRegularDistrib_setNumTransposeRounds()).
+ *
+ * @param[in]  grid
+ *                The grid to work with.  It must have exactly one patch.
+ * @param[in]  distrib
+ *                The distribution of the grid.
+ * @param[in]  idxFFTVar
+ *                The index of the variable that should be transformed.
+ *
+ * @return  Returns a new FFT object.
+ */
 extern gridRegularFFT_t
 gridRegularFFT_new(gridRegular_t        grid,
                    gridRegularDistrib_t distrib,
                    int                  idxFFTVar);
 
+
+/**
+ * @brief  Creates a new FFT object that transforms several variables of a
+ *         grid together.
+ *
+ * All variables must be of the same type and the same padding.  They
+ * share the FFTW plans and, with MPI, each transposition sends the data
+ * of all variables in one message per process instead of one message
+ * per variable.  The i-th variable of the Fourier space grid (see
+ * gridRegularFFT_getGridFFTed()) holds the transform of
+ * @a idxFFTVars[i].  gridRegularFFT_execute() transforms all variables
+ * and returns the data of the first one.
+ *
+ * Note that all variables are held in memory at the same time, the
+ * memory needed is therefore that of the single variable case times
+ * the number of variables.
+ *
+ * @param[in]  grid
+ *                The grid to work with.  It must have exactly one patch.
+ * @param[in]  distrib
+ *                The distribution of the grid.
+ * @param[in]  numFFTVars
+ *                The number of variables to transform, must be positive.
+ * @param[in]  idxFFTVars
+ *                The indices of the variables that should be transformed.
+ *
+ * @return  Returns a new FFT object.
+ */
+extern gridRegularFFT_t
+gridRegularFFT_newMany(gridRegular_t        grid,
+                       gridRegularDistrib_t distrib,
+                       int                  numFFTVars,
+                       const int            *idxFFTVars);
+
 extern void
 gridRegularFFT_del(gridRegularFFT_t *fft);
 
@@ -39,4 +95,20 @@ gridRegularFFT_getNorm(const gridRegularFFT_t fft);
 extern void *
 gridRegularFFT_execute(gridRegularFFT_t fft, int direction);
 
+/**
+ * @brief  Prepares the Fourier space grid to be filled directly.
+ *
+ * This brings the Fourier space grid into the layout a forward transform
+ * would produce, without transforming any data, so that it can be filled
+ * in k-space and then transformed with a backward transform.  Any data
+ * held by the Fourier space grid is discarded.
+ *
+ * @param[in,out]  fft
+ *                    The FFT object to work with.
+ *
+ * @return  Returns nothing.
+ */
+extern void
+gridRegularFFT_initFFTed(gridRegularFFT_t fft);
+
 #endif
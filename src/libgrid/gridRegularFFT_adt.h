@@ -8,22 +8,24 @@
 
 /*--- Includes ----------------------------------------------------------*/
 #include "gridConfig.h"
+#include <stdbool.h>
 
 
 /*--- ADT implementation ------------------------------------------------*/
 struct gridRegularFFT_struct {
 	gridRegular_t        grid;
 	gridRegularDistrib_t distrib;
-	int                  idxFFTVar;
+	int                  numFFTVars;
+	int                  *idxFFTVar;
 	dataVar_t            var;
 	gridPatch_t          patch;
 	gridPointInt_t       nProcs;
 	gridRegular_t        gridFFTed;
 	gridRegularDistrib_t distribFFTed;
-	int                  idxFFTVarFFTed;
-	dataVar_t            varFFTed;
+	int                  *idxFFTVarFFTed;
 	gridPatch_t          patchFFTed;
 	double               norm;
+	bool                 doInPlace;
 #if (defined WITH_MPI)
 	gridPointUint32_t    globalDims[NDIM];
 	gridPointUint32_t    localIdxLo[NDIM];
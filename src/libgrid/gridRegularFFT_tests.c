@@ -46,6 +46,22 @@ local_fillFakeGrid(gridRegular_t grid);
 static bool
 local_testFFTResult(gridRegular_t grid, fpv_t *dataCpy);
 
+#ifdef WITH_MPI
+static bool
+local_compareOverlapped(const gridPointInt_t nProcs, bool padded);
+
+static gridRegular_t
+local_getFakeGridPadded(bool padded);
+
+static bool
+local_compareRows(const fpv_t *data,
+                  const fpv_t *dataRef,
+                  uint64_t    numRows,
+                  uint64_t    lenRow,
+                  uint64_t    lenRowActual);
+
+#endif
+
 
 /*--- Implementations of exported functios ------------------------------*/
 extern bool
@@ -241,6 +257,143 @@ gridRegularFFT_execute_test(void)
 	return hasPassed ? true : false;
 } /* gridRegularFFT_execute_test */
 
+extern bool
+gridRegularFFT_newMany_test(void)
+{
+	bool                 hasPassed     = true;
+	int                  rank          = 0;
+	int                  idxFFTVars[2] = { 0, 1 };
+	gridRegularFFT_t     fft;
+	gridRegular_t        grid;
+	gridRegularDistrib_t distrib;
+	gridPatch_t          patch;
+	gridPointUint32_t    dims, dimsActual;
+	fpv_t                *data0, *data1, *dataCpy;
+	fpvComplex_t         *dataK0, *dataK1;
+	uint64_t             numCells;
+	double               maxDiff = 0.0;
+#ifdef XMEM_TRACK_MEM
+	size_t               allocatedBytes = global_allocated_bytes;
+#endif
+#ifdef WITH_MPI
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+#endif
+
+	if (rank == 0)
+		printf("Testing %s... ", __func__);
+
+	grid     = local_getFakeGrid();
+	gridRegular_attachVar(grid,
+	                      dataVar_clone(gridRegular_getVarHandle(grid, 0)));
+	distrib  = local_getFakeGridDistrib(grid);
+	local_fillFakeGrid(grid);
+	patch    = gridRegular_getPatchHandle(grid, 0);
+	numCells = gridPatch_getNumCellsActual(patch, 0);
+	data0    = gridPatch_getVarDataHandle(patch, 0);
+	data1    = gridPatch_getVarDataHandle(patch, 1);
+	dataCpy  = xmalloc(sizeof(fpv_t) * numCells);
+	for (uint64_t i = 0; i < numCells; i++) {
+		dataCpy[i] = data0[i];
+		data1[i]   = 2. * data0[i];
+	}
+
+	// The second variable must come out as twice the first one.
+	fft    = gridRegularFFT_newMany(grid, distrib, 2, idxFFTVars);
+	gridRegularFFT_execute(fft, GRIDREGULARFFT_FORWARD);
+	patch  = gridRegular_getPatchHandle(gridRegularFFT_getGridFFTed(fft), 0);
+	dataK0 = gridPatch_getVarDataHandle(patch, 0);
+	dataK1 = gridPatch_getVarDataHandle(patch, 1);
+	for (uint64_t i = 0; i < gridPatch_getNumCells(patch); i++) {
+		double diff = cabs(dataK1[i] - 2. * dataK0[i]);
+		maxDiff = (diff > maxDiff) ? diff : maxDiff;
+	}
+	if (maxDiff > 1e-3)
+		hasPassed = false;
+
+	gridRegularFFT_execute(fft, GRIDREGULARFFT_BACKWARD);
+	if (!local_testFFTResult(grid, dataCpy))
+		hasPassed = false;
+	patch = gridRegular_getPatchHandle(grid, 0);
+	data0 = gridPatch_getVarDataHandle(patch, 0);
+	data1 = gridPatch_getVarDataHandle(patch, 1);
+	gridPatch_getDims(patch, dims);
+	gridPatch_getDimsActual(patch, 0, dimsActual);
+	for (uint64_t i = 0; i < numCells; i++) {
+		// Skip the padding.
+		if (i % dimsActual[0] >= dims[0])
+			continue;
+		if (fabs(data1[i] - 2. * data0[i]) > 1e-3 * fabs(data0[i]) + 1e-3)
+			hasPassed = false;
+	}
+
+	gridRegular_del(&grid);
+	gridRegularDistrib_del(&distrib);
+	gridRegularFFT_del(&fft);
+	xfree(dataCpy);
+#ifdef WITH_FFT_FFTW3
+	fftw_cleanup();
+	fftwf_cleanup();
+#endif
+#ifdef XMEM_TRACK_MEM
+	if (allocatedBytes != global_allocated_bytes)
+		hasPassed = false;
+#endif
+
+	return hasPassed ? true : false;
+} /* gridRegularFFT_newMany_test */
+
+#ifdef WITH_MPI
+extern bool
+gridRegularFFT_executeOverlapped_test(void)
+{
+	bool           hasPassed = true;
+	int            rank      = 0;
+	int            size;
+	gridPointInt_t nProcs;
+#  ifdef XMEM_TRACK_MEM
+	size_t         allocatedBytes = global_allocated_bytes;
+#  endif
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+	MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+	if (rank == 0)
+		printf("Testing %s... ", __func__);
+
+	// Slabs.
+	for (int i = 0; i < NDIM; i++)
+		nProcs[i] = 1;
+	nProcs[NDIM - 1] = size;
+	if (!local_compareOverlapped(nProcs, false))
+		hasPassed = false;
+	if (!local_compareOverlapped(nProcs, true))
+		hasPassed = false;
+
+#  if (NDIM > 2)
+	// Pencils.
+	if (size % 2 == 0) {
+		nProcs[1]        = 2;
+		nProcs[NDIM - 1] = size / 2;
+		if (!local_compareOverlapped(nProcs, false))
+			hasPassed = false;
+		if (!local_compareOverlapped(nProcs, true))
+			hasPassed = false;
+	}
+#  endif
+
+#  ifdef WITH_FFT_FFTW3
+	fftw_cleanup();
+	fftwf_cleanup();
+#  endif
+#  ifdef XMEM_TRACK_MEM
+	if (allocatedBytes != global_allocated_bytes)
+		hasPassed = false;
+#  endif
+
+	return hasPassed ? true : false;
+} /* gridRegularFFT_executeOverlapped_test */
+
+#endif
+
 /*--- Implementations of local functions --------------------------------*/
 static gridRegular_t
 local_getFakeGrid(void)
@@ -345,6 +498,7 @@ static bool
 local_testFFTResult(gridRegular_t grid, fpv_t *dataCpy)
 {
 	gridPointUint32_t dims;
+	gridPointUint32_t dimsActual;
 	gridPointUint32_t dimsGlobal;
 	uint64_t          normFac = 1;
 	uint64_t          offset  = UINT64_C(0);
@@ -355,6 +509,7 @@ local_testFFTResult(gridRegular_t grid, fpv_t *dataCpy)
 	dataVarType_t     varType = dataVar_getType(var);
 
 	gridPatch_getDims(patch, dims);
+	gridPatch_getDimsActual(patch, 0, dimsActual);
 	gridRegular_getDims(grid, dimsGlobal);
 
 	for (int i = 0; i < NDIM; i++)
@@ -363,6 +518,7 @@ local_testFFTResult(gridRegular_t grid, fpv_t *dataCpy)
 #if (NDIM == 3)
 	for (int k = 0; k < dims[2]; k++) {
 		for (int j = 0; j < dims[1]; j++) {
+			offset = (j + k * dimsActual[1]) * dimsActual[0];
 			for (int i = 0; i < dims[0]; i++) {
 				double tmp = data[offset] - dataCpy[offset] * normFac;
 				sumSqr += tmp * tmp;
@@ -372,6 +528,7 @@ local_testFFTResult(gridRegular_t grid, fpv_t *dataCpy)
 	}
 #elif (NDIM == 2)
 	for (int j = 0; j < dims[1]; j++) {
+		offset = j * dimsActual[0];
 		for (int i = 0; i < dims[0]; i++) {
 			double tmp = data[offset] - dataCpy[offset] * normFac;
 			sumSqr += tmp * tmp;
@@ -390,3 +547,118 @@ local_testFFTResult(gridRegular_t grid, fpv_t *dataCpy)
 
 	return true;
 } /* local_testFFTResult */
+
+#ifdef WITH_MPI
+static bool
+local_compareOverlapped(const gridPointInt_t nProcs, bool padded)
+{
+	bool                 hasPassed = true;
+	gridRegular_t        grid[2];
+	gridRegularDistrib_t distrib[2];
+	gridRegularFFT_t     fft[2];
+	gridPatch_t          patch[2];
+	gridPointUint32_t    dims, dimsActual;
+	uint64_t             numCells;
+
+	// The first transform is the blocking one, the second one overlaps
+	// the transposes with the 1D transforms.
+	for (int i = 0; i < 2; i++) {
+		gridPointInt_t nProcsCpy;
+		for (int j = 0; j < NDIM; j++)
+			nProcsCpy[j] = nProcs[j];
+		grid[i]    = local_getFakeGridPadded(padded);
+		distrib[i] = gridRegularDistrib_new(grid[i], NULL);
+		gridRegularDistrib_initMPI(distrib[i], nProcsCpy, MPI_COMM_WORLD);
+		gridRegularDistrib_setNumOverlapChunks(distrib[i], 3 * i);
+		gridRegular_attachPatch(grid[i],
+		                        gridRegularDistrib_getPatchForRank(
+		                            distrib[i],
+		                            gridRegularDistrib_getLocalRank(
+		                                distrib[i])));
+		local_fillFakeGrid(grid[i]);
+		fft[i]     = gridRegularFFT_new(grid[i], distrib[i], 0);
+		gridRegularFFT_execute(fft[i], GRIDREGULARFFT_FORWARD);
+		patch[i]   = gridRegular_getPatchHandle(
+		    gridRegularFFT_getGridFFTed(fft[i]), 0);
+	}
+
+	numCells = gridPatch_getNumCells(patch[0]);
+	if (numCells != gridPatch_getNumCells(patch[1])) {
+		hasPassed = false;
+	} else {
+		// Compare the modes as pairs of real numbers.
+		if (!local_compareRows(gridPatch_getVarDataHandle(patch[1], 0),
+		                       gridPatch_getVarDataHandle(patch[0], 0),
+		                       1, 2 * numCells, 2 * numCells))
+			hasPassed = false;
+	}
+
+	for (int i = 0; i < 2; i++) {
+		gridRegularFFT_execute(fft[i], GRIDREGULARFFT_BACKWARD);
+		patch[i] = gridRegular_getPatchHandle(grid[i], 0);
+	}
+	gridPatch_getDims(patch[0], dims);
+	gridPatch_getDimsActual(patch[0], 0, dimsActual);
+	if (!local_compareRows(gridPatch_getVarDataHandle(patch[1], 0),
+	                       gridPatch_getVarDataHandle(patch[0], 0),
+	                       gridPatch_getNumCells(patch[0]) / dims[0],
+	                       dims[0], dimsActual[0]))
+		hasPassed = false;
+
+	for (int i = 0; i < 2; i++) {
+		gridRegularFFT_del(&(fft[i]));
+		gridRegularDistrib_del(&(distrib[i]));
+		gridRegular_del(&(grid[i]));
+	}
+
+	return hasPassed;
+} /* local_compareOverlapped */
+
+static gridRegular_t
+local_getFakeGridPadded(bool padded)
+{
+	gridRegular_t grid = local_getFakeGrid();
+	dataVar_t     var  = gridRegular_getVarHandle(grid, 0);
+
+	// The variable has no memory yet, so its layout can still change.
+	if (padded)
+		dataVar_setFFTWPadded(var);
+	else
+		dataVar_unsetFFTWPadded(var);
+
+	return grid;
+}
+
+static bool
+local_compareRows(const fpv_t *data,
+                  const fpv_t *dataRef,
+                  uint64_t    numRows,
+                  uint64_t    lenRow,
+                  uint64_t    lenRowActual)
+{
+	double maxAbs  = 0.0;
+	double maxDiff = 0.0;
+#  ifdef ENABLE_DOUBLE
+	double tol     = 1e-12;
+#  else
+	double tol     = 1e-5;
+#  endif
+
+	for (uint64_t j = 0; j < numRows; j++) {
+		for (uint64_t i = j * lenRowActual; i < j * lenRowActual + lenRow;
+		     i++) {
+			double diff = fabs((double)(data[i]) - (double)(dataRef[i]));
+			maxDiff = (diff > maxDiff) ? diff : maxDiff;
+			maxAbs  = (fabs(dataRef[i]) > maxAbs) ? fabs(dataRef[i])
+			          : maxAbs;
+		}
+	}
+	// The rounding errors scale with the largest value of the field, a
+	// rank may only hold values that are rounding noise themselves.
+	MPI_Allreduce(MPI_IN_PLACE, &maxAbs, 1, MPI_DOUBLE, MPI_MAX,
+	              MPI_COMM_WORLD);
+
+	return (maxDiff <= tol * maxAbs) ? true : false;
+}
+
+#endif
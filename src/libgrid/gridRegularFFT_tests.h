@@ -24,5 +24,14 @@ gridRegularFFT_getNorm_test(void);
 extern bool
 gridRegularFFT_execute_test(void);
 
+extern bool
+gridRegularFFT_newMany_test(void);
+
+#ifdef WITH_MPI
+extern bool
+gridRegularFFT_executeOverlapped_test(void);
+
+#endif
+
 
 #endif
@@ -405,6 +405,7 @@ local_calcProtoMeanMinMax(void      *data,
                           double    *max)
 {
 	union { double *lf;
+		    float  *f;
 		    int    *i;
 		    int8_t *i8;
 		    fpv_t  *fpv;
@@ -430,6 +431,11 @@ local_calcProtoMeanMinMax(void      *data,
 			*max        = (*(tmp.lf) > *max) ? *(tmp.lf) : *max;
 			*protoMean += *(tmp.lf);
 			break;
+		case DATAVARTYPE_FLOAT:
+			*min        = (*(tmp.f) < *min) ? (double)*(tmp.f) : *min;
+			*max        = (*(tmp.f) > *max) ? (double)*(tmp.f) : *max;
+			*protoMean += (double)*(tmp.f);
+			break;
 		case DATAVARTYPE_FPV:
 			*min        = (*(tmp.fpv) < *min) ? (double)*(tmp.fpv) : *min;
 			*max        = (*(tmp.fpv) > *max) ? (double)*(tmp.fpv) : *max;
@@ -451,6 +457,7 @@ local_calcProtoVarSkewKurt(void         *data,
                            const double mean)
 {
 	union { double *lf;
+		    float  *f;
 		    int    *i;
 		    int    *i8;
 		    fpv_t  *fpv;
@@ -471,6 +478,9 @@ local_calcProtoVarSkewKurt(void         *data,
 		case DATAVARTYPE_DOUBLE:
 			tmpNo = *(tmp.lf) - mean;
 			break;
+		case DATAVARTYPE_FLOAT:
+			tmpNo = (double)*(tmp.f) - mean;
+			break;
 		case DATAVARTYPE_FPV:
 			tmpNo = (double)*(tmp.fpv) - mean;
 			break;
@@ -17,10 +17,20 @@
 
 /*--- Includes ----------------------------------------------------------*/
 #include "gridConfig.h"
+#include <stdbool.h>
 #include <hdf5.h>
 #include "../libutil/diediedie.h"
 
 
+/*--- Exported defines --------------------------------------------------*/
+
+/** @brief  The attribute holding the offset of a quantised dataset. */
+#define GRIDUTILHDF5_QUANTISE_OFFSET "quantiseOffset"
+
+/** @brief  The attribute holding the step of a quantised dataset. */
+#define GRIDUTILHDF5_QUANTISE_STEP "quantiseStep"
+
+
 /*--- Prototypes of exported functions ----------------------------------*/
 
 /**
@@ -75,4 +85,65 @@ gridUtilHDF5_getDataSpaceFromDims(gridPointUint32_t dims)
 	return ds;
 }
 
+/**
+ * @brief  Attaches a scalar double attribute to an HDF5 object.
+ *
+ * @param[in]  obj
+ *                The object (e.g. a dataset) to attach the attribute to.
+ * @param[in]  *name
+ *                The name of the attribute.
+ * @param[in]  value
+ *                The value of the attribute.
+ *
+ * @return  Returns nothing.
+ */
+inline static void
+gridUtilHDF5_writeAttributeDouble(hid_t obj, const char *name, double value)
+{
+	hid_t space, attr;
+
+	space = H5Screate(H5S_SCALAR);
+	attr  = H5Acreate(obj, name, H5T_IEEE_F64LE, space, H5P_DEFAULT,
+	                  H5P_DEFAULT);
+	if ((space < 0) || (attr < 0))
+		diediedie(EXIT_FAILURE);
+
+	if (H5Awrite(attr, H5T_NATIVE_DOUBLE, &value) < 0)
+		diediedie(EXIT_FAILURE);
+
+	H5Aclose(attr);
+	H5Sclose(space);
+}
+
+/**
+ * @brief  Reads a scalar double attribute of an HDF5 object.
+ *
+ * @param[in]   obj
+ *                 The object (e.g. a dataset) holding the attribute.
+ * @param[in]   *name
+ *                 The name of the attribute.
+ * @param[out]  *value
+ *                 Receives the value of the attribute.
+ *
+ * @return  Returns @c true if the attribute exists and could be read, and
+ *          @c false otherwise.
+ */
+inline static bool
+gridUtilHDF5_readAttributeDouble(hid_t obj, const char *name, double *value)
+{
+	hid_t attr;
+	bool  hasRead;
+
+	if (H5Aexists(obj, name) <= 0)
+		return false;
+
+	attr = H5Aopen(obj, name, H5P_DEFAULT);
+	if (attr < 0)
+		return false;
+	hasRead = (H5Aread(attr, H5T_NATIVE_DOUBLE, value) >= 0);
+	H5Aclose(attr);
+
+	return hasRead;
+}
+
 #endif
@@ -26,6 +26,7 @@
 #include "gridPoint.h"
 #include "../libutil/xmem.h"
 #include "../libutil/filename.h"
+#include "../libutil/prof.h"
 
 
 /*--- Implemention of main structure ------------------------------------*/
@@ -88,7 +89,9 @@ gridWriter_writeGridRegular(gridWriter_t  writer,
 	assert(grid != NULL);
 	assert(writer->func->writeGridRegular != NULL);
 
+	prof_start("write");
 	writer->func->writeGridRegular(writer, grid);
+	prof_stop("write");
 }
 
 #ifdef WITH_MPI
@@ -0,0 +1,310 @@
+// Copyright (C) 2013, Steffen Knollmann
+// Released under the terms of the GNU General Public License version 3.
+// This file is part of `ginnungagap'.
+
+
+/*--- Doxygen file description ------------------------------------------*/
+
+/**
+ * @file libgrid/gridWriterAsync.c
+ * @ingroup libgridIOOut
+ * @brief  This file implements the asynchronous grid writer.
+ */
+
+
+/*--- Includes ----------------------------------------------------------*/
+#include "gridConfig.h"
+#include "gridWriterAsync.h"
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef WITH_MPI
+#  include <mpi.h>
+#endif
+#ifdef ENABLE_ASYNC_IO
+#  include <pthread.h>
+#endif
+#include "gridPatch.h"
+#include "gridPoint.h"
+#include "../libdata/dataVar.h"
+#include "../libutil/xmem.h"
+#include "../libutil/prof.h"
+#include "../libutil/diediedie.h"
+
+
+/*--- Implemention of main structure ------------------------------------*/
+#include "gridWriterAsync_adt.h"
+#include "gridWriter_adt.h"
+
+
+/*--- Local structures --------------------------------------------------*/
+#ifdef ENABLE_ASYNC_IO
+
+/** @brief  Describes one grid waiting to be written. */
+typedef struct {
+	/** @brief  The private copy of the grid. */
+	gridRegular_t grid;
+	/** @brief  The file name to overlay, may be @c NULL. */
+	filename_t    fileName;
+	/** @brief  The number of bytes held by the copy. */
+	uint64_t      numBytes;
+} local_job_t;
+#endif
+
+
+/*--- Prototypes of local functions -------------------------------------*/
+static void
+local_writeGrid(gridWriter_t     writer,
+                gridRegular_t    grid,
+                const filename_t fileName,
+                bool             useProf);
+
+#ifdef ENABLE_ASYNC_IO
+static uint64_t
+local_getNumBytes(gridRegular_t grid);
+
+static gridRegular_t
+local_snapshotGrid(gridRegular_t grid);
+
+static void *
+local_ioThread(void *arg);
+
+#endif
+
+
+/*--- Implementations of exported functions -----------------------------*/
+extern gridWriterAsync_t
+gridWriterAsync_new(gridWriter_t writer, uint64_t maxBytes)
+{
+	gridWriterAsync_t async;
+
+	assert(writer != NULL);
+
+	async           = xmalloc(sizeof(struct gridWriterAsync_struct));
+	async->writer   = writer;
+	async->maxBytes = maxBytes;
+	async->isAsync  = false;
+
+#ifdef ENABLE_ASYNC_IO
+	async->isAsync = (maxBytes > 0) ? true : false;
+#  ifdef WITH_MPI
+	if (async->isAsync) {
+		int provided;
+		MPI_Query_thread(&provided);
+		if (provided < MPI_THREAD_MULTIPLE)
+			async->isAsync = false;
+	}
+#  endif
+	if (async->isAsync) {
+		async->jobs           = varArr_new(4);
+		async->numPending     = 0;
+		async->bytesPending   = 0;
+		async->isShuttingDown = false;
+		pthread_mutex_init(&(async->lock), NULL);
+		pthread_cond_init(&(async->cond), NULL);
+		if (pthread_create(&(async->thread), NULL, &local_ioThread,
+		                   async) != 0) {
+			fprintf(stderr, "Could not start the IO thread.\n");
+			diediedie(EXIT_FAILURE);
+		}
+	}
+#endif
+
+	return async;
+}
+
+extern void
+gridWriterAsync_del(gridWriterAsync_t *async)
+{
+	assert(async != NULL && *async != NULL);
+
+#ifdef ENABLE_ASYNC_IO
+	if ((*async)->isAsync) {
+		gridWriterAsync_flush(*async);
+		pthread_mutex_lock(&((*async)->lock));
+		(*async)->isShuttingDown = true;
+		pthread_cond_broadcast(&((*async)->cond));
+		pthread_mutex_unlock(&((*async)->lock));
+		pthread_join((*async)->thread, NULL);
+		pthread_cond_destroy(&((*async)->cond));
+		pthread_mutex_destroy(&((*async)->lock));
+		varArr_del(&((*async)->jobs));
+	}
+#endif
+
+	xfree(*async);
+	*async = NULL;
+}
+
+extern void
+gridWriterAsync_writeGridRegular(gridWriterAsync_t async,
+                                 gridRegular_t     grid,
+                                 const filename_t  fileName)
+{
+	assert(async != NULL);
+	assert(grid != NULL);
+
+	if (!async->isAsync) {
+		local_writeGrid(async->writer, grid, fileName, true);
+		return;
+	}
+
+#ifdef ENABLE_ASYNC_IO
+	local_job_t *job = xmalloc(sizeof(local_job_t));
+
+	prof_start("writeQueue");
+	job->numBytes = local_getNumBytes(grid);
+
+	// Reserve the staging memory first, so that the budget also covers
+	// the copy that is about to be made.
+	pthread_mutex_lock(&(async->lock));
+	while ((async->numPending > 0)
+	       && (async->bytesPending + job->numBytes > async->maxBytes))
+		pthread_cond_wait(&(async->cond), &(async->lock));
+	async->numPending++;
+	async->bytesPending += job->numBytes;
+	pthread_mutex_unlock(&(async->lock));
+
+	job->grid     = local_snapshotGrid(grid);
+	job->fileName = (fileName == NULL) ? NULL : filename_clone(fileName);
+
+	pthread_mutex_lock(&(async->lock));
+	(void)varArr_insert(async->jobs, job);
+	pthread_cond_broadcast(&(async->cond));
+	pthread_mutex_unlock(&(async->lock));
+	prof_stop("writeQueue");
+#endif
+}
+
+extern void
+gridWriterAsync_flush(gridWriterAsync_t async)
+{
+	assert(async != NULL);
+
+	if (!async->isAsync)
+		return;
+
+#ifdef ENABLE_ASYNC_IO
+	prof_start("writeFlush");
+	pthread_mutex_lock(&(async->lock));
+	while (async->numPending > 0)
+		pthread_cond_wait(&(async->cond), &(async->lock));
+	pthread_mutex_unlock(&(async->lock));
+	prof_stop("writeFlush");
+#endif
+}
+
+extern bool
+gridWriterAsync_isAsync(const gridWriterAsync_t async)
+{
+	assert(async != NULL);
+
+	return async->isAsync;
+}
+
+/*--- Implementations of local functions --------------------------------*/
+static void
+local_writeGrid(gridWriter_t     writer,
+                gridRegular_t    grid,
+                const filename_t fileName,
+                bool             useProf)
+{
+	if (fileName != NULL)
+		gridWriter_overlayFileName(writer, fileName);
+	gridWriter_activate(writer);
+	// The profiler is not thread-safe, the IO thread calls the
+	// implementation directly.
+	if (useProf)
+		gridWriter_writeGridRegular(writer, grid);
+	else
+		writer->func->writeGridRegular(writer, grid);
+	gridWriter_deactivate(writer);
+}
+
+#ifdef ENABLE_ASYNC_IO
+static uint64_t
+local_getNumBytes(gridRegular_t grid)
+{
+	uint64_t numBytes = 0;
+
+	for (int p = 0; p < gridRegular_getNumPatches(grid); p++) {
+		gridPatch_t patch = gridRegular_getPatchHandle(grid, p);
+		for (int i = 0; i < gridRegular_getNumVars(grid); i++) {
+			dataVar_t var = gridRegular_getVarHandle(grid, i);
+			numBytes += gridPatch_getNumCellsActual(patch, i)
+			            * dataVar_getSizePerElement(var);
+		}
+	}
+
+	return numBytes;
+}
+
+static gridRegular_t
+local_snapshotGrid(gridRegular_t grid)
+{
+	gridRegular_t copy = gridRegular_cloneWithoutData(grid);
+
+	for (int i = 0; i < gridRegular_getNumVars(grid); i++)
+		(void)gridRegular_attachVar(copy,
+		                            dataVar_clone(gridRegular_getVarHandle(
+		                                              grid, i)));
+
+	for (int p = 0; p < gridRegular_getNumPatches(grid); p++) {
+		gridPatch_t       patch = gridRegular_getPatchHandle(grid, p);
+		gridPatch_t       patchCopy;
+		gridPointUint32_t idxLo, idxHi, dims;
+
+		gridPatch_getIdxLo(patch, idxLo);
+		gridPatch_getDims(patch, dims);
+		for (int j = 0; j < NDIM; j++)
+			idxHi[j] = idxLo[j] + dims[j] - 1;
+		patchCopy = gridPatch_new(idxLo, idxHi);
+		(void)gridRegular_attachPatch(copy, patchCopy);
+
+		for (int i = 0; i < gridRegular_getNumVars(grid); i++) {
+			size_t numBytes = gridPatch_getNumCellsActual(patch, i)
+			                  * dataVar_getSizePerElement(
+			    gridRegular_getVarHandle(grid, i));
+			memcpy(gridPatch_getVarDataHandle(patchCopy, i),
+			       gridPatch_getVarDataHandle(patch, i),
+			       numBytes);
+		}
+	}
+
+	return copy;
+}
+
+static void *
+local_ioThread(void *arg)
+{
+	gridWriterAsync_t async = (gridWriterAsync_t)arg;
+	local_job_t       *job;
+
+	pthread_mutex_lock(&(async->lock));
+	while (true) {
+		while ((varArr_getLength(async->jobs) == 0)
+		       && !async->isShuttingDown)
+			pthread_cond_wait(&(async->cond), &(async->lock));
+		if (varArr_getLength(async->jobs) == 0)
+			break;
+		job = varArr_remove(async->jobs, 0);
+		pthread_mutex_unlock(&(async->lock));
+
+		local_writeGrid(async->writer, job->grid, job->fileName, false);
+		gridRegular_del(&(job->grid));
+		if (job->fileName != NULL)
+			filename_del(&(job->fileName));
+
+		pthread_mutex_lock(&(async->lock));
+		async->numPending--;
+		async->bytesPending -= job->numBytes;
+		pthread_cond_broadcast(&(async->cond));
+		xfree(job);
+	}
+	pthread_mutex_unlock(&(async->lock));
+
+	return NULL;
+}
+
+#endif
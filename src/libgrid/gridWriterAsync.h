@@ -0,0 +1,157 @@
+// Copyright (C) 2013, Steffen Knollmann
+// Released under the terms of the GNU General Public License version 3.
+// This file is part of `ginnungagap'.
+
+#ifndef GRIDWRITERASYNC_H
+#define GRIDWRITERASYNC_H
+
+
+/*--- Doxygen file description ------------------------------------------*/
+
+/**
+ * @file libgrid/gridWriterAsync.h
+ * @ingroup libgridIOOut
+ * @brief  This file provides the interface to a writer that writes grids
+ *         in the background.
+ *
+ * The asynchronous writer sits on top of a normal grid writer.  Every grid
+ * that is handed to it is copied into a staging buffer and the copy is
+ * written by a dedicated IO thread, while the caller is free to modify the
+ * original grid again.  The staging buffers are limited to a given number
+ * of bytes; if this budget is exhausted, submitting a grid blocks until
+ * enough earlier writes have finished.
+ *
+ * If the code has been compiled without #ENABLE_ASYNC_IO, or the budget is
+ * 0, or (with MPI) the MPI library does not provide
+ * @c MPI_THREAD_MULTIPLE, the grids are written synchronously instead.
+ */
+
+
+/*--- Includes ----------------------------------------------------------*/
+#include "gridConfig.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include "gridWriter.h"
+#include "gridRegular.h"
+#include "../libutil/filename.h"
+
+
+/*--- ADT handle --------------------------------------------------------*/
+
+/** @brief  Defines the handle for an asynchronous grid writer. */
+typedef struct gridWriterAsync_struct *gridWriterAsync_t;
+
+
+/*--- Prototypes of exported functions ----------------------------------*/
+
+/**
+ * @name  Creating and Deleting
+ *
+ * @{
+ */
+
+/**
+ * @brief  Creates a new asynchronous writer on top of a grid writer.
+ *
+ * @param[in,out]  writer
+ *                    The writer that does the actual writing.  The
+ *                    asynchronous writer does not take ownership of it,
+ *                    but the writer may not be used otherwise until the
+ *                    asynchronous writer has been deleted.  With MPI, the
+ *                    writer should have been initialised with a
+ *                    communicator that is not used by anything else (see
+ *                    gridWriter_initParallel()), as the communication will
+ *                    happen from the IO thread.
+ * @param[in]      maxBytes
+ *                    The maximum number of bytes that may be held in
+ *                    staging buffers at any time.  A single grid larger
+ *                    than this is still accepted when no other write is
+ *                    pending.  Passing 0 selects synchronous writing.
+ *
+ * @return  Returns a new asynchronous writer.
+ */
+extern gridWriterAsync_t
+gridWriterAsync_new(gridWriter_t writer, uint64_t maxBytes);
+
+
+/**
+ * @brief  Deletes an asynchronous writer.
+ *
+ * This will finish all pending writes first.  The underlying writer is
+ * not deleted.
+ *
+ * @param[in,out]  *async
+ *                    A pointer to the variable holding the writer, will be
+ *                    set to @c NULL.
+ *
+ * @return  Returns nothing.
+ */
+extern void
+gridWriterAsync_del(gridWriterAsync_t *async);
+
+
+/** @} */
+
+/**
+ * @name  Using
+ *
+ * @{
+ */
+
+/**
+ * @brief  Writes a grid.
+ *
+ * The writer is activated, the grid is written and the writer is
+ * deactivated again.  When writing asynchronously, this returns as soon as
+ * the grid has been copied to the staging buffer.  All ranks must submit
+ * the same sequence of grids.
+ *
+ * @param[in,out]  async
+ *                    The writer to use.
+ * @param[in]      grid
+ *                    The grid to write.  The data, the names of the
+ *                    variables and the patches are captured at the time
+ *                    of the call.
+ * @param[in]      fileName
+ *                    Optional file name that is overlaid onto the file
+ *                    name of the writer before the grid is written (see
+ *                    gridWriter_overlayFileName()).  May be @c NULL.  The
+ *                    caller keeps ownership.
+ *
+ * @return  Returns nothing.
+ */
+extern void
+gridWriterAsync_writeGridRegular(gridWriterAsync_t async,
+                                 gridRegular_t     grid,
+                                 const filename_t  fileName);
+
+
+/**
+ * @brief  Waits until all pending writes have finished.
+ *
+ * @param[in,out]  async
+ *                    The writer to flush.
+ *
+ * @return  Returns nothing.
+ */
+extern void
+gridWriterAsync_flush(gridWriterAsync_t async);
+
+
+/**
+ * @brief  Checks whether the writer writes in the background.
+ *
+ * @param[in]  async
+ *                The writer to query.
+ *
+ * @return  Returns @c true if the grids are written by an IO thread and
+ *          @c false if they are written synchronously.
+ */
+extern bool
+gridWriterAsync_isAsync(const gridWriterAsync_t async);
+
+
+/** @} */
+
+
+#endif
@@ -0,0 +1,59 @@
+// Copyright (C) 2013, Steffen Knollmann
+// Released under the terms of the GNU General Public License version 3.
+// This file is part of `ginnungagap'.
+
+#ifndef GRIDWRITERASYNC_ADT_H
+#define GRIDWRITERASYNC_ADT_H
+
+
+/*--- Doxygen file description ------------------------------------------*/
+
+/**
+ * @file libgrid/gridWriterAsync_adt.h
+ * @ingroup libgridIOOut
+ * @brief  This file provides the main structure of the asynchronous grid
+ *         writer.
+ */
+
+
+/*--- Includes ----------------------------------------------------------*/
+#include "gridConfig.h"
+#include <stdint.h>
+#include <stdbool.h>
+#ifdef ENABLE_ASYNC_IO
+#  include <pthread.h>
+#endif
+#include "gridWriter.h"
+#include "../libutil/varArr.h"
+
+
+/*--- ADT implementation ------------------------------------------------*/
+
+/** @brief  The main structure of the asynchronous grid writer. */
+struct gridWriterAsync_struct {
+	/** @brief  The writer doing the actual work (not owned). */
+	gridWriter_t    writer;
+	/** @brief  The maximum number of bytes held in staging buffers. */
+	uint64_t        maxBytes;
+	/** @brief  Whether the grids are written by the IO thread. */
+	bool            isAsync;
+#ifdef ENABLE_ASYNC_IO
+	/** @brief  The IO thread. */
+	pthread_t       thread;
+	/** @brief  Protects all fields below. */
+	pthread_mutex_t lock;
+	/** @brief  Signals any change of the queue or the counters. */
+	pthread_cond_t  cond;
+	/** @brief  The queued jobs, oldest first. */
+	varArr_t        jobs;
+	/** @brief  The number of jobs that are queued or being written. */
+	int             numPending;
+	/** @brief  The number of bytes held by the pending jobs. */
+	uint64_t        bytesPending;
+	/** @brief  Tells the IO thread to exit once the queue is empty. */
+	bool            isShuttingDown;
+#endif
+};
+
+
+#endif
@@ -0,0 +1,331 @@
+// Copyright (C) 2013, Steffen Knollmann
+// Released under the terms of the GNU General Public License version 3.
+// This file is part of `ginnungagap'.
+
+
+/*--- Doxygen file description ------------------------------------------*/
+
+/**
+ * @file libgrid/gridWriterAsync_tests.c
+ * @ingroup libgridIOOut
+ * @brief  This file implements the test functions for the asynchronous
+ *         grid writer.
+ */
+
+
+/*--- Includes ----------------------------------------------------------*/
+#include "gridConfig.h"
+#include "gridWriterAsync_tests.h"
+#include "gridWriterAsync.h"
+#include <stdio.h>
+#include <string.h>
+#ifdef WITH_MPI
+#  include <mpi.h>
+#endif
+#include "gridPatch.h"
+#include "gridRegular.h"
+#include "../libdata/dataVar.h"
+#include "../libutil/xmem.h"
+
+
+/*--- Implemention of main structure ------------------------------------*/
+#include "gridWriterAsync_adt.h"
+#include "gridWriter_adt.h"
+
+
+/*--- Local defines -----------------------------------------------------*/
+#define LOCAL_MAXWRITES 4
+
+
+/*--- Local structures --------------------------------------------------*/
+
+/** @brief  A writer that only records what it has been given. */
+struct local_fakeWriter_struct {
+	/** @brief  The base structure. */
+	struct gridWriter_struct base;
+	/** @brief  The number of grids written. */
+	int                      numWrites;
+	/** @brief  The sum of the first variable of each grid. */
+	double                   sums[LOCAL_MAXWRITES];
+	/** @brief  The name of the first variable of each grid. */
+	char                     names[LOCAL_MAXWRITES][16];
+	/** @brief  The qualifier of the file name for each grid. */
+	char                     qualifiers[LOCAL_MAXWRITES][16];
+};
+
+/** @brief  Short name for the fake writer. */
+typedef struct local_fakeWriter_struct *local_fakeWriter_t;
+
+
+/*--- Prototypes of local functions -------------------------------------*/
+static gridWriter_t
+local_newFakeWriter(void);
+
+static void
+local_fakeDel(gridWriter_t *writer);
+
+static void
+local_fakeActivate(gridWriter_t writer);
+
+static void
+local_fakeDeactivate(gridWriter_t writer);
+
+static void
+local_fakeWriteGridRegular(gridWriter_t writer, gridRegular_t grid);
+
+static gridRegular_t
+local_getFakeGrid(void);
+
+
+/*--- Local variables ---------------------------------------------------*/
+
+/** @brief  The function table of the fake writer. */
+static struct gridWriter_func_struct local_fakeFunc
+    = {.del              = &local_fakeDel,
+       .activate         = &local_fakeActivate,
+       .deactivate       = &local_fakeDeactivate,
+       .writeGridPatch   = NULL,
+       .writeGridRegular = &local_fakeWriteGridRegular};
+
+
+/*--- Implementations of exported functios ------------------------------*/
+extern bool
+gridWriterAsync_new_test(void)
+{
+	bool              hasPassed = true;
+	int               rank      = 0;
+	gridWriter_t      writer;
+	gridWriterAsync_t async;
+#ifdef XMEM_TRACK_MEM
+	size_t            allocatedBytes = global_allocated_bytes;
+#endif
+#ifdef WITH_MPI
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+#endif
+
+	if (rank == 0)
+		printf("Testing %s... ", __func__);
+
+	writer = local_newFakeWriter();
+	async  = gridWriterAsync_new(writer, 0);
+	if (async->writer != writer)
+		hasPassed = false;
+	if (gridWriterAsync_isAsync(async))
+		hasPassed = false;
+	gridWriterAsync_del(&async);
+
+	async = gridWriterAsync_new(writer, 1024);
+	if (async->maxBytes != 1024)
+		hasPassed = false;
+#ifndef ENABLE_ASYNC_IO
+	if (gridWriterAsync_isAsync(async))
+		hasPassed = false;
+#endif
+	gridWriterAsync_del(&async);
+	gridWriter_del(&writer);
+#ifdef XMEM_TRACK_MEM
+	if (allocatedBytes != global_allocated_bytes)
+		hasPassed = false;
+#endif
+
+	return hasPassed ? true : false;
+}
+
+extern bool
+gridWriterAsync_del_test(void)
+{
+	bool              hasPassed = true;
+	int               rank      = 0;
+	gridWriter_t      writer;
+	gridWriterAsync_t async;
+#ifdef XMEM_TRACK_MEM
+	size_t            allocatedBytes = global_allocated_bytes;
+#endif
+#ifdef WITH_MPI
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+#endif
+
+	if (rank == 0)
+		printf("Testing %s... ", __func__);
+
+	writer = local_newFakeWriter();
+	async  = gridWriterAsync_new(writer, 1024);
+	gridWriterAsync_del(&async);
+	if (async != NULL)
+		hasPassed = false;
+	if (writer == NULL)
+		hasPassed = false;
+	gridWriter_del(&writer);
+#ifdef XMEM_TRACK_MEM
+	if (allocatedBytes != global_allocated_bytes)
+		hasPassed = false;
+#endif
+
+	return hasPassed ? true : false;
+}
+
+extern bool
+gridWriterAsync_writeGridRegular_test(void)
+{
+	bool               hasPassed = true;
+	int                rank      = 0;
+	gridWriter_t       writer;
+	gridWriterAsync_t  async;
+	gridRegular_t      grid;
+	gridPatch_t        patch;
+	fpv_t              *data;
+	uint64_t           numCells;
+	filename_t         fn;
+	local_fakeWriter_t fake;
+#ifdef XMEM_TRACK_MEM
+	size_t             allocatedBytes = global_allocated_bytes;
+#endif
+#ifdef WITH_MPI
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+#endif
+
+	if (rank == 0)
+		printf("Testing %s... ", __func__);
+
+	writer   = local_newFakeWriter();
+	fake     = (local_fakeWriter_t)writer;
+	grid     = local_getFakeGrid();
+	patch    = gridRegular_getPatchHandle(grid, 0);
+	data     = gridPatch_getVarDataHandle(patch, 0);
+	numCells = gridPatch_getNumCellsActual(patch, 0);
+	fn       = filename_new();
+
+	// A budget of a single byte forces every submission to wait for the
+	// previous write, the grid itself must still be accepted.
+	async = gridWriterAsync_new(writer, 1);
+	filename_setQualifier(fn, "_a");
+	gridWriterAsync_writeGridRegular(async, grid, fn);
+
+	// The changes must not be visible in the grids already submitted.
+	for (uint64_t i = 0; i < numCells; i++)
+		data[i] = 2.;
+	dataVar_rename(gridRegular_getVarHandle(grid, 0), "changed");
+	filename_setQualifier(fn, "_b");
+	gridWriterAsync_writeGridRegular(async, grid, fn);
+	gridWriterAsync_writeGridRegular(async, grid, NULL);
+	gridWriterAsync_flush(async);
+
+	if (fake->numWrites != 3)
+		hasPassed = false;
+	if (fake->sums[0] != (double)numCells)
+		hasPassed = false;
+	if ((fake->sums[1] != 2. * numCells) || (fake->sums[2] != 2. * numCells))
+		hasPassed = false;
+	if ((strcmp(fake->names[0], "test") != 0)
+	    || (strcmp(fake->names[1], "changed") != 0))
+		hasPassed = false;
+	if ((strcmp(fake->qualifiers[0], "_a") != 0)
+	    || (strcmp(fake->qualifiers[1], "_b") != 0)
+	    || (strcmp(fake->qualifiers[2], "_b") != 0))
+		hasPassed = false;
+	if (gridWriter_isActive(writer))
+		hasPassed = false;
+
+	gridWriterAsync_del(&async);
+	filename_del(&fn);
+	gridRegular_del(&grid);
+	gridWriter_del(&writer);
+#ifdef XMEM_TRACK_MEM
+	if (allocatedBytes != global_allocated_bytes)
+		hasPassed = false;
+#endif
+
+	return hasPassed ? true : false;
+} /* gridWriterAsync_writeGridRegular_test */
+
+/*--- Implementations of local functions --------------------------------*/
+static gridWriter_t
+local_newFakeWriter(void)
+{
+	local_fakeWriter_t fake;
+
+	fake = xmalloc(sizeof(struct local_fakeWriter_struct));
+	gridWriter_init((gridWriter_t)fake, GRIDIO_TYPE_UNKNOWN,
+	                &local_fakeFunc);
+	fake->base.fileName = filename_new();
+	fake->numWrites     = 0;
+
+	return (gridWriter_t)fake;
+}
+
+static void
+local_fakeDel(gridWriter_t *writer)
+{
+	gridWriter_free(*writer);
+	xfree(*writer);
+	*writer = NULL;
+}
+
+static void
+local_fakeActivate(gridWriter_t writer)
+{
+	gridWriter_setIsActive(writer);
+}
+
+static void
+local_fakeDeactivate(gridWriter_t writer)
+{
+	gridWriter_setIsInactive(writer);
+}
+
+static void
+local_fakeWriteGridRegular(gridWriter_t writer, gridRegular_t grid)
+{
+	local_fakeWriter_t fake  = (local_fakeWriter_t)writer;
+	gridPatch_t        patch = gridRegular_getPatchHandle(grid, 0);
+	fpv_t              *data = gridPatch_getVarDataHandle(patch, 0);
+	uint64_t           numCells;
+	double             sum   = 0.0;
+	int                pos   = fake->numWrites;
+
+	if (pos >= LOCAL_MAXWRITES)
+		return;
+
+	numCells = gridPatch_getNumCellsActual(patch, 0);
+	for (uint64_t i = 0; i < numCells; i++)
+		sum += data[i];
+	fake->sums[pos] = sum;
+	strncpy(fake->names[pos],
+	        dataVar_getName(gridRegular_getVarHandle(grid, 0)), 15);
+	fake->names[pos][15] = '\0';
+	strncpy(fake->qualifiers[pos],
+	        filename_getQualifier(writer->fileName), 15);
+	fake->qualifiers[pos][15] = '\0';
+	fake->numWrites++;
+}
+
+static gridRegular_t
+local_getFakeGrid(void)
+{
+	gridRegular_t     grid;
+	gridPatch_t       patch;
+	gridPointDbl_t    origin;
+	gridPointDbl_t    extent;
+	gridPointUint32_t dims, idxLo, idxHi;
+	fpv_t             *data;
+	uint64_t          numCells;
+
+	for (int i = 0; i < NDIM; i++) {
+		origin[i] = 0.0;
+		extent[i] = 1.0;
+		dims[i]   = 8;
+		idxLo[i]  = 0;
+		idxHi[i]  = dims[i] - 1;
+	}
+	grid  = gridRegular_new("test", origin, extent, dims);
+	gridRegular_attachVar(grid, dataVar_new("test", DATAVARTYPE_FPV, 1));
+	patch = gridPatch_new(idxLo, idxHi);
+	gridRegular_attachPatch(grid, patch);
+
+	data     = gridPatch_getVarDataHandle(patch, 0);
+	numCells = gridPatch_getNumCellsActual(patch, 0);
+	for (uint64_t i = 0; i < numCells; i++)
+		data[i] = 1.;
+
+	return grid;
+}
@@ -0,0 +1,35 @@
+// Copyright (C) 2013, Steffen Knollmann
+// Released under the terms of the GNU General Public License version 3.
+// This file is part of `ginnungagap'.
+
+#ifndef GRIDWRITERASYNC_TESTS_H
+#define GRIDWRITERASYNC_TESTS_H
+
+
+/*--- Doxygen file description ------------------------------------------*/
+
+/**
+ * @file libgrid/gridWriterAsync_tests.h
+ * @ingroup libgridIOOut
+ * @brief  This file provides the test functions for the asynchronous grid
+ *         writer.
+ */
+
+
+/*--- Includes ----------------------------------------------------------*/
+#include "gridConfig.h"
+#include <stdbool.h>
+
+
+/*--- Prototypes of exported functions ----------------------------------*/
+extern bool
+gridWriterAsync_new_test(void);
+
+extern bool
+gridWriterAsync_del_test(void);
+
+extern bool
+gridWriterAsync_writeGridRegular_test(void);
+
+
+#endif
@@ -163,6 +163,7 @@ gridWriterFactory_newFromIniHDF5(parse_ini_t ini, const char *sectionName)
 
 	gridWriterHDF5_t writer;
 	bool             tmp, doChunking, doChecksum, doCompression, doPatch;
+	double           quantiseTolerance;
 
 
 	writer = gridWriterHDF5_new();
@@ -199,6 +200,15 @@ gridWriterFactory_newFromIniHDF5(parse_ini_t ini, const char *sectionName)
 		local_doPatch(ini, sectionName, writer);
 	}
 
+	if (parse_ini_get_double(ini, "quantiseTolerance", sectionName,
+	                         &quantiseTolerance)) {
+		if (quantiseTolerance < 0.0) {
+			fprintf(stderr, "quantiseTolerance in section %s must not be "
+			        "negative.\n", sectionName);
+			diediedie(EXIT_FAILURE);
+		}
+		gridWriterHDF5_setQuantiseTolerance(writer, quantiseTolerance);
+	}
 
 	return (gridWriter_t)writer;
 } /* gridWriterFactory_newFromIniHDF5 */
@@ -290,6 +290,9 @@ local_getGraficTypeFromGridType(const dataVar_t var)
 	case DATAVARTYPE_DOUBLE:
 		varType = GRAFIC_FORMAT_DOUBLE;
 		break;
+	case DATAVARTYPE_FLOAT:
+		varType = GRAFIC_FORMAT_FLOAT;
+		break;
 	case DATAVARTYPE_FPV:
 		varType = sizeof(fpv_t) == 4 ?
 		          GRAFIC_FORMAT_FLOAT : GRAFIC_FORMAT_DOUBLE;
@@ -24,6 +24,7 @@
 #include "gridPatch.h"
 #include "gridRegular.h"
 #include "gridPoint.h"
+#include "gridQuantise.h"
 #include "gridUtilHDF5.h"
 #include "../libutil/xmem.h"
 #include "../libutil/xstring.h"
@@ -117,17 +118,90 @@ local_getAccessPropsFileAccessMPI(MPI_Comm comm);
 static hid_t
 local_getDSCreationPropList(const gridWriterHDF5_t writer);
 
+/**
+ * @brief  Creates the quantiser for a variable.
+ *
+ * @param[in]  writer
+ *                The writer holding the tolerance of the quantisation.
+ * @param[in]  var
+ *                The variable that should be written.
+ *
+ * @return  Returns a new quantiser or @c NULL if the variable should not
+ *          be quantised.
+ */
+static gridQuantise_t
+local_newQuantise(const gridWriterHDF5_t writer, dataVar_t var);
+
+/**
+ * @brief  Derives the quantisation from the data seen by all processes.
+ *
+ * @param[in]      writer
+ *                    The writer holding the communicator.
+ * @param[in,out]  *quantise
+ *                    The quantiser to prepare.  If the data cannot be
+ *                    quantised, it is deleted and set to @c NULL.
+ * @param[in]      var
+ *                    The variable that should be written.
+ *
+ * @return  Returns nothing.
+ */
+static void
+local_prepareQuantise(const gridWriterHDF5_t writer,
+                      gridQuantise_t         *quantise,
+                      dataVar_t              var);
+
+/**
+ * @brief  Gives the HDF5 datatype of the quantised values.
+ *
+ * @param[in]  quantise
+ *                The prepared quantiser.
+ * @param[in]  inMemory
+ *                Selects the native type (for the memory) or the standard
+ *                type (for the file).
+ *
+ * @return  Returns the datatype, it must not be closed.
+ */
+static hid_t
+local_getQuantisedDatatype(const gridQuantise_t quantise, bool inMemory);
+
+/**
+ * @brief  Creates the dataset for a variable.
+ *
+ * @param[in]  writer
+ *                The writer to create the dataset with.
+ * @param[in]  var
+ *                The variable that should be written.
+ * @param[in]  quantise
+ *                The quantiser of the variable, may be @c NULL.
+ * @param[in]  space
+ *                The data space of the dataset.
+ * @param[in]  dsCreationPropList
+ *                The creation property list of the dataset.
+ *
+ * @return  Returns the new dataset.
+ */
+static hid_t
+local_createDataSet(const gridWriterHDF5_t writer,
+                    dataVar_t              var,
+                    const gridQuantise_t   quantise,
+                    hid_t                  space,
+                    hid_t                  dsCreationPropList);
+
 /**
  * @brief  Helper function to write the data of a variable at a given patch.
  *
  * @param[in]  var
  *                The variable that should be written.
+ * @param[in]  quantise
+ *                The quantiser of the variable, if not @c NULL the data is
+ *                encoded before writing.
  * @param[in]  patch
  *                The patch that should be written.
  * @param[in]  dataSet
  *                The HDF5 dataset to work with.
  * @param[in]  dt
- *                The HDF5 datatype corresponding to the variable.
+ *                The HDF5 datatype corresponding to the variable (or to the
+ *                quantised values).
  * @param[in]  gridSize
  *                The extent of the grid that should be written.  Note that
  *                the patch may be smaller.
@@ -135,11 +209,12 @@ local_getDSCreationPropList(const gridWriterHDF5_t writer);
  * @return  Returns nothing.
  */
 inline static void
-local_writeVariableAtPatch(dataVar_t   var,
-                           gridPatch_t patch,
-                           hid_t       dataSet,
-                           hid_t       dt,
-                           hid_t       gridSize);
+local_writeVariableAtPatch(dataVar_t            var,
+                           const gridQuantise_t quantise,
+                           gridPatch_t          patch,
+                           hid_t                dataSet,
+                           hid_t                dt,
+                           hid_t                gridSize);
 
 
 /**
@@ -228,14 +303,25 @@ gridWriterHDF5_writeGridPatch(gridWriter_t   writer,
 	dsCreationPropList = local_getDSCreationPropList(w);
 
 	for (int i = 0; i < numVars; i++) {
-		dataVar_t var = gridPatch_getVarHandle(patch, i);
-		hid_t     dt  = dataVar_getHDF5Datatype(var);
-		hid_t     dataSet = H5Dcreate(w->fileHandle, dataVar_getName(var),
-		                              dt, patchSize, H5P_DEFAULT,
-		                              dsCreationPropList,
-		                              H5P_DEFAULT);
-		local_writeVariableAtPatch(var, patch, dataSet, dt, patchSize);
+		dataVar_t      var   = gridPatch_getVarHandle(patch, i);
+		gridQuantise_t quant = local_newQuantise(w, var);
+		hid_t          dt, dataSet;
+
+		if (quant != NULL) {
+			gridQuantise_addData(quant, var,
+			                     gridPatch_getVarDataHandleByVar(patch, var),
+			                     gridPatch_getNumCells(patch));
+			local_prepareQuantise(w, &quant, var);
+		}
+		dt = (quant != NULL) ? local_getQuantisedDatatype(quant, true)
+		     : dataVar_getHDF5Datatype(var);
+		dataSet = local_createDataSet(w, var, quant, patchSize,
+		                              dsCreationPropList);
+		local_writeVariableAtPatch(var, quant, patch, dataSet, dt,
+		                           patchSize);
 		H5Dclose(dataSet);
+		if (quant != NULL)
+			gridQuantise_del(&quant);
 	}
 }
 
@@ -378,6 +464,15 @@ gridWriterHDF5_setRtw(gridWriterHDF5_t w, int32_t* Lo, gridPointUint32_t d)
 	}
 }
 
+extern void
+gridWriterHDF5_setQuantiseTolerance(gridWriterHDF5_t w, double tolerance)
+{
+	assert(w != NULL);
+	assert(tolerance >= 0.0);
+
+	w->quantiseTolerance = tolerance;
+}
+
 
 /*--- Implementations of protected functions ----------------------------*/
 extern gridWriterHDF5_t
@@ -413,6 +508,7 @@ gridWriterHDF5_init(gridWriterHDF5_t writer)
 	writer->doCompression     = false;
 	writer->compressionFilter = H5I_INVALID_HID;
 	writer->doPatch			  = false;
+	writer->quantiseTolerance = 0.0;
 }
 
 extern void
@@ -539,6 +635,10 @@ local_writeGridRtw(gridWriter_t  writer,
 	for(int k = 0; k<NDIM; k++) 
 		rtwHi[k] = w->rtwLo[k]+w->rtwDims[k]-1;
 
+	if (w->quantiseTolerance > 0.0)
+		fprintf(stderr, "WARNING: Quantisation is not supported when "
+		        "writing a region, writing the data as it is.\n");
+
 	numVars    = gridRegular_getNumVars(grid);
 	numPatches = gridRegular_getNumPatches(grid);
 
@@ -667,18 +767,33 @@ local_writeGridRegular(gridWriter_t  writer,
 	dsCreationPropList = local_getDSCreationPropList(w);
 
 	for (int i = 0; i < numVars; i++) {
-		dataVar_t var     = gridRegular_getVarHandle(grid, i);
-		hid_t     dt      = dataVar_getHDF5Datatype(var);
-		hid_t     dataSet = H5Dcreate(w->fileHandle, dataVar_getName(var),
-		                              dt, gridSize, H5P_DEFAULT,
-		                              dsCreationPropList,
-		                              H5P_DEFAULT);
+		dataVar_t      var   = gridRegular_getVarHandle(grid, i);
+		gridQuantise_t quant = local_newQuantise(w, var);
+		hid_t          dt, dataSet;
+
+		if (quant != NULL) {
+			for (int j = 0; j < numPatches; j++) {
+				gridPatch_t patch = gridRegular_getPatchHandle(grid, j);
+				gridQuantise_addData(quant, var,
+				                     gridPatch_getVarDataHandleByVar(patch,
+				                                                     var),
+				                     gridPatch_getNumCells(patch));
+			}
+			local_prepareQuantise(w, &quant, var);
+		}
+		dt = (quant != NULL) ? local_getQuantisedDatatype(quant, true)
+		     : dataVar_getHDF5Datatype(var);
+		dataSet = local_createDataSet(w, var, quant, gridSize,
+		                              dsCreationPropList);
 		for (int j = 0; j < numPatches; j++) {
 			gridPatch_t patch = gridRegular_getPatchHandle(grid, j);
 			assert(w->fileHandle != H5I_INVALID_HID);
-			local_writeVariableAtPatch(var, patch, dataSet, dt, gridSize);
+			local_writeVariableAtPatch(var, quant, patch, dataSet, dt,
+			                           gridSize);
 		}
 		H5Dclose(dataSet);
+		if (quant != NULL)
+			gridQuantise_del(&quant);
 	}
 	H5Sclose(gridSize);
 }
@@ -769,18 +884,102 @@ local_getDSCreationPropList(const gridWriterHDF5_t writer)
 	return rtn;
 }
 
+static gridQuantise_t
+local_newQuantise(const gridWriterHDF5_t writer, dataVar_t var)
+{
+	if (!(writer->quantiseTolerance > 0.0))
+		return NULL;
+
+	if (!gridQuantise_isSupported(var)) {
+		fprintf(stderr, "WARNING: Cannot quantise %s, writing it as it is.\n",
+		        dataVar_getName(var));
+		return NULL;
+	}
+
+	return gridQuantise_new(writer->quantiseTolerance);
+}
+
+static void
+local_prepareQuantise(const gridWriterHDF5_t writer,
+                      gridQuantise_t         *quantise,
+                      dataVar_t              var)
+{
+#ifdef WITH_MPI
+	if (writer->mpiComm != MPI_COMM_NULL)
+		gridQuantise_reduce(*quantise, writer->mpiComm);
+#else
+	(void)writer;
+#endif
+
+	if (!gridQuantise_prepare(*quantise)) {
+		fprintf(stderr, "WARNING: The range of %s is too large to quantise, "
+		        "writing it as it is.\n", dataVar_getName(var));
+		gridQuantise_del(quantise);
+	}
+}
+
+static hid_t
+local_getQuantisedDatatype(const gridQuantise_t quantise, bool inMemory)
+{
+	switch (gridQuantise_getNumBytes(quantise)) {
+	case 1:
+		return inMemory ? H5T_NATIVE_INT8 : H5T_STD_I8LE;
+	case 2:
+		return inMemory ? H5T_NATIVE_INT16 : H5T_STD_I16LE;
+	default:
+		break;
+	}
+
+	return inMemory ? H5T_NATIVE_INT32 : H5T_STD_I32LE;
+}
+
+static hid_t
+local_createDataSet(const gridWriterHDF5_t writer,
+                    dataVar_t              var,
+                    const gridQuantise_t   quantise,
+                    hid_t                  space,
+                    hid_t                  dsCreationPropList)
+{
+	hid_t dt, dataSet;
+
+	dt = (quantise != NULL) ? local_getQuantisedDatatype(quantise, false)
+	     : dataVar_getHDF5Datatype(var);
+
+	dataSet = H5Dcreate(writer->fileHandle, dataVar_getName(var),
+	                    dt, space, H5P_DEFAULT, dsCreationPropList,
+	                    H5P_DEFAULT);
+	if (dataSet < 0)
+		diediedie(EXIT_FAILURE);
+
+	if (quantise != NULL) {
+		gridUtilHDF5_writeAttributeDouble(dataSet,
+		                                  GRIDUTILHDF5_QUANTISE_OFFSET,
+		                                  gridQuantise_getOffset(quantise));
+		gridUtilHDF5_writeAttributeDouble(dataSet,
+		                                  GRIDUTILHDF5_QUANTISE_STEP,
+		                                  gridQuantise_getStep(quantise));
+	}
+
+	return dataSet;
+}
+
 inline static void
-local_writeVariableAtPatch(dataVar_t   var,
-                           gridPatch_t patch,
-                           hid_t       dataSet,
-                           hid_t       dt,
-                           hid_t       gridSize)
+local_writeVariableAtPatch(dataVar_t            var,
+                           const gridQuantise_t quantise,
+                           gridPatch_t          patch,
+                           hid_t                dataSet,
+                           hid_t                dt,
+                           hid_t                gridSize)
 {
 	hid_t             transProps = H5P_DEFAULT;
 	gridPointUint32_t dimsPatch;
 	hid_t             dataSpacePatch, dataSpaceFile;
 	void              *data = gridPatch_getVarDataHandleByVar(patch, var);
 
+	if (quantise != NULL)
+		data = gridQuantise_encode(quantise, var, data,
+		                           gridPatch_getNumCells(patch));
+
 #ifdef WITH_MPI
 	transProps = H5Pcreate(H5P_DATASET_XFER);
 	assert(transProps >= 0);
@@ -806,6 +1005,8 @@ local_writeVariableAtPatch(dataVar_t   var,
 	H5Sclose(dataSpaceFile);
 	if (transProps != H5P_DEFAULT)
 		H5Pclose(transProps);
+	if (quantise != NULL)
+		xfree(data);
 } /* local_writeVariableAtPatch */
 
 inline static void
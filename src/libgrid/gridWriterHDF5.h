@@ -233,6 +233,30 @@ extern void
 gridWriterHDF5_setRtw(gridWriterHDF5_t w, int32_t *Lo, gridPointUint32_t d);
 
 
+/**
+ * @brief  This will activate the lossy quantisation of scalar floating
+ *         point variables.
+ *
+ * The values are stored as 1, 2 or 4 byte integers (whatever suffices for
+ * the range of the data) in steps of twice the tolerance, so that no value
+ * differs from the original by more than the tolerance.  Offset and step
+ * are attached to the dataset as the attributes @c quantiseOffset and
+ * @c quantiseStep, the HDF5 reader decodes such datasets transparently.
+ * Variables that cannot be quantised, and all variables when writing only
+ * a region, are written as they are.
+ *
+ * @param[in]  w
+ *                The writer for which to work with.
+ * @param[in]  tolerance
+ *                The largest allowed error in units of the standard
+ *                deviation of the variable, 0 disables the quantisation.
+ *
+ * *@return  Returns nothing.
+ */
+extern void
+gridWriterHDF5_setQuantiseTolerance(gridWriterHDF5_t w, double tolerance);
+
+
 /** @} */
 
 
@@ -247,6 +271,9 @@ gridWriterHDF5_setRtw(gridWriterHDF5_t w, int32_t *Lo, gridPointUint32_t d);
  *
  * @code
  * [SectionName]
+ * # Optional, store scalar floating point variables as integers with an
+ * # error of at most quantiseTolerance times their standard deviation.
+ * quantiseTolerance = 0.01
  * @endcode
  */
 
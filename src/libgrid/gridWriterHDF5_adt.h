@@ -53,6 +53,11 @@ struct gridWriterHDF5_struct {
 	int32_t	 rtwLo[3];
 	/** @brief	Gives region to write dims. */
 	gridPointUint32_t	 rtwDims;
+	/**
+	 * @brief  The tolerance of the quantisation in units of the standard
+	 *         deviation, 0 disables the quantisation.
+	 */
+	double       quantiseTolerance;
 	 
 };
 
@@ -18,6 +18,7 @@
 #include "gridWriterHDF5.h"
 #include <stdio.h>
 #include <string.h>
+#include <math.h>
 #include <assert.h>
 #ifdef WITH_MPI
 #  include <mpi.h>
@@ -28,6 +29,7 @@
 #include "gridRegular.h"
 #include "gridRegularDistrib.h"
 #include "gridPatch.h"
+#include "gridReaderHDF5.h"
 #include "../libdata/dataVar.h"
 
 
@@ -173,6 +175,92 @@ gridWriterHDF5_writeGridRegular_test(void)
 	return hasPassed ? true : false;
 } /* gridWriterHDF5_writeGridRegular_test */
 
+extern bool
+gridWriterHDF5_setQuantiseTolerance_test(void)
+{
+	bool              hasPassed = true;
+	int               rank      = 0;
+	gridWriterHDF5_t  writer;
+	gridRegular_t     grid;
+	gridReader_t      reader;
+	gridPatch_t       patch;
+	dataVar_t         var;
+	double            *data, maxError;
+	gridPointUint32_t idxLo = { 0, 0, 0 };
+	gridPointUint32_t idxHi = { 3, 7, 15 };
+	hid_t             file, dataSet, dataType;
+#ifdef XMEM_TRACK_MEM
+	size_t            allocatedBytes = global_allocated_bytes;
+#endif
+#ifdef WITH_MPI
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+#endif
+
+	if (rank == 0)
+		printf("Testing %s... ", __func__);
+
+	grid   = local_getFakeGrid();
+
+	writer = gridWriterHDF5_new();
+	gridWriter_setFileName((gridWriter_t)writer,
+	                       filename_newFull(NULL, "outGridQuantise", NULL,
+	                                        ".h5"));
+	gridWriter_setOverwriteFileIfExists((gridWriter_t)writer, true);
+	gridWriterHDF5_setQuantiseTolerance(writer, 0.01);
+	if (writer->quantiseTolerance != 0.01)
+		hasPassed = false;
+#ifdef WITH_MPI
+	gridWriterHDF5_initParallel((gridWriter_t)writer, MPI_COMM_WORLD);
+#endif
+	gridWriterHDF5_activate((gridWriter_t)writer);
+	gridWriterHDF5_writeGridRegular((gridWriter_t)writer, grid);
+	gridWriterHDF5_deactivate((gridWriter_t)writer);
+	gridWriterHDF5_del((gridWriter_t *)&writer);
+	gridRegular_del(&grid);
+#ifdef WITH_MPI
+	MPI_Barrier(MPI_COMM_WORLD);
+#endif
+
+	// The 512 cell indices have a standard deviation of about 147.8, a
+	// step of about 3 fits them into single bytes.
+	file     = H5Fopen("outGridQuantise.h5", H5F_ACC_RDONLY, H5P_DEFAULT);
+	dataSet  = H5Dopen(file, "FakeVar", H5P_DEFAULT);
+	dataType = H5Dget_type(dataSet);
+	if ((H5Tget_class(dataType) != H5T_INTEGER)
+	    || (H5Tget_size(dataType) != 1))
+		hasPassed = false;
+	H5Tclose(dataType);
+	H5Dclose(dataSet);
+	H5Fclose(file);
+
+	reader = (gridReader_t)gridReaderHDF5_new();
+	gridReaderHDF5_setDoPatch(reader, false);
+	gridReader_setFileName(reader,
+	                       filename_newFull(NULL, "outGridQuantise", NULL,
+	                                        ".h5"));
+	var   = dataVar_new("FakeVar", DATAVARTYPE_DOUBLE, 1);
+	patch = gridPatch_new(idxLo, idxHi);
+	gridPatch_attachVar(patch, var);
+	gridReader_readIntoPatchForVar(reader, patch, 0);
+	data = gridPatch_getVarDataHandle(patch, 0);
+
+	maxError = 0.01 * sqrt((512. * 512. - 1.) / 12.) * (1. + 1e-10);
+	for (uint64_t i = 0; i < 512; i++) {
+		if (fabs(data[i] - (double)i) > maxError)
+			hasPassed = false;
+	}
+
+	gridPatch_del(&patch);
+	dataVar_del(&var);
+	gridReader_del(&reader);
+#ifdef XMEM_TRACK_MEM
+	if (allocatedBytes != global_allocated_bytes)
+		hasPassed = false;
+#endif
+
+	return hasPassed ? true : false;
+} /* gridWriterHDF5_setQuantiseTolerance_test */
+
 /*--- Implementations of local functions --------------------------------*/
 static gridRegular_t
 local_getFakeGrid(void)
@@ -30,5 +30,8 @@ gridWriterHDF5_del_test(void);
 extern bool
 gridWriterHDF5_writeGridRegular_test(void);
 
+extern bool
+gridWriterHDF5_setQuantiseTolerance_test(void);
+
 
 #endif
@@ -752,6 +752,9 @@ local_getVarType(dataVar_t var)
 	case DATAVARTYPE_DOUBLE:
 		varType = DB_DOUBLE;
 		break;
+	case DATAVARTYPE_FLOAT:
+		varType = DB_FLOAT;
+		break;
 	case DATAVARTYPE_FPV:
 		varType = (sizeof(fpv_t) == 4 ? DB_FLOAT : DB_DOUBLE);
 		break;
@@ -15,6 +15,8 @@
 #include "gridReaderFactory_tests.h"
 #include "gridReader_tests.h"
 #include "gridReaderBov_tests.h"
+#include "gridWriterAsync_tests.h"
+#include "gridQuantise_tests.h"
 #ifdef WITH_HDF5
 #  include "gridWriterHDF5_tests.h"
 #  include "gridReaderHDF5_tests.h"
@@ -103,6 +105,7 @@ main(int argc, char **argv)
 	RUNTEST(&gridPatch_getNumVars_test, hasFailed);
 	RUNTEST(&gridPatch_transpose_test, hasFailed);
 	RUNTEST(&gridPatch_getWindowedDataCopy_test, hasFailed);
+	RUNTEST(&gridPatch_getWindowedData_test, hasFailed);
 	RUNTEST(&gridPatch_putWindowedData_test, hasFailed);
 	RUNTEST(&gridPatch_calcDistanceVector_test, hasFailed);
 #ifdef XMEM_TRACK_MEM
@@ -153,7 +156,13 @@ main(int argc, char **argv)
 	RUNTEST(&gridRegularDistrib_getLocalRank_test, hasFailed);
 	RUNTEST(&gridRegularDistrib_getPatchForRank_test, hasFailed);
 	RUNTEST(&gridRegularDistrib_calcIdxsForRank1D_test, hasFailed);
+	RUNTEST(&gridRegularDistrib_calcNProcsForDecomp_test, hasFailed);
 	RUNTEST(&gridRegularDistrib_transpose_test, hasFailed);
+	RUNTEST(&gridRegularDistrib_transposeStreamed_test, hasFailed);
+#ifdef WITH_MPI
+	RUNTEST(&gridRegularDistrib_transposeStreamedRounds_test, hasFailed);
+	RUNTEST(&gridRegularDistrib_transposePersistent_test, hasFailed);
+#endif
 #ifdef XMEM_TRACK_MEM
 	if (rank == 0)
 		xmem_info(stdout);
@@ -167,6 +176,10 @@ main(int argc, char **argv)
 	RUNTEST(&gridRegularFFT_del_test, hasFailed);
 	RUNTEST(&gridRegularFFT_getNorm_test, hasFailed);
 	RUNTEST(&gridRegularFFT_execute_test, hasFailed);
+	RUNTEST(&gridRegularFFT_newMany_test, hasFailed);
+#ifdef WITH_MPI
+	RUNTEST(&gridRegularFFT_executeOverlapped_test, hasFailed);
+#endif
 #ifdef XMEM_TRACK_MEM
 	if (rank == 0)
 		xmem_info(stdout);
@@ -253,6 +266,32 @@ main(int argc, char **argv)
 	global_max_allocated_bytes = 0;
 #endif
 
+	if (rank == 0) {
+		printf("\nRunning tests for gridWriterAsync:\n");
+	}
+	RUNTEST(&gridWriterAsync_new_test, hasFailed);
+	RUNTEST(&gridWriterAsync_del_test, hasFailed);
+	RUNTEST(&gridWriterAsync_writeGridRegular_test, hasFailed);
+#ifdef XMEM_TRACK_MEM
+	if (rank == 0)
+		xmem_info(stdout);
+	global_max_allocated_bytes = 0;
+#endif
+
+	if (rank == 0) {
+		printf("\nRunning tests for gridQuantise:\n");
+	}
+	RUNTEST(&gridQuantise_new_test, hasFailed);
+	RUNTEST(&gridQuantise_del_test, hasFailed);
+	RUNTEST(&gridQuantise_addData_test, hasFailed);
+	RUNTEST(&gridQuantise_prepare_test, hasFailed);
+	RUNTEST(&gridQuantise_encode_test, hasFailed);
+#ifdef XMEM_TRACK_MEM
+	if (rank == 0)
+		xmem_info(stdout);
+	global_max_allocated_bytes = 0;
+#endif
+
 
 #ifdef WITH_HDF5
 	if (rank == 0) {
@@ -267,6 +306,7 @@ main(int argc, char **argv)
 	//RUNTEST(&gridWriterHDF5_deactivate_test, hasFailed);
 	//RUNTEST(&gridWriterHDF5_writeGridPatch_test, hasFailed);
 	RUNTEST(&gridWriterHDF5_writeGridRegular_test, hasFailed);
+	RUNTEST(&gridWriterHDF5_setQuantiseTolerance_test, hasFailed);
 #  ifdef XMEM_TRACK_MEM
 	if (rank == 0)
 		xmem_info(stdout);
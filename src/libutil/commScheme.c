@@ -56,6 +56,43 @@ inline static void
 local_startSending(commScheme_t scheme);
 
 
+/**
+ * @brief  Finds the send buffer to start sending with.
+ *
+ * @param[in]  scheme
+ *                The communication scheme.
+ *
+ * @return  Returns the index of the first send buffer that goes to a
+ *          process with a higher rank, or 0 if there is none.
+ */
+inline static int
+local_getFirstSendBuf(const commScheme_t scheme);
+
+
+/**
+ * @brief  Creates the persistent requests of a scheme.
+ *
+ * @param[in,out]  scheme
+ *                    The persistent communication scheme.
+ *
+ * @return  Returns nothing.
+ */
+static void
+local_initPersistent(commScheme_t scheme);
+
+
+/**
+ * @brief  Restarts the persistent requests of a scheme.
+ *
+ * @param[in,out]  scheme
+ *                    The persistent communication scheme.
+ *
+ * @return  Returns nothing.
+ */
+static void
+local_startPersistent(commScheme_t scheme);
+
+
 /*--- Implementations of exported functions -----------------------------*/
 extern commScheme_t
 commScheme_new(MPI_Comm comm, int tag)
@@ -75,6 +112,17 @@ commScheme_new(MPI_Comm comm, int tag)
 	scheme->buffersSend  = varArr_new(scheme->size / 10);
 	scheme->requestsSend = NULL;
 	scheme->status       = COMMSCHEME_STATUS_PREFIRE;
+	scheme->isPersistent = false;
+
+	return scheme;
+}
+
+extern commScheme_t
+commScheme_newPersistent(MPI_Comm comm, int tag)
+{
+	commScheme_t scheme = commScheme_new(comm, tag);
+
+	scheme->isPersistent = true;
 
 	return scheme;
 }
@@ -87,6 +135,16 @@ commScheme_del(commScheme_t *scheme)
 	if ((*scheme)->status == COMMSCHEME_STATUS_FIRING)
 		commScheme_wait(*scheme);
 
+	if ((*scheme)->isPersistent
+	    && ((*scheme)->status != COMMSCHEME_STATUS_PREFIRE)) {
+		for (int i = 0; i < varArr_getLength((*scheme)->buffersRecv); i++)
+			MPI_Request_free((*scheme)->requestsRecv + i);
+		for (int i = 0; i < varArr_getLength((*scheme)->buffersSend); i++)
+			MPI_Request_free((*scheme)->requestsSend + i);
+		xfree((*scheme)->requestsRecv);
+		xfree((*scheme)->requestsSend);
+	}
+
 	while (varArr_getLength((*scheme)->buffersRecv) != 0) {
 		commSchemeBuffer_t buf = varArr_remove((*scheme)->buffersRecv, 0);
 		commSchemeBuffer_del(&buf);
@@ -122,10 +180,18 @@ extern void
 commScheme_fire(commScheme_t scheme)
 {
 	assert(scheme != NULL);
-	assert(scheme->status == COMMSCHEME_STATUS_PREFIRE);
-
-	local_startReceiving(scheme);
-	local_startSending(scheme);
+	assert(scheme->status == COMMSCHEME_STATUS_PREFIRE
+	       || (scheme->isPersistent
+	           && scheme->status == COMMSCHEME_STATUS_POSTFIRE));
+
+	if (scheme->isPersistent) {
+		if (scheme->status == COMMSCHEME_STATUS_PREFIRE)
+			local_initPersistent(scheme);
+		local_startPersistent(scheme);
+	} else {
+		local_startReceiving(scheme);
+		local_startSending(scheme);
+	}
 
 	scheme->status = COMMSCHEME_STATUS_FIRING;
 }
@@ -153,16 +219,59 @@ commScheme_wait(commScheme_t scheme)
 	numRequests = varArr_getLength(scheme->buffersSend);
 	if (numRequests > 0)
 		MPI_Waitall(numRequests, scheme->requestsSend, MPI_STATUSES_IGNORE);
-	xfree(scheme->requestsSend);
-	scheme->requestsSend = NULL;
 
-	numRequests          = varArr_getLength(scheme->buffersRecv);
+	numRequests = varArr_getLength(scheme->buffersRecv);
 	if (numRequests > 0)
 		MPI_Waitall(numRequests, scheme->requestsRecv, MPI_STATUSES_IGNORE);
-	xfree(scheme->requestsRecv);
-	scheme->requestsRecv = NULL;
 
-	scheme->status       = COMMSCHEME_STATUS_POSTFIRE;
+	// Persistent requests are only inactive now and are kept for the
+	// next firing.
+	if (!scheme->isPersistent) {
+		xfree(scheme->requestsSend);
+		scheme->requestsSend = NULL;
+		xfree(scheme->requestsRecv);
+		scheme->requestsRecv = NULL;
+	}
+
+	scheme->status = COMMSCHEME_STATUS_POSTFIRE;
+}
+
+extern bool
+commScheme_test(commScheme_t scheme)
+{
+	int numRequests;
+	int flagRecv = 1;
+	int flagSend = 1;
+
+	assert(scheme != NULL);
+
+	if (scheme->status != COMMSCHEME_STATUS_FIRING)
+		return true;
+
+	numRequests = varArr_getLength(scheme->buffersRecv);
+	if (numRequests > 0)
+		MPI_Testall(numRequests, scheme->requestsRecv, &flagRecv,
+		            MPI_STATUSES_IGNORE);
+	numRequests = varArr_getLength(scheme->buffersSend);
+	if (numRequests > 0)
+		MPI_Testall(numRequests, scheme->requestsSend, &flagSend,
+		            MPI_STATUSES_IGNORE);
+
+	if (!flagRecv || !flagSend)
+		return false;
+
+	// Completed requests are inactive, waiting on them returns at once.
+	commScheme_wait(scheme);
+
+	return true;
+}
+
+extern bool
+commScheme_isPersistent(const commScheme_t scheme)
+{
+	assert(scheme != NULL);
+
+	return scheme->isPersistent;
 }
 
 /*--- Implementations of local functions --------------------------------*/
@@ -185,20 +294,13 @@ local_startReceiving(commScheme_t scheme)
 inline static void
 local_startSending(commScheme_t scheme)
 {
-	int                firstSendBuf = 0;
+	int                firstSendBuf;
 	int                numBuffersSend;
 	commSchemeBuffer_t buf;
 
 	numBuffersSend       = varArr_getLength(scheme->buffersSend);
 	scheme->requestsSend = xmalloc(sizeof(MPI_Request) * numBuffersSend);
-
-	while (firstSendBuf < numBuffersSend) {
-		buf = varArr_getElementHandle(scheme->buffersSend, firstSendBuf);
-		if (buf->rank > scheme->rank)
-			break;
-		firstSendBuf++;
-	}
-	firstSendBuf %= numBuffersSend;
+	firstSendBuf         = local_getFirstSendBuf(scheme);
 
 	for (int i = firstSendBuf; i < numBuffersSend; i++) {
 		buf = varArr_getElementHandle(scheme->buffersSend, i);
@@ -212,3 +314,61 @@ local_startSending(commScheme_t scheme)
 		          scheme->tag, scheme->comm, scheme->requestsSend + i);
 	}
 }
+
+inline static int
+local_getFirstSendBuf(const commScheme_t scheme)
+{
+	int                firstSendBuf   = 0;
+	int                numBuffersSend = varArr_getLength(scheme->buffersSend);
+	commSchemeBuffer_t buf;
+
+	while (firstSendBuf < numBuffersSend) {
+		buf = varArr_getElementHandle(scheme->buffersSend, firstSendBuf);
+		if (buf->rank > scheme->rank)
+			break;
+		firstSendBuf++;
+	}
+	if (numBuffersSend > 0)
+		firstSendBuf %= numBuffersSend;
+
+	return firstSendBuf;
+}
+
+static void
+local_initPersistent(commScheme_t scheme)
+{
+	int                numBuffersRecv = varArr_getLength(scheme->buffersRecv);
+	int                numBuffersSend = varArr_getLength(scheme->buffersSend);
+	commSchemeBuffer_t buf;
+
+	scheme->requestsRecv = xmalloc(sizeof(MPI_Request) * numBuffersRecv);
+	for (int i = 0; i < numBuffersRecv; i++) {
+		buf = varArr_getElementHandle(scheme->buffersRecv, i);
+		MPI_Recv_init(buf->buf, buf->count, buf->datatype, buf->rank,
+		              scheme->tag, scheme->comm, scheme->requestsRecv + i);
+	}
+
+	scheme->requestsSend = xmalloc(sizeof(MPI_Request) * numBuffersSend);
+	for (int i = 0; i < numBuffersSend; i++) {
+		buf = varArr_getElementHandle(scheme->buffersSend, i);
+		MPI_Send_init(buf->buf, buf->count, buf->datatype, buf->rank,
+		              scheme->tag, scheme->comm, scheme->requestsSend + i);
+	}
+}
+
+static void
+local_startPersistent(commScheme_t scheme)
+{
+	int numBuffersRecv = varArr_getLength(scheme->buffersRecv);
+	int numBuffersSend = varArr_getLength(scheme->buffersSend);
+	int firstSendBuf   = local_getFirstSendBuf(scheme);
+
+	if (numBuffersRecv > 0)
+		MPI_Startall(numBuffersRecv, scheme->requestsRecv);
+
+	// Keep the order of commScheme_fire() to avoid congestion.
+	for (int i = firstSendBuf; i < numBuffersSend; i++)
+		MPI_Start(scheme->requestsSend + i);
+	for (int i = 0; i < firstSendBuf; i++)
+		MPI_Start(scheme->requestsSend + i);
+}
@@ -19,6 +19,7 @@
 /*--- Includes ----------------------------------------------------------*/
 #include "util_config.h"
 #include "commSchemeBuffer.h"
+#include <stdbool.h>
 
 
 /*--- ADT handle --------------------------------------------------------*/
@@ -63,6 +64,27 @@ extern commScheme_t
 commScheme_new(MPI_Comm comm, int tag);
 
 
+/**
+ * @brief  Creates a new persistent communication scheme.
+ *
+ * A persistent scheme is set up like a normal one, but it can be fired
+ * any number of times.  The requests are created (with MPI_Send_init()
+ * and MPI_Recv_init()) when the scheme is fired the first time and are
+ * only restarted afterwards, hence the buffers must stay at the same
+ * place as long as the scheme is used.  The content of the send buffers
+ * may change between the firings.
+ *
+ * @param[in]  comm
+ *                The MPI communicator, see commScheme_new().
+ * @param[in]  tag
+ *                The tag, see commScheme_new().
+ *
+ * @return  Returns a handle to a persistent communication scheme.
+ */
+extern commScheme_t
+commScheme_newPersistent(MPI_Comm comm, int tag);
+
+
 /**
  * @brief  Deletes a communication scheme object and frees all memory.
  *
@@ -154,7 +176,8 @@ commScheme_addBuffer(commScheme_t       scheme,
  * @param[in,out] scheme
  *                   The handle of the scheme that should be executed.
  *                   Must not be NULL and must not have been executed
- *                   before.
+ *                   before, unless it is a persistent scheme that is
+ *                   not executing anymore.
  *
  * @return  Returns nothing.
  */
@@ -196,6 +219,37 @@ extern void
 commScheme_wait(commScheme_t scheme);
 
 
+/**
+ * @brief  Checks whether all communication of a scheme has finished.
+ *
+ * This does not block.  If all communication has finished, the scheme
+ * is left in the same state as after commScheme_wait(), otherwise the
+ * communication is only progressed.  This allows to do work while the
+ * messages are in flight and to react as soon as they have arrived.
+ *
+ * @param[in,out]  scheme
+ *                    The scheme to check.  Must not be NULL.
+ *
+ * @return  Returns @c true if no communication of the scheme is pending
+ *          anymore and @c false otherwise.
+ */
+extern bool
+commScheme_test(commScheme_t scheme);
+
+
+/**
+ * @brief  Checks whether a scheme is persistent.
+ *
+ * @param[in]  scheme
+ *                The scheme to check.  Must not be NULL.
+ *
+ * @return  Returns @c true if the scheme has been created with
+ *          commScheme_newPersistent() and @c false otherwise.
+ */
+extern bool
+commScheme_isPersistent(const commScheme_t scheme);
+
+
 /** @} */
 
 
@@ -18,6 +18,7 @@
 /*--- Includes ----------------------------------------------------------*/
 #include "util_config.h"
 #include <mpi.h>
+#include <stdbool.h>
 #include "varArr.h"
 
 
@@ -56,6 +57,8 @@ struct commScheme_struct {
 	varArr_t    buffersSend;
 	/** @brief Array holding the send requests. */
 	MPI_Request *requestsSend;
+	/** @brief Whether the requests are kept to fire again. */
+	bool        isPersistent;
 };
 
 
@@ -214,6 +214,99 @@ commScheme_wait_test(void)
 	return hasPassed ? true : false;
 }
 
+extern bool
+commScheme_test_test(void)
+{
+	bool         hasPassed = true;
+	int          rank, size;
+	commScheme_t scheme;
+	int          *buffers;
+#ifdef XMEM_TRACK_MEM
+	size_t       allocatedBytes = global_allocated_bytes;
+#endif
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+	MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+	if (rank == 0)
+		printf("Testing %s... ", __func__);
+
+	scheme = local_getFakeScheme(&buffers);
+	if (!commScheme_test(scheme))
+		hasPassed = false;
+	commScheme_fire(scheme);
+	while (!commScheme_test(scheme))
+		;
+	if (scheme->status != COMMSCHEME_STATUS_POSTFIRE)
+		hasPassed = false;
+	if ((scheme->requestsRecv != NULL) || (scheme->requestsSend != NULL))
+		hasPassed = false;
+	if (buffers[0] != (rank + size - 1) % size)
+		hasPassed = false;
+	commScheme_del(&scheme);
+	xfree(buffers);
+#ifdef XMEM_TRACK_MEM
+	if (allocatedBytes != global_allocated_bytes)
+		hasPassed = false;
+#endif
+
+	return hasPassed ? true : false;
+}
+
+extern bool
+commScheme_persistent_test(void)
+{
+	bool               hasPassed = true;
+	int                rank, size;
+	int                to, from;
+	int                valSend, valRecv;
+	commScheme_t       scheme;
+	commSchemeBuffer_t buf;
+#ifdef XMEM_TRACK_MEM
+	size_t             allocatedBytes = global_allocated_bytes;
+#endif
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+	MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+	if (rank == 0)
+		printf("Testing %s... ", __func__);
+
+	to     = (rank + 1) % size;
+	from   = (rank + size - 1) % size;
+	scheme = commScheme_newPersistent(MPI_COMM_WORLD, 99);
+	if (!commScheme_isPersistent(scheme))
+		hasPassed = false;
+	buf    = commSchemeBuffer_new(&valSend, 1, MPI_INT, to);
+	commScheme_addBuffer(scheme, buf, COMMSCHEME_TYPE_SEND);
+	buf    = commSchemeBuffer_new(&valRecv, 1, MPI_INT, from);
+	commScheme_addBuffer(scheme, buf, COMMSCHEME_TYPE_RECV);
+
+	// The same scheme is fired several times with new content.
+	for (int i = 0; i < 3; i++) {
+		valSend = rank + i * size;
+		valRecv = -1;
+		if (i == 1) {
+			commScheme_fire(scheme);
+			while (!commScheme_test(scheme))
+				;
+		} else {
+			commScheme_fireBlock(scheme);
+		}
+		if (scheme->status != COMMSCHEME_STATUS_POSTFIRE)
+			hasPassed = false;
+		if ((scheme->requestsRecv == NULL) || (scheme->requestsSend == NULL))
+			hasPassed = false;
+		if (valRecv != from + i * size)
+			hasPassed = false;
+	}
+	commScheme_del(&scheme);
+#ifdef XMEM_TRACK_MEM
+	if (allocatedBytes != global_allocated_bytes)
+		hasPassed = false;
+#endif
+
+	return hasPassed ? true : false;
+}
+
 /*--- Implementations of local functions --------------------------------*/
 static commScheme_t
 local_getFakeScheme(int **buffers)
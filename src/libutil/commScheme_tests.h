@@ -30,5 +30,11 @@ commScheme_fireBlock_test(void);
 extern bool
 commScheme_wait_test(void);
 
+extern bool
+commScheme_test_test(void);
+
+extern bool
+commScheme_persistent_test(void);
+
 
 #endif
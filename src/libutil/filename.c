@@ -232,6 +232,8 @@ filename_clone(const filename_t fn)
 		clone->suffix = xstrdup(fn->suffix);
 	if (fn->fullName != local_emptyString)
 		clone->fullName = xstrdup(fn->fullName);
+	// The full name of the original may not have been updated yet.
+	clone->fullNameUpdateRequired = fn->fullNameUpdateRequired;
 
 	return clone;
 }
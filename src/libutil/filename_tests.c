@@ -143,6 +143,13 @@ filename_clone_test(void)
 		hasPassed = false;
 	if (strcmp(fn->suffix, clone->suffix))
 		hasPassed = false;
+	filename_del(&clone);
+
+	// A full name that is not yet updated must be right in the clone.
+	filename_setPrefix(fn, "<other>");
+	clone = filename_clone(fn);
+	if (strcmp(filename_getFullName(fn), filename_getFullName(clone)))
+		hasPassed = false;
 
 	filename_del(&clone);
 	filename_del(&fn);
@@ -0,0 +1,439 @@
+// Copyright (C) 2013, Steffen Knollmann
+// Released under the terms of the GNU General Public License version 3.
+// This file is part of `ginnungagap'.
+
+
+/*--- Doxygen file description ------------------------------------------*/
+
+/**
+ * @file libutil/gadgetHDF5.c
+ * @ingroup libutilFilesGadgetHDF5
+ * @brief  Implements the writing of Gadget HDF5 (format 3) files.
+ */
+
+
+/*--- Includes ----------------------------------------------------------*/
+#include "util_config.h"
+#include "gadgetHDF5.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <assert.h>
+#include <hdf5.h>
+#include "xmem.h"
+#include "xstring.h"
+#include "diediedie.h"
+
+
+/*--- Implemention of main structure ------------------------------------*/
+
+/** @brief  The main structure of the Gadget HDF5 file object. */
+struct gadgetHDF5_struct {
+	/** @brief  The name of the file. */
+	char     *fileName;
+	/** @brief  The handle of the file, invalid if not open. */
+	hid_t    fileHandle;
+	/** @brief  The groups of the particle types, invalid if absent. */
+	hid_t    groups[6];
+	/** @brief  The datasets of the blocks, invalid if absent. */
+	hid_t    dataSets[6][GADGETBLOCK_NUM];
+	/** @brief  The number of particles of each type in the file. */
+	uint64_t npFile[6];
+	/** @brief  Whether the IDs are 64bit integers. */
+	bool     useLongIDs;
+#ifdef WITH_MPI
+	/** @brief  The communicator sharing the file, may be null. */
+	MPI_Comm mpiComm;
+#endif
+};
+
+
+/*--- Local variables ---------------------------------------------------*/
+
+/** @brief  The names of the datasets, must match up with gadgetBlock_t. */
+static const char *local_dataSetNames[GADGETBLOCK_NUM]
+    = {"Header", "Coordinates", "Velocities", "ParticleIDs", "Masses",
+	   "InternalEnergy", "Density", "ElectronAbundance",
+	   "NeutralHydrogenAbundance", "SmoothingLength", "StarFormationRate",
+	   "StellarFormationTime", "Metallicity", "Unknown"};
+
+
+/*--- Prototypes of local functions -------------------------------------*/
+static hid_t
+local_getFileAccessProps(const gadgetHDF5_t gadgetHDF5);
+
+static hid_t
+local_getXferProps(const gadgetHDF5_t gadgetHDF5);
+
+static hid_t
+local_getMemType(const gadgetHDF5_t gadgetHDF5, gadgetBlock_t block);
+
+static void
+local_writeHeader(const gadgetHDF5_t   gadgetHDF5,
+                  const gadgetHeader_t header);
+
+static void
+local_writeAttribute(hid_t      group,
+                     const char *name,
+                     hid_t      type,
+                     hsize_t    num,
+                     const void *value);
+
+
+/*--- Implementations of exported functions -----------------------------*/
+extern gadgetHDF5_t
+gadgetHDF5_new(const char *fileName)
+{
+	gadgetHDF5_t gadgetHDF5;
+
+	assert(fileName != NULL);
+
+	gadgetHDF5             = xmalloc(sizeof(struct gadgetHDF5_struct));
+	gadgetHDF5->fileName   = xstrdup(fileName);
+	gadgetHDF5->fileHandle = H5I_INVALID_HID;
+	for (int i = 0; i < 6; i++) {
+		gadgetHDF5->groups[i] = H5I_INVALID_HID;
+		gadgetHDF5->npFile[i] = UINT64_C(0);
+		for (int j = 0; j < GADGETBLOCK_NUM; j++)
+			gadgetHDF5->dataSets[i][j] = H5I_INVALID_HID;
+	}
+	gadgetHDF5->useLongIDs = false;
+#ifdef WITH_MPI
+	gadgetHDF5->mpiComm    = MPI_COMM_NULL;
+#endif
+
+	return gadgetHDF5;
+}
+
+extern void
+gadgetHDF5_del(gadgetHDF5_t *gadgetHDF5)
+{
+	assert(gadgetHDF5 != NULL && *gadgetHDF5 != NULL);
+
+	if ((*gadgetHDF5)->fileHandle != H5I_INVALID_HID)
+		gadgetHDF5_close(*gadgetHDF5);
+	xfree((*gadgetHDF5)->fileName);
+	xfree(*gadgetHDF5);
+
+	*gadgetHDF5 = NULL;
+}
+
+#ifdef WITH_MPI
+extern void
+gadgetHDF5_initParallel(gadgetHDF5_t gadgetHDF5, MPI_Comm comm)
+{
+	assert(gadgetHDF5 != NULL);
+	assert(gadgetHDF5->fileHandle == H5I_INVALID_HID);
+
+	gadgetHDF5->mpiComm = comm;
+}
+
+#endif
+
+extern void
+gadgetHDF5_create(gadgetHDF5_t         gadgetHDF5,
+                  const gadgetHeader_t header,
+                  const uint64_t       npFile[6])
+{
+	hid_t accessProps;
+
+	assert(gadgetHDF5 != NULL);
+	assert(gadgetHDF5->fileHandle == H5I_INVALID_HID);
+	assert(header != NULL);
+	assert(npFile != NULL);
+
+	for (int i = 0; i < 6; i++)
+		gadgetHDF5->npFile[i] = npFile[i];
+	gadgetHDF5->useLongIDs = gadgetHeader_getUseLongIDs(header);
+
+	accessProps            = local_getFileAccessProps(gadgetHDF5);
+	gadgetHDF5->fileHandle = H5Fcreate(gadgetHDF5->fileName, H5F_ACC_TRUNC,
+	                                   H5P_DEFAULT, accessProps);
+	if (gadgetHDF5->fileHandle < 0) {
+		fprintf(stderr, "Could not create %s\n", gadgetHDF5->fileName);
+		diediedie(EXIT_FAILURE);
+	}
+	if (accessProps != H5P_DEFAULT)
+		H5Pclose(accessProps);
+
+	local_writeHeader(gadgetHDF5, header);
+}
+
+extern void
+gadgetHDF5_createBlock(gadgetHDF5_t  gadgetHDF5,
+                       gadgetBlock_t block,
+                       int           type)
+{
+	hsize_t dims[2];
+	hid_t   fileType, dataSpace, dataSet;
+	int     rank;
+
+	assert(gadgetHDF5 != NULL);
+	assert(gadgetHDF5->fileHandle != H5I_INVALID_HID);
+	assert(block != GADGETBLOCK_HEAD && block != GADGETBLOCK_UNKNOWN);
+	assert(type >= 0 && type < 6);
+	assert(gadgetHDF5->dataSets[type][block] == H5I_INVALID_HID);
+
+	if (gadgetHDF5->npFile[type] == UINT64_C(0))
+		return;
+
+	if (gadgetHDF5->groups[type] == H5I_INVALID_HID) {
+		char name[16];
+		sprintf(name, "PartType%i", type);
+		gadgetHDF5->groups[type] = H5Gcreate(gadgetHDF5->fileHandle, name,
+		                                     H5P_DEFAULT, H5P_DEFAULT,
+		                                     H5P_DEFAULT);
+		if (gadgetHDF5->groups[type] < 0)
+			diediedie(EXIT_FAILURE);
+	}
+
+	dims[0]   = (hsize_t)(gadgetHDF5->npFile[type]);
+	dims[1]   = (hsize_t)gadgetBlock_getNumComponents(block);
+	rank      = (dims[1] > 1) ? 2 : 1;
+	dataSpace = H5Screate_simple(rank, dims, NULL);
+	if (gadgetBlock_isInteger(block))
+		fileType = gadgetHDF5->useLongIDs ? H5T_STD_U64LE : H5T_STD_U32LE;
+	else
+		fileType = (sizeof(fpv_t) == 8) ? H5T_IEEE_F64LE : H5T_IEEE_F32LE;
+
+	dataSet = H5Dcreate(gadgetHDF5->groups[type], local_dataSetNames[block],
+	                    fileType, dataSpace, H5P_DEFAULT, H5P_DEFAULT,
+	                    H5P_DEFAULT);
+	if (dataSet < 0)
+		diediedie(EXIT_FAILURE);
+	H5Sclose(dataSpace);
+
+	gadgetHDF5->dataSets[type][block] = dataSet;
+} // gadgetHDF5_createBlock
+
+extern void
+gadgetHDF5_writeBlock(gadgetHDF5_t  gadgetHDF5,
+                      gadgetBlock_t block,
+                      int           type,
+                      uint64_t      firstParticle,
+                      uint64_t      numParticles,
+                      const void    *data)
+{
+	hsize_t start[2], count[2];
+	hid_t   dataSet, spaceFile, spaceMem, xferProps;
+	herr_t  err;
+	int     rank;
+
+	assert(gadgetHDF5 != NULL);
+	assert(block != GADGETBLOCK_HEAD && block != GADGETBLOCK_UNKNOWN);
+	assert(type >= 0 && type < 6);
+	assert(firstParticle + numParticles <= gadgetHDF5->npFile[type]);
+	assert(data != NULL || numParticles == 0);
+
+	// Without particles of this type, no process holds any of them.
+	if (gadgetHDF5->npFile[type] == UINT64_C(0))
+		return;
+
+	dataSet = gadgetHDF5->dataSets[type][block];
+	assert(dataSet != H5I_INVALID_HID);
+
+	start[0]  = (hsize_t)firstParticle;
+	start[1]  = 0;
+	count[0]  = (hsize_t)numParticles;
+	count[1]  = (hsize_t)gadgetBlock_getNumComponents(block);
+	rank      = (count[1] > 1) ? 2 : 1;
+
+	spaceFile = H5Dget_space(dataSet);
+	if (numParticles > 0) {
+		H5Sselect_hyperslab(spaceFile, H5S_SELECT_SET, start, NULL, count,
+		                    NULL);
+		spaceMem = H5Screate_simple(rank, count, NULL);
+	} else {
+		// Processes without data still take part in the collective write.
+		count[0] = 1;
+		H5Sselect_none(spaceFile);
+		spaceMem = H5Screate_simple(rank, count, NULL);
+		H5Sselect_none(spaceMem);
+	}
+
+	xferProps = local_getXferProps(gadgetHDF5);
+	err       = H5Dwrite(dataSet, local_getMemType(gadgetHDF5, block),
+	                     spaceMem, spaceFile, xferProps, data);
+	if (err < 0) {
+		fprintf(stderr, "Could not write %s of type %i to %s\n",
+		        local_dataSetNames[block], type, gadgetHDF5->fileName);
+		diediedie(EXIT_FAILURE);
+	}
+
+	if (xferProps != H5P_DEFAULT)
+		H5Pclose(xferProps);
+	H5Sclose(spaceMem);
+	H5Sclose(spaceFile);
+} // gadgetHDF5_writeBlock
+
+extern void
+gadgetHDF5_close(gadgetHDF5_t gadgetHDF5)
+{
+	assert(gadgetHDF5 != NULL);
+	assert(gadgetHDF5->fileHandle != H5I_INVALID_HID);
+
+	for (int i = 0; i < 6; i++) {
+		for (int j = 0; j < GADGETBLOCK_NUM; j++) {
+			if (gadgetHDF5->dataSets[i][j] != H5I_INVALID_HID) {
+				H5Dclose(gadgetHDF5->dataSets[i][j]);
+				gadgetHDF5->dataSets[i][j] = H5I_INVALID_HID;
+			}
+		}
+		if (gadgetHDF5->groups[i] != H5I_INVALID_HID) {
+			H5Gclose(gadgetHDF5->groups[i]);
+			gadgetHDF5->groups[i] = H5I_INVALID_HID;
+		}
+	}
+	H5Fclose(gadgetHDF5->fileHandle);
+	gadgetHDF5->fileHandle = H5I_INVALID_HID;
+}
+
+extern const char *
+gadgetHDF5_getDataSetName(gadgetBlock_t block)
+{
+	assert(block != GADGETBLOCK_HEAD && block != GADGETBLOCK_UNKNOWN);
+
+	return local_dataSetNames[block];
+}
+
+/*--- Implementations of local functions --------------------------------*/
+static hid_t
+local_getFileAccessProps(const gadgetHDF5_t gadgetHDF5)
+{
+	hid_t accessProps = H5P_DEFAULT;
+
+#ifdef WITH_MPI
+	if (gadgetHDF5->mpiComm != MPI_COMM_NULL) {
+		accessProps = H5Pcreate(H5P_FILE_ACCESS);
+		if (accessProps < 0)
+			diediedie(EXIT_FAILURE);
+		if (H5Pset_fapl_mpio(accessProps, gadgetHDF5->mpiComm,
+		                     MPI_INFO_NULL) < 0)
+			diediedie(EXIT_FAILURE);
+	}
+#else
+	(void)gadgetHDF5;
+#endif
+
+	return accessProps;
+}
+
+static hid_t
+local_getXferProps(const gadgetHDF5_t gadgetHDF5)
+{
+	hid_t xferProps = H5P_DEFAULT;
+
+#ifdef WITH_MPI
+	if (gadgetHDF5->mpiComm != MPI_COMM_NULL) {
+		xferProps = H5Pcreate(H5P_DATASET_XFER);
+		if (xferProps < 0)
+			diediedie(EXIT_FAILURE);
+		H5Pset_dxpl_mpio(xferProps, H5FD_MPIO_COLLECTIVE);
+	}
+#else
+	(void)gadgetHDF5;
+#endif
+
+	return xferProps;
+}
+
+static hid_t
+local_getMemType(const gadgetHDF5_t gadgetHDF5, gadgetBlock_t block)
+{
+	if (gadgetBlock_isInteger(block))
+		return gadgetHDF5->useLongIDs ? H5T_NATIVE_UINT64 : H5T_NATIVE_UINT32;
+
+	return (sizeof(fpv_t) == 8) ? H5T_NATIVE_DOUBLE : H5T_NATIVE_FLOAT;
+}
+
+static void
+local_writeHeader(const gadgetHDF5_t   gadgetHDF5,
+                  const gadgetHeader_t header)
+{
+	hid_t    group;
+	uint64_t nall[6];
+	uint32_t nallLow[6], nallHigh[6];
+	double   massArr[6], value;
+	int32_t  flag;
+
+	group = H5Gcreate(gadgetHDF5->fileHandle, "Header", H5P_DEFAULT,
+	                  H5P_DEFAULT, H5P_DEFAULT);
+	if (group < 0)
+		diediedie(EXIT_FAILURE);
+
+	// The totals are split like in the binary header for Gadget-2/3, the
+	// particles in the file are 64bit as in newer codes.
+	gadgetHeader_getNall(header, nall);
+	for (int i = 0; i < 6; i++) {
+		nallLow[i]  = (uint32_t)(nall[i] & UINT64_C(0xFFFFFFFF));
+		nallHigh[i] = (uint32_t)(nall[i] >> 32);
+	}
+	local_writeAttribute(group, "NumPart_ThisFile", H5T_NATIVE_UINT64, 6,
+	                     gadgetHDF5->npFile);
+	local_writeAttribute(group, "NumPart_Total", H5T_NATIVE_UINT32, 6,
+	                     nallLow);
+	local_writeAttribute(group, "NumPart_Total_HighWord", H5T_NATIVE_UINT32,
+	                     6, nallHigh);
+
+	gadgetHeader_getMassArr(header, massArr);
+	local_writeAttribute(group, "MassTable", H5T_NATIVE_DOUBLE, 6, massArr);
+
+	value = gadgetHeader_getTime(header);
+	local_writeAttribute(group, "Time", H5T_NATIVE_DOUBLE, 1, &value);
+	value = gadgetHeader_getRedshift(header);
+	local_writeAttribute(group, "Redshift", H5T_NATIVE_DOUBLE, 1, &value);
+	value = gadgetHeader_getBoxsize(header);
+	local_writeAttribute(group, "BoxSize", H5T_NATIVE_DOUBLE, 1, &value);
+	value = gadgetHeader_getOmega0(header);
+	local_writeAttribute(group, "Omega0", H5T_NATIVE_DOUBLE, 1, &value);
+	value = gadgetHeader_getOmegaLambda(header);
+	local_writeAttribute(group, "OmegaLambda", H5T_NATIVE_DOUBLE, 1, &value);
+	value = gadgetHeader_getHubbleParameter(header);
+	local_writeAttribute(group, "HubbleParam", H5T_NATIVE_DOUBLE, 1, &value);
+
+	flag = gadgetHeader_getNumFiles(header);
+	local_writeAttribute(group, "NumFilesPerSnapshot", H5T_NATIVE_INT32, 1,
+	                     &flag);
+	flag = gadgetHeader_getFlagSfr(header);
+	local_writeAttribute(group, "Flag_Sfr", H5T_NATIVE_INT32, 1, &flag);
+	flag = gadgetHeader_getFlagCooling(header);
+	local_writeAttribute(group, "Flag_Cooling", H5T_NATIVE_INT32, 1, &flag);
+	flag = gadgetHeader_getFlagStellarAge(header);
+	local_writeAttribute(group, "Flag_StellarAge", H5T_NATIVE_INT32, 1,
+	                     &flag);
+	flag = gadgetHeader_getFlagMetal(header);
+	local_writeAttribute(group, "Flag_Metals", H5T_NATIVE_INT32, 1, &flag);
+	flag = gadgetHeader_getFlagFeedback(header);
+	local_writeAttribute(group, "Flag_Feedback", H5T_NATIVE_INT32, 1, &flag);
+	flag = gadgetHeader_getFlagEntropy(header);
+	local_writeAttribute(group, "Flag_Entropy_ICs", H5T_NATIVE_INT32, 1,
+	                     &flag);
+	// The datasets are written in the precision of the code.
+	flag = (sizeof(fpv_t) == 8) ? 1 : 0;
+	local_writeAttribute(group, "Flag_DoublePrecision", H5T_NATIVE_INT32, 1,
+	                     &flag);
+	flag = gadgetHeader_getFlagICInfo(header);
+	local_writeAttribute(group, "Flag_IC_Info", H5T_NATIVE_INT32, 1, &flag);
+
+	H5Gclose(group);
+} // local_writeHeader
+
+static void
+local_writeAttribute(hid_t      group,
+                     const char *name,
+                     hid_t      type,
+                     hsize_t    num,
+                     const void *value)
+{
+	hid_t dataSpace, attr;
+
+	dataSpace = (num == 1) ? H5Screate(H5S_SCALAR)
+	            : H5Screate_simple(1, &num, NULL);
+	attr      = H5Acreate(group, name, type, dataSpace, H5P_DEFAULT,
+	                      H5P_DEFAULT);
+	if ((attr < 0) || (H5Awrite(attr, type, value) < 0)) {
+		fprintf(stderr, "Could not write the header attribute %s\n", name);
+		diediedie(EXIT_FAILURE);
+	}
+	H5Aclose(attr);
+	H5Sclose(dataSpace);
+}
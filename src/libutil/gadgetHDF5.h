@@ -0,0 +1,230 @@
+// Copyright (C) 2013, Steffen Knollmann
+// Released under the terms of the GNU General Public License version 3.
+// This file is part of `ginnungagap'.
+
+#ifndef GADGETHDF5_H
+#define GADGETHDF5_H
+
+
+/*--- Doxygen file description ------------------------------------------*/
+
+/**
+ * @file  libutil/gadgetHDF5.h
+ * @ingroup  libutilFilesGadgetHDF5
+ * @brief  Provides the interface to Gadget HDF5 (format 3) files.
+ */
+
+
+/*--- Includes ----------------------------------------------------------*/
+#include "util_config.h"
+#include <stdint.h>
+#include <stdbool.h>
+#ifdef WITH_MPI
+#  include <mpi.h>
+#endif
+#include "gadgetBlock.h"
+#include "gadgetHeader.h"
+
+
+/*--- ADT handle --------------------------------------------------------*/
+
+/** @brief  The handle for the Gadget HDF5 file object. */
+typedef struct gadgetHDF5_struct *gadgetHDF5_t;
+
+
+/*--- Prototypes of exported functions ----------------------------------*/
+
+/**
+ * @name  Creation and Deletion
+ * @{
+ */
+
+/**
+ * @brief  Creates a new Gadget HDF5 file object.
+ *
+ * The file itself is only created by gadgetHDF5_create().
+ *
+ * @param[in]  *fileName
+ *                The name of the file, must not be @c NULL.
+ *
+ * @return  Returns a new Gadget HDF5 file object.
+ */
+extern gadgetHDF5_t
+gadgetHDF5_new(const char *fileName);
+
+
+/**
+ * @brief  Deletes a Gadget HDF5 file object, closing the file if required.
+ *
+ * @param[in,out]  *gadgetHDF5
+ *                    A pointer to the variable holding the object that
+ *                    should be deleted.  After deletion, the external
+ *                    variable will be set to @c NULL.
+ *
+ * @return  Returns nothing.
+ */
+extern void
+gadgetHDF5_del(gadgetHDF5_t *gadgetHDF5);
+
+
+#ifdef WITH_MPI
+
+/**
+ * @brief  Lets all processes of a communicator share the file.
+ *
+ * All following operations become collective operations of the
+ * communicator and the data is written with collective MPI-IO.
+ *
+ * @param[in,out]  gadgetHDF5
+ *                    The file object to work with, the file must not have
+ *                    been created yet.
+ * @param[in]      comm
+ *                    The communicator of the processes sharing the file.
+ *
+ * @return  Returns nothing.
+ */
+extern void
+gadgetHDF5_initParallel(gadgetHDF5_t gadgetHDF5, MPI_Comm comm);
+
+#endif
+
+/** @} */
+
+
+/**
+ * @name  Writing
+ * @{
+ */
+
+/**
+ * @brief  Creates the file and writes the header.
+ *
+ * Existing files are overwritten.  The header is stored as the attributes
+ * of the @c Header group, the particle numbers of the file are given
+ * separately as they may exceed the 32bit numbers of the binary header.
+ *
+ * @param[in,out]  gadgetHDF5
+ *                    The file object to work with.
+ * @param[in]      header
+ *                    The header to write.
+ * @param[in]      npFile
+ *                    The number of particles of each type in the file.
+ *
+ * @return  Returns nothing.
+ */
+extern void
+gadgetHDF5_create(gadgetHDF5_t         gadgetHDF5,
+                  const gadgetHeader_t header,
+                  const uint64_t       npFile[6]);
+
+
+/**
+ * @brief  Creates the dataset of a block for one particle type.
+ *
+ * The dataset is sized for all particles of that type in the file, it is
+ * not created if there are none.  Floating point blocks are stored as
+ * @c fpv_t, the IDs as 32 or 64bit unsigned integers depending on the
+ * header.
+ *
+ * @param[in,out]  gadgetHDF5
+ *                    The file object to work with, the file must have been
+ *                    created.
+ * @param[in]      block
+ *                    The block to create, must not be #GADGETBLOCK_HEAD or
+ *                    #GADGETBLOCK_UNKNOWN.
+ * @param[in]      type
+ *                    The particle type, must be in [0, 5].
+ *
+ * @return  Returns nothing.
+ */
+extern void
+gadgetHDF5_createBlock(gadgetHDF5_t  gadgetHDF5,
+                       gadgetBlock_t block,
+                       int           type);
+
+
+/**
+ * @brief  Writes a consecutive range of particles into a block.
+ *
+ * In parallel every process writes its own range, ranges of different
+ * processes must not overlap.  Processes without particles must still
+ * call this function with @c numParticles set to 0.
+ *
+ * @param[in,out]  gadgetHDF5
+ *                    The file object to work with.
+ * @param[in]      block
+ *                    The block to write to, must have been created for
+ *                    this particle type.
+ * @param[in]      type
+ *                    The particle type, must be in [0, 5].
+ * @param[in]      firstParticle
+ *                    The index within the particles of this type in the
+ *                    file at which the range starts.
+ * @param[in]      numParticles
+ *                    The number of particles to write.
+ * @param[in]      *data
+ *                    The data of the particles, all components of a
+ *                    particle are consecutive.  May be @c NULL if
+ *                    @c numParticles is 0.
+ *
+ * @return  Returns nothing.
+ */
+extern void
+gadgetHDF5_writeBlock(gadgetHDF5_t  gadgetHDF5,
+                      gadgetBlock_t block,
+                      int           type,
+                      uint64_t      firstParticle,
+                      uint64_t      numParticles,
+                      const void    *data);
+
+
+/**
+ * @brief  Closes the file.
+ *
+ * @param[in,out]  gadgetHDF5
+ *                    The file object to work with.
+ *
+ * @return  Returns nothing.
+ */
+extern void
+gadgetHDF5_close(gadgetHDF5_t gadgetHDF5);
+
+/** @} */
+
+
+/**
+ * @name  Translating
+ * @{
+ */
+
+/**
+ * @brief  Retrieves the name of the dataset holding a given block.
+ *
+ * @param[in]  block
+ *                The block to translate, must not be #GADGETBLOCK_HEAD or
+ *                #GADGETBLOCK_UNKNOWN.
+ *
+ * @return  Returns the name of the dataset within the @c PartTypeN groups.
+ */
+extern const char *
+gadgetHDF5_getDataSetName(gadgetBlock_t block);
+
+/** @} */
+
+
+/*--- Doxygen group definitions -----------------------------------------*/
+
+/**
+ * @defgroup libutilFilesGadgetHDF5 Gadget HDF5
+ * @ingroup libutilFilesGadget
+ * @brief Provides the writing of Gadget HDF5 (format 3) files.
+ *
+ * The header is stored as attributes of the @c Header group and every
+ * block as a dataset in the group of its particle type, e.g.
+ * @c PartType1/Coordinates.  Unlike the binary files, one file can be
+ * filled by many processes at once, each selecting its range of
+ * particles as a hyperslab of the datasets.
+ */
+
+
+#endif
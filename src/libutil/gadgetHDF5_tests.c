@@ -0,0 +1,191 @@
+// Copyright (C) 2013, Steffen Knollmann
+// Released under the terms of the GNU General Public License version 3.
+// This file is part of `ginnungagap'.
+
+
+/*--- Doxygen file description ------------------------------------------*/
+
+/**
+ * @file  libutil/gadgetHDF5_tests.c
+ * @ingroup  libutilFilesGadgetHDF5Tests
+ * @brief  Provides the implementation of the tests functions for
+ *         gadgetHDF5.c.
+ */
+
+
+/*--- Includes ----------------------------------------------------------*/
+#include "util_config.h"
+#include "gadgetHDF5_tests.h"
+#include "gadgetHDF5.h"
+#include <stdio.h>
+#include <hdf5.h>
+#ifdef WITH_MPI
+#  include <mpi.h>
+#endif
+#ifdef ENABLE_XMEM_TRACK_MEM
+#  include "../libutil/xmem.h"
+#endif
+
+
+/*--- Local defines -----------------------------------------------------*/
+
+/** @brief  The name of the file written by the tests. */
+#define LOCAL_TESTFILE "TEST_gadgetHDF5.hdf5"
+
+
+/*--- Prototypes of local functions -------------------------------------*/
+static gadgetHeader_t
+local_getHeader(void);
+
+
+/*--- Implementations of exported functions -----------------------------*/
+extern bool
+gadgetHDF5_new_test(void)
+{
+	bool         hasPassed = true;
+	int          rank      = 0;
+	gadgetHDF5_t gadgetHDF5;
+#ifdef XMEM_TRACK_MEM
+	size_t       allocatedBytes = global_allocated_bytes;
+#endif
+#ifdef WITH_MPI
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+#endif
+
+	if (rank == 0)
+		printf("Testing %s... ", __func__);
+
+	gadgetHDF5 = gadgetHDF5_new(LOCAL_TESTFILE);
+	if (gadgetHDF5 == NULL)
+		hasPassed = false;
+	gadgetHDF5_del(&gadgetHDF5);
+#ifdef XMEM_TRACK_MEM
+	if (allocatedBytes != global_allocated_bytes)
+		hasPassed = false;
+#endif
+
+	return hasPassed ? true : false;
+}
+
+extern bool
+gadgetHDF5_del_test(void)
+{
+	bool         hasPassed = true;
+	int          rank      = 0;
+	gadgetHDF5_t gadgetHDF5;
+#ifdef XMEM_TRACK_MEM
+	size_t       allocatedBytes = global_allocated_bytes;
+#endif
+#ifdef WITH_MPI
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+#endif
+
+	if (rank == 0)
+		printf("Testing %s... ", __func__);
+
+	gadgetHDF5 = gadgetHDF5_new(LOCAL_TESTFILE);
+	gadgetHDF5_del(&gadgetHDF5);
+	if (gadgetHDF5 != NULL)
+		hasPassed = false;
+#ifdef XMEM_TRACK_MEM
+	if (allocatedBytes != global_allocated_bytes)
+		hasPassed = false;
+#endif
+
+	return hasPassed ? true : false;
+}
+
+extern bool
+gadgetHDF5_writeBlock_test(void)
+{
+	bool           hasPassed = true;
+	int            rank      = 0;
+	uint64_t       npFile[6] = {0, 10, 0, 0, 0, 0};
+	gadgetHeader_t header;
+	gadgetHDF5_t   gadgetHDF5;
+	fpv_t          pos[10][3];
+	uint32_t       ids[10];
+	uint64_t       numPart[6];
+	hid_t          file, dataSet, attr;
+#ifdef XMEM_TRACK_MEM
+	size_t         allocatedBytes = global_allocated_bytes;
+#endif
+#ifdef WITH_MPI
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+#endif
+
+	if (rank == 0)
+		printf("Testing %s... ", __func__);
+
+	for (int i = 0; i < 10; i++) {
+		pos[i][0] = pos[i][1] = pos[i][2] = (fpv_t)i;
+		ids[i]    = (uint32_t)(i + 1);
+	}
+
+	header     = local_getHeader();
+	gadgetHDF5 = gadgetHDF5_new(LOCAL_TESTFILE);
+	gadgetHDF5_create(gadgetHDF5, header, npFile);
+	for (int type = 0; type < 6; type++) {
+		gadgetHDF5_createBlock(gadgetHDF5, GADGETBLOCK_POS_, type);
+		gadgetHDF5_createBlock(gadgetHDF5, GADGETBLOCK_ID__, type);
+	}
+	// Written in two pieces and out of order, as by different processes.
+	gadgetHDF5_writeBlock(gadgetHDF5, GADGETBLOCK_POS_, 1, 4, 6, pos[4]);
+	gadgetHDF5_writeBlock(gadgetHDF5, GADGETBLOCK_POS_, 1, 0, 4, pos[0]);
+	gadgetHDF5_writeBlock(gadgetHDF5, GADGETBLOCK_ID__, 1, 0, 10, ids);
+	gadgetHDF5_writeBlock(gadgetHDF5, GADGETBLOCK_ID__, 1, 10, 0, NULL);
+	gadgetHDF5_writeBlock(gadgetHDF5, GADGETBLOCK_ID__, 0, 0, 0, NULL);
+	gadgetHDF5_del(&gadgetHDF5);
+	gadgetHeader_del(&header);
+
+	for (int i = 0; i < 10; i++) {
+		pos[i][0] = pos[i][1] = pos[i][2] = (fpv_t)(-1);
+		ids[i]    = 0;
+	}
+	file    = H5Fopen(LOCAL_TESTFILE, H5F_ACC_RDONLY, H5P_DEFAULT);
+	dataSet = H5Dopen(file, "PartType1/Coordinates", H5P_DEFAULT);
+	H5Dread(dataSet, (sizeof(fpv_t) == 8) ? H5T_NATIVE_DOUBLE
+	        : H5T_NATIVE_FLOAT, H5S_ALL, H5S_ALL, H5P_DEFAULT, pos);
+	H5Dclose(dataSet);
+	dataSet = H5Dopen(file, "PartType1/ParticleIDs", H5P_DEFAULT);
+	H5Dread(dataSet, H5T_NATIVE_UINT32, H5S_ALL, H5S_ALL, H5P_DEFAULT, ids);
+	H5Dclose(dataSet);
+	attr = H5Aopen_by_name(file, "Header", "NumPart_ThisFile", H5P_DEFAULT,
+	                       H5P_DEFAULT);
+	H5Aread(attr, H5T_NATIVE_UINT64, numPart);
+	H5Aclose(attr);
+	if (H5Lexists(file, "PartType0", H5P_DEFAULT) > 0)
+		hasPassed = false;
+	H5Fclose(file);
+
+	for (int i = 0; i < 10; i++) {
+		if ((pos[i][2] != (fpv_t)i) || (ids[i] != (uint32_t)(i + 1)))
+			hasPassed = false;
+	}
+	for (int i = 0; i < 6; i++) {
+		if (numPart[i] != npFile[i])
+			hasPassed = false;
+	}
+#ifdef XMEM_TRACK_MEM
+	if (allocatedBytes != global_allocated_bytes)
+		hasPassed = false;
+#endif
+
+	return hasPassed ? true : false;
+} // gadgetHDF5_writeBlock_test
+
+/*--- Implementations of local functions --------------------------------*/
+static gadgetHeader_t
+local_getHeader(void)
+{
+	uint64_t       nall[6]    = {0, 10, 0, 0, 0, 0};
+	double         massarr[6] = {0.0, 1.0, 0.0, 0.0, 0.0, 0.0};
+	gadgetHeader_t header     = gadgetHeader_new();
+
+	gadgetHeader_setMassArr(header, massarr);
+	gadgetHeader_setNall(header, nall);
+	gadgetHeader_setNumFiles(header, 1);
+	gadgetHeader_setBoxsize(header, 100.0);
+
+	return header;
+}
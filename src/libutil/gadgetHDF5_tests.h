@@ -0,0 +1,47 @@
+// Copyright (C) 2013, Steffen Knollmann
+// Released under the terms of the GNU General Public License version 3.
+// This file is part of `ginnungagap'.
+
+#ifndef GADGETHDF5_TESTS_H
+#define GADGETHDF5_TESTS_H
+
+
+/*--- Doxygen file description ------------------------------------------*/
+
+/**
+ * @file  libutil/gadgetHDF5_tests.h
+ * @ingroup  libutilFilesGadgetHDF5Tests
+ * @brief  Provides the interface to the Gadget HDF5 tests.
+ */
+
+
+/*--- Includes ----------------------------------------------------------*/
+#include "util_config.h"
+#include <stdbool.h>
+
+
+/*--- Prototypes of exported functions ----------------------------------*/
+
+/** @brief  Tests gadgetHDF5_new(). */
+extern bool
+gadgetHDF5_new_test(void);
+
+/** @brief  Tests gadgetHDF5_del(). */
+extern bool
+gadgetHDF5_del_test(void);
+
+/** @brief  Tests gadgetHDF5_writeBlock(). */
+extern bool
+gadgetHDF5_writeBlock_test(void);
+
+
+/*--- Doxygen group definitions -----------------------------------------*/
+
+/**
+ * @defgroup libutilFilesGadgetHDF5Tests Tests
+ * @ingroup libutilFilesGadgetHDF5
+ * @brief Provides tests for @ref libutilFilesGadgetHDF5
+ */
+
+
+#endif
@@ -19,6 +19,11 @@
 #include "../libutil/xmem.h"
 
 
+/*--- Prototypes of local functions -------------------------------------*/
+static uint64_t
+local_interleave3d(const uint32_t coords[3], int bits);
+
+
 /*--- Implementations of exported functions -----------------------------*/
 extern uint64_t
 lIdx_fromCoordNd(const uint32_t *restrict coords,
@@ -50,3 +55,102 @@ lIdx_toCoordNd(uint64_t                 idx,
 	}
 	coords[i] = idx;
 }
+
+extern uint64_t
+lIdx_toMorton3d(const uint32_t coords[3], int bits)
+{
+	assert(bits >= 0 && bits <= LIDX_CURVE_MAXBITS);
+
+	return local_interleave3d(coords, bits);
+}
+
+extern uint64_t
+lIdx_toHilbert3d(const uint32_t coords[3], int bits)
+{
+	uint32_t x[3];
+	uint32_t t;
+
+	assert(bits >= 0 && bits <= LIDX_CURVE_MAXBITS);
+
+	if (bits == 0)
+		return UINT64_C(0);
+
+	x[0] = coords[0];
+	x[1] = coords[1];
+	x[2] = coords[2];
+
+	// Skilling's transformation (AIP Conf. Proc. 707, 381 (2004)) of the
+	// coordinates to the transposed Hilbert index, first undo the excess
+	// work of the rotations ...
+	for (uint32_t q = UINT32_C(1) << (bits - 1); q > 1; q >>= 1) {
+		uint32_t p = q - 1;
+		for (int i = 0; i < 3; i++) {
+			if (x[i] & q) {
+				x[0] ^= p;
+			} else {
+				t     = (x[0] ^ x[i]) & p;
+				x[0] ^= t;
+				x[i] ^= t;
+			}
+		}
+	}
+
+	// ... and then Gray encode.
+	x[1] ^= x[0];
+	x[2] ^= x[1];
+	t     = 0;
+	for (uint32_t q = UINT32_C(1) << (bits - 1); q > 1; q >>= 1) {
+		if (x[2] & q)
+			t ^= q - 1;
+	}
+	x[0] ^= t;
+	x[1] ^= t;
+	x[2] ^= t;
+
+	return local_interleave3d(x, bits);
+} /* lIdx_toHilbert3d */
+
+extern uint64_t
+lIdx_toKey3d(lIdxOrder_t    order,
+             const uint32_t coords[3],
+             const uint32_t dims[3],
+             int            bits)
+{
+	switch (order) {
+	case LIDX_ORDER_MORTON:
+		return lIdx_toMorton3d(coords, bits);
+	case LIDX_ORDER_HILBERT:
+		return lIdx_toHilbert3d(coords, bits);
+	default:
+		return lIdx_fromCoord3d(coords, dims);
+	}
+}
+
+extern int
+lIdx_getNumBits3d(const uint32_t dims[3])
+{
+	uint32_t dimMax = dims[0];
+	int      bits   = 0;
+
+	dimMax = (dims[1] > dimMax) ? dims[1] : dimMax;
+	dimMax = (dims[2] > dimMax) ? dims[2] : dimMax;
+
+	while ((bits < 32) && ((UINT64_C(1) << bits) < dimMax))
+		bits++;
+
+	return bits;
+}
+
+/*--- Implementations of local functions --------------------------------*/
+static uint64_t
+local_interleave3d(const uint32_t coords[3], int bits)
+{
+	uint64_t key = UINT64_C(0);
+
+	for (int b = bits - 1; b >= 0; b--) {
+		for (int i = 0; i < 3; i++)
+			key = (key << 1) | ((coords[i] >> b) & 1);
+	}
+
+	return key;
+}
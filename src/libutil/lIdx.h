@@ -20,6 +20,23 @@
 #include <stdint.h>
 
 
+/*--- Exported types ----------------------------------------------------*/
+
+/** @brief  Gives the available orderings of 3D coordinates. */
+typedef enum {
+	/** @brief  The usual row-major order of lIdx_fromCoord3d(). */
+	LIDX_ORDER_LINEAR,
+	/** @brief  The Morton (Z-order) curve. */
+	LIDX_ORDER_MORTON,
+	/** @brief  The Peano-Hilbert curve. */
+	LIDX_ORDER_HILBERT
+} lIdxOrder_t;
+
+
+/** @brief  The largest number of bits per dimension of curve keys. */
+#define LIDX_CURVE_MAXBITS 21
+
+
 /*--- Prototypes of exported functions ----------------------------------*/
 
 /**
@@ -140,6 +157,82 @@ lIdx_toCoordNd(uint64_t                 idx,
                uint32_t *restrict       coords);
 
 
+
+/**
+ * @brief  Translates 3D coordinates to their position on the Morton curve.
+ *
+ * The bits of the coordinates are interleaved, starting with the most
+ * significant bit of the first coordinate.
+ *
+ * @param[in]  coords
+ *                The coordinates, each must be smaller than 2^bits.
+ * @param[in]  bits
+ *                The number of bits per coordinate, at most
+ *                #LIDX_CURVE_MAXBITS.
+ *
+ * @return  Returns the key of the coordinates.
+ */
+extern uint64_t
+lIdx_toMorton3d(const uint32_t coords[3], int bits);
+
+
+/**
+ * @brief  Translates 3D coordinates to their position on the Peano-Hilbert
+ *         curve.
+ *
+ * Consecutive keys belong to coordinates that are neighbours, which the
+ * Morton curve does not guarantee.
+ *
+ * @param[in]  coords
+ *                The coordinates, each must be smaller than 2^bits.
+ * @param[in]  bits
+ *                The number of bits per coordinate, at most
+ *                #LIDX_CURVE_MAXBITS.
+ *
+ * @return  Returns the key of the coordinates.
+ */
+extern uint64_t
+lIdx_toHilbert3d(const uint32_t coords[3], int bits);
+
+
+/**
+ * @brief  Translates 3D coordinates to their key in a given ordering.
+ *
+ * @param[in]  order
+ *                The ordering to use.
+ * @param[in]  coords
+ *                The coordinates.
+ * @param[in]  dims
+ *                The extensions, every extension must be at most 2^bits
+ *                for the curve orderings.
+ * @param[in]  bits
+ *                The number of bits per coordinate for the curve
+ *                orderings, see lIdx_getNumBits3d().  Ignored for
+ *                #LIDX_ORDER_LINEAR.
+ *
+ * @return  Returns the key, sorting by it gives the ordering.
+ */
+extern uint64_t
+lIdx_toKey3d(lIdxOrder_t    order,
+             const uint32_t coords[3],
+             const uint32_t dims[3],
+             int            bits);
+
+
+/**
+ * @brief  Calculates the number of bits per coordinate required for the
+ *         curve keys of a 3D grid.
+ *
+ * @param[in]  dims
+ *                The extensions.
+ *
+ * @return  Returns the smallest number of bits such that 2^bits is at
+ *          least as large as the largest extension.
+ */
+extern int
+lIdx_getNumBits3d(const uint32_t dims[3]);
+
+
 #if (NDIM == 2)
 #  define lIdx_fromCoordNdim(a, b)  lIdx_fromCoord2d(a, b)
 #  define lIdx_toCoordNdim(a, b, c) lIdx_toCoord2d(a, b, c)
@@ -171,6 +264,10 @@ lIdx_toCoordNd(uint64_t                 idx,
  * @ingroup libutilMisc
  * @brief Provides functionality to convert multidimensional indices to
  *        linear indices and vice-versa.
+ *
+ * Besides the row-major linear index, 3D coordinates can be mapped onto
+ * the Morton and Peano-Hilbert space-filling curves.  Sorting by these
+ * keys keeps neighbouring coordinates close in memory or in a file.
  */
 
 
@@ -302,4 +302,109 @@ lIdx_toCoordNd_test(void)
 	return hasPassed ? true : false;
 }         /* lIdx_toCoordNd_test */
 
+extern bool
+lIdx_toMorton3d_test(void)
+{
+	bool     hasPassed = true;
+	int      rank      = 0;
+	uint32_t coord[3];
+#ifdef XMEM_TRACK_MEM
+	size_t   allocatedBytes = global_allocated_bytes;
+#endif
+#ifdef WITH_MPI
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+#endif
+
+	if (rank == 0)
+		printf("Testing %s... ", __func__);
+
+	coord[0] = 1;
+	coord[1] = 0;
+	coord[2] = 0;
+	if (lIdx_toMorton3d(coord, 1) != 4)
+		hasPassed = false;
+	if (lIdx_toMorton3d(coord, 2) != 4)
+		hasPassed = false;
+	coord[0] = 2;
+	coord[1] = 3;
+	coord[2] = 1;
+	// x = 10b, y = 11b, z = 01b gives 110 011b.
+	if (lIdx_toMorton3d(coord, 2) != 51)
+		hasPassed = false;
+	coord[0] = (UINT32_C(1) << LIDX_CURVE_MAXBITS) - 1;
+	coord[1] = coord[0];
+	coord[2] = coord[0];
+	if (lIdx_toMorton3d(coord, LIDX_CURVE_MAXBITS)
+	    != (UINT64_C(1) << (3 * LIDX_CURVE_MAXBITS)) - 1)
+		hasPassed = false;
+
+#ifdef XMEM_TRACK_MEM
+	if (allocatedBytes != global_allocated_bytes)
+		hasPassed = false;
+#endif
+
+	return hasPassed ? true : false;
+} /* lIdx_toMorton3d_test */
+
+extern bool
+lIdx_toHilbert3d_test(void)
+{
+	bool     hasPassed = true;
+	int      rank      = 0;
+	uint32_t coord[3];
+	uint32_t coordOfKey[512][3];
+	bool     isUsed[512];
+#ifdef XMEM_TRACK_MEM
+	size_t   allocatedBytes = global_allocated_bytes;
+#endif
+#ifdef WITH_MPI
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+#endif
+
+	if (rank == 0)
+		printf("Testing %s... ", __func__);
+
+	for (int i = 0; i < 512; i++)
+		isUsed[i] = false;
+
+	// Every key of an 8^3 grid must be used exactly once ...
+	for (coord[2] = 0; coord[2] < 8; coord[2]++) {
+		for (coord[1] = 0; coord[1] < 8; coord[1]++) {
+			for (coord[0] = 0; coord[0] < 8; coord[0]++) {
+				uint64_t key = lIdx_toHilbert3d(coord, 3);
+				if ((key >= 512) || isUsed[key]) {
+					hasPassed = false;
+					continue;
+				}
+				isUsed[key]        = true;
+				coordOfKey[key][0] = coord[0];
+				coordOfKey[key][1] = coord[1];
+				coordOfKey[key][2] = coord[2];
+			}
+		}
+	}
+
+	// ... starting at the origin and only stepping to direct neighbours.
+	if (hasPassed) {
+		if (coordOfKey[0][0] + coordOfKey[0][1] + coordOfKey[0][2] != 0)
+			hasPassed = false;
+		for (int i = 1; i < 512; i++) {
+			uint32_t dist = 0;
+			for (int j = 0; j < 3; j++)
+				dist += (coordOfKey[i][j] > coordOfKey[i - 1][j])
+				        ? coordOfKey[i][j] - coordOfKey[i - 1][j]
+				        : coordOfKey[i - 1][j] - coordOfKey[i][j];
+			if (dist != 1)
+				hasPassed = false;
+		}
+	}
+
+#ifdef XMEM_TRACK_MEM
+	if (allocatedBytes != global_allocated_bytes)
+		hasPassed = false;
+#endif
+
+	return hasPassed ? true : false;
+} /* lIdx_toHilbert3d_test */
+
 /*--- Implementations of local functions --------------------------------*/
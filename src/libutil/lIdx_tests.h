@@ -70,6 +70,22 @@ lIdx_fromCoordNd_test(void);
 extern bool
 lIdx_toCoordNd_test(void);
 
+/**
+ * @brief  Tests lIdx_toMorton3d().
+ *
+ * @return  Returns @c true if the tests succeeded and @c false otherwise.
+ */
+extern bool
+lIdx_toMorton3d_test(void);
+
+/**
+ * @brief  Tests lIdx_toHilbert3d().
+ *
+ * @return  Returns @c true if the tests succeeded and @c false otherwise.
+ */
+extern bool
+lIdx_toHilbert3d_test(void);
+
 
 /*--- Doxygen group definitions -----------------------------------------*/
 
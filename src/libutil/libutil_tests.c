@@ -12,6 +12,8 @@
 #include "endian_tests.h"
 #include "tile_tests.h"
 #include "lIdx_tests.h"
+#include "rng_tests.h"
+#include "prof_tests.h"
 #include "filename_tests.h"
 #include "bov_tests.h"
 #include "grafic_tests.h"
@@ -21,6 +23,9 @@
 #include "gadgetTOC_tests.h"
 #include "gadgetHeader_tests.h"
 #include "gadget_tests.h"
+#ifdef WITH_HDF5
+#  include "gadgetHDF5_tests.h"
+#endif
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
@@ -138,6 +143,16 @@ main(void)
 		RUNTEST(&lIdx_toCoord3d_test, hasFailed);
 		RUNTEST(&lIdx_fromCoordNd_test, hasFailed);
 		RUNTEST(&lIdx_toCoordNd_test, hasFailed);
+		RUNTEST(&lIdx_toMorton3d_test, hasFailed);
+		RUNTEST(&lIdx_toHilbert3d_test, hasFailed);
+	}
+
+	if (rank == 0) {
+		printf("\nRunning tests for rng:\n");
+#ifdef WITH_SPRNG
+		RUNTEST(&rng_fillGaussUnit_test, hasFailed);
+#endif
+		RUNTEST(&rng_getGaussUnitAtIndex_test, hasFailed);
 	}
 
 	if (rank == 0) {
@@ -309,6 +324,30 @@ main(void)
 		RUNTEST(&gadget_writeBlockToCurrentFile_test, hasFailed);
 	}
 
+#ifdef WITH_HDF5
+	if (rank == 0) {
+		printf("\nRunning tests for gadgetHDF5:\n");
+		RUNTEST(&gadgetHDF5_new_test, hasFailed);
+		RUNTEST(&gadgetHDF5_del_test, hasFailed);
+		RUNTEST(&gadgetHDF5_writeBlock_test, hasFailed);
+	}
+#endif
+
+#ifdef WITH_MPI
+	MPI_Barrier(MPI_COMM_WORLD);
+	if (rank == 0) {
+		printf("\nRunning tests for prof:\n");
+	}
+	RUNTESTMPI(&prof_startStop_test, hasFailed);
+	RUNTESTMPI(&prof_report_test, hasFailed);
+	RUNTESTMPI(&prof_memPeak_test, hasFailed);
+#else
+	printf("\nRunning tests for prof:\n");
+	RUNTEST(&prof_startStop_test, hasFailed);
+	RUNTEST(&prof_report_test, hasFailed);
+	RUNTEST(&prof_memPeak_test, hasFailed);
+#endif
+
 #ifdef WITH_MPI
 	MPI_Barrier(MPI_COMM_WORLD);
 	if (rank == 0) {
@@ -330,6 +369,8 @@ main(void)
 	RUNTESTMPI(&commScheme_fire_test, hasFailed);
 	RUNTESTMPI(&commScheme_fireBlock_test, hasFailed);
 	RUNTESTMPI(&commScheme_wait_test, hasFailed);
+	RUNTESTMPI(&commScheme_test_test, hasFailed);
+	RUNTESTMPI(&commScheme_persistent_test, hasFailed);
 
 	if (rank == 0)
 		printf("\nRunning tests for groupi:\n");
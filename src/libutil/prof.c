@@ -0,0 +1,816 @@
+// Copyright (C) 2012, Steffen Knollmann
+// Released under the terms of the GNU General Public License version 3.
+// This file is part of `ginnungagap'.
+
+
+/*--- Doxygen file description ------------------------------------------*/
+
+/**
+ * @file libutil/prof.c
+ * @ingroup libutilMisc
+ * @brief  This file provides the implementation of the profiling layer.
+ */
+
+
+/*--- Includes ----------------------------------------------------------*/
+#include "util_config.h"
+#include "prof.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <string.h>
+#include <assert.h>
+#if (defined WITH_MPI)
+#  include <mpi.h>
+#endif
+#if (defined WITH_OPENMP)
+#  include <omp.h>
+#endif
+#if (!defined WITH_MPI && !defined WITH_OPENMP)
+#  include <time.h>
+#endif
+#include "xmem.h"
+#include "xfile.h"
+#include "xstring.h"
+#include "diediedie.h"
+
+
+/*--- Local defines -----------------------------------------------------*/
+
+/** @brief  The maximal nesting depth of regions. */
+#define LOCAL_MAXDEPTH 32
+
+/** @brief  The maximal length of the path of a region. */
+#define LOCAL_MAXPATHLEN 256
+
+/** @brief  The maximal number of events that are recorded per rank. */
+#define LOCAL_MAXEVENTS 65536
+
+/** @brief  The tag for the messages sending the profile to rank 0. */
+#define LOCAL_MPI_TAG 4224
+
+
+/*--- Local structures --------------------------------------------------*/
+
+/** @brief  Describes a region as seen by one rank. */
+typedef struct {
+	/** @brief  The full path of the region. */
+	char     path[LOCAL_MAXPATHLEN];
+	/** @brief  The offset of the name of the region in the path. */
+	int32_t  nameOffset;
+	/** @brief  The index of the enclosing region, -1 if there is none. */
+	int32_t  parent;
+	/** @brief  The nesting depth, 0 for a top-level region. */
+	int32_t  depth;
+	/** @brief  The number of times the region was left. */
+	uint64_t numCalls;
+	/** @brief  The accumulated time spent in the region. */
+	double   time;
+	/** @brief  The largest number of tracked bytes within the region. */
+	uint64_t memPeak;
+} local_region_t;
+
+/** @brief  Describes one call of a region. */
+typedef struct {
+	/** @brief  The index of the region. */
+	int32_t  region;
+	/** @brief  The start time relative to the call of prof_enable(). */
+	double   start;
+	/** @brief  The time spent in the region. */
+	double   duration;
+	/** @brief  The largest number of tracked bytes during the call. */
+	uint64_t memPeak;
+} local_event_t;
+
+/** @brief  Describes a region reduced over all ranks. */
+typedef struct {
+	/** @brief  The full path of the region. */
+	const char *path;
+	/** @brief  The nesting depth. */
+	int32_t    depth;
+	/** @brief  The number of ranks that entered the region. */
+	int        numRanks;
+	/** @brief  The total number of calls on all ranks. */
+	uint64_t   numCalls;
+	/** @brief  The minimal time on any of the ranks. */
+	double     min;
+	/** @brief  The maximal time on any of the ranks. */
+	double     max;
+	/** @brief  The sum of the times of all ranks. */
+	double     sum;
+	/** @brief  The smallest memory peak on any of the ranks. */
+	uint64_t   memPeakMin;
+	/** @brief  The largest memory peak on any of the ranks. */
+	uint64_t   memPeakMax;
+	/** @brief  The rank with the largest memory peak. */
+	int        memPeakRank;
+} local_summary_t;
+
+/** @brief  Describes the memory peak of one tag on one rank. */
+typedef struct {
+	/** @brief  The name of the tag. */
+	char     name[XMEM_TRACK_MAXTAGLEN + 1];
+	/** @brief  The peak. */
+	uint64_t peak;
+} local_tag_t;
+
+
+/*--- Local variables ---------------------------------------------------*/
+
+/** @brief  Flags whether the profiler is recording. */
+static bool local_isEnabled = false;
+
+/** @brief  The time of the call of prof_enable(). */
+static double local_origin = 0.0;
+
+/** @brief  All regions seen so far, in the order they were first entered. */
+static local_region_t *local_regions = NULL;
+
+/** @brief  The number of regions. */
+static int local_numRegions = 0;
+
+/** @brief  The number of regions that fit into the allocated array. */
+static int local_numRegionsAlloc = 0;
+
+/** @brief  The regions that are currently open. */
+static int local_stackRegion[LOCAL_MAXDEPTH];
+
+/** @brief  The times the open regions were entered. */
+static double local_stackStart[LOCAL_MAXDEPTH];
+
+/**
+ * @brief  The memory peaks of the enclosing regions up to the time the
+ *         open regions were entered.
+ */
+static size_t local_stackMemPeak[LOCAL_MAXDEPTH];
+
+/** @brief  The number of open regions. */
+static int local_stackDepth = 0;
+
+/** @brief  The recorded events. */
+static local_event_t *local_events = NULL;
+
+/** @brief  The number of recorded events. */
+static uint64_t local_numEvents = 0;
+
+/** @brief  The number of events that fit into the allocated array. */
+static uint64_t local_numEventsAlloc = 0;
+
+/** @brief  The number of events that were not recorded. */
+static uint64_t local_numEventsDropped = 0;
+
+#if (!defined WITH_MPI && !defined WITH_OPENMP)
+
+/**
+ * @brief  The conversion factor from the result of clock() to seconds.
+ */
+static double local_cpsInv = 1. / ((double)CLOCKS_PER_SEC);
+#endif
+
+
+/*--- Prototypes of local functions -------------------------------------*/
+
+/**
+ * @brief  Returns the current wall clock time in seconds.
+ *
+ * @return  Returns the time, only differences are meaningful.
+ */
+static double
+local_getTime(void);
+
+
+/**
+ * @brief  Checks whether the calls should be ignored.
+ *
+ * @return  Returns @c true if the profiler is disabled or if the call is
+ *          made from within an OpenMP parallel region.
+ */
+static bool
+local_isIgnored(void);
+
+
+/**
+ * @brief  Looks up a region, creating it if it does not exist yet.
+ *
+ * @param[in]  parent
+ *                The index of the enclosing region, -1 for a top-level
+ *                region.
+ * @param[in]  *name
+ *                The name of the region.
+ *
+ * @return  Returns the index of the region.
+ */
+static int
+local_getRegion(int parent, const char *name);
+
+
+/**
+ * @brief  Records an event.
+ *
+ * @param[in]  region
+ *                The index of the region.
+ * @param[in]  start
+ *                The start time of the event.
+ * @param[in]  duration
+ *                The duration of the event.
+ * @param[in]  memPeak
+ *                The memory peak during the event.
+ *
+ * @return  Returns nothing.
+ */
+static void
+local_addEvent(int region, double start, double duration, uint64_t memPeak);
+
+
+/**
+ * @brief  Merges the regions of one rank into the summary.
+ *
+ * @param[in,out]  **summary
+ *                    The summary, will be grown as required.
+ * @param[in,out]  *numSummary
+ *                    The number of regions in the summary.
+ * @param[in]      *regions
+ *                    The regions of the rank.
+ * @param[in]      numRegions
+ *                    The number of regions of the rank.
+ * @param[in]      rank
+ *                    The rank the regions belong to.
+ *
+ * @return  Returns nothing.
+ */
+static void
+local_mergeRegions(local_summary_t      **summary,
+                   int                  *numSummary,
+                   const local_region_t *regions,
+                   int                  numRegions,
+                   int                  rank);
+
+
+/**
+ * @brief  Merges the memory peaks of the tags of one rank.
+ *
+ * @param[in,out]  **summary
+ *                    The peaks of all tags (maximum over the ranks), will
+ *                    be grown as required.
+ * @param[in,out]  *numSummary
+ *                    The number of tags in the summary.
+ * @param[in]      *tags
+ *                    The tags of the rank.
+ * @param[in]      numTags
+ *                    The number of tags of the rank.
+ *
+ * @return  Returns nothing.
+ */
+static void
+local_mergeTags(local_tag_t       **summary,
+                int               *numSummary,
+                const local_tag_t *tags,
+                int               numTags);
+
+
+/**
+ * @brief  Collects the memory peaks of the tags of this rank.
+ *
+ * @param[out]  *numTags
+ *                 Will receive the number of tags.
+ *
+ * @return  Returns a new array holding the tags.
+ */
+static local_tag_t *
+local_getTags(int *numTags);
+
+
+/**
+ * @brief  Writes the events of one rank to the trace file.
+ *
+ * @param[in,out]  *f
+ *                    The trace file.
+ * @param[in]      rank
+ *                    The rank the events belong to.
+ * @param[in]      *regions
+ *                    The regions of that rank.
+ * @param[in]      *events
+ *                    The events of that rank.
+ * @param[in]      numEvents
+ *                    The number of events.
+ *
+ * @return  Returns nothing.
+ */
+static void
+local_writeEvents(FILE                 *f,
+                  int                  rank,
+                  const local_region_t *regions,
+                  const local_event_t  *events,
+                  uint64_t             numEvents);
+
+
+/**
+ * @brief  Writes the reduced profile.
+ *
+ * @param[in]  *fname
+ *                The name of the file to write.
+ * @param[in]  *summary
+ *                The reduced regions.
+ * @param[in]  numSummary
+ *                The number of reduced regions.
+ * @param[in]  size
+ *                The number of ranks.
+ * @param[in]  numEventsDropped
+ *                The number of events that were dropped on all ranks.
+ * @param[in]  *tags
+ *                The memory peaks of the tags.
+ * @param[in]  numTags
+ *                The number of tags.
+ *
+ * @return  Returns nothing.
+ */
+static void
+local_writeSummary(const char            *fname,
+                   const local_summary_t *summary,
+                   int                   numSummary,
+                   int                   size,
+                   uint64_t              numEventsDropped,
+                   const local_tag_t     *tags,
+                   int                   numTags);
+
+
+/**
+ * @brief  Holds all ranks until rank 0 has written the report.
+ *
+ * Without this, ranks could leave prof_report() and, for example,
+ * finalize or read the report files before they are complete.
+ *
+ * @return  Returns nothing.
+ */
+static void
+local_waitForReport(void);
+
+
+/*--- Implementations of exported functios ------------------------------*/
+extern void
+prof_enable(void)
+{
+	local_isEnabled = true;
+	local_origin    = local_getTime();
+}
+
+extern bool
+prof_isEnabled(void)
+{
+	return local_isEnabled;
+}
+
+extern void
+prof_start(const char *name)
+{
+	int parent;
+
+	if (local_isIgnored())
+		return;
+
+	assert(name != NULL);
+
+	if (local_stackDepth == LOCAL_MAXDEPTH) {
+		fprintf(stderr, "Profiling regions nested too deeply at %s.\n",
+		        name);
+		diediedie(EXIT_FAILURE);
+	}
+
+	parent = (local_stackDepth == 0) ? -1
+	         : local_stackRegion[local_stackDepth - 1];
+	local_stackRegion[local_stackDepth]  = local_getRegion(parent, name);
+	local_stackMemPeak[local_stackDepth] = xmem_getTrackedPeak();
+	xmem_setTrackedPeak(xmem_getTrackedBytes());
+	local_stackStart[local_stackDepth]   = local_getTime();
+	local_stackDepth++;
+}
+
+extern void
+prof_stop(const char *name)
+{
+	double         now;
+	local_region_t *region;
+	size_t         memPeak;
+
+	if (local_isIgnored())
+		return;
+
+	now     = local_getTime();
+	memPeak = xmem_getTrackedPeak();
+
+	assert(name != NULL);
+
+	if (local_stackDepth == 0) {
+		fprintf(stderr, "Profiling region %s left but not entered.\n",
+		        name);
+		diediedie(EXIT_FAILURE);
+	}
+	local_stackDepth--;
+	region = local_regions + local_stackRegion[local_stackDepth];
+	if (strcmp(region->path + region->nameOffset, name) != 0) {
+		fprintf(stderr, "Profiling region %s left while in %s.\n",
+		        name, region->path);
+		diediedie(EXIT_FAILURE);
+	}
+
+	region->numCalls++;
+	region->time   += now - local_stackStart[local_stackDepth];
+	region->memPeak = (memPeak > region->memPeak) ? memPeak
+	                  : region->memPeak;
+	local_addEvent(local_stackRegion[local_stackDepth],
+	               local_stackStart[local_stackDepth] - local_origin,
+	               now - local_stackStart[local_stackDepth], memPeak);
+
+	// The enclosing region has seen this peak, too.
+	if (local_stackMemPeak[local_stackDepth] > memPeak)
+		xmem_setTrackedPeak(local_stackMemPeak[local_stackDepth]);
+}
+
+extern void
+prof_report(const char *prefix)
+{
+	int             rank             = 0;
+	int             size             = 1;
+	uint64_t        numEventsDropped = local_numEventsDropped;
+	local_summary_t *summary         = NULL;
+	int             numSummary       = 0;
+	FILE            *f               = NULL;
+	char            *fname;
+	local_tag_t     *tags, *tagSummary = NULL;
+	int             numTags, numTagSummary = 0;
+
+	assert(prefix != NULL);
+
+	if (!local_isEnabled)
+		return;
+
+	if (local_stackDepth != 0) {
+		fprintf(stderr, "Profiling region %s not left before report.\n",
+		        local_regions[local_stackRegion[local_stackDepth - 1]].path);
+		diediedie(EXIT_FAILURE);
+	}
+
+	tags = local_getTags(&numTags);
+#ifdef WITH_MPI
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+	MPI_Comm_size(MPI_COMM_WORLD, &size);
+	MPI_Reduce(&local_numEventsDropped, &numEventsDropped, 1,
+	           MPI_UINT64_T, MPI_SUM, 0, MPI_COMM_WORLD);
+	if (rank != 0) {
+		int nums[3] = { local_numRegions, (int)local_numEvents, numTags };
+		MPI_Send(nums, 3, MPI_INT, 0, LOCAL_MPI_TAG, MPI_COMM_WORLD);
+		MPI_Send(local_regions, (int)(nums[0] * sizeof(local_region_t)),
+		         MPI_BYTE, 0, LOCAL_MPI_TAG, MPI_COMM_WORLD);
+		MPI_Send(local_events, (int)(nums[1] * sizeof(local_event_t)),
+		         MPI_BYTE, 0, LOCAL_MPI_TAG, MPI_COMM_WORLD);
+		MPI_Send(tags, (int)(nums[2] * sizeof(local_tag_t)),
+		         MPI_BYTE, 0, LOCAL_MPI_TAG, MPI_COMM_WORLD);
+	}
+#endif
+	if (rank != 0) {
+		xfree(tags);
+		local_waitForReport();
+		return;
+	}
+
+	fname = xstrmerge(prefix, ".trace.json");
+	f     = xfopen(fname, "w");
+	xfree(fname);
+	fprintf(f, "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n");
+
+	for (int r = 0; r < size; r++) {
+		local_region_t *regions    = local_regions;
+		local_event_t  *events     = local_events;
+		int            numRegions  = local_numRegions;
+		uint64_t       numEvents   = local_numEvents;
+#ifdef WITH_MPI
+		if (r != 0) {
+			int nums[3];
+			MPI_Recv(nums, 3, MPI_INT, r, LOCAL_MPI_TAG, MPI_COMM_WORLD,
+			         MPI_STATUS_IGNORE);
+			numRegions = nums[0];
+			numEvents  = (uint64_t)nums[1];
+			numTags    = nums[2];
+			regions    = xmalloc(sizeof(local_region_t) * (numRegions + 1));
+			events     = xmalloc(sizeof(local_event_t) * (numEvents + 1));
+			xfree(tags);
+			tags       = xmalloc(sizeof(local_tag_t) * (numTags + 1));
+			MPI_Recv(regions, (int)(numRegions * sizeof(local_region_t)),
+			         MPI_BYTE, r, LOCAL_MPI_TAG, MPI_COMM_WORLD,
+			         MPI_STATUS_IGNORE);
+			MPI_Recv(events, (int)(numEvents * sizeof(local_event_t)),
+			         MPI_BYTE, r, LOCAL_MPI_TAG, MPI_COMM_WORLD,
+			         MPI_STATUS_IGNORE);
+			MPI_Recv(tags, (int)(numTags * sizeof(local_tag_t)),
+			         MPI_BYTE, r, LOCAL_MPI_TAG, MPI_COMM_WORLD,
+			         MPI_STATUS_IGNORE);
+		}
+#endif
+		local_mergeRegions(&summary, &numSummary, regions, numRegions, r);
+		local_mergeTags(&tagSummary, &numTagSummary, tags, numTags);
+		if (r == 0)
+			fprintf(f, "  {\"name\": \"process_name\", \"ph\": \"M\", "
+			        "\"pid\": %i, \"args\": {\"name\": \"rank %i\"}}",
+			        r, r);
+		else
+			fprintf(f, ",\n  {\"name\": \"process_name\", \"ph\": \"M\", "
+			        "\"pid\": %i, \"args\": {\"name\": \"rank %i\"}}",
+			        r, r);
+		local_writeEvents(f, r, regions, events, numEvents);
+		if (r != 0) {
+			xfree(events);
+			xfree(regions);
+		}
+	}
+
+	fprintf(f, "\n]}\n");
+	xfclose(&f);
+
+	for (int i = 0; i < numSummary; i++) {
+		if (summary[i].numRanks < size) {
+			summary[i].min        = 0.0;
+			summary[i].memPeakMin = 0;
+		}
+	}
+	fname = xstrmerge(prefix, ".json");
+	local_writeSummary(fname, summary, numSummary, size, numEventsDropped,
+	                   tagSummary, numTagSummary);
+	xfree(fname);
+
+	xfree(tags);
+	if (tagSummary != NULL)
+		xfree(tagSummary);
+
+	for (int i = 0; i < numSummary; i++)
+		xfree((char *)(summary[i].path));
+	xfree(summary);
+	local_waitForReport();
+} /* prof_report */
+
+extern void
+prof_reset(void)
+{
+	if (local_regions != NULL)
+		xfree(local_regions);
+	if (local_events != NULL)
+		xfree(local_events);
+	local_regions          = NULL;
+	local_numRegions       = 0;
+	local_numRegionsAlloc  = 0;
+	local_events           = NULL;
+	local_numEvents        = 0;
+	local_numEventsAlloc   = 0;
+	local_numEventsDropped = 0;
+	local_stackDepth       = 0;
+	local_isEnabled        = false;
+}
+
+/*--- Implementations of local functions --------------------------------*/
+static double
+local_getTime(void)
+{
+#if (defined WITH_MPI)
+	return MPI_Wtime();
+#elif (defined WITH_OPENMP)
+	return omp_get_wtime();
+#else
+	return clock() * local_cpsInv;
+#endif
+}
+
+static bool
+local_isIgnored(void)
+{
+	if (!local_isEnabled)
+		return true;
+#ifdef WITH_OPENMP
+	if (omp_in_parallel())
+		return true;
+#endif
+
+	return false;
+}
+
+static int
+local_getRegion(int parent, const char *name)
+{
+	local_region_t *region;
+
+	for (int i = 0; i < local_numRegions; i++) {
+		region = local_regions + i;
+		if ((region->parent == parent)
+		    && (strcmp(region->path + region->nameOffset, name) == 0))
+			return i;
+	}
+
+	if (local_numRegions == local_numRegionsAlloc) {
+		local_numRegionsAlloc += 32;
+		local_regions          = xrealloc(local_regions,
+		                                  sizeof(local_region_t)
+		                                  * local_numRegionsAlloc);
+	}
+
+	region = local_regions + local_numRegions;
+	if (parent < 0) {
+		region->path[0]    = '\0';
+		region->nameOffset = 0;
+		region->depth      = 0;
+	} else {
+		strcpy(region->path, local_regions[parent].path);
+		strcat(region->path, "/");
+		region->nameOffset = (int32_t)strlen(region->path);
+		region->depth      = local_regions[parent].depth + 1;
+	}
+	if (region->nameOffset + strlen(name) >= LOCAL_MAXPATHLEN) {
+		fprintf(stderr, "Path of profiling region %s too long.\n", name);
+		diediedie(EXIT_FAILURE);
+	}
+	strcat(region->path, name);
+	region->parent   = parent;
+	region->numCalls = 0;
+	region->time     = 0.0;
+	region->memPeak  = 0;
+
+	return local_numRegions++;
+}
+
+static void
+local_addEvent(int region, double start, double duration, uint64_t memPeak)
+{
+	if (local_numEvents == LOCAL_MAXEVENTS) {
+		local_numEventsDropped++;
+		return;
+	}
+
+	if (local_numEvents == local_numEventsAlloc) {
+		local_numEventsAlloc = (local_numEventsAlloc == 0) ? 1024
+		                       : 2 * local_numEventsAlloc;
+		local_events         = xrealloc(local_events,
+		                                sizeof(local_event_t)
+		                                * local_numEventsAlloc);
+	}
+
+	local_events[local_numEvents].region   = region;
+	local_events[local_numEvents].start    = start;
+	local_events[local_numEvents].duration = duration;
+	local_events[local_numEvents].memPeak  = memPeak;
+	local_numEvents++;
+}
+
+static void
+local_mergeRegions(local_summary_t      **summary,
+                   int                  *numSummary,
+                   const local_region_t *regions,
+                   int                  numRegions,
+                   int                  rank)
+{
+	for (int i = 0; i < numRegions; i++) {
+		local_summary_t *s = NULL;
+
+		for (int j = 0; j < *numSummary; j++) {
+			if (strcmp((*summary)[j].path, regions[i].path) == 0) {
+				s = *summary + j;
+				break;
+			}
+		}
+		if (s == NULL) {
+			*summary = xrealloc(*summary,
+			                    sizeof(local_summary_t) * (*numSummary + 1));
+			s           = *summary + *numSummary;
+			s->path     = xstrdup(regions[i].path);
+			s->depth    = regions[i].depth;
+			s->numRanks = 0;
+			s->numCalls = 0;
+			s->min         = regions[i].time;
+			s->max         = regions[i].time;
+			s->sum         = 0.0;
+			s->memPeakMin  = regions[i].memPeak;
+			s->memPeakMax  = regions[i].memPeak;
+			s->memPeakRank = rank;
+			(*numSummary)++;
+		}
+		s->numRanks++;
+		s->numCalls += regions[i].numCalls;
+		s->min       = (regions[i].time < s->min) ? regions[i].time : s->min;
+		s->max       = (regions[i].time > s->max) ? regions[i].time : s->max;
+		s->sum      += regions[i].time;
+		if (regions[i].memPeak < s->memPeakMin)
+			s->memPeakMin = regions[i].memPeak;
+		if (regions[i].memPeak > s->memPeakMax) {
+			s->memPeakMax  = regions[i].memPeak;
+			s->memPeakRank = rank;
+		}
+	}
+}
+
+static void
+local_mergeTags(local_tag_t       **summary,
+                int               *numSummary,
+                const local_tag_t *tags,
+                int               numTags)
+{
+	for (int i = 0; i < numTags; i++) {
+		local_tag_t *t = NULL;
+
+		for (int j = 0; j < *numSummary; j++) {
+			if (strcmp((*summary)[j].name, tags[i].name) == 0) {
+				t = *summary + j;
+				break;
+			}
+		}
+		if (t == NULL) {
+			*summary = xrealloc(*summary,
+			                    sizeof(local_tag_t) * (*numSummary + 1));
+			t        = *summary + *numSummary;
+			strcpy(t->name, tags[i].name);
+			t->peak  = 0;
+			(*numSummary)++;
+		}
+		t->peak = (tags[i].peak > t->peak) ? tags[i].peak : t->peak;
+	}
+}
+
+static local_tag_t *
+local_getTags(int *numTags)
+{
+	local_tag_t *tags;
+
+	*numTags = xmem_getTrackedNumTags();
+	tags     = xmalloc(sizeof(local_tag_t) * (*numTags + 1));
+	for (int i = 0; i < *numTags; i++) {
+		size_t peak;
+		strcpy(tags[i].name, xmem_getTrackedTag(i, &peak));
+		tags[i].peak = (uint64_t)peak;
+	}
+
+	return tags;
+}
+
+static void
+local_writeEvents(FILE                 *f,
+                  int                  rank,
+                  const local_region_t *regions,
+                  const local_event_t  *events,
+                  uint64_t             numEvents)
+{
+	for (uint64_t i = 0; i < numEvents; i++) {
+		const local_region_t *region = regions + events[i].region;
+
+		fprintf(f, ",\n  {\"name\": \"%s\", \"cat\": \"%s\", "
+		        "\"ph\": \"X\", \"pid\": %i, \"tid\": 0, "
+		        "\"ts\": %.3f, \"dur\": %.3f, "
+		        "\"args\": {\"memPeak\": %" PRIu64 "}}",
+		        region->path + region->nameOffset, region->path, rank,
+		        events[i].start * 1e6, events[i].duration * 1e6,
+		        events[i].memPeak);
+	}
+}
+
+static void
+local_writeSummary(const char            *fname,
+                   const local_summary_t *summary,
+                   int                   numSummary,
+                   int                   size,
+                   uint64_t              numEventsDropped,
+                   const local_tag_t     *tags,
+                   int                   numTags)
+{
+	FILE *f = xfopen(fname, "w");
+
+	fprintf(f, "{\n  \"numRanks\": %i,\n", size);
+	fprintf(f, "  \"numEventsDropped\": %" PRIu64 ",\n", numEventsDropped);
+	fprintf(f, "  \"memPeakPerTag\": [");
+	for (int i = 0; i < numTags; i++)
+		fprintf(f, "%s\n    {\"tag\": \"%s\", \"max\": %" PRIu64 "}",
+		        (i == 0) ? "" : ",", tags[i].name, tags[i].peak);
+	fprintf(f, "\n  ],\n");
+	fprintf(f, "  \"regions\": [");
+	for (int i = 0; i < numSummary; i++) {
+		double mean = summary[i].sum / size;
+
+		fprintf(f, "%s\n    {\"path\": \"%s\", \"depth\": %i, "
+		        "\"numRanks\": %i, \"numCalls\": %" PRIu64 ", "
+		        "\"min\": %.6e, \"mean\": %.6e, \"max\": %.6e, "
+		        "\"imbalance\": %.4f, "
+		        "\"memPeakMin\": %" PRIu64 ", \"memPeakMax\": %" PRIu64 ", "
+		        "\"memPeakRank\": %i}",
+		        (i == 0) ? "" : ",", summary[i].path,
+		        (int)(summary[i].depth), summary[i].numRanks,
+		        summary[i].numCalls, summary[i].min, mean, summary[i].max,
+		        (mean > 0.0) ? summary[i].max / mean : 1.0,
+		        summary[i].memPeakMin, summary[i].memPeakMax,
+		        summary[i].memPeakRank);
+	}
+	fprintf(f, "\n  ]\n}\n");
+
+	xfclose(&f);
+}
+
+static void
+local_waitForReport(void)
+{
+#ifdef WITH_MPI
+	MPI_Barrier(MPI_COMM_WORLD);
+#endif
+}
@@ -0,0 +1,128 @@
+// Copyright (C) 2012, Steffen Knollmann
+// Released under the terms of the GNU General Public License version 3.
+// This file is part of `ginnungagap'.
+
+#ifndef PROF_H
+#define PROF_H
+
+
+/*--- Doxygen file description ------------------------------------------*/
+
+/**
+ * @file libutil/prof.h
+ * @ingroup libutilMisc
+ * @brief  This file provides the interface of the profiling layer.
+ *
+ * The profiler records named regions that may be nested.  Every region
+ * is identified by its path, i.e. the names of all enclosing regions and
+ * its own name, joined with a slash, for example
+ * <tt>deltaX/fftBackward/transpose/comm</tt>.  For each path the number of calls,
+ * the accumulated wall time, and the peak of the tracked memory (see
+ * xmem_trackAlloc()) are kept per rank.  Additionally, every single call
+ * is recorded as an event (up to a fixed number per rank) to produce a
+ * timeline.
+ *
+ * At the end of the run prof_report() reduces the accumulated times over
+ * all ranks and writes two files:
+ *  - <tt>\<prefix\>.json</tt> lists for every region the number of calls
+ *    (summed over all ranks) and the minimum, mean, and maximum time over all ranks as well as
+ *    the imbalance (the ratio of the maximum to the mean).  Likewise
+ *    the minimum and maximum of the memory peaks are given, together
+ *    with the rank that has the largest peak, and for every tag of the
+ *    tracked memory the largest peak of all ranks.  A rank that never
+ *    entered a region counts with a time and memory peak of zero.
+ *  - <tt>\<prefix\>.trace.json</tt> holds the events in the Chrome trace
+ *    event format (one process per rank), it can be loaded into
+ *    <tt>chrome://tracing</tt> or Perfetto.
+ *
+ * Regions must be entered and left by all threads of a rank together,
+ * calls made from within an OpenMP parallel region are ignored.  As
+ * long as the profiler is not enabled, prof_start() and prof_stop() only
+ * check a flag and return.
+ */
+
+
+/*--- Includes ----------------------------------------------------------*/
+#include "util_config.h"
+#include <stdbool.h>
+
+
+/*--- Prototypes of exported functions ----------------------------------*/
+
+/**
+ * @brief  Enables the profiler.
+ *
+ * The time of this call is used as the origin of the timeline, it should
+ * hence be called at the same point of the program on all ranks.
+ *
+ * @return  Returns nothing.
+ */
+extern void
+prof_enable(void);
+
+
+/**
+ * @brief  Checks whether the profiler is enabled.
+ *
+ * @return  Returns @c true if prof_enable() has been called (and
+ *          prof_reset() not afterwards), @c false otherwise.
+ */
+extern bool
+prof_isEnabled(void);
+
+
+/**
+ * @brief  Enters a region.
+ *
+ * @param[in]  *name
+ *                The name of the region.  Should not contain a slash or
+ *                characters that need escaping in JSON.  Must not be
+ *                @c NULL.
+ *
+ * @return  Returns nothing.
+ */
+extern void
+prof_start(const char *name);
+
+
+/**
+ * @brief  Leaves a region.
+ *
+ * @param[in]  *name
+ *                The name of the region, this must be the name that was
+ *                passed to the matching call of prof_start().
+ *
+ * @return  Returns nothing.
+ */
+extern void
+prof_stop(const char *name);
+
+
+/**
+ * @brief  Reduces the profile over all ranks and writes the report.
+ *
+ * This is a collective operation in MPI mode, the files are written by
+ * rank 0 and are complete on all ranks when this function returns.  All
+ * regions must have been left.  Does nothing if the
+ * profiler is not enabled.
+ *
+ * @param[in]  *prefix
+ *                The prefix of the files to write, see the file
+ *                description.  Must not be @c NULL.
+ *
+ * @return  Returns nothing.
+ */
+extern void
+prof_report(const char *prefix);
+
+
+/**
+ * @brief  Discards all recorded data and disables the profiler.
+ *
+ * @return  Returns nothing.
+ */
+extern void
+prof_reset(void);
+
+
+#endif
@@ -0,0 +1,267 @@
+// Copyright (C) 2012, Steffen Knollmann
+// Released under the terms of the GNU General Public License version 3.
+// This file is part of `ginnungagap'.
+
+
+/*--- Doxygen file description ------------------------------------------*/
+
+/**
+ * @file  libutil/prof_tests.c
+ * @ingroup  libutilMisc
+ * @brief  Implements the tests for the profiler.
+ */
+
+
+/*--- Includes ----------------------------------------------------------*/
+#include "util_config.h"
+#include "prof_tests.h"
+#include "prof.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef WITH_MPI
+#  include <mpi.h>
+#endif
+#include "xmem.h"
+#include "xfile.h"
+
+
+/*--- Local defines -----------------------------------------------------*/
+#define LOCAL_PREFIX "prof_test"
+
+
+/*--- Prototypes of local functions -------------------------------------*/
+
+/**
+ * @brief  Reads a whole file into a string.
+ *
+ * @param[in]  *fname
+ *                The file to read.
+ *
+ * @return  Returns a newly allocated string holding the content.
+ */
+static char *
+local_readFile(const char *fname);
+
+
+/**
+ * @brief  Checks the memory peak of a region in the summary.
+ *
+ * @param[in]  *summary
+ *                The content of the summary file.
+ * @param[in]  *path
+ *                The path of the region.
+ * @param[in]  peak
+ *                The expected peak (on all ranks).
+ *
+ * @return  Returns @c true if the region is found and has the expected
+ *          peak, @c false otherwise.
+ */
+static bool
+local_checkMemPeak(const char *summary, const char *path, size_t peak);
+
+
+/*--- Implementations of exported functions -----------------------------*/
+extern bool
+prof_startStop_test(void)
+{
+	bool   hasPassed = true;
+	int    rank      = 0;
+#ifdef XMEM_TRACK_MEM
+	size_t allocatedBytes = global_allocated_bytes;
+#endif
+#ifdef WITH_MPI
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+#endif
+
+	if (rank == 0)
+		printf("Testing %s... ", __func__);
+
+	if (prof_isEnabled())
+		hasPassed = false;
+	// Must be no-ops while the profiler is disabled.
+	prof_start("outer");
+	prof_stop("outer");
+#ifdef XMEM_TRACK_MEM
+	if (allocatedBytes != global_allocated_bytes)
+		hasPassed = false;
+#endif
+
+	prof_enable();
+	if (!prof_isEnabled())
+		hasPassed = false;
+	prof_start("outer");
+	prof_start("inner");
+	prof_stop("inner");
+	prof_stop("outer");
+	prof_reset();
+	if (prof_isEnabled())
+		hasPassed = false;
+#ifdef XMEM_TRACK_MEM
+	if (allocatedBytes != global_allocated_bytes)
+		hasPassed = false;
+#endif
+
+	return hasPassed ? true : false;
+}
+
+extern bool
+prof_report_test(void)
+{
+	bool   hasPassed = true;
+	int    rank      = 0;
+	int    size      = 1;
+#ifdef XMEM_TRACK_MEM
+	size_t allocatedBytes = global_allocated_bytes;
+#endif
+#ifdef WITH_MPI
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+	MPI_Comm_size(MPI_COMM_WORLD, &size);
+#endif
+
+	if (rank == 0)
+		printf("Testing %s... ", __func__);
+
+	prof_enable();
+	for (int i = 0; i < 3; i++) {
+		prof_start("outer");
+		prof_start("inner");
+		prof_stop("inner");
+		prof_stop("outer");
+	}
+	// Only present on rank 0 and a different region than outer/inner.
+	if (rank == 0) {
+		prof_start("inner");
+		prof_stop("inner");
+	}
+	prof_report(LOCAL_PREFIX);
+	prof_reset();
+
+	if (rank == 0) {
+		char *summary = local_readFile(LOCAL_PREFIX ".json");
+		char *trace   = local_readFile(LOCAL_PREFIX ".trace.json");
+		char expected[128];
+
+		sprintf(expected, "\"numRanks\": %i", size);
+		if (strstr(summary, expected) == NULL)
+			hasPassed = false;
+		sprintf(expected, "\"path\": \"outer/inner\", \"depth\": 1, "
+		        "\"numRanks\": %i, \"numCalls\": %i", size, 3 * size);
+		if (strstr(summary, expected) == NULL)
+			hasPassed = false;
+		if (strstr(summary, "\"path\": \"inner\", \"depth\": 0, "
+		           "\"numRanks\": 1, \"numCalls\": 1") == NULL)
+			hasPassed = false;
+		if (strstr(trace, "\"cat\": \"outer/inner\"") == NULL)
+			hasPassed = false;
+
+		xfree(trace);
+		xfree(summary);
+		remove(LOCAL_PREFIX ".json");
+		remove(LOCAL_PREFIX ".trace.json");
+	}
+#ifdef XMEM_TRACK_MEM
+	if (allocatedBytes != global_allocated_bytes)
+		hasPassed = false;
+#endif
+
+	return hasPassed ? true : false;
+} /* prof_report_test */
+
+extern bool
+prof_memPeak_test(void)
+{
+	bool   hasPassed = true;
+	int    rank      = 0;
+	size_t base      = xmem_getTrackedBytes();
+	char   a[2], b[2];
+#ifdef XMEM_TRACK_MEM
+	size_t allocatedBytes = global_allocated_bytes;
+#endif
+#ifdef WITH_MPI
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+#endif
+
+	if (rank == 0)
+		printf("Testing %s... ", __func__);
+
+	// Only the bookkeeping matters, the pointers need not be real
+	// allocations.
+	prof_enable();
+	prof_start("outer");
+	xmem_trackAlloc(a, 1000, "profTest");
+	prof_start("inner");
+	xmem_trackAlloc(b, 500, "profTest");
+	xmem_trackFree(b);
+	prof_stop("inner");
+	xmem_trackFree(a);
+	prof_start("second");
+	prof_stop("second");
+	prof_stop("outer");
+	if (xmem_getTrackedBytes() != base)
+		hasPassed = false;
+	prof_report(LOCAL_PREFIX);
+	prof_reset();
+
+	if (rank == 0) {
+		char *summary = local_readFile(LOCAL_PREFIX ".json");
+
+		if (!local_checkMemPeak(summary, "outer", base + 1500))
+			hasPassed = false;
+		if (!local_checkMemPeak(summary, "outer/inner", base + 1500))
+			hasPassed = false;
+		if (!local_checkMemPeak(summary, "outer/second", base))
+			hasPassed = false;
+		if (strstr(summary, "{\"tag\": \"profTest\", \"max\": 1500}")
+		    == NULL)
+			hasPassed = false;
+
+		xfree(summary);
+		remove(LOCAL_PREFIX ".json");
+		remove(LOCAL_PREFIX ".trace.json");
+	}
+#ifdef XMEM_TRACK_MEM
+	if (allocatedBytes != global_allocated_bytes)
+		hasPassed = false;
+#endif
+
+	return hasPassed ? true : false;
+} /* prof_memPeak_test */
+
+/*--- Implementations of local functions --------------------------------*/
+static char *
+local_readFile(const char *fname)
+{
+	FILE *f = xfopen(fname, "r");
+	long size;
+	char *content;
+
+	xfseek(f, 0L, SEEK_END);
+	size    = xftell(f);
+	xfseek(f, 0L, SEEK_SET);
+	content = xmalloc(size + 1);
+	xfread(content, 1, size, f);
+	content[size] = '\0';
+	xfclose(&f);
+
+	return content;
+}
+
+static bool
+local_checkMemPeak(const char *summary, const char *path, size_t peak)
+{
+	char       expected[256];
+	const char *line, *end, *found;
+
+	sprintf(expected, "{\"path\": \"%s\",", path);
+	line = strstr(summary, expected);
+	if (line == NULL)
+		return false;
+	end = strchr(line, '\n');
+
+	sprintf(expected, "\"memPeakMin\": %lu, \"memPeakMax\": %lu,",
+	        (unsigned long)peak, (unsigned long)peak);
+	found = strstr(line, expected);
+
+	return (found != NULL) && ((end == NULL) || (found < end));
+}
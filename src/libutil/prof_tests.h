@@ -0,0 +1,50 @@
+// Copyright (C) 2012, Steffen Knollmann
+// Released under the terms of the GNU General Public License version 3.
+// This file is part of `ginnungagap'.
+
+#ifndef PROF_TESTS_H
+#define PROF_TESTS_H
+
+
+/*--- Doxygen file description ------------------------------------------*/
+
+/**
+ * @file  libutil/prof_tests.h
+ * @ingroup  libutilMisc
+ * @brief  Provides the interface for testing the profiler.
+ */
+
+
+/*--- Includes ----------------------------------------------------------*/
+#include "util_config.h"
+#include <stdbool.h>
+
+
+/*--- Prototypes of exported functions ----------------------------------*/
+
+/**
+ * @brief  Tests prof_start() and prof_stop().
+ *
+ * @return  Returns @c true if the tests succeeded and @c false otherwise.
+ */
+extern bool
+prof_startStop_test(void);
+
+/**
+ * @brief  Tests prof_report().
+ *
+ * @return  Returns @c true if the tests succeeded and @c false otherwise.
+ */
+extern bool
+prof_report_test(void);
+
+/**
+ * @brief  Tests the memory peaks recorded by the profiler.
+ *
+ * @return  Returns @c true if the tests succeeded and @c false otherwise.
+ */
+extern bool
+prof_memPeak_test(void);
+
+
+#endif
@@ -17,6 +17,7 @@
 #include "rng.h"
 #include "xmem.h"
 #include "diediedie.h"
+#include "utilMath.h"
 #ifdef WITH_MPI
 #  include <mpi.h>
 #endif
@@ -29,6 +30,7 @@
 #include <math.h>
 #include <float.h>
 #include <assert.h>
+#include <string.h>
 
 
 /*--- Implemention of main structure ------------------------------------*/
@@ -39,6 +41,7 @@
 #define CONFIG_GENERATOR_NAME    "generator"
 #define CONFIG_TOTALSTREAMS_NAME "numStreamsTotal"
 #define CONFIG_RANDOMSEED_NAME   "randomSeed"
+#define LOCAL_FILL_BLOCKSIZE     256
 
 
 /*--- Prototypes of local functions -------------------------------------*/
@@ -57,6 +60,25 @@ local_getNumStreamsLocal(int numStreamsTotal);
 static int
 local_getBaseStreamId(int numStreamsTotal);
 
+static uint64_t
+local_mix64(uint64_t z);
+
+static void
+local_fillGaussUnit(const rng_t rng,
+                    const int   streamNumber,
+                    double      *outDouble,
+                    float       *outFloat,
+                    uint64_t    n);
+
+#ifdef WITH_SPRNG
+static void
+local_boxMuller(const double *u1,
+                const double *u2,
+                double       *out,
+                uint64_t     numPairs);
+
+#endif
+
 
 /*--- Implementations of exported functios ------------------------------*/
 extern rng_t
@@ -165,6 +187,54 @@ rng_getGaussUnit(const rng_t rng, const int streamNumber)
 	return rng_getGauss(rng, streamNumber, 0.0, 1.0);
 }
 
+extern void
+rng_fillGaussUnit(const rng_t rng,
+                  const int   streamNumber,
+                  fpv_t       *out,
+                  uint64_t    n)
+{
+#ifdef ENABLE_DOUBLE
+	rng_fillGaussUnitDouble(rng, streamNumber, out, n);
+#else
+	rng_fillGaussUnitFloat(rng, streamNumber, out, n);
+#endif
+}
+
+extern void
+rng_fillGaussUnitDouble(const rng_t rng,
+                        const int   streamNumber,
+                        double      *out,
+                        uint64_t    n)
+{
+	local_fillGaussUnit(rng, streamNumber, out, NULL, n);
+}
+
+extern void
+rng_fillGaussUnitFloat(const rng_t rng,
+                       const int   streamNumber,
+                       float       *out,
+                       uint64_t    n)
+{
+	local_fillGaussUnit(rng, streamNumber, NULL, out, n);
+}
+
+extern double
+rng_getGaussUnitAtIndex(const rng_t rng, uint64_t index)
+{
+	uint64_t key;
+	double   u1, u2;
+
+	assert(rng != NULL);
+
+	key = local_mix64((uint64_t)(uint32_t)rng->randomSeed);
+	// Two uniform deviates from the upper 53 bits, u1 in (0, 1] and
+	// u2 in [0, 1), combined with the Box-Muller transform.
+	u1  = ((local_mix64(key ^ (2 * index)) >> 11) + 1) * 0x1.0p-53;
+	u2  = (local_mix64(key ^ (2 * index + 1)) >> 11) * 0x1.0p-53;
+
+	return sqrt(-2.0 * log(u1)) * cos(2.0 * M_PI * u2);
+}
+
 /*--- Implementations of local functions --------------------------------*/
 static int
 local_getGeneratorType(parse_ini_t ini, const char *sectionName)
@@ -232,3 +302,76 @@ local_getBaseStreamId(int numStreamsLocal)
 #endif
 	return rank * numStreamsLocal;
 }
+
+static uint64_t
+local_mix64(uint64_t z)
+{
+	// The finaliser of the SplitMix64 generator.
+	z += UINT64_C(0x9e3779b97f4a7c15);
+	z  = (z ^ (z >> 30)) * UINT64_C(0xbf58476d1ce4e5b9);
+	z  = (z ^ (z >> 27)) * UINT64_C(0x94d049bb133111eb);
+
+	return z ^ (z >> 31);
+}
+
+static void
+local_fillGaussUnit(const rng_t rng,
+                    const int   streamNumber,
+                    double      *outDouble,
+                    float       *outFloat,
+                    uint64_t    n)
+{
+#ifdef WITH_SPRNG
+	double   u1[LOCAL_FILL_BLOCKSIZE], u2[LOCAL_FILL_BLOCKSIZE];
+	double   g[2 * LOCAL_FILL_BLOCKSIZE];
+	uint64_t numPairs = (n + 1) / 2;
+
+	assert(rng != NULL);
+	assert(streamNumber >= 0 && streamNumber < rng->numStreamsLocal);
+	assert(outDouble != NULL || outFloat != NULL || n == 0);
+
+	// For an odd number the second deviate of the last pair is lost.
+	for (uint64_t i = 0; i < numPairs; i += LOCAL_FILL_BLOCKSIZE) {
+		uint64_t num    = numPairs - i;
+		uint64_t numOut;
+
+		num    = (num > LOCAL_FILL_BLOCKSIZE) ? LOCAL_FILL_BLOCKSIZE : num;
+		numOut = (2 * num > n - 2 * i) ? n - 2 * i : 2 * num;
+		for (uint64_t j = 0; j < num; j++) {
+			u1[j] = sprng(rng->streams[streamNumber]);
+			u2[j] = sprng(rng->streams[streamNumber]);
+		}
+		local_boxMuller(u1, u2, g, num);
+		if (outDouble != NULL) {
+			memcpy(outDouble + 2 * i, g, sizeof(double) * numOut);
+		} else {
+			for (uint64_t j = 0; j < numOut; j++)
+				outFloat[2 * i + j] = (float)(g[j]);
+		}
+	}
+#else
+	diediedie(EXIT_FAILURE);
+#endif
+}
+
+#ifdef WITH_SPRNG
+static void
+local_boxMuller(const double *u1,
+                const double *u2,
+                double       *out,
+                uint64_t     numPairs)
+{
+	// No branches and no rejection, so that this can be vectorised.
+	// SPRNG gives [0, 1), hence 1 - u1 is used to avoid log(0).
+#  if (defined WITH_OPENMP && _OPENMP >= 201307)
+#    pragma omp simd
+#  endif
+	for (uint64_t i = 0; i < numPairs; i++) {
+		double r   = sqrt(-2.0 * log(1.0 - u1[i]));
+		double phi = 2.0 * M_PI * u2[i];
+		out[2 * i]     = r * cos(phi);
+		out[2 * i + 1] = r * sin(phi);
+	}
+}
+
+#endif
@@ -18,6 +18,7 @@
 /*--- Includes ----------------------------------------------------------*/
 #include "util_config.h"
 #include "parse_ini.h"
+#include <stdint.h>
 
 
 /*--- ADT handle --------------------------------------------------------*/
@@ -150,6 +151,83 @@ extern double
 rng_getGaussUnit(const rng_t rng, const int streamNumber);
 
 
+/**
+ * @brief  Fills an array with Gaussian random numbers with zero mean and
+ *         unit variance.
+ *
+ * This gives the same distribution as calling rng_getGaussUnit() for
+ * every element, but it is considerably faster: the uniform deviates are
+ * drawn in blocks, transformed with the Box-Muller method in a loop that
+ * the compiler can vectorise, and both deviates of every pair are used.
+ * The sequence of numbers is therefore not the one rng_getGaussUnit()
+ * would produce for the same stream.
+ *
+ * @param[in]   rng
+ *                 The random generator object to use.
+ * @param[in]   streamNumber
+ *                 The stream number to use.
+ * @param[out]  *out
+ *                 The array to fill, must be able to hold @c n elements.
+ * @param[in]   n
+ *                 The number of random numbers to generate.
+ *
+ * @return  Returns nothing.
+ */
+extern void
+rng_fillGaussUnit(const rng_t rng,
+                  const int   streamNumber,
+                  fpv_t       *out,
+                  uint64_t    n);
+
+
+/**
+ * @brief  Like rng_fillGaussUnit(), but always fills an array of
+ *         doubles, independent of the precision of #fpv_t.
+ */
+extern void
+rng_fillGaussUnitDouble(const rng_t rng,
+                        const int   streamNumber,
+                        double      *out,
+                        uint64_t    n);
+
+
+/**
+ * @brief  Like rng_fillGaussUnit(), but always fills an array of
+ *         floats, independent of the precision of #fpv_t.
+ *
+ * The numbers are the ones rng_fillGaussUnitDouble() gives, rounded to
+ * single precision.
+ */
+extern void
+rng_fillGaussUnitFloat(const rng_t rng,
+                       const int   streamNumber,
+                       float       *out,
+                       uint64_t    n);
+
+
+/**
+ * @brief  Generates a Gaussian random number with zero mean and unit
+ *         variance that only depends on the seed and the given index.
+ *
+ * Contrary to rng_getGaussUnit() this does not draw from a stream, but
+ * hashes the random seed of the generator together with the index.
+ * Hence the same index always gives the same number, independent of
+ * the number of streams or tasks and of the order in which the numbers
+ * are requested.  This does not require SPRNG and can be called
+ * concurrently from several threads.
+ *
+ * @param[in]  rng
+ *                The random generator object to use, only its seed is
+ *                used.
+ * @param[in]  index
+ *                The index of the number to generate.
+ *
+ * @return  A Gaussian distributed random number.
+ */
+extern double
+rng_getGaussUnitAtIndex(const rng_t rng, uint64_t index);
+
+
 /** @} */
 
 
@@ -0,0 +1,165 @@
+// Copyright (C) 2011, Steffen Knollmann
+// Released under the terms of the GNU General Public License version 3.
+// This file is part of `ginnungagap'.
+
+
+/*--- Doxygen file description ------------------------------------------*/
+
+/**
+ * @file  libutil/rng_tests.c
+ * @ingroup  libutilMiscRNG
+ * @brief  Implements the tests for the RNG.
+ */
+
+
+/*--- Includes ----------------------------------------------------------*/
+#include "util_config.h"
+#include "rng_tests.h"
+#include "rng.h"
+#include <stdio.h>
+#include <math.h>
+#include <string.h>
+#ifdef WITH_MPI
+#  include <mpi.h>
+#endif
+#include "../libutil/xmem.h"
+
+
+/*--- Local defines -----------------------------------------------------*/
+#define LOCAL_NUM_SAMPLES 100000
+
+
+/*--- Prototypes of local functions -------------------------------------*/
+
+
+/*--- Implementations of exported functions -----------------------------*/
+#ifdef WITH_SPRNG
+extern bool
+rng_fillGaussUnit_test(void)
+{
+	bool     hasPassed = true;
+	int      rank      = 0;
+	int      size      = 1;
+	rng_t    rng;
+	fpv_t    *data, *dataAgain;
+	double   *dataDouble;
+	float    *dataFloat;
+	uint64_t n         = LOCAL_NUM_SAMPLES + 1;
+	double   sum       = 0.0, sum2 = 0.0, mean, var;
+#  ifdef XMEM_TRACK_MEM
+	size_t   allocatedBytes = global_allocated_bytes;
+#  endif
+#  ifdef WITH_MPI
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+	MPI_Comm_size(MPI_COMM_WORLD, &size);
+#  endif
+
+	if (rank == 0)
+		printf("Testing %s... ", __func__);
+
+	rng        = rng_new(4, size, 1234);
+	data       = xmalloc(sizeof(fpv_t) * n);
+	dataAgain  = xmalloc(sizeof(fpv_t) * n);
+	dataDouble = xmalloc(sizeof(double) * n);
+	dataFloat  = xmalloc(sizeof(float) * n);
+
+	rng_fillGaussUnit(rng, 0, data, n);
+	for (uint64_t i = 0; i < n; i++) {
+		sum  += data[i];
+		sum2 += data[i] * data[i];
+	}
+	mean = sum / n;
+	var  = sum2 / n - mean * mean;
+	if (fabs(mean) > 5. / sqrt(n))
+		hasPassed = false;
+	if (fabs(var - 1.0) > 5. * sqrt(2. / n))
+		hasPassed = false;
+
+	// Filling in pieces of even length must give the same numbers.
+	rng_reset(rng);
+	rng_fillGaussUnit(rng, 0, dataAgain, 1000);
+	rng_fillGaussUnit(rng, 0, dataAgain + 1000, n - 1000);
+	if (memcmp(data, dataAgain, sizeof(fpv_t) * n) != 0)
+		hasPassed = false;
+
+	// The float variant must be the double variant rounded.
+	rng_reset(rng);
+	rng_fillGaussUnitDouble(rng, 0, dataDouble, n);
+	rng_reset(rng);
+	rng_fillGaussUnitFloat(rng, 0, dataFloat, n);
+	for (uint64_t i = 0; i < n; i++) {
+		if (dataFloat[i] != (float)(dataDouble[i]))
+			hasPassed = false;
+	}
+
+	xfree(dataFloat);
+	xfree(dataDouble);
+	xfree(dataAgain);
+	xfree(data);
+	rng_del(&rng);
+#  ifdef XMEM_TRACK_MEM
+	if (allocatedBytes != global_allocated_bytes)
+		hasPassed = false;
+#  endif
+
+	return hasPassed ? true : false;
+} /* rng_fillGaussUnit_test */
+
+#endif
+
+extern bool
+rng_getGaussUnitAtIndex_test(void)
+{
+	bool   hasPassed = true;
+	int    rank      = 0;
+	int    size      = 1;
+	rng_t  rng, rngSame, rngOther;
+	double sum = 0.0, sum2 = 0.0, mean, var;
+	int    numDifferent = 0;
+#ifdef XMEM_TRACK_MEM
+	size_t allocatedBytes = global_allocated_bytes;
+#endif
+#ifdef WITH_MPI
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+	MPI_Comm_size(MPI_COMM_WORLD, &size);
+#endif
+
+	if (rank == 0)
+		printf("Testing %s... ", __func__);
+
+	rng      = rng_new(4, size, 1234);
+	rngSame  = rng_new(4, 2 * size, 1234);
+	rngOther = rng_new(4, size, 1235);
+
+	// The numbers must not depend on the order of the calls or the
+	// number of streams, only on the seed and the index.
+	for (int i = LOCAL_NUM_SAMPLES - 1; i >= 0; i--) {
+		double g = rng_getGaussUnitAtIndex(rng, (uint64_t)i);
+		sum  += g;
+		sum2 += g * g;
+		if (g != rng_getGaussUnitAtIndex(rngSame, (uint64_t)i))
+			hasPassed = false;
+		if (g != rng_getGaussUnitAtIndex(rngOther, (uint64_t)i))
+			numDifferent++;
+	}
+	if (numDifferent < LOCAL_NUM_SAMPLES - 10)
+		hasPassed = false;
+
+	// Mean and variance within five sigma of the expectation.
+	mean = sum / LOCAL_NUM_SAMPLES;
+	var  = sum2 / LOCAL_NUM_SAMPLES - mean * mean;
+	if (fabs(mean) > 5. / sqrt(LOCAL_NUM_SAMPLES))
+		hasPassed = false;
+	if (fabs(var - 1.0) > 5. * sqrt(2. / LOCAL_NUM_SAMPLES))
+		hasPassed = false;
+
+	rng_del(&rngOther);
+	rng_del(&rngSame);
+	rng_del(&rng);
+#ifdef XMEM_TRACK_MEM
+	if (allocatedBytes != global_allocated_bytes)
+		hasPassed = false;
+#endif
+
+	return hasPassed ? true : false;
+} /* rng_getGaussUnitAtIndex_test */
@@ -0,0 +1,47 @@
+// Copyright (C) 2011, Steffen Knollmann
+// Released under the terms of the GNU General Public License version 3.
+// This file is part of `ginnungagap'.
+
+#ifndef RNG_TESTS_H
+#define RNG_TESTS_H
+
+
+/*--- Doxygen file description ------------------------------------------*/
+
+/**
+ * @file  libutil/rng_tests.h
+ * @ingroup  libutilMiscRNG
+ * @brief  Provides the interface for testing the RNG.
+ */
+
+
+/*--- Includes ----------------------------------------------------------*/
+#include "util_config.h"
+#include <stdbool.h>
+
+
+/*--- Prototypes of exported functions ----------------------------------*/
+
+#ifdef WITH_SPRNG
+
+/**
+ * @brief  Tests rng_fillGaussUnit() and its typed variants.
+ *
+ * @return  Returns @c true if the tests succeeded and @c false otherwise.
+ */
+extern bool
+rng_fillGaussUnit_test(void);
+
+#endif
+
+
+/**
+ * @brief  Tests rng_getGaussUnitAtIndex().
+ *
+ * @return  Returns @c true if the tests succeeded and @c false otherwise.
+ */
+extern bool
+rng_getGaussUnitAtIndex_test(void);
+
+
+#endif
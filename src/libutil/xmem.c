@@ -19,6 +19,10 @@
 #include <stdio.h>
 #include <string.h>
 #include <inttypes.h>
+#include <stdint.h>
+#if (defined ENABLE_ASYNC_IO && !defined WITH_OPENMP)
+#  include <pthread.h>
+#endif
 
 
 /*--- Implementation of exported variables ------------------------------*/
@@ -33,6 +37,127 @@ size_t  global_max_allocated_bytes = 0;
 int64_t global_malloc_vs_free      = 0;
 
 
+/*--- Local structures --------------------------------------------------*/
+
+/** @brief  Describes a tag of tracked memory. */
+typedef struct {
+	/** @brief  The name of the tag. */
+	char   name[XMEM_TRACK_MAXTAGLEN + 1];
+	/** @brief  The number of bytes currently tracked under this tag. */
+	size_t bytes;
+	/** @brief  The largest number of bytes tracked under this tag. */
+	size_t peak;
+} local_tag_t;
+
+/** @brief  Describes one tracked allocation. */
+typedef struct {
+	/** @brief  The allocated memory, @c NULL marks an empty slot. */
+	const void *ptr;
+	/** @brief  The size of the allocation. */
+	size_t     size;
+	/** @brief  The index of the tag of the allocation. */
+	int        tag;
+} local_entry_t;
+
+
+/*--- Local variables ---------------------------------------------------*/
+
+/** @brief  The tags used so far. */
+static local_tag_t local_tags[XMEM_TRACK_MAXTAGS];
+
+/** @brief  The number of tags used so far. */
+static int local_numTags = 0;
+
+#if (defined ENABLE_ASYNC_IO && !defined WITH_OPENMP)
+/**
+ * @brief  Protects the tracking against the background writer thread if
+ *         there is no OpenMP critical section to do it.
+ */
+static pthread_mutex_t local_trackMutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
+/** @brief  The tag used for allocations without an explicit tag. */
+static const char *local_currentTag = "other";
+
+/**
+ * @brief  The tracked allocations, kept as a hash table with linear
+ *         probing.
+ */
+static local_entry_t *local_entries = NULL;
+
+/** @brief  The number of slots of the hash table (a power of two). */
+static size_t local_numSlots = 0;
+
+/** @brief  The number of tracked allocations. */
+static size_t local_numEntries = 0;
+
+/** @brief  The number of currently tracked bytes. */
+static size_t local_trackedBytes = 0;
+
+/** @brief  The largest number of tracked bytes. */
+static size_t local_trackedPeak = 0;
+
+
+/*--- Prototypes of local functions -------------------------------------*/
+
+/**
+ * @brief  Finds the index of a tag, adding the tag if required.
+ *
+ * @param[in]  *tag
+ *                The name of the tag.
+ *
+ * @return  Returns the index of the tag.
+ */
+static int
+local_getTag(const char *tag);
+
+
+/**
+ * @brief  Gets the slot of the hash table a pointer would ideally go to.
+ *
+ * @param[in]  *ptr
+ *                The pointer.
+ *
+ * @return  Returns the slot.
+ */
+static size_t
+local_getSlot(const void *ptr);
+
+
+/**
+ * @brief  Finds the slot holding a pointer.
+ *
+ * @param[in]  *ptr
+ *                The pointer to look for.
+ *
+ * @return  Returns the slot holding the pointer or the empty slot the
+ *          pointer would be stored in.
+ */
+static size_t
+local_findSlot(const void *ptr);
+
+
+/**
+ * @brief  Doubles the size of the hash table.
+ *
+ * @return  Returns nothing.
+ */
+static void
+local_growTable(void);
+
+
+/**
+ * @brief  Removes the entry in a slot of the hash table.
+ *
+ * @param[in]  slot
+ *                The slot to clear, must hold an entry.
+ *
+ * @return  Returns nothing.
+ */
+static void
+local_removeSlot(size_t slot);
+
+
 /*--- Implementation of exported functions ------------------------------*/
 extern void *
 xmalloc(size_t size)
@@ -151,6 +276,123 @@ xrealloc(void *ptr, size_t size)
 	return dummy;
 } /* xrealloc */
 
+extern void
+xmem_trackAlloc(const void *ptr, size_t size, const char *tag)
+{
+	if (ptr == NULL)
+		return;
+
+#if (defined ENABLE_ASYNC_IO && !defined WITH_OPENMP)
+	pthread_mutex_lock(&local_trackMutex);
+#endif
+#ifdef WITH_OPENMP
+#  pragma omp critical (xmemTrack)
+#endif
+	{
+		size_t slot;
+		int    idxOfTag;
+
+		if (2 * (local_numEntries + 1) > local_numSlots)
+			local_growTable();
+		slot = local_findSlot(ptr);
+		if (local_entries[slot].ptr != NULL)
+			local_removeSlot(slot);
+		slot                      = local_findSlot(ptr);
+		idxOfTag                  = local_getTag(tag == NULL
+		                                         ? local_currentTag : tag);
+		local_entries[slot].ptr   = ptr;
+		local_entries[slot].size  = size;
+		local_entries[slot].tag   = idxOfTag;
+		local_numEntries++;
+
+		local_tags[idxOfTag].bytes += size;
+		if (local_tags[idxOfTag].bytes > local_tags[idxOfTag].peak)
+			local_tags[idxOfTag].peak = local_tags[idxOfTag].bytes;
+		local_trackedBytes += size;
+		if (local_trackedBytes > local_trackedPeak)
+			local_trackedPeak = local_trackedBytes;
+	}
+#if (defined ENABLE_ASYNC_IO && !defined WITH_OPENMP)
+	pthread_mutex_unlock(&local_trackMutex);
+#endif
+}
+
+extern void
+xmem_trackFree(const void *ptr)
+{
+	if ((ptr == NULL) || (local_numEntries == 0))
+		return;
+
+#if (defined ENABLE_ASYNC_IO && !defined WITH_OPENMP)
+	pthread_mutex_lock(&local_trackMutex);
+#endif
+#ifdef WITH_OPENMP
+#  pragma omp critical (xmemTrack)
+#endif
+	{
+		size_t slot = local_findSlot(ptr);
+
+		if (local_entries[slot].ptr != NULL)
+			local_removeSlot(slot);
+	}
+#if (defined ENABLE_ASYNC_IO && !defined WITH_OPENMP)
+	pthread_mutex_unlock(&local_trackMutex);
+#endif
+}
+
+extern const char *
+xmem_setTrackTag(const char *tag)
+{
+	const char *oldTag = local_currentTag;
+
+	if (tag == NULL) {
+		fprintf(stderr, "The tag of tracked memory cannot be NULL.\n");
+		abort();
+	}
+	local_currentTag = tag;
+
+	return oldTag;
+}
+
+extern size_t
+xmem_getTrackedBytes(void)
+{
+	return local_trackedBytes;
+}
+
+extern size_t
+xmem_getTrackedPeak(void)
+{
+	return local_trackedPeak;
+}
+
+extern void
+xmem_setTrackedPeak(size_t peak)
+{
+	local_trackedPeak = (peak < local_trackedBytes) ? local_trackedBytes
+	                    : peak;
+}
+
+extern int
+xmem_getTrackedNumTags(void)
+{
+	return local_numTags;
+}
+
+extern const char *
+xmem_getTrackedTag(int idxOfTag, size_t *peak)
+{
+	if ((idxOfTag < 0) || (idxOfTag >= local_numTags) || (peak == NULL)) {
+		fprintf(stderr, "Invalid request for tag %i of tracked memory.\n",
+		        idxOfTag);
+		abort();
+	}
+
+	*peak = local_tags[idxOfTag].peak;
+
+	return local_tags[idxOfTag].name;
+}
+
 #ifdef XMEM_TRACK_MEM
 void
 xmem_info(FILE *f)
@@ -184,3 +426,96 @@ xmem_info(FILE *f)
 }
 
 #endif
+
+
+/*--- Implementations of local functions --------------------------------*/
+static int
+local_getTag(const char *tag)
+{
+	for (int i = 0; i < local_numTags; i++) {
+		if (strncmp(local_tags[i].name, tag, XMEM_TRACK_MAXTAGLEN) == 0)
+			return i;
+	}
+
+	if (local_numTags == XMEM_TRACK_MAXTAGS) {
+		fprintf(stderr, "Too many tags of tracked memory (at %s).\n", tag);
+		abort();
+	}
+	strncpy(local_tags[local_numTags].name, tag, XMEM_TRACK_MAXTAGLEN);
+	local_tags[local_numTags].name[XMEM_TRACK_MAXTAGLEN] = '\0';
+	local_tags[local_numTags].bytes                      = 0;
+	local_tags[local_numTags].peak                       = 0;
+
+	return local_numTags++;
+}
+
+static size_t
+local_getSlot(const void *ptr)
+{
+	uint64_t h = (uint64_t)(uintptr_t)ptr;
+
+	// Fibonacci hashing, the lower bits carry no information for
+	// aligned allocations.
+	h = (h >> 4) * UINT64_C(11400714819323198485);
+
+	return (size_t)(h >> 32) & (local_numSlots - 1);
+}
+
+static size_t
+local_findSlot(const void *ptr)
+{
+	size_t slot = local_getSlot(ptr);
+
+	while (local_entries[slot].ptr != NULL && local_entries[slot].ptr != ptr)
+		slot = (slot + 1) & (local_numSlots - 1);
+
+	return slot;
+}
+
+static void
+local_growTable(void)
+{
+	local_entry_t *oldEntries  = local_entries;
+	size_t        oldNumSlots  = local_numSlots;
+
+	// Plain calloc/free, the table itself must not show up in the
+	// accounting of xmalloc.
+	local_numSlots = (oldNumSlots == 0) ? 256 : 2 * oldNumSlots;
+	local_entries  = calloc(local_numSlots, sizeof(local_entry_t));
+	if (local_entries == NULL) {
+		fprintf(stderr, "Could not grow the table of tracked memory.\n");
+		abort();
+	}
+
+	for (size_t i = 0; i < oldNumSlots; i++) {
+		if (oldEntries[i].ptr != NULL)
+			local_entries[local_findSlot(oldEntries[i].ptr)] = oldEntries[i];
+	}
+	free(oldEntries);
+}
+
+static void
+local_removeSlot(size_t slot)
+{
+	size_t mask = local_numSlots - 1;
+	size_t next = (slot + 1) & mask;
+
+	local_tags[local_entries[slot].tag].bytes -= local_entries[slot].size;
+	local_trackedBytes                        -= local_entries[slot].size;
+	local_entries[slot].ptr                    = NULL;
+	local_numEntries--;
+
+	// Move back entries that would otherwise not be found anymore.
+	while (local_entries[next].ptr != NULL) {
+		size_t ideal = local_getSlot(local_entries[next].ptr);
+
+		// The hole can take the entry, if it lies between the ideal slot
+		// of the entry and its actual slot.
+		if (((next - ideal) & mask) >= ((next - slot) & mask)) {
+			local_entries[slot]     = local_entries[next];
+			local_entries[next].ptr = NULL;
+			slot                    = next;
+		}
+		next = (next + 1) & mask;
+	}
+}
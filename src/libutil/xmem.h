@@ -24,6 +24,15 @@
 #endif
 
 
+/*--- Exported defines --------------------------------------------------*/
+
+/** @brief  The maximal length of the tags of tracked memory. */
+#define XMEM_TRACK_MAXTAGLEN 31
+
+/** @brief  The maximal number of different tags of tracked memory. */
+#define XMEM_TRACK_MAXTAGS 16
+
+
 /*--- Exported global variables -----------------------------------------*/
 #ifdef XMEM_TRACK_MEM
 extern size_t  global_allocated_bytes;
@@ -85,6 +94,124 @@ extern void *
 xrealloc(void *ptr, size_t size);
 
 
+/**
+ * @brief  Adds an allocation to the tracked memory.
+ *
+ * The tracked memory is independent of the accounting activated via
+ * -DXMEM_TRACK_MEM, it is always available and meant for the large
+ * allocations (grids, FFT and communication buffers) that do not
+ * necessarily go through xmalloc() (e.g. memory from fftw_malloc).  The
+ * allocation is recorded under a tag to allow for a break-down of the
+ * memory usage.  Tracking a pointer that is already tracked replaces the
+ * old record.
+ *
+ * @param[in]  *ptr
+ *                The allocated memory.  If this is @c NULL, nothing
+ *                happens.
+ * @param[in]  size
+ *                The size of the allocation in bytes.
+ * @param[in]  *tag
+ *                The tag to record the allocation under.  This must be a
+ *                string that lives as long as the allocation (usually a
+ *                string literal) and is truncated to
+ *                #XMEM_TRACK_MAXTAGLEN characters.  If this is @c NULL,
+ *                the current tag (see xmem_setTrackTag()) is used.
+ *
+ * @return  Returns nothing.
+ */
+extern void
+xmem_trackAlloc(const void *ptr, size_t size, const char *tag);
+
+
+/**
+ * @brief  Removes an allocation from the tracked memory.
+ *
+ * @param[in]  *ptr
+ *                The memory that is about to be freed.  Pointers that are
+ *                not tracked are ignored.
+ *
+ * @return  Returns nothing.
+ */
+extern void
+xmem_trackFree(const void *ptr);
+
+
+/**
+ * @brief  Sets the tag that is used for allocations that are tracked
+ *         without an explicit tag.
+ *
+ * @param[in]  *tag
+ *                The new tag, see xmem_trackAlloc().  Must not be
+ *                @c NULL.  Initially the tag is <tt>other</tt>.
+ *
+ * @return  Returns the previous tag, this should be restored once the
+ *          allocations to be tagged have been done.
+ */
+extern const char *
+xmem_setTrackTag(const char *tag);
+
+
+/**
+ * @brief  Gets the number of currently tracked bytes.
+ *
+ * @return  Returns the number of bytes.
+ */
+extern size_t
+xmem_getTrackedBytes(void);
+
+
+/**
+ * @brief  Gets the largest number of tracked bytes.
+ *
+ * @return  Returns the peak since the start of the program or the last
+ *          call to xmem_setTrackedPeak().
+ */
+extern size_t
+xmem_getTrackedPeak(void);
+
+
+/**
+ * @brief  Sets the peak of the tracked bytes.
+ *
+ * This allows to measure the peak of a part of the program:  Set the
+ * peak to the current number of tracked bytes before and query the peak
+ * afterwards.
+ *
+ * @param[in]  peak
+ *                The new peak.  If this is smaller than the number of
+ *                currently tracked bytes, the latter is used.
+ *
+ * @return  Returns nothing.
+ */
+extern void
+xmem_setTrackedPeak(size_t peak);
+
+
+/**
+ * @brief  Gets the number of tags that have been used so far.
+ *
+ * @return  Returns the number of tags.
+ */
+extern int
+xmem_getTrackedNumTags(void);
+
+
+/**
+ * @brief  Gets the name and the peak of a tag.
+ *
+ * @param[in]   idxOfTag
+ *                 The index of the tag, must be smaller than the number
+ *                 returned by xmem_getTrackedNumTags().
+ * @param[out]  *peak
+ *                 Will receive the largest number of bytes tracked under
+ *                 this tag.  Passing @c NULL is undefined.
+ *
+ * @return  Returns the name of the tag.
+ */
+extern const char *
+xmem_getTrackedTag(int idxOfTag, size_t *peak);
+
+
 #ifdef XMEM_TRACK_MEM
 
 /**
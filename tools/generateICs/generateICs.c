@@ -21,22 +21,27 @@
 #include <assert.h>
 #include <inttypes.h>
 #include <math.h>
+#include <time.h>
 #ifdef WITH_MPI
 #  include <mpi.h>
 #endif
-#ifdef WITH_OPENMP
+#if (defined WITH_OPENMP)
 #  include <omp.h>
 #endif
 #include "../../src/libcosmo/cosmoModel.h"
 #include "../../src/libcosmo/cosmo.h"
 #include "../../src/libutil/utilMath.h"
 #include "../../src/libutil/xmem.h"
-#include "../../src/libutil/timer.h"
+#include "../../src/libutil/prof.h"
+#include "../../src/libutil/xstring.h"
 #include "../../src/libutil/diediedie.h"
 #include "../../src/libutil/lIdx.h"
 #include "../../src/libutil/gadget.h"
 #include "../../src/libutil/gadgetHeader.h"
 #include "../../src/libutil/gadgetTOC.h"
+#ifdef WITH_HDF5
+#  include "../../src/libutil/gadgetHDF5.h"
+#endif
 #include "../../src/libg9p/g9pICMap.h"
 #include "../../src/libgrid/gridPatch.h"
 #include "../../src/libpart/partBunch.h"
@@ -96,12 +101,122 @@ local_computeNumPartsLevel(const generateICs_t genics,
 static void
 local_doFile(generateICs_t genics, const g9pICMap_t map, int file, uint64_t *startID);
 
+/**
+ * @brief  Creates the particles of one file.
+ *
+ * @param[in,out]  genics
+ *                    The application to work with.
+ * @param[in]      map
+ *                    The mapping of tiles onto the files.
+ * @param[in]      file
+ *                    The file number to work on.
+ * @param[in,out]  *startID
+ *                    The first sequential ID, is advanced past the
+ *                    particles.
+ *
+ * @return  Returns the particles, the caller must delete them.
+ */
+static partBunch_t
+local_makeParticles(generateICs_t genics,
+                    g9pICMap_t    map,
+                    int           file,
+                    uint64_t      *startID);
+
+/**
+ * @brief  Sorts the particles of one file along the requested curve.
+ *
+ * With gas, the gas particles and the dark matter particles are sorted
+ * separately, so that they stay in their halves of the storage.
+ *
+ * @param[in]      genics
+ *                    The application to work with.
+ * @param[in,out]  particles
+ *                    The particles to sort, with their final positions.
+ *
+ * @return  Returns nothing.
+ */
+static void
+local_sortParticles(const generateICs_t genics, partBunch_t particles);
+
+/**
+ * @brief  Creates the header of the current level.
+ *
+ * @param[in]   genics
+ *                 The application to work with.
+ * @param[out]  *withMassBlock
+ *                 Receives whether the particle masses must be written.
+ *
+ * @return  Returns a new header without the particle numbers of the file.
+ */
+static gadgetHeader_t
+local_newHeaderForLevel(const generateICs_t genics, bool *withMassBlock);
+
 static void
 local_writeGadgetFile(generateICs_t     genics,
                       int               file,
                       const partBunch_t particles,
                       g9pICMap_t map);
 
+#ifdef WITH_HDF5
+
+/**
+ * @brief  Helper function for generateICs_run() writing one HDF5 file.
+ *
+ * All processes write the particles of the current level collectively
+ * into one file.  They work in rounds, one file of the map per round, so
+ * that processes with fewer (or no) files still take part in every
+ * collective write.
+ *
+ * @param[in,out]  genics
+ *                    The application to work with.
+ * @param[in]      map
+ *                    The mapping of tiles onto the files.
+ * @param[in,out]  *startID
+ *                    The first sequential ID.
+ *
+ * @return  Returns nothing.
+ */
+static void
+local_runHDF5(generateICs_t genics, g9pICMap_t map, uint64_t *startID);
+
+/**
+ * @brief  Writes the particles of one file of the map into the HDF5 file.
+ *
+ * @param[in]      genics
+ *                    The application to work with.
+ * @param[in,out]  gadgetHDF5
+ *                    The HDF5 file to write to.
+ * @param[in]      particles
+ *                    The particles, may be @c NULL to only take part in
+ *                    the collective writes.
+ * @param[in]      firstParticle
+ *                    The position of the first particle of each type in
+ *                    the HDF5 file.
+ * @param[in]      withMassBlock
+ *                    Whether the particle masses must be written.
+ *
+ * @return  Returns nothing.
+ */
+static void
+local_writeHDF5Part(const generateICs_t genics,
+                    gadgetHDF5_t        gadgetHDF5,
+                    const partBunch_t   particles,
+                    uint64_t            firstParticle,
+                    bool                withMassBlock);
+
+#endif
+
+/**
+ * @brief  Returns the wall clock time of the calling rank.
+ *
+ * Unlike timer_start() this does not synchronise the ranks, which may
+ * produce different numbers of files.
+ *
+ * @return  Returns the time in seconds.
+ */
+static double
+local_getTime(void);
+
 
 /*--- Exported functions: Creating and deleting -------------------------*/
 extern generateICs_t
@@ -135,6 +250,8 @@ generateICs_del(generateICs_t *genics)
 		g9pDataStore_del(&(*genics)->datastore);
 	if ( (*genics)->mask != NULL )
 		g9pMask_del(&(*genics)->mask);
+	if ( (*genics)->profilePrefix != NULL )
+		xfree( (*genics)->profilePrefix );
 
 	xfree(*genics);
 
@@ -171,9 +288,13 @@ generateICs_run(generateICs_t genics)
 	uint32_t numFiles = genics->out->numFilesForLevel[genics->zoomlevel-minlev];
 	uint64_t startID = 0;
 
-	g9pICMap_t map = g9pICMap_new( numFiles, 0, NULL,
-	                               g9pMask_getRef(genics->mask),
-	                               genics->zoomlevel);
+	if (genics->profilePrefix != NULL)
+		prof_enable();
+
+	g9pICMap_t map = g9pICMap_newOrdered( numFiles, 0, NULL,
+	                                      g9pMask_getRef(genics->mask),
+	                                      genics->zoomlevel,
+	                                      genics->particleOrder);
 
 	if (genics->rank == 0)
 		generateICs_printSummary(genics, stdout);
@@ -192,56 +313,108 @@ generateICs_run(generateICs_t genics)
 		startID += local_computeNumPartsLevel(genics,lev);
 	}
 	
-        uint32_t N1, N2, Nperproc;
-        uint32_t  NDO=0;
-        uint32_t foffset=0;
-        for (uint32_t i = 0; i < genics->zoomlevel-minlev; i++){
-			foffset+=genics->out->numFilesForLevel[i];
+	uint32_t N1, N2;
+	uint32_t foffset = 0;
+	for (uint32_t i = 0; i < genics->zoomlevel - minlev; i++)
+		foffset += genics->out->numFilesForLevel[i];
+
+#ifdef WITH_HDF5
+	if (genics->out->useHDF5) {
+		local_runHDF5(genics, map, &startID);
+	} else
+#endif
+	if (generateICs_getFilesForRank(genics, genics->rank, &N1, &N2)) {
+		printf(" * Comienzo a producir files desde  %i a %i\n", N1, N2);
+		for (uint32_t i = N1; i < N2; i++) {
+			printf(" * Working on file %i\n", i + foffset);
+			double timing = -local_getTime();
+
+			prof_start("file");
+			local_doFile(genics, map, i, &startID);
+			prof_stop("file");
+
+			timing += local_getTime();
+			printf("      File processed in in %.2fs\n", timing);
 		}
-
-        if (genics->size <=  numFiles ) 
-          {
-            Nperproc= numFiles / genics->size;
-            N1 = Nperproc * genics->rank ;
-            N2= Nperproc  + N1;
-
-            if (genics->rank  ==  genics->size -1 )
-              {
-                N2 = numFiles;
-              } 
-          }
-        else
-          {
-            if ( genics->rank <=  numFiles -1 )
-              {
-                N1 = genics->rank;
-                N2 = N1+1;
-              }
-            else
-              {NDO=1;}
-          }
-
-        printf(" * Comienzo a producir files desde  %i a %i\n", N1, N2);
-
-        if ( NDO == 0 ) 
-          {
-            for (uint32_t i = N1; i < N2; i++) 
-              {
-		
-		//	for (uint32_t i = 0; i < genics->out->numFiles; i++) {
-		printf(" * Working on file %i\n", i+foffset);
-		double timing = timer_start();
-		
-		local_doFile(genics, map, i, &startID);
-		
-		timing = timer_stop(timing);
-		printf("      File processed in in %.2fs\n", timing);
-	      }
-	  }
+	}
 
 	g9pICMap_del(&map);
+
+	if (genics->profilePrefix != NULL) {
+		prof_report(genics->profilePrefix);
+		prof_reset();
+	}
 } // generateICs_run
 
+extern bool
+generateICs_getFilesForRank(const generateICs_t genics,
+                            int                 rank,
+                            uint32_t            *firstFile,
+                            uint32_t            *lastFile)
+{
+	uint32_t minlev   = g9pMask_getMinLevel(genics->mask);
+	uint32_t numFiles = genics->out->numFilesForLevel[genics->zoomlevel
+	                                                  - minlev];
+
+	assert(rank >= 0 && rank < genics->size);
+	assert(firstFile != NULL && lastFile != NULL);
+
+	if ((uint32_t)(genics->size) <= numFiles) {
+		uint32_t numPerRank = numFiles / genics->size;
+		*firstFile = numPerRank * rank;
+		*lastFile  = *firstFile + numPerRank;
+		if (rank == genics->size - 1)
+			*lastFile = numFiles;
+	} else {
+		*firstFile = (uint32_t)rank;
+		*lastFile  = *firstFile + 1;
+		if ((uint32_t)rank >= numFiles) {
+			*firstFile = *lastFile = 0;
+			return false;
+		}
+	}
+
+	return true;
+}
+
+extern generateICsMem_t
+generateICs_newMem(const generateICs_t genics)
+{
+	uint32_t         minlev   = g9pMask_getMinLevel(genics->mask);
+	uint32_t         numFiles = genics->out->numFilesForLevel[
+	    genics->zoomlevel - minlev];
+	uint32_t         *firstTile, *lastTile;
+	generateICsMem_t mem;
+	g9pICMap_t       map;
+
+	map = g9pICMap_newOrdered(numFiles, 0, NULL,
+	                          g9pMask_getRef(genics->mask),
+	                          genics->zoomlevel, genics->particleOrder);
+
+	firstTile = xmalloc(sizeof(uint32_t) * genics->size * 2);
+	lastTile  = firstTile + genics->size;
+	for (int r = 0; r < genics->size; r++) {
+		uint32_t firstFile, lastFile;
+
+		// An empty range is marked by the first tile being after the last.
+		firstTile[r] = 1;
+		lastTile[r]  = 0;
+		if (generateICs_getFilesForRank(genics, r, &firstFile, &lastFile)) {
+			firstTile[r] = g9pICMap_getFirstTileInFile(map, firstFile);
+			lastTile[r]  = g9pICMap_getLastTileInFile(map, lastFile - 1);
+		}
+	}
+
+	mem = generateICsMem_new(genics->mask, (uint8_t)(genics->zoomlevel),
+	                         firstTile, lastTile,
+	                         g9pICMap_getTileOrder(map));
+
+	xfree(firstTile);
+	g9pICMap_del(&map);
+
+	return mem;
+}
+
 /*--- Implementations of local functions --------------------------------*/
 inline static generateICs_t
 local_alloc(void)
@@ -277,6 +450,8 @@ local_init(generateICs_t genics)
 	genics->mask      = NULL;
 	genics->typeForLevel = NULL;
 	genics->shift = xmalloc(sizeof(double)*3);
+	genics->profilePrefix = NULL;
+	genics->particleOrder = LIDX_ORDER_LINEAR;
 } // local_init
 
 static uint64_t
@@ -323,12 +498,14 @@ local_setupCore(generateICsCore_t   core,
 
 static partBunch_t
 local_getParticleStorage(const generateICs_t genics,
+                         const g9pICMap_t    map,
                          const uint32_t      firstTile,
                          const uint32_t      lastTile)
 {
 	uint64_t numParticles = UINT64_C(0);
 	for (uint32_t i = firstTile; i <= lastTile; i++) {
-		numParticles += local_computeNumParts(genics, i);
+		numParticles += local_computeNumParts(genics,
+		                                      g9pICMap_getTileAt(map, i));
 	}
 	if (genics->mode->doGas && (genics->typeForLevel)[genics->zoomlevel-g9pMask_getMinLevel(genics->mask)]==1)
 		numParticles *= 2;
@@ -354,12 +531,27 @@ local_getParticleStorage(const generateICs_t genics,
 
 static void
 local_doFile(generateICs_t genics, g9pICMap_t map, int file, uint64_t *startID)
+{
+	partBunch_t particles = local_makeParticles(genics, map, file, startID);
+
+	prof_start("writeGadget");
+	local_writeGadgetFile(genics, file, particles, map);
+	prof_stop("writeGadget");
+
+	partBunch_del(&particles);
+}
+
+static partBunch_t
+local_makeParticles(generateICs_t genics,
+                    g9pICMap_t    map,
+                    int           file,
+                    uint64_t      *startID)
 {
 	uint32_t    firstTile = g9pICMap_getFirstTileInFile(map, file);
 	uint32_t    lastTile  = g9pICMap_getLastTileInFile(map, file);
 	uint64_t    partsRead = UINT64_C(0);
 
-	partBunch_t particles = local_getParticleStorage(genics,
+	partBunch_t particles = local_getParticleStorage(genics, map,
 	                                                 firstTile, lastTile);
 
 	generateICsCore_s core = GENICSCORE_INIT_STRUCT(genics->data,
@@ -369,7 +561,8 @@ local_doFile(generateICs_t genics, g9pICMap_t map, int file, uint64_t *startID)
 	printf("np in level: %i\n",
 				local_computeNumPartsLevel(genics, genics->zoomlevel)); 
 	
-	for (uint32_t i = firstTile; i <= lastTile; i++) {
+	for (uint32_t pos = firstTile; pos <= lastTile; pos++) {
+		uint32_t i = g9pICMap_getTileAt(map, pos);
 		printf("cells in tile: %i\n", g9pMask_getNumCellsInTileForLevel(genics->mask,i,genics->zoomlevel));
 		core.numParticles = local_computeNumParts(genics, i);
 		if(core.numParticles > 0) {
@@ -390,14 +583,14 @@ local_doFile(generateICs_t genics, g9pICMap_t map, int file, uint64_t *startID)
 //		fpv_t             *velxP = gridPatch_getVarDataHandle(core.patch, 0);
 	//	printf("\n %i \n", i);
 
-		gridReader_readIntoPatchForVar(genics->in->velx, core.patch, 0);
-		gridReader_readIntoPatchForVar(genics->in->vely, core.patch, 1);
-		gridReader_readIntoPatchForVar(genics->in->velz, core.patch, 2);
+		generateICsIn_readIntoPatch(genics->in, core.patch, i);
 		
 		//fpv_t             *velx1P = gridPatch_getVarDataHandle(core.patch, 0);
 		//printf(" %i \n", velx1P);
 		
+		prof_start("toParticles");
 		generateICsCore_toParticles(&core);
+		prof_stop("toParticles");
 		
 		*startID = core.startID;
 		printf("StartID: %i\n",*startID);
@@ -454,50 +647,61 @@ local_doFile(generateICs_t genics, g9pICMap_t map, int file, uint64_t *startID)
 		generateICsCore_kpc(&core);
 	}
 
+	if (genics->particleOrder != LIDX_ORDER_LINEAR)
+		local_sortParticles(genics, particles);
 
-	local_writeGadgetFile(genics, file, particles, map);
-
-	partBunch_del(&particles);
-} // local_doFile
+	return particles;
+} // local_makeParticles
 
 static void
-local_writeGadgetFile(generateICs_t     genics,
-                      int               file,
-                      const partBunch_t particles,
-                      g9pICMap_t map)
+local_sortParticles(const generateICs_t genics, partBunch_t particles)
+{
+	uint32_t minlev   = g9pMask_getMinLevel(genics->mask);
+	uint32_t arrIdx   = (genics->typeForLevel)[genics->zoomlevel - minlev];
+	bool     withGas  = genics->mode->doGas && arrIdx == 1;
+	uint64_t np       = partBunch_getNumParticles(particles);
+	int      numParts = withGas ? 2 : 1;
+	double   boxsize  = genics->data->boxsizeInMpch;
+
+	if (genics->mode->kpc)
+		boxsize *= 1000.;
+
+	prof_start("sort");
+	for (int i = 0; i < numParts; i++) {
+		generateICsCore_s core = GENICSCORE_INIT_STRUCT(genics->data,
+		                                                genics->mode);
+		uint64_t          skip = i * (np / numParts);
+
+		core.numParticles = np / numParts;
+		if (core.numParticles == 0)
+			continue;
+		core.pos = partBunch_at(particles, 0, skip);
+		core.vel = partBunch_at(particles, 1, skip);
+		core.id  = partBunch_at(particles, 2, skip);
+		generateICsCore_sortParticles(&core, genics->particleOrder, boxsize);
+	}
+	prof_stop("sort");
+}
+
+static gadgetHeader_t
+local_newHeaderForLevel(const generateICs_t genics, bool *withMassBlock)
 {
-	uint32_t       npLocal[6] = {0, 0, 0, 0, 0, 0};
 	uint64_t       npAll[6] = {0, 0, 0, 0, 0, 0};
 	double         massArr[6] = {0., 0., 0., 0., 0., 0.};
 	gadgetHeader_t myHeader;
 
-	const uint64_t               np = partBunch_getNumParticles(particles);
 	uint32_t minlev = g9pMask_getMinLevel(genics->mask);
 	uint32_t maxlev = g9pMask_getMaxLevel(genics->mask);
-	uint32_t   numLevels = maxlev - minlev + 1;
 	uint32_t   arrIdx = (genics->typeForLevel)[genics->zoomlevel-minlev];
 	uint32_t nlevfortype[6] = {0, 0, 0, 0, 0, 0};
 	uint64_t npFull;
-	
-	uint32_t foffset=0;
-        for (uint32_t i = 0; i < genics->zoomlevel-minlev; i++){
-			foffset+=genics->out->numFilesForLevel[i];
-		}
-	
+
     for(int lev=minlev; lev<=maxlev; lev++) {
-		for(int type=0; type<=6; type++) {
+		for(int type=0; type<6; type++) {
 			if((genics->typeForLevel)[lev-minlev]==type) nlevfortype[type]++;
 		}
 	}
-    
-	if (genics->mode->doGas && arrIdx==1) {
-		assert(np % 2 == 0);
-		npLocal[0] = np / 2;
-		npLocal[arrIdx] = npLocal[0];
-	} else {
-		npLocal[arrIdx] = (uint32_t)np;
-	}
-	
+
 	myHeader   = gadgetHeader_clone(genics->out->baseHeader);
 	
 	if (genics->mode->kpc) {
@@ -515,30 +719,60 @@ local_writeGadgetFile(generateICs_t     genics,
 			npFull = POW_NDIM((uint64_t)g9pMask_getDim1DLevel(genics->mask,level));
 			massArr[idx] = generateICsOut_boxMass(genics->data) / npFull;
 		}
-		
-		//idx = 1 + maxlev - level;
-		//npAll[idx] = (uint64_t)local_computeNumPartsFileLevel(genics, map, level);
-		//npFull = POW_NDIM(g9pMask_getDim1DLevel(genics->mask,level));
-		//massArr[idx] = generateICsOut_boxMass(genics->data) / npFull;
 	}
 	printf("\n mass: %lf\n",generateICsOut_boxMass(genics->data));
 	
-	if(nlevfortype[arrIdx]>1 || genics->mode->doMassBlock) {
-		gadgetTOC_addEntryByType(genics->out->toc, GADGETBLOCK_MASS);
-	}
+	*withMassBlock = (nlevfortype[arrIdx]>1 || genics->mode->doMassBlock);
 	if (genics->mode->doGas) {
 		const double omegaBaryon0 = cosmoModel_getOmegaBaryon0(genics->data->model);
 		const double omegaMatter0 = cosmoModel_getOmegaMatter0(genics->data->model);
 		npAll[0]    = npAll[1];
 		massArr[0]  = massArr[1] * omegaBaryon0 / omegaMatter0;
 		massArr[1]  -= massArr[0];
-		if(arrIdx==1)
-			gadgetTOC_addEntryByType(genics->out->toc, GADGETBLOCK_U___);
 	}
 	gadgetHeader_setNall(myHeader,npAll);
 	gadgetHeader_setMassArr(myHeader, massArr);
-	//gadgetHeader_setNumFiles(myHeader,numLevels);
-	//
+
+	return myHeader;
+} // local_newHeaderForLevel
+
+static void
+local_writeGadgetFile(generateICs_t     genics,
+                      int               file,
+                      const partBunch_t particles,
+                      g9pICMap_t map)
+{
+	uint32_t       npLocal[6] = {0, 0, 0, 0, 0, 0};
+	double         massArr[6] = {0., 0., 0., 0., 0., 0.};
+	gadgetHeader_t myHeader;
+	bool           withMassBlock;
+
+	const uint64_t               np = partBunch_getNumParticles(particles);
+	uint32_t minlev = g9pMask_getMinLevel(genics->mask);
+	uint32_t   arrIdx = (genics->typeForLevel)[genics->zoomlevel-minlev];
+	uint64_t npFull;
+	
+	uint32_t foffset=0;
+        for (uint32_t i = 0; i < genics->zoomlevel-minlev; i++){
+			foffset+=genics->out->numFilesForLevel[i];
+		}
+	
+	if (genics->mode->doGas && arrIdx==1) {
+		assert(np % 2 == 0);
+		npLocal[0] = np / 2;
+		npLocal[arrIdx] = npLocal[0];
+	} else {
+		npLocal[arrIdx] = (uint32_t)np;
+	}
+	
+	myHeader = local_newHeaderForLevel(genics, &withMassBlock);
+
+	if(withMassBlock) {
+		gadgetTOC_addEntryByType(genics->out->toc, GADGETBLOCK_MASS);
+	}
+	if (genics->mode->doGas && arrIdx==1) {
+		gadgetTOC_addEntryByType(genics->out->toc, GADGETBLOCK_U___);
+	}
 	
 	gadgetHeader_getMassArr(myHeader, massArr);
 	gadgetHeader_setNp(myHeader, npLocal);
@@ -574,7 +808,7 @@ local_writeGadgetFile(generateICs_t     genics,
 		stai_del(&stai);
 		
 		
-		if(nlevfortype[arrIdx]>1 || genics->mode->doMassBlock) {
+		if(withMassBlock) {
 			fpv_t masses[np];
 			npFull = POW_NDIM((uint64_t)g9pMask_getDim1DLevel(genics->mask,genics->zoomlevel));
 			fpv_t mass1 = generateICsOut_boxMass(genics->data) / npFull;
@@ -601,3 +835,155 @@ local_writeGadgetFile(generateICs_t     genics,
 	}
 	gadget_close(genics->out->gadget);
 } // local_writeGadgetFile
+
+#ifdef WITH_HDF5
+static void
+local_runHDF5(generateICs_t genics, g9pICMap_t map, uint64_t *startID)
+{
+	uint32_t       minlev    = g9pMask_getMinLevel(genics->mask);
+	uint32_t       levelIdx  = genics->zoomlevel - minlev;
+	uint32_t       arrIdx    = (genics->typeForLevel)[levelIdx];
+	uint64_t       npFile[6] = {0, 0, 0, 0, 0, 0};
+	uint32_t       N1, N2, numRounds;
+	bool           withMassBlock;
+	char           *fileName;
+	gadgetHeader_t header;
+	gadgetHDF5_t   gadgetHDF5;
+
+	(void)generateICs_getFilesForRank(genics, genics->rank, &N1, &N2);
+	numRounds = N2 - N1;
+#ifdef WITH_MPI
+	MPI_Allreduce(MPI_IN_PLACE, &numRounds, 1, MPI_UINT32_T, MPI_MAX,
+	              MPI_COMM_WORLD);
+#endif
+
+	npFile[arrIdx] = local_computeNumPartsLevel(genics, genics->zoomlevel);
+	if (genics->mode->doGas && arrIdx == 1)
+		npFile[0] = npFile[arrIdx];
+
+	header     = local_newHeaderForLevel(genics, &withMassBlock);
+	fileName   = generateICsOut_getHDF5FileName(genics->out, levelIdx);
+	gadgetHDF5 = gadgetHDF5_new(fileName);
+#ifdef WITH_MPI
+	gadgetHDF5_initParallel(gadgetHDF5, MPI_COMM_WORLD);
+#endif
+	if (genics->rank == 0)
+		printf(" * Writing %s in %" PRIu32 " rounds\n", fileName, numRounds);
+
+	gadgetHDF5_create(gadgetHDF5, header, npFile);
+	for (int type = 0; type < 6; type++) {
+		gadgetHDF5_createBlock(gadgetHDF5, GADGETBLOCK_POS_, type);
+		gadgetHDF5_createBlock(gadgetHDF5, GADGETBLOCK_VEL_, type);
+		gadgetHDF5_createBlock(gadgetHDF5, GADGETBLOCK_ID__, type);
+		if (withMassBlock)
+			gadgetHDF5_createBlock(gadgetHDF5, GADGETBLOCK_MASS, type);
+	}
+	if (genics->mode->doGas && arrIdx == 1)
+		gadgetHDF5_createBlock(gadgetHDF5, GADGETBLOCK_U___, 0);
+
+	for (uint32_t i = 0; i < numRounds; i++) {
+		partBunch_t particles     = NULL;
+		uint64_t    firstParticle = UINT64_C(0);
+
+		if (N1 + i < N2) {
+			uint32_t firstTile = g9pICMap_getFirstTileInFile(map, N1 + i);
+
+			printf(" * Working on part %" PRIu32 "\n", N1 + i);
+			double timing = -local_getTime();
+
+			prof_start("file");
+			particles = local_makeParticles(genics, map, N1 + i, startID);
+			prof_stop("file");
+			for (uint32_t pos = 0; pos < firstTile; pos++)
+				firstParticle += local_computeNumParts(
+				    genics, g9pICMap_getTileAt(map, pos));
+
+			timing += local_getTime();
+			printf("      Part processed in in %.2fs\n", timing);
+		}
+
+		prof_start("writeGadget");
+		local_writeHDF5Part(genics, gadgetHDF5, particles, firstParticle,
+		                    withMassBlock);
+		prof_stop("writeGadget");
+
+		if (particles != NULL)
+			partBunch_del(&particles);
+	}
+
+	gadgetHDF5_del(&gadgetHDF5);
+	xfree(fileName);
+	gadgetHeader_del(&header);
+} // local_runHDF5
+
+static void
+local_writeHDF5Part(const generateICs_t genics,
+                    gadgetHDF5_t        gadgetHDF5,
+                    const partBunch_t   particles,
+                    uint64_t            firstParticle,
+                    bool                withMassBlock)
+{
+	uint32_t minlev   = g9pMask_getMinLevel(genics->mask);
+	uint32_t arrIdx   = (genics->typeForLevel)[genics->zoomlevel - minlev];
+	bool     withGas  = genics->mode->doGas && arrIdx == 1;
+	int      types[2] = {withGas ? 0 : (int)arrIdx, (int)arrIdx};
+	int      numTypes = withGas ? 2 : 1;
+	uint64_t np       = (particles != NULL)
+	                    ? partBunch_getNumParticles(particles) : 0;
+	uint64_t npType   = withGas ? np / 2 : np;
+	fpv_t    *values  = NULL;
+
+	// The gas particles come first, followed by the same number of dark
+	// matter particles, see generateICsCode_dm2Gas().
+	assert(!withGas || np % 2 == 0);
+
+	if (withMassBlock || withGas)
+		values = xmalloc(sizeof(fpv_t) * (npType > 0 ? npType : 1));
+
+	for (int t = 0; t < numTypes; t++) {
+		uint64_t skip = t * npType;
+
+		gadgetHDF5_writeBlock(gadgetHDF5, GADGETBLOCK_POS_, types[t],
+		                      firstParticle, npType, npType > 0
+		                      ? partBunch_at(particles, 0, skip) : NULL);
+		gadgetHDF5_writeBlock(gadgetHDF5, GADGETBLOCK_VEL_, types[t],
+		                      firstParticle, npType, npType > 0
+		                      ? partBunch_at(particles, 1, skip) : NULL);
+		gadgetHDF5_writeBlock(gadgetHDF5, GADGETBLOCK_ID__, types[t],
+		                      firstParticle, npType, npType > 0
+		                      ? partBunch_at(particles, 2, skip) : NULL);
+		if (withMassBlock) {
+			uint64_t npFull = POW_NDIM((uint64_t)g9pMask_getDim1DLevel(
+			                               genics->mask, genics->zoomlevel));
+			fpv_t    mass1  = generateICsOut_boxMass(genics->data) / npFull;
+			for (uint64_t i = 0; i < npType; i++)
+				values[i] = mass1;
+			gadgetHDF5_writeBlock(gadgetHDF5, GADGETBLOCK_MASS, types[t],
+			                      firstParticle, npType, values);
+		}
+	}
+
+	if (withGas) {
+		for (uint64_t i = 0; i < npType; i++)
+			values[i] = 0;
+		gadgetHDF5_writeBlock(gadgetHDF5, GADGETBLOCK_U___, 0,
+		                      firstParticle, npType, values);
+	}
+
+	if (values != NULL)
+		xfree(values);
+} // local_writeHDF5Part
+
+#endif
+
+static double
+local_getTime(void)
+{
+#if (defined WITH_MPI)
+	return MPI_Wtime();
+#elif (defined WITH_OPENMP)
+	return omp_get_wtime();
+#else
+	return clock() / (double)CLOCKS_PER_SEC;
+#endif
+}
@@ -18,14 +18,18 @@
 /*--- Includes ----------------------------------------------------------*/
 #include "generateICsConfig.h"
 #include <stdio.h>
+#include <stdint.h>
+#include <stdbool.h>
 #include "generateICsMode.h"
 #include "generateICsData.h"
 #include "generateICsIn.h"
+#include "generateICsMem.h"
 #include "generateICsOut.h"
 #include "../../src/libcosmo/cosmoModel.h"
 #include "../../src/libg9p/g9pHierarchy.h"
 #include "../../src/libg9p/g9pDataStore.h"
 #include "../../src/libg9p/g9pMask.h"
+#include "../../src/libutil/lIdx.h"
 
 
 /*--- ADT handle --------------------------------------------------------*/
@@ -166,6 +170,41 @@ generateICs_setShift(generateICs_t genics, gridPointDbl_t shift);
 extern void
 generateICs_setZoomLevel(generateICs_t genics, int32_t z);
 
+/**
+ * @brief  Switches on the profiling of generateICs_run().
+ *
+ * @param[in,out]  genics
+ *                    The application object to work with.  Passing @c NULL
+ *                    is undefined.
+ * @param[in]      *prefix
+ *                    The prefix of the profile files, see prof_report().
+ *                    The application keeps a copy.  Passing @c NULL
+ *                    switches the profiling off again.
+ *
+ * @return  Returns nothing.
+ */
+extern void
+generateICs_setProfilePrefix(generateICs_t genics, const char *prefix);
+
+/**
+ * @brief  Sets the ordering of the particles in the output.
+ *
+ * The tiles are assigned to the files along the curve and the particles
+ * within each file are sorted along it.  The default is
+ * #LIDX_ORDER_LINEAR, which keeps the particles in the order in which they
+ * are created, tile by tile.
+ *
+ * @param[in,out]  genics
+ *                    The application object to work with.  Passing @c NULL
+ *                    is undefined.
+ * @param[in]      order
+ *                    The ordering to use.
+ *
+ * @return  Returns nothing.
+ */
+extern void
+generateICs_setParticleOrder(generateICs_t genics, lIdxOrder_t order);
+
 /** @} */
 
 /**
@@ -256,6 +295,46 @@ extern void
 generateICs_run(generateICs_t genics);
 
 
+/**
+ * @brief  Determines which output files are produced by a given rank.
+ *
+ * @param[in]   genics
+ *                 The application to query.
+ * @param[in]   rank
+ *                 The rank to query.
+ * @param[out]  *firstFile
+ *                 Will receive the first file of the rank.
+ * @param[out]  *lastFile
+ *                 Will receive the file after the last file of the rank.
+ *
+ * @return  Returns @c true if the rank produces files and @c false if
+ *          not, in which case both files are set to 0.
+ */
+extern bool
+generateICs_getFilesForRank(const generateICs_t genics,
+                            int                 rank,
+                            uint32_t            *firstFile,
+                            uint32_t            *lastFile);
+
+
+/**
+ * @brief  Creates an in-memory store for the velocities.
+ *
+ * Every rank will keep the velocities of the tiles that go into the
+ * files it produces (see generateICs_getFilesForRank()).  The store can be
+ * given to ginnungagap as its writer and then be used as the input with
+ * generateICsIn_newFromMem().
+ *
+ * @param[in]  genics
+ *                The application for which to create the store, the mask,
+ *                the zoom level and the output must have been set.
+ *
+ * @return  Returns a new store.
+ */
+extern generateICsMem_t
+generateICs_newMem(const generateICs_t genics);
+
+
 /** @} */
 
 
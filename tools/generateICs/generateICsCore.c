@@ -17,6 +17,7 @@
 #include "generateICsConfig.h"
 #include "generateICsCore.h"
 #include <assert.h>
+#include <stdlib.h>
 #include <string.h>
 #include "../../src/libutil/xmem.h"
 #include "../../src/libutil/lIdx.h"
@@ -24,8 +25,24 @@
 
 /*--- Local defines -----------------------------------------------------*/
 
+/** @brief  Used to sort the particles by their key. */
+struct local_partKey_struct {
+	/** @brief  The key of the cell of the particle. */
+	uint64_t key;
+	/** @brief  The index of the particle before sorting. */
+	uint64_t idx;
+};
+
 
 /*--- Prototypes of local functions -------------------------------------*/
+static int
+local_cmpPartKey(const void *a, const void *b);
+
+static void
+local_permute(void                              *data,
+              size_t                            size,
+              const struct local_partKey_struct *keys,
+              uint64_t                          numParticles);
 
 
 /*--- Implementations of exported functions -----------------------------*/
@@ -212,4 +229,78 @@ generateICsCore_kpc(generateICsCore_const_t d) {
 
 }
 
+extern void
+generateICsCore_sortParticles(generateICsCore_const_t d,
+                              lIdxOrder_t             order,
+                              double                  boxsize)
+{
+	struct local_partKey_struct *keys;
+	const uint32_t              dim1D    = UINT32_C(1) << LIDX_CURVE_MAXBITS;
+	const uint32_t              dims[3]  = {dim1D, dim1D, dim1D};
+
+	assert(d != NULL);
+	assert(boxsize > 0.0);
+
+	if ((order == LIDX_ORDER_LINEAR) || (d->numParticles < 2))
+		return;
+
+	keys = xmalloc(sizeof(struct local_partKey_struct) * d->numParticles);
+#ifdef WITH_OPENMP
+#  pragma omp parallel for
+#endif
+	for (uint64_t i = 0; i < d->numParticles; i++) {
+		uint32_t coords[3];
+		for (int k = 0; k < 3; k++) {
+			double x = d->pos[i * 3 + k] / boxsize;
+			x        -= floor(x);
+			coords[k] = (uint32_t)(x * dim1D);
+			// Guards against rounding up to the upper edge of the box.
+			if (coords[k] >= dim1D)
+				coords[k] = dim1D - 1;
+		}
+		keys[i].key = lIdx_toKey3d(order, coords, dims, LIDX_CURVE_MAXBITS);
+		keys[i].idx = i;
+	}
+	qsort(keys, d->numParticles, sizeof(struct local_partKey_struct),
+	      &local_cmpPartKey);
+
+	local_permute(d->pos, sizeof(fpv_t) * 3, keys, d->numParticles);
+	local_permute(d->vel, sizeof(fpv_t) * 3, keys, d->numParticles);
+	local_permute(d->id,
+	              d->mode->useLongIDs ? sizeof(uint64_t) : sizeof(uint32_t),
+	              keys, d->numParticles);
+
+	xfree(keys);
+} // generateICsCore_sortParticles
+
 /*--- Implementations of local functions --------------------------------*/
+static int
+local_cmpPartKey(const void *a, const void *b)
+{
+	const struct local_partKey_struct *ka = a;
+	const struct local_partKey_struct *kb = b;
+
+	// The index breaks ties, this keeps the sort stable.
+	if (ka->key != kb->key)
+		return (ka->key < kb->key) ? -1 : 1;
+
+	return (ka->idx < kb->idx) ? -1 : ((ka->idx > kb->idx) ? 1 : 0);
+}
+
+static void
+local_permute(void                              *data,
+              size_t                            size,
+              const struct local_partKey_struct *keys,
+              uint64_t                          numParticles)
+{
+	char *tmp = xmalloc(size * numParticles);
+
+#ifdef WITH_OPENMP
+#  pragma omp parallel for
+#endif
+	for (uint64_t i = 0; i < numParticles; i++)
+		memcpy(tmp + i * size, (char *)data + keys[i].idx * size, size);
+	memcpy(data, tmp, size * numParticles);
+
+	xfree(tmp);
+}
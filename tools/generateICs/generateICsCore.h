@@ -20,6 +20,7 @@
 #include "generateICsData.h"
 #include "generateICsMode.h"
 #include "../../src/libgrid/gridPatch.h"
+#include "../../src/libutil/lIdx.h"
 
 
 /*--- Simple structure easing the data passing --------------------------*/
@@ -87,6 +88,30 @@ generateICsCore_recenter(generateICsCore_const_t d, float* newCenter);
 extern void
 generateICsCore_kpc(generateICsCore_const_t d);
 
+/**
+ * @brief  Sorts the particles along a space-filling curve.
+ *
+ * The positions are mapped periodically onto a grid of 2^21 cells per
+ * dimension covering the box, the particles are then sorted by the key of
+ * their cell.  Positions, velocities and IDs are moved together, particles
+ * in the same cell keep their relative order.
+ *
+ * @param[in,out]  d
+ *                    The particles to sort, given by @c numParticles,
+ *                    @c pos, @c vel and @c id.
+ * @param[in]      order
+ *                    The curve to sort along, #LIDX_ORDER_LINEAR leaves
+ *                    the particles as they are.
+ * @param[in]      boxsize
+ *                    The size of the box in the units of the positions.
+ *
+ * @return  Returns nothing.
+ */
+extern void
+generateICsCore_sortParticles(generateICsCore_const_t d,
+                              lIdxOrder_t             order,
+                              double                  boxsize);
+
 /*--- Doxygen group definitions -----------------------------------------*/
 
 /**
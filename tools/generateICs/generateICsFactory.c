@@ -243,9 +243,39 @@ local_newFromIni_output(parse_ini_t   ini,
 void
 local_doPatch(parse_ini_t ini, const char *sectionName, gridReader_t reader);
 
+/**
+ * @brief  Does the work for the exported constructors.
+ *
+ * @param[in,out]  ini
+ *                    The ini file to use.
+ * @param[in]      *sectionName
+ *                    The main section, may be @c NULL.
+ * @param[in]      withInput
+ *                    Whether the input should be constructed from the ini
+ *                    file.
+ *
+ * @return  Returns a new application.
+ */
+static generateICs_t
+local_newFromIni(parse_ini_t ini, const char *sectionName, bool withInput);
+
 /*--- Implementations of exported functios ------------------------------*/
 extern generateICs_t
 generateICsFactory_newFromIni(parse_ini_t ini, const char *sectionName)
+{
+	return local_newFromIni(ini, sectionName, true);
+}
+
+extern generateICs_t
+generateICsFactory_newFromIniWithoutInput(parse_ini_t ini,
+                                          const char  *sectionName)
+{
+	return local_newFromIni(ini, sectionName, false);
+}
+
+/*--- Implementations of local functions --------------------------------*/
+static generateICs_t
+local_newFromIni(parse_ini_t ini, const char *sectionName, bool withInput)
 {
 	generateICs_iniData_t iniData;
 	generateICs_t         genics;
@@ -290,7 +320,8 @@ generateICsFactory_newFromIni(parse_ini_t ini, const char *sectionName)
 	minlev = g9pMask_getMinLevel(mask);
 	maxlev = g9pMask_getMaxLevel(mask);
 
-	local_newFromIni_input(ini, iniData->inputSection, genics);
+	if (withInput)
+		local_newFromIni_input(ini, iniData->inputSection, genics);
 	local_newFromIni_output(ini, iniData->outputSection, genics,minlev,maxlev);
 
 	local_iniDataDel(&iniData);
@@ -323,11 +354,34 @@ generateICsFactory_newFromIni(parse_ini_t ini, const char *sectionName)
 		}
 	}
 	generateICs_setShift(genics, shift);
+
+	char *prefix;
+	if (parse_ini_get_string(ini, "profilePrefix",
+	                         (sectionName != NULL) ? sectionName :
+	                         GENERATEICSCONFIG_DEFAULT_SECTIONNAME,
+	                         &prefix)) {
+		generateICs_setProfilePrefix(genics, prefix);
+		xfree(prefix);
+	}
+
+	char *order;
+	if (parse_ini_get_string(ini, "particleOrder",
+	                         (sectionName != NULL) ? sectionName :
+	                         GENERATEICSCONFIG_DEFAULT_SECTIONNAME,
+	                         &order)) {
+		if (strcmp(order, "morton") == 0) {
+			generateICs_setParticleOrder(genics, LIDX_ORDER_MORTON);
+		} else if (strcmp(order, "hilbert") == 0) {
+			generateICs_setParticleOrder(genics, LIDX_ORDER_HILBERT);
+		} else if (strcmp(order, "none") != 0) {
+			fprintf(stderr, "Unknown particle order %s\n", order);
+			diediedie(EXIT_FAILURE);
+		}
+		xfree(order);
+	}
 	
 	return genics;
-} // generateICsFactory_newFromIni
-
-/*--- Implementations of local functions --------------------------------*/
+} // local_newFromIni
 
 static generateICs_iniData_t
 local_iniDataNewFromIni(parse_ini_t ini, const char *sectionName)
@@ -684,6 +738,7 @@ local_newFromIni_output(parse_ini_t   ini,
 	uint32_t        numFiles;
 	char            *prefix;
 	char            *version;
+	char            *format;
 	char 			tname[50];
 	gadgetVersion_t ver;
 
@@ -710,6 +765,21 @@ local_newFromIni_output(parse_ini_t   ini,
 	generateICsOut_t out;
 	out = generateICsOut_new(prefix, numFilesForLevel, ver, maxlev-minlev+1);
 
+	if (parse_ini_get_string(ini, "format", secName, &format)) {
+		if (strcmp(format, "hdf5") == 0) {
+#ifdef WITH_HDF5
+			generateICsOut_setUseHDF5(out, true);
+#else
+			fprintf(stderr, "HDF5 output requires compiling with HDF5.\n");
+			diediedie(EXIT_FAILURE);
+#endif
+		} else if (strcmp(format, "gadget") != 0) {
+			fprintf(stderr, "Unknown output format %s\n", format);
+			diediedie(EXIT_FAILURE);
+		}
+		xfree(format);
+	}
+
 	generateICs_setOut(genics, out);
 
 	xfree(prefix);
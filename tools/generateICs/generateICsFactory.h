@@ -41,6 +41,28 @@ extern generateICs_t
 generateICsFactory_newFromIni(parse_ini_t ini, const char *sectionName);
 
 
+/**
+ * @brief  Constructs the application from an ini file, but leaves out the
+ *         input.
+ *
+ * The input section is not read, the input must be set with
+ * generateICs_setIn() before the application is run.
+ *
+ * @param[in,out]  ini
+ *                    The ini file from which to construct the application.
+ * @param[in]      *sectionName
+ *                    The name of section in which to look for the setup
+ *                    information.  This may be @c NULL in which case the
+ *                    value of #GENERATEICSCONFIG_DEFAULT_SECTIONNAME is
+ *                    used.
+ *
+ * @return  Returns a new application without input.
+ */
+extern generateICs_t
+generateICsFactory_newFromIniWithoutInput(parse_ini_t ini,
+                                          const char  *sectionName);
+
+
 /*--- Doxygen group definitions -----------------------------------------*/
 
 /**
@@ -35,6 +35,7 @@ generateICsIn_new(gridReader_t velx, gridReader_t vely, gridReader_t velz)
 	in->velx    = velx;
 	in->vely    = vely;
 	in->velz    = velz;
+	in->mem     = NULL;
 
 	in->varVelx = dataVar_new("velx", DATAVARTYPE_FPV, 1);
 	in->varVely = dataVar_new("vely", DATAVARTYPE_FPV, 1);
@@ -43,6 +44,19 @@ generateICsIn_new(gridReader_t velx, gridReader_t vely, gridReader_t velz)
 	return in;
 }
 
+extern generateICsIn_t
+generateICsIn_newFromMem(generateICsMem_t mem)
+{
+	generateICsIn_t in;
+
+	assert(mem != NULL);
+
+	in      = generateICsIn_new(NULL, NULL, NULL);
+	in->mem = mem;
+
+	return in;
+}
+
 extern void
 generateICsIn_del(generateICsIn_t *in)
 {
@@ -52,12 +66,33 @@ generateICsIn_del(generateICsIn_t *in)
 	dataVar_del( &( (*in)->varVely ) );
 	dataVar_del( &( (*in)->varVelz ) );
 
-	gridReader_del( &( (*in)->velx ) );
-	gridReader_del( &( (*in)->vely ) );
-	gridReader_del( &( (*in)->velz ) );
+	if ( (*in)->mem != NULL ) {
+		generateICsMem_del( &( (*in)->mem ) );
+	} else {
+		gridReader_del( &( (*in)->velx ) );
+		gridReader_del( &( (*in)->vely ) );
+		gridReader_del( &( (*in)->velz ) );
+	}
 	xfree(*in);
 
 	*in = NULL;
 }
 
+extern void
+generateICsIn_readIntoPatch(generateICsIn_t in,
+                            gridPatch_t     patch,
+                            uint32_t        tile)
+{
+	assert(in != NULL);
+	assert(patch != NULL);
+
+	if (in->mem != NULL) {
+		generateICsMem_readIntoPatch(in->mem, patch, tile);
+	} else {
+		gridReader_readIntoPatchForVar(in->velx, patch, 0);
+		gridReader_readIntoPatchForVar(in->vely, patch, 1);
+		gridReader_readIntoPatchForVar(in->velz, patch, 2);
+	}
+}
+
 /*--- Implementations of local functions --------------------------------*/
@@ -17,7 +17,10 @@
 
 /*--- Includes ----------------------------------------------------------*/
 #include "generateICsConfig.h"
+#include <stdint.h>
+#include "generateICsMem.h"
 #include "../../src/libgrid/gridReader.h"
+#include "../../src/libgrid/gridPatch.h"
 #include "../../src/libdata/dataVar.h"
 
 
@@ -30,6 +33,8 @@ struct generateICsIn_struct {
 	gridReader_t velx;
 	gridReader_t vely;
 	gridReader_t velz;
+	// Alternative to the readers, NULL if reading from files
+	generateICsMem_t mem;
 	// Auto generated
 	dataVar_t    varVelx;
 	dataVar_t    varVely;
@@ -41,9 +46,39 @@ struct generateICsIn_struct {
 extern generateICsIn_t
 generateICsIn_new(gridReader_t velx, gridReader_t vely, gridReader_t velz);
 
+/**
+ * @brief  Creates an input that takes the velocities from memory.
+ *
+ * @param[in]  mem
+ *                The store holding the velocities.  The input takes over
+ *                the reference.
+ *
+ * @return  Returns a new input.
+ */
+extern generateICsIn_t
+generateICsIn_newFromMem(generateICsMem_t mem);
+
 extern void
 generateICsIn_del(generateICsIn_t *generateICsIn);
 
+/**
+ * @brief  Fills a patch with the velocities of a tile.
+ *
+ * @param[in,out]  in
+ *                    The input to use.
+ * @param[in,out]  patch
+ *                    The patch to fill, it must have #varVelx, #varVely
+ *                    and #varVelz attached at the positions 0, 1 and 2.
+ * @param[in]      tile
+ *                    The tile the patch belongs to.
+ *
+ * @return  Returns nothing.
+ */
+extern void
+generateICsIn_readIntoPatch(generateICsIn_t in,
+                            gridPatch_t     patch,
+                            uint32_t        tile);
+
 
 /*--- Doxygen group definitions -----------------------------------------*/
 
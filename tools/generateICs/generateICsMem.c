@@ -0,0 +1,615 @@
+// Copyright (C) 2013, Steffen Knollmann
+// Released under the terms of the GNU General Public License version 3.
+// This file is part of `ginnungagap'.
+
+
+/*--- Doxygen file description ------------------------------------------*/
+
+/**
+ * @file generateICs/generateICsMem.c
+ * @ingroup  toolsGICSMem
+ * @brief  Implements the in-memory velocity store.
+ */
+
+
+/*--- Includes ----------------------------------------------------------*/
+#include "generateICsConfig.h"
+#include "generateICsMem.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include <assert.h>
+#ifdef WITH_MPI
+#  include <mpi.h>
+#  include "../../src/libutil/commScheme.h"
+#  include "../../src/libutil/commSchemeBuffer.h"
+#endif
+#include "../../src/libgrid/gridRegular.h"
+#include "../../src/libgrid/gridPoint.h"
+#include "../../src/libdata/dataVar.h"
+#include "../../src/libutil/refCounter.h"
+#include "../../src/libutil/filename.h"
+#include "../../src/libutil/xmem.h"
+#include "../../src/libutil/diediedie.h"
+
+
+/*--- Implemention of main structure ------------------------------------*/
+#include "../../src/libgrid/gridWriter_adt.h"
+
+/** @brief  The main structure of the in-memory velocity store. */
+struct generateICsMem_struct {
+	/** @brief  The base structure, the store is a grid writer. */
+	struct gridWriter_struct base;
+	/** @brief  The reference counter. */
+	refCounter_t             refCounter;
+	/** @brief  The mask describing the tiles. */
+	g9pMask_t                mask;
+	/** @brief  The level at which the velocities are given. */
+	uint8_t                  level;
+	/** @brief  The number of ranks. */
+	int                      size;
+	/** @brief  The rank of this process. */
+	int                      rank;
+#ifdef WITH_MPI
+	/** @brief  The communicator used for the redistribution. */
+	MPI_Comm                 comm;
+#endif
+	/** @brief  The first position owned by each rank. */
+	uint32_t                 *firstTile;
+	/** @brief  The last position (inclusive) owned by each rank. */
+	uint32_t                 *lastTile;
+	/** @brief  The tile at each position. */
+	uint32_t                 *tileAt;
+	/** @brief  The position of each tile. */
+	uint32_t                 *posOfTile;
+	/** @brief  The box (@c idxLo then @c idxHi) of each tile at level. */
+	uint32_t                 *tileBoxes;
+	/** @brief  Whether a tile has cells at the level. */
+	bool                     *isTileUsed;
+	/** @brief  The variables for velx, vely and velz. */
+	dataVar_t                vars[NDIM];
+	/** @brief  The patches of the own tiles, @c NULL if unused. */
+	gridPatch_t              *tiles;
+	/** @brief  Which components have been captured. */
+	bool                     hasComponent[NDIM];
+};
+
+
+/*--- Local defines -----------------------------------------------------*/
+
+/** @brief  The tag used for the redistribution. */
+#define LOCAL_TAG 4711
+
+
+/*--- Prototypes of local functions -------------------------------------*/
+static void
+local_del(gridWriter_t *writer);
+
+static void
+local_activate(gridWriter_t writer);
+
+static void
+local_deactivate(gridWriter_t writer);
+
+static void
+local_writeGridRegular(gridWriter_t writer, gridRegular_t grid);
+
+#ifdef WITH_MPI
+static void
+local_initParallel(gridWriter_t writer, MPI_Comm mpiComm);
+
+#endif
+
+static int
+local_getComponent(const filename_t fileName);
+
+static void
+local_checkGrid(const generateICsMem_t mem, gridRegular_t grid);
+
+static uint32_t *
+local_getPatchBoxes(const generateICsMem_t mem, gridPatch_t patch);
+
+static bool
+local_getOverlap(const uint32_t    *boxA,
+                 const uint32_t    *boxB,
+                 gridPointUint32_t idxLo,
+                 gridPointUint32_t idxHi);
+
+static uint32_t
+local_getNumTilesOfRank(const generateICsMem_t mem, int owner);
+
+static uint64_t
+local_getNumOverlap(const generateICsMem_t mem,
+                    int                    owner,
+                    const uint32_t         *box);
+
+static void
+local_pack(const generateICsMem_t mem,
+           int                    owner,
+           gridPatch_t            patch,
+           const uint32_t         *box,
+           fpv_t                  *buffer);
+
+static void
+local_unpack(generateICsMem_t mem,
+             int              comp,
+             const uint32_t   *box,
+             const fpv_t      *buffer);
+
+static void
+local_redistribute(generateICsMem_t mem, gridPatch_t patch, int comp);
+
+
+/*--- Local variables ---------------------------------------------------*/
+
+/** @brief  The function table of the store. */
+static struct gridWriter_func_struct local_func
+    = {.del              = &local_del,
+       .activate         = &local_activate,
+       .deactivate       = &local_deactivate,
+       .writeGridPatch   = NULL,
+       .writeGridRegular = &local_writeGridRegular,
+#ifdef WITH_MPI
+       .initParallel     = &local_initParallel
+#endif
+	};
+
+/** @brief  The qualifiers under which ginnungagap writes the velocities. */
+static const char *local_qualifiers[NDIM] = {"_velx", "_vely", "_velz"};
+
+/** @brief  The names of the velocity variables. */
+static const char *local_names[NDIM] = {"velx", "vely", "velz"};
+
+
+/*--- Implementations of exported functions -----------------------------*/
+extern generateICsMem_t
+generateICsMem_new(g9pMask_t      mask,
+                   uint8_t        level,
+                   const uint32_t *firstTile,
+                   const uint32_t *lastTile,
+                   const uint32_t *tileOrder)
+{
+	generateICsMem_t mem;
+	uint32_t         numTiles, numOwnTiles;
+
+	assert(mask != NULL);
+	assert(firstTile != NULL && lastTile != NULL);
+
+	mem = xmalloc(sizeof(struct generateICsMem_struct));
+	gridWriter_init((gridWriter_t)mem, GRIDIO_TYPE_UNKNOWN, &local_func);
+	refCounter_init(&(mem->refCounter));
+	mem->mask  = g9pMask_getRef(mask);
+	mem->level = level;
+	mem->size  = 1;
+	mem->rank  = 0;
+#ifdef WITH_MPI
+	mem->comm = MPI_COMM_WORLD;
+	MPI_Comm_size(mem->comm, &(mem->size));
+	MPI_Comm_rank(mem->comm, &(mem->rank));
+#endif
+
+	mem->firstTile = xmalloc(sizeof(uint32_t) * mem->size * 2);
+	mem->lastTile  = mem->firstTile + mem->size;
+	memcpy(mem->firstTile, firstTile, sizeof(uint32_t) * mem->size);
+	memcpy(mem->lastTile, lastTile, sizeof(uint32_t) * mem->size);
+
+	numTiles       = g9pMask_getTotalNumTiles(mask);
+	mem->tileAt    = xmalloc(sizeof(uint32_t) * numTiles * 2);
+	mem->posOfTile = mem->tileAt + numTiles;
+	for (uint32_t t = 0; t < numTiles; t++) {
+		mem->tileAt[t] = (tileOrder != NULL) ? tileOrder[t] : t;
+		assert(mem->tileAt[t] < numTiles);
+		mem->posOfTile[mem->tileAt[t]] = t;
+	}
+
+	mem->tileBoxes  = xmalloc(sizeof(uint32_t) * numTiles * 2 * NDIM);
+	mem->isTileUsed = xmalloc(sizeof(bool) * numTiles);
+	for (uint32_t t = 0; t < numTiles; t++) {
+		gridPatch_t       patch;
+		gridPointUint32_t dims;
+		uint32_t          *box = mem->tileBoxes + t * 2 * NDIM;
+
+		mem->isTileUsed[t] = (g9pMask_getNumCellsInTileForLevel(mask, t,
+		                                                        level) > 0)
+		                     ? true : false;
+		patch = g9pMask_getEmptyPatchForTileLevel(mask, t, level);
+		gridPatch_getIdxLo(patch, box);
+		gridPatch_getDims(patch, dims);
+		for (int i = 0; i < NDIM; i++)
+			box[NDIM + i] = box[i] + dims[i] - 1;
+		gridPatch_del(&patch);
+	}
+
+	for (int i = 0; i < NDIM; i++) {
+		mem->vars[i]         = dataVar_new(local_names[i],
+		                                   DATAVARTYPE_FPV, 1);
+		mem->hasComponent[i] = false;
+	}
+
+	numOwnTiles = local_getNumTilesOfRank(mem, mem->rank);
+	mem->tiles  = xmalloc(sizeof(gridPatch_t) * (numOwnTiles + 1));
+	for (uint32_t t = 0; t < numOwnTiles; t++) {
+		uint32_t tile = mem->tileAt[firstTile[mem->rank] + t];
+		mem->tiles[t] = NULL;
+		if (!mem->isTileUsed[tile])
+			continue;
+		mem->tiles[t] = g9pMask_getEmptyPatchForTileLevel(mask, tile, level);
+		for (int i = 0; i < NDIM; i++)
+			(void)gridPatch_attachVar(mem->tiles[t], mem->vars[i]);
+	}
+
+	return generateICsMem_getRef(mem);
+} // generateICsMem_new
+
+extern generateICsMem_t
+generateICsMem_getRef(generateICsMem_t mem)
+{
+	assert(mem != NULL);
+
+	refCounter_ref(&(mem->refCounter));
+
+	return mem;
+}
+
+extern void
+generateICsMem_del(generateICsMem_t *mem)
+{
+	assert(mem != NULL && *mem != NULL);
+
+	if (refCounter_deref(&((*mem)->refCounter))) {
+		uint32_t numTiles = local_getNumTilesOfRank(*mem, (*mem)->rank);
+
+		for (uint32_t i = 0; i < numTiles; i++) {
+			if ((*mem)->tiles[i] != NULL)
+				gridPatch_del((*mem)->tiles + i);
+		}
+		xfree((*mem)->tiles);
+		for (int i = 0; i < NDIM; i++)
+			dataVar_del((*mem)->vars + i);
+		xfree((*mem)->isTileUsed);
+		xfree((*mem)->tileBoxes);
+		xfree((*mem)->firstTile);
+		xfree((*mem)->tileAt);
+		g9pMask_del(&((*mem)->mask));
+		gridWriter_free((gridWriter_t)(*mem));
+		xfree(*mem);
+	}
+
+	*mem = NULL;
+}
+
+extern gridWriter_t
+generateICsMem_getWriter(generateICsMem_t mem)
+{
+	return (gridWriter_t)generateICsMem_getRef(mem);
+}
+
+extern bool
+generateICsMem_isComplete(const generateICsMem_t mem)
+{
+	assert(mem != NULL);
+
+	for (int i = 0; i < NDIM; i++) {
+		if (!mem->hasComponent[i])
+			return false;
+	}
+
+	return true;
+}
+
+extern void
+generateICsMem_readIntoPatch(generateICsMem_t mem,
+                             gridPatch_t      patch,
+                             uint32_t         tile)
+{
+	gridPatch_t stored;
+	uint32_t    slot;
+
+	assert(mem != NULL);
+	assert(patch != NULL);
+	assert(tile < g9pMask_getTotalNumTiles(mem->mask));
+	assert(mem->posOfTile[tile] >= mem->firstTile[mem->rank]
+	       && mem->posOfTile[tile] <= mem->lastTile[mem->rank]);
+	assert(gridPatch_getNumVars(patch) >= NDIM);
+
+	slot   = mem->posOfTile[tile] - mem->firstTile[mem->rank];
+	stored = mem->tiles[slot];
+	if (stored == NULL) {
+		fprintf(stderr, "Velocities of tile %" PRIu32 " not available.\n",
+		        tile);
+		diediedie(EXIT_FAILURE);
+	}
+	assert(gridPatch_getNumCells(stored) == gridPatch_getNumCells(patch));
+
+	for (int i = 0; i < NDIM; i++)
+		gridPatch_replaceVarData(patch, i,
+		                         gridPatch_popVarData(stored, i));
+	gridPatch_del(mem->tiles + slot);
+}
+
+/*--- Implementations of local functions --------------------------------*/
+static void
+local_del(gridWriter_t *writer)
+{
+	generateICsMem_del((generateICsMem_t *)writer);
+}
+
+static void
+local_activate(gridWriter_t writer)
+{
+	gridWriter_setIsActive(writer);
+}
+
+static void
+local_deactivate(gridWriter_t writer)
+{
+	gridWriter_setIsInactive(writer);
+}
+
+static void
+local_writeGridRegular(gridWriter_t writer, gridRegular_t grid)
+{
+	generateICsMem_t mem  = (generateICsMem_t)writer;
+	int              comp = local_getComponent(writer->fileName);
+
+	if (comp < 0)
+		return;
+
+	local_checkGrid(mem, grid);
+	local_redistribute(mem, gridRegular_getPatchHandle(grid, 0), comp);
+	mem->hasComponent[comp] = true;
+}
+
+#ifdef WITH_MPI
+static void
+local_initParallel(gridWriter_t writer, MPI_Comm mpiComm)
+{
+	generateICsMem_t mem = (generateICsMem_t)writer;
+	int              size;
+
+	MPI_Comm_size(mpiComm, &size);
+	assert(size == mem->size);
+	mem->comm = mpiComm;
+	MPI_Comm_rank(mem->comm, &(mem->rank));
+}
+
+#endif
+
+static int
+local_getComponent(const filename_t fileName)
+{
+	const char *qualifier;
+
+	if (fileName == NULL)
+		return -1;
+
+	qualifier = filename_getQualifier(fileName);
+	if (qualifier == NULL)
+		return -1;
+
+	for (int i = 0; i < NDIM; i++) {
+		if (strcmp(qualifier, local_qualifiers[i]) == 0)
+			return i;
+	}
+
+	return -1;
+}
+
+static void
+local_checkGrid(const generateICsMem_t mem, gridRegular_t grid)
+{
+	gridPointUint32_t dims;
+	dataVar_t         var;
+	uint32_t          dim1D = g9pMask_getDim1DLevel(mem->mask, mem->level);
+
+	gridRegular_getDims(grid, dims);
+	for (int i = 0; i < NDIM; i++) {
+		if (dims[i] != dim1D) {
+			fprintf(stderr, "The grid has %" PRIu32 " cells per dimension, "
+			        "but level %i of the mask needs %" PRIu32 ".\n",
+			        dims[i], (int)(mem->level), dim1D);
+			diediedie(EXIT_FAILURE);
+		}
+	}
+	assert(gridRegular_getNumPatches(grid) == 1);
+	assert(gridRegular_getNumVars(grid) == 1);
+
+	var = gridRegular_getVarHandle(grid, 0);
+	if ((dataVar_getType(var) != DATAVARTYPE_FPV)
+	    || dataVar_isFFTWPadded(var) || dataVar_isComplexified(var)) {
+		fprintf(stderr, "Can only keep unpadded real fields of the "
+		        "native floating point type.\n");
+		diediedie(EXIT_FAILURE);
+	}
+}
+
+static uint32_t *
+local_getPatchBoxes(const generateICsMem_t mem, gridPatch_t patch)
+{
+	uint32_t          *boxes = xmalloc(sizeof(uint32_t) * mem->size * 2
+	                                   * NDIM);
+	uint32_t          *box   = boxes + mem->rank * 2 * NDIM;
+	gridPointUint32_t dims;
+
+	gridPatch_getIdxLo(patch, box);
+	gridPatch_getDims(patch, dims);
+	for (int i = 0; i < NDIM; i++)
+		box[NDIM + i] = box[i] + dims[i] - 1;
+
+#ifdef WITH_MPI
+	MPI_Allgather(MPI_IN_PLACE, 0, MPI_DATATYPE_NULL,
+	              boxes, 2 * NDIM, MPI_UINT32_T, mem->comm);
+#endif
+
+	return boxes;
+}
+
+static bool
+local_getOverlap(const uint32_t    *boxA,
+                 const uint32_t    *boxB,
+                 gridPointUint32_t idxLo,
+                 gridPointUint32_t idxHi)
+{
+	for (int i = 0; i < NDIM; i++) {
+		idxLo[i] = (boxA[i] > boxB[i]) ? boxA[i] : boxB[i];
+		idxHi[i] = (boxA[NDIM + i] < boxB[NDIM + i])
+		           ? boxA[NDIM + i] : boxB[NDIM + i];
+		if (idxLo[i] > idxHi[i])
+			return false;
+	}
+
+	return true;
+}
+
+static uint32_t
+local_getNumTilesOfRank(const generateICsMem_t mem, int owner)
+{
+	if (mem->firstTile[owner] > mem->lastTile[owner])
+		return 0;
+
+	return mem->lastTile[owner] - mem->firstTile[owner] + 1;
+}
+
+static uint64_t
+local_getNumOverlap(const generateICsMem_t mem,
+                    int                    owner,
+                    const uint32_t         *box)
+{
+	uint64_t          num      = 0;
+	uint32_t          numTiles = local_getNumTilesOfRank(mem, owner);
+	gridPointUint32_t idxLo, idxHi;
+
+	for (uint32_t i = 0; i < numTiles; i++) {
+		uint32_t t        = mem->tileAt[mem->firstTile[owner] + i];
+		uint64_t numCells = 1;
+
+		if (!mem->isTileUsed[t]
+		    || !local_getOverlap(mem->tileBoxes + t * 2 * NDIM, box,
+		                         idxLo, idxHi))
+			continue;
+		for (int j = 0; j < NDIM; j++)
+			numCells *= idxHi[j] - idxLo[j] + 1;
+		num += numCells;
+	}
+
+	return num;
+}
+
+static void
+local_pack(const generateICsMem_t mem,
+           int                    owner,
+           gridPatch_t            patch,
+           const uint32_t         *box,
+           fpv_t                  *buffer)
+{
+	uint32_t          numTiles = local_getNumTilesOfRank(mem, owner);
+	gridPointUint32_t idxLo, idxHi;
+
+	for (uint32_t i = 0; i < numTiles; i++) {
+		uint32_t t = mem->tileAt[mem->firstTile[owner] + i];
+
+		if (!mem->isTileUsed[t]
+		    || !local_getOverlap(mem->tileBoxes + t * 2 * NDIM, box,
+		                         idxLo, idxHi))
+			continue;
+		buffer += gridPatch_getWindowedData(patch, 0, idxLo, idxHi, buffer);
+	}
+}
+
+static void
+local_unpack(generateICsMem_t mem,
+             int              comp,
+             const uint32_t   *box,
+             const fpv_t      *buffer)
+{
+	uint32_t          numTiles = local_getNumTilesOfRank(mem, mem->rank);
+	gridPointUint32_t idxLo, idxHi;
+
+	for (uint32_t i = 0; i < numTiles; i++) {
+		uint32_t t        = mem->tileAt[mem->firstTile[mem->rank] + i];
+		uint64_t numCells = 1;
+
+		if (!mem->isTileUsed[t]
+		    || !local_getOverlap(mem->tileBoxes + t * 2 * NDIM, box,
+		                         idxLo, idxHi))
+			continue;
+		gridPatch_putWindowedData(mem->tiles[i], comp, idxLo, idxHi,
+		                          buffer);
+		for (int j = 0; j < NDIM; j++)
+			numCells *= idxHi[j] - idxLo[j] + 1;
+		buffer += numCells;
+	}
+}
+
+static void
+local_redistribute(generateICsMem_t mem, gridPatch_t patch, int comp)
+{
+	uint32_t *boxes  = local_getPatchBoxes(mem, patch);
+	uint32_t *ownBox = boxes + mem->rank * 2 * NDIM;
+	uint64_t *numSend, *numRecv;
+	fpv_t    **sendBufs, **recvBufs;
+
+	numSend  = xmalloc(sizeof(uint64_t) * mem->size * 2);
+	numRecv  = numSend + mem->size;
+	sendBufs = xmalloc(sizeof(fpv_t *) * mem->size * 2);
+	recvBufs = sendBufs + mem->size;
+
+	// The own part is packed like any other, it is then simply used as
+	// the receive buffer.
+	for (int r = 0; r < mem->size; r++) {
+		numSend[r]  = local_getNumOverlap(mem, r, ownBox);
+		numRecv[r]  = local_getNumOverlap(mem, mem->rank,
+		                                  boxes + r * 2 * NDIM);
+		sendBufs[r] = NULL;
+		recvBufs[r] = NULL;
+		if (numSend[r] > 0) {
+			sendBufs[r] = xmalloc(sizeof(fpv_t) * numSend[r]);
+			local_pack(mem, r, patch, ownBox, sendBufs[r]);
+		}
+		if (r == mem->rank)
+			recvBufs[r] = sendBufs[r];
+		else if (numRecv[r] > 0)
+			recvBufs[r] = xmalloc(sizeof(fpv_t) * numRecv[r]);
+	}
+
+#ifdef WITH_MPI
+	commScheme_t scheme = commScheme_new(mem->comm, LOCAL_TAG);
+	MPI_Datatype type   = dataVar_getMPIDatatype(mem->vars[comp]);
+
+	for (int r = 0; r < mem->size; r++) {
+		if (r == mem->rank)
+			continue;
+		if (sendBufs[r] != NULL)
+			(void)commScheme_addBuffer(scheme,
+			                           commSchemeBuffer_new(sendBufs[r],
+			                                                (int)numSend[r],
+			                                                type, r),
+			                           COMMSCHEME_TYPE_SEND);
+		if (recvBufs[r] != NULL)
+			(void)commScheme_addBuffer(scheme,
+			                           commSchemeBuffer_new(recvBufs[r],
+			                                                (int)numRecv[r],
+			                                                type, r),
+			                           COMMSCHEME_TYPE_RECV);
+	}
+	commScheme_fire(scheme);
+	commScheme_wait(scheme);
+	commScheme_del(&scheme);
+#endif
+
+	for (int r = 0; r < mem->size; r++) {
+		if (recvBufs[r] != NULL)
+			local_unpack(mem, comp, boxes + r * 2 * NDIM, recvBufs[r]);
+	}
+
+	for (int r = 0; r < mem->size; r++) {
+		if (sendBufs[r] != NULL)
+			xfree(sendBufs[r]);
+		if ((r != mem->rank) && (recvBufs[r] != NULL))
+			xfree(recvBufs[r]);
+	}
+	xfree(sendBufs);
+	xfree(numSend);
+	xfree(boxes);
+} // local_redistribute
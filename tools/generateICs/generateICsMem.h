@@ -0,0 +1,175 @@
+// Copyright (C) 2013, Steffen Knollmann
+// Released under the terms of the GNU General Public License version 3.
+// This file is part of `ginnungagap'.
+
+#ifndef GENERATEICSMEM_H
+#define GENERATEICSMEM_H
+
+
+/*--- Doxygen file description ------------------------------------------*/
+
+/**
+ * @file generateICs/generateICsMem.h
+ * @ingroup  toolsGICSMem
+ * @brief  Provides the interface to the in-memory velocity store.
+ */
+
+
+/*--- Includes ----------------------------------------------------------*/
+#include "generateICsConfig.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include "../../src/libgrid/gridWriter.h"
+#include "../../src/libgrid/gridPatch.h"
+#include "../../src/libg9p/g9pMask.h"
+
+
+/*--- ADT handle --------------------------------------------------------*/
+
+/** @brief  Defines the handle for the in-memory velocity store. */
+typedef struct generateICsMem_struct *generateICsMem_t;
+
+
+/*--- Prototypes of exported functions ----------------------------------*/
+
+/**
+ * @name  Creating and Deleting
+ *
+ * @{
+ */
+
+/**
+ * @brief  Creates a new in-memory velocity store.
+ *
+ * Every rank of @c MPI_COMM_WORLD owns a contiguous range of tiles, for
+ * which it will keep the velocities.  The ranges are given for all ranks
+ * and must be the same on all ranks.  They refer to positions in the
+ * ordering of the tiles, see g9pICMap_getTileOrder().
+ *
+ * @param[in]  mask
+ *                The mask describing the tiles.  The store will keep a
+ *                reference.
+ * @param[in]  level
+ *                The level at which the velocities are given.
+ * @param[in]  *firstTile
+ *                The first position owned by each rank.
+ * @param[in]  *lastTile
+ *                The last position (inclusive) owned by each rank.  If it
+ *                is smaller than the first position, the rank owns no tile.
+ * @param[in]  *tileOrder
+ *                The tile at each position.  If this is @c NULL, the
+ *                positions are the tiles.
+ *
+ * @return  Returns a new store with one reference.
+ */
+extern generateICsMem_t
+generateICsMem_new(g9pMask_t      mask,
+                   uint8_t        level,
+                   const uint32_t *firstTile,
+                   const uint32_t *lastTile,
+                   const uint32_t *tileOrder);
+
+
+/**
+ * @brief  Retrieves a new reference to a store.
+ *
+ * @param[in,out]  mem
+ *                    The store to reference.
+ *
+ * @return  Returns the store.
+ */
+extern generateICsMem_t
+generateICsMem_getRef(generateICsMem_t mem);
+
+
+/**
+ * @brief  Releases a reference to a store; the last one frees it.
+ *
+ * @param[in,out]  *mem
+ *                    A pointer to the variable holding the store, will be
+ *                    set to @c NULL.
+ *
+ * @return  Returns nothing.
+ */
+extern void
+generateICsMem_del(generateICsMem_t *mem);
+
+
+/** @} */
+
+/**
+ * @name  Using
+ *
+ * @{
+ */
+
+/**
+ * @brief  Provides the store as a grid writer.
+ *
+ * Writing a grid to the writer will capture it, if the qualifier of the
+ * file name of the writer is @c _velx, @c _vely or @c _velz (as set by
+ * ginnungagap), and ignore it otherwise.  The grid must hold one
+ * unpadded variable of type #DATAVARTYPE_FPV at the resolution of the
+ * level of the store and is redistributed to the ranks owning the tiles.
+ * All ranks must write the same sequence of grids.
+ *
+ * @param[in,out]  mem
+ *                    The store to use.
+ *
+ * @return  Returns a new reference to the store in the form of a writer,
+ *          to be released with gridWriter_del().
+ */
+extern gridWriter_t
+generateICsMem_getWriter(generateICsMem_t mem);
+
+
+/**
+ * @brief  Checks whether all three velocity components have been captured.
+ *
+ * @param[in]  mem
+ *                The store to query.
+ *
+ * @return  Returns @c true if velx, vely and velz have been captured.
+ */
+extern bool
+generateICsMem_isComplete(const generateICsMem_t mem);
+
+
+/**
+ * @brief  Moves the velocities of a tile into a patch.
+ *
+ * The memory held by the store for the tile is handed to the patch, a
+ * tile can hence only be retrieved once.
+ *
+ * @param[in,out]  mem
+ *                    The store to use.
+ * @param[in,out]  patch
+ *                    The patch to fill, it must cover the tile at the
+ *                    level of the store and have the variables for velx,
+ *                    vely and velz attached at the positions 0, 1 and 2.
+ * @param[in]      tile
+ *                    The tile to retrieve, it must be owned by the calling
+ *                    rank.
+ *
+ * @return  Returns nothing.
+ */
+extern void
+generateICsMem_readIntoPatch(generateICsMem_t mem,
+                             gridPatch_t      patch,
+                             uint32_t         tile);
+
+
+/** @} */
+
+
+/*--- Doxygen group definitions -----------------------------------------*/
+
+/**
+ * @defgroup toolsGICSMem In-memory Velocities
+ * @ingroup toolsGICS
+ * @brief  Hands the velocities from ginnungagap to generateICs without
+ *         going through files.
+ */
+
+
+#endif
@@ -16,8 +16,12 @@
 #include "generateICsConfig.h"
 #include "generateICsOut.h"
 #include <assert.h>
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
 #include "../../src/libcosmo/cosmo.h"
 #include "../../src/libutil/xmem.h"
+#include "../../src/libutil/xstring.h"
 
 
 /*--- Local defines -----------------------------------------------------*/
@@ -45,6 +49,9 @@ generateICsOut_new(const char *prefix, uint32_t* outputFiles, gadgetVersion_t v,
 		nFilesTot+=outputFiles[i];
 		//printf("of %i\n",outputFiles[i]);
 	}
+	genicsOut->numLevels = (uint32_t)s;
+	genicsOut->prefix    = xstrdup(prefix);
+	genicsOut->useHDF5   = false;
 
 
 	genicsOut->gadget = gadget_newSimple(prefix, nFilesTot);
@@ -72,12 +79,39 @@ generateICsOut_del(generateICsOut_t *genicsOut)
 		gadgetHeader_del( &( (*genicsOut)->baseHeader ) );
 	}
 	gadget_del( &( (*genicsOut)->gadget ) );
+	xfree( (*genicsOut)->prefix );
 
 	xfree(*genicsOut);
 
 	*genicsOut = NULL;
 }
 
+extern void
+generateICsOut_setUseHDF5(generateICsOut_t genicsOut, bool useHDF5)
+{
+	assert(genicsOut != NULL);
+
+	genicsOut->useHDF5 = useHDF5;
+}
+
+extern char *
+generateICsOut_getHDF5FileName(const generateICsOut_t genicsOut,
+                               uint32_t               levelIdx)
+{
+	char *fileName;
+
+	assert(genicsOut != NULL);
+	assert(levelIdx < genicsOut->numLevels);
+
+	fileName = xmalloc(strlen(genicsOut->prefix) + 20);
+	if (genicsOut->numLevels == 1)
+		sprintf(fileName, "%s.hdf5", genicsOut->prefix);
+	else
+		sprintf(fileName, "%s.%" PRIu32 ".hdf5", genicsOut->prefix, levelIdx);
+
+	return fileName;
+}
+
 extern double
 generateICsOut_boxMass(const generateICsData_t data)
 {
@@ -96,7 +130,9 @@ generateICsOut_initBaseHeader(generateICsOut_t        genicsOut,
 	double         massarr[6];
 	const double   boxsize      = data->boxsizeInMpch;
 	const double   omegaMatter0 = cosmoModel_getOmegaMatter0(data->model);
-	const int      numFiles     = gadget_getNumFiles(genicsOut->gadget);
+	const int      numFiles     = genicsOut->useHDF5
+	                              ? (int)(genicsOut->numLevels)
+	                              : gadget_getNumFiles(genicsOut->gadget);
 
 	gadgetHeader_t header       = gadgetHeader_new();
 
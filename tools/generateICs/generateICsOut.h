@@ -31,6 +31,12 @@ struct generateICsOut_struct {
 	// Input
 	//const int      numFiles;
 	uint32_t*		numFilesForLevel;
+	/** @brief  The number of levels, one HDF5 file is written per level. */
+	uint32_t       numLevels;
+	/** @brief  The prefix of the output files. */
+	char           *prefix;
+	/** @brief  Whether Gadget HDF5 files are written instead of binary. */
+	bool           useHDF5;
 	gadget_t       gadget;
 	gadgetTOC_t    toc;
 	// Generated by initBaseHeader();
@@ -45,6 +51,39 @@ generateICsOut_new(const char *prefix, uint32_t* outputFiles, gadgetVersion_t v,
 extern void
 generateICsOut_del(generateICsOut_t *genicsOut);
 
+/**
+ * @brief  Switches the output to Gadget HDF5 files.
+ *
+ * All processes write collectively into one file per level, called
+ * @c prefix.hdf5 for a single level and @c prefix.N.hdf5 otherwise, with
+ * @c N counting the levels from the coarsest.  The number of files per
+ * level then only sets how the particles are split among the processes.
+ *
+ * @param[in,out]  genicsOut
+ *                    The output object to work with.
+ * @param[in]      useHDF5
+ *                    Whether HDF5 files should be written.
+ *
+ * @return  Returns nothing.
+ */
+extern void
+generateICsOut_setUseHDF5(generateICsOut_t genicsOut, bool useHDF5);
+
+/**
+ * @brief  Retrieves the name of the HDF5 file of a level.
+ *
+ * @param[in]  genicsOut
+ *                The output object to query.
+ * @param[in]  levelIdx
+ *                The index of the level, counting from the coarsest.
+ *
+ * @return  Returns a new string holding the file name, the caller must
+ *          free it.
+ */
+extern char *
+generateICsOut_getHDF5FileName(const generateICsOut_t genicsOut,
+                               uint32_t               levelIdx);
+
 extern void
 generateICsOut_initBaseHeader(generateICsOut_t        genicsOut,
                               const generateICsData_t data,
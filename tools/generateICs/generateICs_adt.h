@@ -29,6 +29,7 @@
 #include "../../src/libg9p/g9pHierarchy.h"
 #include "../../src/libg9p/g9pDataStore.h"
 #include "../../src/libg9p/g9pMask.h"
+#include "../../src/libutil/lIdx.h"
 
 
 /*--- Implemention of main structure ------------------------------------*/
@@ -62,6 +63,11 @@ struct generateICs_struct {
 	int32_t zoomlevel;
 	int32_t *typeForLevel;
 	double *shift;
+
+	/** @brief  Stores the prefix of the profile, @c NULL if disabled. */
+	char *profilePrefix;
+	/** @brief  Stores the ordering of the tiles and particles. */
+	lIdxOrder_t particleOrder;
 };
 
 
@@ -125,6 +125,24 @@ generateICs_setShift(generateICs_t genics, double* shift)
 	}
 }
 
+extern void
+generateICs_setProfilePrefix(generateICs_t genics, const char *prefix)
+{
+	assert(genics != NULL);
+
+	if (genics->profilePrefix != NULL)
+		xfree(genics->profilePrefix);
+	genics->profilePrefix = (prefix != NULL) ? xstrdup(prefix) : NULL;
+}
+
+extern void
+generateICs_setParticleOrder(generateICs_t genics, lIdxOrder_t order)
+{
+	assert(genics != NULL);
+
+	genics->particleOrder = order;
+}
+
 /*--- Exported function: Getter -----------------------------------------*/
 extern g9pHierarchy_t
 generateICs_getHierarchy(const generateICs_t genics)
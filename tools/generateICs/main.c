@@ -92,6 +92,10 @@ main(int argc, char **argv)
 	generateICs_run(genics);
 	generateICs_del(&genics);
 
+#ifdef WITH_MPI
+	MPI_Finalize();
+#endif
+
 	return EXIT_SUCCESS;
 }
 
@@ -0,0 +1,95 @@
+// Copyright (C) 2013, Steffen Knollmann
+// Released under the terms of the GNU General Public License version 3.
+// This file is part of `ginnungagap'.
+
+
+/*--- Doxygen file description ------------------------------------------*/
+
+/**
+ * @file ginnungagapICs/ginnungagapICs.c
+ * @ingroup  toolsG9pICs
+ * @brief  Provides the implementation of the combined ginnungagap and
+ *         generateICs application.
+ */
+
+
+/*--- Includes ----------------------------------------------------------*/
+#include "ginnungagapICs.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <assert.h>
+#include "../generateICs/generateICsFactory.h"
+#include "../generateICs/generateICsIn.h"
+#include "../../src/libutil/xmem.h"
+#include "../../src/libutil/timer.h"
+#include "../../src/libutil/diediedie.h"
+
+
+/*--- Implemention of main structure ------------------------------------*/
+#include "ginnungagapICs_adt.h"
+
+
+/*--- Implementations of exported functions -----------------------------*/
+extern ginnungagapICs_t
+ginnungagapICs_newFromIni(parse_ini_t ini, const char *sectionName)
+{
+	ginnungagapICs_t g9pICs;
+
+	assert(ini != NULL);
+
+	g9pICs = xmalloc(sizeof(struct ginnungagapICs_struct));
+
+	// The velocities are handed over in memory, so generateICs needs no
+	// input section and ginnungagap no output section.
+	g9pICs->genics = generateICsFactory_newFromIniWithoutInput(ini,
+	                                                           sectionName);
+	g9pICs->mem    = generateICs_newMem(g9pICs->genics);
+	g9pICs->g9p    = ginnungagap_newWithWriter(ini,
+	                                           generateICsMem_getWriter(
+	                                               g9pICs->mem));
+
+	return g9pICs;
+}
+
+extern void
+ginnungagapICs_run(ginnungagapICs_t g9pICs)
+{
+	double timing;
+
+	assert(g9pICs != NULL);
+	assert(g9pICs->g9p != NULL);
+
+	ginnungagap_init(g9pICs->g9p);
+	ginnungagap_run(g9pICs->g9p);
+	// This releases the FFT grids before the particles are made.
+	ginnungagap_del(&(g9pICs->g9p));
+
+	if (!generateICsMem_isComplete(g9pICs->mem)) {
+		fprintf(stderr, "FATAL:  ginnungagap did not provide all "
+		        "velocity components.\n");
+		diediedie(EXIT_FAILURE);
+	}
+	// The input takes over the reference to the store.
+	generateICs_setIn(g9pICs->genics,
+	                  generateICsIn_newFromMem(g9pICs->mem));
+	g9pICs->mem = NULL;
+
+	timing = timer_start_text("Generating the particles...\n");
+	generateICs_run(g9pICs->genics);
+	timing = timer_stop_text(timing, "Particles done in %.5fs\n");
+}
+
+extern void
+ginnungagapICs_del(ginnungagapICs_t *g9pICs)
+{
+	assert(g9pICs != NULL && *g9pICs != NULL);
+
+	if ((*g9pICs)->g9p != NULL)
+		ginnungagap_del(&((*g9pICs)->g9p));
+	if ((*g9pICs)->mem != NULL)
+		generateICsMem_del(&((*g9pICs)->mem));
+	generateICs_del(&((*g9pICs)->genics));
+
+	xfree(*g9pICs);
+	*g9pICs = NULL;
+}
@@ -0,0 +1,77 @@
+// Copyright (C) 2013, Steffen Knollmann
+// Released under the terms of the GNU General Public License version 3.
+// This file is part of `ginnungagap'.
+
+#ifndef GINNUNGAGAPICS_H
+#define GINNUNGAGAPICS_H
+
+
+/*--- Doxygen file description ------------------------------------------*/
+
+/**
+ * @file ginnungagapICs/ginnungagapICs.h
+ * @ingroup  toolsG9pICs
+ * @brief  Provides the interface to the combined ginnungagap and
+ *         generateICs application.
+ */
+
+
+/*--- Includes ----------------------------------------------------------*/
+#include "../../config.h"
+#include "../../src/libutil/parse_ini.h"
+
+
+/*--- ADT handle --------------------------------------------------------*/
+
+/** @brief  Provides a handle for the ginnungagapICs application. */
+typedef struct ginnungagapICs_struct *ginnungagapICs_t;
+
+
+/*--- Prototypes of exported functions ----------------------------------*/
+
+/**
+ * @brief  Creates a new ginnungagapICs application from an ini file.
+ *
+ * @param[in,out]  ini
+ *                    The ini file holding the setup of ginnungagap (without
+ *                    the @c Output section) and of generateICs (without the
+ *                    input section).  It is only used during the creation.
+ * @param[in]      *sectionName
+ *                    The generateICs section, passing @c NULL uses the
+ *                    default.
+ *
+ * @return  Returns a new application.
+ */
+extern ginnungagapICs_t
+ginnungagapICs_newFromIni(parse_ini_t ini, const char *sectionName);
+
+
+/**
+ * @brief  Executes the application.
+ *
+ * Runs ginnungagap, keeps the velocities in memory and turns them into
+ * particles with generateICs.
+ *
+ * @param[in,out]  g9pICs
+ *                    The application to execute.
+ *
+ * @return  Returns nothing.
+ */
+extern void
+ginnungagapICs_run(ginnungagapICs_t g9pICs);
+
+
+/**
+ * @brief  Deletes a ginnungagapICs application and frees the associated
+ *         memory.
+ *
+ * @param[in,out]  *g9pICs
+ *                    The application to delete, will be set to @c NULL.
+ *
+ * @return  Returns nothing.
+ */
+extern void
+ginnungagapICs_del(ginnungagapICs_t *g9pICs);
+
+
+#endif
@@ -0,0 +1,41 @@
+// Copyright (C) 2013, Steffen Knollmann
+// Released under the terms of the GNU General Public License version 3.
+// This file is part of `ginnungagap'.
+
+#ifndef GINNUNGAGAPICS_ADT_H
+#define GINNUNGAGAPICS_ADT_H
+
+
+/*--- Doxygen file description ------------------------------------------*/
+
+/**
+ * @file ginnungagapICs/ginnungagapICs_adt.h
+ * @ingroup  toolsG9pICs
+ * @brief  Provides the main structure of the ginnungagapICs application.
+ */
+
+
+/*--- Includes ----------------------------------------------------------*/
+#include "../../config.h"
+#include "../../src/ginnungagap/ginnungagap.h"
+#include "../generateICs/generateICs.h"
+#include "../generateICs/generateICsMem.h"
+
+
+/*--- Implemention of main structure ------------------------------------*/
+
+/** @brief  The main structure of the ginnungagapICs application. */
+struct ginnungagapICs_struct {
+	/** @brief  The ginnungagap application, @c NULL once it has run. */
+	ginnungagap_t    g9p;
+	/** @brief  The generateICs application. */
+	generateICs_t    genics;
+	/**
+	 * @brief  The store through which the velocities are handed over,
+	 *         @c NULL once it has been given to generateICs.
+	 */
+	generateICsMem_t mem;
+};
+
+
+#endif
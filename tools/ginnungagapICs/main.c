@@ -0,0 +1,273 @@
+// Copyright (C) 2013, Steffen Knollmann
+// Released under the terms of the GNU General Public License version 3.
+// This file is part of `ginnungagap'.
+
+
+/*--- Doxygen file description ------------------------------------------*/
+
+/**
+ * @file ginnungagapICs/main.c
+ * @ingroup  toolsG9pICs
+ * @brief  Implements the main routine for ginnungagapICs.
+ */
+
+
+/*--- Includes ----------------------------------------------------------*/
+#include "../../config.h"
+#include "../../version.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <errno.h>
+#ifdef WITH_MPI
+#  include <mpi.h>
+#endif
+#if (defined WITH_OPENMP && WITH_FFT_FFTW3)
+#  include <omp.h>
+#  include <fftw3.h>
+#endif
+#include "ginnungagapICs.h"
+#include "../../src/libutil/xmem.h"
+#include "../../src/libutil/cmdline.h"
+#include "../../src/libutil/parse_ini.h"
+
+
+/*--- Local variables ---------------------------------------------------*/
+
+/** @brief  The name of the program. */
+static const char *local_thisProgramName = "ginnungagapICs";
+
+/** @brief  Stores the name of the ini file that shoul be used. */
+static char *local_iniFileName = NULL;
+
+/** @brief  Stores the section name from which to parse generateICs. */
+static char *local_sectionName = NULL;
+
+/** @brief  Stores the position of the various elements in the cmdline. */
+struct local_cmdlinePos {
+	/** @brief  The position for #local_iniFileName. */
+	int iniFileName;
+	/** @brief  The position for the help screen. */
+	int help;
+	/** @brief  The position for the version screen. */
+	int version;
+	/** @brief  The position for #local_sectionName. */
+	int sectionName;
+} local_cmdlinePos;
+
+
+/*--- Prototypes of local functions -------------------------------------*/
+static void
+local_initEnvironment(int *argc, char ***argv);
+
+#if (defined WITH_OPENMP && WITH_FFT_FFTW3)
+static void
+local_setThreadedFFTW(void);
+
+#endif
+
+static void
+local_registerCleanUpFunctions(void);
+
+static cmdline_t
+local_cmdlineSetup(void);
+
+static void
+local_checkForPrematureTermination(cmdline_t cmdline);
+
+static void
+local_finalMessage(void);
+
+static void
+local_verifyCloseOfStdout(void);
+
+
+/*--- M A I N -----------------------------------------------------------*/
+int
+main(int argc, char **argv)
+{
+	parse_ini_t      ini;
+	ginnungagapICs_t g9pICs;
+
+	local_registerCleanUpFunctions();
+	local_initEnvironment(&argc, &argv);
+
+	ini = parse_ini_open(local_iniFileName);
+	if (ini == NULL) {
+		fprintf(stderr, "FATAL:  Could not open %s for reading.\n",
+		        local_iniFileName);
+		exit(EXIT_FAILURE);
+	}
+	g9pICs = ginnungagapICs_newFromIni(ini, local_sectionName);
+	parse_ini_close(&ini);
+
+	ginnungagapICs_run(g9pICs);
+	ginnungagapICs_del(&g9pICs);
+
+#ifdef WITH_MPI
+	// The ranks produce different numbers of files and may finish early.
+	MPI_Finalize();
+#endif
+
+	return EXIT_SUCCESS;
+}
+
+/*--- Implementations of local functions --------------------------------*/
+static void
+local_initEnvironment(int *argc, char ***argv)
+{
+	cmdline_t cmdline;
+
+#if (defined WITH_MPI && defined ENABLE_ASYNC_IO)
+	// As for ginnungagap, the writer may be called from its own thread.
+	int provided;
+	MPI_Init_thread(argc, argv, MPI_THREAD_MULTIPLE, &provided);
+#elif (defined WITH_MPI)
+	MPI_Init(argc, argv);
+#endif
+#if (defined WITH_OPENMP && WITH_FFT_FFTW3)
+	local_setThreadedFFTW();
+#endif
+
+	cmdline = local_cmdlineSetup();
+	cmdline_parse(cmdline, *argc, *argv);
+	local_checkForPrematureTermination(cmdline);
+	cmdline_getArgValueByNum(cmdline, local_cmdlinePos.iniFileName,
+	                         &local_iniFileName);
+	if (cmdline_checkOptSetByNum(cmdline, local_cmdlinePos.sectionName))
+		cmdline_getOptValueByNum(cmdline, local_cmdlinePos.sectionName,
+		                         &local_sectionName);
+	cmdline_del(&cmdline);
+}
+
+#if (defined WITH_OPENMP && WITH_FFT_FFTW3)
+static void
+local_setThreadedFFTW(void)
+{
+	fftw_init_threads();
+	fftw_plan_with_nthreads(omp_get_max_threads());
+	fftwf_init_threads();
+	fftwf_plan_with_nthreads(omp_get_max_threads());
+}
+
+#endif
+
+static void
+local_registerCleanUpFunctions(void)
+{
+	if (atexit(&local_verifyCloseOfStdout) != 0) {
+		fprintf(stderr, "cannot register `%s' as exit function\n",
+		        "local_verifyCloseOfStdout");
+		exit(EXIT_FAILURE);
+	}
+	if (atexit(&local_finalMessage) != 0) {
+		fprintf(stderr, "cannot register `%s' as exit function\n",
+		        "local_finalMessage");
+		exit(EXIT_FAILURE);
+	}
+}
+
+static void
+local_finalMessage(void)
+{
+#if (defined WITH_OPENMP && WITH_FFT_FFTW3)
+	fftw_cleanup_threads();
+	fftwf_cleanup_threads();
+#endif
+	if (local_iniFileName != NULL)
+		xfree(local_iniFileName);
+	if (local_sectionName != NULL)
+		xfree(local_sectionName);
+#ifdef XMEM_TRACK_MEM
+	printf("\n");
+	xmem_info(stdout);
+	printf("\n");
+#endif
+	printf("\nVertu sæl/sæll...\n");
+}
+
+static void
+local_verifyCloseOfStdout(void)
+{
+	if (fclose(stdout) != 0) {
+		int errnum = errno;
+		fprintf(stderr, "%s", strerror(errnum));
+		_Exit(EXIT_FAILURE);
+	}
+}
+
+static cmdline_t
+local_cmdlineSetup(void)
+{
+	cmdline_t cmdline;
+
+	cmdline = cmdline_new(1, 3, local_thisProgramName);
+
+	local_cmdlinePos.version
+	    = cmdline_addOpt(cmdline, "version",
+	                     "This will output a version information.",
+	                     false, CMDLINE_TYPE_NONE);
+	local_cmdlinePos.help
+	    = cmdline_addOpt(cmdline, "help",
+	                     "This will print this help text.",
+	                     false, CMDLINE_TYPE_NONE);
+	local_cmdlinePos.sectionName
+	    = cmdline_addOpt(cmdline, "section",
+	                     "Gives the generateICs section in the ini file.",
+	                     false, CMDLINE_TYPE_STRING);
+	local_cmdlinePos.iniFileName
+	    = cmdline_addArg(cmdline,
+	                     "Gives the name of the configuration file.",
+	                     CMDLINE_TYPE_STRING);
+
+	return cmdline;
+}
+
+static void
+local_checkForPrematureTermination(cmdline_t cmdline)
+{
+	int rank = 0;
+#ifdef WITH_MPI
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+#endif
+	if (cmdline_checkOptSetByNum(cmdline, local_cmdlinePos.version)) {
+		if (rank == 0) {
+			PRINT_VERSION_INFO2(stdout, local_thisProgramName);
+			PRINT_BUILT_INFO(stdout);
+			printf("%s", CONFIG_SUMMARY_STRING);
+		}
+		cmdline_del(&cmdline);
+		exit(EXIT_SUCCESS);
+	}
+	if (cmdline_checkOptSetByNum(cmdline, local_cmdlinePos.help)) {
+		cmdline_printHelp(cmdline, stdout);
+		cmdline_del(&cmdline);
+		exit(EXIT_SUCCESS);
+	}
+	if (!cmdline_verify(cmdline)) {
+		cmdline_printHelp(cmdline, stderr);
+		cmdline_del(&cmdline);
+		exit(EXIT_FAILURE);
+	}
+}
+
+/*--- Doxygen group definitions -----------------------------------------*/
+
+/**
+ * @defgroup toolsG9pICs ginnungagapICs
+ * @ingroup  tools
+ * @brief  Runs ginnungagap and generateICs in one go.
+ *
+ * The velocity fields computed by ginnungagap are kept in memory and
+ * redistributed directly to the ranks that turn them into particles,
+ * instead of being written to files and read back by generateICs.
+ *
+ * @section toolsG9pICsSynopsis Synopsis
+ * <code>ginnungagapICs [--version] [--help] [--section name] arg0</code>
+ *
+ * The argument <code>arg0</code> is an ini file that holds the setup of
+ * ginnungagap (without the @c Output section) and of generateICs (without
+ * the input section).  The zoom level of generateICs must have the
+ * resolution of the grid of ginnungagap.
+ */
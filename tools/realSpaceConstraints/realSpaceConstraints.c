@@ -15,6 +15,7 @@
 /*--- Includes ----------------------------------------------------------*/
 #include "realSpaceConstraintsConfig.h"
 #include "realSpaceConstraints.h"
+#include "realSpaceConstraintsKernel.h"
 #include <stdlib.h>
 #include <assert.h>
 #include <inttypes.h>
@@ -32,6 +33,7 @@
 #include "../../src/libdata/dataVar.h"
 #include "../../src/libutil/xmem.h"
 #include "../../src/libutil/timer.h"
+#include "../../src/libutil/prof.h"
 #include "../../src/libutil/rng.h"
 #include "../../src/libutil/tile.h"
 
@@ -115,11 +117,17 @@ local_getGrid(double         boxsizeInMpch,
  * @param[in]      seed
  *                    The seed for the RNG, only used if @c reader is
  *                    @c NULL.
+ * @param[in]      useBatchedGauss
+ *                    Whether the batched Gaussian sampler should be used,
+ *                    see local_fillPatchWithWhiteNoise().
  *
  * @return  Returns nothing.
  */
 static void
-local_fillInputGrid(gridRegular_t grid, gridReader_t reader, int seed);
+local_fillInputGrid(gridRegular_t grid,
+                    gridReader_t  reader,
+                    int           seed,
+                    bool          useBatchedGauss);
 
 
 /**
@@ -139,13 +147,17 @@ local_fillInputGrid(gridRegular_t grid, gridReader_t reader, int seed);
  * @param[in]      seedOut
  *                    The seed for the output grid.  This is only used, if
  *                    the input grid is smaller than the output grid.
+ * @param[in]      useBatchedGauss
+ *                    Whether the batched Gaussian sampler should be used,
+ *                    see local_fillPatchWithWhiteNoise().
  *
  * @return  Returns nothing.
  */
 static void
 local_fillOutputGrid(gridRegular_t       gridOut,
                      const gridRegular_t gridIn,
-                     int                 seedOut);
+                     int                 seedOut,
+                     bool                useBatchedGauss);
 
 
 /**
@@ -155,109 +167,19 @@ local_fillOutputGrid(gridRegular_t       gridOut,
  *                    The patch to be filled.
  * @param[in]      seed
  *                    The seed that should be used for the RNG.
+ * @param[in]      useBatchedGauss
+ *                    If @c true, the values are drawn with
+ *                    rng_fillGaussUnit(), otherwise one by one with
+ *                    rng_getGaussUnit().  The two give different
+ *                    realisations for the same seed, the latter is the
+ *                    one ginnungagap uses by default.
  *
  * @return  Returns nothing.
  */
 static void
-local_fillPatchWithWhiteNoise(gridPatch_t patch, int seed);
-
-
-/**
- * @brief  Does the heavy lifting for degrading a data cube.
- *
- *
- * General conversion from @f$(i,j,k)@f$ to linear array index (assuming
- * array has the dimensions@f$(d_0, d_1, d_2)@f$):
- * @f[
- *   idx(i, j, k) = i + (j + k d_1) d_0
- * @f]
- *
- * Given two grids g_H and g_L with @f$(d_{H,0}, d_{H,1}, d_{H,2}) =
- * (f_0 d_{L,0}, f_1 d_{L,1}, f_2 d_{L,2})@f$, the position in the H
- * grid can be calculated from the coordinates of the L grid and a
- * position in the subvolume as
- * @f[
- *   i_H = i_L f_0 + i_S \, j_H = j_L f_1 + j_S \, k_H = k_L f_2 + k_S
- * @f]
- * which leads to the expression for the linear index in the H grid as
- * @f[
- *  i_H + (j_H + k_H d_{H,1}) d_{H,0}
- *   = i_L f_0 + (j_L f_1 + k_L f_2 d_{H,1}) d_{H,0}
- *     + i_S + (j_S + k_S d_{H,1}) d_{H,0}
- * @f]
- *
- * @param[out]  *dataOut
- *                 The output data cube.
- * @param[in]   *dataIn
- *                 The input data cube.
- * @param[in]   dimsOut
- *                 The dimensions of the output data cube.
- * @param[in]   dimsIn
- *                 The dimensions of the input data cube.
- *
- * @return  Returns nothing.
- */
-static void
-local_degrade(fpv_t             *dataOut,
-              const fpv_t       *dataIn,
-              gridPointUint32_t dimsOut,
-              gridPointUint32_t dimsIn);
-
-
-/**
- * @brief  Will enforce constraints of a lowRes grid onto a highRes grid.
- *
- * @param[out]  *dataOut
- *                 The output data cube.
- * @param[in]   *dataIn
- *                 The input data cube.
- * @param[in]   dimsOut
- *                 The dimensions of the output data cube.
- * @param[in]   dimsIn
- *                 The dimensions of the input data cube.
- *
- * @return  Returns nothing.
- */
-static void
-local_enforceConstraints(fpv_t             *dataOut,
-                         const fpv_t       *dataIn,
-                         gridPointUint32_t dimsOut,
-                         gridPointUint32_t dimsIn);
-
-
-inline static void
-local_fillCoeff(const fpv_t       *dataIn,
-		const fpv_t       *dataOut,
-		gridPointUint32_t dimsIn,
-		gridPointUint32_t dimsOut,
-		double		*a);
-
-inline static void
-local_refine4(fpv_t       *data,
-		gridPointUint32_t dims,
-		const double		*a);
-
-inline static void
-local_refine3(fpv_t       *data,
-		gridPointUint32_t dims,
-		const double		*a);
-
-/**
- * @brief  This will sum over a subvolume.
- *
- * @param[in]  *data
- *                The data.  Must point to the beginning of the subvolume.
- * @param[in]  dimsIn
- *                The dimension of the input grid.
- * @param[in]  dimsSV
- *                The dimension of the subvolume.
- *
- * @return  Returns the sum of all values in the subvolume.
- */
-inline static long double
-local_sumSV(const fpv_t       *data,
-            gridPointUint32_t dimsIn,
-            gridPointUint32_t dimsSV);
+local_fillPatchWithWhiteNoise(gridPatch_t patch,
+                              int         seed,
+                              bool        useBatchedGauss);
 
 
 /**
@@ -348,13 +270,20 @@ realSpaceConstraints_run(realSpaceConstraints_t te)
 	nProc[1] = 1;
 	nProc[2] = 0;
 
+	if (te->setup->profilePrefix != NULL)
+		prof_enable();
+
 	stat   = gridStatistics_new();
 
 	timing = timer_start_text("  Filling input grid... ");
-	local_fillInputGrid(te->gridIn, te->reader, te->setup->seedIn);
+	prof_start("fillInput");
+	local_fillInputGrid(te->gridIn, te->reader, te->setup->seedIn,
+	                    te->setup->useBatchedGauss);
+	prof_stop("fillInput");
 	timing = timer_stop_text(timing, "took %.5fs\n");
 
 	timing = timer_start_text("  Calculating statistics on input grid... ");
+	prof_start("statistics");
 #ifdef WITH_MPI	
 	distrib = gridRegularDistrib_new(te->gridIn, NULL);
 	gridRegularDistrib_initMPI(distrib, nProc, MPI_COMM_WORLD);
@@ -362,6 +291,7 @@ realSpaceConstraints_run(realSpaceConstraints_t te)
 #else
 	gridStatistics_calcGridRegular(stat, te->gridIn, 0);
 #endif
+	prof_stop("statistics");
 	timing = timer_stop_text(timing, "took %.5fs\n");
 	if (rank == 0)
 		gridStatistics_printPretty(stat, stdout, "  ");
@@ -375,10 +305,14 @@ realSpaceConstraints_run(realSpaceConstraints_t te)
 	}
 
 	timing = timer_start_text("  Filling output grid... ");
-	local_fillOutputGrid(te->gridOut, te->gridIn, te->setup->seedOut);
+	prof_start("fillOutput");
+	local_fillOutputGrid(te->gridOut, te->gridIn, te->setup->seedOut,
+	                     te->setup->useBatchedGauss);
+	prof_stop("fillOutput");
 	timing = timer_stop_text(timing, "took %.5fs\n");
 
 	timing = timer_start_text("  Calculating statistics on output grid... ");
+	prof_start("statistics");
 #ifdef WITH_MPI 
         distrib = gridRegularDistrib_new(te->gridOut, NULL);
         gridRegularDistrib_initMPI(distrib, nProc, MPI_COMM_WORLD);
@@ -386,6 +320,7 @@ realSpaceConstraints_run(realSpaceConstraints_t te)
 #else
 	gridStatistics_calcGridRegular(stat, te->gridOut, 0);
 #endif
+	prof_stop("statistics");
 	timing = timer_stop_text(timing, "took %.5fs\n");
 	if (rank == 0)
 		gridStatistics_printPretty(stat, stdout, "  ");
@@ -397,8 +332,47 @@ realSpaceConstraints_run(realSpaceConstraints_t te)
 	timing = timer_stop_text(timing, "took %.5fs\n");
 
 	gridStatistics_del(&stat);
+
+	if (te->setup->profilePrefix != NULL) {
+		prof_report(te->setup->profilePrefix);
+		prof_reset();
+	}
 } /* realSpaceConstraints_run */
 
+extern gridReader_t
+realSpaceConstraints_getReader(const realSpaceConstraints_t te)
+{
+	assert(te != NULL);
+
+	return te->reader;
+}
+
+extern void
+realSpaceConstraints_setReader(realSpaceConstraints_t te, gridReader_t reader)
+{
+	assert(te != NULL);
+	assert(reader != NULL);
+
+	te->reader = reader;
+}
+
+extern gridWriter_t
+realSpaceConstraints_getWriter(const realSpaceConstraints_t te)
+{
+	assert(te != NULL);
+
+	return te->writer;
+}
+
+extern void
+realSpaceConstraints_setWriter(realSpaceConstraints_t te, gridWriter_t writer)
+{
+	assert(te != NULL);
+	assert(writer != NULL);
+
+	te->writer = writer;
+}
+
 extern void
 realSpaceConstraints_del(realSpaceConstraints_t *te)
 {
@@ -505,14 +479,17 @@ local_getGrid(double         boxsizeInMpch,
 }
 
 static void
-local_fillInputGrid(gridRegular_t grid, gridReader_t reader, int seed)
+local_fillInputGrid(gridRegular_t grid,
+                    gridReader_t  reader,
+                    int           seed,
+                    bool          useBatchedGauss)
 {
 	gridPatch_t patch;
 
 	patch = gridRegular_getPatchHandle(grid, 0);
 
 	if (reader == NULL) {
-		local_fillPatchWithWhiteNoise(patch, seed);
+		local_fillPatchWithWhiteNoise(patch, seed, useBatchedGauss);
 	} else {
 		gridReader_readIntoPatchForVar(reader, patch, 0);
 	}
@@ -521,7 +498,8 @@ local_fillInputGrid(gridRegular_t grid, gridReader_t reader, int seed)
 static void
 local_fillOutputGrid(gridRegular_t       gridOut,
                      const gridRegular_t gridIn,
-                     int                 seedOut)
+                     int                 seedOut,
+                     bool                useBatchedGauss)
 {
 	gridPatch_t       patchIn, patchOut;
 	fpv_t             *dataIn, *dataOut;
@@ -538,18 +516,21 @@ local_fillOutputGrid(gridRegular_t       gridOut,
 
 	if ((dimsIn[0] < dimsOut[0]) && (dimsIn[1] < dimsOut[1])
 	    && (dimsIn[2] < dimsOut[2])) {
-		local_fillPatchWithWhiteNoise(patchOut, seedOut);
-		local_enforceConstraints(dataOut, dataIn, dimsOut, dimsIn);
+		local_fillPatchWithWhiteNoise(patchOut, seedOut, useBatchedGauss);
+		realSpaceConstraintsKernel_enforceConstraints(dataOut, dataIn, dimsOut,
+		                                              dimsIn);
 	} else if ((dimsIn[0] > dimsOut[0]) && (dimsIn[1] > dimsOut[1])
 	           && (dimsIn[2] > dimsOut[2])) {
-		local_degrade(dataOut, dataIn, dimsOut, dimsIn);
+		realSpaceConstraintsKernel_degrade(dataOut, dataIn, dimsOut, dimsIn);
 	} else {
 		fprintf(stdout, "doing nothing");
 	}
 }
 
 static void
-local_fillPatchWithWhiteNoise(gridPatch_t patch, int seed)
+local_fillPatchWithWhiteNoise(gridPatch_t patch,
+                              int         seed,
+                              bool        useBatchedGauss)
 {
 	fpv_t    *data;
 	uint64_t numCells;
@@ -579,194 +560,18 @@ local_fillPatchWithWhiteNoise(gridPatch_t patch, int seed)
 		uint64_t start = i * cps;
 		uint64_t stop  = (i == numStreams - 1) ? numCells : (start
 		                                                     + cps);
-		for (uint64_t j = start; j < stop; j++) {
-			assert(j < numCells);
-			data[j] = (fpv_t)rng_getGaussUnit(rng, i);
+		assert(stop <= numCells);
+		if (useBatchedGauss) {
+			rng_fillGaussUnit(rng, i, data + start, stop - start);
+		} else {
+			for (uint64_t j = start; j < stop; j++)
+				data[j] = (fpv_t)rng_getGaussUnit(rng, i);
 		}
 	}
 
 	rng_del(&rng);
 }
 
-static void
-local_degrade(fpv_t             *dataOut,
-              const fpv_t       *dataIn,
-              gridPointUint32_t dimsOut,
-              gridPointUint32_t dimsIn)
-{
-	gridPointUint32_t dimsSV;
-	double            numCellsSVInv      = 1.;
-	double            varianceAdjustment = 1;
-	//TODO rewrite degrading using Jetkins algorithm
-
-	for (int i = 0; i < NDIM; i++) {
-		assert(dimsIn[i] % dimsOut[i] == 0);
-		dimsSV[i]           = dimsIn[i] / dimsOut[i];
-		numCellsSVInv      /= (double)(dimsSV[i]);
-		varianceAdjustment *= dimsIn[i] / ((double)(dimsOut[i]));
-	}
-	varianceAdjustment = sqrt(varianceAdjustment);
-
-#if (NDIM > 2)
-#  ifdef WITH_OPENMP
-#    pragma omp parallel for
-#  endif
-	for (uint64_t k = 0; k < dimsOut[2]; k++)
-#endif
-	{
-		for (uint64_t j = 0; j < dimsOut[1]; j++) {
-			for (uint64_t i = 0; i < dimsOut[0]; i++) {
-				long double sum;
-				uint64_t    idxOut = i + (j + k * dimsOut[1]) * dimsOut[0];
-				uint64_t    idxIn  = i * dimsSV[0]
-				                     + (j * dimsSV[1]
-				                        + k * dimsSV[2]
-				                        * dimsIn[1]) * dimsIn[0];
-				sum = local_sumSV(dataIn + idxIn,
-				                  dimsIn,
-				                  dimsSV);
-				dataOut[idxOut] = (fpv_t)(sum * numCellsSVInv
-				                          * varianceAdjustment);
-			}
-		}
-	}
-} /* local_degrade */
-
-static void
-local_enforceConstraints(fpv_t             *dataOut,
-                         const fpv_t       *dataIn,
-                         gridPointUint32_t dimsOut,
-                         gridPointUint32_t dimsIn)
-{
-
-	for (int i = 0; i < NDIM; i++) {
-		assert(dimsOut[i] % dimsIn[i] == 0 || (dimsOut[i]*2) == (dimsIn[i]*3));
-	}
-
-	int ncoef = 4;
-	if ((dimsOut[0]*2) == (dimsIn[0]*3)) ncoef = 3;
-
-#if (NDIM > 2)
-#  ifdef WITH_OPENMP
-#    pragma omp parallel for
-#  endif
-	for (uint64_t k = 0; k < dimsIn[2]; k+=2)
-#endif
-	{
-		for (uint64_t j = 0; j < dimsIn[1]; j+=2) {
-			for (uint64_t i = 0; i < dimsIn[0]; i+=2) {
-				uint64_t    idxIn  = i + (j + k * dimsIn[1]) * dimsIn[0];
-				uint64_t    idxOut = i * dimsOut[0] / dimsIn[0]
-				                     + (j * dimsOut[1] / dimsIn[1]
-				                        + k * dimsOut[2] / dimsIn[2]
-				                        * dimsOut[1]) * dimsOut[0];
-				double			  a[64], b[27]; // expansion coefficients
-
-
-
-				if(ncoef == 4){
-					local_fillCoeff(dataIn+idxIn,dataOut+idxOut,dimsIn,dimsOut,a);
-					local_refine4(dataOut+idxOut,dimsOut,a);
-				}
-				else {
-					local_fillCoeff(dataIn+idxIn,dataOut+idxOut,dimsIn,dimsOut,b);
-					local_refine3(dataOut+idxOut,dimsOut,b);
-				}
-
-
-			}
-		}
-	}
-} /* local_enforceConstraints */
-
-inline static void
-local_fillCoeff(const fpv_t       *dataIn,
-		const fpv_t       *dataOut,
-		gridPointUint32_t dimsIn,
-		gridPointUint32_t dimsOut,
-		double		*a)
-{
-	int i,j,k,ii,jj,kk;
-	int len = 4;
-	if ((dimsOut[0]*2) == (dimsIn[0]*3)) len = 3;
-
-	const double mat[8][8] = {{1.0,1.0,1.0,1.0,1.0,1.0,1.0,1.0},{-1.0,1.0,-1.0,1.0,-1.0,1.0,-1.0,1.0},{-1.0,-1.0,1.0,1.0,-1.0,-1.0,1.0,1.0},{1.0,-1.0,-1.0,1.0,1.0,-1.0,-1.0,1.0},{-1.0,-1.0,-1.0,-1.0,1.0,1.0,1.0,1.0},{1.0,-1.0,1.0,-1.0,-1.0,1.0,-1.0,1.0},{1.0,1.0,-1.0,-1.0,-1.0,-1.0,1.0,1.0},{-1.0,1.0,1.0,-1.0,1.0,-1.0,-1.0,1.0}};
-	// initially fill a[][][] with random numbers from dataOut:
-	for (k=0; k<len; k++)
-		for (j=0; j<len; j++)
-			for (i=0; i<len; i++) {
-				a[i+(j+k*len)*len] = dataOut[i + (j + k * dimsOut[1]) * dimsOut[0]];
-			}
-	// put constraints on a[0..1][0..1][0..1]:
-	for (k=0; k<2; k++)
-		for (j=0; j<2; j++)
-			for (i=0; i<2; i++) {
-				a[i+(j+k*len)*len] = 0;
-				for (kk=0; kk<2; kk++)
-					for (jj=0; jj<2; jj++)
-						for (ii=0; ii<2; ii++)
-							a[i+(j+k*len)*len] += dataIn[ii+(jj+kk*dimsIn[1])*dimsIn[0]] * mat[2*(2*k+j)+i][2*(2*kk+jj)+ii]/sqrt(8.0);
-			}
-}
-
-inline static void
-local_refine4(fpv_t       *data,
-		gridPointUint32_t dims,
-		const double		*a)
-{
-	int i,j,k,ii,jj,kk;
-	double e[4][4]={{0.5,-0.661437827766,-0.5,0.25},{0.5,-0.25,0.5,-0.661437827766},{0.5,0.25,0.5,0.661437827766},{0.5,0.661437827766,-0.5,-0.25}};
-	for (k=0; k<4; k++)
-			for (j=0; j<4; j++)
-				for (i=0; i<4; i++) {
-					data[i+(j+k*dims[1])*dims[0]] = 0;
-					for (kk=0; kk<4; kk++)
-						for (jj=0; jj<4; jj++)
-							for (ii=0; ii<4; ii++)
-								data[i+(j+k*dims[1])*dims[0]] += a[ii+(jj+kk*4)*4] * e[k][kk] * e[j][jj] * e[i][ii];
-				}
-}
-
-inline static void
-local_refine3(fpv_t       *data,
-		gridPointUint32_t dims,
-		const double		*a)
-{
-	int i,j,k,ii,jj,kk;
-	double e[3][3]={{0.57735026918962584,-0.70710678118654746,-0.40824829046386307},{0.57735026918962584,0.0,0.81649658092772615},{0.57735026918962584,0.70710678118654746,-0.40824829046386307}};
-	for (k=0; k<3; k++)
-			for (j=0; j<3; j++)
-				for (i=0; i<3; i++) {
-					data[i+(j+k*dims[1])*dims[0]] = 0;
-					for (kk=0; kk<3; kk++)
-						for (jj=0; jj<3; jj++)
-							for (ii=0; ii<3; ii++)
-								data[i+(j+k*dims[1])*dims[0]] += a[ii+(jj+kk*3)*3] * e[k][kk] * e[j][jj] * e[i][ii];
-				}
-}
-
-inline static long double
-local_sumSV(const fpv_t       *data,
-            gridPointUint32_t dimsIn,
-            gridPointUint32_t dimsSV)
-{
-	long double sum = 0.0L;
-
-#if (NDIM > 2)
-	for (uint64_t k = 0; k < dimsSV[2]; k++)
-#endif
-	{
-		for (uint64_t j = 0; j < dimsSV[1]; j++) {
-			for (uint64_t i = 0; i < dimsSV[0]; i++) {
-				sum += data[i + (j + k * dimsIn[1]) * dimsIn[0]];
-			}
-		}
-	}
-
-
-	return sum;
-}
-
 inline static void
 local_addToSV(fpv_t             *data,
               gridPointUint32_t dimsIn,
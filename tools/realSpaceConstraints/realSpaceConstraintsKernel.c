@@ -0,0 +1,439 @@
+// Copyright (C) 2011, Steffen Knollmann
+// Released under the terms of the GNU General Public License version 3.
+// This file is part of `ginnungagap'.
+
+
+/*--- Doxygen file description ------------------------------------------*/
+
+/**
+ * @file realSpaceConstraints/realSpaceConstraintsKernel.c
+ * @ingroup  toolsRealSpaceConstraintsKernel
+ * @brief  Provides the implementation of the numerical kernels of the
+ *         realSpaceConstraints tool.
+ */
+
+
+/*--- Includes ----------------------------------------------------------*/
+#include "realSpaceConstraintsConfig.h"
+#include "realSpaceConstraintsKernel.h"
+#include <assert.h>
+#include <math.h>
+#ifdef WITH_OPENMP
+#  include <omp.h>
+#endif
+#include "../../src/libutil/xmem.h"
+
+
+/*--- Prototypes of local functions -------------------------------------*/
+
+/**
+ * @brief  Fills the expansion coefficients for one constraint block.
+ *
+ * All @c len^3 coefficients are first initialised from the (random)
+ * values of the output block, then the lowest @c 2^3 coefficients are
+ * replaced by the Haar transform of the @c 2x2x2 input block.  As the
+ * Haar basis is a tensor product, this is done as three 1D passes.
+ *
+ * @param[in]   *dataIn
+ *                 The input data, must point to the beginning of the
+ *                 @c 2x2x2 input block.
+ * @param[in]   *dataOut
+ *                 The output data, must point to the beginning of the
+ *                 output block.
+ * @param[in]   dimsIn
+ *                 The dimensions of the input data cube.
+ * @param[in]   dimsOut
+ *                 The dimensions of the output data cube.
+ * @param[out]  *a
+ *                 The coefficient array, must be able to hold @c len^3
+ *                 values, where @c len is @c 3 or @c 4 depending on the
+ *                 refinement factor.
+ *
+ * @return  Returns nothing.
+ */
+inline static void
+local_fillCoeff(const fpv_t       *dataIn,
+                const fpv_t       *dataOut,
+                gridPointUint32_t dimsIn,
+                gridPointUint32_t dimsOut,
+                double            *a);
+
+
+/**
+ * @brief  Synthesises a @c 4x4x4 output block from its coefficients.
+ *
+ * @param[out]  *data
+ *                 The output data, must point to the beginning of the
+ *                 output block.
+ * @param[in]   dims
+ *                 The dimensions of the output data cube.
+ * @param[in]   *a
+ *                 The @c 64 expansion coefficients.
+ *
+ * @return  Returns nothing.
+ */
+inline static void
+local_refine4(fpv_t             *data,
+              gridPointUint32_t dims,
+              const double      *a);
+
+
+/**
+ * @brief  Synthesises a @c 3x3x3 output block from its coefficients.
+ *
+ * @param[out]  *data
+ *                 The output data, must point to the beginning of the
+ *                 output block.
+ * @param[in]   dims
+ *                 The dimensions of the output data cube.
+ * @param[in]   *a
+ *                 The @c 27 expansion coefficients.
+ *
+ * @return  Returns nothing.
+ */
+inline static void
+local_refine3(fpv_t             *data,
+              gridPointUint32_t dims,
+              const double      *a);
+
+
+/**
+ * @brief  Applies a separable 3D basis transform to a cube of
+ *         coefficients.
+ *
+ * The output is
+ * @f[
+ *   d_{ijk} = \sum_{i'j'k'} e_{kk'} e_{jj'} e_{ii'} a_{i'j'k'}
+ * @f]
+ * which is evaluated as three successive 1D transforms, requiring
+ * @f$3 n^4@f$ instead of @f$n^6@f$ multiply-adds.
+ *
+ * @param[out]  *data
+ *                 The output data, must point to the beginning of the
+ *                 output block.
+ * @param[in]   dims
+ *                 The dimensions of the output data cube.
+ * @param[in]   *a
+ *                 The @c n^3 expansion coefficients.
+ * @param[in]   *e
+ *                 The @c n x @c n basis matrix, stored row-major.
+ * @param[in]   n
+ *                 The number of cells per dimension of the block.
+ *
+ * @return  Returns nothing.
+ */
+inline static void
+local_refineSeparable(fpv_t *restrict        data,
+                      gridPointUint32_t      dims,
+                      const double *restrict a,
+                      const double *restrict e,
+                      const int              n);
+
+
+/**
+ * @brief  Adds one row of the fine grid to a row of coarse cell sums.
+ *
+ * Each group of @c factor consecutive fine cells is summed in double
+ * precision and the result is added to the corresponding coarse cell
+ * using Kahan summation.
+ *
+ * @param[in,out]  *sum
+ *                    The running sums of the coarse cells, must hold
+ *                    @c numCoarse values.
+ * @param[in,out]  *comp
+ *                    The running Kahan compensations of the coarse
+ *                    cells, must hold @c numCoarse values.
+ * @param[in]      *row
+ *                    The fine row, must hold @c numCoarse * @c factor
+ *                    values.
+ * @param[in]      numCoarse
+ *                    The number of coarse cells in the row.
+ * @param[in]      factor
+ *                    The number of fine cells per coarse cell.
+ *
+ * @return  Returns nothing.
+ */
+inline static void
+local_addRowCompensated(double *restrict      sum,
+                        double *restrict      comp,
+                        const fpv_t *restrict row,
+                        uint32_t              numCoarse,
+                        uint32_t              factor);
+
+
+/*--- Implementations of exported functions -----------------------------*/
+extern void
+realSpaceConstraintsKernel_enforceConstraints(fpv_t             *dataOut,
+                                              const fpv_t       *dataIn,
+                                              gridPointUint32_t dimsOut,
+                                              gridPointUint32_t dimsIn)
+{
+
+	for (int i = 0; i < NDIM; i++) {
+		assert(dimsOut[i] % dimsIn[i] == 0 || (dimsOut[i]*2) == (dimsIn[i]*3));
+	}
+
+	int ncoef = 4;
+	if ((dimsOut[0]*2) == (dimsIn[0]*3)) ncoef = 3;
+
+#if (NDIM > 2)
+#  ifdef WITH_OPENMP
+#    pragma omp parallel for
+#  endif
+	for (uint64_t k = 0; k < dimsIn[2]; k+=2)
+#endif
+	{
+		for (uint64_t j = 0; j < dimsIn[1]; j+=2) {
+			for (uint64_t i = 0; i < dimsIn[0]; i+=2) {
+				uint64_t    idxIn  = i + (j + k * dimsIn[1]) * dimsIn[0];
+				uint64_t    idxOut = i * dimsOut[0] / dimsIn[0]
+				                     + (j * dimsOut[1] / dimsIn[1]
+				                        + k * dimsOut[2] / dimsIn[2]
+				                        * dimsOut[1]) * dimsOut[0];
+				double			  a[64], b[27]; // expansion coefficients
+
+
+
+				if(ncoef == 4){
+					local_fillCoeff(dataIn+idxIn,dataOut+idxOut,dimsIn,dimsOut,a);
+					local_refine4(dataOut+idxOut,dimsOut,a);
+				}
+				else {
+					local_fillCoeff(dataIn+idxIn,dataOut+idxOut,dimsIn,dimsOut,b);
+					local_refine3(dataOut+idxOut,dimsOut,b);
+				}
+
+
+			}
+		}
+	}
+} /* realSpaceConstraintsKernel_enforceConstraints */
+
+extern void
+realSpaceConstraintsKernel_degrade(fpv_t             *dataOut,
+                                   const fpv_t       *dataIn,
+                                   gridPointUint32_t dimsOut,
+                                   gridPointUint32_t dimsIn)
+{
+	gridPointUint32_t dimsSV;
+	double            numCellsSVInv      = 1.;
+	double            varianceAdjustment = 1;
+	uint64_t          numRowsOut         = 1;
+	int               numThreads         = 1;
+	double            *buffer;
+
+	for (int i = 0; i < NDIM; i++) {
+		assert(dimsIn[i] % dimsOut[i] == 0);
+		dimsSV[i]           = dimsIn[i] / dimsOut[i];
+		numCellsSVInv      /= (double)(dimsSV[i]);
+		varianceAdjustment *= dimsIn[i] / ((double)(dimsOut[i]));
+	}
+	varianceAdjustment = sqrt(varianceAdjustment);
+	for (int i = 1; i < NDIM; i++)
+		numRowsOut *= dimsOut[i];
+#ifdef WITH_OPENMP
+	numThreads = omp_get_max_threads();
+#endif
+	// Every thread needs the sums and compensations of one coarse row.
+	buffer = xmalloc(sizeof(double) * 2 * dimsOut[0] * numThreads);
+
+#ifdef WITH_OPENMP
+#  pragma omp parallel shared(buffer)
+#endif
+	{
+		int    tid = 0;
+#ifdef WITH_OPENMP
+		tid = omp_get_thread_num();
+#endif
+		double *sum  = buffer + (uint64_t)2 * dimsOut[0] * tid;
+		double *comp = sum + dimsOut[0];
+
+		// The y and z loops over the coarse grid are collapsed into one
+		// loop over coarse rows to have enough work for all threads even
+		// if the patch holds only a few z-planes.
+#ifdef WITH_OPENMP
+#  pragma omp for schedule(static)
+#endif
+		for (uint64_t r = 0; r < numRowsOut; r++) {
+			uint64_t j = r % dimsOut[1];
+			uint64_t k = r / dimsOut[1];
+
+			for (uint32_t i = 0; i < dimsOut[0]; i++) {
+				sum[i]  = 0.0;
+				comp[i] = 0.0;
+			}
+
+#if (NDIM > 2)
+			for (uint64_t kS = 0; kS < dimsSV[2]; kS++)
+#endif
+			{
+				for (uint64_t jS = 0; jS < dimsSV[1]; jS++) {
+					uint64_t idxIn = (j * dimsSV[1] + jS
+					                  + (k * dimsSV[2] + kS)
+					                  * dimsIn[1]) * dimsIn[0];
+					local_addRowCompensated(sum, comp, dataIn + idxIn,
+					                        dimsOut[0], dimsSV[0]);
+				}
+			}
+
+			fpv_t *rowOut = dataOut + r * dimsOut[0];
+			for (uint32_t i = 0; i < dimsOut[0]; i++)
+				rowOut[i] = (fpv_t)(sum[i] * numCellsSVInv
+				                    * varianceAdjustment);
+		}
+	}
+
+	xfree(buffer);
+} /* realSpaceConstraintsKernel_degrade */
+
+/*--- Implementations of local functions --------------------------------*/
+inline static void
+local_fillCoeff(const fpv_t       *dataIn,
+                const fpv_t       *dataOut,
+                gridPointUint32_t dimsIn,
+                gridPointUint32_t dimsOut,
+                double            *a)
+{
+	int    len = 4;
+	double t[8];
+
+	if ((dimsOut[0] * 2) == (dimsIn[0] * 3))
+		len = 3;
+
+	// initially fill a[][][] with random numbers from dataOut:
+	for (int k = 0; k < len; k++)
+		for (int j = 0; j < len; j++)
+			for (int i = 0; i < len; i++)
+				a[i + (j + k * len) * len]
+				    = dataOut[i + (j + k * dimsOut[1]) * dimsOut[0]];
+
+	// Haar transform of the 2x2x2 input block, one dimension at a time
+	// with h = {{1, 1}, {-1, 1}}:
+	for (int k = 0; k < 2; k++) {
+		for (int j = 0; j < 2; j++) {
+			const fpv_t *row = dataIn + (j + k * dimsIn[1]) * dimsIn[0];
+			t[0 + (j + k * 2) * 2] = (double)row[0] + (double)row[1];
+			t[1 + (j + k * 2) * 2] = (double)row[1] - (double)row[0];
+		}
+	}
+	for (int k = 0; k < 2; k++) {
+		for (int i = 0; i < 2; i++) {
+			double lo = t[i + (0 + k * 2) * 2];
+			double hi = t[i + (1 + k * 2) * 2];
+			t[i + (0 + k * 2) * 2] = lo + hi;
+			t[i + (1 + k * 2) * 2] = hi - lo;
+		}
+	}
+	// put constraints on a[0..1][0..1][0..1]:
+	for (int j = 0; j < 2; j++) {
+		for (int i = 0; i < 2; i++) {
+			double lo = t[i + (j + 0 * 2) * 2];
+			double hi = t[i + (j + 1 * 2) * 2];
+			a[i + (j + 0 * len) * len] = (lo + hi) / sqrt(8.0);
+			a[i + (j + 1 * len) * len] = (hi - lo) / sqrt(8.0);
+		}
+	}
+}
+
+inline static void
+local_refine4(fpv_t             *data,
+              gridPointUint32_t dims,
+              const double      *a)
+{
+	const double e[4 * 4] = {
+		0.5, -0.661437827766, -0.5, 0.25,
+		0.5, -0.25,           0.5,  -0.661437827766,
+		0.5, 0.25,            0.5,  0.661437827766,
+		0.5, 0.661437827766,  -0.5, -0.25
+	};
+
+	local_refineSeparable(data, dims, a, e, 4);
+}
+
+inline static void
+local_refine3(fpv_t             *data,
+              gridPointUint32_t dims,
+              const double      *a)
+{
+	const double e[3 * 3] = {
+		0.57735026918962584, -0.70710678118654746, -0.40824829046386307,
+		0.57735026918962584, 0.0,                  0.81649658092772615,
+		0.57735026918962584, 0.70710678118654746,  -0.40824829046386307
+	};
+
+	local_refineSeparable(data, dims, a, e, 3);
+}
+
+inline static void
+local_refineSeparable(fpv_t *restrict        data,
+                      gridPointUint32_t      dims,
+                      const double *restrict a,
+                      const double *restrict e,
+                      const int              n)
+{
+	double t1[64], t2[64];
+
+	assert(n <= 4);
+
+	// x-pass: t1[i][jj][kk] = sum_ii e[i][ii] a[ii][jj][kk]
+	for (int l = 0; l < n * n; l++) {
+		for (int i = 0; i < n; i++) {
+			double sum = 0.0;
+			for (int ii = 0; ii < n; ii++)
+				sum += e[i * n + ii] * a[ii + l * n];
+			t1[i + l * n] = sum;
+		}
+	}
+
+	// y-pass: t2[i][j][kk] = sum_jj e[j][jj] t1[i][jj][kk]
+	for (int kk = 0; kk < n; kk++) {
+		for (int j = 0; j < n; j++) {
+			double *restrict out = t2 + (j + kk * n) * n;
+			for (int i = 0; i < n; i++)
+				out[i] = 0.0;
+			for (int jj = 0; jj < n; jj++) {
+				const double *restrict in = t1 + (jj + kk * n) * n;
+				const double           f  = e[j * n + jj];
+				for (int i = 0; i < n; i++)
+					out[i] += f * in[i];
+			}
+		}
+	}
+
+	// z-pass: data[i][j][k] = sum_kk e[k][kk] t2[i][j][kk]
+	for (int k = 0; k < n; k++) {
+		for (int j = 0; j < n; j++) {
+			double row[4] = { 0.0, 0.0, 0.0, 0.0 };
+			for (int kk = 0; kk < n; kk++) {
+				const double *restrict in = t2 + (j + kk * n) * n;
+				const double           f  = e[k * n + kk];
+				for (int i = 0; i < n; i++)
+					row[i] += f * in[i];
+			}
+			for (int i = 0; i < n; i++)
+				data[i + (j + k * dims[1]) * dims[0]] = (fpv_t)row[i];
+		}
+	}
+}
+
+inline static void
+local_addRowCompensated(double *restrict      sum,
+                        double *restrict      comp,
+                        const fpv_t *restrict row,
+                        uint32_t              numCoarse,
+                        uint32_t              factor)
+{
+	for (uint32_t i = 0; i < numCoarse; i++) {
+		const fpv_t *cells = row + (uint64_t)i * factor;
+		double      part   = 0.0;
+		double      y, t;
+
+		for (uint32_t ii = 0; ii < factor; ii++)
+			part += cells[ii];
+
+		y       = part - comp[i];
+		t       = sum[i] + y;
+		comp[i] = (t - sum[i]) - y;
+		sum[i]  = t;
+	}
+}
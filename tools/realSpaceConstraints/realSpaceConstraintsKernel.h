@@ -0,0 +1,111 @@
+// Copyright (C) 2011, Steffen Knollmann
+// Released under the terms of the GNU General Public License version 3.
+// This file is part of `ginnungagap'.
+
+#ifndef REALSPACECONSTRAINTSKERNEL_H
+#define REALSPACECONSTRAINTSKERNEL_H
+
+
+/*--- Doxygen file description ------------------------------------------*/
+
+/**
+ * @file realSpaceConstraints/realSpaceConstraintsKernel.h
+ * @ingroup  toolsRealSpaceConstraintsKernel
+ * @brief  Provides the interface to the numerical kernels of the
+ *         realSpaceConstraints tool.
+ */
+
+
+/*--- Includes ----------------------------------------------------------*/
+#include "realSpaceConstraintsConfig.h"
+#include <stdint.h>
+#include "../../src/libgrid/gridPoint.h"
+
+
+/*--- Prototypes of exported functions ----------------------------------*/
+
+/**
+ * @brief  Will enforce constraints of a lowRes grid onto a highRes grid.
+ *
+ * Every @c 2x2x2 block of the input is expanded in the constraint basis
+ * together with the (random) values of the corresponding @c 4x4x4 (or
+ * @c 3x3x3 for a refinement by 1.5) output block, the output block is then
+ * replaced by the synthesis of the constrained coefficients.
+ *
+ * @param[in,out]  *dataOut
+ *                    The output data cube, holding the white noise that
+ *                    is to be constrained.
+ * @param[in]      *dataIn
+ *                    The input data cube.
+ * @param[in]      dimsOut
+ *                    The dimensions of the output data cube.
+ * @param[in]      dimsIn
+ *                    The dimensions of the input data cube, the output
+ *                    must be twice (or 1.5 times) as large.
+ *
+ * @return  Returns nothing.
+ */
+extern void
+realSpaceConstraintsKernel_enforceConstraints(fpv_t             *dataOut,
+                                              const fpv_t       *dataIn,
+                                              gridPointUint32_t dimsOut,
+                                              gridPointUint32_t dimsIn);
+
+
+/**
+ * @brief  Degrades a data cube by averaging over subvolumes.
+ *
+ * The averages are scaled by the square root of the number of cells per
+ * subvolume to keep the variance of white noise unchanged.
+ *
+ * General conversion from @f$(i,j,k)@f$ to linear array index (assuming
+ * array has the dimensions@f$(d_0, d_1, d_2)@f$):
+ * @f[
+ *   idx(i, j, k) = i + (j + k d_1) d_0
+ * @f]
+ *
+ * Given two grids g_H and g_L with @f$(d_{H,0}, d_{H,1}, d_{H,2}) =
+ * (f_0 d_{L,0}, f_1 d_{L,1}, f_2 d_{L,2})@f$, the position in the H
+ * grid can be calculated from the coordinates of the L grid and a
+ * position in the subvolume as
+ * @f[
+ *   i_H = i_L f_0 + i_S \, j_H = j_L f_1 + j_S \, k_H = k_L f_2 + k_S
+ * @f]
+ * which leads to the expression for the linear index in the H grid as
+ * @f[
+ *  i_H + (j_H + k_H d_{H,1}) d_{H,0}
+ *   = i_L f_0 + (j_L f_1 + k_L f_2 d_{H,1}) d_{H,0}
+ *     + i_S + (j_S + k_S d_{H,1}) d_{H,0}
+ * @f]
+ *
+ * @param[out]  *dataOut
+ *                 The output data cube.
+ * @param[in]   *dataIn
+ *                 The input data cube.
+ * @param[in]   dimsOut
+ *                 The dimensions of the output data cube.
+ * @param[in]   dimsIn
+ *                 The dimensions of the input data cube.
+ *
+ * @return  Returns nothing.
+ */
+extern void
+realSpaceConstraintsKernel_degrade(fpv_t             *dataOut,
+                                   const fpv_t       *dataIn,
+                                   gridPointUint32_t dimsOut,
+                                   gridPointUint32_t dimsIn);
+
+
+/*--- Doxygen group definitions -----------------------------------------*/
+
+/**
+ * @defgroup toolsRealSpaceConstraintsKernel Kernels
+ * @ingroup  toolsRealSpaceConstraints
+ * @brief  Provides the refinement and degrading of the noise blocks.
+ *
+ * The kernels work on plain data cubes and are kept separate from the
+ * grid handling so that they can be tested on their own.
+ */
+
+
+#endif
@@ -0,0 +1,330 @@
+// Copyright (C) 2011, Steffen Knollmann
+// Released under the terms of the GNU General Public License version 3.
+// This file is part of `ginnungagap'.
+
+
+/*--- Doxygen file description ------------------------------------------*/
+
+/**
+ * @file realSpaceConstraints/realSpaceConstraintsKernel_tests.c
+ * @ingroup  toolsRealSpaceConstraintsKernelTests
+ * @brief  Implements the tests of the kernels.
+ */
+
+
+/*--- Includes ----------------------------------------------------------*/
+#include "realSpaceConstraintsConfig.h"
+#include "realSpaceConstraintsKernel_tests.h"
+#include "realSpaceConstraintsKernel.h"
+#include <stdio.h>
+#include <stdint.h>
+#include <math.h>
+#ifdef WITH_MPI
+#  include <mpi.h>
+#endif
+#include "../../src/libutil/xmem.h"
+
+
+/*--- Local defines -----------------------------------------------------*/
+
+/** @brief  The largest allowed deviation from the reference results. */
+#define LOCAL_TOLERANCE 1e-5
+
+
+/*--- Prototypes of local functions -------------------------------------*/
+static void
+local_fillRandom(fpv_t *data, uint64_t numValues, uint32_t seed);
+
+static bool
+local_checkEnforce(uint32_t dimIn, uint32_t dimOut);
+
+static void
+local_enforceReference(fpv_t             *dataOut,
+                       const fpv_t       *dataIn,
+                       gridPointUint32_t dimsOut,
+                       gridPointUint32_t dimsIn);
+
+static bool
+local_checkDegrade(gridPointUint32_t dimsIn, gridPointUint32_t dimsOut);
+
+static bool
+local_checkDegradeConstant(void);
+
+
+/*--- Implementations of exported functions -----------------------------*/
+extern bool
+realSpaceConstraintsKernel_enforceConstraints_test(void)
+{
+	bool hasPassed = true;
+	int  rank      = 0;
+#ifdef XMEM_TRACK_MEM
+	size_t allocatedBytes = global_allocated_bytes;
+#endif
+#ifdef WITH_MPI
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+#endif
+
+	if (rank == 0)
+		printf("Testing %s... ", __func__);
+
+	if (!local_checkEnforce(8, 16))
+		hasPassed = false;
+	if (!local_checkEnforce(8, 12))
+		hasPassed = false;
+
+#ifdef XMEM_TRACK_MEM
+	if (allocatedBytes != global_allocated_bytes)
+		hasPassed = false;
+#endif
+
+	return hasPassed ? true : false;
+}
+
+extern bool
+realSpaceConstraintsKernel_degrade_test(void)
+{
+	bool              hasPassed = true;
+	int               rank      = 0;
+	gridPointUint32_t dimsIn1   = {16, 16, 16};
+	gridPointUint32_t dimsOut1  = {8, 8, 8};
+	gridPointUint32_t dimsIn2   = {12, 8, 6};
+	gridPointUint32_t dimsOut2  = {4, 4, 3};
+#ifdef XMEM_TRACK_MEM
+	size_t            allocatedBytes = global_allocated_bytes;
+#endif
+#ifdef WITH_MPI
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+#endif
+
+	if (rank == 0)
+		printf("Testing %s... ", __func__);
+
+	if (!local_checkDegrade(dimsIn1, dimsOut1))
+		hasPassed = false;
+	if (!local_checkDegrade(dimsIn2, dimsOut2))
+		hasPassed = false;
+	if (!local_checkDegradeConstant())
+		hasPassed = false;
+
+#ifdef XMEM_TRACK_MEM
+	if (allocatedBytes != global_allocated_bytes)
+		hasPassed = false;
+#endif
+
+	return hasPassed ? true : false;
+}
+
+/*--- Implementations of local functions --------------------------------*/
+static void
+local_fillRandom(fpv_t *data, uint64_t numValues, uint32_t seed)
+{
+	uint32_t state = seed;
+
+	// A small linear congruential generator is enough to get
+	// reproducible values in [-1, 1).
+	for (uint64_t i = 0; i < numValues; i++) {
+		state   = state * UINT32_C(1664525) + UINT32_C(1013904223);
+		data[i] = (fpv_t)(state / 2147483648.0 - 1.0);
+	}
+}
+
+static bool
+local_checkEnforce(uint32_t dimIn, uint32_t dimOut)
+{
+	bool              hasPassed = true;
+	gridPointUint32_t dimsIn    = {dimIn, dimIn, dimIn};
+	gridPointUint32_t dimsOut   = {dimOut, dimOut, dimOut};
+	uint64_t          numIn     = (uint64_t)dimIn * dimIn * dimIn;
+	uint64_t          numOut    = (uint64_t)dimOut * dimOut * dimOut;
+	fpv_t             *dataIn, *dataOut, *dataRef;
+
+	dataIn  = xmalloc(sizeof(fpv_t) * numIn);
+	dataOut = xmalloc(sizeof(fpv_t) * numOut);
+	dataRef = xmalloc(sizeof(fpv_t) * numOut);
+	local_fillRandom(dataIn, numIn, 1);
+	local_fillRandom(dataOut, numOut, 2);
+	for (uint64_t i = 0; i < numOut; i++)
+		dataRef[i] = dataOut[i];
+
+	realSpaceConstraintsKernel_enforceConstraints(dataOut, dataIn,
+	                                              dimsOut, dimsIn);
+	local_enforceReference(dataRef, dataIn, dimsOut, dimsIn);
+
+	for (uint64_t i = 0; i < numOut; i++) {
+		if (fabs((double)dataOut[i] - (double)dataRef[i]) > LOCAL_TOLERANCE)
+			hasPassed = false;
+	}
+
+	xfree(dataRef);
+	xfree(dataOut);
+	xfree(dataIn);
+
+	return hasPassed;
+}
+
+static void
+local_enforceReference(fpv_t             *dataOut,
+                       const fpv_t       *dataIn,
+                       gridPointUint32_t dimsOut,
+                       gridPointUint32_t dimsIn)
+{
+	// This is the original full-sum implementation of the constraints,
+	// the kernel must reproduce it.
+	const double mat[8][8] = {
+		{1.0, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0, 1.0},
+		{-1.0, 1.0, -1.0, 1.0, -1.0, 1.0, -1.0, 1.0},
+		{-1.0, -1.0, 1.0, 1.0, -1.0, -1.0, 1.0, 1.0},
+		{1.0, -1.0, -1.0, 1.0, 1.0, -1.0, -1.0, 1.0},
+		{-1.0, -1.0, -1.0, -1.0, 1.0, 1.0, 1.0, 1.0},
+		{1.0, -1.0, 1.0, -1.0, -1.0, 1.0, -1.0, 1.0},
+		{1.0, 1.0, -1.0, -1.0, -1.0, -1.0, 1.0, 1.0},
+		{-1.0, 1.0, 1.0, -1.0, 1.0, -1.0, -1.0, 1.0}
+	};
+	const double e4[4][4] = {
+		{0.5, -0.661437827766, -0.5, 0.25},
+		{0.5, -0.25, 0.5, -0.661437827766},
+		{0.5, 0.25, 0.5, 0.661437827766},
+		{0.5, 0.661437827766, -0.5, -0.25}
+	};
+	const double e3[3][3] = {
+		{0.57735026918962584, -0.70710678118654746, -0.40824829046386307},
+		{0.57735026918962584, 0.0, 0.81649658092772615},
+		{0.57735026918962584, 0.70710678118654746, -0.40824829046386307}
+	};
+	int          len = ((dimsOut[0] * 2) == (dimsIn[0] * 3)) ? 3 : 4;
+
+	for (uint64_t k = 0; k < dimsIn[2]; k += 2) {
+		for (uint64_t j = 0; j < dimsIn[1]; j += 2) {
+			for (uint64_t i = 0; i < dimsIn[0]; i += 2) {
+				const fpv_t *in  = dataIn + i + (j + k * dimsIn[1])
+				                   * dimsIn[0];
+				fpv_t       *out = dataOut + i * dimsOut[0] / dimsIn[0]
+				                   + (j * dimsOut[1] / dimsIn[1]
+				                      + k * dimsOut[2] / dimsIn[2]
+				                      * dimsOut[1]) * dimsOut[0];
+				double      a[64];
+
+				for (int c = 0; c < len; c++)
+					for (int b = 0; b < len; b++)
+						for (int d = 0; d < len; d++)
+							a[d + (b + c * len) * len]
+							    = out[d + (b + c * dimsOut[1]) * dimsOut[0]];
+				for (int c = 0; c < 2; c++) {
+					for (int b = 0; b < 2; b++) {
+						for (int d = 0; d < 2; d++) {
+							double sum = 0.0;
+							for (int cc = 0; cc < 2; cc++)
+								for (int bb = 0; bb < 2; bb++)
+									for (int dd = 0; dd < 2; dd++)
+										sum += in[dd + (bb + cc * dimsIn[1])
+										          * dimsIn[0]]
+										       * mat[2 * (2 * c + b) + d]
+										       [2 * (2 * cc + bb) + dd]
+										       / sqrt(8.0);
+							a[d + (b + c * len) * len] = sum;
+						}
+					}
+				}
+
+				for (int c = 0; c < len; c++) {
+					for (int b = 0; b < len; b++) {
+						for (int d = 0; d < len; d++) {
+							double sum = 0.0;
+							for (int cc = 0; cc < len; cc++)
+								for (int bb = 0; bb < len; bb++)
+									for (int dd = 0; dd < len; dd++)
+										sum += a[dd + (bb + cc * len) * len]
+										       * (len == 4
+										          ? e4[c][cc] * e4[b][bb]
+										          * e4[d][dd]
+										          : e3[c][cc] * e3[b][bb]
+										          * e3[d][dd]);
+							out[d + (b + c * dimsOut[1]) * dimsOut[0]]
+							    = (fpv_t)sum;
+						}
+					}
+				}
+			}
+		}
+	}
+} /* local_enforceReference */
+
+static bool
+local_checkDegrade(gridPointUint32_t dimsIn, gridPointUint32_t dimsOut)
+{
+	bool              hasPassed = true;
+	gridPointUint32_t dimsSV;
+	uint64_t          numIn  = (uint64_t)dimsIn[0] * dimsIn[1] * dimsIn[2];
+	uint64_t          numOut = (uint64_t)dimsOut[0] * dimsOut[1]
+	                           * dimsOut[2];
+	double            norm   = 1.0;
+	fpv_t             *dataIn, *dataOut;
+
+	for (int i = 0; i < 3; i++) {
+		dimsSV[i] = dimsIn[i] / dimsOut[i];
+		norm     *= dimsSV[i];
+	}
+	// The mean over a subvolume, scaled to keep the variance of white
+	// noise.
+	norm    = sqrt(norm) / norm;
+
+	dataIn  = xmalloc(sizeof(fpv_t) * numIn);
+	dataOut = xmalloc(sizeof(fpv_t) * numOut);
+	local_fillRandom(dataIn, numIn, 3);
+
+	realSpaceConstraintsKernel_degrade(dataOut, dataIn, dimsOut, dimsIn);
+
+	for (uint32_t k = 0; k < dimsOut[2]; k++) {
+		for (uint32_t j = 0; j < dimsOut[1]; j++) {
+			for (uint32_t i = 0; i < dimsOut[0]; i++) {
+				long double sum = 0.0L;
+				for (uint32_t kS = 0; kS < dimsSV[2]; kS++)
+					for (uint32_t jS = 0; jS < dimsSV[1]; jS++)
+						for (uint32_t iS = 0; iS < dimsSV[0]; iS++)
+							sum += dataIn[i * dimsSV[0] + iS
+							              + (j * dimsSV[1] + jS
+							                 + (k * dimsSV[2] + kS)
+							                 * dimsIn[1]) * dimsIn[0]];
+				uint64_t idx = i + (j + (uint64_t)k * dimsOut[1])
+				               * dimsOut[0];
+				if (fabs((double)dataOut[idx] - (double)(sum * norm))
+				    > LOCAL_TOLERANCE)
+					hasPassed = false;
+			}
+		}
+	}
+
+	xfree(dataOut);
+	xfree(dataIn);
+
+	return hasPassed;
+}
+
+static bool
+local_checkDegradeConstant(void)
+{
+	bool              hasPassed = true;
+	gridPointUint32_t dimsIn    = {12, 12, 12};
+	gridPointUint32_t dimsOut   = {4, 4, 4};
+	uint64_t          numIn     = 12 * 12 * 12;
+	uint64_t          numOut    = 4 * 4 * 4;
+	fpv_t             *dataIn, *dataOut;
+
+	dataIn  = xmalloc(sizeof(fpv_t) * numIn);
+	dataOut = xmalloc(sizeof(fpv_t) * numOut);
+	for (uint64_t i = 0; i < numIn; i++)
+		dataIn[i] = 0.1;
+
+	realSpaceConstraintsKernel_degrade(dataOut, dataIn, dimsOut, dimsIn);
+
+	// A constant c turns into c * sqrt(3^3).
+	for (uint64_t i = 0; i < numOut; i++) {
+		if (fabs((double)dataOut[i] - 0.1 * sqrt(27.0)) > LOCAL_TOLERANCE)
+			hasPassed = false;
+	}
+
+	xfree(dataOut);
+	xfree(dataIn);
+
+	return hasPassed;
+}
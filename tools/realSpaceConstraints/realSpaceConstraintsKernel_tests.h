@@ -0,0 +1,53 @@
+// Copyright (C) 2011, Steffen Knollmann
+// Released under the terms of the GNU General Public License version 3.
+// This file is part of `ginnungagap'.
+
+#ifndef REALSPACECONSTRAINTSKERNEL_TESTS_H
+#define REALSPACECONSTRAINTSKERNEL_TESTS_H
+
+
+/*--- Doxygen file description ------------------------------------------*/
+
+/**
+ * @file realSpaceConstraints/realSpaceConstraintsKernel_tests.h
+ * @ingroup  toolsRealSpaceConstraintsKernelTests
+ * @brief  Provides the interface to the tests of the kernels.
+ */
+
+
+/*--- Includes ----------------------------------------------------------*/
+#include "realSpaceConstraintsConfig.h"
+#include <stdbool.h>
+
+
+/*--- Prototypes of exported functions ----------------------------------*/
+
+/**
+ * @brief  Tests realSpaceConstraintsKernel_enforceConstraints() for a
+ *         refinement by 2 and by 1.5.
+ *
+ * @return  Returns @c true if the tests succeeded and @c false otherwise.
+ */
+extern bool
+realSpaceConstraintsKernel_enforceConstraints_test(void);
+
+/**
+ * @brief  Tests realSpaceConstraintsKernel_degrade() for random data and
+ *         for a constant field.
+ *
+ * @return  Returns @c true if the tests succeeded and @c false otherwise.
+ */
+extern bool
+realSpaceConstraintsKernel_degrade_test(void);
+
+
+/*--- Doxygen group definitions -----------------------------------------*/
+
+/**
+ * @defgroup toolsRealSpaceConstraintsKernelTests Tests
+ * @ingroup  toolsRealSpaceConstraintsKernel
+ * @brief  Provides tests for the kernels.
+ */
+
+
+#endif
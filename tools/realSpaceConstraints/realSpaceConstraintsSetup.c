@@ -61,6 +61,12 @@ realSpaceConstraintsSetup_newFromIni(parse_ini_t ini,
 	}
 	getFromIni(&(setup->writerSecName), parse_ini_get_string,
 	           ini, "writerSecName", sectionName);
+	if (!parse_ini_get_bool(ini, "useBatchedGauss", sectionName,
+	                        &(setup->useBatchedGauss)))
+		setup->useBatchedGauss = false;
+	if (!parse_ini_get_string(ini, "profilePrefix", sectionName,
+	                          &(setup->profilePrefix)))
+		setup->profilePrefix = NULL;
 
 	return setup;
 } /* realSpaceConstraintsSetup_newFromIni */
@@ -77,6 +83,8 @@ realSpaceConstraintsSetup_del(realSpaceConstraintsSetup_t *setup)
 		xfree((*setup)->readerSecName);
 	if ((*setup)->writerInSecName != NULL)
 		xfree((*setup)->writerInSecName);
+	if ((*setup)->profilePrefix != NULL)
+		xfree((*setup)->profilePrefix);
 	xfree(*setup);
 
 	*setup = NULL;
@@ -39,6 +39,8 @@ struct realSpaceConstraintsSetup_struct {
 	char     *writerInSecName;
 	int      seedIn;
 	int      seedOut;
+	bool     useBatchedGauss;
+	char     *profilePrefix;
 };
 
 
@@ -89,6 +91,12 @@ realSpaceConstraintsSetup_del(realSpaceConstraintsSetup_t *setup);
  * # grid is smaller than the output grid.
  * seedOut = <integer>
  * #
+ * # Selects whether the white noise is drawn with the batched Gaussian
+ * # sampler.  This is optional and defaults to false.  It must match the
+ * # useBatchedGauss setting of the ginnungagap run that the constraints
+ * # should reproduce, as the two samplers give different realisations.
+ * useBatchedGauss = <true|false>
+ * #
  * # The name of the section in which to find the construction information
  * # for the reader.
  * # Either give this (when useFileForInput = true)..
@@ -103,6 +111,11 @@ realSpaceConstraintsSetup_del(realSpaceConstraintsSetup_t *setup);
  * # the output grid can be found.
  * writerSecName = <string>
  * #
+ * # Switches on the profiling, the region timings are written to
+ * # <prefix>.json and <prefix>.trace.json (see libutil/prof.h).  This is
+ * # optional, without it no profile is written.
+ * profilePrefix = <string>
+ * #
  * @endcode
  *
  * Please see @ref libgridIOOutIniFormat and @ref libgridIOInIniFormat for
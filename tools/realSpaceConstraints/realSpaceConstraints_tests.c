@@ -0,0 +1,91 @@
+// Copyright (C) 2011, Steffen Knollmann
+// Released under the terms of the GNU General Public License version 3.
+// This file is part of `ginnungagap'.
+
+
+/*--- Includes ----------------------------------------------------------*/
+#include "realSpaceConstraintsConfig.h"
+#include "realSpaceConstraintsKernel_tests.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#ifdef WITH_MPI
+#  include <mpi.h>
+#endif
+
+
+/*--- Local defines -----------------------------------------------------*/
+#define NAME "realSpaceConstraints"
+
+
+/*--- Macros ------------------------------------------------------------*/
+#define RUNTEST(a, hasFailed)   \
+    if (!(local_runtest(a))) {  \
+		hasFailed = true;       \
+	} else {                    \
+		if (!hasFailed)         \
+			hasFailed = false;  \
+	}
+
+
+/*--- Prototypes of local functions -------------------------------------*/
+static bool
+local_runtest(bool       (*f
+                       )(void));
+
+
+/*--- M A I N -----------------------------------------------------------*/
+int
+main(int argc, char **argv)
+{
+	bool hasFailed = false;
+	int  rank      = 0;
+	int  size      = 1;
+
+#ifdef WITH_MPI
+	MPI_Init(&argc, &argv);
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+	MPI_Comm_size(MPI_COMM_WORLD, &size);
+#endif
+
+	if (rank == 0) {
+		printf("\nTesting %s on %i %s\n",
+		       NAME, size, size > 1 ? "tasks" : "task");
+	}
+
+	if (rank == 0) {
+		printf("\nRunning tests for realSpaceConstraintsKernel:\n");
+		RUNTEST(&realSpaceConstraintsKernel_enforceConstraints_test,
+		        hasFailed);
+		RUNTEST(&realSpaceConstraintsKernel_degrade_test, hasFailed);
+	}
+
+#ifdef WITH_MPI
+	MPI_Finalize();
+#endif
+
+	if (hasFailed) {
+		if (rank == 0)
+			fprintf(stderr, "\nSome tests failed!\n\n");
+		return EXIT_FAILURE;
+	}
+	if (rank == 0)
+		printf("\nAll tests passed successfully!\n\n");
+
+	return EXIT_SUCCESS;
+} /* main */
+
+/*--- Implementations of local functions --------------------------------*/
+static bool
+local_runtest(bool       (*f
+                       )(void))
+{
+	bool hasPassed = f();
+
+	if (!hasPassed)
+		printf("!! FAILED !!\n");
+	else
+		printf("passed\n");
+
+	return hasPassed;
+}
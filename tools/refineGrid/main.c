@@ -38,6 +38,12 @@
 /*--- Local variables ---------------------------------------------------*/
 static char *localIniFileName = NULL;
 
+/**
+ * @brief  The rank of this process, kept for the final message which is
+ *         printed after MPI has been finalized.
+ */
+static int localRank = 0;
+
 
 /*--- Prototypes of local functions -------------------------------------*/
 static void
@@ -75,6 +81,10 @@ main(int argc, char **argv)
 	refineGrid_run(te);
 	refineGrid_del(&te);
 
+#ifdef WITH_MPI
+	MPI_Finalize();
+#endif
+
 	return EXIT_SUCCESS;
 }
 
@@ -86,6 +96,7 @@ local_initEnvironment(int *argc, char ***argv)
 
 #ifdef WITH_MPI
 	MPI_Init(argc, argv);
+	MPI_Comm_rank(MPI_COMM_WORLD, &localRank);
 #endif
 	cmdline = local_cmdlineSetup();
 	cmdline_parse(cmdline, *argc, *argv);
@@ -112,15 +123,9 @@ local_registerCleanUpFunctions(void)
 static void
 local_finalMessage(void)
 {
-	int rank = 0;
-
 	if (localIniFileName != NULL)
 		xfree(localIniFileName);
-#ifdef WITH_MPI
-	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
-	//MPI_Finalize();
-#endif
-	if (rank == 0) {
+	if (localRank == 0) {
 #ifdef XMEM_TRACK_MEM
 		printf("\n");
 		xmem_info(stdout);
@@ -34,6 +34,7 @@
 #include "../../src/libdata/dataVar.h"
 #include "../../src/libutil/xmem.h"
 #include "../../src/libutil/timer.h"
+#include "../../src/libutil/prof.h"
 #include "../../src/libutil/rng.h"
 #include "../../src/libutil/tile.h"
 #include "../../src/libutil/utilMath.h"
@@ -216,6 +217,88 @@ local_doFilter(gridRegularFFT_t fft, int cut_kind, uint32_t dim1D);
 static void
 local_doShiftFFT(gridRegularFFT_t fft, uint32_t          dim1D);
 
+/**
+ * @brief  Resamples the input grid onto the output grid in Fourier space.
+ *
+ * The input grid is transformed to k-space, its modes are truncated or
+ * zero-padded to the k-space layout of the output grid and the output
+ * grid is obtained with one backward FFT.  This gives the exact
+ * band-limited resampling of the input field, including its mean, and
+ * works in both directions.  The data of the input grid is consumed.
+ *
+ * @param[in,out]  gridOut
+ *                    The output grid that will be filled by this routine.
+ * @param[in]      distribOut
+ *                    The distribution of the output grid.
+ * @param[in,out]  gridIn
+ *                    The input grid.
+ * @param[in]      distribIn
+ *                    The distribution of the input grid.
+ *
+ * @return  Returns nothing.
+ */
+static void
+local_resampleSpectral(gridRegular_t        gridOut,
+                       gridRegularDistrib_t distribOut,
+                       gridRegular_t        gridIn,
+                       gridRegularDistrib_t distribIn);
+
+/**
+ * @brief  Copies the Fourier modes common to both grids from the input to
+ *         the output k-space grid.
+ *
+ * Modes that are not resolved by both grids (including the Nyquist
+ * planes of the smaller grid) are set to zero.  The modes are multiplied
+ * by the normalisation of the input transform and by a phase factor that
+ * accounts for the different positions of the cell centres in the two
+ * grids.  The k-space grids are distributed along their last storage
+ * dimension; complete planes are exchanged between the processes.
+ *
+ * @param[in,out]  fftOut
+ *                    The FFT of the output grid, its Fourier space grid
+ *                    will be filled.
+ * @param[in]      fftIn
+ *                    The FFT of the input grid, must hold the forward
+ *                    transform.
+ * @param[in]      dimsOut
+ *                    The real space dimensions of the output grid.
+ * @param[in]      dimsIn
+ *                    The real space dimensions of the input grid.
+ *
+ * @return  Returns nothing.
+ */
+static void
+local_resampleModes(gridRegularFFT_t        fftOut,
+                    const gridRegularFFT_t  fftIn,
+                    const gridPointUint32_t dimsOut,
+                    const gridPointUint32_t dimsIn);
+
+/**
+ * @brief  Maps an index of a k-space grid to the index of the same mode in
+ *         another k-space grid.
+ *
+ * @param[in]  idx
+ *                The index in the first grid.
+ * @param[in]  dim1D
+ *                The real space size of the first grid in this dimension.
+ * @param[in]  dim1DOther
+ *                The real space size of the other grid in this dimension.
+ * @param[in]  isR2CDim
+ *                Whether this is the dimension of the real-to-complex
+ *                transform, which only holds non-negative wave numbers.
+ * @param[out] *k
+ *                Receives the (signed) wave number of the mode.
+ *
+ * @return  Returns the index in the other grid or @c -1 if the mode is
+ *          not resolved by both grids.
+ */
+inline static int64_t
+local_resampleIdx(uint32_t idx,
+                  uint32_t dim1D,
+                  uint32_t dim1DOther,
+                  bool     isR2CDim,
+                  int64_t  *k);
+
 static cosmoPk_t
 local_calcPk(gridRegularFFT_t gridFFT,
                       uint32_t         dim1D,
@@ -312,19 +395,26 @@ refineGrid_run(refineGrid_t te)
 #endif
 
 	assert(te != NULL);
-	
+
+	if (te->setup->profilePrefix != NULL)
+		prof_enable();
+
 	stat   = gridStatistics_new();
 
 	timing = timer_start_text("  Filling input grid... ");
+	prof_start("fillInput");
 	local_fillInputGrid(te->gridIn, te->reader);
+	prof_stop("fillInput");
 	timing = timer_stop_text(timing, "took %.5fs\n");
 
 	timing = timer_start_text("  Calculating statistics on input grid... ");
+	prof_start("statistics");
 #ifdef WITH_MPI	
 	gridStatistics_calcGridRegularDistrib(stat, te->distribIn, 0);
 #else
 	gridStatistics_calcGridRegular(stat, te->gridIn, 0);
 #endif
+	prof_stop("statistics");
         mean = gridStatistics_getMean(stat);
 	timing = timer_stop_text(timing, "took %.5fs\n");
 	if (rank == 0)
@@ -332,21 +422,26 @@ refineGrid_run(refineGrid_t te)
 
     if(te->setup->addFields) {
 		timing = timer_start_text("  Filling second input grid... ");
+		prof_start("fillInput");
 		local_fillInputGrid(te->gridIn2, te->reader2);
+		prof_stop("fillInput");
 		timing = timer_stop_text(timing, "took %.5fs\n");
 	
 		timing = timer_start_text("  Calculating statistics on second input grid... ");
+		prof_start("statistics");
 #ifdef WITH_MPI	
 		gridStatistics_calcGridRegularDistrib(stat, te->distribIn2, 0);
 #else
 		gridStatistics_calcGridRegular(stat, te->gridIn2, 0);
 #endif
+		prof_stop("statistics");
 		timing = timer_stop_text(timing, "took %.5fs\n");
 		if (rank == 0)
 			gridStatistics_printPretty(stat, stdout, "  ");
 			
 		
 		timing = timer_start_text("  Filtering first grid in k-space... ");
+		prof_start("filter");
 		fft1 = gridRegularFFT_new(te->gridIn,te->distribIn,0);
 		gridRegularFFT_execute(fft1, GRIDREGULARFFT_FORWARD);
 		local_doFilter(fft1,CUT_SMALL,te->setup->inputDim1D);
@@ -361,29 +456,56 @@ refineGrid_run(refineGrid_t te)
 		local_doFilter(fft2,CUT_LARGE,te->setup->inputDim1D);
 		gridRegularFFT_execute(fft2, GRIDREGULARFFT_BACKWARD);
 		gridRegularFFT_del(&fft2);
+		prof_stop("filter");
 		timing = timer_stop_text(timing, "took %.5fs\n");
 	}
 	
-	if(te->setup->inputDim1D > te->setup->outputDim1D) {
-		timing = timer_start_text("  FFT correction before NGP interpolation... ");
-		fft1 = gridRegularFFT_new(te->gridIn,te->distribIn,0);
-		gridRegularFFT_execute(fft1, GRIDREGULARFFT_FORWARD);
-		local_doShiftFFT(fft1,te->setup->inputDim1D);
-		gridRegularFFT_execute(fft1, GRIDREGULARFFT_BACKWARD);
-		gridRegularFFT_del(&fft1);
+	if (te->setup->useSpectralResampling) {
+		timing = timer_start_text("  Resampling in Fourier space... ");
+		prof_start("resample");
+		local_resampleSpectral(te->gridOut, te->distribOut,
+		                       te->gridIn, te->distribIn);
+		if (te->gridIn2 != NULL) {
+			gridPatch_t       patchOut, patchIn2;
+			gridPointUint32_t dimsOut;
+
+			patchOut = gridRegular_getPatchHandle(te->gridOut, 0);
+			patchIn2 = gridRegular_getPatchHandle(te->gridIn2, 0);
+			gridPatch_getDims(patchOut, dimsOut);
+			local_addGrid(gridPatch_getVarDataHandle(patchOut, 0),
+			              gridPatch_getVarDataHandle(patchIn2, 0),
+			              dimsOut);
+		}
+		prof_stop("resample");
 		timing = timer_stop_text(timing, "took %.5fs\n");
-	}
+	} else {
+		if(te->setup->inputDim1D > te->setup->outputDim1D) {
+			timing = timer_start_text("  FFT correction before NGP interpolation... ");
+			prof_start("shiftFFT");
+			fft1 = gridRegularFFT_new(te->gridIn,te->distribIn,0);
+			gridRegularFFT_execute(fft1, GRIDREGULARFFT_FORWARD);
+			local_doShiftFFT(fft1,te->setup->inputDim1D);
+			gridRegularFFT_execute(fft1, GRIDREGULARFFT_BACKWARD);
+			gridRegularFFT_del(&fft1);
+			prof_stop("shiftFFT");
+			timing = timer_stop_text(timing, "took %.5fs\n");
+		}
 
-	timing = timer_start_text("  Filling output grid... ");
-	local_fillOutputGrid(te->gridOut, te->gridIn, te->gridIn2);
-	timing = timer_stop_text(timing, "took %.5fs\n");
+		timing = timer_start_text("  Filling output grid... ");
+		prof_start("fillOutput");
+		local_fillOutputGrid(te->gridOut, te->gridIn, te->gridIn2);
+		prof_stop("fillOutput");
+		timing = timer_stop_text(timing, "took %.5fs\n");
+	}
 
 	timing = timer_start_text("  Calculating statistics on output grid... ");
+	prof_start("statistics");
 #ifdef WITH_MPI 
         gridStatistics_calcGridRegularDistrib(stat, te->distribOut, 0);
 #else
 	gridStatistics_calcGridRegular(stat, te->gridOut, 0);
 #endif
+	prof_stop("statistics");
 	timing = timer_stop_text(timing, "took %.5fs\n");
 	if (rank == 0)
 		gridStatistics_printPretty(stat, stdout, "  ");
@@ -398,18 +520,59 @@ refineGrid_run(refineGrid_t te)
 		gridRegularFFT_t fft = gridRegularFFT_new(te->gridOut,te->distribOut,0);
 		cosmoPk_t pk;
 		timing = timer_start_text("  Calculating P(k)...");
+		prof_start("pk");
 		gridRegularFFT_execute(fft, GRIDREGULARFFT_FORWARD);
 		pk     = local_calcPk(fft,
 				                 te->setup->outputDim1D,
 				                               te->setup->boxsizeInMpch);
 				cosmoPk_dumpToFile(pk, te->setup->PkFile, 1);
 				cosmoPk_del(&pk);
+		prof_stop("pk");
 		timing = timer_stop_text(timing, "took %.5fs\n");
 	}
 
 	gridStatistics_del(&stat);
+
+	if (te->setup->profilePrefix != NULL) {
+		prof_report(te->setup->profilePrefix);
+		prof_reset();
+	}
 } /* refineGrid_run */
 
+extern gridReader_t
+refineGrid_getReader(const refineGrid_t te)
+{
+	assert(te != NULL);
+
+	return te->reader;
+}
+
+extern void
+refineGrid_setReader(refineGrid_t te, gridReader_t reader)
+{
+	assert(te != NULL);
+	assert(reader != NULL);
+
+	te->reader = reader;
+}
+
+extern gridWriter_t
+refineGrid_getWriter(const refineGrid_t te)
+{
+	assert(te != NULL);
+
+	return te->writer;
+}
+
+extern void
+refineGrid_setWriter(refineGrid_t te, gridWriter_t writer)
+{
+	assert(te != NULL);
+	assert(writer != NULL);
+
+	te->writer = writer;
+}
+
 extern void
 refineGrid_del(refineGrid_t *te)
 {
@@ -594,6 +757,226 @@ local_doShiftFFT(gridRegularFFT_t fft, uint32_t          dim1D)
 
 
 
+static void
+local_resampleSpectral(gridRegular_t        gridOut,
+                       gridRegularDistrib_t distribOut,
+                       gridRegular_t        gridIn,
+                       gridRegularDistrib_t distribIn)
+{
+	gridRegularFFT_t  fftIn, fftOut;
+	gridPointUint32_t dimsIn, dimsOut;
+
+	gridRegular_getDims(gridIn, dimsIn);
+	gridRegular_getDims(gridOut, dimsOut);
+
+	fftIn  = gridRegularFFT_new(gridIn, distribIn, 0);
+	fftOut = gridRegularFFT_new(gridOut, distribOut, 0);
+
+	gridRegularFFT_execute(fftIn, GRIDREGULARFFT_FORWARD);
+	gridRegularFFT_initFFTed(fftOut);
+	local_resampleModes(fftOut, fftIn, dimsOut, dimsIn);
+	gridRegularFFT_del(&fftIn);
+
+	gridRegularFFT_execute(fftOut, GRIDREGULARFFT_BACKWARD);
+	gridRegularFFT_del(&fftOut);
+}
+
+static void
+local_resampleModes(gridRegularFFT_t        fftOut,
+                    const gridRegularFFT_t  fftIn,
+                    const gridPointUint32_t dimsOut,
+                    const gridPointUint32_t dimsIn)
+{
+	gridRegular_t     gridIn, gridOut;
+	gridPatch_t       patchIn, patchOut;
+	gridPointInt_t    permute, permuteIn;
+	gridPointUint32_t nIn, nOut, dimsPatchIn, dimsPatchOut;
+	gridPointUint32_t idxLoIn, idxLoOut;
+	double            shift[NDIM];
+	double            norm = gridRegularFFT_getNorm(fftIn);
+	fpvComplex_t      *dataIn, *dataOut, *sendBuf, *recvBuf;
+	uint64_t          planeSizeIn, planeSizeOut, numPlanes;
+	uint32_t          *ranges;
+	int               *counts, *displs;
+	int               rank = 0, size = 1;
+	const int         d    = NDIM - 1;
+
+	gridIn   = gridRegularFFT_getGridFFTed(fftIn);
+	gridOut  = gridRegularFFT_getGridFFTed(fftOut);
+	patchIn  = gridRegular_getPatchHandle(gridIn, 0);
+	patchOut = gridRegular_getPatchHandle(gridOut, 0);
+	gridRegular_getPermute(gridIn, permuteIn);
+	gridRegular_getPermute(gridOut, permute);
+	gridPatch_getDims(patchIn, dimsPatchIn);
+	gridPatch_getDims(patchOut, dimsPatchOut);
+	gridPatch_getIdxLo(patchIn, idxLoIn);
+	gridPatch_getIdxLo(patchOut, idxLoOut);
+	dataIn  = gridPatch_getVarDataHandle(patchIn, 0);
+	dataOut = gridPatch_getVarDataHandle(patchOut, 0);
+
+	// Work in the storage order of the k-space grids, all but the last
+	// dimension must be held completely by each process.
+	for (int i = 0; i < NDIM; i++) {
+		assert(permute[i] == permuteIn[i]);
+		nIn[i]    = dimsIn[permute[i]];
+		nOut[i]   = dimsOut[permute[i]];
+		shift[i]  = 2. * M_PI * (0.5 / nOut[i] - 0.5 / nIn[i]);
+		if (i < d) {
+			assert(idxLoIn[i] == 0 && idxLoOut[i] == 0);
+			assert(dimsPatchIn[i] == (permute[i] == 0 ? nIn[i] / 2 + 1
+			                          : nIn[i]));
+			assert(dimsPatchOut[i] == (permute[i] == 0 ? nOut[i] / 2 + 1
+			                           : nOut[i]));
+		}
+	}
+	planeSizeIn  = (uint64_t)dimsPatchIn[0] * dimsPatchIn[1];
+	planeSizeOut = (uint64_t)dimsPatchOut[0] * dimsPatchOut[1];
+
+#ifdef WITH_MPI
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+	MPI_Comm_size(MPI_COMM_WORLD, &size);
+#endif
+	// ranges[4 * r + (0..3)] = first and last plane of the input and the
+	// output k-space grid held by process r.
+	ranges    = xmalloc(sizeof(uint32_t) * 4 * size);
+	ranges[4 * rank + 0] = idxLoIn[d];
+	ranges[4 * rank + 1] = idxLoIn[d] + dimsPatchIn[d] - 1;
+	ranges[4 * rank + 2] = idxLoOut[d];
+	ranges[4 * rank + 3] = idxLoOut[d] + dimsPatchOut[d] - 1;
+#ifdef WITH_MPI
+	MPI_Allgather(MPI_IN_PLACE, 4, MPI_UNSIGNED, ranges, 4, MPI_UNSIGNED,
+	              MPI_COMM_WORLD);
+#endif
+	counts = xmalloc(sizeof(int) * 4 * size);
+	displs = counts + 2 * size;
+
+	// Every process builds the output planes for which it holds the
+	// source plane, ordered by destination process and output plane.
+	numPlanes = 0;
+	for (int r = 0; r < size; r++) {
+		counts[r] = 0;
+		displs[r] = (int)numPlanes;
+		for (uint32_t o = ranges[4 * r + 2]; o <= ranges[4 * r + 3]; o++) {
+			int64_t k, s;
+			s = local_resampleIdx(o, nOut[d], nIn[d], permute[d] == 0, &k);
+			if ((s >= ranges[4 * rank + 0]) && (s <= ranges[4 * rank + 1]))
+				counts[r]++;
+		}
+		numPlanes += counts[r];
+	}
+	sendBuf = xmalloc(sizeof(fpvComplex_t) * planeSizeOut
+	                  * (numPlanes > 0 ? numPlanes : 1));
+
+	numPlanes = 0;
+	for (int r = 0; r < size; r++) {
+		for (uint32_t o = ranges[4 * r + 2]; o <= ranges[4 * r + 3]; o++) {
+			int64_t            k2, s2;
+			const fpvComplex_t *planeIn;
+			fpvComplex_t       *planeOut;
+
+			s2 = local_resampleIdx(o, nOut[d], nIn[d], permute[d] == 0, &k2);
+			if ((s2 < ranges[4 * rank + 0]) || (s2 > ranges[4 * rank + 1]))
+				continue;
+
+			planeIn  = dataIn + (s2 - idxLoIn[d]) * planeSizeIn;
+			planeOut = sendBuf + numPlanes * planeSizeOut;
+			numPlanes++;
+#ifdef WITH_OPENMP
+#  pragma omp parallel for shared(planeIn, planeOut, k2)
+#endif
+			for (uint32_t j = 0; j < dimsPatchOut[1]; j++) {
+				fpvComplex_t *rowOut = planeOut + j * dimsPatchOut[0];
+				int64_t      k1, s1;
+
+				s1 = local_resampleIdx(j, nOut[1], nIn[1], permute[1] == 0, &k1);
+				for (uint32_t i = 0; i < dimsPatchOut[0]; i++) {
+					int64_t k0, s0;
+
+					s0 = local_resampleIdx(i, nOut[0], nIn[0],
+					                       permute[0] == 0, &k0);
+					if ((s0 < 0) || (s1 < 0)) {
+						rowOut[i] = FPV_C(0.0);
+					} else {
+						double phase = k0 * shift[0] + k1 * shift[1]
+						               + k2 * shift[2];
+						rowOut[i] = planeIn[s0 + s1 * dimsPatchIn[0]]
+						            * (fpvComplex_t)(norm * cexp(I * phase));
+					}
+				}
+			}
+		}
+	}
+
+	// Receive, for every source process in turn, the planes it built for
+	// this process.
+	for (int r = 0; r < size; r++) {
+		counts[size + r]     = 0;
+		displs[size + r]     = (r == 0) ? 0 : displs[size + r - 1]
+		                                     + counts[size + r - 1];
+		for (uint32_t o = idxLoOut[d]; o <= ranges[4 * rank + 3]; o++) {
+			int64_t k, s;
+			s = local_resampleIdx(o, nOut[d], nIn[d], permute[d] == 0, &k);
+			if ((s >= ranges[4 * r + 0]) && (s <= ranges[4 * r + 1]))
+				counts[size + r]++;
+		}
+	}
+#ifdef WITH_MPI
+	MPI_Datatype planeType;
+	uint64_t     numPlanesRecv = displs[2 * size - 1] + counts[2 * size - 1];
+
+	recvBuf = xmalloc(sizeof(fpvComplex_t) * planeSizeOut
+	                  * (numPlanesRecv > 0 ? numPlanesRecv : 1));
+	MPI_Type_contiguous((int)(2 * planeSizeOut), MYMPI_FPV, &planeType);
+	MPI_Type_commit(&planeType);
+	MPI_Alltoallv(sendBuf, counts, displs, planeType,
+	              recvBuf, counts + size, displs + size, planeType,
+	              MPI_COMM_WORLD);
+	MPI_Type_free(&planeType);
+	xfree(sendBuf);
+#else
+	recvBuf = sendBuf;
+#endif
+
+	for (uint64_t i = 0; i < planeSizeOut * dimsPatchOut[d]; i++)
+		dataOut[i] = FPV_C(0.0);
+	for (int r = 0; r < size; r++) {
+		uint64_t pos = displs[size + r];
+		for (uint32_t o = idxLoOut[d]; o <= ranges[4 * rank + 3]; o++) {
+			int64_t k, s;
+			s = local_resampleIdx(o, nOut[d], nIn[d], permute[d] == 0, &k);
+			if ((s < ranges[4 * r + 0]) || (s > ranges[4 * r + 1]))
+				continue;
+			memcpy(dataOut + (o - idxLoOut[d]) * planeSizeOut,
+			       recvBuf + pos * planeSizeOut,
+			       sizeof(fpvComplex_t) * planeSizeOut);
+			pos++;
+		}
+	}
+
+	xfree(recvBuf);
+	xfree(counts);
+	xfree(ranges);
+} /* local_resampleModes */
+
+inline static int64_t
+local_resampleIdx(uint32_t idx,
+                  uint32_t dim1D,
+                  uint32_t dim1DOther,
+                  bool     isR2CDim,
+                  int64_t  *k)
+{
+	int64_t kMax = (int64_t)MIN(dim1D, dim1DOther) / 2;
+
+	*k = (int64_t)idx;
+	if (!isR2CDim && (*k > (int64_t)dim1D / 2))
+		*k -= dim1D;
+
+	if ((*k >= kMax) || (*k <= -kMax))
+		return -1;
+
+	return (*k < 0) ? *k + dim1DOther : *k;
+}
+
 static cosmoPk_t
 local_calcPk(gridRegularFFT_t gridFFT,
                       uint32_t         dim1D,
@@ -18,6 +18,8 @@
 /*--- Includes ----------------------------------------------------------*/
 #include "refineGridConfig.h"
 #include "../../src/libutil/parse_ini.h"
+#include "../../src/libgrid/gridReader.h"
+#include "../../src/libgrid/gridWriter.h"
 
 
 /*--- ADT handle --------------------------------------------------------*/
@@ -53,6 +55,65 @@ extern void
 refineGrid_run(refineGrid_t rsc);
 
 
+/**
+ * @brief  Gives the reader of the input grid.
+ *
+ * @param[in]  rsc
+ *                The application to query.
+ *
+ * @return  Returns the reader, it remains owned by the application.
+ */
+extern gridReader_t
+refineGrid_getReader(const refineGrid_t rsc);
+
+
+/**
+ * @brief  Replaces the reader of the input grid.
+ *
+ * This allows to wrap the reader, e.g. to serve the grid from memory.
+ * The previous reader is not deleted, the caller is responsible for it.
+ *
+ * @param[in,out]  rsc
+ *                    The application to change.
+ * @param[in]      reader
+ *                    The new reader.  The application takes it over.
+ *                    It must not be @c NULL.
+ *
+ * @return  Returns nothing.
+ */
+extern void
+refineGrid_setReader(refineGrid_t rsc, gridReader_t reader);
+
+
+/**
+ * @brief  Gives the writer of the output grid.
+ *
+ * @param[in]  rsc
+ *                The application to query.
+ *
+ * @return  Returns the writer, it remains owned by the application.
+ */
+extern gridWriter_t
+refineGrid_getWriter(const refineGrid_t rsc);
+
+
+/**
+ * @brief  Replaces the writer of the output grid.
+ *
+ * Like refineGrid_setReader(), the previous writer is not deleted.
+ *
+ * @param[in,out]  rsc
+ *                    The application to change.
+ * @param[in]      writer
+ *                    The new writer.  The application takes it over.
+ *                    It must not be @c NULL.
+ *
+ * @return  Returns nothing.
+ */
+extern void
+refineGrid_setWriter(refineGrid_t rsc, gridWriter_t writer);
+
+
 /**
  * @brief  Deletes a refineGrid application and frees the
  *         associated memory.
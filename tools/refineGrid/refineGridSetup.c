@@ -60,6 +60,13 @@ refineGridSetup_newFromIni(parse_ini_t ini,
     			setup->PkFile = "Pk_ref.dat";                                    \
     		}
     }
+	if (!parse_ini_get_bool(ini, "useSpectralResampling", sectionName,
+	                        &(setup->useSpectralResampling))) {
+		setup->useSpectralResampling = false;
+	}
+	if (!parse_ini_get_string(ini, "profilePrefix", sectionName,
+	                          &(setup->profilePrefix)))
+		setup->profilePrefix = NULL;
 	if(setup->addFields) {
 	      getFromIni(&(setup->reader2SecName), parse_ini_get_string,
 		           ini, "readerAddSecName", sectionName);           
@@ -82,6 +89,8 @@ refineGridSetup_del(refineGridSetup_t *setup)
 		xfree((*setup)->readerSecName);
 	if ((*setup)->reader2SecName != NULL)
 		xfree((*setup)->reader2SecName);
+	if ((*setup)->profilePrefix != NULL)
+		xfree((*setup)->profilePrefix);
 	xfree(*setup);
 
 	*setup = NULL;
@@ -40,6 +40,8 @@ struct refineGridSetup_struct {
 	char     *reader2SecName;
 	bool	 doPk;
 	char	 *PkFile;
+	bool     useSpectralResampling;
+	char     *profilePrefix;
 };
 
 
@@ -104,6 +106,16 @@ refineGridSetup_del(refineGridSetup_t *setup);
  * # the output grid can be found.
  * writerSecName = <string>
  * #
+ * # Optional, defaults to false.  If true, the output grid is obtained by
+ * # truncating or zero-padding the Fourier modes of the input grid instead
+ * # of interpolating in real space.  This requires only one forward and
+ * # one backward FFT and gives the exact band-limited resampling.
+ * useSpectralResampling = <true|false>
+ * #
+ * # Optional.  Switches on the profiling, the region timings are written
+ * # to <prefix>.json and <prefix>.trace.json (see libutil/prof.h).
+ * profilePrefix = <string>
+ * #
  * @endcode
  *
  * Please see @ref libgridIOOutIniFormat and @ref libgridIOInIniFormat for
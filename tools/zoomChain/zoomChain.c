@@ -0,0 +1,608 @@
+// Copyright (C) 2013, Steffen Knollmann
+// Released under the terms of the GNU General Public License version 3.
+// This file is part of `ginnungagap'.
+
+
+/*--- Doxygen file description ------------------------------------------*/
+
+/**
+ * @file zoomChain/zoomChain.c
+ * @ingroup  toolsZoomChain
+ * @brief  Provides the implementation of the zoomChain tool.
+ */
+
+
+/*--- Includes ----------------------------------------------------------*/
+#include "zoomChainConfig.h"
+#include "zoomChain.h"
+#include "zoomChainManifest.h"
+#include "zoomChainStore.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <assert.h>
+#ifdef WITH_MPI
+#  include <mpi.h>
+#endif
+#include "../../src/ginnungagap/ginnungagap.h"
+#include "../../src/libgrid/gridWriterFactory.h"
+#include "../makeMask/makeMask.h"
+#include "../makeMask/makeMaskConfig.h"
+#include "../realSpaceConstraints/realSpaceConstraints.h"
+#include "../refineGrid/refineGrid.h"
+#include "../generateICs/generateICs.h"
+#include "../generateICs/generateICsFactory.h"
+#include "../ginnungagapICs/ginnungagapICs.h"
+#include "../../src/libutil/xmem.h"
+#include "../../src/libutil/xstring.h"
+#include "../../src/libutil/xfile.h"
+#include "../../src/libutil/timer.h"
+#include "../../src/libutil/diediedie.h"
+
+
+/*--- Implemention of main structure ------------------------------------*/
+#include "zoomChain_adt.h"
+
+
+/*--- Local variables ---------------------------------------------------*/
+
+/** @brief  The names of the tools, in the order of #zoomChainTool_t. */
+static const char *local_toolNames[] = {
+	"makeMask",
+	"ginnungagap",
+	"realSpaceConstraints",
+	"refineGrid",
+	"generateICs",
+	"ginnungagapICs"
+};
+
+/** @brief  The number of entries in #local_toolNames. */
+#define LOCAL_NUMTOOLS \
+	(sizeof(local_toolNames) / sizeof(local_toolNames[0]))
+
+/** @brief  The suffix of the manifest, it follows the ini file and the
+ *         stage name. */
+#define LOCAL_MANIFEST_SUFFIX ".manifest"
+
+
+/*--- Prototypes of local functions -------------------------------------*/
+static void
+local_stageInitFromIni(struct zoomChainStage_struct *stage,
+                       parse_ini_t                  ini,
+                       const char                   *stageName);
+
+static void
+local_getFileListFromIni(parse_ini_t ini,
+                         const char  *numKey,
+                         const char  *listKey,
+                         const char  *stageName,
+                         uint32_t    *numFiles,
+                         char        ***files);
+
+static zoomChainTool_t
+local_getToolFromName(const char *toolName, const char *stageName);
+
+static bool
+local_stageIsUpToDate(const zoomChain_t chain, uint32_t stageIdx);
+
+static char *
+local_getManifestName(const struct zoomChainStage_struct *stage);
+
+static bool
+local_stageRecordsOutputs(const struct zoomChainStage_struct *stage);
+
+static void
+local_recordOutputsOfStage(struct zoomChainStage_struct *stage,
+                           zoomChainStore_t             store);
+
+static void
+local_addUsesOfStage(zoomChainStore_t                   store,
+                     const struct zoomChainStage_struct *stage);
+
+static void
+local_releaseUsesOfStage(zoomChainStore_t                   store,
+                         const struct zoomChainStage_struct *stage);
+
+static void
+local_runStage(const struct zoomChainStage_struct *stage,
+               zoomChainStore_t                   store,
+               bool                               keepGridsInMemory);
+
+
+/*--- Implementations of exported functions -----------------------------*/
+extern zoomChain_t
+zoomChain_newFromIni(parse_ini_t ini, const char *sectionName)
+{
+	zoomChain_t chain;
+	char        **stageNames;
+
+	assert(ini != NULL);
+
+	if (sectionName == NULL)
+		sectionName = ZOOMCHAINCONFIG_DEFAULT_SECTIONNAME;
+
+	chain           = xmalloc(sizeof(struct zoomChain_struct));
+	chain->forceRun = false;
+
+	getFromIni(&(chain->numStages), parse_ini_get_uint32,
+	           ini, "numStages", sectionName);
+	if (chain->numStages == 0) {
+		fprintf(stderr, "FATAL:  The chain in section %s has no stages.\n",
+		        sectionName);
+		exit(EXIT_FAILURE);
+	}
+	if (!parse_ini_get_stringlist(ini, "stages", sectionName,
+	                              chain->numStages, &stageNames)) {
+		fprintf(stderr,
+		        "FATAL:  Could not get %u stage names from stages in "
+		        "section %s.\n", chain->numStages, sectionName);
+		exit(EXIT_FAILURE);
+	}
+
+	chain->stages = xmalloc(sizeof(struct zoomChainStage_struct)
+	                        * chain->numStages);
+	for (uint32_t i = 0; i < chain->numStages; i++) {
+		local_stageInitFromIni(chain->stages + i, ini, stageNames[i]);
+		xfree(stageNames[i]);
+	}
+	xfree(stageNames);
+
+	if (!parse_ini_get_bool(ini, "keepGridsInMemory", sectionName,
+	                        &(chain->keepGridsInMemory)))
+		chain->keepGridsInMemory = true;
+	if (!parse_ini_get_bool(ini, "hashContent", sectionName,
+	                        &(chain->hashContent)))
+		chain->hashContent = true;
+
+	// The store also records the written files, it is always needed.
+	chain->store = zoomChainStore_new();
+	if (chain->keepGridsInMemory) {
+		for (uint32_t i = 0; i < chain->numStages; i++)
+			local_addUsesOfStage(chain->store, chain->stages + i);
+	}
+
+	return chain;
+}
+
+extern void
+zoomChain_printSummary(const zoomChain_t chain, FILE *out)
+{
+	assert(chain != NULL);
+	assert(out != NULL);
+
+	fprintf(out, "Stages of the chain:\n");
+	for (uint32_t i = 0; i < chain->numStages; i++) {
+		const struct zoomChainStage_struct *stage = chain->stages + i;
+
+		fprintf(out, "  %3u  %-16s %-22s %s", i, stage->name,
+		        local_toolNames[stage->tool], stage->iniFileName);
+		if (stage->sectionName != NULL)
+			fprintf(out, " [%s]", stage->sectionName);
+		if (stage->wasSkipped)
+			fprintf(out, "  skipped");
+		else if (stage->timing >= 0.0)
+			fprintf(out, "  %.5fs", stage->timing);
+		fprintf(out, "\n");
+	}
+}
+
+extern void
+zoomChain_setForceRun(zoomChain_t chain, bool forceRun)
+{
+	assert(chain != NULL);
+
+	chain->forceRun = forceRun;
+}
+
+extern void
+zoomChain_run(zoomChain_t chain)
+{
+	int    rank = 0;
+	double timing;
+
+	assert(chain != NULL);
+#ifdef WITH_MPI
+	MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+#endif
+
+	if (rank == 0)
+		zoomChain_printSummary(chain, stdout);
+
+	timing = timer_start();
+	for (uint32_t i = 0; i < chain->numStages; i++) {
+		struct zoomChainStage_struct *stage = chain->stages + i;
+		int                          isUpToDate = 0;
+
+		// Only the root rank hashes, the others follow its decision.
+		if (rank == 0)
+			isUpToDate = local_stageIsUpToDate(chain, i) ? 1 : 0;
+#ifdef WITH_MPI
+		MPI_Bcast(&isUpToDate, 1, MPI_INT, 0, MPI_COMM_WORLD);
+#endif
+		stage->wasSkipped = (isUpToDate != 0);
+
+		if (rank == 0) {
+			printf("\n### Stage %u of %u: %s (%s)%s\n\n", i + 1,
+			       chain->numStages, stage->name,
+			       local_toolNames[stage->tool],
+			       stage->wasSkipped ? ", skipped as its outputs are "
+			       "current" : "");
+			fflush(stdout);
+		}
+		if (stage->wasSkipped) {
+			local_releaseUsesOfStage(chain->store, stage);
+			continue;
+		}
+
+		stage->timing = timer_start();
+		local_runStage(stage, chain->store, chain->keepGridsInMemory);
+		// timer_stop() synchronises, all ranks are done with the outputs.
+		stage->timing = timer_stop(stage->timing);
+		local_releaseUsesOfStage(chain->store, stage);
+		local_recordOutputsOfStage(stage, chain->store);
+
+		if ((rank == 0) && (stage->manifest != NULL)
+		    && (zoomChainManifest_getNumOutputs(stage->manifest) > 0)) {
+			char *manifestName = local_getManifestName(stage);
+			zoomChainManifest_write(stage->manifest, manifestName);
+			xfree(manifestName);
+		}
+	}
+	timing = timer_stop(timing);
+
+	if (rank == 0) {
+		printf("\n");
+		zoomChain_printSummary(chain, stdout);
+		printf("Chain done in %.5fs\n", timing);
+	}
+}
+
+extern void
+zoomChain_del(zoomChain_t *chain)
+{
+	assert(chain != NULL && *chain != NULL);
+
+	for (uint32_t i = 0; i < (*chain)->numStages; i++) {
+		struct zoomChainStage_struct *stage = (*chain)->stages + i;
+
+		xfree(stage->name);
+		xfree(stage->iniFileName);
+		if (stage->sectionName != NULL)
+			xfree(stage->sectionName);
+		for (uint32_t j = 0; j < stage->numInputs; j++)
+			xfree(stage->inputs[j]);
+		if (stage->inputs != NULL)
+			xfree(stage->inputs);
+		for (uint32_t j = 0; j < stage->numOutputs; j++)
+			xfree(stage->outputs[j]);
+		if (stage->outputs != NULL)
+			xfree(stage->outputs);
+		if (stage->manifest != NULL)
+			zoomChainManifest_del(&(stage->manifest));
+	}
+	xfree((*chain)->stages);
+	zoomChainStore_del(&((*chain)->store));
+	xfree(*chain);
+
+	*chain = NULL;
+}
+
+/*--- Implementations of local functions --------------------------------*/
+static void
+local_stageInitFromIni(struct zoomChainStage_struct *stage,
+                       parse_ini_t                  ini,
+                       const char                   *stageName)
+{
+	char *toolName;
+
+	stage->name = xstrdup(stageName);
+
+	getFromIni(&toolName, parse_ini_get_string, ini, "tool", stageName);
+	stage->tool = local_getToolFromName(toolName, stageName);
+	xfree(toolName);
+
+	getFromIni(&(stage->iniFileName), parse_ini_get_string,
+	           ini, "iniFile", stageName);
+	// Catch missing files before hours have been spent on earlier stages.
+	if (!xfile_checkIfFileExists(stage->iniFileName)) {
+		fprintf(stderr, "FATAL:  The ini file %s of stage %s does not "
+		        "exist.\n", stage->iniFileName, stageName);
+		exit(EXIT_FAILURE);
+	}
+
+	if (!parse_ini_get_string(ini, "section", stageName,
+	                          &(stage->sectionName)))
+		stage->sectionName = NULL;
+
+	local_getFileListFromIni(ini, "numInputs", "inputs", stageName,
+	                         &(stage->numInputs), &(stage->inputs));
+	local_getFileListFromIni(ini, "numOutputs", "outputs", stageName,
+	                         &(stage->numOutputs), &(stage->outputs));
+
+	stage->manifest   = NULL;
+	stage->wasSkipped = false;
+	stage->timing     = -1.0;
+}
+
+static void
+local_getFileListFromIni(parse_ini_t ini,
+                         const char  *numKey,
+                         const char  *listKey,
+                         const char  *stageName,
+                         uint32_t    *numFiles,
+                         char        ***files)
+{
+	if (!parse_ini_get_uint32(ini, numKey, stageName, numFiles))
+		*numFiles = 0;
+
+	if (*numFiles == 0) {
+		*files = NULL;
+		return;
+	}
+
+	if (!parse_ini_get_stringlist(ini, listKey, stageName, *numFiles,
+	                              files)) {
+		fprintf(stderr, "FATAL:  Could not get %u file names from %s in "
+		        "section %s.\n", *numFiles, listKey, stageName);
+		exit(EXIT_FAILURE);
+	}
+}
+
+static zoomChainTool_t
+local_getToolFromName(const char *toolName, const char *stageName)
+{
+	for (size_t i = 0; i < LOCAL_NUMTOOLS; i++) {
+		if (strcmp(toolName, local_toolNames[i]) == 0)
+			return (zoomChainTool_t)i;
+	}
+
+	fprintf(stderr, "FATAL:  Unknown tool %s in stage %s, use one of:",
+	        toolName, stageName);
+	for (size_t i = 0; i < LOCAL_NUMTOOLS; i++)
+		fprintf(stderr, " %s", local_toolNames[i]);
+	fprintf(stderr, "\n");
+	exit(EXIT_FAILURE);
+}
+
+static bool
+local_stageIsUpToDate(const zoomChain_t chain, uint32_t stageIdx)
+{
+	struct zoomChainStage_struct *stage = chain->stages + stageIdx;
+	bool                         inputsAreKnown = true;
+	char                         *manifestName;
+	bool                         isUpToDate;
+
+	// Without outputs there is nothing to compare against, always run.
+	if ((stage->numOutputs == 0) && !local_stageRecordsOutputs(stage))
+		return false;
+
+	if (stage->manifest != NULL)
+		zoomChainManifest_del(&(stage->manifest));
+	stage->manifest = zoomChainManifest_new(stage->name, chain->hashContent);
+
+	zoomChainManifest_addInputString(stage->manifest,
+	                                 local_toolNames[stage->tool]);
+	zoomChainManifest_addInputString(stage->manifest, stage->sectionName);
+	// The ini file holds the seeds, cosmology and the grid hierarchy.
+	zoomChainManifest_addInputString(stage->manifest, stage->iniFileName);
+	inputsAreKnown &= zoomChainManifest_addInputFileContent(
+	    stage->manifest, stage->iniFileName);
+
+	for (uint32_t i = 0; i < stage->numInputs; i++) {
+		const struct zoomChainStage_struct *producer = NULL;
+		uint64_t                           hash;
+
+		// An output of an earlier stage is identified by what went into
+		// that stage, its time stamp is not needed.  The content is added
+		// as well if it is known, in case the tool does not reproduce its
+		// outputs exactly (e.g. with a different number of processes).
+		for (uint32_t j = stageIdx; j > 0 && producer == NULL; j--) {
+			const struct zoomChainStage_struct *earlier = chain->stages + j - 1;
+
+			if ((earlier->manifest != NULL)
+			    && zoomChainManifest_hasOutput(earlier->manifest,
+			                                   stage->inputs[i]))
+				producer = earlier;
+		}
+		if (producer != NULL) {
+			zoomChainManifest_addInputString(stage->manifest,
+			                                 stage->inputs[i]);
+			zoomChainManifest_addInputHash(
+			    stage->manifest,
+			    zoomChainManifest_getInputHash(producer->manifest));
+			if (chain->hashContent
+			    && zoomChainManifest_getOutputHash(producer->manifest,
+			                                       stage->inputs[i], &hash))
+				zoomChainManifest_addInputHash(stage->manifest, hash);
+		} else {
+			inputsAreKnown &= zoomChainManifest_addInputFile(
+			    stage->manifest, stage->inputs[i]);
+		}
+	}
+
+	// Without explicit inputs the stage depends on everything before it,
+	// which cannot be tracked through a stage without a manifest.
+	if ((stage->numInputs == 0) && (stageIdx > 0)) {
+		const struct zoomChainStage_struct *prev = stage - 1;
+
+		if (prev->manifest != NULL)
+			zoomChainManifest_addInputHash(
+			    stage->manifest, zoomChainManifest_getInputHash(prev->manifest));
+		else
+			inputsAreKnown = false;
+	}
+
+	// The outputs written by the tool are only known after it ran, the
+	// manifest of the last run provides them.
+	for (uint32_t i = 0; i < stage->numOutputs; i++)
+		zoomChainManifest_addOutput(stage->manifest, stage->outputs[i]);
+
+	// Without a full description of the inputs, the manifest could not be
+	// trusted later, neither by this stage nor by the ones reading its
+	// outputs.
+	if (!inputsAreKnown) {
+		zoomChainManifest_del(&(stage->manifest));
+		return false;
+	}
+	if (chain->forceRun)
+		return false;
+
+	manifestName = local_getManifestName(stage);
+	isUpToDate   = zoomChainManifest_isUpToDate(stage->manifest, manifestName);
+	xfree(manifestName);
+
+	return isUpToDate;
+} // local_stageIsUpToDate
+
+static char *
+local_getManifestName(const struct zoomChainStage_struct *stage)
+{
+	char *name, *tmp;
+
+	tmp  = xstrmerge(stage->iniFileName, ".");
+	name = xstrmerge(tmp, stage->name);
+	xfree(tmp);
+	tmp  = xstrmerge(name, LOCAL_MANIFEST_SUFFIX);
+	xfree(name);
+
+	return tmp;
+}
+
+static bool
+local_stageRecordsOutputs(const struct zoomChainStage_struct *stage)
+{
+	// The writers of these tools are wrapped by the store.
+	return (stage->tool == ZOOMCHAIN_TOOL_GINNUNGAGAP)
+	       || (stage->tool == ZOOMCHAIN_TOOL_REALSPACECONSTRAINTS)
+	       || (stage->tool == ZOOMCHAIN_TOOL_REFINEGRID);
+}
+
+static void
+local_recordOutputsOfStage(struct zoomChainStage_struct *stage,
+                           zoomChainStore_t             store)
+{
+	// Only the root rank keeps a manifest, all ranks forget the files.
+	if (stage->manifest != NULL) {
+		for (uint32_t i = 0; i < zoomChainStore_getNumWritten(store); i++)
+			zoomChainManifest_addOutput(stage->manifest,
+			                            zoomChainStore_getWritten(store, i));
+	}
+	zoomChainStore_clearWritten(store);
+}
+
+static void
+local_addUsesOfStage(zoomChainStore_t                   store,
+                     const struct zoomChainStage_struct *stage)
+{
+	// Only these tools read their input grid through a reader that can be
+	// served from memory.
+	if ((stage->tool != ZOOMCHAIN_TOOL_REALSPACECONSTRAINTS)
+	    && (stage->tool != ZOOMCHAIN_TOOL_REFINEGRID))
+		return;
+
+	for (uint32_t i = 0; i < stage->numInputs; i++)
+		zoomChainStore_addUse(store, stage->inputs[i]);
+}
+
+static void
+local_releaseUsesOfStage(zoomChainStore_t                   store,
+                         const struct zoomChainStage_struct *stage)
+{
+	if ((stage->tool != ZOOMCHAIN_TOOL_REALSPACECONSTRAINTS)
+	    && (stage->tool != ZOOMCHAIN_TOOL_REFINEGRID))
+		return;
+
+	for (uint32_t i = 0; i < stage->numInputs; i++)
+		zoomChainStore_release(store, stage->inputs[i]);
+}
+
+static void
+local_runStage(const struct zoomChainStage_struct *stage,
+               zoomChainStore_t                   store,
+               bool                               keepGridsInMemory)
+{
+	parse_ini_t ini;
+
+	ini = parse_ini_open(stage->iniFileName);
+	if (ini == NULL) {
+		fprintf(stderr, "FATAL:  Could not open %s for reading.\n",
+		        stage->iniFileName);
+		diediedie(EXIT_FAILURE);
+	}
+
+	// The applications only need the ini during their construction, it is
+	// closed before they run to not keep it around for the whole stage.
+	switch (stage->tool) {
+	case ZOOMCHAIN_TOOL_MAKEMASK:
+	{
+		makeMask_t mama = makeMask_newFromIni(ini,
+		                                      (stage->sectionName != NULL)
+		                                      ? stage->sectionName
+		                                      : MAKEMASK_SECTIONNAME_MASK);
+		parse_ini_close(&ini);
+		makeMask_run(mama);
+		makeMask_del(&mama);
+		break;
+	}
+	case ZOOMCHAIN_TOOL_GINNUNGAGAP:
+	{
+		ginnungagap_t g9p = ginnungagap_newWithWriter(
+		    ini,
+		    zoomChainStore_newWriter(
+		        store, gridWriterFactory_newWriterFromIni(ini, "Output")));
+		parse_ini_close(&ini);
+		ginnungagap_init(g9p);
+		ginnungagap_run(g9p);
+		ginnungagap_del(&g9p);
+		break;
+	}
+	case ZOOMCHAIN_TOOL_REALSPACECONSTRAINTS:
+	{
+		realSpaceConstraints_t rsc = realSpaceConstraints_newFromIni(ini);
+		parse_ini_close(&ini);
+		realSpaceConstraints_setWriter(
+		    rsc,
+		    zoomChainStore_newWriter(store,
+		                             realSpaceConstraints_getWriter(rsc)));
+		if (keepGridsInMemory && (realSpaceConstraints_getReader(rsc) != NULL))
+			realSpaceConstraints_setReader(
+			    rsc,
+			    zoomChainStore_newReader(store,
+			                             realSpaceConstraints_getReader(rsc)));
+		realSpaceConstraints_run(rsc);
+		realSpaceConstraints_del(&rsc);
+		break;
+	}
+	case ZOOMCHAIN_TOOL_REFINEGRID:
+	{
+		refineGrid_t ref = refineGrid_newFromIni(ini);
+		parse_ini_close(&ini);
+		refineGrid_setWriter(
+		    ref, zoomChainStore_newWriter(store, refineGrid_getWriter(ref)));
+		if (keepGridsInMemory)
+			refineGrid_setReader(
+			    ref, zoomChainStore_newReader(store, refineGrid_getReader(ref)));
+		refineGrid_run(ref);
+		refineGrid_del(&ref);
+		break;
+	}
+	case ZOOMCHAIN_TOOL_GENERATEICS:
+	{
+		generateICs_t genics = generateICsFactory_newFromIni(
+		    ini, stage->sectionName);
+		parse_ini_close(&ini);
+		generateICs_run(genics);
+		generateICs_del(&genics);
+		break;
+	}
+	case ZOOMCHAIN_TOOL_GINNUNGAGAPICS:
+	{
+		ginnungagapICs_t g9pICs = ginnungagapICs_newFromIni(
+		    ini, stage->sectionName);
+		parse_ini_close(&ini);
+		ginnungagapICs_run(g9pICs);
+		ginnungagapICs_del(&g9pICs);
+		break;
+	}
+	}
+} // local_runStage
@@ -0,0 +1,170 @@
+// Copyright (C) 2013, Steffen Knollmann
+// Released under the terms of the GNU General Public License version 3.
+// This file is part of `ginnungagap'.
+
+#ifndef ZOOMCHAIN_H
+#define ZOOMCHAIN_H
+
+
+/*--- Doxygen file description ------------------------------------------*/
+
+/**
+ * @file zoomChain/zoomChain.h
+ * @ingroup  toolsZoomChain
+ * @brief  Provides the interface to the zoomChain tool.
+ */
+
+
+/*--- Includes ----------------------------------------------------------*/
+#include "zoomChainConfig.h"
+#include <stdio.h>
+#include <stdbool.h>
+#include "../../src/libutil/parse_ini.h"
+
+
+/*--- ADT handle --------------------------------------------------------*/
+
+/** @brief  Provides a handle for the zoomChain application. */
+typedef struct zoomChain_struct *zoomChain_t;
+
+
+/*--- Prototypes of exported functions ----------------------------------*/
+
+/**
+ * @brief  Creates a new zoomChain application from an ini file.
+ *
+ * Only the list of stages is read here, the ini files of the stages are
+ * checked for existence but are only parsed when the stage is executed.
+ *
+ * @param[in,out]  ini
+ *                    The ini file describing the chain.
+ * @param[in]      *sectionName
+ *                    The section holding the list of stages, passing
+ *                    @c NULL uses #ZOOMCHAINCONFIG_DEFAULT_SECTIONNAME.
+ *
+ * @return  Returns a new zoomChain application.
+ */
+extern zoomChain_t
+zoomChain_newFromIni(parse_ini_t ini, const char *sectionName);
+
+
+/**
+ * @brief  Prints the stages of the chain.
+ *
+ * @param[in]      chain
+ *                    The application to print.
+ * @param[in,out]  *out
+ *                    The stream to write to.
+ *
+ * @return  Returns nothing.
+ */
+extern void
+zoomChain_printSummary(const zoomChain_t chain, FILE *out);
+
+
+/**
+ * @brief  Sets whether stages are run even if their manifest says that
+ *         their outputs are current.
+ *
+ * @param[in,out]  chain
+ *                    The application to change.
+ * @param[in]      forceRun
+ *                    If @c true, all stages are run, the default is
+ *                    @c false.
+ *
+ * @return  Returns nothing.
+ */
+extern void
+zoomChain_setForceRun(zoomChain_t chain, bool forceRun);
+
+
+/**
+ * @brief  Executes all stages of the chain in order.
+ *
+ * A stage is skipped if its manifest matches the current inputs and its
+ * outputs are intact, see @ref toolsZoomChainManifest.  After a stage
+ * ran, its manifest is (re)written with the files it wrote.
+ *
+ * @param[in,out]  chain
+ *                    The application to execute.
+ *
+ * @return  Returns nothing.
+ */
+extern void
+zoomChain_run(zoomChain_t chain);
+
+
+/**
+ * @brief  Deletes a zoomChain application and frees the associated
+ *         memory.
+ *
+ * @param[in,out]  *chain
+ *                    The application to delete, will be set to @c NULL.
+ *
+ * @return  Returns nothing.
+ */
+extern void
+zoomChain_del(zoomChain_t *chain);
+
+
+/*--- Doxygen group definitions -----------------------------------------*/
+
+/**
+ * @defgroup toolsZoomChain zoomChain
+ * @ingroup  tools
+ * @brief  Runs the whole tool chain for (zoomed) initial conditions in
+ *         one job.
+ *
+ * The stages are the applications of makeMask, ginnungagap,
+ * realSpaceConstraints, refineGrid, generateICs and ginnungagapICs, each
+ * set up from its own ini file exactly as for the separate tools.  Running
+ * them in one process initialises MPI and the threaded FFTW once, and a
+ * ginnungagapICs stage hands the velocities to generateICs in memory.
+ * Likewise, the grids written by a ginnungagap stage are kept in memory
+ * if a later realSpaceConstraints or refineGrid stage lists them in its
+ * inputs, and that stage reads them from there instead of from the file
+ * (see @ref toolsZoomChainStore).  The files are written nonetheless.
+ *
+ * Every stage with outputs keeps a manifest next to its ini file and is
+ * skipped when neither the ini file nor its inputs changed since.  The
+ * outputs of ginnungagap, realSpaceConstraints and refineGrid are recorded
+ * from their writers, the other tools must list them.  The inputs are the
+ * listed input files or, if none are given, everything the previous stage
+ * depended on.  Use @c --force to run all stages regardless.
+ *
+ * @section toolsZoomChainIni Ini Format
+ *
+ * @code
+ * [ZoomChain]
+ * numStages = 3
+ * stages = wn64 rsc128 ics128
+ * # optional, false reads all grids from their files
+ * keepGridsInMemory = true
+ * # optional, false trusts size and mtime of files instead of hashing
+ * hashContent = true
+ *
+ * [wn64]
+ * tool = ginnungagap
+ * iniFile = ggp_64.ini
+ *
+ * [rsc128]
+ * tool = realSpaceConstraints
+ * iniFile = rsc_128.ini
+ * # optional, defaults to depending on all earlier stages
+ * numInputs = 1
+ * inputs = wn_64_delta.bov
+ *
+ * [ics128]
+ * # ginnungagap and generateICs in one, without intermediate files.
+ * tool = ginnungagapICs
+ * iniFile = ics_128.ini
+ * # optional, the section of makeMask, generateICs or ginnungagapICs
+ * section = GenerateICs
+ * # optional for the tools that record their outputs, enables skipping
+ * numOutputs = 1
+ * outputs = ics_128.0
+ * @endcode
+ */
+
+
+#endif
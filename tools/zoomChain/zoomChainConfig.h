@@ -0,0 +1,37 @@
+// Copyright (C) 2013, Steffen Knollmann
+// Released under the terms of the GNU General Public License version 3.
+// This file is part of `ginnungagap'.
+
+#ifndef ZOOMCHAINCONFIG_H
+#define ZOOMCHAINCONFIG_H
+
+
+/*--- Doxygen file description ------------------------------------------*/
+
+/**
+ * @file zoomChain/zoomChainConfig.h
+ * @ingroup  toolsZoomChainConfig
+ * @brief  Provides code configuration for zoomChain.
+ */
+
+
+/*--- Includes ----------------------------------------------------------*/
+#include "../../config.h"
+
+
+/*--- Defines -----------------------------------------------------------*/
+
+/** @brief  Gives the default section name for the setup from ini files. */
+#define ZOOMCHAINCONFIG_DEFAULT_SECTIONNAME "ZoomChain"
+
+
+/*--- Doxygen group definitions -----------------------------------------*/
+
+/**
+ * @defgroup toolsZoomChainConfig Code Configuration
+ * @ingroup  toolsZoomChain
+ * @brief  Provides the code configuration.
+ */
+
+
+#endif
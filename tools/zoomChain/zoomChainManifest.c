@@ -0,0 +1,504 @@
+// Copyright (C) 2013, Steffen Knollmann
+// Released under the terms of the GNU General Public License version 3.
+// This file is part of `ginnungagap'.
+
+
+/*--- Doxygen file description ------------------------------------------*/
+
+/**
+ * @file zoomChain/zoomChainManifest.c
+ * @ingroup  toolsZoomChainManifest
+ * @brief  Provides the implementation of the manifests of the stages.
+ */
+
+
+/*--- Includes ----------------------------------------------------------*/
+#include "zoomChainConfig.h"
+#include "zoomChainManifest.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include <assert.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+#include "../../src/libutil/xmem.h"
+#include "../../src/libutil/xstring.h"
+#include "../../src/libutil/xfile.h"
+
+
+/*--- Implemention of main structure ------------------------------------*/
+
+/** @brief  Describes one output of a stage. */
+struct local_output_struct {
+	/** @brief  The name of the file. */
+	char     *fileName;
+	/** @brief  The size of the file in bytes. */
+	uint64_t size;
+	/** @brief  The modification time of the file. */
+	int64_t  mtime;
+	/** @brief  The hash of the content, or of size and modification time
+	 *          if the content is not hashed. */
+	uint64_t hash;
+	/** @brief  Whether @c size, @c mtime and @c hash are known. */
+	bool     isKnown;
+};
+
+/** @brief  The main structure of a manifest. */
+struct zoomChainManifest_struct {
+	/** @brief  The name of the stage. */
+	char                       *stageName;
+	/** @brief  Whether files are hashed by their content. */
+	bool                       hashContent;
+	/** @brief  The combined hash of all inputs. */
+	uint64_t                   inputHash;
+	/** @brief  The number of outputs. */
+	uint32_t                   numOutputs;
+	/** @brief  The outputs. */
+	struct local_output_struct *outputs;
+};
+
+
+/*--- Local defines -----------------------------------------------------*/
+
+/** @brief  The offset basis of the 64bit FNV-1a hash. */
+#define LOCAL_HASH_INIT UINT64_C(14695981039346656037)
+
+/** @brief  The prime of the 64bit FNV-1a hash. */
+#define LOCAL_HASH_PRIME UINT64_C(1099511628211)
+
+/** @brief  The number of bytes read at once when hashing a file. */
+#define LOCAL_CHUNK_SIZE (1 << 20)
+
+/** @brief  The first line of a manifest file. */
+#define LOCAL_MAGIC "# zoomChain manifest 2"
+
+
+/*--- Prototypes of local functions -------------------------------------*/
+static uint64_t
+local_hashBytes(uint64_t hash, const void *data, size_t numBytes);
+
+static uint64_t
+local_hashUint64(uint64_t hash, uint64_t value);
+
+static bool
+local_hashFile(const char *fileName, uint64_t *hash);
+
+static bool
+local_getFileHash(const char *fileName,
+                  bool       hashContent,
+                  uint64_t   *size,
+                  int64_t    *mtime,
+                  uint64_t   *hash);
+
+static int64_t
+local_findOutput(const zoomChainManifest_t manifest, const char *fileName);
+
+static bool
+local_statFile(const char *fileName, uint64_t *size, int64_t *mtime);
+
+static bool
+local_outputIsIntact(const struct local_output_struct *recorded,
+                     bool                             hashContent);
+
+
+/*--- Implementations of exported functions -----------------------------*/
+extern zoomChainManifest_t
+zoomChainManifest_new(const char *stageName, bool hashContent)
+{
+	zoomChainManifest_t manifest;
+
+	assert(stageName != NULL);
+
+	manifest              = xmalloc(sizeof(struct zoomChainManifest_struct));
+	manifest->stageName   = xstrdup(stageName);
+	manifest->hashContent = hashContent;
+	// Hashes of the two modes are not comparable, switching reruns.
+	manifest->inputHash   = local_hashUint64(LOCAL_HASH_INIT,
+	                                         hashContent ? 1 : 0);
+	manifest->numOutputs  = 0;
+	manifest->outputs     = NULL;
+
+	return manifest;
+}
+
+extern void
+zoomChainManifest_del(zoomChainManifest_t *manifest)
+{
+	assert(manifest != NULL && *manifest != NULL);
+
+	for (uint32_t i = 0; i < (*manifest)->numOutputs; i++)
+		xfree((*manifest)->outputs[i].fileName);
+	if ((*manifest)->outputs != NULL)
+		xfree((*manifest)->outputs);
+	xfree((*manifest)->stageName);
+	xfree(*manifest);
+
+	*manifest = NULL;
+}
+
+extern void
+zoomChainManifest_addInputString(zoomChainManifest_t manifest,
+                                 const char          *str)
+{
+	assert(manifest != NULL);
+
+	if (str == NULL) {
+		manifest->inputHash = local_hashUint64(manifest->inputHash, 0);
+	} else {
+		// The terminating '\0' separates consecutive strings.
+		manifest->inputHash = local_hashUint64(manifest->inputHash, 1);
+		manifest->inputHash = local_hashBytes(manifest->inputHash, str,
+		                                      strlen(str) + 1);
+	}
+}
+
+extern void
+zoomChainManifest_addInputHash(zoomChainManifest_t manifest, uint64_t hash)
+{
+	assert(manifest != NULL);
+
+	manifest->inputHash = local_hashUint64(manifest->inputHash, hash);
+}
+
+extern bool
+zoomChainManifest_addInputFile(zoomChainManifest_t manifest,
+                               const char          *fileName)
+{
+	uint64_t hash, size;
+	int64_t  mtime;
+
+	assert(manifest != NULL);
+	assert(fileName != NULL);
+
+	if (!local_getFileHash(fileName, manifest->hashContent, &size, &mtime,
+	                       &hash))
+		return false;
+
+	zoomChainManifest_addInputString(manifest, fileName);
+	zoomChainManifest_addInputHash(manifest, hash);
+
+	return true;
+}
+
+extern bool
+zoomChainManifest_addInputFileContent(zoomChainManifest_t manifest,
+                                      const char          *fileName)
+{
+	uint64_t hash;
+
+	assert(manifest != NULL);
+	assert(fileName != NULL);
+
+	if (!local_hashFile(fileName, &hash))
+		return false;
+
+	zoomChainManifest_addInputString(manifest, fileName);
+	zoomChainManifest_addInputHash(manifest, hash);
+
+	return true;
+}
+
+extern void
+zoomChainManifest_addOutput(zoomChainManifest_t manifest,
+                            const char          *fileName)
+{
+	struct local_output_struct *output;
+
+	assert(manifest != NULL);
+	assert(fileName != NULL);
+
+	if (local_findOutput(manifest, fileName) >= 0)
+		return;
+
+	manifest->outputs = xrealloc(manifest->outputs,
+	                             sizeof(struct local_output_struct)
+	                             * (manifest->numOutputs + 1));
+	output           = manifest->outputs + manifest->numOutputs;
+	output->fileName = xstrdup(fileName);
+	output->size     = 0;
+	output->mtime    = 0;
+	output->hash     = 0;
+	output->isKnown  = false;
+	manifest->numOutputs++;
+}
+
+extern uint32_t
+zoomChainManifest_getNumOutputs(const zoomChainManifest_t manifest)
+{
+	assert(manifest != NULL);
+
+	return manifest->numOutputs;
+}
+
+extern uint64_t
+zoomChainManifest_getInputHash(const zoomChainManifest_t manifest)
+{
+	assert(manifest != NULL);
+
+	return manifest->inputHash;
+}
+
+extern bool
+zoomChainManifest_hasOutput(const zoomChainManifest_t manifest,
+                            const char                *fileName)
+{
+	assert(manifest != NULL);
+	assert(fileName != NULL);
+
+	return local_findOutput(manifest, fileName) >= 0;
+}
+
+extern bool
+zoomChainManifest_getOutputHash(const zoomChainManifest_t manifest,
+                                const char                *fileName,
+                                uint64_t                  *hash)
+{
+	int64_t idx;
+
+	assert(manifest != NULL);
+	assert(fileName != NULL);
+	assert(hash != NULL);
+
+	idx = local_findOutput(manifest, fileName);
+	if ((idx < 0) || !manifest->outputs[idx].isKnown)
+		return false;
+
+	*hash = manifest->outputs[idx].hash;
+
+	return true;
+}
+
+extern bool
+zoomChainManifest_isUpToDate(zoomChainManifest_t manifest,
+                             const char          *manifestName)
+{
+	FILE                       *f;
+	char                       line[1024];
+	char                       fileName[1024];
+	uint64_t                   inputHash;
+	uint32_t                   numOutputs;
+	struct local_output_struct *recorded;
+	bool                       isUpToDate = true;
+
+	assert(manifest != NULL);
+	assert(manifestName != NULL);
+
+	f = fopen(manifestName, "r");
+	if (f == NULL)
+		return false;
+
+	if ((fgets(line, sizeof(line), f) == NULL)
+	    || (strncmp(line, LOCAL_MAGIC, strlen(LOCAL_MAGIC)) != 0)
+	    || (fgets(line, sizeof(line), f) == NULL)
+	    || (fscanf(f, "inputHash %" SCNx64 "\n", &inputHash) != 1)
+	    || (fscanf(f, "numOutputs %" SCNu32 "\n", &numOutputs) != 1)
+	    || (inputHash != manifest->inputHash)
+	    || (numOutputs == 0)) {
+		fclose(f);
+		return false;
+	}
+
+	// The recorded outputs are those the last run wrote, the ones known
+	// beforehand (if any) must be among them.
+	recorded = xmalloc(sizeof(struct local_output_struct) * numOutputs);
+	for (uint32_t i = 0; i < numOutputs; i++)
+		recorded[i].fileName = NULL;
+	for (uint32_t i = 0; i < numOutputs && isUpToDate; i++) {
+		if (fscanf(f, "output %" SCNu64 " %" SCNd64 " %" SCNx64 " %1023s\n",
+		           &(recorded[i].size), &(recorded[i].mtime),
+		           &(recorded[i].hash), fileName) != 4) {
+			isUpToDate = false;
+			break;
+		}
+		recorded[i].fileName = xstrdup(fileName);
+		isUpToDate           = local_outputIsIntact(recorded + i,
+		                                            manifest->hashContent);
+	}
+	fclose(f);
+
+	for (uint32_t i = 0; i < manifest->numOutputs && isUpToDate; i++) {
+		bool isRecorded = false;
+
+		for (uint32_t j = 0; j < numOutputs && !isRecorded; j++)
+			isRecorded = (strcmp(manifest->outputs[i].fileName,
+			                     recorded[j].fileName) == 0);
+		isUpToDate = isRecorded;
+	}
+
+	if (isUpToDate) {
+		for (uint32_t i = 0; i < manifest->numOutputs; i++)
+			xfree(manifest->outputs[i].fileName);
+		if (manifest->outputs != NULL)
+			xfree(manifest->outputs);
+		manifest->numOutputs = numOutputs;
+		manifest->outputs    = recorded;
+		for (uint32_t i = 0; i < numOutputs; i++)
+			manifest->outputs[i].isKnown = true;
+	} else {
+		for (uint32_t i = 0; i < numOutputs; i++) {
+			if (recorded[i].fileName != NULL)
+				xfree(recorded[i].fileName);
+		}
+		xfree(recorded);
+	}
+
+	return isUpToDate;
+} // zoomChainManifest_isUpToDate
+
+extern void
+zoomChainManifest_write(zoomChainManifest_t manifest,
+                        const char          *manifestName)
+{
+	FILE *f;
+
+	assert(manifest != NULL);
+	assert(manifestName != NULL);
+
+	for (uint32_t i = 0; i < manifest->numOutputs; i++) {
+		struct local_output_struct *output = manifest->outputs + i;
+
+		output->isKnown = local_getFileHash(output->fileName,
+		                                    manifest->hashContent,
+		                                    &(output->size),
+		                                    &(output->mtime),
+		                                    &(output->hash));
+		if (!output->isKnown) {
+			fprintf(stderr, "WARNING:  Stage %s did not produce %s, not "
+			        "writing %s.\n", manifest->stageName,
+			        output->fileName, manifestName);
+			return;
+		}
+	}
+
+	f = xfopen(manifestName, "w");
+	fprintf(f, "%s\n", LOCAL_MAGIC);
+	fprintf(f, "stage %s\n", manifest->stageName);
+	fprintf(f, "inputHash %016" PRIx64 "\n", manifest->inputHash);
+	fprintf(f, "numOutputs %" PRIu32 "\n", manifest->numOutputs);
+	for (uint32_t i = 0; i < manifest->numOutputs; i++) {
+		const struct local_output_struct *output = manifest->outputs + i;
+
+		fprintf(f, "output %" PRIu64 " %" PRId64 " %016" PRIx64 " %s\n",
+		        output->size, output->mtime, output->hash,
+		        output->fileName);
+	}
+	xfclose(&f);
+}
+
+/*--- Implementations of local functions --------------------------------*/
+static uint64_t
+local_hashBytes(uint64_t hash, const void *data, size_t numBytes)
+{
+	const unsigned char *bytes = data;
+
+	for (size_t i = 0; i < numBytes; i++) {
+		hash ^= (uint64_t)(bytes[i]);
+		hash *= LOCAL_HASH_PRIME;
+	}
+
+	return hash;
+}
+
+static uint64_t
+local_hashUint64(uint64_t hash, uint64_t value)
+{
+	unsigned char bytes[8];
+
+	// Fixed byte order, so the hash does not depend on the machine.
+	for (int i = 0; i < 8; i++)
+		bytes[i] = (unsigned char)((value >> (8 * i)) & 0xff);
+
+	return local_hashBytes(hash, bytes, 8);
+}
+
+static bool
+local_hashFile(const char *fileName, uint64_t *hash)
+{
+	FILE          *f;
+	unsigned char *buffer;
+	size_t        numRead;
+
+	f = fopen(fileName, "rb");
+	if (f == NULL)
+		return false;
+
+	buffer = xmalloc(LOCAL_CHUNK_SIZE);
+	*hash  = LOCAL_HASH_INIT;
+	while ((numRead = fread(buffer, 1, LOCAL_CHUNK_SIZE, f)) > 0)
+		*hash = local_hashBytes(*hash, buffer, numRead);
+	xfree(buffer);
+
+	if (ferror(f)) {
+		fclose(f);
+		return false;
+	}
+	fclose(f);
+
+	return true;
+}
+
+static bool
+local_getFileHash(const char *fileName,
+                  bool       hashContent,
+                  uint64_t   *size,
+                  int64_t    *mtime,
+                  uint64_t   *hash)
+{
+	if (!local_statFile(fileName, size, mtime))
+		return false;
+
+	if (hashContent)
+		return local_hashFile(fileName, hash);
+
+	// Without reading the file, size and modification time stand in for
+	// the content.
+	*hash = local_hashUint64(LOCAL_HASH_INIT, *size);
+	*hash = local_hashUint64(*hash, (uint64_t)(*mtime));
+
+	return true;
+}
+
+static int64_t
+local_findOutput(const zoomChainManifest_t manifest, const char *fileName)
+{
+	for (uint32_t i = 0; i < manifest->numOutputs; i++) {
+		if (strcmp(manifest->outputs[i].fileName, fileName) == 0)
+			return (int64_t)i;
+	}
+
+	return -1;
+}
+
+static bool
+local_statFile(const char *fileName, uint64_t *size, int64_t *mtime)
+{
+	struct stat info;
+
+	if (stat(fileName, &info) != 0)
+		return false;
+
+	*size  = (uint64_t)(info.st_size);
+	*mtime = (int64_t)(info.st_mtime);
+
+	return true;
+}
+
+static bool
+local_outputIsIntact(const struct local_output_struct *recorded,
+                     bool                             hashContent)
+{
+	uint64_t size, hash;
+	int64_t  mtime;
+
+	if (!local_statFile(recorded->fileName, &size, &mtime))
+		return false;
+	if (size != recorded->size)
+		return false;
+	if (mtime == recorded->mtime)
+		return true;
+
+	// The file has been touched, only its content counts, if it is known.
+	return hashContent && local_hashFile(recorded->fileName, &hash)
+	       && (hash == recorded->hash);
+}
@@ -0,0 +1,292 @@
+// Copyright (C) 2013, Steffen Knollmann
+// Released under the terms of the GNU General Public License version 3.
+// This file is part of `ginnungagap'.
+
+#ifndef ZOOMCHAINMANIFEST_H
+#define ZOOMCHAINMANIFEST_H
+
+
+/*--- Doxygen file description ------------------------------------------*/
+
+/**
+ * @file zoomChain/zoomChainManifest.h
+ * @ingroup  toolsZoomChainManifest
+ * @brief  Provides the interface to the manifests of the stages.
+ */
+
+
+/*--- Includes ----------------------------------------------------------*/
+#include "zoomChainConfig.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+
+/*--- ADT handle --------------------------------------------------------*/
+
+/** @brief  Provides a handle for a manifest. */
+typedef struct zoomChainManifest_struct *zoomChainManifest_t;
+
+
+/*--- Prototypes of exported functions ----------------------------------*/
+
+/**
+ * @name  Creating and Deleting
+ *
+ * @{
+ */
+
+/**
+ * @brief  Creates a new manifest for a stage.
+ *
+ * @param[in]  *stageName
+ *                The name of the stage, it is recorded but not hashed.
+ * @param[in]  hashContent
+ *                If @c true, input and output files are identified by the
+ *                hash of their content.  Otherwise only their size and
+ *                modification time are used, which does not require
+ *                reading them.
+ *
+ * @return  Returns a new manifest without inputs and outputs.
+ */
+extern zoomChainManifest_t
+zoomChainManifest_new(const char *stageName, bool hashContent);
+
+
+/**
+ * @brief  Deletes a manifest and frees the associated memory.
+ *
+ * @param[in,out]  *manifest
+ *                    The manifest to delete, will be set to @c NULL.
+ *
+ * @return  Returns nothing.
+ */
+extern void
+zoomChainManifest_del(zoomChainManifest_t *manifest);
+
+
+/** @} */
+
+/**
+ * @name  Describing the Stage
+ *
+ * @{
+ */
+
+/**
+ * @brief  Adds a string to the inputs of the stage.
+ *
+ * @param[in,out]  manifest
+ *                    The manifest to work with.
+ * @param[in]      *str
+ *                    The string to add, @c NULL is treated as an empty
+ *                    string that differs from "".
+ *
+ * @return  Returns nothing.
+ */
+extern void
+zoomChainManifest_addInputString(zoomChainManifest_t manifest,
+                                 const char          *str);
+
+
+/**
+ * @brief  Adds a hash (e.g. of an output of an earlier stage) to the
+ *         inputs of the stage.
+ *
+ * @param[in,out]  manifest
+ *                    The manifest to work with.
+ * @param[in]      hash
+ *                    The hash to add.
+ *
+ * @return  Returns nothing.
+ */
+extern void
+zoomChainManifest_addInputHash(zoomChainManifest_t manifest, uint64_t hash);
+
+
+/**
+ * @brief  Adds a file to the inputs of the stage.
+ *
+ * The file is identified by its content or by its size and modification
+ * time, as chosen with zoomChainManifest_new().
+ *
+ * @param[in,out]  manifest
+ *                    The manifest to work with.
+ * @param[in]      *fileName
+ *                    The file to add.
+ *
+ * @return  Returns @c true if the file could be accessed and @c false if
+ *          not, in which case the inputs are left unchanged.
+ */
+extern bool
+zoomChainManifest_addInputFile(zoomChainManifest_t manifest,
+                               const char          *fileName);
+
+
+/**
+ * @brief  Adds the content of a file to the inputs of the stage.
+ *
+ * Meant for small files, like ini files, whose content always counts.
+ *
+ * @param[in,out]  manifest
+ *                    The manifest to work with.
+ * @param[in]      *fileName
+ *                    The file to add.
+ *
+ * @return  Returns @c true if the file could be read and @c false if not,
+ *          in which case the inputs are left unchanged.
+ */
+extern bool
+zoomChainManifest_addInputFileContent(zoomChainManifest_t manifest,
+                                      const char          *fileName);
+
+
+/**
+ * @brief  Adds a file to the outputs of the stage.
+ *
+ * Files that are already outputs are not added again.
+ *
+ * @param[in,out]  manifest
+ *                    The manifest to work with.
+ * @param[in]      *fileName
+ *                    The name of the output file.
+ *
+ * @return  Returns nothing.
+ */
+extern void
+zoomChainManifest_addOutput(zoomChainManifest_t manifest,
+                            const char          *fileName);
+
+
+/** @} */
+
+/**
+ * @name  Using
+ *
+ * @{
+ */
+
+/**
+ * @brief  Retrieves the number of outputs.
+ *
+ * @param[in]  manifest
+ *                The manifest to query.
+ *
+ * @return  Returns the number of outputs.
+ */
+extern uint32_t
+zoomChainManifest_getNumOutputs(const zoomChainManifest_t manifest);
+
+
+/**
+ * @brief  Retrieves the combined hash of all inputs.
+ *
+ * @param[in]  manifest
+ *                The manifest to query.
+ *
+ * @return  Returns the hash.
+ */
+extern uint64_t
+zoomChainManifest_getInputHash(const zoomChainManifest_t manifest);
+
+
+/**
+ * @brief  Checks whether a file is an output of the stage.
+ *
+ * @param[in]  manifest
+ *                The manifest to query.
+ * @param[in]  *fileName
+ *                The file to look for.
+ *
+ * @return  Returns @c true if the file is an output.
+ */
+extern bool
+zoomChainManifest_hasOutput(const zoomChainManifest_t manifest,
+                            const char                *fileName);
+
+
+/**
+ * @brief  Retrieves the hash of an output.
+ *
+ * The hashes are only known after zoomChainManifest_write() or a
+ * successful zoomChainManifest_isUpToDate().  Without content hashing,
+ * the hash only covers size and modification time.
+ *
+ * @param[in]   manifest
+ *                 The manifest to query.
+ * @param[in]   *fileName
+ *                 The output to look for.
+ * @param[out]  *hash
+ *                 Receives the hash.
+ *
+ * @return  Returns @c true if the file is a known output with a hash.
+ */
+extern bool
+zoomChainManifest_getOutputHash(const zoomChainManifest_t manifest,
+                                const char                *fileName,
+                                uint64_t                  *hash);
+
+
+/**
+ * @brief  Checks whether a manifest file describes the current stage and
+ *         its outputs are still intact.
+ *
+ * The inputs hash must match and the outputs already added to @c manifest
+ * must be among the recorded ones.  A recorded output whose size and
+ * modification time are unchanged is trusted.  If only the modification
+ * time changed, the content is hashed again and compared when content
+ * hashing is enabled, otherwise the output counts as changed.
+ *
+ * @param[in,out]  manifest
+ *                    The manifest of the current stage, its outputs are
+ *                    replaced by the recorded ones if the file matches.
+ * @param[in]      *manifestName
+ *                    The manifest file to compare with.
+ *
+ * @return  Returns @c true if the stage does not need to be run again.
+ */
+extern bool
+zoomChainManifest_isUpToDate(zoomChainManifest_t manifest,
+                             const char          *manifestName);
+
+
+/**
+ * @brief  Hashes the outputs and writes the manifest file.
+ *
+ * @param[in,out]  manifest
+ *                    The manifest to write.
+ * @param[in]      *manifestName
+ *                    The name of the manifest file.
+ *
+ * @return  Returns nothing.
+ */
+extern void
+zoomChainManifest_write(zoomChainManifest_t manifest,
+                        const char          *manifestName);
+
+
+/** @} */
+
+
+/*--- Doxygen group definitions -----------------------------------------*/
+
+/**
+ * @defgroup toolsZoomChainManifest Stage Manifests
+ * @ingroup  toolsZoomChain
+ * @brief  Records which inputs produced the outputs of a stage.
+ *
+ * A manifest is a small text file holding the hash of everything a stage
+ * depends on (its tool, section and ini file, and its input files)
+ * together with the size, modification time and hash of every output.  If
+ * the manifest of a stage still matches, the stage is skipped.
+ *
+ * By default, files are identified by the hash of their content.  Size and
+ * modification time only serve as a fast check: an output whose size and
+ * time stamp are unchanged is not read again.  Without content hashing,
+ * size and modification time (to the second) identify the files, which
+ * avoids reading them but misses files rewritten within the same second.
+ * The hashes are 64bit FNV-1a hashes, they protect against accidental
+ * changes, not against deliberate collisions.
+ */
+
+
+#endif
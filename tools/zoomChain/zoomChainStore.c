@@ -0,0 +1,808 @@
+// Copyright (C) 2013, Steffen Knollmann
+// Released under the terms of the GNU General Public License version 3.
+// This file is part of `ginnungagap'.
+
+
+/*--- Doxygen file description ------------------------------------------*/
+
+/**
+ * @file zoomChain/zoomChainStore.c
+ * @ingroup  toolsZoomChainStore
+ * @brief  Implements the in-memory grid store of the chain.
+ */
+
+
+/*--- Includes ----------------------------------------------------------*/
+#include "zoomChainConfig.h"
+#include "zoomChainStore.h"
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <limits.h>
+#include <assert.h>
+#ifdef WITH_MPI
+#  include <mpi.h>
+#  include "../../src/libutil/commScheme.h"
+#  include "../../src/libutil/commSchemeBuffer.h"
+#endif
+#include "../../src/libgrid/gridRegular.h"
+#include "../../src/libgrid/gridPatch.h"
+#include "../../src/libgrid/gridPoint.h"
+#include "../../src/libdata/dataVar.h"
+#include "../../src/libutil/filename.h"
+#include "../../src/libutil/xmem.h"
+#include "../../src/libutil/xstring.h"
+
+
+/*--- Implemention of main structure ------------------------------------*/
+#include "../../src/libgrid/gridWriter_adt.h"
+#include "../../src/libgrid/gridReader_adt.h"
+#ifdef WITH_HDF5
+#  include "../../src/libgrid/gridWriterHDF5.h"
+#  include "../../src/libgrid/gridWriterHDF5_adt.h"
+#endif
+
+/** @brief  Describes one wanted file. */
+struct zoomChainStore_entry_struct {
+	/** @brief  The full name of the file. */
+	char        *fileName;
+	/** @brief  The number of stages that still read the file. */
+	uint32_t    numUses;
+	/** @brief  The variable of the kept grid, @c NULL if none is kept. */
+	dataVar_t   var;
+	/** @brief  The local part of the kept grid, @c NULL if none is kept. */
+	gridPatch_t patch;
+};
+
+/** @brief  The main structure of the grid store. */
+struct zoomChainStore_struct {
+	/** @brief  The number of wanted files. */
+	uint32_t                           numEntries;
+	/** @brief  The wanted files. */
+	struct zoomChainStore_entry_struct *entries;
+	/** @brief  The number of files written since the last clearing. */
+	uint32_t                           numWritten;
+	/** @brief  The full names of the files written. */
+	char                               **written;
+	/** @brief  The number of ranks. */
+	int                                size;
+	/** @brief  The rank of this process. */
+	int                                rank;
+#ifdef WITH_MPI
+	/** @brief  The communicator of the reading stages. */
+	MPI_Comm                           comm;
+#endif
+};
+
+/** @brief  A writer passing everything on and filling the store. */
+struct zoomChainStore_writer_struct {
+	/** @brief  The base structure. */
+	struct gridWriter_struct base;
+	/** @brief  The store to fill. */
+	zoomChainStore_t         store;
+	/** @brief  The writer that writes the files. */
+	gridWriter_t             writer;
+};
+
+/** @brief  A reader serving from the store if it can. */
+struct zoomChainStore_reader_struct {
+	/** @brief  The base structure. */
+	struct gridReader_struct base;
+	/** @brief  The store to read from. */
+	zoomChainStore_t         store;
+	/** @brief  The reader for the files not in the store. */
+	gridReader_t             reader;
+};
+
+
+/*--- Local defines -----------------------------------------------------*/
+
+/** @brief  The tag used for the redistribution. */
+#define LOCAL_TAG 4712
+
+/** @brief  The number of entries describing a box (@c idxLo, @c idxHi). */
+#define LOCAL_BOXSIZE (2 * NDIM)
+
+
+/*--- Prototypes of local functions -------------------------------------*/
+static struct zoomChainStore_entry_struct *
+local_findEntry(const zoomChainStore_t store, const char *fileName);
+
+static void
+local_dropGrid(struct zoomChainStore_entry_struct *entry);
+
+static void
+local_recordWritten(zoomChainStore_t store, const char *fileName);
+
+static void
+local_keepGrid(zoomChainStore_t store,
+               gridWriter_t     writer,
+               const char       *fileName,
+               gridRegular_t    grid);
+
+static bool
+local_writesRegion(const gridWriter_t writer);
+
+static bool
+local_readFromStore(zoomChainStore_t                         store,
+                    const struct zoomChainStore_entry_struct *entry,
+                    gridPatch_t                              patch,
+                    int                                      idxOfVar);
+
+static bool
+local_isSameType(const dataVar_t var, const dataVar_t other);
+
+static void
+local_getBox(const gridPatch_t patch, uint32_t *box);
+
+static uint64_t
+local_getOverlap(const uint32_t    *boxA,
+                 const uint32_t    *boxB,
+                 gridPointUint32_t idxLo,
+                 gridPointUint32_t idxHi);
+
+static void
+local_copyWindow(gridPatch_t             patch,
+                 int                     idxOfVar,
+                 const gridPointUint32_t idxLo,
+                 const gridPointUint32_t idxHi,
+                 void                    *buffer,
+                 bool                    intoPatch);
+
+static bool
+local_allRanksAgree(const zoomChainStore_t store, bool value);
+
+static void
+local_writerDel(gridWriter_t *writer);
+
+static void
+local_writerActivate(gridWriter_t writer);
+
+static void
+local_writerDeactivate(gridWriter_t writer);
+
+static void
+local_writerWriteGridPatch(gridWriter_t   writer,
+                           gridPatch_t    patch,
+                           const char     *patchName,
+                           gridPointDbl_t origin,
+                           gridPointDbl_t delta);
+
+static void
+local_writerWriteGridRegular(gridWriter_t writer, gridRegular_t grid);
+
+#ifdef WITH_MPI
+static void
+local_writerInitParallel(gridWriter_t writer, MPI_Comm mpiComm);
+
+#endif
+
+static void
+local_readerDel(gridReader_t *reader);
+
+static void
+local_readerReadIntoPatch(gridReader_t reader, gridPatch_t patch);
+
+static void
+local_readerReadIntoPatchForVar(gridReader_t reader,
+                                gridPatch_t  patch,
+                                int          idxOfVar);
+
+static void
+local_readerHandleFilenameChange(gridReader_t reader);
+
+
+/*--- Local variables ---------------------------------------------------*/
+
+/** @brief  The function table of the writers. */
+static struct gridWriter_func_struct local_writerFunc
+    = {.del              = &local_writerDel,
+       .activate         = &local_writerActivate,
+       .deactivate       = &local_writerDeactivate,
+       .writeGridPatch   = &local_writerWriteGridPatch,
+       .writeGridRegular = &local_writerWriteGridRegular,
+#ifdef WITH_MPI
+       .initParallel     = &local_writerInitParallel
+#endif
+	};
+
+/** @brief  The function table of the readers. */
+static struct gridReader_func_struct local_readerFunc
+    = {.del                 = &local_readerDel,
+       .readIntoPatch       = &local_readerReadIntoPatch,
+       .readIntoPatchForVar = &local_readerReadIntoPatchForVar};
+
+
+/*--- Implementations of exported functions -----------------------------*/
+extern zoomChainStore_t
+zoomChainStore_new(void)
+{
+	zoomChainStore_t store;
+
+	store             = xmalloc(sizeof(struct zoomChainStore_struct));
+	store->numEntries = 0;
+	store->entries    = NULL;
+	store->numWritten = 0;
+	store->written    = NULL;
+	store->size       = 1;
+	store->rank       = 0;
+#ifdef WITH_MPI
+	store->comm = MPI_COMM_WORLD;
+	MPI_Comm_size(store->comm, &(store->size));
+	MPI_Comm_rank(store->comm, &(store->rank));
+#endif
+
+	return store;
+}
+
+extern void
+zoomChainStore_del(zoomChainStore_t *store)
+{
+	assert(store != NULL && *store != NULL);
+
+	for (uint32_t i = 0; i < (*store)->numEntries; i++) {
+		local_dropGrid((*store)->entries + i);
+		xfree((*store)->entries[i].fileName);
+	}
+	if ((*store)->entries != NULL)
+		xfree((*store)->entries);
+	zoomChainStore_clearWritten(*store);
+	xfree(*store);
+
+	*store = NULL;
+}
+
+extern void
+zoomChainStore_addUse(zoomChainStore_t store, const char *fileName)
+{
+	struct zoomChainStore_entry_struct *entry;
+
+	assert(store != NULL);
+	assert(fileName != NULL);
+
+	entry = local_findEntry(store, fileName);
+	if (entry == NULL) {
+		store->entries = xrealloc(store->entries,
+		                          sizeof(struct zoomChainStore_entry_struct)
+		                          * (store->numEntries + 1));
+		entry           = store->entries + store->numEntries;
+		entry->fileName = xstrdup(fileName);
+		entry->numUses  = 0;
+		entry->var      = NULL;
+		entry->patch    = NULL;
+		store->numEntries++;
+	}
+	entry->numUses++;
+}
+
+extern void
+zoomChainStore_release(zoomChainStore_t store, const char *fileName)
+{
+	struct zoomChainStore_entry_struct *entry;
+
+	assert(store != NULL);
+	assert(fileName != NULL);
+
+	entry = local_findEntry(store, fileName);
+	if ((entry == NULL) || (entry->numUses == 0))
+		return;
+
+	entry->numUses--;
+	if (entry->numUses == 0)
+		local_dropGrid(entry);
+}
+
+extern uint32_t
+zoomChainStore_getNumWritten(const zoomChainStore_t store)
+{
+	assert(store != NULL);
+
+	return store->numWritten;
+}
+
+extern const char *
+zoomChainStore_getWritten(const zoomChainStore_t store, uint32_t idx)
+{
+	assert(store != NULL);
+	assert(idx < store->numWritten);
+
+	return store->written[idx];
+}
+
+extern void
+zoomChainStore_clearWritten(zoomChainStore_t store)
+{
+	assert(store != NULL);
+
+	for (uint32_t i = 0; i < store->numWritten; i++)
+		xfree(store->written[i]);
+	if (store->written != NULL)
+		xfree(store->written);
+	store->numWritten = 0;
+	store->written    = NULL;
+}
+
+extern gridWriter_t
+zoomChainStore_newWriter(zoomChainStore_t store, gridWriter_t writer)
+{
+	struct zoomChainStore_writer_struct *w;
+
+	assert(store != NULL);
+	assert(writer != NULL);
+
+	w = xmalloc(sizeof(struct zoomChainStore_writer_struct));
+	gridWriter_init((gridWriter_t)w, GRIDIO_TYPE_UNKNOWN, &local_writerFunc);
+	w->store  = store;
+	w->writer = writer;
+	if (gridWriter_getFileName(writer) != NULL)
+		w->base.fileName = filename_clone(gridWriter_getFileName(writer));
+	w->base.overwriteFileIfExists = gridWriter_getOverwriteFileIfExists(
+	    writer);
+
+	return (gridWriter_t)w;
+}
+
+extern gridReader_t
+zoomChainStore_newReader(zoomChainStore_t store, gridReader_t reader)
+{
+	struct zoomChainStore_reader_struct *r;
+
+	assert(store != NULL);
+	assert(reader != NULL);
+
+	r = xmalloc(sizeof(struct zoomChainStore_reader_struct));
+	gridReader_init((gridReader_t)r, GRIDIO_TYPE_UNKNOWN, &local_readerFunc,
+	                &local_readerHandleFilenameChange);
+	r->store  = store;
+	r->reader = reader;
+	if (gridReader_getFileName(reader) != NULL)
+		r->base.fileName = filename_clone(gridReader_getFileName(reader));
+
+	return (gridReader_t)r;
+}
+
+/*--- Implementations of local functions --------------------------------*/
+static struct zoomChainStore_entry_struct *
+local_findEntry(const zoomChainStore_t store, const char *fileName)
+{
+	for (uint32_t i = 0; i < store->numEntries; i++) {
+		if (strcmp(store->entries[i].fileName, fileName) == 0)
+			return store->entries + i;
+	}
+
+	return NULL;
+}
+
+static void
+local_dropGrid(struct zoomChainStore_entry_struct *entry)
+{
+	if (entry->patch != NULL)
+		gridPatch_del(&(entry->patch));
+	if (entry->var != NULL)
+		dataVar_del(&(entry->var));
+}
+
+static void
+local_recordWritten(zoomChainStore_t store, const char *fileName)
+{
+	for (uint32_t i = 0; i < store->numWritten; i++) {
+		if (strcmp(store->written[i], fileName) == 0)
+			return;
+	}
+
+	store->written = xrealloc(store->written,
+	                          sizeof(char *) * (store->numWritten + 1));
+	store->written[store->numWritten] = xstrdup(fileName);
+	store->numWritten++;
+}
+
+static void
+local_keepGrid(zoomChainStore_t store,
+               gridWriter_t     writer,
+               const char       *fileName,
+               gridRegular_t    grid)
+{
+	struct zoomChainStore_entry_struct *entry;
+	gridPatch_t                        patch;
+	dataVar_t                          var;
+	uint32_t                           box[LOCAL_BOXSIZE];
+
+	entry = local_findEntry(store, fileName);
+	if ((entry == NULL) || (entry->numUses == 0))
+		return;
+
+	// A rewritten file replaces the grid, also if the new one is not kept.
+	local_dropGrid(entry);
+
+	if ((gridRegular_getNumPatches(grid) != 1)
+	    || (gridRegular_getNumVars(grid) != 1) || local_writesRegion(writer))
+		return;
+	var = gridRegular_getVarHandle(grid, 0);
+	if (dataVar_isComplexified(var) || (dataVar_getNumComponents(var) != 1))
+		return;
+
+	patch = gridRegular_getPatchHandle(grid, 0);
+	local_getBox(patch, box);
+
+	// The copy drops the FFTW padding, the store never holds padded data.
+	entry->var   = dataVar_new(dataVar_getName(var), dataVar_getType(var), 1);
+	entry->patch = gridPatch_new(box, box + NDIM);
+	(void)gridPatch_attachVar(entry->patch, entry->var);
+	local_copyWindow(patch, 0, box, box + NDIM,
+	                 gridPatch_getVarDataHandle(entry->patch, 0), false);
+}
+
+static bool
+local_writesRegion(const gridWriter_t writer)
+{
+#ifdef WITH_HDF5
+	if (writer->type == GRIDIO_TYPE_HDF5)
+		return ((const struct gridWriterHDF5_struct *)writer)->doPatch;
+#endif
+
+	return false;
+}
+
+static bool
+local_readFromStore(zoomChainStore_t                         store,
+                    const struct zoomChainStore_entry_struct *entry,
+                    gridPatch_t                              patch,
+                    int                                      idxOfVar)
+{
+	bool     canUse;
+	uint32_t *boxes, *ownBox;
+	uint64_t *numSend, *numRecv, numCovered = 0;
+	void     **sendBufs, **recvBufs;
+	size_t   sizePerElement;
+
+	canUse = (entry != NULL) && (entry->patch != NULL)
+	         && local_isSameType(entry->var,
+	                             gridPatch_getVarHandle(patch, idxOfVar));
+	if (!local_allRanksAgree(store, canUse))
+		return false;
+
+	// Per rank the box of the kept part, followed by the box to fill.
+	boxes  = xmalloc(sizeof(uint32_t) * store->size * 2 * LOCAL_BOXSIZE);
+	ownBox = boxes + store->rank * 2 * LOCAL_BOXSIZE;
+	local_getBox(entry->patch, ownBox);
+	local_getBox(patch, ownBox + LOCAL_BOXSIZE);
+#ifdef WITH_MPI
+	MPI_Allgather(MPI_IN_PLACE, 0, MPI_DATATYPE_NULL,
+	              boxes, 2 * LOCAL_BOXSIZE, MPI_UINT32_T, store->comm);
+#endif
+
+	// The kept parts do not overlap, they cover the patch if their
+	// overlaps with it add up to its size.
+	numSend = xmalloc(sizeof(uint64_t) * store->size * 2);
+	numRecv = numSend + store->size;
+	for (int r = 0; r < store->size; r++) {
+		gridPointUint32_t idxLo, idxHi;
+		const uint32_t    *boxOfR = boxes + r * 2 * LOCAL_BOXSIZE;
+
+		numSend[r]  = local_getOverlap(ownBox, boxOfR + LOCAL_BOXSIZE,
+		                               idxLo, idxHi);
+		numRecv[r]  = local_getOverlap(boxOfR, ownBox + LOCAL_BOXSIZE,
+		                               idxLo, idxHi);
+		numCovered += numRecv[r];
+		assert(numSend[r] <= INT_MAX && numRecv[r] <= INT_MAX);
+	}
+	if (!local_allRanksAgree(store,
+	                         numCovered == gridPatch_getNumCells(patch))) {
+		xfree(numSend);
+		xfree(boxes);
+		return false;
+	}
+
+	sizePerElement = dataVar_getSizePerElement(entry->var);
+	sendBufs       = xmalloc(sizeof(void *) * store->size * 2);
+	recvBufs       = sendBufs + store->size;
+	for (int r = 0; r < store->size; r++) {
+		gridPointUint32_t idxLo, idxHi;
+		const uint32_t    *boxOfR = boxes + r * 2 * LOCAL_BOXSIZE;
+
+		sendBufs[r] = NULL;
+		recvBufs[r] = NULL;
+		if (numSend[r] > 0) {
+			sendBufs[r] = xmalloc(sizePerElement * numSend[r]);
+			(void)local_getOverlap(ownBox, boxOfR + LOCAL_BOXSIZE,
+			                       idxLo, idxHi);
+			local_copyWindow(entry->patch, 0, idxLo, idxHi, sendBufs[r],
+			                 false);
+		}
+		if (r == store->rank)
+			recvBufs[r] = sendBufs[r];
+		else if (numRecv[r] > 0)
+			recvBufs[r] = xmalloc(sizePerElement * numRecv[r]);
+	}
+
+#ifdef WITH_MPI
+	commScheme_t scheme = commScheme_new(store->comm, LOCAL_TAG);
+	MPI_Datatype type   = dataVar_getMPIDatatype(entry->var);
+
+	for (int r = 0; r < store->size; r++) {
+		if (r == store->rank)
+			continue;
+		if (sendBufs[r] != NULL)
+			(void)commScheme_addBuffer(scheme,
+			                           commSchemeBuffer_new(sendBufs[r],
+			                                                (int)numSend[r],
+			                                                type, r),
+			                           COMMSCHEME_TYPE_SEND);
+		if (recvBufs[r] != NULL)
+			(void)commScheme_addBuffer(scheme,
+			                           commSchemeBuffer_new(recvBufs[r],
+			                                                (int)numRecv[r],
+			                                                type, r),
+			                           COMMSCHEME_TYPE_RECV);
+	}
+	commScheme_fire(scheme);
+	commScheme_wait(scheme);
+	commScheme_del(&scheme);
+#endif
+
+	for (int r = 0; r < store->size; r++) {
+		gridPointUint32_t idxLo, idxHi;
+
+		if (recvBufs[r] == NULL)
+			continue;
+		(void)local_getOverlap(boxes + r * 2 * LOCAL_BOXSIZE,
+		                       ownBox + LOCAL_BOXSIZE, idxLo, idxHi);
+		local_copyWindow(patch, idxOfVar, idxLo, idxHi, recvBufs[r], true);
+	}
+
+	for (int r = 0; r < store->size; r++) {
+		if (sendBufs[r] != NULL)
+			xfree(sendBufs[r]);
+		if ((r != store->rank) && (recvBufs[r] != NULL))
+			xfree(recvBufs[r]);
+	}
+	xfree(sendBufs);
+	xfree(numSend);
+	xfree(boxes);
+
+	return true;
+} // local_readFromStore
+
+static bool
+local_isSameType(const dataVar_t var, const dataVar_t other)
+{
+	dataVarType_t type      = dataVar_getType(var);
+	dataVarType_t typeOther = dataVar_getType(other);
+
+	if (dataVar_getNumComponents(other) != 1)
+		return false;
+
+	if (type == typeOther)
+		return true;
+
+	// fpv_t is either float or double, compare by the size then.
+	if (((type == DATAVARTYPE_FPV) || (typeOther == DATAVARTYPE_FPV))
+	    && ((type == DATAVARTYPE_FLOAT) || (type == DATAVARTYPE_DOUBLE)
+	        || (typeOther == DATAVARTYPE_FLOAT)
+	        || (typeOther == DATAVARTYPE_DOUBLE)))
+		return dataVar_getSizePerElement(var)
+		       == dataVar_getSizePerElement(other);
+
+	return false;
+}
+
+static void
+local_getBox(const gridPatch_t patch, uint32_t *box)
+{
+	gridPointUint32_t dims;
+
+	gridPatch_getIdxLo(patch, box);
+	gridPatch_getDims(patch, dims);
+	for (int i = 0; i < NDIM; i++)
+		box[NDIM + i] = box[i] + dims[i] - 1;
+}
+
+static uint64_t
+local_getOverlap(const uint32_t    *boxA,
+                 const uint32_t    *boxB,
+                 gridPointUint32_t idxLo,
+                 gridPointUint32_t idxHi)
+{
+	uint64_t numCells = 1;
+
+	for (int i = 0; i < NDIM; i++) {
+		idxLo[i] = (boxA[i] > boxB[i]) ? boxA[i] : boxB[i];
+		idxHi[i] = (boxA[NDIM + i] < boxB[NDIM + i])
+		           ? boxA[NDIM + i] : boxB[NDIM + i];
+		if (idxLo[i] > idxHi[i])
+			return 0;
+		numCells *= idxHi[i] - idxLo[i] + 1;
+	}
+
+	return numCells;
+}
+
+static void
+local_copyWindow(gridPatch_t             patch,
+                 int                     idxOfVar,
+                 const gridPointUint32_t idxLo,
+                 const gridPointUint32_t idxHi,
+                 void                    *buffer,
+                 bool                    intoPatch)
+{
+	char              *data = gridPatch_getVarDataHandle(patch, idxOfVar);
+	char              *buf  = buffer;
+	size_t            sizePerElement, rowSize;
+	gridPointUint32_t patchLo, dimsActual;
+	uint64_t          numRows = 1;
+
+	sizePerElement = dataVar_getSizePerElement(
+	    gridPatch_getVarHandle(patch, idxOfVar));
+	rowSize        = (idxHi[0] - idxLo[0] + 1) * sizePerElement;
+	gridPatch_getIdxLo(patch, patchLo);
+	// Padded variables have longer rows than the patch.
+	gridPatch_getDimsActual(patch, idxOfVar, dimsActual);
+	for (int i = 1; i < NDIM; i++)
+		numRows *= idxHi[i] - idxLo[i] + 1;
+
+	for (uint64_t row = 0; row < numRows; row++) {
+		uint64_t offset = idxLo[0] - patchLo[0];
+		uint64_t stride = dimsActual[0];
+		uint64_t rest   = row;
+
+		for (int i = 1; i < NDIM; i++) {
+			uint64_t len = idxHi[i] - idxLo[i] + 1;
+			offset += (idxLo[i] - patchLo[i] + rest % len) * stride;
+			rest   /= len;
+			stride *= dimsActual[i];
+		}
+		if (intoPatch)
+			memcpy(data + offset * sizePerElement, buf, rowSize);
+		else
+			memcpy(buf, data + offset * sizePerElement, rowSize);
+		buf += rowSize;
+	}
+}
+
+static bool
+local_allRanksAgree(const zoomChainStore_t store, bool value)
+{
+	int agree = value ? 1 : 0;
+
+#ifdef WITH_MPI
+	MPI_Allreduce(MPI_IN_PLACE, &agree, 1, MPI_INT, MPI_LAND, store->comm);
+#else
+	(void)store;
+#endif
+
+	return (agree != 0) ? true : false;
+}
+
+static void
+local_writerDel(gridWriter_t *writer)
+{
+	struct zoomChainStore_writer_struct *w;
+
+	assert(writer != NULL && *writer != NULL);
+
+	w = (struct zoomChainStore_writer_struct *)*writer;
+	gridWriter_del(&(w->writer));
+	gridWriter_free(*writer);
+	xfree(*writer);
+
+	*writer = NULL;
+}
+
+static void
+local_writerActivate(gridWriter_t writer)
+{
+	struct zoomChainStore_writer_struct *w;
+
+	w = (struct zoomChainStore_writer_struct *)writer;
+	// A changed file name resets the activation, hand it on then.
+	if ((writer->fileName != NULL) && !writer->hasBeenActivated)
+		gridWriter_overlayFileName(w->writer, writer->fileName);
+	gridWriter_setOverwriteFileIfExists(w->writer,
+	                                    writer->overwriteFileIfExists);
+	gridWriter_activate(w->writer);
+	gridWriter_setIsActive(writer);
+}
+
+static void
+local_writerDeactivate(gridWriter_t writer)
+{
+	struct zoomChainStore_writer_struct *w;
+
+	w = (struct zoomChainStore_writer_struct *)writer;
+	gridWriter_deactivate(w->writer);
+	gridWriter_setIsInactive(writer);
+}
+
+static void
+local_writerWriteGridPatch(gridWriter_t   writer,
+                           gridPatch_t    patch,
+                           const char     *patchName,
+                           gridPointDbl_t origin,
+                           gridPointDbl_t delta)
+{
+	struct zoomChainStore_writer_struct *w;
+
+	w = (struct zoomChainStore_writer_struct *)writer;
+	gridWriter_writeGridPatch(w->writer, patch, patchName, origin, delta);
+	if (writer->fileName != NULL)
+		local_recordWritten(w->store, filename_getFullName(writer->fileName));
+}
+
+static void
+local_writerWriteGridRegular(gridWriter_t writer, gridRegular_t grid)
+{
+	struct zoomChainStore_writer_struct *w;
+
+	w = (struct zoomChainStore_writer_struct *)writer;
+	// The profiler is not thread-safe and may be called from the IO
+	// thread, the writer is called directly (see gridWriterAsync).
+	w->writer->func->writeGridRegular(w->writer, grid);
+	if (writer->fileName != NULL) {
+		const char *fileName = filename_getFullName(writer->fileName);
+
+		local_recordWritten(w->store, fileName);
+		local_keepGrid(w->store, w->writer, fileName, grid);
+	}
+}
+
+#ifdef WITH_MPI
+static void
+local_writerInitParallel(gridWriter_t writer, MPI_Comm mpiComm)
+{
+	struct zoomChainStore_writer_struct *w;
+
+	w = (struct zoomChainStore_writer_struct *)writer;
+	gridWriter_initParallel(w->writer, mpiComm);
+}
+
+#endif
+
+static void
+local_readerDel(gridReader_t *reader)
+{
+	struct zoomChainStore_reader_struct *r;
+
+	assert(reader != NULL && *reader != NULL);
+
+	r = (struct zoomChainStore_reader_struct *)*reader;
+	gridReader_del(&(r->reader));
+	gridReader_free(*reader);
+	xfree(*reader);
+
+	*reader = NULL;
+}
+
+static void
+local_readerReadIntoPatch(gridReader_t reader, gridPatch_t patch)
+{
+	for (int i = 0; i < gridPatch_getNumVars(patch); i++)
+		local_readerReadIntoPatchForVar(reader, patch, i);
+}
+
+static void
+local_readerReadIntoPatchForVar(gridReader_t reader,
+                                gridPatch_t  patch,
+                                int          idxOfVar)
+{
+	struct zoomChainStore_reader_struct *r;
+	struct zoomChainStore_entry_struct  *entry = NULL;
+
+	r = (struct zoomChainStore_reader_struct *)reader;
+	// Reading a region of the file cannot be served from the whole grid.
+	if ((reader->fileName != NULL)
+	    && !((r->reader->type == GRIDIO_TYPE_HDF5) && r->reader->doPatch))
+		entry = local_findEntry(r->store,
+		                        filename_getFullName(reader->fileName));
+
+	if (!local_readFromStore(r->store, entry, patch, idxOfVar))
+		r->reader->func->readIntoPatchForVar(r->reader, patch, idxOfVar);
+}
+
+static void
+local_readerHandleFilenameChange(gridReader_t reader)
+{
+	struct zoomChainStore_reader_struct *r;
+
+	r = (struct zoomChainStore_reader_struct *)reader;
+	gridReader_setFileName(r->reader, filename_clone(reader->fileName));
+}
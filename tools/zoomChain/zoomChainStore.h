@@ -0,0 +1,222 @@
+// Copyright (C) 2013, Steffen Knollmann
+// Released under the terms of the GNU General Public License version 3.
+// This file is part of `ginnungagap'.
+
+#ifndef ZOOMCHAINSTORE_H
+#define ZOOMCHAINSTORE_H
+
+
+/*--- Doxygen file description ------------------------------------------*/
+
+/**
+ * @file zoomChain/zoomChainStore.h
+ * @ingroup  toolsZoomChainStore
+ * @brief  Provides the interface to the in-memory grid store of the chain.
+ */
+
+
+/*--- Includes ----------------------------------------------------------*/
+#include "zoomChainConfig.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include "../../src/libgrid/gridWriter.h"
+#include "../../src/libgrid/gridReader.h"
+
+
+/*--- ADT handle --------------------------------------------------------*/
+
+/** @brief  Provides a handle for the grid store. */
+typedef struct zoomChainStore_struct *zoomChainStore_t;
+
+
+/*--- Prototypes of exported functions ----------------------------------*/
+
+/**
+ * @name  Creating and Deleting
+ *
+ * @{
+ */
+
+/**
+ * @brief  Creates a new, empty grid store.
+ *
+ * @return  Returns a new store that does not want any grid.
+ */
+extern zoomChainStore_t
+zoomChainStore_new(void);
+
+
+/**
+ * @brief  Deletes a grid store and frees the associated memory.
+ *
+ * The readers and writers handed out by the store must have been deleted
+ * before.
+ *
+ * @param[in,out]  *store
+ *                    The store to delete, will be set to @c NULL.
+ *
+ * @return  Returns nothing.
+ */
+extern void
+zoomChainStore_del(zoomChainStore_t *store);
+
+
+/** @} */
+
+/**
+ * @name  Keeping Grids
+ *
+ * @{
+ */
+
+/**
+ * @brief  Marks a file whose grid should be kept once it is written.
+ *
+ * Every call adds one use, the grid is freed after as many calls to
+ * zoomChainStore_release().
+ *
+ * @param[in,out]  store
+ *                    The store to work with.
+ * @param[in]      *fileName
+ *                    The full name of the file, exactly as the writer and
+ *                    the reader will produce it.
+ *
+ * @return  Returns nothing.
+ */
+extern void
+zoomChainStore_addUse(zoomChainStore_t store, const char *fileName);
+
+
+/**
+ * @brief  Gives up one use of a file.
+ *
+ * Nothing happens for files that are not wanted.
+ *
+ * @param[in,out]  store
+ *                    The store to work with.
+ * @param[in]      *fileName
+ *                    The full name of the file.
+ *
+ * @return  Returns nothing.
+ */
+extern void
+zoomChainStore_release(zoomChainStore_t store, const char *fileName);
+
+
+/** @} */
+
+/**
+ * @name  Written Files
+ *
+ * @{
+ */
+
+/**
+ * @brief  Gives the number of files written through the writers of the
+ *         store since the last zoomChainStore_clearWritten().
+ *
+ * @param[in]  store
+ *                The store to query.
+ *
+ * @return  Returns the number of distinct files.
+ */
+extern uint32_t
+zoomChainStore_getNumWritten(const zoomChainStore_t store);
+
+
+/**
+ * @brief  Gives the full name of a written file.
+ *
+ * @param[in]  store
+ *                The store to query.
+ * @param[in]  idx
+ *                The index of the file, in the order of the first write.
+ *
+ * @return  Returns the name, it remains owned by the store.
+ */
+extern const char *
+zoomChainStore_getWritten(const zoomChainStore_t store, uint32_t idx);
+
+
+/**
+ * @brief  Forgets the written files.
+ *
+ * @param[in,out]  store
+ *                    The store to work with.
+ *
+ * @return  Returns nothing.
+ */
+extern void
+zoomChainStore_clearWritten(zoomChainStore_t store);
+
+
+/** @} */
+
+/**
+ * @name  Readers and Writers
+ *
+ * @{
+ */
+
+/**
+ * @brief  Wraps a writer so that the store keeps a copy of the grids.
+ *
+ * All calls are passed on to @c writer, the files are written as before.
+ * The names of the files are recorded, see zoomChainStore_getWritten().
+ * In addition, the local part of every grid written to a wanted file is
+ * copied into the store.  Only grids with one patch and one real variable
+ * are kept, the others are only written.
+ *
+ * @param[in,out]  store
+ *                    The store to fill, it must outlive the writer.
+ * @param[in]      writer
+ *                    The writer to wrap, the returned writer takes it over.
+ *
+ * @return  Returns a new writer.
+ */
+extern gridWriter_t
+zoomChainStore_newWriter(zoomChainStore_t store, gridWriter_t writer);
+
+
+/**
+ * @brief  Wraps a reader so that it is served from the store.
+ *
+ * If the store holds the grid of the reader's file, with a matching type
+ * and covering the whole patch, the data are taken from the store and
+ * redistributed to the layout of the patch.  Otherwise, and always for
+ * readers that only read a region of the file, @c reader reads the file.
+ * Under MPI, all ranks must read collectively.
+ *
+ * @param[in,out]  store
+ *                    The store to read from, it must outlive the reader.
+ * @param[in]      reader
+ *                    The reader to wrap, the returned reader takes it over.
+ *
+ * @return  Returns a new reader.
+ */
+extern gridReader_t
+zoomChainStore_newReader(zoomChainStore_t store, gridReader_t reader);
+
+
+/** @} */
+
+
+/*--- Doxygen group definitions -----------------------------------------*/
+
+/**
+ * @defgroup toolsZoomChainStore In-Memory Grids
+ * @ingroup  toolsZoomChain
+ * @brief  Hands grids from one stage to the next without reading files.
+ *
+ * The grids are still written, so that the manifests, skipped stages and
+ * later runs find the files.  A later stage that reads one of them gets
+ * the values from memory instead, at the precision they were computed in.
+ * Writers that round or quantise the values therefore give slightly
+ * different (more precise) inputs than reading the file would.
+ *
+ * The writers of the store also record which files a stage wrote, these
+ * are the outputs in the manifest of the stage.
+ */
+
+
+#endif
@@ -0,0 +1,95 @@
+// Copyright (C) 2013, Steffen Knollmann
+// Released under the terms of the GNU General Public License version 3.
+// This file is part of `ginnungagap'.
+
+#ifndef ZOOMCHAIN_ADT_H
+#define ZOOMCHAIN_ADT_H
+
+
+/*--- Doxygen file description ------------------------------------------*/
+
+/**
+ * @file zoomChain/zoomChain_adt.h
+ * @ingroup  toolsZoomChain
+ * @brief  Provides the main structure of the zoomChain application.
+ */
+
+
+/*--- Includes ----------------------------------------------------------*/
+#include "zoomChainConfig.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include "zoomChainManifest.h"
+#include "zoomChainStore.h"
+
+
+/*--- Exported types ----------------------------------------------------*/
+
+/** @brief  Lists the tools that can be run as a stage. */
+typedef enum {
+	/** @brief  Runs makeMask. */
+	ZOOMCHAIN_TOOL_MAKEMASK,
+	/** @brief  Runs ginnungagap. */
+	ZOOMCHAIN_TOOL_GINNUNGAGAP,
+	/** @brief  Runs realSpaceConstraints. */
+	ZOOMCHAIN_TOOL_REALSPACECONSTRAINTS,
+	/** @brief  Runs refineGrid. */
+	ZOOMCHAIN_TOOL_REFINEGRID,
+	/** @brief  Runs generateICs. */
+	ZOOMCHAIN_TOOL_GENERATEICS,
+	/** @brief  Runs ginnungagap and generateICs without files in between. */
+	ZOOMCHAIN_TOOL_GINNUNGAGAPICS
+} zoomChainTool_t;
+
+/** @brief  Describes one stage of the chain. */
+struct zoomChainStage_struct {
+	/** @brief  The name of the stage (its section in the chain ini). */
+	char                *name;
+	/** @brief  The tool to run. */
+	zoomChainTool_t     tool;
+	/** @brief  The ini file from which the tool is set up. */
+	char                *iniFileName;
+	/** @brief  The section for the tool, @c NULL for the default. */
+	char                *sectionName;
+	/** @brief  The number of input files. */
+	uint32_t            numInputs;
+	/** @brief  The input files, their content decides about a rerun. */
+	char                **inputs;
+	/** @brief  The number of output files listed in the ini.  Stages
+	 *          whose tool does not record its outputs are never skipped
+	 *          without them. */
+	uint32_t            numOutputs;
+	/** @brief  The output files listed in the ini, in addition to those
+	 *          recorded from the writers of the tool. */
+	char                **outputs;
+	/** @brief  The manifest of the last run, only kept on the root rank. */
+	zoomChainManifest_t manifest;
+	/** @brief  Whether the stage was skipped as its outputs were current. */
+	bool                wasSkipped;
+	/** @brief  The time the stage took, negative if it did not run. */
+	double              timing;
+};
+
+
+/*--- Implemention of main structure ------------------------------------*/
+
+/** @brief  The main structure of the zoomChain application. */
+struct zoomChain_struct {
+	/** @brief  The number of stages. */
+	uint32_t                     numStages;
+	/** @brief  The stages in the order in which they are executed. */
+	struct zoomChainStage_struct *stages;
+	/** @brief  Whether all stages are run regardless of their manifests. */
+	bool                         forceRun;
+	/** @brief  Whether grids are handed to later stages in memory. */
+	bool                         keepGridsInMemory;
+	/** @brief  Whether files are identified by their content instead of
+	 *          their size and modification time. */
+	bool                         hashContent;
+	/** @brief  The grids handed to later stages in memory and the files
+	 *          written by the current stage. */
+	zoomChainStore_t             store;
+};
+
+
+#endif